@@ -27,6 +27,16 @@
 
 #define LZMA_HEADER_SIZE (LZMA_PROPS_SIZE + 8)
 
+//
+// Header of the chunked format, see LZMA_PARALLEL_HEADER in
+// MdeModulePkg/Include/Guid/LzmaDecompress.h. It is followed by the
+// compressed size of every chunk, then by the chunks, each of which is a
+// complete LZMA stream.
+//
+#define LZMA_PARALLEL_SIGNATURE 0x504D5A4C
+#define LZMA_PARALLEL_HEADER_SIZE 16
+#define LZMA_PARALLEL_DEFAULT_CHUNK_SIZE (1 << 20)
+
 typedef enum {
   NoConverter,
   X86Converter,
@@ -41,6 +51,8 @@ const char *kInvalidParamValMessage = "Invalid parameter value";
 
 static BoolInt mQuietMode = False;
 static CONVERTER_TYPE mConType = NoConverter;
+static BoolInt mChunked = False;
+static UINT64 mChunkSize = LZMA_PARALLEL_DEFAULT_CHUNK_SIZE;
 
 UINT64 mDictionarySize = 28;
 UINT64 mCompressionMode = 2;
@@ -60,6 +72,8 @@ void PrintHelp(char *buffer)
              "  -d: decode file\n"
              "  -o FileName, --output FileName: specify the output filename\n"
              "  --f86: enable converter for x86 code\n"
+             "  --chunked: compress independent chunks that can be decoded in parallel\n"
+             "  --chunk-size: set the chunk size in KB for --chunked, default: 1024\n"
              "  -v, --verbose: increase output messages\n"
              "  -q, --quiet: reduce output messages\n"
              "  --debug [0-9]: set debug level\n"
@@ -238,6 +252,177 @@ Done:
   return res;
 }
 
+static void SetUInt32(Byte *buffer, UInt32 value)
+{
+  int i;
+  for (i = 0; i < 4; i++)
+    buffer[i] = (Byte)(value >> (8 * i));
+}
+
+static UInt32 GetUInt32(const Byte *buffer)
+{
+  return (UInt32)buffer[0] | ((UInt32)buffer[1] << 8) |
+         ((UInt32)buffer[2] << 16) | ((UInt32)buffer[3] << 24);
+}
+
+static SRes EncodeChunked(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize, CLzmaEncProps *props)
+{
+  SRes res;
+  size_t inSize = (size_t)fileSize;
+  size_t chunkSize = (size_t)mChunkSize;
+  UInt32 chunkCount;
+  UInt32 chunk;
+  Byte *inBuffer = 0;
+  Byte *outBuffer = 0;
+  size_t outSize;
+  size_t outPos;
+
+  if (inSize == 0) {
+    return SZ_ERROR_INPUT_EOF;
+  }
+
+  if (fileSize > 0xFFFFFFFF) {
+    return SZ_ERROR_PARAM;
+  }
+
+  inBuffer = (Byte *)MyAlloc(inSize);
+  if (inBuffer == 0)
+    return SZ_ERROR_MEM;
+
+  if (SeqInStream_Read(inStream, inBuffer, inSize) != SZ_OK) {
+    res = SZ_ERROR_READ;
+    goto Done;
+  }
+
+  chunkCount = (UInt32)((inSize + chunkSize - 1) / chunkSize);
+
+  // we allocate 105% of original size + 64KB for every chunk
+  outSize = LZMA_PARALLEL_HEADER_SIZE + 4 * (size_t)chunkCount +
+            (size_t)chunkCount * (LZMA_HEADER_SIZE + chunkSize / 20 * 21 + (1 << 16));
+  outBuffer = (Byte *)MyAlloc(outSize);
+  if (outBuffer == 0) {
+    res = SZ_ERROR_MEM;
+    goto Done;
+  }
+
+  SetUInt32(outBuffer, LZMA_PARALLEL_SIGNATURE);
+  SetUInt32(outBuffer + 4, chunkCount);
+  SetUInt32(outBuffer + 8, (UInt32)chunkSize);
+  SetUInt32(outBuffer + 12, (UInt32)inSize);
+  outPos = LZMA_PARALLEL_HEADER_SIZE + 4 * (size_t)chunkCount;
+
+  for (chunk = 0; chunk < chunkCount; chunk++) {
+    size_t chunkStart = (size_t)chunk * chunkSize;
+    size_t chunkInSize = inSize - chunkStart < chunkSize ? inSize - chunkStart : chunkSize;
+    Byte *chunkOut = outBuffer + outPos;
+    size_t outSizeProcessed = outSize - outPos - LZMA_HEADER_SIZE;
+    size_t outPropsSize = LZMA_PROPS_SIZE;
+    int i;
+
+    for (i = 0; i < 8; i++)
+      chunkOut[i + LZMA_PROPS_SIZE] = (Byte)((UInt64)chunkInSize >> (8 * i));
+
+    res = LzmaEncode(chunkOut + LZMA_HEADER_SIZE, &outSizeProcessed,
+        inBuffer + chunkStart, chunkInSize,
+        props, chunkOut, &outPropsSize, 0,
+        NULL, &g_Alloc, &g_Alloc);
+
+    if (res != SZ_OK)
+      goto Done;
+
+    SetUInt32(outBuffer + LZMA_PARALLEL_HEADER_SIZE + 4 * (size_t)chunk, (UInt32)(LZMA_HEADER_SIZE + outSizeProcessed));
+    outPos += LZMA_HEADER_SIZE + outSizeProcessed;
+  }
+
+  if (outStream->Write(outStream, outBuffer, outPos) != outPos)
+    res = SZ_ERROR_WRITE;
+
+Done:
+  MyFree(outBuffer);
+  MyFree(inBuffer);
+
+  return res;
+}
+
+static SRes DecodeChunked(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize)
+{
+  SRes res;
+  size_t inSize = (size_t)fileSize;
+  Byte *inBuffer = 0;
+  Byte *outBuffer = 0;
+  size_t outSize;
+  size_t outPos;
+  size_t inPos;
+  UInt32 chunkCount;
+  UInt32 chunkSize;
+  UInt32 chunk;
+  ELzmaStatus status;
+
+  if (inSize < LZMA_PARALLEL_HEADER_SIZE)
+    return SZ_ERROR_INPUT_EOF;
+
+  inBuffer = (Byte *)MyAlloc(inSize);
+  if (inBuffer == 0)
+    return SZ_ERROR_MEM;
+
+  if (SeqInStream_Read(inStream, inBuffer, inSize) != SZ_OK) {
+    res = SZ_ERROR_READ;
+    goto Done;
+  }
+
+  chunkCount = GetUInt32(inBuffer + 4);
+  chunkSize = GetUInt32(inBuffer + 8);
+  outSize = GetUInt32(inBuffer + 12);
+  if ((GetUInt32(inBuffer) != LZMA_PARALLEL_SIGNATURE) ||
+      (chunkCount > (inSize - LZMA_PARALLEL_HEADER_SIZE) / 4)) {
+    res = SZ_ERROR_DATA;
+    goto Done;
+  }
+
+  outBuffer = (Byte *)MyAlloc(outSize != 0 ? outSize : 1);
+  if (outBuffer == 0) {
+    res = SZ_ERROR_MEM;
+    goto Done;
+  }
+
+  inPos = LZMA_PARALLEL_HEADER_SIZE + 4 * (size_t)chunkCount;
+  outPos = 0;
+  for (chunk = 0; chunk < chunkCount; chunk++) {
+    size_t chunkInSize = GetUInt32(inBuffer + LZMA_PARALLEL_HEADER_SIZE + 4 * (size_t)chunk);
+    size_t chunkOutSize = outSize - outPos < chunkSize ? outSize - outPos : chunkSize;
+    size_t inSizePure;
+
+    if ((chunkInSize < LZMA_HEADER_SIZE) || (chunkInSize > inSize - inPos)) {
+      res = SZ_ERROR_DATA;
+      goto Done;
+    }
+
+    inSizePure = chunkInSize - LZMA_HEADER_SIZE;
+    res = LzmaDecode(outBuffer + outPos, &chunkOutSize, inBuffer + inPos + LZMA_HEADER_SIZE, &inSizePure,
+        inBuffer + inPos, LZMA_PROPS_SIZE, LZMA_FINISH_END, &status, &g_Alloc);
+
+    if (res != SZ_OK)
+      goto Done;
+
+    inPos += chunkInSize;
+    outPos += chunkOutSize;
+  }
+
+  if (outPos != outSize) {
+    res = SZ_ERROR_DATA;
+    goto Done;
+  }
+
+  if (outStream->Write(outStream, outBuffer, outSize) != outSize)
+    res = SZ_ERROR_WRITE;
+
+Done:
+  MyFree(outBuffer);
+  MyFree(inBuffer);
+
+  return res;
+}
+
 int main2(int numArgs, const char *args[], char *rs)
 {
   CFileSeqInStream inStream;
@@ -272,6 +457,17 @@ int main2(int numArgs, const char *args[], char *rs)
       modeWasSet = True;
     } else if (strcmp(args[param], "--f86") == 0) {
       mConType = X86Converter;
+    } else if (strcmp(args[param], "--chunked") == 0) {
+      mChunked = True;
+    } else if (strcmp(args[param], "--chunk-size") == 0) {
+      if (numArgs < (param + 2)) {
+        return PrintUserError(rs);
+      }
+      AsciiStringToUint64(args[++param], FALSE, &mChunkSize);
+      if ((mChunkSize == 0) || (mChunkSize > (1 << 20))) {
+        return PrintError(rs, kInvalidParamValMessage);
+      }
+      mChunkSize *= 1024;
     } else if (strcmp(args[param], "-o") == 0 ||
                strcmp(args[param], "--output") == 0) {
       if (numArgs < (param + 2)) {
@@ -342,6 +538,10 @@ int main2(int numArgs, const char *args[], char *rs)
     return PrintUserError(rs);
   }
 
+  if (mChunked && (mConType != NoConverter)) {
+    return PrintError(rs, "--chunked can not be used with a converter");
+  }
+
   {
     size_t t4 = sizeof(UInt32);
     size_t t8 = sizeof(UInt64);
@@ -364,14 +564,22 @@ int main2(int numArgs, const char *args[], char *rs)
     if (!mQuietMode) {
       printf("Encoding\n");
     }
-    res = Encode(&outStream.vt, &inStream.vt, fileSize, &props);
+    if (mChunked) {
+      res = EncodeChunked(&outStream.vt, &inStream.vt, fileSize, &props);
+    } else {
+      res = Encode(&outStream.vt, &inStream.vt, fileSize, &props);
+    }
   }
   else
   {
     if (!mQuietMode) {
       printf("Decoding\n");
     }
-    res = Decode(&outStream.vt, &inStream.vt, fileSize);
+    if (mChunked) {
+      res = DecodeChunked(&outStream.vt, &inStream.vt, fileSize);
+    } else {
+      res = Decode(&outStream.vt, &inStream.vt, fileSize);
+    }
   }
 
   File_Close(&outStream.file);
@@ -0,0 +1,224 @@
+## @file
+# process DISPATCH_PLAN statement and generate the DXE dispatch plan file
+#
+#  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+#
+#  SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+##
+# Import Modules
+#
+from __future__ import absolute_import
+import re
+import uuid
+import zlib
+from struct import pack
+import Common.LongFilePathOs as os
+from io import BytesIO
+from .FfsInfStatement import FfsInfStatement
+from .FfsFileStatement import FileStatement
+from .GenFdsGlobalVariable import GenFdsGlobalVariable
+from Common.StringUtils import NormPath
+from Common.Misc import SaveFileOnChange, PackGUID, GuidStructureStringToGuidString
+from Common.LongFilePathSupport import OpenLongFilePath as open
+from Common.DataType import *
+from AutoGen.GenDepex import DependencyExpression
+
+DXE_DISPATCH_PLAN_GUID = "EE2DA7DD-B46F-43CA-98C0-C9BB7512BCCC"
+
+## Signature 'DPLN' and version of EDKII_DISPATCH_PLAN_HEADER
+DISPATCH_PLAN_SIGNATURE = 0x4E4C5044
+DISPATCH_PLAN_VERSION = 2
+
+## Module types dispatched by the DXE dispatcher from their DEPEX
+DISPATCH_PLAN_MODULE_TYPES = {SUP_MODULE_DXE_DRIVER, SUP_MODULE_DXE_RUNTIME_DRIVER, SUP_MODULE_DXE_SAL_DRIVER}
+
+## Usage comment of the protocols a module installs from its entry point
+PRODUCES_PATTERN = re.compile(r'^##\s*(PRODUCES|ALWAYS_PRODUCED)\b')
+
+DEPEX_OPCODE = {Value: Name for Name, Value in DependencyExpression.Opcode["DXE"].items()}
+
+## process DISPATCH_PLAN statement and generate the DXE dispatch plan file
+#
+#   The plan lists the DXE drivers of the FV with the dispatch round in which
+#   the DXE dispatcher would find them ready, given the protocols that the
+#   drivers of the FV are declared to produce in their INF. Drivers whose DEPEX
+#   refers to anything else, or that use BEFORE, AFTER or SOR, are left out and
+#   dispatched by the regular dispatcher. The DXE core schedules the planned
+#   drivers by round without evaluating their DEPEX.
+#
+class DispatchPlan (object):
+    ## The constructor
+    #
+    #   @param  self        The object pointer
+    #
+    def __init__(self):
+        self.DispatchPlanType = ""
+
+    ## Parse a binary DXE DEPEX
+    #
+    #   @param  Buffer      The content of the .depex file
+    #   @retval list        (opcode name, GUID string or None) tuples, or None
+    #                       if the DEPEX can't be planned
+    #
+    @staticmethod
+    def _ParseDepex(Buffer):
+        Instructions = []
+        Offset = 0
+        while Offset < len(Buffer):
+            Opcode = DEPEX_OPCODE.get(Buffer[Offset])
+            Offset += 1
+            if Opcode in {DEPEX_OPCODE_BEFORE, DEPEX_OPCODE_AFTER, DEPEX_OPCODE_SOR, None}:
+                return None
+            if Opcode == DEPEX_OPCODE_PUSH:
+                if Offset + 16 > len(Buffer):
+                    return None
+                Instructions.append((Opcode, str(uuid.UUID(bytes_le=bytes(Buffer[Offset:Offset + 16]))).upper()))
+                Offset += 16
+            else:
+                Instructions.append((Opcode, None))
+            if Opcode == DEPEX_OPCODE_END:
+                return Instructions
+        return None
+
+    ## Evaluate a parsed DEPEX
+    #
+    #   @param  Instructions    Returned by _ParseDepex()
+    #   @param  Installed       Set of the GUID strings of installed protocols
+    #   @retval bool            The value of the DEPEX
+    #
+    @staticmethod
+    def _EvaluateDepex(Instructions, Installed):
+        Stack = []
+        try:
+            for Opcode, Guid in Instructions:
+                if Opcode == DEPEX_OPCODE_PUSH:
+                    Stack.append(Guid in Installed)
+                elif Opcode == DEPEX_OPCODE_AND:
+                    Stack.append(Stack.pop() & Stack.pop())
+                elif Opcode == DEPEX_OPCODE_OR:
+                    Stack.append(Stack.pop() | Stack.pop())
+                elif Opcode == DEPEX_OPCODE_NOT:
+                    Stack.append(not Stack.pop())
+                elif Opcode == DEPEX_OPCODE_TRUE:
+                    Stack.append(True)
+                elif Opcode == DEPEX_OPCODE_FALSE:
+                    Stack.append(False)
+                elif Opcode == DEPEX_OPCODE_END:
+                    return Stack.pop()
+        except IndexError:
+            pass
+        return False
+
+    ## Get the protocols a module is declared to produce
+    #
+    #   @param  Inf         The InfBuildData of the module
+    #   @retval set         GUID strings of the protocols
+    #
+    @staticmethod
+    def _GetProducedProtocols(Inf):
+        Produced = set()
+        for CName, Value in Inf.Protocols.items():
+            for Comment in Inf.ProtocolComments.get(CName, []):
+                if PRODUCES_PATTERN.match(Comment.strip()):
+                    Produced.add(GuidStructureStringToGuidString(Value).upper())
+                    break
+        return Produced
+
+    ## Compute the expected dispatch order
+    #
+    #   Replays the rounds of the DXE dispatcher: every round schedules, in FV
+    #   order, all the drivers whose DEPEX holds at the start of the round.
+    #
+    #   @param  self        The object pointer
+    #   @param  FfsList     The FfsInfStatement and FileStatement of the FV, after
+    #                       their FFS files were generated
+    #   @param  AprioriSectionList  The APRIORI sections of the FV
+    #   @retval list        (File GUID string, round) tuples in dispatch order
+    #
+    def _GetDispatchOrder(self, FfsList, AprioriSectionList):
+        AprioriInfs = set()
+        AprioriGuids = set()
+        for AprSection in AprioriSectionList:
+            for FfsObj in AprSection.FfsList:
+                if isinstance(FfsObj, FileStatement):
+                    AprioriGuids.add(FfsObj.NameGuid.upper())
+                else:
+                    AprioriInfs.add(NormPath(FfsObj.InfFileName))
+
+        Installed = set()
+        Pending = []
+        for FfsObj in FfsList:
+            if not isinstance(FfsObj, FfsInfStatement) or FfsObj.InfModule is None:
+                continue
+            if FfsObj.ModuleType not in DISPATCH_PLAN_MODULE_TYPES:
+                continue
+            Produced = self._GetProducedProtocols(FfsObj.InfModule)
+            if NormPath(FfsObj.InfFileName) in AprioriInfs or FfsObj.ModuleGuid.upper() in AprioriGuids:
+                #
+                # Dispatched first by the a priori file
+                #
+                Installed |= Produced
+                continue
+            DepexFile = os.path.join(FfsObj.EfiOutputPath, FfsObj.BaseName + '.depex')
+            if not os.path.exists(DepexFile):
+                continue
+            with open(DepexFile, 'rb') as File:
+                Instructions = self._ParseDepex(bytearray(File.read()))
+            if Instructions is None:
+                continue
+            Pending.append((FfsObj.ModuleGuid.upper(), Instructions, Produced))
+
+        Order = []
+        Round = 0
+        while Pending:
+            Ready = [Module for Module in Pending if self._EvaluateDepex(Module[1], Installed)]
+            if not Ready:
+                break
+            for Module in Ready:
+                Order.append((Module[0], Round))
+                Installed |= Module[2]
+                Pending.remove(Module)
+            Round += 1
+
+        for Module in Pending:
+            GenFdsGlobalVariable.VerboseLogger("%s is not in the dispatch plan" % Module[0])
+        return Order
+
+    ## GenFfs() method
+    #
+    #   Generate FFS for the dispatch plan file
+    #
+    #   @param  self        The object pointer
+    #   @param  FvName      for whom dispatch plan file generated
+    #   @param  FfsList     The FfsInfStatement and FileStatement of the FV
+    #   @param  AprioriSectionList  The APRIORI sections of the FV
+    #   @retval string      Generated file name
+    #
+    def GenFfs (self, FvName, FfsList, AprioriSectionList):
+        OutputPlanFilePath = os.path.join (GenFdsGlobalVariable.WorkSpaceDir, \
+                                   GenFdsGlobalVariable.FfsDir,\
+                                   DXE_DISPATCH_PLAN_GUID + FvName)
+        if not os.path.exists(OutputPlanFilePath):
+            os.makedirs(OutputPlanFilePath)
+
+        OutputPlanFileName = os.path.join(OutputPlanFilePath, DXE_DISPATCH_PLAN_GUID + FvName + '.Plan')
+        PlanFfsFileName = os.path.join(OutputPlanFilePath, DXE_DISPATCH_PLAN_GUID + FvName + '.Ffs')
+
+        Order = self._GetDispatchOrder(FfsList, AprioriSectionList)
+        GenFdsGlobalVariable.InfLogger("Dispatch plan of %s FV: %d drivers" % (FvName, len(Order)))
+
+        Entries = b''.join(PackGUID(Guid.split('-')) for Guid, Round in Order)
+        Entries += b''.join(pack('=I', Round) for Guid, Round in Order)
+        Buffer = BytesIO()
+        Buffer.write(pack('=4I', DISPATCH_PLAN_SIGNATURE, DISPATCH_PLAN_VERSION, len(Order), zlib.crc32(Entries) & 0xFFFFFFFF))
+        Buffer.write(Entries)
+        SaveFileOnChange(OutputPlanFileName, Buffer.getvalue())
+
+        RawSectionFileName = os.path.join(OutputPlanFilePath, DXE_DISPATCH_PLAN_GUID + FvName + '.raw')
+        GenFdsGlobalVariable.GenerateSection(RawSectionFileName, [OutputPlanFileName], 'EFI_SECTION_RAW')
+        GenFdsGlobalVariable.GenerateFfs(PlanFfsFileName, [RawSectionFileName],
+                                        'EFI_FV_FILETYPE_FREEFORM', DXE_DISPATCH_PLAN_GUID)
+
+        return PlanFfsFileName
@@ -32,6 +32,7 @@ from .Fd import FD
 from .Region import Region
 from .Fv import FV
 from .AprioriSection import AprioriSection
+from .DispatchPlan import DispatchPlan
 from .FfsInfStatement import FfsInfStatement
 from .FfsFileStatement import FileStatement
 from .VerSection import VerSection
@@ -2107,6 +2108,7 @@ class FdfParser:
 
         self._GetAprioriSection(FvObj)
         self._GetAprioriSection(FvObj)
+        self._GetDispatchPlanStatement(FvObj)
 
         while True:
             isInf = self._GetInfStatement(FvObj)
@@ -2376,6 +2378,27 @@ class FdfParser:
         FvObj.AprioriSectionList.append(AprSectionObj)
         return True
 
+    ## _GetDispatchPlanStatement() method
+    #
+    #   Get DISPATCH_PLAN statement
+    #
+    #   @param  self        The object pointer
+    #   @param  FvObj       for whom dispatch plan is got
+    #   @retval True        Successfully find dispatch plan statement
+    #   @retval False       Not able to find dispatch plan statement
+    #
+    def _GetDispatchPlanStatement(self, FvObj):
+        if not self._IsKeyword("DISPATCH_PLAN"):
+            return False
+
+        if not self._IsKeyword("DXE"):
+            raise Warning.Expected("Dispatch plan type DXE", self.FileName, self.CurrentLineNumber)
+
+        DispatchPlanObj = DispatchPlan()
+        DispatchPlanObj.DispatchPlanType = self._Token
+        FvObj.DispatchPlan = DispatchPlanObj
+        return True
+
     def _ParseInfStatement(self):
         if not self._IsKeyword("INF"):
             return None
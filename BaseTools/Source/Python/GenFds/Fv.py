@@ -42,6 +42,7 @@ class FV (object):
         self.FvNameGuid = None
         self.FvNameString = None
         self.AprioriSectionList = []
+        self.DispatchPlan = None
         self.FfsList = []
         self.BsBaseAddress = None
         self.RtBaseAddress = None
@@ -130,6 +131,15 @@ class FV (object):
                 self.FvInfFile.append("EFI_FILE_NAME = " + \
                                             FileName          + \
                                             TAB_LINE_BREAK)
+        #
+        # The dispatch plan needs the DEPEX of the modules, so generate it last
+        #
+        if self.DispatchPlan is not None and not Flag:
+            FileName = self.DispatchPlan.GenFfs(self.UiFvName, self.FfsList, self.AprioriSectionList)
+            FfsFileList.append(FileName)
+            self.FvInfFile.append("EFI_FILE_NAME = " + \
+                                        FileName          + \
+                                        TAB_LINE_BREAK)
         if not Flag:
             FvInfFile = ''.join(self.FvInfFile)
             SaveFileOnChange(self.InfFileName, FvInfFile, False)
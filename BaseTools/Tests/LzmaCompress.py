@@ -0,0 +1,142 @@
+## @file
+# Unit tests for the chunked format of the LzmaCompress utility
+#
+#  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+#
+#  SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+##
+# Import Modules
+#
+from __future__ import print_function
+import os
+import random
+import struct
+import sys
+import unittest
+
+import TestTools
+
+#
+# See LZMA_PARALLEL_HEADER in MdeModulePkg/Include/Guid/LzmaDecompress.h
+#
+LZMA_PARALLEL_SIGNATURE = b'LZMP'
+LZMA_PARALLEL_HEADER_SIZE = 16
+LZMA_HEADER_SIZE = 13
+
+class Tests(TestTools.BaseToolsTest):
+
+    def setUp(self):
+        TestTools.BaseToolsTest.setUp(self)
+        self.toolName = 'LzmaCompress'
+
+    def getRandomData(self, size):
+        #
+        # Repeat short random runs, so that the data compresses
+        #
+        data = bytearray()
+        while len(data) < size:
+            data += bytes([random.randint(0, 255)]) * random.randint(1, 16)
+        return bytes(data[:size])
+
+    def checkChunkedFormat(self, data, compressed, chunkSize):
+        signature, chunkCount, headerChunkSize, decompressedSize = \
+            struct.unpack_from('<4sIII', compressed)
+        self.assertEqual(signature, LZMA_PARALLEL_SIGNATURE)
+        self.assertEqual(chunkCount, (len(data) + chunkSize - 1) // chunkSize)
+        self.assertEqual(headerChunkSize, chunkSize)
+        self.assertEqual(decompressedSize, len(data))
+
+        compressedSizes = struct.unpack_from(
+            '<%dI' % chunkCount,
+            compressed,
+            LZMA_PARALLEL_HEADER_SIZE
+            )
+        offset = LZMA_PARALLEL_HEADER_SIZE + 4 * chunkCount
+        for chunk in range(chunkCount):
+            #
+            # Every chunk is a complete LZMA stream that records its own size
+            #
+            size = struct.unpack_from('<Q', compressed, offset + 5)[0]
+            self.assertEqual(size, min(chunkSize, len(data) - chunk * chunkSize))
+            offset += compressedSizes[chunk]
+        self.assertEqual(offset, len(compressed))
+
+    def chunkedCompressionTestCycle(self, data, chunkSizeKb):
+        self.WriteTmpFile('input', data)
+        result = self.RunTool(
+            '-e', '--chunked',
+            '--chunk-size', str(chunkSizeKb),
+            '-o', self.GetTmpFilePath('output1'),
+            self.GetTmpFilePath('input')
+            )
+        self.assertTrue(result == 0)
+        self.checkChunkedFormat(data, self.ReadTmpFile('output1'), chunkSizeKb * 1024)
+        result = self.RunTool(
+            '-d', '--chunked',
+            '-o', self.GetTmpFilePath('output2'),
+            self.GetTmpFilePath('output1')
+            )
+        self.assertTrue(result == 0)
+        finish = self.ReadTmpFile('output2')
+        startEqualsFinish = data == finish
+        if not startEqualsFinish:
+            print()
+            print('Original data did not match decompress(compress(data))')
+            self.DisplayBinaryData('original data', data)
+            self.DisplayBinaryData('after compression', self.ReadTmpFile('output1'))
+            self.DisplayBinaryData('after decompression', finish)
+        self.assertTrue(startEqualsFinish)
+
+    def testSingleChunkCycles(self):
+        for size in (1, 1000, 1024):
+            self.chunkedCompressionTestCycle(self.getRandomData(size), 1)
+            self.CleanUpTmpDir()
+
+    def testMultiChunkCycles(self):
+        for size in (1025, 2048, 5000):
+            self.chunkedCompressionTestCycle(self.getRandomData(size), 1)
+            self.CleanUpTmpDir()
+
+    def testRandomDataCycles(self):
+        for i in range(8):
+            data = self.getRandomData(random.randint(1024, 16384))
+            self.chunkedCompressionTestCycle(data, random.randint(1, 4))
+            self.CleanUpTmpDir()
+
+    def testCorruptHeader(self):
+        data = self.getRandomData(3000)
+        self.WriteTmpFile('input', data)
+        result = self.RunTool(
+            '-e', '--chunked',
+            '--chunk-size', '1',
+            '-o', self.GetTmpFilePath('output1'),
+            self.GetTmpFilePath('input')
+            )
+        self.assertTrue(result == 0)
+        compressed = self.ReadTmpFile('output1')
+
+        corruptions = (
+            (0, b'LZMA'),
+            (4, struct.pack('<I', 0)),
+            (4, struct.pack('<I', len(compressed))),
+            (8, struct.pack('<I', 0)),
+            (LZMA_PARALLEL_HEADER_SIZE, struct.pack('<I', 4)),
+            (LZMA_PARALLEL_HEADER_SIZE + 4, struct.pack('<I', len(compressed))),
+            )
+        for offset, value in corruptions:
+            corrupted = compressed[:offset] + value + compressed[offset + len(value):]
+            self.WriteTmpFile('corrupted', corrupted)
+            result = self.RunTool(
+                '-d', '--chunked',
+                '-o', self.GetTmpFilePath('output2'),
+                self.GetTmpFilePath('corrupted')
+                )
+            self.assertTrue(result != 0)
+
+TheTestSuite = TestTools.MakeTheTestSuite(locals())
+
+if __name__ == '__main__':
+    allTests = TheTestSuite()
+    unittest.TextTestRunner().run(allTests)
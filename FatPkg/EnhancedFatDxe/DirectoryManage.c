@@ -1,7 +1,7 @@
 /** @file
   Functions for performing directory entry io.
 
-Copyright (c) 2005 - 2015, Intel Corporation. All rights reserved.<BR>
+Copyright (c) 2005 - 2026, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
@@ -1234,6 +1234,10 @@ FatCloseDirEnt (
     RemoveEntryList (&OFile->ChildLink);
   }
 
+  if (OFile->Extents != NULL) {
+    FreePool (OFile->Extents);
+  }
+
   FreePool (OFile);
   DirEnt->OFile = NULL;
   if (DirEnt->Invalid == TRUE) {
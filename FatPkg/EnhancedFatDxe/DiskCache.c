@@ -1,7 +1,7 @@
 /** @file
   Cache implementation for EFI FAT File system driver.
 
-Copyright (c) 2005 - 2013, Intel Corporation. All rights reserved.<BR>
+Copyright (c) 2005 - 2026, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
@@ -210,7 +210,7 @@ CacheFatDiskIo (
 
 /**
 
-  This function is used by the Data Cache.
+  This function is used when the disk is accessed directly, bypassing the cache.
 
   When this function is called by write command, all entries in this range
   are older than the contents in disk, so they are invalid; just mark them invalid.
@@ -220,21 +220,23 @@ CacheFatDiskIo (
   than the info in the cache; So need to update the relative info in the Buffer.
 
   @param  Volume                - FAT file system volume.
+  @param  CacheDataType         - The type of cache: CacheData or CacheFat.
   @param  IoMode                - This function is called by read command or write command
   @param  StartPageNo           - First PageNo to be checked in the cache.
   @param  EndPageNo             - Last PageNo to be checked in the cache.
   @param  Buffer                - The user buffer need to update. Only when doing the read command
                           and there is dirty cache in the cache range, this parameter will be used.
+                          It holds whole pages from StartPageNo.
 
 **/
-STATIC
 VOID
-FatFlushDataCacheRange (
-  IN  FAT_VOLUME  *Volume,
-  IN  IO_MODE     IoMode,
-  IN  UINTN       StartPageNo,
-  IN  UINTN       EndPageNo,
-  OUT UINT8       *Buffer
+FatFlushCacheRange (
+  IN  FAT_VOLUME       *Volume,
+  IN  CACHE_DATA_TYPE  CacheDataType,
+  IN  IO_MODE          IoMode,
+  IN  UINTN            StartPageNo,
+  IN  UINTN            EndPageNo,
+  OUT UINT8            *Buffer
   )
 {
   UINTN       PageNo;
@@ -246,7 +248,7 @@ FatFlushDataCacheRange (
   CACHE_TAG   *CacheTag;
   UINT8       *BaseAddress;
 
-  DiskCache     = &Volume->DiskCache[CacheData];
+  DiskCache     = &Volume->DiskCache[CacheDataType];
   BaseAddress   = DiskCache->CacheBase;
   GroupMask     = DiskCache->GroupMask;
   PageAlignment = DiskCache->PageAlignment;
@@ -544,12 +546,20 @@ FatAccessCache (
   //
   // The access of the Aligned data
   //
-  if (AlignedPageCount > 0) {
+  if ((AlignedPageCount > 0) && (CacheDataType == CacheFat)) {
     //
-    // Accessing fat table cannot have alignment data
+    // The fat table is always accessed through the cache, page by page
     //
-    ASSERT (CacheDataType == CacheData);
+    for ( ; PageNo < OverRunPageNo; PageNo++) {
+      Status = FatAccessUnalignedCachePage (Volume, CacheDataType, IoMode, PageNo, 0, PageSize, Buffer);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
 
+      Buffer     += PageSize;
+      BufferSize -= PageSize;
+    }
+  } else if (AlignedPageCount > 0) {
     EntryPos    = Volume->RootPos + LShiftU64 (PageNo, PageAlignment);
     AlignedSize = AlignedPageCount << PageAlignment;
     Status      = FatDiskIo (Volume, IoMode, EntryPos, AlignedSize, Buffer, Task);
@@ -561,7 +571,7 @@ FatAccessCache (
     // If these access data over laps the relative cache range, these cache pages need
     // to be updated.
     //
-    FatFlushDataCacheRange (Volume, IoMode, PageNo, OverRunPageNo, Buffer);
+    FatFlushCacheRange (Volume, CacheData, IoMode, PageNo, OverRunPageNo, Buffer);
     Buffer     += AlignedSize;
     BufferSize -= AlignedSize;
   }
@@ -1,7 +1,7 @@
 /** @file
   Main header file for EFI FAT file system driver.
 
-Copyright (c) 2005 - 2013, Intel Corporation. All rights reserved.<BR>
+Copyright (c) 2005 - 2026, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
@@ -118,6 +118,12 @@ STATIC_ASSERT ((((1 << FAT_DATACACHE_PAGE_MAX_ALIGNMENT) / (1 << MIN_BLOCK_ALIGN
 
 #define FAT_MAX_DIR_CACHE_COUNT  8
 #define FAT_MAX_DIRENTRY_COUNT   0xFFFF
+
+//
+// Initial and maximum number of entries in an OFile's extent map
+//
+#define FAT_EXTENT_MIN_COUNT  16
+#define FAT_EXTENT_MAX_COUNT  0x1000
 typedef CHAR8 LC_ISO_639_2;
 
 //
@@ -201,6 +207,15 @@ struct _FAT_DIRENT {
   FAT_DIRECTORY_ENTRY    Entry;                 // The physical directory entry stored in disk
 };
 
+//
+// A run of physically consecutive clusters in a file's cluster chain
+//
+typedef struct {
+  UINTN    FileCluster;                       // Index of the first cluster of the run within the file
+  UINTN    Cluster;                           // The first cluster of the run on the disk
+  UINTN    Length;                            // The number of clusters in the run
+} FAT_EXTENT;
+
 struct _FAT_ODIR {
   UINTN         Signature;
   UINT32        CurrentEndPos;                // Current end position of the directory
@@ -267,6 +282,16 @@ struct _FAT_OFILE {
   UINTN         FileCurrentCluster;
   UINTN         FileLastCluster;
 
+  //
+  // The extent map of the cluster chain, filled in as the chain
+  // is walked. It covers the first ExtentClusters clusters of the
+  // file, so a position inside them is found without reading the FAT
+  //
+  FAT_EXTENT    *Extents;
+  UINTN         ExtentCount;
+  UINTN         ExtentMax;
+  UINTN         ExtentClusters;
+
   //
   // Dirty is set if there have been any updates to the
   // file
@@ -349,6 +374,7 @@ struct _FAT_VOLUME {
   FAT_INFO_SECTOR                    FatInfoSector;  // Free cluster info
   UINTN                              FreeInfoPos;    // Pos with the free cluster info
   BOOLEAN                            FreeInfoValid;  // If free cluster info is valid
+  UINTN                              *FreeClusterBitmap; // One bit set per free cluster, NULL if not built yet
   //
   // Unpacked Fat BPB info
   //
@@ -766,6 +792,37 @@ FatAccessCache (
   IN     FAT_TASK         *Task
   );
 
+/**
+
+  This function is used when the disk is accessed directly, bypassing the cache.
+
+  When this function is called by write command, all entries in this range
+  are older than the contents in disk, so they are invalid; just mark them invalid.
+
+  When this function is called by read command, if any entry in this range
+  is dirty, it means that the relative info directly read from media is older than
+  than the info in the cache; So need to update the relative info in the Buffer.
+
+  @param  Volume                - FAT file system volume.
+  @param  CacheDataType         - The type of cache: CacheData or CacheFat.
+  @param  IoMode                - This function is called by read command or write command
+  @param  StartPageNo           - First PageNo to be checked in the cache.
+  @param  EndPageNo             - Last PageNo to be checked in the cache.
+  @param  Buffer                - The user buffer need to update. Only when doing the read command
+                          and there is dirty cache in the cache range, this parameter will be used.
+                          It holds whole pages from StartPageNo.
+
+**/
+VOID
+FatFlushCacheRange (
+  IN  FAT_VOLUME       *Volume,
+  IN  CACHE_DATA_TYPE  CacheDataType,
+  IN  IO_MODE          IoMode,
+  IN  UINTN            StartPageNo,
+  IN  UINTN            EndPageNo,
+  OUT UINT8            *Buffer
+  );
+
 /**
 
   Flush all the dirty cache back, include the FAT cache and the Data cache.
@@ -910,6 +967,69 @@ FatGrowEof (
   IN UINT64     NewSizeInBytes
   );
 
+/**
+
+  Build the free cluster bitmap of the volume, if it is not built yet.
+
+  The FAT table is read directly from the disk in large blocks, the dirty pages
+  of the FAT cache replacing the stale data read. The free cluster info is
+  updated with the exact count of the free clusters.
+
+  @param  Volume                - FAT file system volume.
+
+  @retval EFI_SUCCESS           - The free cluster bitmap is built.
+  @retval EFI_OUT_OF_RESOURCES  - Not enough memory to build the bitmap.
+  @return other                 - An error occurred when reading the FAT table.
+
+**/
+EFI_STATUS
+FatBuildFreeClusterBitmap (
+  IN FAT_VOLUME  *Volume
+  );
+
+/**
+
+  Allocate a run of consecutive free clusters. The run follows the last
+  cluster of the file when possible, so that the file stays contiguous.
+
+  @param  Volume                - FAT file system volume.
+  @param  LastCluster           - The last cluster of the file, or FAT_CLUSTER_FREE.
+  @param  MaxCount              - The maximum number of clusters to allocate.
+  @param  Count                 - The number of clusters of the run.
+
+  @return The index of the first cluster of the run, or FAT_CLUSTER_LAST if
+          there is no free cluster.
+
+**/
+UINTN
+FatAllocateClusterRun (
+  IN  FAT_VOLUME  *Volume,
+  IN  UINTN       LastCluster,
+  IN  UINTN       MaxCount,
+  OUT UINTN       *Count
+  );
+
+/**
+
+  Set the FAT entries of a run of consecutive clusters, so that they make a
+  cluster chain terminated by FAT_CLUSTER_LAST. The entries are written in
+  blocks through the FAT cache.
+
+  @param  Volume                - FAT file system volume.
+  @param  Cluster               - The first cluster of the run.
+  @param  Count                 - The number of clusters of the run.
+
+  @retval EFI_SUCCESS           - The cluster chain is set successfully.
+  @return other                 - An error occurred when operation the FAT entries.
+
+**/
+EFI_STATUS
+FatSetFatChain (
+  IN FAT_VOLUME  *Volume,
+  IN UINTN       Cluster,
+  IN UINTN       Count
+  );
+
 /**
 
   Get the size of directory of the open file.
@@ -1,7 +1,7 @@
 /** @file
   Routines dealing with disk spaces and FAT table entries.
 
-Copyright (c) 2005 - 2013, Intel Corporation. All rights reserved.<BR>
+Copyright (c) 2005 - 2026, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
 
@@ -10,6 +10,22 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "Fat.h"
 
+//
+// Number of clusters in one word of the free cluster bitmap
+//
+#define FAT_BITMAP_WORD_BITS  (sizeof (UINTN) * 8)
+
+//
+// Size of the reads of the FAT table that build the free cluster bitmap.
+// It is a multiple of the FAT cache page size.
+//
+#define FAT_BITMAP_SCAN_SIZE  SIZE_1MB
+
+//
+// Number of FAT entries written at once to allocate a cluster chain
+//
+#define FAT_CHAIN_ENTRY_COUNT  128
+
 /**
 
   Get the FAT entry of the volume, which is identified with the Index.
@@ -122,6 +138,284 @@ FatGetFatEntry (
   return Accum;
 }
 
+/**
+
+  Check whether a cluster is free in the free cluster bitmap.
+
+  @param  Volume                - FAT file system volume.
+  @param  Cluster               - The cluster index.
+
+  @retval TRUE                  - The cluster is free.
+  @retval FALSE                 - The cluster is used or out of the volume.
+
+**/
+STATIC
+BOOLEAN
+FatIsClusterFree (
+  IN FAT_VOLUME  *Volume,
+  IN UINTN       Cluster
+  )
+{
+  ASSERT (Volume->FreeClusterBitmap != NULL);
+
+  if ((Cluster < FAT_MIN_CLUSTER) || (Cluster > (Volume->MaxCluster + 1))) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)((Volume->FreeClusterBitmap[Cluster / FAT_BITMAP_WORD_BITS] &
+                    ((UINTN)1 << (Cluster % FAT_BITMAP_WORD_BITS))) != 0);
+}
+
+/**
+
+  Update a cluster in the free cluster bitmap, if it is built.
+
+  @param  Volume                - FAT file system volume.
+  @param  Cluster               - The cluster index.
+  @param  Free                  - TRUE if the cluster is now free.
+
+**/
+STATIC
+VOID
+FatSetClusterFree (
+  IN FAT_VOLUME  *Volume,
+  IN UINTN       Cluster,
+  IN BOOLEAN     Free
+  )
+{
+  UINTN  Mask;
+
+  if ((Volume->FreeClusterBitmap == NULL) ||
+      (Cluster < FAT_MIN_CLUSTER) || (Cluster > (Volume->MaxCluster + 1)))
+  {
+    return;
+  }
+
+  Mask = (UINTN)1 << (Cluster % FAT_BITMAP_WORD_BITS);
+  if (Free) {
+    Volume->FreeClusterBitmap[Cluster / FAT_BITMAP_WORD_BITS] |= Mask;
+  } else {
+    Volume->FreeClusterBitmap[Cluster / FAT_BITMAP_WORD_BITS] &= ~Mask;
+  }
+}
+
+/**
+
+  Find the first free cluster from the cluster index, in the free cluster bitmap.
+
+  @param  Volume                - FAT file system volume.
+  @param  Cluster               - The cluster index to start from.
+
+  @return The index of the free cluster, or FAT_CLUSTER_LAST if there is no
+          free cluster from the index.
+
+**/
+STATIC
+UINTN
+FatFindFreeCluster (
+  IN FAT_VOLUME  *Volume,
+  IN UINTN       Cluster
+  )
+{
+  UINTN  Word;
+  UINTN  LastWord;
+  UINTN  Bits;
+
+  ASSERT (Volume->FreeClusterBitmap != NULL);
+
+  if (Cluster > (Volume->MaxCluster + 1)) {
+    return (UINTN)FAT_CLUSTER_LAST;
+  }
+
+  Word     = Cluster / FAT_BITMAP_WORD_BITS;
+  LastWord = (Volume->MaxCluster + 1) / FAT_BITMAP_WORD_BITS;
+  Bits     = Volume->FreeClusterBitmap[Word] & ((UINTN)-1 << (Cluster % FAT_BITMAP_WORD_BITS));
+  while (Bits == 0) {
+    if (Word == LastWord) {
+      return (UINTN)FAT_CLUSTER_LAST;
+    }
+
+    Bits = Volume->FreeClusterBitmap[++Word];
+  }
+
+  //
+  // The bits past the last cluster are never set
+  //
+  return Word * FAT_BITMAP_WORD_BITS + (UINTN)LowBitSet64 (Bits);
+}
+
+/**
+
+  Build the free cluster bitmap of the volume, if it is not built yet.
+
+  The FAT table is read directly from the disk in large blocks, the dirty pages
+  of the FAT cache replacing the stale data read. The free cluster info is
+  updated with the exact count of the free clusters.
+
+  @param  Volume                - FAT file system volume.
+
+  @retval EFI_SUCCESS           - The free cluster bitmap is built.
+  @retval EFI_OUT_OF_RESOURCES  - Not enough memory to build the bitmap.
+  @return other                 - An error occurred when reading the FAT table.
+
+**/
+EFI_STATUS
+FatBuildFreeClusterBitmap (
+  IN FAT_VOLUME  *Volume
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       *Bitmap;
+  UINT8       *Buffer;
+  UINTN       ClusterCount;
+  UINTN       FatBytes;
+  UINTN       Offset;
+  UINTN       Length;
+  UINTN       Cluster;
+  UINTN       Limit;
+  UINTN       Pos;
+  UINTN       Accum;
+  UINTN       FreeCount;
+  UINT8       PageAlignment;
+
+  if (Volume->FreeClusterBitmap != NULL) {
+    return EFI_SUCCESS;
+  }
+
+  if (Volume->DiskError) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  //
+  // Compute the size of the FAT table holding the entries of the clusters
+  //
+  ClusterCount = Volume->MaxCluster + 2;
+  switch (Volume->FatType) {
+    case Fat12:
+      FatBytes = FAT_POS_FAT12 (ClusterCount) + 1;
+      break;
+
+    case Fat16:
+      FatBytes = FAT_POS_FAT16 (ClusterCount);
+      break;
+
+    default:
+      FatBytes = FAT_POS_FAT32 (ClusterCount);
+  }
+
+  if (FatBytes > Volume->FatSize) {
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  Bitmap = AllocateZeroPool ((ClusterCount + FAT_BITMAP_WORD_BITS - 1) / FAT_BITMAP_WORD_BITS * sizeof (UINTN));
+  Buffer = AllocatePool (FAT_BITMAP_SCAN_SIZE);
+  if ((Bitmap == NULL) || (Buffer == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Done;
+  }
+
+  Status        = EFI_SUCCESS;
+  PageAlignment = Volume->DiskCache[CacheFat].PageAlignment;
+  FreeCount     = 0;
+  Cluster       = FAT_MIN_CLUSTER;
+  for (Offset = 0; Offset < FatBytes; Offset += Length) {
+    Length = MIN (FAT_BITMAP_SCAN_SIZE, FatBytes - Offset);
+    Status = FatDiskIo (Volume, ReadDisk, Volume->FatPos + Offset, Length, Buffer, NULL);
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+
+    FatFlushCacheRange (
+      Volume,
+      CacheFat,
+      ReadDisk,
+      Offset >> PageAlignment,
+      (Offset + Length + ((UINTN)1 << PageAlignment) - 1) >> PageAlignment,
+      Buffer
+      );
+
+    //
+    // FAT12 tables always fit in one read, the entries of the other FAT types
+    // never cross reads.
+    //
+    switch (Volume->FatType) {
+      case Fat12:
+        ASSERT (Length == FatBytes);
+        Limit = ClusterCount;
+        break;
+
+      case Fat16:
+        Limit = MIN (ClusterCount, (Offset + Length) / sizeof (UINT16));
+        break;
+
+      default:
+        Limit = MIN (ClusterCount, (Offset + Length) / sizeof (UINT32));
+    }
+
+    for ( ; Cluster < Limit; Cluster++) {
+      switch (Volume->FatType) {
+        case Fat12:
+          Pos   = FAT_POS_FAT12 (Cluster) - Offset;
+          Accum = Buffer[Pos] | (Buffer[Pos + 1] << 8);
+          Accum = FAT_ODD_CLUSTER_FAT12 (Cluster) ? (Accum >> 4) : (Accum & FAT_CLUSTER_MASK_FAT12);
+          break;
+
+        case Fat16:
+          Pos   = FAT_POS_FAT16 (Cluster) - Offset;
+          Accum = *(UINT16 *)(Buffer + Pos);
+          break;
+
+        default:
+          Pos   = FAT_POS_FAT32 (Cluster) - Offset;
+          Accum = *(UINT32 *)(Buffer + Pos) & FAT_CLUSTER_MASK_FAT32;
+      }
+
+      if (Accum == FAT_CLUSTER_FREE) {
+        Bitmap[Cluster / FAT_BITMAP_WORD_BITS] |= (UINTN)1 << (Cluster % FAT_BITMAP_WORD_BITS);
+        FreeCount++;
+      }
+    }
+  }
+
+  Volume->FreeClusterBitmap                   = Bitmap;
+  Volume->FreeInfoValid                       = TRUE;
+  Volume->FatInfoSector.FreeInfo.ClusterCount = (UINT32)FreeCount;
+  Volume->FatInfoSector.Signature             = FAT_INFO_SIGNATURE;
+  Volume->FatInfoSector.InfoBeginSignature    = FAT_INFO_BEGIN_SIGNATURE;
+  Volume->FatInfoSector.InfoEndSignature      = FAT_INFO_END_SIGNATURE;
+  Bitmap                                      = NULL;
+
+Done:
+  if (Bitmap != NULL) {
+    FreePool (Bitmap);
+  }
+
+  if (Buffer != NULL) {
+    FreePool (Buffer);
+  }
+
+  return Status;
+}
+
+/**
+
+  Set the volume dirty bit, if it is not set yet, before the FAT entries are updated.
+
+  @param  Volume                - FAT file system volume.
+
+**/
+STATIC
+VOID
+FatMarkFatDirty (
+  IN FAT_VOLUME  *Volume
+  )
+{
+  if (!Volume->FatDirty && (Volume->FatType != Fat12)) {
+    Volume->FatDirty = TRUE;
+    FatAccessVolumeDirty (Volume, WriteFat, &Volume->DirtyValue);
+  }
+}
+
 /**
 
   Set the FAT entry value of the volume, which is identified with the Index.
@@ -161,10 +455,14 @@ FatSetFatEntry (
     if (Index < Volume->FatInfoSector.FreeInfo.NextCluster) {
       Volume->FatInfoSector.FreeInfo.NextCluster = (UINT32)Index;
     }
+
+    FatSetClusterFree (Volume, Index, TRUE);
   } else if ((Value != FAT_CLUSTER_FREE) && (OriginalVal == FAT_CLUSTER_FREE)) {
     if (Volume->FatInfoSector.FreeInfo.ClusterCount != 0) {
       Volume->FatInfoSector.FreeInfo.ClusterCount -= 1;
     }
+
+    FatSetClusterFree (Volume, Index, FALSE);
   }
 
   //
@@ -204,10 +502,7 @@ FatSetFatEntry (
   //
   // If the volume's dirty bit is not set, set it now
   //
-  if (!Volume->FatDirty && (Volume->FatType != Fat12)) {
-    Volume->FatDirty = TRUE;
-    FatAccessVolumeDirty (Volume, WriteFat, &Volume->DirtyValue);
-  }
+  FatMarkFatDirty (Volume);
 
   //
   // Write the updated fat entry value to the volume
@@ -225,6 +520,107 @@ FatSetFatEntry (
   return Status;
 }
 
+/**
+
+  Set the FAT entries of a run of consecutive clusters, so that they make a
+  cluster chain terminated by FAT_CLUSTER_LAST. The entries are written in
+  blocks through the FAT cache.
+
+  @param  Volume                - FAT file system volume.
+  @param  Cluster               - The first cluster of the run.
+  @param  Count                 - The number of clusters of the run.
+
+  @retval EFI_SUCCESS           - The cluster chain is set successfully.
+  @return other                 - An error occurred when operation the FAT entries.
+
+**/
+EFI_STATUS
+FatSetFatChain (
+  IN FAT_VOLUME  *Volume,
+  IN UINTN       Cluster,
+  IN UINTN       Count
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      Entries[FAT_CHAIN_ENTRY_COUNT];
+  UINT16      *En16;
+  UINT32      *En32;
+  UINTN       EntrySize;
+  UINTN       Length;
+  UINTN       Index;
+  UINTN       Value;
+  UINT64      Pos;
+
+  ASSERT ((Cluster >= FAT_MIN_CLUSTER) && (Count != 0) && (Cluster + Count - 1 <= Volume->MaxCluster + 1));
+
+  //
+  // FAT12 entries share bytes, set them one by one
+  //
+  if (Volume->FatType == Fat12) {
+    for (Index = 0; Index < Count; Index++) {
+      Value  = (Index + 1 < Count) ? (Cluster + Index + 1) : (UINTN)FAT_CLUSTER_LAST;
+      Status = FatSetFatEntry (Volume, Cluster + Index, Value);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
+    return EFI_SUCCESS;
+  }
+
+  FatMarkFatDirty (Volume);
+
+  EntrySize = (Volume->FatType == Fat16) ? sizeof (UINT16) : sizeof (UINT32);
+  En16      = (UINT16 *)Entries;
+  En32      = Entries;
+  while (Count > 0) {
+    Length = MIN (Count, sizeof (Entries) / EntrySize);
+    Pos    = Volume->FatPos + Cluster * EntrySize;
+
+    //
+    // Read the entries first, to keep the reserved bits of the FAT32 entries
+    // and to update the free cluster info.
+    //
+    Status = FatDiskIo (Volume, ReadFat, Pos, Length * EntrySize, Entries, NULL);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    for (Index = 0; Index < Length; Index++) {
+      Value = (Index + 1 < Count) ? (Cluster + Index + 1) : (UINTN)FAT_CLUSTER_LAST;
+      if (Volume->FatType == Fat16) {
+        if (En16[Index] == FAT_CLUSTER_FREE) {
+          if (Volume->FatInfoSector.FreeInfo.ClusterCount != 0) {
+            Volume->FatInfoSector.FreeInfo.ClusterCount -= 1;
+          }
+        }
+
+        En16[Index] = (UINT16)Value;
+      } else {
+        if ((En32[Index] & FAT_CLUSTER_MASK_FAT32) == FAT_CLUSTER_FREE) {
+          if (Volume->FatInfoSector.FreeInfo.ClusterCount != 0) {
+            Volume->FatInfoSector.FreeInfo.ClusterCount -= 1;
+          }
+        }
+
+        En32[Index] = (En32[Index] & FAT_CLUSTER_UNMASK_FAT32) | (UINT32)(Value & FAT_CLUSTER_MASK_FAT32);
+      }
+
+      FatSetClusterFree (Volume, Cluster + Index, FALSE);
+    }
+
+    Status = FatDiskIo (Volume, WriteFat, Pos, Length * EntrySize, Entries, NULL);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Cluster += Length;
+    Count   -= Length;
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
 
   Free the cluster chain.
@@ -283,6 +679,22 @@ FatAllocateCluster (
     return (UINTN)FAT_CLUSTER_LAST;
   }
 
+  //
+  // Look up the free cluster bitmap, wrapping around to the first cluster
+  //
+  if (!EFI_ERROR (FatBuildFreeClusterBitmap (Volume))) {
+    Cluster = FatFindFreeCluster (Volume, Volume->FatInfoSector.FreeInfo.NextCluster);
+    if (FAT_END_OF_FAT_CHAIN (Cluster)) {
+      Cluster = FatFindFreeCluster (Volume, FAT_MIN_CLUSTER);
+    }
+
+    if (!FAT_END_OF_FAT_CHAIN (Cluster)) {
+      Volume->FatInfoSector.FreeInfo.NextCluster = (UINT32)(Cluster + 1);
+    }
+
+    return Cluster;
+  }
+
   for ( ; ;) {
     //
     // If the end of the list, return no available cluster
@@ -314,6 +726,66 @@ FatAllocateCluster (
   return Cluster;
 }
 
+/**
+
+  Allocate a run of consecutive free clusters. The run follows the last
+  cluster of the file when possible, so that the file stays contiguous.
+
+  @param  Volume                - FAT file system volume.
+  @param  LastCluster           - The last cluster of the file, or FAT_CLUSTER_FREE.
+  @param  MaxCount              - The maximum number of clusters to allocate.
+  @param  Count                 - The number of clusters of the run.
+
+  @return The index of the first cluster of the run, or FAT_CLUSTER_LAST if
+          there is no free cluster.
+
+**/
+UINTN
+FatAllocateClusterRun (
+  IN  FAT_VOLUME  *Volume,
+  IN  UINTN       LastCluster,
+  IN  UINTN       MaxCount,
+  OUT UINTN       *Count
+  )
+{
+  UINTN  Cluster;
+
+  *Count = 0;
+  if (Volume->DiskError) {
+    return (UINTN)FAT_CLUSTER_LAST;
+  }
+
+  //
+  // Without the free cluster bitmap, allocate the clusters one by one
+  //
+  if (EFI_ERROR (FatBuildFreeClusterBitmap (Volume))) {
+    Cluster = FatAllocateCluster (Volume);
+    if (!FAT_END_OF_FAT_CHAIN (Cluster)) {
+      *Count = 1;
+    }
+
+    return Cluster;
+  }
+
+  if ((LastCluster != FAT_CLUSTER_FREE) && FatIsClusterFree (Volume, LastCluster + 1)) {
+    Cluster = LastCluster + 1;
+  } else {
+    Cluster = FatAllocateCluster (Volume);
+    if (FAT_END_OF_FAT_CHAIN (Cluster)) {
+      return Cluster;
+    }
+  }
+
+  for (*Count = 1; *Count < MaxCount; (*Count)++) {
+    if (!FatIsClusterFree (Volume, Cluster + *Count)) {
+      break;
+    }
+  }
+
+  Volume->FatInfoSector.FreeInfo.NextCluster = (UINT32)(Cluster + *Count);
+  return Cluster;
+}
+
 /**
 
   Count the number of clusters given a size.
@@ -341,6 +813,157 @@ FatSizeToClusters (
   return Clusters;
 }
 
+/**
+
+  Extend the extent map of the open file by walking its cluster chain from
+  the end of the map, until the map covers the cluster ClusterIndex of the
+  file or the end of the cluster chain is reached.
+
+  @param  OFile                 - The open file.
+  @param  ClusterIndex          - The index of the cluster within the file.
+
+  @retval EFI_SUCCESS           - The extent map was extended.
+  @retval EFI_OUT_OF_RESOURCES  - The extent map can not grow any more.
+  @retval EFI_VOLUME_CORRUPTED  - Cluster chain corrupt.
+
+**/
+STATIC
+EFI_STATUS
+FatFillExtentMap (
+  IN FAT_OFILE  *OFile,
+  IN UINTN      ClusterIndex
+  )
+{
+  FAT_VOLUME  *Volume;
+  FAT_EXTENT  *Extent;
+  FAT_EXTENT  *NewExtents;
+  UINTN       NewMax;
+  UINTN       Cluster;
+
+  Volume  = OFile->Volume;
+  Extent  = NULL;
+  Cluster = OFile->FileCluster;
+  if (OFile->ExtentCount != 0) {
+    Extent  = &OFile->Extents[OFile->ExtentCount - 1];
+    Cluster = FatGetFatEntry (Volume, Extent->Cluster + Extent->Length - 1);
+  }
+
+  while ((OFile->ExtentClusters <= ClusterIndex) && !FAT_END_OF_FAT_CHAIN (Cluster)) {
+    if ((Cluster < FAT_MIN_CLUSTER) || (Cluster > Volume->MaxCluster + 1)) {
+      DEBUG ((DEBUG_INIT | DEBUG_ERROR, "FatFillExtentMap: cluster chain corrupt\n"));
+      return EFI_VOLUME_CORRUPTED;
+    }
+
+    if ((Extent != NULL) && (Extent->Cluster + Extent->Length == Cluster)) {
+      Extent->Length++;
+    } else {
+      if (OFile->ExtentCount == OFile->ExtentMax) {
+        if (OFile->ExtentMax >= FAT_EXTENT_MAX_COUNT) {
+          return EFI_OUT_OF_RESOURCES;
+        }
+
+        NewMax     = (OFile->ExtentMax == 0) ? FAT_EXTENT_MIN_COUNT : OFile->ExtentMax * 2;
+        NewExtents = ReallocatePool (
+                       OFile->ExtentMax * sizeof (FAT_EXTENT),
+                       NewMax * sizeof (FAT_EXTENT),
+                       OFile->Extents
+                       );
+        if (NewExtents == NULL) {
+          return EFI_OUT_OF_RESOURCES;
+        }
+
+        OFile->Extents   = NewExtents;
+        OFile->ExtentMax = NewMax;
+      }
+
+      Extent              = &OFile->Extents[OFile->ExtentCount++];
+      Extent->FileCluster = OFile->ExtentClusters;
+      Extent->Cluster     = Cluster;
+      Extent->Length      = 1;
+    }
+
+    OFile->ExtentClusters++;
+    Cluster = FatGetFatEntry (Volume, Cluster);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+
+  Find the extent in the extent map of the open file that holds the
+  cluster ClusterIndex of the file.
+
+  @param  OFile                 - The open file.
+  @param  ClusterIndex          - The index of the cluster within the file,
+                                  it must be covered by the extent map.
+
+  @return The index of the extent in OFile->Extents.
+
+**/
+STATIC
+UINTN
+FatFindExtent (
+  IN FAT_OFILE  *OFile,
+  IN UINTN      ClusterIndex
+  )
+{
+  UINTN  Low;
+  UINTN  High;
+  UINTN  Middle;
+
+  ASSERT (ClusterIndex < OFile->ExtentClusters);
+
+  Low  = 0;
+  High = OFile->ExtentCount;
+  while (High - Low > 1) {
+    Middle = (Low + High) / 2;
+    if (OFile->Extents[Middle].FileCluster <= ClusterIndex) {
+      Low = Middle;
+    } else {
+      High = Middle;
+    }
+  }
+
+  return Low;
+}
+
+/**
+
+  Drop the part of the extent map of the open file beyond the first
+  ClusterCount clusters of the file.
+
+  @param  OFile                 - The open file.
+  @param  ClusterCount          - The number of clusters to keep.
+
+**/
+STATIC
+VOID
+FatTrimExtentMap (
+  IN FAT_OFILE  *OFile,
+  IN UINTN      ClusterCount
+  )
+{
+  FAT_EXTENT  *Extent;
+
+  while ((OFile->ExtentCount != 0) &&
+         (OFile->Extents[OFile->ExtentCount - 1].FileCluster >= ClusterCount))
+  {
+    OFile->ExtentCount--;
+  }
+
+  if (OFile->ExtentCount != 0) {
+    Extent = &OFile->Extents[OFile->ExtentCount - 1];
+    if (Extent->FileCluster + Extent->Length > ClusterCount) {
+      Extent->Length = ClusterCount - Extent->FileCluster;
+    }
+  }
+
+  if (OFile->ExtentClusters > ClusterCount) {
+    OFile->ExtentClusters = ClusterCount;
+  }
+}
+
 /**
 
   Shrink the end of the open file base on the file size.
@@ -366,6 +989,7 @@ FatShrinkEof (
   ASSERT_VOLUME_LOCKED (Volume);
 
   NewSize = FatSizeToClusters (Volume, OFile->FileSize);
+  FatTrimExtentMap (OFile, NewSize);
 
   //
   // Find the address of the last cluster
@@ -439,6 +1063,7 @@ FatGrowEof (
   UINTN       LastCluster;
   UINTN       NewCluster;
   UINTN       ClusterCount;
+  UINTN       RunCount;
 
   //
   // For FAT file system, the max file is 4GB.
@@ -494,7 +1119,7 @@ FatGrowEof (
     LastCluster = OFile->FileLastCluster;
 
     while (CurSize < NewSize) {
-      NewCluster = FatAllocateCluster (Volume);
+      NewCluster = FatAllocateClusterRun (Volume, LastCluster, NewSize - CurSize, &RunCount);
       if (FAT_END_OF_FAT_CHAIN (NewCluster)) {
         if (LastCluster != FAT_CLUSTER_FREE) {
           FatSetFatEntry (Volume, LastCluster, (UINTN)FAT_CLUSTER_LAST);
@@ -505,11 +1130,27 @@ FatGrowEof (
         goto Done;
       }
 
-      if ((NewCluster < FAT_MIN_CLUSTER) || (NewCluster > Volume->MaxCluster + 1)) {
+      if ((NewCluster < FAT_MIN_CLUSTER) || (NewCluster + RunCount - 1 > Volume->MaxCluster + 1)) {
         Status = EFI_VOLUME_CORRUPTED;
         goto Done;
       }
 
+      //
+      // Chain the new clusters together and terminate the cluster list
+      //
+      // Note that we must do this EVERY time we allocate clusters, because
+      // FatAllocateClusterRun scans the FAT looking for free clusters and
+      // the new clusters are no longer free!  Usually, FatAllocateClusterRun
+      // will start looking with the cluster after "LastCluster"; however, when
+      // there are few free clusters left, it will find them a second time.
+      // There are other, less predictable scenarios where this could happen,
+      // as well.
+      //
+      Status = FatSetFatChain (Volume, NewCluster, RunCount);
+      if (EFI_ERROR (Status)) {
+        goto Done;
+      }
+
       if (LastCluster != 0) {
         FatSetFatEntry (Volume, LastCluster, NewCluster);
       } else {
@@ -517,21 +1158,8 @@ FatGrowEof (
         OFile->FileCurrentCluster = NewCluster;
       }
 
-      LastCluster = NewCluster;
-      CurSize    += 1;
-
-      //
-      // Terminate the cluster list
-      //
-      // Note that we must do this EVERY time we allocate a cluster, because
-      // FatAllocateCluster scans the FAT looking for a free cluster and
-      // "LastCluster" is no longer free!  Usually, FatAllocateCluster will
-      // start looking with the cluster after "LastCluster"; however, when
-      // there is only one free cluster left, it will find "LastCluster"
-      // a second time.  There are other, less predictable scenarios
-      // where this could happen, as well.
-      //
-      FatSetFatEntry (Volume, LastCluster, (UINTN)FAT_CLUSTER_LAST);
+      LastCluster            = NewCluster + RunCount - 1;
+      CurSize               += RunCount;
       OFile->FileLastCluster = LastCluster;
     }
   }
@@ -548,7 +1176,11 @@ Done:
 /**
 
   Seek OFile to requested position, and calculate the number of
-  consecutive clusters from the position in the file
+  consecutive clusters from the position in the file.
+
+  The position is looked up in the OFile's extent map, which is filled in
+  from the cluster chain as needed. If the map can not grow any more, the
+  cluster chain is walked instead.
 
   @param  OFile                 - The open file.
   @param  Position              - The file's position which will be accessed.
@@ -566,8 +1198,14 @@ FatOFilePosition (
   )
 {
   FAT_VOLUME  *Volume;
+  FAT_EXTENT  *Extent;
+  EFI_STATUS  Status;
   UINTN       ClusterSize;
   UINTN       Cluster;
+  UINTN       NextCluster;
+  UINTN       ClusterIndex;
+  UINTN       ExtentIndex;
+  UINTN       RunClusters;
   UINTN       StartPos;
   UINTN       Run;
 
@@ -584,33 +1222,85 @@ FatOFilePosition (
     OFile->PosDisk = Volume->RootPos + Position;
     Run            = OFile->FileSize - Position;
   } else {
-    //
-    // Run the file's cluster chain to find the current position
-    // If possible, run from the current cluster rather than
-    // start from beginning
-    // Assumption: OFile->Position is always consistent with
-    // OFile->FileCurrentCluster.
-    // OFile->Position is not modified outside this function;
-    // OFile->FileCurrentCluster is modified outside this function
-    // to be the same as OFile->FileCluster
-    // when OFile->FileCluster is updated, so make a check of this
-    // and invalidate the original OFile->Position in this case
-    //
-    Cluster  = OFile->FileCurrentCluster;
-    StartPos = OFile->Position;
-    if ((Position < StartPos) || (OFile->FileCluster == Cluster)) {
-      StartPos = 0;
-      Cluster  = OFile->FileCluster;
+    ClusterIndex = Position >> Volume->ClusterAlignment;
+    Status       = FatFillExtentMap (OFile, ClusterIndex);
+    if (Status == EFI_VOLUME_CORRUPTED) {
+      return Status;
     }
 
-    while (StartPos + ClusterSize <= Position) {
-      StartPos += ClusterSize;
-      if ((Cluster == FAT_CLUSTER_FREE) || (Cluster >= FAT_CLUSTER_SPECIAL)) {
+    if (!EFI_ERROR (Status)) {
+      if (ClusterIndex >= OFile->ExtentClusters) {
         DEBUG ((DEBUG_INIT | DEBUG_ERROR, "FatOFilePosition:" " cluster chain corrupt\n"));
         return EFI_VOLUME_CORRUPTED;
       }
 
-      Cluster = FatGetFatEntry (Volume, Cluster);
+      //
+      // The consecutive clusters of the position end with its extent,
+      // unless it is the last one in the map and the chain goes on.
+      // Fill in the map up to the end of this access in that case
+      //
+      ExtentIndex = FatFindExtent (OFile, ClusterIndex);
+      Extent      = &OFile->Extents[ExtentIndex];
+      RunClusters = Extent->FileCluster + Extent->Length - ClusterIndex;
+      if ((ExtentIndex == OFile->ExtentCount - 1) && (RunClusters <= (PosLimit >> Volume->ClusterAlignment) + 1)) {
+        FatFillExtentMap (OFile, ClusterIndex + (PosLimit >> Volume->ClusterAlignment) + 1);
+        Extent      = &OFile->Extents[ExtentIndex];
+        RunClusters = Extent->FileCluster + Extent->Length - ClusterIndex;
+      }
+
+      RunClusters = MIN (RunClusters, (PosLimit >> Volume->ClusterAlignment) + 2);
+      Cluster     = Extent->Cluster + ClusterIndex - Extent->FileCluster;
+      StartPos    = ClusterIndex << Volume->ClusterAlignment;
+      Run         = (RunClusters << Volume->ClusterAlignment) - (Position - StartPos);
+    } else {
+      //
+      // Run the file's cluster chain to find the current position
+      // If possible, run from the current cluster or the end of the
+      // extent map rather than start from beginning
+      // Assumption: OFile->Position is always consistent with
+      // OFile->FileCurrentCluster.
+      // OFile->Position is not modified outside this function;
+      // OFile->FileCurrentCluster is modified outside this function
+      // to be the same as OFile->FileCluster
+      // when OFile->FileCluster is updated, so make a check of this
+      // and invalidate the original OFile->Position in this case
+      //
+      Cluster  = OFile->FileCurrentCluster;
+      StartPos = OFile->Position;
+      if ((Position < StartPos) || (OFile->FileCluster == Cluster)) {
+        StartPos = 0;
+        Cluster  = OFile->FileCluster;
+      }
+
+      if ((OFile->ExtentClusters != 0) &&
+          (((OFile->ExtentClusters - 1) << Volume->ClusterAlignment) > StartPos))
+      {
+        Extent   = &OFile->Extents[OFile->ExtentCount - 1];
+        StartPos = (OFile->ExtentClusters - 1) << Volume->ClusterAlignment;
+        Cluster  = Extent->Cluster + Extent->Length - 1;
+      }
+
+      while (StartPos + ClusterSize <= Position) {
+        StartPos += ClusterSize;
+        if ((Cluster == FAT_CLUSTER_FREE) || (Cluster >= FAT_CLUSTER_SPECIAL)) {
+          DEBUG ((DEBUG_INIT | DEBUG_ERROR, "FatOFilePosition:" " cluster chain corrupt\n"));
+          return EFI_VOLUME_CORRUPTED;
+        }
+
+        Cluster = FatGetFatEntry (Volume, Cluster);
+      }
+
+      //
+      // Compute the number of consecutive clusters in the file
+      //
+      Run = StartPos + ClusterSize - Position;
+      if (!FAT_END_OF_FAT_CHAIN (Cluster)) {
+        NextCluster = Cluster;
+        while ((FatGetFatEntry (Volume, NextCluster) == NextCluster + 1) && Run < PosLimit) {
+          Run         += ClusterSize;
+          NextCluster += 1;
+        }
+      }
     }
 
     if ((Cluster < FAT_MIN_CLUSTER) || (Cluster > Volume->MaxCluster + 1)) {
@@ -622,17 +1312,6 @@ FatOFilePosition (
                      Position - StartPos;
     OFile->FileCurrentCluster = Cluster;
     OFile->Position           = StartPos;
-
-    //
-    // Compute the number of consecutive clusters in the file
-    //
-    Run = StartPos + ClusterSize - Position;
-    if (!FAT_END_OF_FAT_CHAIN (Cluster)) {
-      while ((FatGetFatEntry (Volume, Cluster) == Cluster + 1) && Run < PosLimit) {
-        Run     += ClusterSize;
-        Cluster += 1;
-      }
-    }
   }
 
   OFile->PosRem = Run;
@@ -722,11 +1401,24 @@ FatComputeFreeInfo (
   )
 {
   UINTN  Index;
+  UINTN  Cluster;
 
   //
   // If we don't have valid info, compute it now
   //
   if (!Volume->FreeInfoValid) {
+    //
+    // Building the free cluster bitmap counts the free clusters as well
+    //
+    if (!EFI_ERROR (FatBuildFreeClusterBitmap (Volume))) {
+      Cluster = FatFindFreeCluster (Volume, FAT_MIN_CLUSTER);
+      if (!FAT_END_OF_FAT_CHAIN (Cluster)) {
+        Volume->FatInfoSector.FreeInfo.NextCluster = (UINT32)Cluster;
+      }
+
+      return;
+    }
+
     Volume->FreeInfoValid                       = TRUE;
     Volume->FatInfoSector.FreeInfo.ClusterCount = 0;
     for (Index = Volume->MaxCluster + 1; Index >= FAT_MIN_CLUSTER; Index--) {
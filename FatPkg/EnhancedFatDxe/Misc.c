@@ -1,7 +1,7 @@
 /** @file
   Miscellaneous functions.
 
-Copyright (c) 2005 - 2018, Intel Corporation. All rights reserved.<BR>
+Copyright (c) 2005 - 2026, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
 
@@ -468,6 +468,13 @@ FatFreeVolume (
     FreePool (Volume->CacheBuffer);
   }
 
+  //
+  // Free free cluster bitmap
+  //
+  if (Volume->FreeClusterBitmap != NULL) {
+    FreePool (Volume->FreeClusterBitmap);
+  }
+
   //
   // Free directory cache
   //
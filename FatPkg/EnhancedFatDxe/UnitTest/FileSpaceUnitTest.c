@@ -0,0 +1,1286 @@
+/** @file
+  Unit tests of the cluster allocation of the FAT file system driver.
+
+  The FAT routines run over an in-memory image holding the FAT tables, and
+  access it through the FAT cache of DiskCache.c the same way the driver does.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <time.h>
+
+#include "../Fat.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_APP_NAME     "FAT File Space Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+//
+// Layout of the in-memory image: the FAT tables start at TEST_FAT_POS and
+// are followed by TEST_DATA_SIZE bytes of the data area. The data of the
+// files is never accessed by the tests.
+//
+#define TEST_FAT_POS            0x4000
+#define TEST_DATA_SIZE          SIZE_64KB
+#define TEST_BLOCK_SIZE         512
+#define TEST_CLUSTER_ALIGNMENT  12
+
+#define TEST_FILE_COUNT         16
+#define TEST_GROW_SHRINK_STEPS  5000
+
+//
+// Size of the volume and of the file of the large file benchmark.
+//
+#define TEST_LARGE_CLUSTER_COUNT  0x800000
+#define TEST_LARGE_FILE_SIZE      SIZE_1GB
+#define TEST_LARGE_GROW_STEP      SIZE_64KB
+
+//
+// Number of runs of consecutive clusters of the fragmented file, more than
+// the extent map holds, and number of positions looked up in each step.
+//
+#define TEST_FRAGMENT_COUNT  (FAT_EXTENT_MAX_COUNT + FAT_EXTENT_MAX_COUNT / 2)
+#define TEST_SEEK_COUNT      2000
+
+typedef struct {
+  FAT_VOLUME_TYPE    FatType;
+  UINTN              ClusterCount;
+} TEST_VOLUME_CONTEXT;
+
+STATIC TEST_VOLUME_CONTEXT  mFat12Context = { Fat12, 4000 };
+STATIC TEST_VOLUME_CONTEXT  mFat16Context = { Fat16, 60000 };
+STATIC TEST_VOLUME_CONTEXT  mFat32Context = { Fat32, 200000 };
+
+EFI_LOCK  FatFsLock;
+
+STATIC UINT8   *mImage;
+STATIC UINT64  mDeviceReads;
+STATIC UINT64  mDeviceWrites;
+
+STATIC EFI_BLOCK_IO_MEDIA  mMedia = {
+  .BlockSize = TEST_BLOCK_SIZE
+};
+
+/**
+  Flush the in-memory device, there is nothing to do.
+
+  @param  This       Indicates a pointer to the calling context.
+
+  @retval EFI_SUCCESS   Always.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestFlushBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL  *This
+  )
+{
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_BLOCK_IO_PROTOCOL  mBlockIo = {
+  .Media       = &mMedia,
+  .FlushBlocks = TestFlushBlocks
+};
+
+/**
+  Access the in-memory image, or the FAT cache, in place of FatDiskIo () of
+  Misc.c. The tasks are not supported.
+
+  @param  Volume                - FAT file system volume.
+  @param  IoMode                - The access mode (disk read/write or cache access).
+  @param  Offset                - The starting byte offset to read from.
+  @param  BufferSize            - Size of Buffer.
+  @param  Buffer                - Buffer containing read data.
+  @param  Task                    point to task instance.
+
+  @retval EFI_SUCCESS           - The operation is performed successfully.
+  @retval EFI_VOLUME_CORRUPTED  - The access is out of the volume.
+**/
+EFI_STATUS
+FatDiskIo (
+  IN     FAT_VOLUME  *Volume,
+  IN     IO_MODE     IoMode,
+  IN     UINT64      Offset,
+  IN     UINTN       BufferSize,
+  IN OUT VOID        *Buffer,
+  IN     FAT_TASK    *Task
+  )
+{
+  ASSERT (Task == NULL);
+
+  if (Offset + BufferSize > Volume->VolumeSize) {
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  if (CACHE_ENABLED (IoMode)) {
+    return FatAccessCache (Volume, CACHE_TYPE (IoMode), RAW_ACCESS (IoMode), Offset, BufferSize, Buffer, Task);
+  }
+
+  if (IoMode == ReadDisk) {
+    mDeviceReads++;
+    CopyMem (Buffer, mImage + Offset, BufferSize);
+  } else {
+    mDeviceWrites++;
+    CopyMem (mImage + Offset, Buffer, BufferSize);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Set the volume as dirty or not, in place of FatAccessVolumeDirty () of
+  Misc.c. The dirty bit is not tested.
+
+  @param  Volume                - FAT file system volume.
+  @param  IoMode                - The access mode.
+  @param  DirtyValue            - Set the volume as dirty or not.
+
+  @retval EFI_SUCCESS           - Always.
+**/
+EFI_STATUS
+FatAccessVolumeDirty (
+  IN FAT_VOLUME  *Volume,
+  IN IO_MODE     IoMode,
+  IN VOID        *DirtyValue
+  )
+{
+  return EFI_SUCCESS;
+}
+
+/**
+  Get the end of chain value of the FAT entries of the volume.
+
+  @param  Volume    The volume.
+
+  @return The value FatSetFatEntry () writes for FAT_CLUSTER_LAST.
+**/
+STATIC
+UINTN
+TestEndOfChain (
+  IN FAT_VOLUME  *Volume
+  )
+{
+  switch (Volume->FatType) {
+    case Fat12:
+      return FAT_CLUSTER_MASK_FAT12;
+
+    case Fat16:
+      return MAX_UINT16;
+
+    default:
+      return FAT_CLUSTER_MASK_FAT32;
+  }
+}
+
+/**
+  Read an entry of the first FAT table from the image.
+
+  @param  Volume    The volume.
+  @param  Cluster   The cluster index.
+
+  @return The value of the entry, without the reserved bits of FAT32.
+**/
+STATIC
+UINTN
+TestGetEntry (
+  IN FAT_VOLUME  *Volume,
+  IN UINTN       Cluster
+  )
+{
+  UINT8  *Fat;
+  UINTN  Value;
+
+  Fat = mImage + Volume->FatPos;
+  switch (Volume->FatType) {
+    case Fat12:
+      Value = Fat[FAT_POS_FAT12 (Cluster)] | (Fat[FAT_POS_FAT12 (Cluster) + 1] << 8);
+      return FAT_ODD_CLUSTER_FAT12 (Cluster) ? (Value >> 4) : (Value & FAT_CLUSTER_MASK_FAT12);
+
+    case Fat16:
+      return *(UINT16 *)(Fat + FAT_POS_FAT16 (Cluster));
+
+    default:
+      return *(UINT32 *)(Fat + FAT_POS_FAT32 (Cluster)) & FAT_CLUSTER_MASK_FAT32;
+  }
+}
+
+/**
+  Write an entry of the first FAT table in the image.
+
+  @param  Volume    The volume.
+  @param  Cluster   The cluster index.
+  @param  Value     The new value of the entry. The reserved bits of FAT32 are
+                    written too.
+**/
+STATIC
+VOID
+TestSetEntry (
+  IN FAT_VOLUME  *Volume,
+  IN UINTN       Cluster,
+  IN UINTN       Value
+  )
+{
+  UINT8   *Fat;
+  UINT16  *Entry12;
+
+  Fat = mImage + Volume->FatPos;
+  switch (Volume->FatType) {
+    case Fat12:
+      Entry12 = (UINT16 *)(Fat + FAT_POS_FAT12 (Cluster));
+      if (FAT_ODD_CLUSTER_FAT12 (Cluster)) {
+        *Entry12 = (UINT16)((*Entry12 & 0x000F) | (Value << 4));
+      } else {
+        *Entry12 = (UINT16)((*Entry12 & FAT_CLUSTER_UNMASK_FAT12) | (Value & FAT_CLUSTER_MASK_FAT12));
+      }
+
+      break;
+
+    case Fat16:
+      *(UINT16 *)(Fat + FAT_POS_FAT16 (Cluster)) = (UINT16)Value;
+      break;
+
+    default:
+      *(UINT32 *)(Fat + FAT_POS_FAT32 (Cluster)) = (UINT32)Value;
+  }
+}
+
+/**
+  Check whether a cluster is free in the free cluster bitmap of the volume.
+
+  @param  Volume    The volume.
+  @param  Cluster   The cluster index.
+
+  @retval TRUE      The bit of the cluster is set.
+  @retval FALSE     The bit of the cluster is clear.
+**/
+STATIC
+BOOLEAN
+TestIsFreeInBitmap (
+  IN FAT_VOLUME  *Volume,
+  IN UINTN       Cluster
+  )
+{
+  UINTN  WordBits;
+
+  WordBits = sizeof (UINTN) * 8;
+  return (BOOLEAN)((Volume->FreeClusterBitmap[Cluster / WordBits] & ((UINTN)1 << (Cluster % WordBits))) != 0);
+}
+
+/**
+  Create a volume over a new, empty, in-memory image. Only the first cluster,
+  the root directory, is used.
+
+  @param  FatType        The FAT type of the volume.
+  @param  ClusterCount   The number of clusters of the volume.
+
+  @return The volume, or NULL if there is not enough memory.
+**/
+STATIC
+FAT_VOLUME *
+TestCreateVolume (
+  IN FAT_VOLUME_TYPE  FatType,
+  IN UINTN            ClusterCount
+  )
+{
+  FAT_VOLUME  *Volume;
+  UINTN       FatBytes;
+
+  Volume = AllocateZeroPool (sizeof (FAT_VOLUME));
+  if (Volume == NULL) {
+    return NULL;
+  }
+
+  switch (FatType) {
+    case Fat12:
+      FatBytes = FAT_POS_FAT12 (ClusterCount + 2) + 1;
+      break;
+
+    case Fat16:
+      FatBytes = FAT_POS_FAT16 (ClusterCount + 2);
+      break;
+
+    default:
+      FatBytes = FAT_POS_FAT32 (ClusterCount + 2);
+  }
+
+  Volume->BlockIo          = &mBlockIo;
+  Volume->FatType          = FatType;
+  Volume->FatEntrySize     = (FatType == Fat32) ? sizeof (UINT32) : sizeof (UINT16);
+  Volume->NumFats          = 2;
+  Volume->MaxCluster       = ClusterCount - 1;
+  Volume->FatPos           = TEST_FAT_POS;
+  Volume->FatSize          = ALIGN_VALUE (FatBytes, TEST_BLOCK_SIZE);
+  Volume->RootPos          = Volume->FatPos + Volume->NumFats * Volume->FatSize;
+  Volume->FirstClusterPos  = Volume->RootPos;
+  Volume->VolumeSize       = Volume->RootPos + TEST_DATA_SIZE;
+  Volume->ClusterSize      = (UINTN)1 << TEST_CLUSTER_ALIGNMENT;
+  Volume->ClusterAlignment = TEST_CLUSTER_ALIGNMENT;
+
+  Volume->FatInfoSector.FreeInfo.NextCluster = FAT_MIN_CLUSTER;
+
+  mImage = AllocateZeroPool ((UINTN)Volume->VolumeSize);
+  if ((mImage == NULL) || EFI_ERROR (FatInitializeDiskCache (Volume))) {
+    if (mImage != NULL) {
+      FreePool (mImage);
+    }
+
+    FreePool (Volume);
+    return NULL;
+  }
+
+  TestSetEntry (Volume, FAT_MIN_CLUSTER, TestEndOfChain (Volume));
+  mDeviceReads  = 0;
+  mDeviceWrites = 0;
+  return Volume;
+}
+
+/**
+  Free a volume created by TestCreateVolume () and its image.
+
+  @param  Volume    The volume.
+**/
+STATIC
+VOID
+TestFreeVolume (
+  IN FAT_VOLUME  *Volume
+  )
+{
+  if (Volume->FreeClusterBitmap != NULL) {
+    FreePool (Volume->FreeClusterBitmap);
+  }
+
+  FreePool (Volume->CacheBuffer);
+  FreePool (Volume);
+  FreePool (mImage);
+  mImage = NULL;
+}
+
+/**
+  Write the FAT cache back to the image, then verify that the cluster chains
+  of the files are consistent with their sizes and do not share clusters, and
+  that the free cluster bitmap and count match the free entries of the FAT.
+
+  @param  Volume    The volume.
+  @param  Files     The files of the volume, beside the root directory.
+  @param  FileCount The number of files.
+  @param  Extents   Return the total number of runs of consecutive clusters
+                    of the files.
+
+  @retval UNIT_TEST_PASSED             The volume is consistent.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+TestCheckVolume (
+  IN  FAT_VOLUME  *Volume,
+  IN  FAT_OFILE   **Files,
+  IN  UINTN       FileCount,
+  OUT UINTN       *Extents
+  )
+{
+  UINT8  *Used;
+  UINTN  Index;
+  UINTN  Cluster;
+  UINTN  Previous;
+  UINTN  Length;
+  UINTN  FreeCount;
+
+  UT_ASSERT_NOT_EFI_ERROR (FatVolumeFlushCache (Volume, NULL));
+
+  Used = AllocateZeroPool (Volume->MaxCluster + 2);
+  UT_ASSERT_NOT_NULL (Used);
+  Used[FAT_MIN_CLUSTER] = 1;
+
+  *Extents = 0;
+  for (Index = 0; Index < FileCount; Index++) {
+    Length   = 0;
+    Previous = 0;
+    for (Cluster = Files[Index]->FileCluster; Cluster != 0 && Cluster != TestEndOfChain (Volume); Cluster = TestGetEntry (Volume, Cluster)) {
+      UT_ASSERT_TRUE (Cluster >= FAT_MIN_CLUSTER && Cluster <= Volume->MaxCluster + 1);
+      UT_ASSERT_EQUAL (Used[Cluster], 0);
+      Used[Cluster] = 1;
+      if (Cluster != Previous + 1) {
+        (*Extents)++;
+      }
+
+      Previous = Cluster;
+      Length++;
+    }
+
+    UT_ASSERT_EQUAL (Length, (Files[Index]->FileSize + Volume->ClusterSize - 1) >> Volume->ClusterAlignment);
+    if (Length != 0) {
+      UT_ASSERT_EQUAL (Files[Index]->FileLastCluster, Previous);
+    }
+  }
+
+  FreeCount = 0;
+  for (Cluster = FAT_MIN_CLUSTER; Cluster <= Volume->MaxCluster + 1; Cluster++) {
+    if (TestGetEntry (Volume, Cluster) == FAT_CLUSTER_FREE) {
+      UT_ASSERT_EQUAL (Used[Cluster], 0);
+      FreeCount++;
+    } else {
+      UT_ASSERT_EQUAL (Used[Cluster], 1);
+    }
+
+    if (Volume->FreeClusterBitmap != NULL) {
+      UT_ASSERT_EQUAL (TestIsFreeInBitmap (Volume, Cluster), TestGetEntry (Volume, Cluster) == FAT_CLUSTER_FREE);
+    }
+  }
+
+  UT_ASSERT_EQUAL (Volume->FatInfoSector.FreeInfo.ClusterCount, FreeCount);
+
+  FreePool (Used);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Verify that the free cluster bitmap built from the FAT table matches its
+  free entries, including those changed in the FAT cache only.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+BuildFreeClusterBitmapShouldMatchFat (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_VOLUME_CONTEXT  *VolumeContext;
+  FAT_VOLUME           *Volume;
+  UINTN                Cluster;
+  UINTN                FreeCount;
+  UINTN                CachedCluster;
+  UINT32               Value;
+
+  VolumeContext = (TEST_VOLUME_CONTEXT *)Context;
+  Volume        = TestCreateVolume (VolumeContext->FatType, VolumeContext->ClusterCount);
+  UT_ASSERT_NOT_NULL (Volume);
+
+  //
+  // Use about half of the clusters, the last one included
+  //
+  srand (1);
+  for (Cluster = FAT_MIN_CLUSTER + 1; Cluster <= Volume->MaxCluster + 1; Cluster++) {
+    if ((rand () % 2 == 0) || (Cluster == Volume->MaxCluster + 1)) {
+      TestSetEntry (Volume, Cluster, TestEndOfChain (Volume));
+    }
+  }
+
+  //
+  // Free a used cluster through the FAT cache only, the image keeps the
+  // stale entry
+  //
+  CachedCluster = Volume->MaxCluster + 1;
+  if (Volume->FatType != Fat12) {
+    Value = 0;
+    UT_ASSERT_NOT_EFI_ERROR (
+      FatDiskIo (Volume, WriteFat, Volume->FatPos + CachedCluster * Volume->FatEntrySize, Volume->FatEntrySize, &Value, NULL)
+      );
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (FatBuildFreeClusterBitmap (Volume));
+  UT_ASSERT_NOT_NULL (Volume->FreeClusterBitmap);
+  UT_ASSERT_TRUE (Volume->FreeInfoValid);
+
+  FreeCount = 0;
+  for (Cluster = FAT_MIN_CLUSTER; Cluster <= Volume->MaxCluster + 1; Cluster++) {
+    if ((Cluster == CachedCluster) && (Volume->FatType != Fat12)) {
+      UT_ASSERT_TRUE (TestIsFreeInBitmap (Volume, Cluster));
+    } else {
+      UT_ASSERT_EQUAL (TestIsFreeInBitmap (Volume, Cluster), TestGetEntry (Volume, Cluster) == FAT_CLUSTER_FREE);
+    }
+
+    if (TestIsFreeInBitmap (Volume, Cluster)) {
+      FreeCount++;
+    }
+  }
+
+  //
+  // The bits out of the volume are never set
+  //
+  UT_ASSERT_FALSE (TestIsFreeInBitmap (Volume, 0));
+  UT_ASSERT_FALSE (TestIsFreeInBitmap (Volume, 1));
+  for (Cluster = Volume->MaxCluster + 2; Cluster % (sizeof (UINTN) * 8) != 0; Cluster++) {
+    UT_ASSERT_FALSE (TestIsFreeInBitmap (Volume, Cluster));
+  }
+
+  UT_ASSERT_EQUAL (Volume->FatInfoSector.FreeInfo.ClusterCount, FreeCount);
+
+  //
+  // Building the bitmap again keeps it
+  //
+  mDeviceReads = 0;
+  UT_ASSERT_NOT_EFI_ERROR (FatBuildFreeClusterBitmap (Volume));
+  UT_ASSERT_EQUAL (mDeviceReads, 0);
+
+  TestFreeVolume (Volume);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Verify that the runs of free clusters follow the last cluster of the file
+  when they can, and are limited to the free clusters and the count asked for.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+AllocateClusterRunShouldFollowFile (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_VOLUME_CONTEXT  *VolumeContext;
+  FAT_VOLUME           *Volume;
+  UINTN                Cluster;
+  UINTN                Count;
+
+  VolumeContext = (TEST_VOLUME_CONTEXT *)Context;
+  Volume        = TestCreateVolume (VolumeContext->FatType, VolumeContext->ClusterCount);
+  UT_ASSERT_NOT_NULL (Volume);
+
+  //
+  // Clusters 2 to 9 and 20 are used, 10 to 19 and from 21 are free
+  //
+  for (Cluster = FAT_MIN_CLUSTER; Cluster < 10; Cluster++) {
+    TestSetEntry (Volume, Cluster, TestEndOfChain (Volume));
+  }
+
+  TestSetEntry (Volume, 20, TestEndOfChain (Volume));
+
+  //
+  // The run following the file is limited by the next used cluster, or by
+  // the count asked for
+  //
+  Cluster = FatAllocateClusterRun (Volume, 9, 100, &Count);
+  UT_ASSERT_NOT_NULL (Volume->FreeClusterBitmap);
+  UT_ASSERT_EQUAL (Cluster, 10);
+  UT_ASSERT_EQUAL (Count, 10);
+  UT_ASSERT_EQUAL (Volume->FatInfoSector.FreeInfo.NextCluster, 20);
+
+  Cluster = FatAllocateClusterRun (Volume, 9, 4, &Count);
+  UT_ASSERT_EQUAL (Cluster, 10);
+  UT_ASSERT_EQUAL (Count, 4);
+
+  Cluster = FatAllocateClusterRun (Volume, 20, 5, &Count);
+  UT_ASSERT_EQUAL (Cluster, 21);
+  UT_ASSERT_EQUAL (Count, 5);
+
+  //
+  // When the cluster following the file is used, or for an empty file, the
+  // run starts at the first free cluster from the hint
+  //
+  Volume->FatInfoSector.FreeInfo.NextCluster = FAT_MIN_CLUSTER;
+  Cluster                                    = FatAllocateClusterRun (Volume, 4, 100, &Count);
+  UT_ASSERT_EQUAL (Cluster, 10);
+  UT_ASSERT_EQUAL (Count, 10);
+
+  Volume->FatInfoSector.FreeInfo.NextCluster = 15;
+  Cluster                                    = FatAllocateClusterRun (Volume, FAT_CLUSTER_FREE, 3, &Count);
+  UT_ASSERT_EQUAL (Cluster, 15);
+  UT_ASSERT_EQUAL (Count, 3);
+
+  //
+  // The search wraps around, and the run stops at the end of the volume
+  //
+  Volume->FatInfoSector.FreeInfo.NextCluster = (UINT32)Volume->MaxCluster + 1;
+  Cluster                                    = FatAllocateClusterRun (Volume, FAT_CLUSTER_FREE, 100, &Count);
+  UT_ASSERT_EQUAL (Cluster, Volume->MaxCluster + 1);
+  UT_ASSERT_EQUAL (Count, 1);
+
+  Volume->FatInfoSector.FreeInfo.NextCluster = (UINT32)Volume->MaxCluster + 2;
+  Cluster                                    = FatAllocateClusterRun (Volume, FAT_CLUSTER_FREE, 100, &Count);
+  UT_ASSERT_EQUAL (Cluster, 10);
+  UT_ASSERT_EQUAL (Count, 10);
+
+  //
+  // The allocated clusters stay free until they are chained
+  //
+  UT_ASSERT_TRUE (TestIsFreeInBitmap (Volume, 10));
+
+  //
+  // No free cluster left
+  //
+  UT_ASSERT_NOT_EFI_ERROR (FatSetFatChain (Volume, 10, 10));
+  UT_ASSERT_NOT_EFI_ERROR (FatSetFatChain (Volume, 21, Volume->MaxCluster + 1 - 20));
+  Cluster = FatAllocateClusterRun (Volume, 9, 100, &Count);
+  UT_ASSERT_TRUE (FAT_END_OF_FAT_CHAIN (Cluster));
+  UT_ASSERT_EQUAL (Count, 0);
+  UT_ASSERT_EQUAL (Volume->FatInfoSector.FreeInfo.ClusterCount, 0);
+
+  TestFreeVolume (Volume);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Verify that a run of clusters is chained across several blocks of FAT
+  entries and FAT cache pages, keeping the reserved bits of the FAT32 entries
+  and updating the free cluster bitmap and count.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+SetFatChainShouldLinkRun (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_VOLUME_CONTEXT  *VolumeContext;
+  FAT_VOLUME           *Volume;
+  UINTN                First;
+  UINTN                Count;
+  UINTN                Cluster;
+  UINTN                FreeCount;
+  UINTN                Offset;
+  UINTN                Size;
+
+  VolumeContext = (TEST_VOLUME_CONTEXT *)Context;
+  Volume        = TestCreateVolume (VolumeContext->FatType, VolumeContext->ClusterCount);
+  UT_ASSERT_NOT_NULL (Volume);
+
+  //
+  // The run crosses a FAT cache page, unless the whole FAT12 table fits in one
+  //
+  Count = 3000;
+  First = ((UINTN)1 << Volume->DiskCache[CacheFat].PageAlignment) / Volume->FatEntrySize - Count / 2;
+  if (First + Count > Volume->MaxCluster + 1) {
+    First = FAT_MIN_CLUSTER + 2;
+  }
+  if (Volume->FatType == Fat32) {
+    TestSetEntry (Volume, First + 7, FAT_CLUSTER_UNMASK_FAT32);
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (FatBuildFreeClusterBitmap (Volume));
+  FreeCount = Volume->FatInfoSector.FreeInfo.ClusterCount;
+
+  UT_ASSERT_NOT_EFI_ERROR (FatSetFatChain (Volume, First, Count));
+  UT_ASSERT_EQUAL (Volume->FatInfoSector.FreeInfo.ClusterCount, FreeCount - Count);
+  UT_ASSERT_NOT_EFI_ERROR (FatVolumeFlushCache (Volume, NULL));
+
+  for (Cluster = First; Cluster < First + Count - 1; Cluster++) {
+    UT_ASSERT_EQUAL (TestGetEntry (Volume, Cluster), Cluster + 1);
+    UT_ASSERT_FALSE (TestIsFreeInBitmap (Volume, Cluster));
+  }
+
+  UT_ASSERT_EQUAL (TestGetEntry (Volume, First + Count - 1), TestEndOfChain (Volume));
+  UT_ASSERT_FALSE (TestIsFreeInBitmap (Volume, First + Count - 1));
+  UT_ASSERT_EQUAL (TestGetEntry (Volume, First - 1), FAT_CLUSTER_FREE);
+  UT_ASSERT_EQUAL (TestGetEntry (Volume, First + Count), FAT_CLUSTER_FREE);
+  UT_ASSERT_TRUE (TestIsFreeInBitmap (Volume, First + Count));
+  if (Volume->FatType == Fat32) {
+    UT_ASSERT_EQUAL (
+      *(UINT32 *)(mImage + Volume->FatPos + FAT_POS_FAT32 (First + 7)),
+      FAT_CLUSTER_UNMASK_FAT32 | (UINT32)(First + 8)
+      );
+  }
+
+  //
+  // The entries of the run are written to the second FAT table too
+  //
+  if (Volume->FatType == Fat12) {
+    Offset = FAT_POS_FAT12 (First);
+    Size   = FAT_POS_FAT12 (First + Count) - Offset;
+  } else {
+    Offset = First * Volume->FatEntrySize;
+    Size   = Count * Volume->FatEntrySize;
+  }
+
+  UT_ASSERT_MEM_EQUAL (mImage + Volume->FatPos + Offset, mImage + Volume->FatPos + Volume->FatSize + Offset, Size);
+
+  TestFreeVolume (Volume);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Grow and shrink files at random, then verify the cluster chains, and log
+  the time spent and the fragmentation of the files.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+RandomGrowShrinkShouldKeepChains (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_VOLUME_CONTEXT  *VolumeContext;
+  FAT_VOLUME           *Volume;
+  FAT_OFILE            *Files[TEST_FILE_COUNT];
+  FAT_OFILE            *OFile;
+  UNIT_TEST_STATUS     TestStatus;
+  EFI_STATUS           Status;
+  UINTN                Step;
+  UINTN                Index;
+  UINT64               NewSize;
+  UINTN                Extents;
+  clock_t              Start;
+  clock_t              Ticks;
+
+  VolumeContext = (TEST_VOLUME_CONTEXT *)Context;
+  Volume        = TestCreateVolume (VolumeContext->FatType, VolumeContext->ClusterCount);
+  UT_ASSERT_NOT_NULL (Volume);
+
+  for (Index = 0; Index < TEST_FILE_COUNT; Index++) {
+    Files[Index] = AllocateZeroPool (sizeof (FAT_OFILE));
+    UT_ASSERT_NOT_NULL (Files[Index]);
+    Files[Index]->Volume = Volume;
+  }
+
+  srand (1);
+  Start = clock ();
+  for (Step = 0; Step < TEST_GROW_SHRINK_STEPS; Step++) {
+    OFile = Files[(UINTN)rand () % TEST_FILE_COUNT];
+    if (rand () % 3 != 0) {
+      //
+      // Grow the file by up to 64 clusters, sometimes by up to 2000 more
+      //
+      NewSize = OFile->FileSize + (UINT64)(rand () % (64 * Volume->ClusterSize));
+      if (rand () % 8 == 0) {
+        NewSize += (UINT64)(rand () % 2000) * Volume->ClusterSize;
+      }
+
+      Status = FatGrowEof (OFile, NewSize);
+      if (Status == EFI_VOLUME_FULL) {
+        for (Index = 0; Index < TEST_FILE_COUNT; Index++) {
+          Files[Index]->FileSize = 0;
+          UT_ASSERT_NOT_EFI_ERROR (FatShrinkEof (Files[Index]));
+        }
+
+        continue;
+      }
+
+      UT_ASSERT_NOT_EFI_ERROR (Status);
+      UT_ASSERT_EQUAL (OFile->FileSize, NewSize);
+    }
+
+    if (rand () % 3 != 0) {
+      OFile->FileSize = (OFile->FileSize != 0) ? (UINTN)rand () % (OFile->FileSize + 1) : 0;
+      UT_ASSERT_NOT_EFI_ERROR (FatShrinkEof (OFile));
+    }
+  }
+
+  Ticks = clock () - Start;
+
+  TestStatus = TestCheckVolume (Volume, Files, TEST_FILE_COUNT, &Extents);
+  UT_LOG_INFO (
+    "FAT%d: %d grow/shrink steps in %ld ms, %ld extents, %ld device reads\n",
+    (VolumeContext->FatType == Fat12) ? 12 : ((VolumeContext->FatType == Fat16) ? 16 : 32),
+    TEST_GROW_SHRINK_STEPS,
+    (UINT64)Ticks * 1000 / CLOCKS_PER_SEC,
+    (UINT64)Extents,
+    mDeviceReads
+    );
+
+  for (Index = 0; Index < TEST_FILE_COUNT; Index++) {
+    if (Files[Index]->Extents != NULL) {
+      FreePool (Files[Index]->Extents);
+    }
+
+    FreePool (Files[Index]);
+  }
+
+  TestFreeVolume (Volume);
+  return TestStatus;
+}
+
+/**
+  Grow a file to 1 GiB in 64 KiB steps on a large FAT32 volume, whose first
+  90% of the clusters are used by another file, then verify the cluster
+  chains, and log the time spent and the number of device reads.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+GrowOnFullVolumeShouldSucceed (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  FAT_VOLUME        *Volume;
+  FAT_OFILE         *Files[2];
+  UNIT_TEST_STATUS  TestStatus;
+  UINTN             Cluster;
+  UINTN             LastUsedCluster;
+  UINT64            Size;
+  UINTN             Extents;
+  clock_t           Start;
+  clock_t           Ticks;
+
+  Volume = TestCreateVolume (Fat32, TEST_LARGE_CLUSTER_COUNT);
+  UT_ASSERT_NOT_NULL (Volume);
+
+  Files[0] = AllocateZeroPool (sizeof (FAT_OFILE));
+  Files[1] = AllocateZeroPool (sizeof (FAT_OFILE));
+  UT_ASSERT_NOT_NULL (Files[0]);
+  UT_ASSERT_NOT_NULL (Files[1]);
+  Files[0]->Volume = Volume;
+  Files[1]->Volume = Volume;
+
+  LastUsedCluster = Volume->MaxCluster * 9 / 10;
+  for (Cluster = FAT_MIN_CLUSTER + 1; Cluster < LastUsedCluster; Cluster++) {
+    TestSetEntry (Volume, Cluster, Cluster + 1);
+  }
+
+  TestSetEntry (Volume, LastUsedCluster, FAT_CLUSTER_MASK_FAT32);
+  Files[0]->FileCluster     = FAT_MIN_CLUSTER + 1;
+  Files[0]->FileLastCluster = LastUsedCluster;
+  Files[0]->FileSize        = (LastUsedCluster - FAT_MIN_CLUSTER) << Volume->ClusterAlignment;
+
+  Start = clock ();
+  for (Size = TEST_LARGE_GROW_STEP; Size <= TEST_LARGE_FILE_SIZE; Size += TEST_LARGE_GROW_STEP) {
+    UT_ASSERT_NOT_EFI_ERROR (FatGrowEof (Files[1], Size));
+  }
+
+  Ticks = clock () - Start;
+
+  TestStatus = TestCheckVolume (Volume, Files, ARRAY_SIZE (Files), &Extents);
+  UT_LOG_INFO (
+    "FAT32: %ld clusters 90%% used, file grown to %ld MiB in %ld ms, %ld extents, %ld device reads\n",
+    (UINT64)TEST_LARGE_CLUSTER_COUNT,
+    (UINT64)(TEST_LARGE_FILE_SIZE >> 20),
+    (UINT64)Ticks * 1000 / CLOCKS_PER_SEC,
+    (UINT64)Extents - 1,
+    mDeviceReads
+    );
+
+  if (Files[1]->Extents != NULL) {
+    FreePool (Files[1]->Extents);
+  }
+
+  FreePool (Files[0]);
+  FreePool (Files[1]);
+  TestFreeVolume (Volume);
+  return TestStatus;
+}
+
+/**
+  Write the FAT cache back to the image, then walk the cluster chain of a file
+  in the first FAT table.
+
+  @param  Volume        The volume.
+  @param  OFile         The file.
+  @param  Chain         Return the clusters of the file, in file order. It must
+                        hold Volume->MaxCluster entries.
+  @param  ChainLength   Return the number of clusters of the file.
+
+  @retval UNIT_TEST_PASSED             The chain was walked.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+TestWalkChain (
+  IN  FAT_VOLUME  *Volume,
+  IN  FAT_OFILE   *OFile,
+  OUT UINTN       *Chain,
+  OUT UINTN       *ChainLength
+  )
+{
+  UINTN  Cluster;
+
+  UT_ASSERT_NOT_EFI_ERROR (FatVolumeFlushCache (Volume, NULL));
+
+  *ChainLength = 0;
+  for (Cluster = OFile->FileCluster; Cluster != 0 && Cluster != TestEndOfChain (Volume); Cluster = TestGetEntry (Volume, Cluster)) {
+    UT_ASSERT_TRUE (Cluster >= FAT_MIN_CLUSTER && Cluster <= Volume->MaxCluster + 1);
+    UT_ASSERT_TRUE (*ChainLength < Volume->MaxCluster);
+    Chain[(*ChainLength)++] = Cluster;
+  }
+
+  UT_ASSERT_EQUAL (*ChainLength, (OFile->FileSize + Volume->ClusterSize - 1) >> Volume->ClusterAlignment);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Look up positions of a file with FatOFilePosition (), and verify the disk
+  position and the run of consecutive clusters it returns against the cluster
+  chain of the file.
+
+  @param  Volume        The volume.
+  @param  OFile         The file.
+  @param  Chain         The clusters of the file, from TestWalkChain ().
+  @param  ChainLength   The number of clusters of the file.
+  @param  First         The first cluster index of the file to look up.
+  @param  Last          The cluster index following the last one to look up.
+
+  @retval UNIT_TEST_PASSED             The positions were found.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+TestSeek (
+  IN FAT_VOLUME  *Volume,
+  IN FAT_OFILE   *OFile,
+  IN UINTN       *Chain,
+  IN UINTN       ChainLength,
+  IN UINTN       First,
+  IN UINTN       Last
+  )
+{
+  UINTN  Seek;
+  UINTN  Position;
+  UINTN  PosLimit;
+  UINTN  Index;
+  UINTN  LastIndex;
+
+  for (Seek = 0; Seek < TEST_SEEK_COUNT; Seek++) {
+    Position = ((First + (UINTN)rand () % (Last - First)) << Volume->ClusterAlignment) + (UINTN)rand () % Volume->ClusterSize;
+    Position = MIN (Position, OFile->FileSize - 1);
+    PosLimit = 1 + (UINTN)rand () % (16 * Volume->ClusterSize);
+
+    UT_ASSERT_NOT_EFI_ERROR (FatOFilePosition (OFile, Position, PosLimit));
+
+    Index = Position >> Volume->ClusterAlignment;
+    UT_ASSERT_EQUAL (
+      OFile->PosDisk,
+      Volume->FirstClusterPos + LShiftU64 (Chain[Index] - FAT_MIN_CLUSTER, Volume->ClusterAlignment) + (Position & (Volume->ClusterSize - 1))
+      );
+    UT_ASSERT_EQUAL (OFile->FileCurrentCluster, Chain[OFile->Position >> Volume->ClusterAlignment]);
+    UT_ASSERT_TRUE (OFile->ExtentCount <= FAT_EXTENT_MAX_COUNT);
+
+    //
+    // The run ends in the cluster of the position at the earliest, and only
+    // covers clusters that follow each other on the disk
+    //
+    UT_ASSERT_TRUE (OFile->PosRem >= Volume->ClusterSize - (Position & (Volume->ClusterSize - 1)));
+    LastIndex = (Position + OFile->PosRem - 1) >> Volume->ClusterAlignment;
+    UT_ASSERT_TRUE (LastIndex < ChainLength);
+    for ( ; Index < LastIndex; Index++) {
+      UT_ASSERT_EQUAL (Chain[Index + 1], Chain[Index] + 1);
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Build a file of more runs of consecutive clusters than the extent map of a
+  file holds, linked out of disk order, then verify the positions found by
+  FatOFilePosition () against its cluster chain: first inside the extent map,
+  then beyond it where the chain is walked, then anywhere, and again after the
+  file is shrunk and grown back.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+FilePositionShouldMatchChain (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_VOLUME_CONTEXT  *VolumeContext;
+  FAT_VOLUME           *Volume;
+  FAT_OFILE            *OFile;
+  UNIT_TEST_STATUS     TestStatus;
+  UINTN                *Slots;
+  UINTN                *Chain;
+  UINTN                ChainLength;
+  UINTN                MapClusters;
+  UINTN                FileSize;
+  UINTN                Index;
+  UINTN                Swap;
+  UINTN                Cluster;
+  UINTN                Length;
+  UINTN                Previous;
+  UINTN                Extents;
+
+  VolumeContext = (TEST_VOLUME_CONTEXT *)Context;
+  Volume        = TestCreateVolume (VolumeContext->FatType, VolumeContext->ClusterCount);
+  UT_ASSERT_NOT_NULL (Volume);
+  UT_ASSERT_TRUE (FAT_MIN_CLUSTER + 1 + TEST_FRAGMENT_COUNT * 4 <= Volume->MaxCluster + 1);
+
+  OFile = AllocateZeroPool (sizeof (FAT_OFILE));
+  Slots = AllocatePool (TEST_FRAGMENT_COUNT * sizeof (UINTN));
+  Chain = AllocatePool (Volume->MaxCluster * sizeof (UINTN));
+  UT_ASSERT_NOT_NULL (OFile);
+  UT_ASSERT_NOT_NULL (Slots);
+  UT_ASSERT_NOT_NULL (Chain);
+  OFile->Volume = Volume;
+
+  //
+  // Each run of 1 to 3 clusters starts a slot of 4 clusters, so that no two
+  // runs are consecutive on the disk. The runs are chained in random order
+  //
+  srand (1);
+  for (Index = 0; Index < TEST_FRAGMENT_COUNT; Index++) {
+    Slots[Index] = Index;
+  }
+
+  for (Index = TEST_FRAGMENT_COUNT - 1; Index > 0; Index--) {
+    Swap         = (UINTN)rand () % (Index + 1);
+    Cluster      = Slots[Index];
+    Slots[Index] = Slots[Swap];
+    Slots[Swap]  = Cluster;
+  }
+
+  Previous    = FAT_CLUSTER_FREE;
+  MapClusters = 0;
+  ChainLength = 0;
+  for (Index = 0; Index < TEST_FRAGMENT_COUNT; Index++) {
+    Cluster = FAT_MIN_CLUSTER + 1 + Slots[Index] * 4;
+    for (Length = 1 + (UINTN)rand () % 3; Length > 0; Length--) {
+      if (Previous == FAT_CLUSTER_FREE) {
+        OFile->FileCluster = Cluster;
+      } else {
+        TestSetEntry (Volume, Previous, Cluster);
+      }
+
+      Previous = Cluster++;
+      ChainLength++;
+    }
+
+    if (Index == FAT_EXTENT_MAX_COUNT - 1) {
+      MapClusters = ChainLength;
+    }
+  }
+
+  TestSetEntry (Volume, Previous, TestEndOfChain (Volume));
+  OFile->FileCurrentCluster = OFile->FileCluster;
+  OFile->FileLastCluster    = Previous;
+  OFile->FileSize           = (ChainLength << Volume->ClusterAlignment) - Volume->ClusterSize / 2;
+  FileSize                  = OFile->FileSize;
+  UT_ASSERT_NOT_EFI_ERROR (FatBuildFreeClusterBitmap (Volume));
+
+  TestStatus = TestWalkChain (Volume, OFile, Chain, &ChainLength);
+  if (TestStatus != UNIT_TEST_PASSED) {
+    return TestStatus;
+  }
+
+  //
+  // Random seeks inside the extent map, then beyond it, where the extent map
+  // stops growing and the chain is walked from its end, then anywhere
+  //
+  TestStatus = TestSeek (Volume, OFile, Chain, ChainLength, 0, MapClusters);
+  if (TestStatus != UNIT_TEST_PASSED) {
+    return TestStatus;
+  }
+
+  UT_ASSERT_TRUE (OFile->ExtentClusters <= MapClusters);
+
+  TestStatus = TestSeek (Volume, OFile, Chain, ChainLength, MapClusters, ChainLength);
+  if (TestStatus != UNIT_TEST_PASSED) {
+    return TestStatus;
+  }
+
+  UT_ASSERT_EQUAL (OFile->ExtentCount, FAT_EXTENT_MAX_COUNT);
+  UT_ASSERT_EQUAL (OFile->ExtentClusters, MapClusters);
+
+  TestStatus = TestSeek (Volume, OFile, Chain, ChainLength, 0, ChainLength);
+  if (TestStatus != UNIT_TEST_PASSED) {
+    return TestStatus;
+  }
+
+  //
+  // Shrink the file in the middle of a run inside the extent map, then grow
+  // it back, on the clusters freed and those between the runs
+  //
+  OFile->FileSize = ((MapClusters / 3) << Volume->ClusterAlignment) + Volume->ClusterSize / 2;
+  UT_ASSERT_NOT_EFI_ERROR (FatShrinkEof (OFile));
+  UT_ASSERT_TRUE (OFile->ExtentClusters <= MapClusters / 3 + 1);
+
+  TestStatus = TestWalkChain (Volume, OFile, Chain, &ChainLength);
+  if (TestStatus != UNIT_TEST_PASSED) {
+    return TestStatus;
+  }
+
+  TestStatus = TestSeek (Volume, OFile, Chain, ChainLength, 0, ChainLength);
+  if (TestStatus != UNIT_TEST_PASSED) {
+    return TestStatus;
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (FatGrowEof (OFile, FileSize));
+  TestStatus = TestWalkChain (Volume, OFile, Chain, &ChainLength);
+  if (TestStatus != UNIT_TEST_PASSED) {
+    return TestStatus;
+  }
+
+  TestStatus = TestSeek (Volume, OFile, Chain, ChainLength, 0, ChainLength);
+  if (TestStatus != UNIT_TEST_PASSED) {
+    return TestStatus;
+  }
+
+  TestStatus = TestCheckVolume (Volume, &OFile, 1, &Extents);
+  UT_LOG_INFO (
+    "FAT%d: %ld extents, %ld in the extent map after regrowing\n",
+    (VolumeContext->FatType == Fat16) ? 16 : 32,
+    (UINT64)Extents,
+    (UINT64)OFile->ExtentCount
+    );
+
+  if (OFile->Extents != NULL) {
+    FreePool (OFile->Extents);
+  }
+
+  FreePool (OFile);
+  FreePool (Slots);
+  FreePool (Chain);
+  TestFreeVolume (Volume);
+  return TestStatus;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  cluster allocation and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      FileSpaceTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // The FAT routines expect the caller to hold the file system lock.
+  //
+  FatFsLock.Tpl  = TPL_CALLBACK;
+  FatFsLock.Lock = EfiLockAcquired;
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&FileSpaceTests, Framework, "FAT File Space Tests", "Fat.FileSpace", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for FAT File Space Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // --------------Suite-------------Description--------------------------------Name-------------------Function-------------------------------Pre---Post---Context---------
+  //
+  AddTestCase (FileSpaceTests, "Free cluster bitmap on FAT12", "BuildBitmap12", BuildFreeClusterBitmapShouldMatchFat, NULL, NULL, &mFat12Context);
+  AddTestCase (FileSpaceTests, "Free cluster bitmap on FAT16", "BuildBitmap16", BuildFreeClusterBitmapShouldMatchFat, NULL, NULL, &mFat16Context);
+  AddTestCase (FileSpaceTests, "Free cluster bitmap on FAT32", "BuildBitmap32", BuildFreeClusterBitmapShouldMatchFat, NULL, NULL, &mFat32Context);
+  AddTestCase (FileSpaceTests, "Cluster run follows the file", "AllocateRun", AllocateClusterRunShouldFollowFile, NULL, NULL, &mFat32Context);
+  AddTestCase (FileSpaceTests, "Chain a run on FAT12", "SetFatChain12", SetFatChainShouldLinkRun, NULL, NULL, &mFat12Context);
+  AddTestCase (FileSpaceTests, "Chain a run on FAT16", "SetFatChain16", SetFatChainShouldLinkRun, NULL, NULL, &mFat16Context);
+  AddTestCase (FileSpaceTests, "Chain a run on FAT32", "SetFatChain32", SetFatChainShouldLinkRun, NULL, NULL, &mFat32Context);
+  AddTestCase (FileSpaceTests, "Random grow and shrink on FAT12", "GrowShrink12", RandomGrowShrinkShouldKeepChains, NULL, NULL, &mFat12Context);
+  AddTestCase (FileSpaceTests, "Random grow and shrink on FAT16", "GrowShrink16", RandomGrowShrinkShouldKeepChains, NULL, NULL, &mFat16Context);
+  AddTestCase (FileSpaceTests, "Random grow and shrink on FAT32", "GrowShrink32", RandomGrowShrinkShouldKeepChains, NULL, NULL, &mFat32Context);
+  AddTestCase (FileSpaceTests, "Grow a file on a full volume", "GrowOnFull", GrowOnFullVolumeShouldSucceed, NULL, NULL, NULL);
+  AddTestCase (FileSpaceTests, "Seek a fragmented file on FAT16", "FilePosition16", FilePositionShouldMatchChain, NULL, NULL, &mFat16Context);
+  AddTestCase (FileSpaceTests, "Seek a fragmented file on FAT32", "FilePosition32", FilePositionShouldMatchChain, NULL, NULL, &mFat32Context);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define FileSpaceUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+FileSpaceUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
@@ -0,0 +1,442 @@
+/** @file
+  Shell application to measure the read throughput of a block device.
+
+  The application reads a block device sequentially for PERF_RUN_TIME, first
+  with EFI_BLOCK_IO_PROTOCOL, one request at a time, then, if the device
+  produces it, with EFI_BLOCK_IO2_PROTOCOL, keeping QueueDepth requests in
+  flight. It reports the throughput and the request rate of each.
+
+  Without arguments, the application lists the block devices that are not
+  partitions. For a figure that is not bound by the storage backend, run it
+  in QEMU against a null-co block device, e.g. with
+
+    -blockdev driver=null-co,node-name=null0,size=8G,read-zeroes=on
+    -device virtio-blk-pci,drive=null0,num-queues=4
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiLib.h>
+#include <Library/UefiApplicationEntryPoint.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/TimerLib.h>
+#include <Library/ElapsedTimeLib.h>
+
+#include <Protocol/BlockIo.h>
+#include <Protocol/BlockIo2.h>
+#include <Protocol/ShellParameters.h>
+
+#define PERF_DEFAULT_TRANSFER_SIZE  SIZE_64KB
+#define PERF_DEFAULT_QUEUE_DEPTH    32
+#define PERF_MAX_QUEUE_DEPTH        256
+
+//
+// Time each measurement runs, in microseconds
+//
+#define PERF_RUN_TIME  3000000
+
+//
+// The reads wrap around at this offset, or at the end of the device if it is
+// smaller.
+//
+#define PERF_REGION_SIZE  SIZE_1GB
+
+typedef struct {
+  EFI_BLOCK_IO_PROTOCOL     *BlockIo;
+  EFI_BLOCK_IO2_PROTOCOL    *BlockIo2;
+  UINT32                    MediaId;
+  UINTN                     TransferSize;
+  EFI_LBA                   BlocksPerTransfer;
+  EFI_LBA                   RegionBlocks;
+  EFI_LBA                   NextLba;
+} PERF_DEVICE;
+
+typedef struct {
+  EFI_BLOCK_IO2_TOKEN    Token;
+  VOID                   *Buffer;
+  BOOLEAN                Busy;
+} PERF_REQUEST;
+
+/**
+  Get the LBA of the next transfer, wrapping around at the end of the region.
+
+  @param  Device                 The device under test.
+
+  @return The LBA of the next transfer.
+
+**/
+EFI_LBA
+PerfNextLba (
+  IN OUT PERF_DEVICE  *Device
+  )
+{
+  EFI_LBA  Lba;
+
+  Lba              = Device->NextLba;
+  Device->NextLba += Device->BlocksPerTransfer;
+  if (Device->NextLba + Device->BlocksPerTransfer > Device->RegionBlocks) {
+    Device->NextLba = 0;
+  }
+
+  return Lba;
+}
+
+/**
+  Print the result of a measurement.
+
+  @param  Name                   The name of the measurement.
+  @param  Requests               The number of completed requests.
+  @param  Bytes                  The number of bytes read.
+  @param  NanoSeconds            The duration of the measurement.
+
+**/
+VOID
+PerfPrintResult (
+  IN CONST CHAR16  *Name,
+  IN UINT64        Requests,
+  IN UINT64        Bytes,
+  IN UINT64        NanoSeconds
+  )
+{
+  if (NanoSeconds == 0) {
+    NanoSeconds = 1;
+  }
+
+  Print (
+    L"  %-24s %,10ld MB/s %,10ld IOPS\n",
+    Name,
+    DivU64x64Remainder (MultU64x32 (Bytes, 1000), NanoSeconds, NULL),
+    DivU64x64Remainder (MultU64x32 (Requests, 1000000000), NanoSeconds, NULL)
+    );
+}
+
+/**
+  Read the device with EFI_BLOCK_IO_PROTOCOL, one request at a time.
+
+  @param  Device                 The device under test.
+
+  @retval EFI_SUCCESS            The measurement completed.
+  @retval other                  A read failed.
+
+**/
+EFI_STATUS
+PerfBlockIo (
+  IN OUT PERF_DEVICE  *Device
+  )
+{
+  EFI_STATUS  Status;
+  VOID        *Buffer;
+  UINT64      Requests;
+  UINT64      Start;
+  UINT64      NanoSeconds;
+
+  Buffer = AllocatePool (Device->TransferSize);
+  if (Buffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status          = EFI_SUCCESS;
+  Requests        = 0;
+  NanoSeconds     = 0;
+  Device->NextLba = 0;
+  Start           = GetPerformanceCounter ();
+  do {
+    Status = Device->BlockIo->ReadBlocks (
+                                Device->BlockIo,
+                                Device->MediaId,
+                                PerfNextLba (Device),
+                                Device->TransferSize,
+                                Buffer
+                                );
+    if (EFI_ERROR (Status)) {
+      Print (L"BlockIoPerf: ReadBlocks failed - %r\n", Status);
+      break;
+    }
+
+    Requests++;
+    NanoSeconds = GetElapsedTimeInNanoSecond (Start, GetPerformanceCounter ());
+  } while (NanoSeconds < MultU64x32 (PERF_RUN_TIME, 1000));
+
+  if (!EFI_ERROR (Status)) {
+    PerfPrintResult (L"BlockIo", Requests, MultU64x64 (Requests, Device->TransferSize), NanoSeconds);
+  }
+
+  FreePool (Buffer);
+  return Status;
+}
+
+/**
+  Read the device with EFI_BLOCK_IO2_PROTOCOL, keeping QueueDepth requests in
+  flight.
+
+  @param  Device                 The device under test.
+  @param  QueueDepth             The number of requests in flight.
+
+  @retval EFI_SUCCESS            The measurement completed.
+  @retval other                  A read failed.
+
+**/
+EFI_STATUS
+PerfBlockIo2 (
+  IN OUT PERF_DEVICE  *Device,
+  IN     UINTN        QueueDepth
+  )
+{
+  EFI_STATUS    Status;
+  PERF_REQUEST  *Requests;
+  UINTN         Index;
+  UINTN         Busy;
+  UINT64        Completed;
+  UINT64        Start;
+  UINT64        NanoSeconds;
+  BOOLEAN       Running;
+
+  Requests = AllocateZeroPool (QueueDepth * sizeof (PERF_REQUEST));
+  if (Requests == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = EFI_SUCCESS;
+  for (Index = 0; Index < QueueDepth; Index++) {
+    Requests[Index].Buffer = AllocatePool (Device->TransferSize);
+    if (Requests[Index].Buffer == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+      goto Done;
+    }
+
+    //
+    // The events have no notification function, so that completions can be
+    // polled with CheckEvent ().
+    //
+    Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &Requests[Index].Token.Event);
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
+  }
+
+  Busy            = 0;
+  Completed       = 0;
+  Running         = TRUE;
+  Device->NextLba = 0;
+  Start           = GetPerformanceCounter ();
+  do {
+    for (Index = 0; Index < QueueDepth; Index++) {
+      if (Requests[Index].Busy) {
+        if (gBS->CheckEvent (Requests[Index].Token.Event) != EFI_SUCCESS) {
+          continue;
+        }
+
+        Requests[Index].Busy = FALSE;
+        Busy--;
+        if (EFI_ERROR (Requests[Index].Token.TransactionStatus)) {
+          Status = Requests[Index].Token.TransactionStatus;
+          Print (L"BlockIoPerf: ReadBlocksEx completed with %r\n", Status);
+          Running = FALSE;
+          continue;
+        }
+
+        Completed++;
+      }
+
+      if (!Running) {
+        continue;
+      }
+
+      Status = Device->BlockIo2->ReadBlocksEx (
+                                   Device->BlockIo2,
+                                   Device->MediaId,
+                                   PerfNextLba (Device),
+                                   &Requests[Index].Token,
+                                   Device->TransferSize,
+                                   Requests[Index].Buffer
+                                   );
+      if (EFI_ERROR (Status)) {
+        Print (L"BlockIoPerf: ReadBlocksEx failed - %r\n", Status);
+        Running = FALSE;
+        continue;
+      }
+
+      Requests[Index].Busy = TRUE;
+      Busy++;
+    }
+
+    if (Running) {
+      Running = (BOOLEAN)(GetElapsedTimeInNanoSecond (Start, GetPerformanceCounter ()) < MultU64x32 (PERF_RUN_TIME, 1000));
+    }
+  } while (Busy > 0);
+
+  //
+  // The requests in flight at the deadline are waited for, and counted.
+  //
+  NanoSeconds = GetElapsedTimeInNanoSecond (Start, GetPerformanceCounter ());
+
+  if (!EFI_ERROR (Status)) {
+    PerfPrintResult (L"BlockIo2", Completed, MultU64x64 (Completed, Device->TransferSize), NanoSeconds);
+  }
+
+Done:
+  for (Index = 0; Index < QueueDepth; Index++) {
+    if (Requests[Index].Token.Event != NULL) {
+      gBS->CloseEvent (Requests[Index].Token.Event);
+    }
+
+    if (Requests[Index].Buffer != NULL) {
+      FreePool (Requests[Index].Buffer);
+    }
+  }
+
+  FreePool (Requests);
+  return Status;
+}
+
+/**
+  The user Entry Point for Application. The user code starts with this function
+  as the real entry point for the application.
+
+  @param[in] ImageHandle    The firmware allocated handle for the EFI image.
+  @param[in] SystemTable    A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS       The entry point is executed successfully.
+  @retval other             Some error occurs when executing this entry point.
+
+**/
+EFI_STATUS
+EFIAPI
+UefiMain (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS                     Status;
+  EFI_SHELL_PARAMETERS_PROTOCOL  *ShellParameters;
+  EFI_HANDLE                     *Handles;
+  UINTN                          HandleCount;
+  UINTN                          Index;
+  UINTN                          DeviceCount;
+  UINTN                          DeviceIndex;
+  UINTN                          QueueDepth;
+  EFI_BLOCK_IO_PROTOCOL          *BlockIo;
+  EFI_BLOCK_IO2_PROTOCOL         *BlockIo2;
+  PERF_DEVICE                    Device;
+
+  Status = gBS->HandleProtocol (
+                  ImageHandle,
+                  &gEfiShellParametersProtocolGuid,
+                  (VOID **)&ShellParameters
+                  );
+  if (EFI_ERROR (Status) || (ShellParameters->Argc > 4)) {
+    Print (L"Usage: BlockIoPerf [Device [TransferSize [QueueDepth]]]\n");
+    return EFI_INVALID_PARAMETER;
+  }
+
+  DeviceIndex         = MAX_UINTN;
+  Device.TransferSize = PERF_DEFAULT_TRANSFER_SIZE;
+  QueueDepth          = PERF_DEFAULT_QUEUE_DEPTH;
+  if (ShellParameters->Argc > 1) {
+    DeviceIndex = StrDecimalToUintn (ShellParameters->Argv[1]);
+  }
+
+  if (ShellParameters->Argc > 2) {
+    Device.TransferSize = StrDecimalToUintn (ShellParameters->Argv[2]);
+  }
+
+  if (ShellParameters->Argc > 3) {
+    QueueDepth = StrDecimalToUintn (ShellParameters->Argv[3]);
+    if ((QueueDepth == 0) || (QueueDepth > PERF_MAX_QUEUE_DEPTH)) {
+      Print (L"BlockIoPerf: invalid queue depth\n");
+      return EFI_INVALID_PARAMETER;
+    }
+  }
+
+  Status = gBS->LocateHandleBuffer (
+                  ByProtocol,
+                  &gEfiBlockIoProtocolGuid,
+                  NULL,
+                  &HandleCount,
+                  &Handles
+                  );
+  if (EFI_ERROR (Status)) {
+    Print (L"BlockIoPerf: no block device\n");
+    return Status;
+  }
+
+  DeviceCount    = 0;
+  Device.BlockIo = NULL;
+  for (Index = 0; Index < HandleCount; Index++) {
+    gBS->HandleProtocol (Handles[Index], &gEfiBlockIoProtocolGuid, (VOID **)&BlockIo);
+    if (BlockIo->Media->LogicalPartition || !BlockIo->Media->MediaPresent) {
+      continue;
+    }
+
+    if (EFI_ERROR (gBS->HandleProtocol (Handles[Index], &gEfiBlockIo2ProtocolGuid, (VOID **)&BlockIo2))) {
+      BlockIo2 = NULL;
+    }
+
+    if (DeviceIndex == MAX_UINTN) {
+      Print (
+        L"%d: %,ld MB, %d-byte blocks%s\n",
+        DeviceCount,
+        DivU64x32 (MultU64x32 (BlockIo->Media->LastBlock + 1, BlockIo->Media->BlockSize), 1000000),
+        BlockIo->Media->BlockSize,
+        (BlockIo2 != NULL) ? L", BlockIo2" : L""
+        );
+    } else if (DeviceCount == DeviceIndex) {
+      Device.BlockIo  = BlockIo;
+      Device.BlockIo2 = BlockIo2;
+    }
+
+    DeviceCount++;
+  }
+
+  FreePool (Handles);
+
+  if (DeviceIndex == MAX_UINTN) {
+    return EFI_SUCCESS;
+  }
+
+  if (Device.BlockIo == NULL) {
+    Print (L"BlockIoPerf: no device %d\n", DeviceIndex);
+    return EFI_NOT_FOUND;
+  }
+
+  Device.MediaId = Device.BlockIo->Media->MediaId;
+  if ((Device.TransferSize == 0) || (Device.TransferSize % Device.BlockIo->Media->BlockSize != 0)) {
+    Print (L"BlockIoPerf: the transfer size must be a multiple of %d\n", Device.BlockIo->Media->BlockSize);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Device.BlocksPerTransfer = Device.TransferSize / Device.BlockIo->Media->BlockSize;
+  Device.RegionBlocks      = MIN (
+                               Device.BlockIo->Media->LastBlock + 1,
+                               PERF_REGION_SIZE / Device.BlockIo->Media->BlockSize
+                               );
+  if (Device.BlocksPerTransfer > Device.RegionBlocks) {
+    Print (L"BlockIoPerf: the transfer size exceeds the device\n");
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Print (
+    L"Device %d, %d-byte reads for %d us\n",
+    DeviceIndex,
+    Device.TransferSize,
+    PERF_RUN_TIME
+    );
+
+  Status = PerfBlockIo (&Device);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (Device.BlockIo2 == NULL) {
+    Print (L"  BlockIo2 is not supported\n");
+    return EFI_SUCCESS;
+  }
+
+  Print (L"  (BlockIo2 queue depth %d)\n", QueueDepth);
+  return PerfBlockIo2 (&Device, QueueDepth);
+}
@@ -0,0 +1,345 @@
+/** @file
+  Shell application to measure the decompression of GUIDed sections.
+
+  The application reads a firmware volume, such as the FVMAIN_COMPACT.Fv of
+  OVMF, or a file holding a section stream, and decodes every GUIDed section
+  at the top level of its files with the extract guided section handlers
+  linked in, reporting the average wall-clock time of a decode. Building the
+  volume once with LZMA and once with LZMA parallel compression compares the
+  serial and the multi-processor decompression.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Pi/PiFirmwareVolume.h>
+#include <Pi/PiFirmwareFile.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/ExtractGuidedSectionLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiLib.h>
+#include <Library/UefiApplicationEntryPoint.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/TimerLib.h>
+#include <Library/ElapsedTimeLib.h>
+
+#include <Protocol/Shell.h>
+#include <Protocol/ShellParameters.h>
+
+#define PERF_DEFAULT_ITERATIONS  10
+
+/**
+  Read a file into a buffer allocated from pool.
+
+  @param  FileName               The name of the file.
+  @param  BufferSize             The size of the file.
+  @param  Buffer                 The buffer holding the file.
+
+  @retval EFI_SUCCESS            The file was read.
+  @retval other                  The file could not be read.
+
+**/
+EFI_STATUS
+PerfReadFile (
+  IN  CHAR16  *FileName,
+  OUT UINTN   *BufferSize,
+  OUT VOID    **Buffer
+  )
+{
+  EFI_STATUS          Status;
+  EFI_SHELL_PROTOCOL  *Shell;
+  SHELL_FILE_HANDLE   Handle;
+  UINT64              FileSize;
+
+  Status = gBS->LocateProtocol (&gEfiShellProtocolGuid, NULL, (VOID **)&Shell);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = Shell->OpenFileByName (FileName, &Handle, EFI_FILE_MODE_READ);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = Shell->GetFileSize (Handle, &FileSize);
+  if (!EFI_ERROR (Status) && (FileSize > MAX_UINT32)) {
+    Status = EFI_UNSUPPORTED;
+  }
+
+  if (!EFI_ERROR (Status)) {
+    *BufferSize = (UINTN)FileSize;
+    *Buffer     = AllocatePool (*BufferSize);
+    if (*Buffer == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+    } else {
+      Status = Shell->ReadFile (Handle, BufferSize, *Buffer);
+      if (EFI_ERROR (Status)) {
+        FreePool (*Buffer);
+      }
+    }
+  }
+
+  Shell->CloseFile (Handle);
+  return Status;
+}
+
+/**
+  Decode a GUIDed section several times and print the average time.
+
+  @param  Section                The GUIDed section.
+  @param  Iterations             The number of times to decode the section.
+
+**/
+VOID
+PerfDecodeSection (
+  IN EFI_COMMON_SECTION_HEADER  *Section,
+  IN UINTN                      Iterations
+  )
+{
+  EFI_GUID       *Guid;
+  UINT32         OutputSize;
+  UINT32         ScratchSize;
+  UINT16         Attributes;
+  VOID           *Output;
+  VOID           *OutputBuffer;
+  VOID           *Scratch;
+  UINT32         AuthenticationStatus;
+  UINT64         Start;
+  UINT64         Elapsed;
+  UINTN          Index;
+  RETURN_STATUS  Status;
+
+  if (IS_SECTION2 (Section)) {
+    Guid = &((EFI_GUID_DEFINED_SECTION2 *)Section)->SectionDefinitionGuid;
+  } else {
+    Guid = &((EFI_GUID_DEFINED_SECTION *)Section)->SectionDefinitionGuid;
+  }
+
+  Status = ExtractGuidedSectionGetInfo (Section, &OutputSize, &ScratchSize, &Attributes);
+  if (RETURN_ERROR (Status)) {
+    Print (L"  %g: no handler - %r\n", Guid, Status);
+    return;
+  }
+
+  Output  = AllocatePool (OutputSize);
+  Scratch = AllocatePool (ScratchSize);
+  if ((Output == NULL) || ((Scratch == NULL) && (ScratchSize != 0))) {
+    Print (L"  %g: cannot allocate %d + %d bytes\n", Guid, OutputSize, ScratchSize);
+    Status = RETURN_OUT_OF_RESOURCES;
+  }
+
+  Elapsed = 0;
+  for (Index = 0; Index < Iterations && !RETURN_ERROR (Status); Index++) {
+    OutputBuffer = Output;
+    Start        = GetPerformanceCounter ();
+    Status       = ExtractGuidedSectionDecode (Section, &OutputBuffer, Scratch, &AuthenticationStatus);
+    Elapsed     += GetElapsedTimeInNanoSecond (Start, GetPerformanceCounter ());
+  }
+
+  if (RETURN_ERROR (Status)) {
+    Print (L"  %g: decode failed - %r\n", Guid, Status);
+  } else {
+    Print (
+      L"  %g: %,d -> %,d bytes, %,ld us per decode\n",
+      Guid,
+      IS_SECTION2 (Section) ? SECTION2_SIZE (Section) : SECTION_SIZE (Section),
+      OutputSize,
+      DivU64x32 (Elapsed, (UINT32)Iterations) / 1000
+      );
+  }
+
+  if (Output != NULL) {
+    FreePool (Output);
+  }
+
+  if (Scratch != NULL) {
+    FreePool (Scratch);
+  }
+}
+
+/**
+  Decode the GUIDed sections of a section stream.
+
+  @param  Stream                 The section stream.
+  @param  StreamSize             The size of the section stream.
+  @param  Iterations             The number of times to decode each section.
+
+  @return The number of GUIDed sections found.
+
+**/
+UINTN
+PerfDecodeSectionStream (
+  IN UINT8  *Stream,
+  IN UINTN  StreamSize,
+  IN UINTN  Iterations
+  )
+{
+  EFI_COMMON_SECTION_HEADER  *Section;
+  UINTN                      Offset;
+  UINTN                      SectionSize;
+  UINTN                      Count;
+
+  Count  = 0;
+  Offset = 0;
+  while (Offset + sizeof (EFI_COMMON_SECTION_HEADER) <= StreamSize) {
+    Section     = (EFI_COMMON_SECTION_HEADER *)(Stream + Offset);
+    SectionSize = SECTION_SIZE (Section);
+    if (IS_SECTION2 (Section)) {
+      if (Offset + sizeof (EFI_COMMON_SECTION_HEADER2) > StreamSize) {
+        break;
+      }
+
+      SectionSize = SECTION2_SIZE (Section);
+    }
+
+    if ((SectionSize < sizeof (EFI_COMMON_SECTION_HEADER)) || (SectionSize > StreamSize - Offset)) {
+      break;
+    }
+
+    if (Section->Type == EFI_SECTION_GUID_DEFINED) {
+      PerfDecodeSection (Section, Iterations);
+      Count++;
+    }
+
+    Offset += ALIGN_VALUE (SectionSize, 4);
+  }
+
+  return Count;
+}
+
+/**
+  Decode the GUIDed sections of the files of a firmware volume.
+
+  @param  FvHeader               The firmware volume.
+  @param  FvSize                 The size of the firmware volume.
+  @param  Iterations             The number of times to decode each section.
+
+  @return The number of GUIDed sections found.
+
+**/
+UINTN
+PerfDecodeFv (
+  IN EFI_FIRMWARE_VOLUME_HEADER  *FvHeader,
+  IN UINTN                       FvSize,
+  IN UINTN                       Iterations
+  )
+{
+  EFI_FFS_FILE_HEADER  *File;
+  UINTN                Offset;
+  UINTN                FileSize;
+  UINTN                HeaderSize;
+  UINTN                Count;
+
+  Offset = FvHeader->HeaderLength;
+  if ((FvHeader->ExtHeaderOffset != 0) &&
+      (FvHeader->ExtHeaderOffset + sizeof (EFI_FIRMWARE_VOLUME_EXT_HEADER) <= FvSize))
+  {
+    Offset = FvHeader->ExtHeaderOffset +
+             ((EFI_FIRMWARE_VOLUME_EXT_HEADER *)((UINT8 *)FvHeader + FvHeader->ExtHeaderOffset))->ExtHeaderSize;
+  }
+
+  FvSize = MIN (FvSize, FvHeader->FvLength);
+  Count  = 0;
+  for (Offset = ALIGN_VALUE (Offset, 8); Offset + sizeof (EFI_FFS_FILE_HEADER) <= FvSize; Offset = ALIGN_VALUE (Offset + FileSize, 8)) {
+    File       = (EFI_FFS_FILE_HEADER *)((UINT8 *)FvHeader + Offset);
+    FileSize   = FFS_FILE_SIZE (File);
+    HeaderSize = sizeof (EFI_FFS_FILE_HEADER);
+    if (IS_FFS_FILE2 (File)) {
+      if (Offset + sizeof (EFI_FFS_FILE_HEADER2) > FvSize) {
+        break;
+      }
+
+      FileSize   = FFS_FILE2_SIZE (File);
+      HeaderSize = sizeof (EFI_FFS_FILE_HEADER2);
+    }
+
+    //
+    // Erased space ends the files
+    //
+    if ((FileSize < HeaderSize) || (FileSize > FvSize - Offset)) {
+      break;
+    }
+
+    if ((File->Type == EFI_FV_FILETYPE_RAW) || (File->Type == EFI_FV_FILETYPE_FFS_PAD)) {
+      continue;
+    }
+
+    Print (L"%g:\n", &File->Name);
+    Count += PerfDecodeSectionStream ((UINT8 *)File + HeaderSize, FileSize - HeaderSize, Iterations);
+  }
+
+  return Count;
+}
+
+/**
+  The user Entry Point for Application. The user code starts with this function
+  as the real entry point for the image goes into a library that calls this
+  function.
+
+  @param[in] ImageHandle    The firmware allocated handle for the EFI image.
+  @param[in] SystemTable    A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS       The entry point is executed successfully.
+  @retval other             Some error occurs when executing this entry point.
+
+**/
+EFI_STATUS
+EFIAPI
+UefiMain (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS                     Status;
+  EFI_SHELL_PARAMETERS_PROTOCOL  *ShellParameters;
+  EFI_FIRMWARE_VOLUME_HEADER     *FvHeader;
+  UINTN                          Iterations;
+  VOID                           *Buffer;
+  UINTN                          BufferSize;
+  UINTN                          Count;
+
+  Status = gBS->HandleProtocol (
+                  ImageHandle,
+                  &gEfiShellParametersProtocolGuid,
+                  (VOID **)&ShellParameters
+                  );
+  if (EFI_ERROR (Status) || (ShellParameters->Argc < 2) || (ShellParameters->Argc > 3)) {
+    Print (L"Usage: DecompressPerf <FvOrSectionFile> [Iterations]\n");
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Iterations = PERF_DEFAULT_ITERATIONS;
+  if (ShellParameters->Argc == 3) {
+    Iterations = StrDecimalToUintn (ShellParameters->Argv[2]);
+    if ((Iterations == 0) || (Iterations > MAX_UINT32)) {
+      Print (L"DecompressPerf: invalid iteration count\n");
+      return EFI_INVALID_PARAMETER;
+    }
+  }
+
+  Status = PerfReadFile (ShellParameters->Argv[1], &BufferSize, &Buffer);
+  if (EFI_ERROR (Status)) {
+    Print (L"DecompressPerf: cannot read %s - %r\n", ShellParameters->Argv[1], Status);
+    return Status;
+  }
+
+  FvHeader = Buffer;
+  if ((BufferSize >= sizeof (EFI_FIRMWARE_VOLUME_HEADER)) &&
+      (FvHeader->Signature == EFI_FVH_SIGNATURE) &&
+      (FvHeader->HeaderLength <= BufferSize))
+  {
+    Count = PerfDecodeFv (FvHeader, BufferSize, Iterations);
+  } else {
+    Count = PerfDecodeSectionStream (Buffer, BufferSize, Iterations);
+  }
+
+  if (Count == 0) {
+    Print (L"DecompressPerf: no GUIDed section found\n");
+  }
+
+  FreePool (Buffer);
+  return EFI_SUCCESS;
+}
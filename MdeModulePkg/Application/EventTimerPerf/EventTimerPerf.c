@@ -0,0 +1,169 @@
+/** @file
+  Shell application to stress the timer services of the DXE core.
+
+  The application creates PERF_TIMER_COUNT periodic timer events with periods
+  spread over PERF_MIN_PERIOD to PERF_MAX_PERIOD, lets them run, then reports
+  the average time to arm, re-arm and cancel a timer with that many timers
+  armed, and the number of notifications delivered.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiLib.h>
+#include <Library/UefiApplicationEntryPoint.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/TimerLib.h>
+#include <Library/ElapsedTimeLib.h>
+
+#define PERF_TIMER_COUNT  4096
+
+//
+// Timer periods in 100ns units
+//
+#define PERF_MIN_PERIOD  EFI_TIMER_PERIOD_MILLISECONDS (1)
+#define PERF_MAX_PERIOD  EFI_TIMER_PERIOD_MILLISECONDS (100)
+
+//
+// Time the timers are left running, in microseconds
+//
+#define PERF_RUN_TIME  1000000
+
+EFI_EVENT  *mPerfEvents;
+UINTN      mPerfNotifyCount;
+
+/**
+  Notification function of the timer events.
+
+  @param  Event                  The event that was signaled.
+  @param  Context                Not used.
+
+**/
+VOID
+EFIAPI
+PerfTimerNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  mPerfNotifyCount++;
+}
+
+/**
+  Get the period of one of the timers.
+
+  @param  Index                  Index of the timer.
+
+  @return The period in 100ns units.
+
+**/
+UINT64
+GetPerfTimerPeriod (
+  IN UINTN  Index
+  )
+{
+  //
+  // Spread the periods with a multiplicative hash, so that timers with close
+  // periods are not armed in sequence.
+  //
+  return PERF_MIN_PERIOD + ((UINT32)(Index * 0x9E3779B1U) % (PERF_MAX_PERIOD - PERF_MIN_PERIOD));
+}
+
+/**
+  Set all the timers to a given type and report the average time per call.
+
+  @param  Type                   TimerPeriodic or TimerCancel.
+
+  @return Average nanoseconds per SetTimer () call.
+
+**/
+UINT64
+MeasureSetTimer (
+  IN EFI_TIMER_DELAY  Type
+  )
+{
+  UINTN   Index;
+  UINT64  Start;
+
+  Start = GetPerformanceCounter ();
+  for (Index = 0; Index < PERF_TIMER_COUNT; Index++) {
+    gBS->SetTimer (
+           mPerfEvents[Index],
+           Type,
+           (Type == TimerCancel) ? 0 : GetPerfTimerPeriod (Index)
+           );
+  }
+
+  return DivU64x32 (GetElapsedTimeInNanoSecond (Start, GetPerformanceCounter ()), PERF_TIMER_COUNT);
+}
+
+/**
+  The user Entry Point for Application. The user code starts with this function
+  as the real entry point for the application.
+
+  @param[in] ImageHandle    The firmware allocated handle for the EFI image.
+  @param[in] SystemTable    A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS       The entry point is executed successfully.
+  @retval other             Some error occurs when executing this entry point.
+
+**/
+EFI_STATUS
+EFIAPI
+UefiMain (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Index;
+  UINT64      ArmTime;
+  UINT64      RearmTime;
+  UINT64      CancelTime;
+
+  mPerfEvents = AllocateZeroPool (PERF_TIMER_COUNT * sizeof (EFI_EVENT));
+  if (mPerfEvents == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = EFI_SUCCESS;
+  for (Index = 0; Index < PERF_TIMER_COUNT; Index++) {
+    Status = gBS->CreateEvent (
+                    EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                    TPL_CALLBACK,
+                    PerfTimerNotify,
+                    NULL,
+                    &mPerfEvents[Index]
+                    );
+    if (EFI_ERROR (Status)) {
+      Print (L"EventTimerPerf: failed to create timer events - %r\n", Status);
+      goto Done;
+    }
+  }
+
+  mPerfNotifyCount = 0;
+  ArmTime          = MeasureSetTimer (TimerPeriodic);
+  gBS->Stall (PERF_RUN_TIME);
+  RearmTime  = MeasureSetTimer (TimerPeriodic);
+  CancelTime = MeasureSetTimer (TimerCancel);
+
+  Print (L"%d periodic timers, run for %d us\n", PERF_TIMER_COUNT, PERF_RUN_TIME);
+  Print (L"  Arm              %,ld ns/call\n", ArmTime);
+  Print (L"  Re-arm           %,ld ns/call\n", RearmTime);
+  Print (L"  Cancel           %,ld ns/call\n", CancelTime);
+  Print (L"  Notifications    %,ld\n", (UINT64)mPerfNotifyCount);
+
+Done:
+  for (Index = 0; Index < PERF_TIMER_COUNT; Index++) {
+    if (mPerfEvents[Index] != NULL) {
+      gBS->CloseEvent (mPerfEvents[Index]);
+    }
+  }
+
+  FreePool (mPerfEvents);
+  return Status;
+}
@@ -0,0 +1,283 @@
+/** @file
+  Shell application to dump the pool and page telemetry of the DXE core.
+
+  The application gets a snapshot of the counters from the Memory Telemetry
+  protocol and prints the allocation counters per memory type, a histogram of
+  the pool allocations per block size class, and the hold time of the pool and
+  page locks. "-r" resets the counters after printing them, so the next run
+  only reports the allocations done in between.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiLib.h>
+#include <Library/UefiApplicationEntryPoint.h>
+#include <Library/UefiBootServicesTableLib.h>
+
+#include <Protocol/MemoryTelemetry.h>
+#include <Protocol/ShellParameters.h>
+
+//
+// Width of the longest histogram bar
+//
+#define TELEMETRY_BAR_WIDTH  40
+
+CHAR16  *mMemoryTypeString[] = {
+  L"EfiReservedMemoryType",
+  L"EfiLoaderCode",
+  L"EfiLoaderData",
+  L"EfiBootServicesCode",
+  L"EfiBootServicesData",
+  L"EfiRuntimeServicesCode",
+  L"EfiRuntimeServicesData",
+  L"EfiConventionalMemory",
+  L"EfiUnusableMemory",
+  L"EfiACPIReclaimMemory",
+  L"EfiACPIMemoryNVS",
+  L"EfiMemoryMappedIO",
+  L"EfiMemoryMappedIOPortSpace",
+  L"EfiPalCode",
+  L"EfiPersistentMemory",
+  L"EfiUnacceptedMemoryType",
+};
+
+/**
+  Memory type to string.
+
+  @param  MemoryType             The memory type of a telemetry record.
+
+  @return Pointer to string.
+
+**/
+CHAR16 *
+TelemetryMemoryTypeToString (
+  IN UINT32  MemoryType
+  )
+{
+  if (MemoryType < ARRAY_SIZE (mMemoryTypeString)) {
+    return mMemoryTypeString[MemoryType];
+  }
+
+  if (MemoryType >= MEMORY_TYPE_OEM_RESERVED_MIN) {
+    return L"EfiOemReserved/EfiOSReserved";
+  }
+
+  return L"Unknown";
+}
+
+/**
+  Convert timer ticks to nanoseconds.
+
+  @param  Ticks                  The number of ticks.
+  @param  TimerPeriod            The period of a tick in femtoseconds.
+
+  @return The time in nanoseconds.
+
+**/
+UINT64
+TelemetryTicksToNanoSeconds (
+  IN UINT64  Ticks,
+  IN UINT64  TimerPeriod
+  )
+{
+  return DivU64x32 (MultU64x64 (Ticks, TimerPeriod), 1000000);
+}
+
+/**
+  Print the counters of a lock.
+
+  @param  Name                   The name of the lock.
+  @param  Lock                   The counters of the lock.
+  @param  TimerPeriod            The period of a tick in femtoseconds, or 0.
+
+**/
+VOID
+TelemetryPrintLock (
+  IN CHAR16                       *Name,
+  IN EDKII_MEMORY_TELEMETRY_LOCK  *Lock,
+  IN UINT64                       TimerPeriod
+  )
+{
+  Print (L"  %s: %,ld acquisitions", Name, Lock->Acquisitions);
+  if (TimerPeriod != 0) {
+    Print (
+      L", %,ld ns held, %,ld ns max",
+      TelemetryTicksToNanoSeconds (Lock->HoldTicks, TimerPeriod),
+      TelemetryTicksToNanoSeconds (Lock->MaxHoldTicks, TimerPeriod)
+      );
+  }
+
+  Print (L"\n");
+}
+
+/**
+  Print the telemetry data.
+
+  @param  Header                 The telemetry data returned by the protocol.
+
+**/
+VOID
+TelemetryPrint (
+  IN EDKII_MEMORY_TELEMETRY_HEADER  *Header
+  )
+{
+  EDKII_MEMORY_TELEMETRY_TYPE        *Type;
+  EDKII_MEMORY_TELEMETRY_POOL_CLASS  *Class;
+  UINT64                             MaxAllocations;
+  UINTN                              Bar;
+  UINTN                              Index;
+
+  Type  = (EDKII_MEMORY_TELEMETRY_TYPE *)((UINT8 *)Header + Header->Length);
+  Class = (EDKII_MEMORY_TELEMETRY_POOL_CLASS *)(Type + Header->MemoryTypeCount);
+
+  Print (L"Locks:\n");
+  TelemetryPrintLock (L"Pool", &Header->PoolLock, Header->TimerPeriod);
+  TelemetryPrintLock (L"Page", &Header->PageLock, Header->TimerPeriod);
+
+  Print (L"\nPool and pages per memory type:\n");
+  for (Index = 0; Index < Header->MemoryTypeCount; Index++) {
+    if ((Type[Index].PoolAllocations == 0) && (Type[Index].PoolFailures == 0) &&
+        (Type[Index].PageAllocations == 0) && (Type[Index].PageFailures == 0))
+    {
+      continue;
+    }
+
+    Print (L"  %s\n", TelemetryMemoryTypeToString (Type[Index].MemoryType));
+    Print (
+      L"    Pool:  %,ld allocations, %,ld frees, %,ld failures, %,ld page fallbacks\n",
+      Type[Index].PoolAllocations,
+      Type[Index].PoolFrees,
+      Type[Index].PoolFailures,
+      Type[Index].PoolPageFallbacks
+      );
+    Print (
+      L"           %,ld bytes allocated, %,ld bytes freed\n",
+      Type[Index].PoolBytesAllocated,
+      Type[Index].PoolBytesFreed
+      );
+    Print (
+      L"    Pages: %,ld allocations, %,ld frees, %,ld failures, %,ld pages allocated, %,ld pages freed\n",
+      Type[Index].PageAllocations,
+      Type[Index].PageFrees,
+      Type[Index].PageFailures,
+      Type[Index].PagesAllocated,
+      Type[Index].PagesFreed
+      );
+  }
+
+  MaxAllocations = 0;
+  for (Index = 0; Index < Header->PoolClassCount; Index++) {
+    MaxAllocations = MAX (MaxAllocations, Class[Index].Allocations);
+  }
+
+  Print (L"\nPool allocations per block size, including pool head and tail:\n");
+  Print (L"  %12s %12s %12s %12s %14s\n", L"Size", L"Allocations", L"Frees", L"Fallbacks", L"Bytes");
+  for (Index = 0; Index < Header->PoolClassCount; Index++) {
+    if (Class[Index].MaxSize == MAX_UINT64) {
+      Print (L"  >%,11ld", Class[Index - 1].MaxSize);
+    } else {
+      Print (L"  <=%,10ld", Class[Index].MaxSize);
+    }
+
+    Print (
+      L" %,12ld %,12ld %,12ld %,14ld ",
+      Class[Index].Allocations,
+      Class[Index].Frees,
+      Class[Index].PageFallbacks,
+      Class[Index].BytesAllocated
+      );
+
+    Bar = 0;
+    if (MaxAllocations != 0) {
+      Bar = (UINTN)DivU64x64Remainder (
+                     MultU64x32 (Class[Index].Allocations, TELEMETRY_BAR_WIDTH) + MaxAllocations - 1,
+                     MaxAllocations,
+                     NULL
+                     );
+    }
+
+    while (Bar-- > 0) {
+      Print (L"#");
+    }
+
+    Print (L"\n");
+  }
+}
+
+/**
+  The user Entry Point for Application. The user code starts with this function
+  as the real entry point for the image goes into a library that calls this
+  function.
+
+  @param[in] ImageHandle    The firmware allocated handle for the EFI image.
+  @param[in] SystemTable    A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS       The entry point is executed successfully.
+  @retval other             Some error occurs when executing this entry point.
+
+**/
+EFI_STATUS
+EFIAPI
+UefiMain (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS                       Status;
+  EDKII_MEMORY_TELEMETRY_PROTOCOL  *Telemetry;
+  EFI_SHELL_PARAMETERS_PROTOCOL    *ShellParameters;
+  BOOLEAN                          Reset;
+  VOID                             *Data;
+  UINTN                            DataSize;
+
+  Reset  = FALSE;
+  Status = gBS->HandleProtocol (
+                  ImageHandle,
+                  &gEfiShellParametersProtocolGuid,
+                  (VOID **)&ShellParameters
+                  );
+  if (!EFI_ERROR (Status) && (ShellParameters->Argc > 1)) {
+    if ((ShellParameters->Argc != 2) || (StrCmp (ShellParameters->Argv[1], L"-r") != 0)) {
+      Print (L"Usage: MemoryTelemetryInfo [-r]\n");
+      return EFI_INVALID_PARAMETER;
+    }
+
+    Reset = TRUE;
+  }
+
+  Status = gBS->LocateProtocol (&gEdkiiMemoryTelemetryProtocolGuid, NULL, (VOID **)&Telemetry);
+  if (EFI_ERROR (Status)) {
+    Print (L"MemoryTelemetryInfo: Memory Telemetry protocol not found - %r\n", Status);
+    return Status;
+  }
+
+  //
+  // Size the buffer first; allocating it does not change the size needed
+  //
+  DataSize = 0;
+  Status   = Telemetry->GetData (Telemetry, &DataSize, NULL);
+  if (Status != EFI_BUFFER_TOO_SMALL) {
+    return Status;
+  }
+
+  Data = AllocatePool (DataSize);
+  if (Data == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = Telemetry->GetData (Telemetry, &DataSize, Data);
+  if (!EFI_ERROR (Status)) {
+    TelemetryPrint (Data);
+    if (Reset) {
+      Status = Telemetry->Reset (Telemetry);
+    }
+  }
+
+  FreePool (Data);
+  return Status;
+}
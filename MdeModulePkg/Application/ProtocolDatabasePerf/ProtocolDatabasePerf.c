@@ -0,0 +1,279 @@
+/** @file
+  Shell application to measure the cost of the boot services that look up the
+  protocol database.
+
+  The application installs PERF_HANDLE_COUNT handles, spread over
+  PERF_PROTOCOL_COUNT different protocols, then reports the average time of
+  HandleProtocol (), OpenProtocol (), LocateProtocol () and of the handle
+  validation done for an unknown handle.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiLib.h>
+#include <Library/UefiApplicationEntryPoint.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/TimerLib.h>
+#include <Library/ElapsedTimeLib.h>
+
+#define PERF_HANDLE_COUNT     1024
+#define PERF_PROTOCOL_COUNT   256
+#define PERF_ITERATION_COUNT  100000
+
+//
+// Protocols installed by the application are this GUID with Data1 increased
+// by the protocol index.
+//
+EFI_GUID  mPerfProtocolGuidBase = {
+  0xa2407908, 0x8e5d, 0x4d57, { 0xb9, 0x0c, 0x8f, 0x7b, 0x36, 0xbd, 0x7d, 0x7d }
+};
+
+EFI_HANDLE  *mPerfHandles;
+UINTN       *mPerfInterfaces;
+
+/**
+  Get the GUID of one of the protocols installed by the application.
+
+  @param  Index                  Index of the protocol.
+  @param  Guid                   Returns the GUID.
+
+**/
+VOID
+GetPerfProtocolGuid (
+  IN  UINTN     Index,
+  OUT EFI_GUID  *Guid
+  )
+{
+  CopyGuid (Guid, &mPerfProtocolGuidBase);
+  Guid->Data1 += (UINT32)(Index % PERF_PROTOCOL_COUNT);
+}
+
+/**
+  Install one protocol on each of PERF_HANDLE_COUNT new handles.
+
+  @retval EFI_SUCCESS            All the handles were created.
+  @retval Others                 A handle could not be created.
+
+**/
+EFI_STATUS
+InstallPerfHandles (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Index;
+  EFI_GUID    Guid;
+
+  mPerfHandles    = AllocateZeroPool (PERF_HANDLE_COUNT * sizeof (EFI_HANDLE));
+  mPerfInterfaces = AllocateZeroPool (PERF_HANDLE_COUNT * sizeof (UINTN));
+  if ((mPerfHandles == NULL) || (mPerfInterfaces == NULL)) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (Index = 0; Index < PERF_HANDLE_COUNT; Index++) {
+    GetPerfProtocolGuid (Index, &Guid);
+    Status = gBS->InstallProtocolInterface (
+                    &mPerfHandles[Index],
+                    &Guid,
+                    EFI_NATIVE_INTERFACE,
+                    &mPerfInterfaces[Index]
+                    );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Uninstall the protocols installed by InstallPerfHandles ().
+
+**/
+VOID
+UninstallPerfHandles (
+  VOID
+  )
+{
+  UINTN     Index;
+  EFI_GUID  Guid;
+
+  if ((mPerfHandles != NULL) && (mPerfInterfaces != NULL)) {
+    for (Index = 0; Index < PERF_HANDLE_COUNT; Index++) {
+      if (mPerfHandles[Index] != NULL) {
+        GetPerfProtocolGuid (Index, &Guid);
+        gBS->UninstallProtocolInterface (mPerfHandles[Index], &Guid, &mPerfInterfaces[Index]);
+      }
+    }
+  }
+
+  if (mPerfHandles != NULL) {
+    FreePool (mPerfHandles);
+  }
+
+  if (mPerfInterfaces != NULL) {
+    FreePool (mPerfInterfaces);
+  }
+}
+
+/**
+  Measure HandleProtocol () on the installed handles.
+
+  @return Average nanoseconds per call.
+
+**/
+UINT64
+MeasureHandleProtocol (
+  VOID
+  )
+{
+  UINTN     Index;
+  UINTN     Iteration;
+  EFI_GUID  Guid;
+  VOID      *Interface;
+  UINT64    Start;
+
+  Start = GetPerformanceCounter ();
+  for (Iteration = 0; Iteration < PERF_ITERATION_COUNT; Iteration++) {
+    Index = Iteration % PERF_HANDLE_COUNT;
+    GetPerfProtocolGuid (Index, &Guid);
+    gBS->HandleProtocol (mPerfHandles[Index], &Guid, &Interface);
+  }
+
+  return DivU64x32 (GetElapsedTimeInNanoSecond (Start, GetPerformanceCounter ()), PERF_ITERATION_COUNT);
+}
+
+/**
+  Measure OpenProtocol (GET_PROTOCOL) on the installed handles.
+
+  @param  ImageHandle            The agent opening the protocols.
+
+  @return Average nanoseconds per call.
+
+**/
+UINT64
+MeasureOpenProtocol (
+  IN EFI_HANDLE  ImageHandle
+  )
+{
+  UINTN     Index;
+  UINTN     Iteration;
+  EFI_GUID  Guid;
+  VOID      *Interface;
+  UINT64    Start;
+
+  Start = GetPerformanceCounter ();
+  for (Iteration = 0; Iteration < PERF_ITERATION_COUNT; Iteration++) {
+    Index = Iteration % PERF_HANDLE_COUNT;
+    GetPerfProtocolGuid (Index, &Guid);
+    gBS->OpenProtocol (
+           mPerfHandles[Index],
+           &Guid,
+           &Interface,
+           ImageHandle,
+           NULL,
+           EFI_OPEN_PROTOCOL_GET_PROTOCOL
+           );
+  }
+
+  return DivU64x32 (GetElapsedTimeInNanoSecond (Start, GetPerformanceCounter ()), PERF_ITERATION_COUNT);
+}
+
+/**
+  Measure LocateProtocol () on the installed protocols.
+
+  @return Average nanoseconds per call.
+
+**/
+UINT64
+MeasureLocateProtocol (
+  VOID
+  )
+{
+  UINTN     Iteration;
+  EFI_GUID  Guid;
+  VOID      *Interface;
+  UINT64    Start;
+
+  Start = GetPerformanceCounter ();
+  for (Iteration = 0; Iteration < PERF_ITERATION_COUNT; Iteration++) {
+    GetPerfProtocolGuid (Iteration, &Guid);
+    gBS->LocateProtocol (&Guid, NULL, &Interface);
+  }
+
+  return DivU64x32 (GetElapsedTimeInNanoSecond (Start, GetPerformanceCounter ()), PERF_ITERATION_COUNT);
+}
+
+/**
+  Measure HandleProtocol () on a handle that is not in the handle database.
+
+  @return Average nanoseconds per call.
+
+**/
+UINT64
+MeasureInvalidHandle (
+  VOID
+  )
+{
+  UINTN     Iteration;
+  EFI_GUID  Guid;
+  VOID      *Interface;
+  UINT64    Start;
+
+  GetPerfProtocolGuid (0, &Guid);
+
+  Start = GetPerformanceCounter ();
+  for (Iteration = 0; Iteration < PERF_ITERATION_COUNT; Iteration++) {
+    gBS->HandleProtocol ((EFI_HANDLE)&Iteration, &Guid, &Interface);
+  }
+
+  return DivU64x32 (GetElapsedTimeInNanoSecond (Start, GetPerformanceCounter ()), PERF_ITERATION_COUNT);
+}
+
+/**
+  The user Entry Point for Application. The user code starts with this function
+  as the real entry point for the application.
+
+  @param[in] ImageHandle    The firmware allocated handle for the EFI image.
+  @param[in] SystemTable    A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS       The entry point is executed successfully.
+  @retval other             Some error occurs when executing this entry point.
+
+**/
+EFI_STATUS
+EFIAPI
+UefiMain (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = InstallPerfHandles ();
+  if (EFI_ERROR (Status)) {
+    Print (L"ProtocolDatabasePerf: failed to install handles - %r\n", Status);
+    UninstallPerfHandles ();
+    return Status;
+  }
+
+  Print (
+    L"%d handles, %d protocols, %d iterations\n",
+    PERF_HANDLE_COUNT,
+    PERF_PROTOCOL_COUNT,
+    PERF_ITERATION_COUNT
+    );
+  Print (L"  HandleProtocol   %,ld ns/call\n", MeasureHandleProtocol ());
+  Print (L"  OpenProtocol     %,ld ns/call\n", MeasureOpenProtocol (ImageHandle));
+  Print (L"  LocateProtocol   %,ld ns/call\n", MeasureLocateProtocol ());
+  Print (L"  Invalid handle   %,ld ns/call\n", MeasureInvalidHandle ());
+
+  UninstallPerfHandles ();
+  return EFI_SUCCESS;
+}
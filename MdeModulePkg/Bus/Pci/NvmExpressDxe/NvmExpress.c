@@ -2,7 +2,7 @@
   NvmExpressDxe driver is used to manage non-volatile memory subsystem which follows
   NVM Express specification.
 
-  Copyright (c) 2013 - 2017, Intel Corporation. All rights reserved.<BR>
+  Copyright (c) 2013 - 2026, Intel Corporation. All rights reserved.<BR>
   Copyright (c) Microsoft Corporation.<BR>
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -555,39 +555,26 @@ UnregisterNvmeNamespace (
 }
 
 /**
-  Call back function when the timer event is signaled.
+  Submit the pending BlockIo2 subtasks to the asynchronous I/O queues, until
+  all of them are submitted or the queues are full.
 
-  @param[in]  Event     The Event this notify function registered to.
-  @param[in]  Context   Pointer to the context data registered to the
-                        Event.
+  The caller must be at TPL_NOTIFY.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
 
 **/
 VOID
-EFIAPI
-ProcessAsyncTaskList (
-  IN EFI_EVENT  Event,
-  IN VOID       *Context
+NvmeSubmitAsyncSubtasks (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
   )
 {
-  NVME_CONTROLLER_PRIVATE_DATA  *Private;
-  EFI_PCI_IO_PROTOCOL           *PciIo;
-  NVME_CQ                       *Cq;
-  UINT16                        QueueId;
-  UINT32                        Data;
-  LIST_ENTRY                    *Link;
-  LIST_ENTRY                    *NextLink;
-  NVME_PASS_THRU_ASYNC_REQ      *AsyncRequest;
-  NVME_BLKIO2_SUBTASK           *Subtask;
-  NVME_BLKIO2_REQUEST           *BlkIo2Request;
-  EFI_BLOCK_IO2_TOKEN           *Token;
-  BOOLEAN                       HasNewItem;
-  EFI_STATUS                    Status;
-
-  Private    = (NVME_CONTROLLER_PRIVATE_DATA *)Context;
-  QueueId    = 2;
-  Cq         = Private->CqBuffer[QueueId] + Private->CqHdbl[QueueId].Cqh;
-  HasNewItem = FALSE;
-  PciIo      = Private->PciIo;
+  LIST_ENTRY           *Link;
+  LIST_ENTRY           *NextLink;
+  NVME_BLKIO2_SUBTASK  *Subtask;
+  NVME_BLKIO2_REQUEST  *BlkIo2Request;
+  EFI_BLOCK_IO2_TOKEN  *Token;
+  EFI_STATUS           Status;
 
   //
   // Submit asynchronous subtasks to the NVMe Submission Queue
@@ -662,87 +649,130 @@ ProcessAsyncTaskList (
       }
     }
   }
+}
 
-  while (Cq->Pt != Private->Pt[QueueId]) {
-    ASSERT (Cq->Sqid == QueueId);
+/**
+  Call back function when the timer event is signaled.
 
-    HasNewItem = TRUE;
+  @param[in]  Event     The Event this notify function registered to.
+  @param[in]  Context   Pointer to the context data registered to the
+                        Event.
 
-    //
-    // Find the command with given Command Id.
-    //
-    for (Link = GetFirstNode (&Private->AsyncPassThruQueue);
-         !IsNull (&Private->AsyncPassThruQueue, Link);
-         Link = NextLink)
-    {
-      NextLink     = GetNextNode (&Private->AsyncPassThruQueue, Link);
-      AsyncRequest = NVME_PASS_THRU_ASYNC_REQ_FROM_THIS (Link);
-      if (AsyncRequest->CommandId == Cq->Cid) {
-        //
-        // Copy the Respose Queue entry for this command to the callers
-        // response buffer.
-        //
-        CopyMem (
-          AsyncRequest->Packet->NvmeCompletion,
-          Cq,
-          sizeof (EFI_NVM_EXPRESS_COMPLETION)
-          );
+**/
+VOID
+EFIAPI
+ProcessAsyncTaskList (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  NVME_CONTROLLER_PRIVATE_DATA  *Private;
+  EFI_PCI_IO_PROTOCOL           *PciIo;
+  NVME_CQ                       *Cq;
+  UINT16                        QueueId;
+  UINT32                        Data;
+  LIST_ENTRY                    *Link;
+  LIST_ENTRY                    *NextLink;
+  NVME_PASS_THRU_ASYNC_REQ      *AsyncRequest;
+  BOOLEAN                       HasNewItem;
 
-        //
-        // Free the resources allocated before cmd submission
-        //
-        if (AsyncRequest->MapData != NULL) {
-          PciIo->Unmap (PciIo, AsyncRequest->MapData);
-        }
+  Private = (NVME_CONTROLLER_PRIVATE_DATA *)Context;
+  PciIo   = Private->PciIo;
 
-        if (AsyncRequest->MapMeta != NULL) {
-          PciIo->Unmap (PciIo, AsyncRequest->MapMeta);
-        }
+  //
+  // Reap the completed commands first, so that the subtasks submitted below
+  // can use the queue entries they free.
+  //
+  for (QueueId = NVME_ASYNC_QUEUE_ID; QueueId < NVME_ASYNC_QUEUE_ID + Private->AsyncQueueNum; QueueId++) {
+    Cq         = Private->CqBuffer[QueueId] + Private->CqHdbl[QueueId].Cqh;
+    HasNewItem = FALSE;
 
-        if (AsyncRequest->MapPrpList != NULL) {
-          PciIo->Unmap (PciIo, AsyncRequest->MapPrpList);
-        }
+    while (Cq->Pt != Private->Pt[QueueId]) {
+      ASSERT (Cq->Sqid == QueueId);
 
-        if (AsyncRequest->PrpListHost != NULL) {
-          PciIo->FreeBuffer (
-                   PciIo,
-                   AsyncRequest->PrpListNo,
-                   AsyncRequest->PrpListHost
-                   );
-        }
+      HasNewItem = TRUE;
 
-        RemoveEntryList (Link);
-        gBS->SignalEvent (AsyncRequest->CallerEvent);
-        FreePool (AsyncRequest);
+      //
+      // Find the command with given Command Id. Command Ids are unique per
+      // submission queue only.
+      //
+      for (Link = GetFirstNode (&Private->AsyncPassThruQueue);
+           !IsNull (&Private->AsyncPassThruQueue, Link);
+           Link = NextLink)
+      {
+        NextLink     = GetNextNode (&Private->AsyncPassThruQueue, Link);
+        AsyncRequest = NVME_PASS_THRU_ASYNC_REQ_FROM_THIS (Link);
+        if ((AsyncRequest->QueueId == QueueId) && (AsyncRequest->CommandId == Cq->Cid)) {
+          //
+          // Copy the Respose Queue entry for this command to the callers
+          // response buffer.
+          //
+          CopyMem (
+            AsyncRequest->Packet->NvmeCompletion,
+            Cq,
+            sizeof (EFI_NVM_EXPRESS_COMPLETION)
+            );
+
+          //
+          // Free the resources allocated before cmd submission
+          //
+          if (AsyncRequest->MapData != NULL) {
+            PciIo->Unmap (PciIo, AsyncRequest->MapData);
+          }
+
+          if (AsyncRequest->MapMeta != NULL) {
+            PciIo->Unmap (PciIo, AsyncRequest->MapMeta);
+          }
+
+          if (AsyncRequest->PrpList != NULL) {
+            NvmePutPrpList (Private, AsyncRequest->PrpList);
+          }
+
+          if (AsyncRequest->MapPrpList != NULL) {
+            PciIo->Unmap (PciIo, AsyncRequest->MapPrpList);
+          }
+
+          if (AsyncRequest->PrpListHost != NULL) {
+            PciIo->FreeBuffer (
+                     PciIo,
+                     AsyncRequest->PrpListNo,
+                     AsyncRequest->PrpListHost
+                     );
+          }
+
+          RemoveEntryList (Link);
+          gBS->SignalEvent (AsyncRequest->CallerEvent);
+          FreePool (AsyncRequest);
+
+          ASSERT (Private->AsyncQueueInFlight[QueueId] > 0);
+          Private->AsyncQueueInFlight[QueueId]--;
+          break;
+        }
+      }
 
-        //
-        // Update submission queue head.
-        //
-        Private->AsyncSqHead = Cq->Sqhd;
-        break;
+      Private->CqHdbl[QueueId].Cqh++;
+      if (Private->CqHdbl[QueueId].Cqh > Private->AsyncQueueSize) {
+        Private->CqHdbl[QueueId].Cqh = 0;
+        Private->Pt[QueueId]        ^= 1;
       }
-    }
 
-    Private->CqHdbl[QueueId].Cqh++;
-    if (Private->CqHdbl[QueueId].Cqh > MIN (NVME_ASYNC_CCQ_SIZE, Private->Cap.Mqes)) {
-      Private->CqHdbl[QueueId].Cqh = 0;
-      Private->Pt[QueueId]        ^= 1;
+      Cq = Private->CqBuffer[QueueId] + Private->CqHdbl[QueueId].Cqh;
     }
 
-    Cq = Private->CqBuffer[QueueId] + Private->CqHdbl[QueueId].Cqh;
+    if (HasNewItem) {
+      Data = ReadUnaligned32 ((UINT32 *)&Private->CqHdbl[QueueId]);
+      PciIo->Mem.Write (
+                   PciIo,
+                   EfiPciIoWidthUint32,
+                   NVME_BAR,
+                   NVME_CQHDBL_OFFSET (QueueId, Private->Cap.Dstrd),
+                   1,
+                   &Data
+                   );
+    }
   }
 
-  if (HasNewItem) {
-    Data = ReadUnaligned32 ((UINT32 *)&Private->CqHdbl[QueueId]);
-    PciIo->Mem.Write (
-                 PciIo,
-                 EfiPciIoWidthUint32,
-                 NVME_BAR,
-                 NVME_CQHDBL_OFFSET (QueueId, Private->Cap.Dstrd),
-                 1,
-                 &Data
-                 );
-  }
+  NvmeSubmitAsyncSubtasks (Private);
 }
 
 /**
@@ -957,6 +987,8 @@ NvmExpressDriverBindingStart (
   EFI_PHYSICAL_ADDRESS                MappedAddr;
   UINTN                               Bytes;
   EFI_NVM_EXPRESS_PASS_THRU_PROTOCOL  *Passthru;
+  UINT16                              AsyncQueueNum;
+  UINT16                              AsyncQueueEntries;
 
   DEBUG ((DEBUG_INFO, "NvmExpressDriverBindingStart: start\n"));
 
@@ -1001,6 +1033,8 @@ NvmExpressDriverBindingStart (
       goto Exit;
     }
 
+    InitializeListHead (&Private->FreePrpLists);
+
     //
     // Save original PCI attributes
     //
@@ -1029,21 +1063,23 @@ NvmExpressDriverBindingStart (
     }
 
     //
-    // 6 x 4kB aligned buffers will be carved out of this buffer.
+    // All the submission & completion queues will be carved out of this buffer.
     // 1st 4kB boundary is the start of the admin submission queue.
     // 2nd 4kB boundary is the start of the admin completion queue.
     // 3rd 4kB boundary is the start of I/O submission queue #1.
     // 4th 4kB boundary is the start of I/O completion queue #1.
-    // 5th 4kB boundary is the start of I/O submission queue #2.
-    // 6th 4kB boundary is the start of I/O completion queue #2.
+    // The asynchronous I/O submission & completion queues follow, sized after
+    // PcdNvmeAsyncIoQueueNumber and PcdNvmeAsyncIoQueueSize.
     //
-    // Allocate 6 pages of memory, then map it for bus master read and write.
+    // Allocate the pages of memory, then map it for bus master read and write.
     //
+    Private->BufferPages = NvmeGetQueueBufferPages (&AsyncQueueNum, &AsyncQueueEntries);
+
     Status = PciIo->AllocateBuffer (
                       PciIo,
                       AllocateAnyPages,
                       EfiBootServicesData,
-                      6,
+                      Private->BufferPages,
                       (VOID **)&Private->Buffer,
                       0
                       );
@@ -1051,7 +1087,7 @@ NvmExpressDriverBindingStart (
       goto Exit;
     }
 
-    Bytes  = EFI_PAGES_TO_SIZE (6);
+    Bytes  = EFI_PAGES_TO_SIZE (Private->BufferPages);
     Status = PciIo->Map (
                       PciIo,
                       EfiPciIoOperationBusMasterCommonBuffer,
@@ -1061,7 +1097,7 @@ NvmExpressDriverBindingStart (
                       &Private->Mapping
                       );
 
-    if (EFI_ERROR (Status) || (Bytes != EFI_PAGES_TO_SIZE (6))) {
+    if (EFI_ERROR (Status) || (Bytes != EFI_PAGES_TO_SIZE (Private->BufferPages))) {
       goto Exit;
     }
 
@@ -1171,7 +1207,7 @@ Exit:
   }
 
   if ((Private != NULL) && (Private->Buffer != NULL)) {
-    PciIo->FreeBuffer (PciIo, 6, Private->Buffer);
+    PciIo->FreeBuffer (PciIo, Private->BufferPages, Private->Buffer);
   }
 
   if ((Private != NULL) && (Private->ControllerData != NULL)) {
@@ -1183,6 +1219,7 @@ Exit:
       gBS->CloseEvent (Private->TimerEvent);
     }
 
+    NvmeFreePrpLists (Private);
     FreePool (Private);
   }
 
@@ -1292,8 +1329,10 @@ NvmExpressDriverBindingStop (
         Private->PciIo->Unmap (Private->PciIo, Private->Mapping);
       }
 
+      NvmeFreePrpLists (Private);
+
       if (Private->Buffer != NULL) {
-        Private->PciIo->FreeBuffer (Private->PciIo, 6, Private->Buffer);
+        Private->PciIo->FreeBuffer (Private->PciIo, Private->BufferPages, Private->Buffer);
       }
 
       FreePool (Private->ControllerData);
@@ -3,7 +3,7 @@
   NVM Express specification.
 
   (C) Copyright 2016 Hewlett Packard Enterprise Development LP<BR>
-  Copyright (c) 2013 - 2019, Intel Corporation. All rights reserved.<BR>
+  Copyright (c) 2013 - 2026, Intel Corporation. All rights reserved.<BR>
   Copyright (c) Microsoft Corporation.<BR>
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
@@ -42,6 +42,7 @@
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiDriverEntryPoint.h>
 #include <Library/ReportStatusCodeLib.h>
+#include <Library/PcdLib.h>
 
 #include <Guid/NVMeEventGroup.h>
 
@@ -68,17 +69,27 @@ extern EFI_DRIVER_SUPPORTED_EFI_VERSION_PROTOCOL  gNvmExpressDriverSupportedEfiV
 #define NVME_CCQ_SIZE  1                                // Number of I/O completion queue entries, which is 0-based
 
 //
-// Number of asynchronous I/O submission queue entries, which is 0-based.
-// The asynchronous I/O submission queue size is 4kB in total.
+// Upper limits of the number of asynchronous I/O queue pairs and of their
+// number of entries. The actual values are PcdNvmeAsyncIoQueueNumber and
+// PcdNvmeAsyncIoQueueSize, limited to what the controller supports.
 //
-#define NVME_ASYNC_CSQ_SIZE  63
+#define NVME_MAX_ASYNC_QUEUES      8
+#define NVME_MAX_ASYNC_QUEUE_SIZE  4096
+
 //
-// Number of asynchronous I/O completion queue entries, which is 0-based.
-// The asynchronous I/O completion queue size is 4kB in total.
+// Queue 0 is the admin queue, queue 1 is the blocking I/O queue, and the
+// asynchronous I/O queues start from queue 2.
 //
-#define NVME_ASYNC_CCQ_SIZE  255
+#define NVME_ASYNC_QUEUE_ID  2
 
-#define NVME_MAX_QUEUES  3                              // Number of queues supported by the driver
+#define NVME_MAX_QUEUES  (NVME_ASYNC_QUEUE_ID + NVME_MAX_ASYNC_QUEUES) // Number of queues supported by the driver
+
+//
+// SGL Support (SGLS) field of the Identify Controller data.
+//
+#define NVME_CTRL_SGLS_SUPPORT_MASK    (BIT0 | BIT1)
+#define NVME_CTRL_SGLS_BYTE_ALIGNED    0x1              // SGLs supported, no alignment requirement
+#define NVME_CTRL_SGLS_DWORD_ALIGNED   0x2              // SGLs supported, Dword alignment and granularity
 
 //
 // FormatNVM Admin Command LBA Format (LBAF) Mask
@@ -145,16 +156,17 @@ struct _NVME_CONTROLLER_PRIVATE_DATA {
   NVME_ADMIN_CONTROLLER_DATA            *ControllerData;
 
   //
-  // 6 x 4kB aligned buffers will be carved out of this buffer.
+  // All the submission & completion queues are carved out of this buffer.
   // 1st 4kB boundary is the start of the admin submission queue.
   // 2nd 4kB boundary is the start of the admin completion queue.
   // 3rd 4kB boundary is the start of I/O submission queue #1.
   // 4th 4kB boundary is the start of I/O completion queue #1.
-  // 5th 4kB boundary is the start of I/O submission queue #2.
-  // 6th 4kB boundary is the start of I/O completion queue #2.
+  // The asynchronous I/O submission & completion queues follow, each one
+  // starting on a 4kB boundary.
   //
   UINT8          *Buffer;
   UINT8          *BufferPciAddr;
+  UINTN          BufferPages;
 
   //
   // Pointers to 4kB aligned submission & completion queues.
@@ -169,7 +181,15 @@ struct _NVME_CONTROLLER_PRIVATE_DATA {
   //
   NVME_SQTDBL    SqTdbl[NVME_MAX_QUEUES];
   NVME_CQHDBL    CqHdbl[NVME_MAX_QUEUES];
-  UINT16         AsyncSqHead;
+
+  //
+  // Number of asynchronous I/O queue pairs, their size (0-based), and the
+  // number of commands in flight in each of them.
+  //
+  UINT16         AsyncQueueNum;
+  UINT16         AsyncQueueSize;
+  UINT16         AsyncQueueInFlight[NVME_MAX_QUEUES];
+  UINT16         NextAsyncQueue;
 
   //
   // Flag to indicate internal IO queue creation.
@@ -192,6 +212,11 @@ struct _NVME_CONTROLLER_PRIVATE_DATA {
   EFI_EVENT      TimerEvent;
   LIST_ENTRY     AsyncPassThruQueue;
   LIST_ENTRY     UnsubmittedSubtasks;
+
+  //
+  // PRP list pages that are free for reuse.
+  //
+  LIST_ENTRY     FreePrpLists;
 };
 
 #define NVME_CONTROLLER_PRIVATE_DATA_FROM_PASS_THRU(a) \
@@ -319,6 +344,24 @@ typedef struct {
 #define NVME_BLKIO2_SUBTASK_FROM_LINK(a) \
   CR (a, NVME_BLKIO2_SUBTASK, Link, NVME_BLKIO2_SUBTASK_SIGNATURE)
 
+//
+// Nvme PRP list page, allocated and mapped once, then kept in
+// Private->FreePrpLists for reuse.
+//
+#define NVME_PRP_LIST_SIGNATURE  SIGNATURE_32 ('N', 'P', 'R', 'L')
+
+typedef struct {
+  UINT32                  Signature;
+  LIST_ENTRY              Link;
+
+  UINT64                  *Host;
+  EFI_PHYSICAL_ADDRESS    DeviceAddress;
+  VOID                    *Mapping;
+} NVME_PRP_LIST;
+
+#define NVME_PRP_LIST_FROM_LINK(a) \
+  CR (a, NVME_PRP_LIST, Link, NVME_PRP_LIST_SIGNATURE)
+
 //
 // Nvme asynchronous passthru request.
 //
@@ -329,7 +372,9 @@ typedef struct {
   LIST_ENTRY                                  Link;
 
   EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET    *Packet;
+  UINT16                                      QueueId;
   UINT16                                      CommandId;
+  NVME_PRP_LIST                               *PrpList;
   VOID                                        *MapPrpList;
   UINTN                                       PrpListNo;
   VOID                                        *PrpListHost;
@@ -759,6 +804,47 @@ NvmeDumpStatus (
   IN NVME_CQ  *Cq
   );
 
+/**
+  Keep a PRP list page for reuse.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+  @param[in] PrpList        The PRP list page returned by NvmeGetPrpList().
+
+**/
+VOID
+NvmePutPrpList (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private,
+  IN NVME_PRP_LIST                 *PrpList
+  );
+
+/**
+  Release the PRP list pages kept for reuse.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+**/
+VOID
+NvmeFreePrpLists (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  );
+
+/**
+  Submit the pending BlockIo2 subtasks to the asynchronous I/O queues, until
+  all of them are submitted or the queues are full.
+
+  The caller must be at TPL_NOTIFY.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+**/
+VOID
+NvmeSubmitAsyncSubtasks (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  );
+
 /**
   Register the shutdown notification through the ResetNotification protocol.
 
@@ -2,7 +2,7 @@
   NvmExpressDxe driver is used to manage non-volatile memory subsystem which follows
   NVM Express specification.
 
-  Copyright (c) 2013 - 2018, Intel Corporation. All rights reserved.<BR>
+  Copyright (c) 2013 - 2026, Intel Corporation. All rights reserved.<BR>
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
@@ -813,6 +813,14 @@ NvmeAsyncRead (
     }
   }
 
+  //
+  // Submit the subtasks right away, rather than on the next tick of the
+  // asynchronous I/O timer.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  NvmeSubmitAsyncSubtasks (Private);
+  gBS->RestoreTPL (OldTpl);
+
   DEBUG ((
     DEBUG_BLKIO,
     "%a: Lba = 0x%08Lx, Original = 0x%08Lx, "
@@ -941,6 +949,14 @@ NvmeAsyncWrite (
     }
   }
 
+  //
+  // Submit the subtasks right away, rather than on the next tick of the
+  // asynchronous I/O timer.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  NvmeSubmitAsyncSubtasks (Private);
+  gBS->RestoreTPL (OldTpl);
+
   DEBUG ((
     DEBUG_BLKIO,
     "%a: Lba = 0x%08Lx, Original = 0x%08Lx, "
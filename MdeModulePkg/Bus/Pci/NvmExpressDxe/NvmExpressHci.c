@@ -2,7 +2,7 @@
   NvmExpressDxe driver is used to manage non-volatile memory subsystem which follows
   NVM Express specification.
 
-  Copyright (c) 2013 - 2019, Intel Corporation. All rights reserved.<BR>
+  Copyright (c) 2013 - 2026, Intel Corporation. All rights reserved.<BR>
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
@@ -564,6 +564,104 @@ NvmeIdentifyNamespace (
   return Status;
 }
 
+/**
+  Get the configured number and size of the asynchronous I/O queues, and the
+  number of pages of the buffer holding all the queues.
+
+  @param[out] AsyncQueueNum      The number of asynchronous I/O queue pairs.
+  @param[out] AsyncQueueEntries  The number of entries of each asynchronous
+                                 I/O queue.
+
+  @return The number of pages of the queue buffer.
+
+**/
+UINTN
+NvmeGetQueueBufferPages (
+  OUT UINT16  *AsyncQueueNum,
+  OUT UINT16  *AsyncQueueEntries
+  )
+{
+  *AsyncQueueNum     = PcdGet16 (PcdNvmeAsyncIoQueueNumber);
+  *AsyncQueueNum     = (UINT16)MAX (*AsyncQueueNum, 1);
+  *AsyncQueueNum     = (UINT16)MIN (*AsyncQueueNum, NVME_MAX_ASYNC_QUEUES);
+  *AsyncQueueEntries = PcdGet16 (PcdNvmeAsyncIoQueueSize);
+  *AsyncQueueEntries = (UINT16)MAX (*AsyncQueueEntries, 2);
+  *AsyncQueueEntries = (UINT16)MIN (*AsyncQueueEntries, NVME_MAX_ASYNC_QUEUE_SIZE);
+
+  //
+  // One page for each admin and blocking I/O queue, and the asynchronous I/O
+  // queue pairs.
+  //
+  return 4 + *AsyncQueueNum * (EFI_SIZE_TO_PAGES (*AsyncQueueEntries * sizeof (NVME_SQ)) +
+                               EFI_SIZE_TO_PAGES (*AsyncQueueEntries * sizeof (NVME_CQ)));
+}
+
+/**
+  Set the number of I/O queues with the Set Features command.
+
+  @param  Private          The pointer to the NVME_CONTROLLER_PRIVATE_DATA data structure.
+  @param  IoQueueNum       On input, the number of I/O queue pairs requested.
+                           On output, the number of I/O queue pairs allocated,
+                           at most the number requested.
+
+  @return EFI_SUCCESS      Successfully set the number of I/O queues.
+  @return EFI_DEVICE_ERROR Fail to set the number of I/O queues.
+
+**/
+EFI_STATUS
+NvmeSetNumberOfQueues (
+  IN     NVME_CONTROLLER_PRIVATE_DATA  *Private,
+  IN OUT UINT16                        *IoQueueNum
+  )
+{
+  EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET  CommandPacket;
+  EFI_NVM_EXPRESS_COMMAND                   Command;
+  EFI_NVM_EXPRESS_COMPLETION                Completion;
+  EFI_STATUS                                Status;
+  NVME_ADMIN_SET_FEATURES                   SetFeatures;
+  UINT16                                    Nsqa;
+  UINT16                                    Ncqa;
+
+  ZeroMem (&CommandPacket, sizeof (EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET));
+  ZeroMem (&Command, sizeof (EFI_NVM_EXPRESS_COMMAND));
+  ZeroMem (&Completion, sizeof (EFI_NVM_EXPRESS_COMPLETION));
+  ZeroMem (&SetFeatures, sizeof (NVME_ADMIN_SET_FEATURES));
+
+  CommandPacket.NvmeCmd        = &Command;
+  CommandPacket.NvmeCompletion = &Completion;
+
+  Command.Cdw0.Opcode          = NVME_ADMIN_SET_FEATURES_CMD;
+  CommandPacket.CommandTimeout = NVME_GENERIC_TIMEOUT;
+  CommandPacket.QueueType      = NVME_ADMIN_QUEUE;
+
+  SetFeatures.Fid = NUMBER_OF_QUEUES_FID;
+  CopyMem (&Command.Cdw10, &SetFeatures, sizeof (NVME_ADMIN_SET_FEATURES));
+  //
+  // The Number of I/O Submission and Completion Queues Requested are 0-based.
+  //
+  Command.Cdw11 = ((UINT32)(*IoQueueNum - 1) << 16) | (*IoQueueNum - 1);
+  Command.Flags = CDW10_VALID | CDW11_VALID;
+
+  Status = Private->Passthru.PassThru (
+                               &Private->Passthru,
+                               NVME_CONTROLLER_ID,
+                               &CommandPacket,
+                               NULL
+                               );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // The numbers of queues allocated are 0-based as well.
+  //
+  Nsqa        = (UINT16)Completion.DW0;
+  Ncqa        = (UINT16)(Completion.DW0 >> 16);
+  *IoQueueNum = (UINT16)MIN (*IoQueueNum, MIN (Nsqa, Ncqa) + 1);
+
+  return EFI_SUCCESS;
+}
+
 /**
   Create io completion queue.
 
@@ -589,7 +687,7 @@ NvmeCreateIoCompletionQueue (
   Status                 = EFI_SUCCESS;
   Private->CreateIoQueue = TRUE;
 
-  for (Index = 1; Index < NVME_MAX_QUEUES; Index++) {
+  for (Index = 1; Index < NVME_ASYNC_QUEUE_ID + Private->AsyncQueueNum; Index++) {
     ZeroMem (&CommandPacket, sizeof (EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET));
     ZeroMem (&Command, sizeof (EFI_NVM_EXPRESS_COMMAND));
     ZeroMem (&Completion, sizeof (EFI_NVM_EXPRESS_COMPLETION));
@@ -607,11 +705,7 @@ NvmeCreateIoCompletionQueue (
     if (Index == 1) {
       QueueSize = NVME_CCQ_SIZE;
     } else {
-      if (Private->Cap.Mqes > NVME_ASYNC_CCQ_SIZE) {
-        QueueSize = NVME_ASYNC_CCQ_SIZE;
-      } else {
-        QueueSize = Private->Cap.Mqes;
-      }
+      QueueSize = Private->AsyncQueueSize;
     }
 
     CrIoCq.Qid   = Index;
@@ -661,7 +755,7 @@ NvmeCreateIoSubmissionQueue (
   Status                 = EFI_SUCCESS;
   Private->CreateIoQueue = TRUE;
 
-  for (Index = 1; Index < NVME_MAX_QUEUES; Index++) {
+  for (Index = 1; Index < NVME_ASYNC_QUEUE_ID + Private->AsyncQueueNum; Index++) {
     ZeroMem (&CommandPacket, sizeof (EFI_NVM_EXPRESS_PASS_THRU_COMMAND_PACKET));
     ZeroMem (&Command, sizeof (EFI_NVM_EXPRESS_COMMAND));
     ZeroMem (&Completion, sizeof (EFI_NVM_EXPRESS_COMPLETION));
@@ -679,11 +773,7 @@ NvmeCreateIoSubmissionQueue (
     if (Index == 1) {
       QueueSize = NVME_CSQ_SIZE;
     } else {
-      if (Private->Cap.Mqes > NVME_ASYNC_CSQ_SIZE) {
-        QueueSize = NVME_ASYNC_CSQ_SIZE;
-      } else {
-        QueueSize = Private->Cap.Mqes;
-      }
+      QueueSize = Private->AsyncQueueSize;
     }
 
     CrIoSq.Qid   = Index;
@@ -732,6 +822,11 @@ NvmeControllerInit (
   NVME_ACQ             Acq;
   UINT8                Sn[21];
   UINT8                Mn[41];
+  UINT16               AsyncQueueNum;
+  UINT16               AsyncQueueEntries;
+  UINT16               IoQueueNum;
+  UINTN                Index;
+  UINTN                Offset;
 
   //
   // Enable this controller.
@@ -777,19 +872,16 @@ NvmeControllerInit (
   //
   ASSERT ((Private->Cap.Mpsmin + 12) <= EFI_PAGE_SHIFT);
 
-  Private->Cid[0]        = 0;
-  Private->Cid[1]        = 0;
-  Private->Cid[2]        = 0;
-  Private->Pt[0]         = 0;
-  Private->Pt[1]         = 0;
-  Private->Pt[2]         = 0;
-  Private->SqTdbl[0].Sqt = 0;
-  Private->SqTdbl[1].Sqt = 0;
-  Private->SqTdbl[2].Sqt = 0;
-  Private->CqHdbl[0].Cqh = 0;
-  Private->CqHdbl[1].Cqh = 0;
-  Private->CqHdbl[2].Cqh = 0;
-  Private->AsyncSqHead   = 0;
+  for (Index = 0; Index < NVME_MAX_QUEUES; Index++) {
+    Private->Cid[Index]                = 0;
+    Private->Pt[Index]                 = 0;
+    Private->SqTdbl[Index].Sqt         = 0;
+    Private->CqHdbl[Index].Cqh         = 0;
+    Private->AsyncQueueInFlight[Index] = 0;
+  }
+
+  Private->AsyncQueueNum  = 0;
+  Private->NextAsyncQueue = 0;
 
   Status = NvmeDisableController (Private);
 
@@ -818,7 +910,7 @@ NvmeControllerInit (
   //
   // Address of I/O submission & completion queue.
   //
-  ZeroMem (Private->Buffer, EFI_PAGES_TO_SIZE (6));
+  ZeroMem (Private->Buffer, EFI_PAGES_TO_SIZE (Private->BufferPages));
   Private->SqBuffer[0]        = (NVME_SQ *)(UINTN)(Private->Buffer);
   Private->SqBufferPciAddr[0] = (NVME_SQ *)(UINTN)(Private->BufferPciAddr);
   Private->CqBuffer[0]        = (NVME_CQ *)(UINTN)(Private->Buffer + 1 * EFI_PAGE_SIZE);
@@ -827,10 +919,19 @@ NvmeControllerInit (
   Private->SqBufferPciAddr[1] = (NVME_SQ *)(UINTN)(Private->BufferPciAddr + 2 * EFI_PAGE_SIZE);
   Private->CqBuffer[1]        = (NVME_CQ *)(UINTN)(Private->Buffer + 3 * EFI_PAGE_SIZE);
   Private->CqBufferPciAddr[1] = (NVME_CQ *)(UINTN)(Private->BufferPciAddr + 3 * EFI_PAGE_SIZE);
-  Private->SqBuffer[2]        = (NVME_SQ *)(UINTN)(Private->Buffer + 4 * EFI_PAGE_SIZE);
-  Private->SqBufferPciAddr[2] = (NVME_SQ *)(UINTN)(Private->BufferPciAddr + 4 * EFI_PAGE_SIZE);
-  Private->CqBuffer[2]        = (NVME_CQ *)(UINTN)(Private->Buffer + 5 * EFI_PAGE_SIZE);
-  Private->CqBufferPciAddr[2] = (NVME_CQ *)(UINTN)(Private->BufferPciAddr + 5 * EFI_PAGE_SIZE);
+
+  NvmeGetQueueBufferPages (&AsyncQueueNum, &AsyncQueueEntries);
+  Offset = 4 * EFI_PAGE_SIZE;
+  for (Index = NVME_ASYNC_QUEUE_ID; Index < NVME_ASYNC_QUEUE_ID + AsyncQueueNum; Index++) {
+    Private->SqBuffer[Index]        = (NVME_SQ *)(UINTN)(Private->Buffer + Offset);
+    Private->SqBufferPciAddr[Index] = (NVME_SQ *)(UINTN)(Private->BufferPciAddr + Offset);
+    Offset                         += EFI_PAGES_TO_SIZE (EFI_SIZE_TO_PAGES (AsyncQueueEntries * sizeof (NVME_SQ)));
+    Private->CqBuffer[Index]        = (NVME_CQ *)(UINTN)(Private->Buffer + Offset);
+    Private->CqBufferPciAddr[Index] = (NVME_CQ *)(UINTN)(Private->BufferPciAddr + Offset);
+    Offset                         += EFI_PAGES_TO_SIZE (EFI_SIZE_TO_PAGES (AsyncQueueEntries * sizeof (NVME_CQ)));
+  }
+
+  ASSERT (Offset <= EFI_PAGES_TO_SIZE (Private->BufferPages));
 
   DEBUG ((DEBUG_INFO, "Private->Buffer = [%016X]\n", (UINT64)(UINTN)Private->Buffer));
   DEBUG ((DEBUG_INFO, "Admin     Submission Queue size (Aqa.Asqs) = [%08X]\n", Aqa.Asqs));
@@ -839,8 +940,10 @@ NvmeControllerInit (
   DEBUG ((DEBUG_INFO, "Admin     Completion Queue (CqBuffer[0]) = [%016X]\n", Private->CqBuffer[0]));
   DEBUG ((DEBUG_INFO, "Sync  I/O Submission Queue (SqBuffer[1]) = [%016X]\n", Private->SqBuffer[1]));
   DEBUG ((DEBUG_INFO, "Sync  I/O Completion Queue (CqBuffer[1]) = [%016X]\n", Private->CqBuffer[1]));
-  DEBUG ((DEBUG_INFO, "Async I/O Submission Queue (SqBuffer[2]) = [%016X]\n", Private->SqBuffer[2]));
-  DEBUG ((DEBUG_INFO, "Async I/O Completion Queue (CqBuffer[2]) = [%016X]\n", Private->CqBuffer[2]));
+  for (Index = NVME_ASYNC_QUEUE_ID; Index < NVME_ASYNC_QUEUE_ID + AsyncQueueNum; Index++) {
+    DEBUG ((DEBUG_INFO, "Async I/O Submission Queue (SqBuffer[%d]) = [%016X]\n", (UINT32)Index, Private->SqBuffer[Index]));
+    DEBUG ((DEBUG_INFO, "Async I/O Completion Queue (CqBuffer[%d]) = [%016X]\n", (UINT32)Index, Private->CqBuffer[Index]));
+  }
 
   //
   // Program admin queue attributes.
@@ -917,10 +1020,32 @@ NvmeControllerInit (
   DEBUG ((DEBUG_INFO, "    SQES      : 0x%x\n", Private->ControllerData->Sqes));
   DEBUG ((DEBUG_INFO, "    CQES      : 0x%x\n", Private->ControllerData->Cqes));
   DEBUG ((DEBUG_INFO, "    NN        : 0x%x\n", Private->ControllerData->Nn));
+  DEBUG ((DEBUG_INFO, "    SGLS      : 0x%x\n", Private->ControllerData->Sgls));
+
+  //
+  // Ask for one I/O queue pair for blocking I/O, and the configured number
+  // of pairs for non-blocking I/O. Fall back to a single pair for non-blocking
+  // I/O if the controller does not grant more.
+  //
+  IoQueueNum = 1 + AsyncQueueNum;
+  Status     = NvmeSetNumberOfQueues (Private, &IoQueueNum);
+  if (EFI_ERROR (Status) || (IoQueueNum < 2)) {
+    DEBUG ((DEBUG_WARN, "NvmeControllerInit: Set Features (Number of Queues) failed (%r)\n", Status));
+    IoQueueNum = 2;
+  }
+
+  Private->AsyncQueueNum  = (UINT16)(IoQueueNum - 1);
+  Private->AsyncQueueSize = (UINT16)MIN (AsyncQueueEntries - 1, Private->Cap.Mqes);
+  DEBUG ((
+    DEBUG_INFO,
+    "NvmeControllerInit: %d asynchronous I/O queue pairs of %d entries\n",
+    Private->AsyncQueueNum,
+    Private->AsyncQueueSize + 1
+    ));
 
   //
-  // Create two I/O completion queues.
-  // One for blocking I/O, one for non-blocking I/O.
+  // Create the I/O completion queues.
+  // One for blocking I/O, the others for non-blocking I/O.
   //
   Status = NvmeCreateIoCompletionQueue (Private);
   if (EFI_ERROR (Status)) {
@@ -928,8 +1053,8 @@ NvmeControllerInit (
   }
 
   //
-  // Create two I/O Submission queues.
-  // One for blocking I/O, one for non-blocking I/O.
+  // Create the I/O Submission queues.
+  // One for blocking I/O, the others for non-blocking I/O.
   //
   Status = NvmeCreateIoSubmissionQueue (Private);
 
@@ -18,6 +18,23 @@
 //
 #define NVME_ASQ_BUF_OFFSET  EFI_PAGE_SIZE
 
+/**
+  Get the configured number and size of the asynchronous I/O queues, and the
+  number of pages of the buffer holding all the queues.
+
+  @param[out] AsyncQueueNum      The number of asynchronous I/O queue pairs.
+  @param[out] AsyncQueueEntries  The number of entries of each asynchronous
+                                 I/O queue.
+
+  @return The number of pages of the queue buffer.
+
+**/
+UINTN
+NvmeGetQueueBufferPages (
+  OUT UINT16  *AsyncQueueNum,
+  OUT UINT16  *AsyncQueueEntries
+  );
+
 /**
   Initialize the Nvm Express controller.
 
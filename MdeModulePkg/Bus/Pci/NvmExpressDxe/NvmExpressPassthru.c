@@ -3,7 +3,7 @@
   NVM Express specification.
 
   (C) Copyright 2014 Hewlett-Packard Development Company, L.P.<BR>
-  Copyright (c) 2013 - 2018, Intel Corporation. All rights reserved.<BR>
+  Copyright (c) 2013 - 2026, Intel Corporation. All rights reserved.<BR>
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
@@ -314,6 +314,130 @@ EXIT:
   return NULL;
 }
 
+/**
+  Get a PRP list page. A page kept for reuse is returned if there is one,
+  otherwise a new page is allocated and mapped for bus master common buffer.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+  @return The PRP list page, or NULL if there are not enough resources.
+
+**/
+NVME_PRP_LIST *
+NvmeGetPrpList (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  )
+{
+  EFI_PCI_IO_PROTOCOL  *PciIo;
+  NVME_PRP_LIST        *PrpList;
+  UINTN                Bytes;
+  EFI_TPL              OldTpl;
+  EFI_STATUS           Status;
+
+  PrpList = NULL;
+  OldTpl  = gBS->RaiseTPL (TPL_NOTIFY);
+  if (!IsListEmpty (&Private->FreePrpLists)) {
+    PrpList = NVME_PRP_LIST_FROM_LINK (GetFirstNode (&Private->FreePrpLists));
+    RemoveEntryList (&PrpList->Link);
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  if (PrpList != NULL) {
+    return PrpList;
+  }
+
+  PrpList = AllocateZeroPool (sizeof (NVME_PRP_LIST));
+  if (PrpList == NULL) {
+    return NULL;
+  }
+
+  PciIo  = Private->PciIo;
+  Status = PciIo->AllocateBuffer (
+                    PciIo,
+                    AllocateAnyPages,
+                    EfiBootServicesData,
+                    1,
+                    (VOID **)&PrpList->Host,
+                    0
+                    );
+  if (EFI_ERROR (Status)) {
+    FreePool (PrpList);
+    return NULL;
+  }
+
+  Bytes  = EFI_PAGE_SIZE;
+  Status = PciIo->Map (
+                    PciIo,
+                    EfiPciIoOperationBusMasterCommonBuffer,
+                    PrpList->Host,
+                    &Bytes,
+                    &PrpList->DeviceAddress,
+                    &PrpList->Mapping
+                    );
+  if (EFI_ERROR (Status) || (Bytes != EFI_PAGE_SIZE)) {
+    DEBUG ((DEBUG_ERROR, "NvmeGetPrpList: create PrpList failure!\n"));
+    if (!EFI_ERROR (Status)) {
+      PciIo->Unmap (PciIo, PrpList->Mapping);
+    }
+
+    PciIo->FreeBuffer (PciIo, 1, PrpList->Host);
+    FreePool (PrpList);
+    return NULL;
+  }
+
+  PrpList->Signature = NVME_PRP_LIST_SIGNATURE;
+  return PrpList;
+}
+
+/**
+  Keep a PRP list page for reuse.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+  @param[in] PrpList        The PRP list page returned by NvmeGetPrpList().
+
+**/
+VOID
+NvmePutPrpList (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private,
+  IN NVME_PRP_LIST                 *PrpList
+  )
+{
+  EFI_TPL  OldTpl;
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  InsertHeadList (&Private->FreePrpLists, &PrpList->Link);
+  gBS->RestoreTPL (OldTpl);
+}
+
+/**
+  Release the PRP list pages kept for reuse.
+
+  @param[in] Private        The pointer to the NVME_CONTROLLER_PRIVATE_DATA
+                            data structure.
+
+**/
+VOID
+NvmeFreePrpLists (
+  IN NVME_CONTROLLER_PRIVATE_DATA  *Private
+  )
+{
+  EFI_PCI_IO_PROTOCOL  *PciIo;
+  NVME_PRP_LIST        *PrpList;
+
+  PciIo = Private->PciIo;
+  while (!IsListEmpty (&Private->FreePrpLists)) {
+    PrpList = NVME_PRP_LIST_FROM_LINK (GetFirstNode (&Private->FreePrpLists));
+    RemoveEntryList (&PrpList->Link);
+
+    PciIo->Unmap (PciIo, PrpList->Mapping);
+    PciIo->FreeBuffer (PciIo, 1, PrpList->Host);
+    FreePool (PrpList);
+  }
+}
+
 /**
   Aborts the asynchronous PassThru requests.
 
@@ -384,6 +508,10 @@ AbortAsyncPassThruTasks (
       PciIo->Unmap (PciIo, AsyncRequest->MapMeta);
     }
 
+    if (AsyncRequest->PrpList != NULL) {
+      NvmePutPrpList (Private, AsyncRequest->PrpList);
+    }
+
     if (AsyncRequest->MapPrpList != NULL) {
       PciIo->Unmap (PciIo, AsyncRequest->MapPrpList);
     }
@@ -475,6 +603,12 @@ NvmExpressPassThru (
   UINT64                         *Prp;
   VOID                           *PrpListHost;
   UINTN                          PrpListNo;
+  NVME_PRP_LIST                  *PrpList;
+  UINTN                          PrpEntryIndex;
+  UINTN                          Pages;
+  NVME_SGL_DESCRIPTOR            Sgl;
+  UINT32                         SglSupport;
+  UINT16                         Index;
   UINT32                         Attributes;
   UINT32                         IoAlign;
   UINT32                         MaxTransLen;
@@ -551,51 +685,69 @@ NvmExpressPassThru (
   PrpListHost = NULL;
   PrpListNo   = 0;
   Prp         = NULL;
+  PrpList     = NULL;
   TimerEvent  = NULL;
   Status      = EFI_SUCCESS;
-  QueueSize   = MIN (NVME_ASYNC_CSQ_SIZE, Private->Cap.Mqes) + 1;
+  QueueSize   = Private->AsyncQueueSize + 1;
+
+  if (Packet->NvmeCmd->Nsid != NamespaceId) {
+    return EFI_INVALID_PARAMETER;
+  }
 
+  AsyncRequest = NULL;
   if (Packet->QueueType == NVME_ADMIN_QUEUE) {
     QueueId = 0;
   } else {
     if (Event == NULL) {
       QueueId = 1;
     } else {
-      QueueId = 2;
+      //
+      // Allocate the request before the command is submitted, so that an
+      // allocation failure cannot leave a command in flight.
+      //
+      AsyncRequest = AllocateZeroPool (sizeof (NVME_PASS_THRU_ASYNC_REQ));
+      if (AsyncRequest == NULL) {
+        return EFI_DEVICE_ERROR;
+      }
 
       //
-      // Submission queue full check.
+      // Non-blocking commands are submitted at TPL_NOTIFY, so that neither
+      // ProcessAsyncTaskList() nor another submission can interleave.
       //
-      if ((Private->SqTdbl[QueueId].Sqt + 1) % QueueSize ==
-          Private->AsyncSqHead)
-      {
+      OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
+      //
+      // Pick the next asynchronous I/O queue in turn, skipping the full ones.
+      // A queue is full when its completion queue could not hold one more
+      // completion entry.
+      //
+      QueueId = NVME_ASYNC_QUEUE_ID;
+      for (Index = 0; Index < Private->AsyncQueueNum; Index++) {
+        QueueId = (UINT16)(NVME_ASYNC_QUEUE_ID + (Private->NextAsyncQueue + Index) % Private->AsyncQueueNum);
+        if (Private->AsyncQueueInFlight[QueueId] < QueueSize - 1) {
+          break;
+        }
+      }
+
+      if (Index == Private->AsyncQueueNum) {
+        gBS->RestoreTPL (OldTpl);
+        FreePool (AsyncRequest);
         return EFI_NOT_READY;
       }
+
+      Private->NextAsyncQueue = (UINT16)((QueueId - NVME_ASYNC_QUEUE_ID + 1) % Private->AsyncQueueNum);
     }
   }
 
   Sq = Private->SqBuffer[QueueId] + Private->SqTdbl[QueueId].Sqt;
   Cq = Private->CqBuffer[QueueId] + Private->CqHdbl[QueueId].Cqh;
 
-  if (Packet->NvmeCmd->Nsid != NamespaceId) {
-    return EFI_INVALID_PARAMETER;
-  }
-
   ZeroMem (Sq, sizeof (NVME_SQ));
   Sq->Opc  = (UINT8)Packet->NvmeCmd->Cdw0.Opcode;
   Sq->Fuse = (UINT8)Packet->NvmeCmd->Cdw0.FusedOperation;
   Sq->Cid  = Private->Cid[QueueId]++;
   Sq->Nsid = Packet->NvmeCmd->Nsid;
 
-  //
-  // Currently we only support PRP for data transfer, SGL is NOT supported.
-  //
-  ASSERT (Sq->Psdt == 0);
-  if (Sq->Psdt != 0) {
-    DEBUG ((DEBUG_ERROR, "NvmExpressPassThru: doesn't support SGL mechanism\n"));
-    return EFI_UNSUPPORTED;
-  }
-
   Sq->Prp[0] = (UINT64)(UINTN)Packet->TransferBuffer;
   if ((Packet->QueueType == NVME_ADMIN_QUEUE) &&
       ((Sq->Opc == NVME_ADMIN_CRIOCQ_CMD) || (Sq->Opc == NVME_ADMIN_CRIOSQ_CMD)))
@@ -618,7 +770,8 @@ NvmExpressPassThru (
     if (((Packet->TransferLength != 0) && (Packet->TransferBuffer == NULL)) ||
         ((Packet->TransferLength == 0) && (Packet->TransferBuffer != NULL)))
     {
-      return EFI_INVALID_PARAMETER;
+      Status = EFI_INVALID_PARAMETER;
+      goto EXIT;
     }
 
     if ((Sq->Opc & BIT0) != 0) {
@@ -638,7 +791,8 @@ NvmExpressPassThru (
                            &MapData
                            );
       if (EFI_ERROR (Status) || (Packet->TransferLength != MapLength)) {
-        return EFI_OUT_OF_RESOURCES;
+        Status = EFI_OUT_OF_RESOURCES;
+        goto EXIT;
       }
 
       Sq->Prp[0] = PhyAddr;
@@ -656,12 +810,8 @@ NvmExpressPassThru (
                            &MapMeta
                            );
       if (EFI_ERROR (Status) || (Packet->MetadataLength != MapLength)) {
-        PciIo->Unmap (
-                 PciIo,
-                 MapData
-                 );
-
-        return EFI_OUT_OF_RESOURCES;
+        Status = EFI_OUT_OF_RESOURCES;
+        goto EXIT;
       }
 
       Sq->Mptr = PhyAddr;
@@ -669,24 +819,62 @@ NvmExpressPassThru (
   }
 
   //
-  // If the buffer size spans more than two memory pages (page size as defined in CC.Mps),
-  // then build a PRP list in the second PRP submission queue entry.
+  // If PcdNvmeSglEnable is TRUE and the controller supports SGLs, the mapped
+  // data buffer of an I/O command is described by a single SGL Data Block
+  // descriptor, whatever its size.
   //
-  Offset = ((UINT16)Sq->Prp[0]) & (EFI_PAGE_SIZE - 1);
-  Bytes  = Packet->TransferLength;
+  // Otherwise, if the buffer size spans more than two memory pages (page size as
+  // defined in CC.Mps), then build a PRP list in the second PRP submission queue entry.
+  //
+  Offset     = ((UINT16)Sq->Prp[0]) & (EFI_PAGE_SIZE - 1);
+  Bytes      = Packet->TransferLength;
+  SglSupport = 0;
+  if (FeaturePcdGet (PcdNvmeSglEnable)) {
+    SglSupport = Private->ControllerData->Sgls & NVME_CTRL_SGLS_SUPPORT_MASK;
+  }
 
-  if ((Offset + Bytes) > (EFI_PAGE_SIZE * 2)) {
-    //
-    // Create PrpList for remaining data buffer.
-    //
+  if ((Packet->QueueType == NVME_IO_QUEUE) && (MapData != NULL) &&
+      ((SglSupport == NVME_CTRL_SGLS_BYTE_ALIGNED) ||
+       ((SglSupport == NVME_CTRL_SGLS_DWORD_ALIGNED) && (((Sq->Prp[0] | Bytes) & 0x3) == 0))))
+  {
+    ZeroMem (&Sgl, sizeof (NVME_SGL_DESCRIPTOR));
+    Sgl.Address = Sq->Prp[0];
+    Sgl.Length  = Bytes;
+    Sgl.Type    = NVME_SGL_TYPE_DATA_BLOCK;
+    Sgl.SubType = NVME_SGL_SUBTYPE_ADDRESS;
+    CopyMem (Sq->Prp, &Sgl, sizeof (NVME_SGL_DESCRIPTOR));
+    Sq->Psdt = NVME_PSDT_SGL_BUFFER;
+  } else if ((Offset + Bytes) > (EFI_PAGE_SIZE * 2)) {
     PhyAddr = (Sq->Prp[0] + EFI_PAGE_SIZE) & ~(EFI_PAGE_SIZE - 1);
-    Prp     = NvmeCreatePrpList (PciIo, PhyAddr, EFI_SIZE_TO_PAGES (Offset + Bytes) - 1, &PrpListHost, &PrpListNo, &MapPrpList);
-    if (Prp == NULL) {
-      Status = EFI_OUT_OF_RESOURCES;
-      goto EXIT;
-    }
+    Pages   = EFI_SIZE_TO_PAGES (Offset + Bytes) - 1;
+    if (Pages <= EFI_PAGE_SIZE / sizeof (UINT64)) {
+      //
+      // The remaining data buffer fits in a single PRP list, use a page kept
+      // for reuse rather than allocating and mapping a new one.
+      //
+      PrpList = NvmeGetPrpList (Private);
+      if (PrpList == NULL) {
+        Status = EFI_OUT_OF_RESOURCES;
+        goto EXIT;
+      }
+
+      for (PrpEntryIndex = 0; PrpEntryIndex < Pages; PrpEntryIndex++) {
+        PrpList->Host[PrpEntryIndex] = PhyAddr + EFI_PAGES_TO_SIZE (PrpEntryIndex);
+      }
 
-    Sq->Prp[1] = (UINT64)(UINTN)Prp;
+      Sq->Prp[1] = PrpList->DeviceAddress;
+    } else {
+      //
+      // Create PrpList for remaining data buffer.
+      //
+      Prp = NvmeCreatePrpList (PciIo, PhyAddr, Pages, &PrpListHost, &PrpListNo, &MapPrpList);
+      if (Prp == NULL) {
+        Status = EFI_OUT_OF_RESOURCES;
+        goto EXIT;
+      }
+
+      Sq->Prp[1] = (UINT64)(UINTN)Prp;
+    }
   } else if ((Offset + Bytes) > EFI_PAGE_SIZE) {
     Sq->Prp[1] = (Sq->Prp[0] + EFI_PAGE_SIZE) & ~(EFI_PAGE_SIZE - 1);
   }
@@ -752,24 +940,20 @@ NvmExpressPassThru (
   // in the submission queue.
   //
   if ((Event != NULL) && (QueueId != 0)) {
-    AsyncRequest = AllocateZeroPool (sizeof (NVME_PASS_THRU_ASYNC_REQ));
-    if (AsyncRequest == NULL) {
-      Status = EFI_DEVICE_ERROR;
-      goto EXIT;
-    }
-
     AsyncRequest->Signature   = NVME_PASS_THRU_ASYNC_REQ_SIG;
     AsyncRequest->Packet      = Packet;
+    AsyncRequest->QueueId     = QueueId;
     AsyncRequest->CommandId   = Sq->Cid;
     AsyncRequest->CallerEvent = Event;
     AsyncRequest->MapData     = MapData;
     AsyncRequest->MapMeta     = MapMeta;
+    AsyncRequest->PrpList     = PrpList;
     AsyncRequest->MapPrpList  = MapPrpList;
     AsyncRequest->PrpListNo   = PrpListNo;
     AsyncRequest->PrpListHost = PrpListHost;
 
-    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
     InsertTailList (&Private->AsyncPassThruQueue, &AsyncRequest->Link);
+    Private->AsyncQueueInFlight[QueueId]++;
     gBS->RestoreTPL (OldTpl);
 
     return EFI_SUCCESS;
@@ -918,10 +1102,19 @@ EXIT:
     PciIo->FreeBuffer (PciIo, PrpListNo, PrpListHost);
   }
 
+  if (PrpList != NULL) {
+    NvmePutPrpList (Private, PrpList);
+  }
+
   if (TimerEvent != NULL) {
     gBS->CloseEvent (TimerEvent);
   }
 
+  if (AsyncRequest != NULL) {
+    gBS->RestoreTPL (OldTpl);
+    FreePool (AsyncRequest);
+  }
+
   return Status;
 }
 
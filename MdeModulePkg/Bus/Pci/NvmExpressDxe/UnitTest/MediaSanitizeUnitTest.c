@@ -536,20 +536,20 @@ NvmeCreateDeviceInstance (
 
   Private = AllocateZeroPool (sizeof (NVME_CONTROLLER_PRIVATE_DATA));
 
-  Private->Signature     = NVME_CONTROLLER_PRIVATE_DATA_SIGNATURE;
-  Private->Cid[0]        = 0;
-  Private->Cid[1]        = 0;
-  Private->Cid[2]        = 0;
-  Private->Pt[0]         = 0;
-  Private->Pt[1]         = 0;
-  Private->Pt[2]         = 0;
-  Private->SqTdbl[0].Sqt = 0;
-  Private->SqTdbl[1].Sqt = 0;
-  Private->SqTdbl[2].Sqt = 0;
-  Private->CqHdbl[0].Cqh = 0;
-  Private->CqHdbl[1].Cqh = 0;
-  Private->CqHdbl[2].Cqh = 0;
-  Private->AsyncSqHead   = 0;
+  Private->Signature             = NVME_CONTROLLER_PRIVATE_DATA_SIGNATURE;
+  Private->Cid[0]                = 0;
+  Private->Cid[1]                = 0;
+  Private->Cid[2]                = 0;
+  Private->Pt[0]                 = 0;
+  Private->Pt[1]                 = 0;
+  Private->Pt[2]                 = 0;
+  Private->SqTdbl[0].Sqt         = 0;
+  Private->SqTdbl[1].Sqt         = 0;
+  Private->SqTdbl[2].Sqt         = 0;
+  Private->CqHdbl[0].Cqh         = 0;
+  Private->CqHdbl[1].Cqh         = 0;
+  Private->CqHdbl[2].Cqh         = 0;
+  Private->AsyncQueueInFlight[2] = 0;
 
   Private->ControllerData = (NVME_ADMIN_CONTROLLER_DATA *)AllocateZeroPool (sizeof (NVME_ADMIN_CONTROLLER_DATA));
 
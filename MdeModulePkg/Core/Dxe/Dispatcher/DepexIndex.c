@@ -0,0 +1,415 @@
+/** @file
+  Protocol index of the dependency expressions of the drivers waiting to be
+  dispatched.
+
+  Without the index, every dispatch round evaluates the dependency expression
+  of every driver that is still in the Dependent state, even if none of the
+  protocols it refers to was installed since the previous round. When
+  PcdDxeDispatcherDepexIndexEnable is TRUE, the dependency expression of a
+  driver is parsed once when it is discovered, and a waiter is recorded for
+  every protocol GUID it pushes. Installing a protocol marks the drivers
+  waiting on it as stale, and a dispatch round only evaluates stale drivers.
+
+  Without a NOT opcode, installing a protocol is the only event that can turn
+  a dependency expression from FALSE to TRUE, so skipping the other drivers
+  does not change the dispatch order. Expressions that use NOT, that cannot be
+  parsed, or that are missing (UEFI driver model drivers) are evaluated in
+  every round as before.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeMain.h"
+
+#define DEPEX_INDEX_BUCKET_BITS   6
+#define DEPEX_INDEX_BUCKET_COUNT  (1U << DEPEX_INDEX_BUCKET_BITS)
+
+//
+// Multiplier of the Fibonacci hash of the protocol GUIDs.
+//
+#define DEPEX_INDEX_HASH_MULTIPLIER  0x9E3779B1U
+
+//
+// mDepexIndex          - The waiters of the indexed drivers hashed by protocol GUID
+// mDepexIndexReady     - TRUE once the buckets of mDepexIndex are initialized
+// mDepexIndexLock      - Lock to protect mDepexIndex. Protocols may be installed
+//                        at any TPL up to TPL_NOTIFY.
+//
+STATIC LIST_ENTRY  mDepexIndex[DEPEX_INDEX_BUCKET_COUNT];
+STATIC BOOLEAN     mDepexIndexReady = FALSE;
+STATIC EFI_LOCK    mDepexIndexLock  = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL);
+
+//
+// Statistics reported by CoreDepexIndexReportStatistics ()
+//
+STATIC UINT64  mDepexEvaluationCount = 0;
+STATIC UINT64  mDepexSkippedCount    = 0;
+STATIC UINT64  mDepexEvaluationTime  = 0;
+
+/**
+  Get the bucket of mDepexIndex that a protocol GUID falls into.
+
+  @param  Protocol              The protocol GUID.
+
+  @return The bucket.
+
+**/
+STATIC
+LIST_ENTRY *
+DepexIndexBucket (
+  IN CONST EFI_GUID  *Protocol
+  )
+{
+  UINT32  Value;
+
+  Value = ReadUnaligned32 ((UINT32 *)Protocol) ^
+          ReadUnaligned32 ((UINT32 *)Protocol + 1) ^
+          ReadUnaligned32 ((UINT32 *)Protocol + 2) ^
+          ReadUnaligned32 ((UINT32 *)Protocol + 3);
+
+  return &mDepexIndex[(UINT32)(Value * DEPEX_INDEX_HASH_MULTIPLIER) >> (32 - DEPEX_INDEX_BUCKET_BITS)];
+}
+
+/**
+  Count the protocol GUIDs pushed by a dependency expression that is not yet
+  satisfied, and check that the expression can be indexed.
+
+  @param  DriverEntry           The driver whose dependency expression is parsed.
+  @param  PushCount             Returns the number of PUSH opcodes.
+
+  @retval TRUE                  The expression only changes when one of the
+                                pushed protocols is installed.
+  @retval FALSE                 The expression has to be evaluated in every
+                                dispatch round.
+
+**/
+STATIC
+BOOLEAN
+DepexIndexParse (
+  IN  EFI_CORE_DRIVER_ENTRY  *DriverEntry,
+  OUT UINTN                  *PushCount
+  )
+{
+  UINT8  *Iterator;
+  UINT8  *End;
+
+  *PushCount = 0;
+  if (DriverEntry->Depex == NULL) {
+    return FALSE;
+  }
+
+  Iterator = DriverEntry->Depex;
+  End      = Iterator + DriverEntry->DepexSize;
+  while (Iterator < End) {
+    switch (*Iterator) {
+      case EFI_DEP_PUSH:
+      case EFI_DEP_REPLACE_TRUE:
+        if ((UINTN)(End - Iterator) <= sizeof (EFI_GUID)) {
+          return FALSE;
+        }
+
+        if (*Iterator == EFI_DEP_PUSH) {
+          (*PushCount)++;
+        }
+
+        Iterator += sizeof (EFI_GUID);
+        break;
+
+      case EFI_DEP_SOR:
+      case EFI_DEP_AND:
+      case EFI_DEP_OR:
+      case EFI_DEP_TRUE:
+      case EFI_DEP_FALSE:
+        break;
+
+      case EFI_DEP_END:
+        return TRUE;
+
+      default:
+        //
+        // NOT may turn an expression TRUE when a protocol is uninstalled.
+        // BEFORE and AFTER are never evaluated by CoreIsSchedulable (), and
+        // unknown opcodes are left to it to report.
+        //
+        return FALSE;
+    }
+
+    Iterator++;
+  }
+
+  return FALSE;
+}
+
+/**
+  Add a driver to the protocol index of the dependency expressions. The
+  driver is marked stale, so its expression is evaluated in the next
+  dispatch round.
+
+  @param  DriverEntry           The driver whose dependency expression was just
+                                read and preprocessed.
+
+**/
+VOID
+CoreDepexIndexAddDriver (
+  IN  EFI_CORE_DRIVER_ENTRY  *DriverEntry
+  )
+{
+  UINTN         PushCount;
+  UINTN         Index;
+  UINT8         *Iterator;
+  DEPEX_WAITER  *Waiters;
+
+  DriverEntry->DepexStale = TRUE;
+
+  if (!FeaturePcdGet (PcdDxeDispatcherDepexIndexEnable) || (DriverEntry->DepexWaiters != NULL)) {
+    return;
+  }
+
+  if (!DepexIndexParse (DriverEntry, &PushCount)) {
+    DriverEntry->DepexAlwaysEvaluate = TRUE;
+    return;
+  }
+
+  if (PushCount == 0) {
+    return;
+  }
+
+  Waiters = AllocatePool (PushCount * sizeof (DEPEX_WAITER));
+  if (Waiters == NULL) {
+    DriverEntry->DepexAlwaysEvaluate = TRUE;
+    return;
+  }
+
+  Index    = 0;
+  Iterator = DriverEntry->Depex;
+  while (*Iterator != EFI_DEP_END) {
+    if ((*Iterator == EFI_DEP_PUSH) || (*Iterator == EFI_DEP_REPLACE_TRUE)) {
+      if (*Iterator == EFI_DEP_PUSH) {
+        Waiters[Index].Signature   = DEPEX_WAITER_SIGNATURE;
+        Waiters[Index].DriverEntry = DriverEntry;
+        CopyGuid (&Waiters[Index].Protocol, (EFI_GUID *)(Iterator + 1));
+        Index++;
+      }
+
+      Iterator += sizeof (EFI_GUID);
+    }
+
+    Iterator++;
+  }
+
+  ASSERT (Index == PushCount);
+
+  CoreAcquireLock (&mDepexIndexLock);
+
+  if (!mDepexIndexReady) {
+    for (Index = 0; Index < DEPEX_INDEX_BUCKET_COUNT; Index++) {
+      InitializeListHead (&mDepexIndex[Index]);
+    }
+
+    mDepexIndexReady = TRUE;
+  }
+
+  for (Index = 0; Index < PushCount; Index++) {
+    InsertTailList (DepexIndexBucket (&Waiters[Index].Protocol), &Waiters[Index].Link);
+  }
+
+  DriverEntry->DepexWaiters     = Waiters;
+  DriverEntry->DepexWaiterCount = PushCount;
+
+  CoreReleaseLock (&mDepexIndexLock);
+}
+
+/**
+  Remove a driver from the protocol index of the dependency expressions once
+  it left the Dependent state.
+
+  @param  DriverEntry           The driver to remove.
+
+**/
+VOID
+CoreDepexIndexRemoveDriver (
+  IN  EFI_CORE_DRIVER_ENTRY  *DriverEntry
+  )
+{
+  UINTN         Index;
+  DEPEX_WAITER  *Waiters;
+
+  if (DriverEntry->DepexWaiters == NULL) {
+    return;
+  }
+
+  CoreAcquireLock (&mDepexIndexLock);
+
+  Waiters = DriverEntry->DepexWaiters;
+  for (Index = 0; Index < DriverEntry->DepexWaiterCount; Index++) {
+    RemoveEntryList (&Waiters[Index].Link);
+  }
+
+  DriverEntry->DepexWaiters     = NULL;
+  DriverEntry->DepexWaiterCount = 0;
+
+  CoreReleaseLock (&mDepexIndexLock);
+
+  CoreFreePool (Waiters);
+}
+
+/**
+  Mark the drivers whose dependency expression pushes a protocol as stale.
+  Called whenever an interface of the protocol is installed.
+
+  @param  Protocol              The protocol that was installed.
+
+**/
+VOID
+CoreDepexIndexProtocolInstalled (
+  IN  EFI_GUID  *Protocol
+  )
+{
+  LIST_ENTRY    *Bucket;
+  LIST_ENTRY    *Link;
+  DEPEX_WAITER  *Waiter;
+
+  if (!FeaturePcdGet (PcdDxeDispatcherDepexIndexEnable) || !mDepexIndexReady) {
+    return;
+  }
+
+  CoreAcquireLock (&mDepexIndexLock);
+
+  Bucket = DepexIndexBucket (Protocol);
+  for (Link = Bucket->ForwardLink; Link != Bucket; Link = Link->ForwardLink) {
+    Waiter = CR (Link, DEPEX_WAITER, Link, DEPEX_WAITER_SIGNATURE);
+    if (CompareGuid (&Waiter->Protocol, Protocol)) {
+      Waiter->DriverEntry->DepexStale = TRUE;
+    }
+  }
+
+  CoreReleaseLock (&mDepexIndexLock);
+}
+
+/**
+  Read a timestamp from the first timer of the CPU Architectural Protocol.
+
+  @param  Period                Returns the period of the timer in femtoseconds,
+                                or 0 if no timer is available yet.
+
+  @return The timer value.
+
+**/
+STATIC
+UINT64
+DepexIndexTimestamp (
+  OUT UINT64  *Period
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      Value;
+
+  *Period = 0;
+  Value   = 0;
+  if ((gCpu != NULL) && (gCpu->NumberOfTimers > 0)) {
+    Status = gCpu->GetTimerValue (gCpu, 0, &Value, Period);
+    if (EFI_ERROR (Status)) {
+      *Period = 0;
+    }
+  }
+
+  return Value;
+}
+
+/**
+  Evaluate the dependency expression of a Dependent driver, unless the
+  protocol index shows that none of the protocols it pushes was installed
+  since it was last evaluated.
+
+  @param  DriverEntry           The driver to evaluate.
+
+  @retval TRUE                  If driver is ready to run.
+  @retval FALSE                 If driver is not ready to run, was skipped, or
+                                some fatal error was found.
+
+**/
+BOOLEAN
+CoreDepexIndexIsSchedulable (
+  IN  EFI_CORE_DRIVER_ENTRY  *DriverEntry
+  )
+{
+  BOOLEAN  Result;
+  UINT64   Start;
+  UINT64   End;
+  UINT64   Period;
+  UINT64   EndPeriod;
+
+  if (!FeaturePcdGet (PcdDxeDispatcherDepexIndexEnable)) {
+    return CoreIsSchedulable (DriverEntry);
+  }
+
+  if (DriverEntry->Before || DriverEntry->After) {
+    return FALSE;
+  }
+
+  if (!DriverEntry->DepexStale && !DriverEntry->DepexAlwaysEvaluate) {
+    mDepexSkippedCount++;
+    return FALSE;
+  }
+
+  //
+  // Clear the flag first, so that a protocol installed while the expression
+  // is evaluated gets the driver evaluated again in the next round.
+  //
+  DriverEntry->DepexStale = FALSE;
+
+  Start  = DepexIndexTimestamp (&Period);
+  Result = CoreIsSchedulable (DriverEntry);
+  End    = DepexIndexTimestamp (&EndPeriod);
+
+  mDepexEvaluationCount++;
+  if ((Period != 0) && (EndPeriod == Period) && (End >= Start)) {
+    //
+    // Accumulate in picoseconds so short evaluations are not rounded to 0.
+    //
+    mDepexEvaluationTime += DivU64x32 (MultU64x64 (End - Start, Period), 1000);
+  }
+
+  return Result;
+}
+
+/**
+  Report how many dependency expression evaluations the protocol index saved,
+  and the time they are estimated to have cost.
+
+**/
+VOID
+CoreDepexIndexReportStatistics (
+  VOID
+  )
+{
+  UINT64  SavedTime;
+
+  if (!FeaturePcdGet (PcdDxeDispatcherDepexIndexEnable)) {
+    return;
+  }
+
+  //
+  // Estimate the time saved from the average cost of the evaluations that
+  // were done.
+  //
+  SavedTime = 0;
+  if (mDepexEvaluationCount != 0) {
+    SavedTime = DivU64x64Remainder (
+                  MultU64x64 (mDepexEvaluationTime, mDepexSkippedCount),
+                  MultU64x32 (mDepexEvaluationCount, 1000),
+                  NULL
+                  );
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "DXE dispatcher: %ld DEPEX evaluations (%ld ns), %ld skipped by the protocol index (~%ld ns saved)\n",
+    mDepexEvaluationCount,
+    DivU64x32 (mDepexEvaluationTime, 1000),
+    mDepexSkippedCount,
+    SavedTime
+    ));
+}
@@ -84,6 +84,28 @@ typedef struct {
 
 FV_FILEPATH_DEVICE_PATH  mFvDevicePath;
 
+//
+// Dispatch plan of one FV, see PcdDxeDispatchPlanEnable
+//
+#define DXE_DISPATCH_PLAN_SIGNATURE  SIGNATURE_32('d','p','l','n')
+typedef struct _DXE_DISPATCH_PLAN {
+  UINTN                    Signature;
+  LIST_ENTRY               Link;            // mDispatchPlanList
+  EFI_HANDLE               FvHandle;
+  BOOLEAN                  Abandoned;       // The plan did not hold for this boot
+  UINTN                    EntryCount;
+  UINTN                    Next;            // Index of the first driver not dispatched yet
+  EFI_CORE_DRIVER_ENTRY    **Entries;
+  UINT32                   *Rounds;         // Dispatch round of each entry, ascending
+} DXE_DISPATCH_PLAN;
+
+//
+// The dispatch plans of the FVs, in the order the FVs were processed.
+//
+LIST_ENTRY  mDispatchPlanList = INITIALIZE_LIST_HEAD_VARIABLE (mDispatchPlanList);
+UINTN       mDispatchPlanAbandonedCount = 0;
+UINTN       mDispatchPlanScheduledCount = 0;
+
 //
 // Function Prototypes
 //
@@ -195,6 +217,57 @@ CoreProcessFvImageFile (
   IN  EFI_GUID                       *FileName
   );
 
+/**
+  Read the dispatch plan file of a firmware volume, if it has one, and append
+  it to mDispatchPlanList. Must be called once every driver of the firmware
+  volume was added to mDiscoveredList.
+
+  @param  Fv                    The FIRMWARE_VOLUME protocol installed on the FV.
+  @param  FvHandle              The handle of the FV.
+
+**/
+VOID
+CoreReadDispatchPlan (
+  IN  EFI_FIRMWARE_VOLUME2_PROTOCOL  *Fv,
+  IN  EFI_HANDLE                     FvHandle
+  );
+
+/**
+  Decide from its dispatch plan, without evaluating its dependency expression,
+  whether a Dependent driver is ready to run. A planned driver is ready once
+  every driver of its plan placed in an earlier dispatch round was dispatched.
+
+  @param  DriverEntry           The Dependent driver.
+  @param  Schedulable           Set to TRUE if the driver is ready to run.
+
+  @retval TRUE                  The driver follows a dispatch plan that still
+                                holds, and Schedulable was set.
+  @retval FALSE                 The dependency expression of the driver must be
+                                evaluated.
+
+**/
+BOOLEAN
+CoreIsSchedulableFromDispatchPlan (
+  IN  EFI_CORE_DRIVER_ENTRY  *DriverEntry,
+  OUT BOOLEAN                *Schedulable
+  );
+
+/**
+  Abandon the dispatch plan of a driver for the rest of the boot, if the
+  driver is part of one. The drivers of the plan that are still waiting have
+  their dependency expression evaluated from then on.
+
+  @param  DriverEntry           The driver that did not behave as planned.
+  @param  Status                The status that the load or start of the
+                                driver returned.
+
+**/
+VOID
+CoreAbandonDispatchPlan (
+  IN  EFI_CORE_DRIVER_ENTRY  *DriverEntry,
+  IN  EFI_STATUS             Status
+  );
+
 /**
   Enter critical section by gaining lock on mDispatcherLock.
 
@@ -269,6 +342,7 @@ CoreGetDepexSectionAndPreProccess (
       DriverEntry->Depex              = NULL;
       DriverEntry->Dependent          = TRUE;
       DriverEntry->DepexProtocolError = FALSE;
+      CoreDepexIndexAddDriver (DriverEntry);
     }
   } else {
     //
@@ -277,6 +351,7 @@ CoreGetDepexSectionAndPreProccess (
     //
     CorePreProcessDepex (DriverEntry);
     DriverEntry->DepexProtocolError = FALSE;
+    CoreDepexIndexAddDriver (DriverEntry);
   }
 
   return Status;
@@ -321,6 +396,7 @@ CoreSchedule (
       CoreAcquireDispatcherLock ();
       DriverEntry->Unrequested = FALSE;
       DriverEntry->Dependent   = TRUE;
+      DriverEntry->DepexStale  = TRUE;
       CoreReleaseDispatcherLock ();
 
       DEBUG ((DEBUG_DISPATCH, "Schedule FFS(%g) - EFI_SUCCESS\n", DriverName));
@@ -381,6 +457,33 @@ CoreTrust (
   return EFI_NOT_FOUND;
 }
 
+/**
+  Have the images of the drivers in the mScheduledQueue read, and loaded on
+  all the processors, before they are dispatched.
+
+**/
+VOID
+CorePrefetchScheduledImages (
+  VOID
+  )
+{
+  LIST_ENTRY             *Link;
+  EFI_CORE_DRIVER_ENTRY  *DriverEntry;
+
+  if (!FeaturePcdGet (PcdDxeImagePrefetchEnable)) {
+    return;
+  }
+
+  for (Link = mScheduledQueue.ForwardLink; Link != &mScheduledQueue; Link = Link->ForwardLink) {
+    DriverEntry = CR (Link, EFI_CORE_DRIVER_ENTRY, ScheduledLink, EFI_CORE_DRIVER_ENTRY_SIGNATURE);
+    if ((DriverEntry->ImageHandle == NULL) && !DriverEntry->IsFvImage) {
+      CoreImagePrefetchAdd (DriverEntry->FvFileDevicePath);
+    }
+  }
+
+  CoreImagePrefetchLoad ();
+}
+
 /**
   This is the main Dispatcher for DXE and it exits when there are no more
   drivers to run. Drain the mScheduledQueue and load and start a PE
@@ -406,6 +509,7 @@ CoreDispatcher (
   LIST_ENTRY             *Link;
   EFI_CORE_DRIVER_ENTRY  *DriverEntry;
   BOOLEAN                ReadyToRun;
+  BOOLEAN                Schedulable;
   EFI_EVENT              DxeDispatchEvent;
 
   PERF_FUNCTION_BEGIN ();
@@ -433,6 +537,8 @@ CoreDispatcher (
 
   ReturnStatus = EFI_NOT_FOUND;
   do {
+    CorePrefetchScheduledImages ();
+
     //
     // Drain the Scheduled Queue
     //
@@ -486,6 +592,8 @@ CoreDispatcher (
 
           CoreReleaseDispatcherLock ();
 
+          CoreAbandonDispatchPlan (DriverEntry, Status);
+
           //
           // If it's an error don't try the StartImage
           //
@@ -523,6 +631,14 @@ CoreDispatcher (
           &DriverEntry->ImageHandle,
           sizeof (DriverEntry->ImageHandle)
           );
+
+        if (EFI_ERROR (Status)) {
+          //
+          // The driver may not have installed the protocols its dependents
+          // were planned to find.
+          //
+          CoreAbandonDispatchPlan (DriverEntry, Status);
+        }
       }
 
       ReturnStatus = EFI_SUCCESS;
@@ -540,6 +656,10 @@ CoreDispatcher (
     //
     // Search DriverList for items to place on Scheduled Queue
     //
+    if (FeaturePcdGet (PcdDxeDispatcherDepexIndexEnable)) {
+      PERF_INMODULE_BEGIN ("DxeDepexEval");
+    }
+
     ReadyToRun = FALSE;
     for (Link = mDiscoveredList.ForwardLink; Link != &mDiscoveredList; Link = Link->ForwardLink) {
       DriverEntry = CR (Link, EFI_CORE_DRIVER_ENTRY, Link, EFI_CORE_DRIVER_ENTRY_SIGNATURE);
@@ -552,7 +672,15 @@ CoreDispatcher (
       }
 
       if (DriverEntry->Dependent) {
-        if (CoreIsSchedulable (DriverEntry)) {
+        //
+        // The dispatch plan of the driver, if it holds, tells whether the
+        // driver is ready without evaluating its dependency expression.
+        //
+        if (!CoreIsSchedulableFromDispatchPlan (DriverEntry, &Schedulable)) {
+          Schedulable = CoreDepexIndexIsSchedulable (DriverEntry);
+        }
+
+        if (Schedulable) {
           CoreInsertOnScheduledQueueWhileProcessingBeforeAndAfter (DriverEntry);
           ReadyToRun = TRUE;
         }
@@ -564,8 +692,23 @@ CoreDispatcher (
         }
       }
     }
+
+    if (FeaturePcdGet (PcdDxeDispatcherDepexIndexEnable)) {
+      PERF_INMODULE_END ("DxeDepexEval");
+    }
   } while (ReadyToRun);
 
+  CoreDepexIndexReportStatistics ();
+
+  if (FeaturePcdGet (PcdDxeDispatchPlanEnable)) {
+    DEBUG ((
+      DEBUG_INFO,
+      "DXE dispatcher: %Lu drivers scheduled from dispatch plans without DEPEX evaluation, %Lu plans abandoned\n",
+      (UINT64)mDispatchPlanScheduledCount,
+      (UINT64)mDispatchPlanAbandonedCount
+      ));
+  }
+
   //
   // Close DXE dispatch Event
   //
@@ -628,6 +771,8 @@ CoreInsertOnScheduledQueueWhileProcessingBeforeAndAfter (
 
   CoreReleaseDispatcherLock ();
 
+  CoreDepexIndexRemoveDriver (InsertedDriverEntry);
+
   //
   // Process After Dependency
   //
@@ -1428,6 +1573,8 @@ CoreFwVolEventProtocolNotify (
       }
     }
 
+    CoreReadDispatchPlan (Fv, FvHandle);
+
     //
     // Free data allocated by Fv->ReadSection ()
     //
@@ -1435,6 +1582,220 @@ CoreFwVolEventProtocolNotify (
   }
 }
 
+/**
+  Read the dispatch plan file of a firmware volume, if it has one, and append
+  it to mDispatchPlanList. Must be called once every driver of the firmware
+  volume was added to mDiscoveredList.
+
+  @param  Fv                    The FIRMWARE_VOLUME protocol installed on the FV.
+  @param  FvHandle              The handle of the FV.
+
+**/
+VOID
+CoreReadDispatchPlan (
+  IN  EFI_FIRMWARE_VOLUME2_PROTOCOL  *Fv,
+  IN  EFI_HANDLE                     FvHandle
+  )
+{
+  EFI_STATUS                  Status;
+  EDKII_DISPATCH_PLAN_HEADER  *Header;
+  EFI_GUID                    *FileName;
+  UINT32                      *Round;
+  UINTN                       Size;
+  UINT32                      AuthenticationStatus;
+  DXE_DISPATCH_PLAN           *Plan;
+  UINTN                       Index;
+  LIST_ENTRY                  *Link;
+  EFI_CORE_DRIVER_ENTRY       *DriverEntry;
+
+  if (!FeaturePcdGet (PcdDxeDispatchPlanEnable)) {
+    return;
+  }
+
+  Header = NULL;
+  Status = Fv->ReadSection (
+                 Fv,
+                 &gEdkiiDxeDispatchPlanFileGuid,
+                 EFI_SECTION_RAW,
+                 0,
+                 (VOID **)&Header,
+                 &Size,
+                 &AuthenticationStatus
+                 );
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  //
+  // The CRC32 only detects a damaged plan. The plan is trusted as much as the
+  // FV it resides in, like the a priori file.
+  //
+  Plan     = NULL;
+  FileName = (EFI_GUID *)(Header + 1);
+  if ((Size < sizeof (EDKII_DISPATCH_PLAN_HEADER)) ||
+      (Header->Signature != EDKII_DISPATCH_PLAN_SIGNATURE) ||
+      (Header->Version != EDKII_DISPATCH_PLAN_VERSION) ||
+      (Header->EntryCount > (Size - sizeof (EDKII_DISPATCH_PLAN_HEADER)) / (sizeof (EFI_GUID) + sizeof (UINT32))) ||
+      (CalculateCrc32 (FileName, Header->EntryCount * (sizeof (EFI_GUID) + sizeof (UINT32))) != Header->Crc32))
+  {
+    DEBUG ((DEBUG_WARN, "Dispatch plan of FV %p is invalid, ignored\n", FvHandle));
+    goto Done;
+  }
+
+  Round = (UINT32 *)(FileName + Header->EntryCount);
+  Plan  = AllocatePool (
+            sizeof (DXE_DISPATCH_PLAN) +
+            Header->EntryCount * (sizeof (EFI_CORE_DRIVER_ENTRY *) + sizeof (UINT32))
+            );
+  if (Plan == NULL) {
+    goto Done;
+  }
+
+  Plan->Signature  = DXE_DISPATCH_PLAN_SIGNATURE;
+  Plan->FvHandle   = FvHandle;
+  Plan->Abandoned  = FALSE;
+  Plan->EntryCount = Header->EntryCount;
+  Plan->Next       = 0;
+  Plan->Entries    = (EFI_CORE_DRIVER_ENTRY **)(Plan + 1);
+  Plan->Rounds     = (UINT32 *)(Plan->Entries + Plan->EntryCount);
+  CopyMem (Plan->Rounds, Round, Plan->EntryCount * sizeof (UINT32));
+
+  //
+  // The plan is only valid for the FV it resides in, like the a priori file.
+  // Its drivers skip their dependency expression, so each of them must be
+  // waiting on a plain dependency expression, and listed only once.
+  //
+  for (Index = 0; Index < Plan->EntryCount; Index++) {
+    Plan->Entries[Index] = NULL;
+    for (Link = mDiscoveredList.ForwardLink; Link != &mDiscoveredList; Link = Link->ForwardLink) {
+      DriverEntry = CR (Link, EFI_CORE_DRIVER_ENTRY, Link, EFI_CORE_DRIVER_ENTRY_SIGNATURE);
+      if ((FvHandle == DriverEntry->FvHandle) && CompareGuid (&DriverEntry->FileName, &FileName[Index])) {
+        Plan->Entries[Index] = DriverEntry;
+        break;
+      }
+    }
+
+    if ((Plan->Entries[Index] == NULL) ||
+        !Plan->Entries[Index]->Dependent ||
+        Plan->Entries[Index]->Before ||
+        Plan->Entries[Index]->After ||
+        (Plan->Entries[Index]->DispatchPlan != NULL) ||
+        ((Index > 0) && (Plan->Rounds[Index] < Plan->Rounds[Index - 1])))
+    {
+      DEBUG ((DEBUG_WARN, "Dispatch plan of FV %p does not match FFS(%g), ignored\n", FvHandle, &FileName[Index]));
+      while (Index > 0) {
+        Index--;
+        Plan->Entries[Index]->DispatchPlan = NULL;
+      }
+
+      FreePool (Plan);
+      goto Done;
+    }
+
+    Plan->Entries[Index]->DispatchPlan      = Plan;
+    Plan->Entries[Index]->DispatchPlanRound = Plan->Rounds[Index];
+  }
+
+  InsertTailList (&mDispatchPlanList, &Plan->Link);
+  DEBUG ((DEBUG_INFO, "Dispatch plan of FV %p: %Lu drivers\n", FvHandle, (UINT64)Plan->EntryCount));
+
+Done:
+  FreePool (Header);
+}
+
+/**
+  Decide from its dispatch plan, without evaluating its dependency expression,
+  whether a Dependent driver is ready to run. A planned driver is ready once
+  every driver of its plan placed in an earlier dispatch round was dispatched.
+
+  @param  DriverEntry           The Dependent driver.
+  @param  Schedulable           Set to TRUE if the driver is ready to run.
+
+  @retval TRUE                  The driver follows a dispatch plan that still
+                                holds, and Schedulable was set.
+  @retval FALSE                 The dependency expression of the driver must be
+                                evaluated.
+
+**/
+BOOLEAN
+CoreIsSchedulableFromDispatchPlan (
+  IN  EFI_CORE_DRIVER_ENTRY  *DriverEntry,
+  OUT BOOLEAN                *Schedulable
+  )
+{
+  DXE_DISPATCH_PLAN      *Plan;
+  EFI_CORE_DRIVER_ENTRY  *NextEntry;
+
+  Plan = DriverEntry->DispatchPlan;
+  if ((Plan == NULL) || Plan->Abandoned) {
+    return FALSE;
+  }
+
+  //
+  // The scheduled queue is drained before the drivers are evaluated, so every
+  // planned driver is either dispatched or still Dependent. A planned driver
+  // in any other state, such as Untrusted, means the plan does not hold.
+  //
+  while (Plan->Next < Plan->EntryCount) {
+    NextEntry = Plan->Entries[Plan->Next];
+    if (NextEntry->Initialized) {
+      Plan->Next++;
+      continue;
+    }
+
+    if (!NextEntry->Dependent) {
+      CoreAbandonDispatchPlan (NextEntry, EFI_NOT_READY);
+      return FALSE;
+    }
+
+    break;
+  }
+
+  *Schedulable = (BOOLEAN)((Plan->Next == Plan->EntryCount) ||
+                           (DriverEntry->DispatchPlanRound <= Plan->Rounds[Plan->Next]));
+  if (*Schedulable) {
+    DEBUG ((DEBUG_DISPATCH, "Evaluate DXE DEPEX for FFS(%g)\n", &DriverEntry->FileName));
+    DEBUG ((DEBUG_DISPATCH, "  RESULT = TRUE (Dispatch plan round %d)\n", DriverEntry->DispatchPlanRound));
+    mDispatchPlanScheduledCount++;
+  }
+
+  return TRUE;
+}
+
+/**
+  Abandon the dispatch plan of a driver for the rest of the boot, if the
+  driver is part of one. The drivers of the plan that are still waiting have
+  their dependency expression evaluated from then on.
+
+  @param  DriverEntry           The driver that did not behave as planned.
+  @param  Status                The status that the load or start of the
+                                driver returned.
+
+**/
+VOID
+CoreAbandonDispatchPlan (
+  IN  EFI_CORE_DRIVER_ENTRY  *DriverEntry,
+  IN  EFI_STATUS             Status
+  )
+{
+  DXE_DISPATCH_PLAN  *Plan;
+
+  Plan = DriverEntry->DispatchPlan;
+  if ((Plan == NULL) || Plan->Abandoned) {
+    return;
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "Dispatch plan of FV %p does not hold at FFS(%g) - %r, abandoned\n",
+    Plan->FvHandle,
+    &DriverEntry->FileName,
+    Status
+    ));
+  Plan->Abandoned = TRUE;
+  mDispatchPlanAbandonedCount++;
+}
+
 /**
   Initialize the dispatcher. Initialize the notification function that runs when
   an FV2 protocol is added to the system.
@@ -46,13 +46,19 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/SmmBase2.h>
 #include <Protocol/PeCoffImageEmulator.h>
 #include <Protocol/MemoryAttribute.h>
+#include <Protocol/MpService.h>
+#include <Protocol/ApSignalEvent.h>
+#include <Protocol/MemoryTelemetry.h>
+#include <Protocol/MemoryAccept.h>
 #include <Guid/MemoryTypeInformation.h>
 #include <Guid/FirmwareFileSystem2.h>
 #include <Guid/FirmwareFileSystem3.h>
 #include <Guid/HobList.h>
+#include <Guid/HobIndex.h>
 #include <Guid/DebugImageInfoTable.h>
 #include <Guid/FileInfo.h>
 #include <Guid/Apriori.h>
+#include <Guid/DxeDispatchPlan.h>
 #include <Guid/DxeServices.h>
 #include <Guid/MemoryAllocationHob.h>
 #include <Guid/EventLegacyBios.h>
@@ -85,7 +91,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/DxeServicesLib.h>
 #include <Library/DebugAgentLib.h>
 #include <Library/CpuExceptionHandlerLib.h>
-#include <Library/OrderedCollectionLib.h>
+#include <Library/SynchronizationLib.h>
 
 //
 // attributes for reserved memory before it is promoted to system memory
@@ -162,8 +168,34 @@ typedef struct {
 
   EFI_HANDLE                       ImageHandle;
   BOOLEAN                          IsFvImage;
+
+  //
+  // State of the DEPEX protocol index (PcdDxeDispatcherDepexIndexEnable)
+  //
+  BOOLEAN                          DepexStale;
+  BOOLEAN                          DepexAlwaysEvaluate;
+  UINTN                            DepexWaiterCount;
+  struct _DEPEX_WAITER             *DepexWaiters;
+
+  //
+  // Dispatch plan that lists the driver (PcdDxeDispatchPlanEnable), and the
+  // dispatch round the plan places it in
+  //
+  struct _DXE_DISPATCH_PLAN        *DispatchPlan;
+  UINT32                           DispatchPlanRound;
 } EFI_CORE_DRIVER_ENTRY;
 
+//
+// One protocol GUID pushed by the DEPEX of a driver in the Dependent state
+//
+#define DEPEX_WAITER_SIGNATURE  SIGNATURE_32('d','p','x','w')
+typedef struct _DEPEX_WAITER {
+  UINTN                    Signature;
+  LIST_ENTRY               Link;            // Bucket of the DEPEX protocol index
+  EFI_GUID                 Protocol;
+  EFI_CORE_DRIVER_ENTRY    *DriverEntry;
+} DEPEX_WAITER;
+
 //
 // The data structure of GCD memory map entry
 //
@@ -242,6 +274,10 @@ extern BOOLEAN  gMemoryMapTerminated;
 
 extern EFI_DECOMPRESS_PROTOCOL  gEfiDecompress;
 
+extern EDKII_AP_SIGNAL_EVENT_PROTOCOL  gApSignalEvent;
+
+extern EDKII_MEMORY_TELEMETRY_PROTOCOL  gMemoryTelemetry;
+
 extern EFI_RUNTIME_ARCH_PROTOCOL         *gRuntime;
 extern EFI_CPU_ARCH_PROTOCOL             *gCpu;
 extern EFI_WATCHDOG_TIMER_ARCH_PROTOCOL  *gWatchdogTimer;
@@ -251,6 +287,7 @@ extern EFI_SECURITY_ARCH_PROTOCOL        *gSecurity;
 extern EFI_SECURITY2_ARCH_PROTOCOL       *gSecurity2;
 extern EFI_BDS_ARCH_PROTOCOL             *gBds;
 extern EFI_SMM_BASE2_PROTOCOL            *gSmmBase2;
+extern EDKII_MEMORY_ACCEPT_PROTOCOL      *gMemoryAccept;
 extern EFI_MEMORY_ATTRIBUTE_PROTOCOL     *gMemoryAttributeProtocol;
 
 extern EFI_TPL  gEfiCurrentTpl;
@@ -404,6 +441,16 @@ CoreNotifyOnProtocolInstallation (
   VOID
   );
 
+/**
+  Initialize the driver binding Supported() cache. Its statistics are
+  reported at ReadyToBoot.
+
+**/
+VOID
+CoreInitializeDriverBindingCache (
+  VOID
+  );
+
 /**
   Return TRUE if all AP services are available.
 
@@ -486,6 +533,98 @@ CorePreProcessDepex (
   IN  EFI_CORE_DRIVER_ENTRY  *DriverEntry
   );
 
+/**
+  Add a driver to the protocol index of the dependency expressions. The
+  driver is marked stale, so its expression is evaluated in the next
+  dispatch round.
+
+  @param  DriverEntry           The driver whose dependency expression was just
+                                read and preprocessed.
+
+**/
+VOID
+CoreDepexIndexAddDriver (
+  IN  EFI_CORE_DRIVER_ENTRY  *DriverEntry
+  );
+
+/**
+  Remove a driver from the protocol index of the dependency expressions once
+  it left the Dependent state.
+
+  @param  DriverEntry           The driver to remove.
+
+**/
+VOID
+CoreDepexIndexRemoveDriver (
+  IN  EFI_CORE_DRIVER_ENTRY  *DriverEntry
+  );
+
+/**
+  Mark the drivers whose dependency expression pushes a protocol as stale.
+  Called whenever an interface of the protocol is installed.
+
+  @param  Protocol              The protocol that was installed.
+
+**/
+VOID
+CoreDepexIndexProtocolInstalled (
+  IN  EFI_GUID  *Protocol
+  );
+
+/**
+  Evaluate the dependency expression of a Dependent driver, unless the
+  protocol index shows that none of the protocols it pushes was installed
+  since it was last evaluated.
+
+  @param  DriverEntry           The driver to evaluate.
+
+  @retval TRUE                  If driver is ready to run.
+  @retval FALSE                 If driver is not ready to run, was skipped, or
+                                some fatal error was found.
+
+**/
+BOOLEAN
+CoreDepexIndexIsSchedulable (
+  IN  EFI_CORE_DRIVER_ENTRY  *DriverEntry
+  );
+
+/**
+  Report how many dependency expression evaluations the protocol index saved,
+  and the time they are estimated to have cost.
+
+**/
+VOID
+CoreDepexIndexReportStatistics (
+  VOID
+  );
+
+/**
+  Add an image to the images that the next CoreImagePrefetchLoad () reads and
+  loads.
+
+  @param  FilePath               The device path of the image. It must remain
+                                 valid until the image is loaded.
+
+**/
+VOID
+CoreImagePrefetchAdd (
+  IN EFI_DEVICE_PATH_PROTOCOL  *FilePath
+  );
+
+/**
+  Read and authenticate the images added by CoreImagePrefetchAdd (), and load
+  the sections of those that can be loaded ahead on all the enabled
+  processors.
+
+  Nothing is prefetched unless the MP Services protocol is installed and at
+  least one AP is enabled.
+
+**/
+VOID
+CoreImagePrefetchLoad (
+  VOID
+  );
+
 /**
   Terminates all boot services.
 
@@ -1304,6 +1443,43 @@ CoreInternalFreePool (
   OUT EFI_MEMORY_TYPE  *PoolType OPTIONAL
   );
 
+/**
+  Get a snapshot of the memory telemetry counters.
+
+  @param  This                   The EDKII_MEMORY_TELEMETRY_PROTOCOL instance.
+  @param  DataSize               On entry, the size of Data. On return, the
+                                 size of the telemetry data.
+  @param  Data                   The buffer to receive the telemetry data.
+
+  @retval EFI_SUCCESS            The telemetry data was returned.
+  @retval EFI_INVALID_PARAMETER  DataSize is NULL, or Data is NULL and
+                                 *DataSize is not 0.
+  @retval EFI_BUFFER_TOO_SMALL   *DataSize is too small; it was updated with
+                                 the size needed.
+
+**/
+EFI_STATUS
+EFIAPI
+CoreGetMemoryTelemetry (
+  IN     EDKII_MEMORY_TELEMETRY_PROTOCOL  *This,
+  IN OUT UINTN                            *DataSize,
+  OUT    VOID                             *Data
+  );
+
+/**
+  Reset all the memory telemetry counters to 0.
+
+  @param  This                   The EDKII_MEMORY_TELEMETRY_PROTOCOL instance.
+
+  @retval EFI_SUCCESS            The counters were reset.
+
+**/
+EFI_STATUS
+EFIAPI
+CoreResetMemoryTelemetry (
+  IN EDKII_MEMORY_TELEMETRY_PROTOCOL  *This
+  );
+
 /**
   Loads an EFI image into memory and returns a handle to the image.
 
@@ -1554,6 +1730,25 @@ CoreSignalEvent (
   IN EFI_EVENT  UserEvent
   );
 
+/**
+  Queue an event to be signaled by the BSP.
+
+  This function may be called on the BSP or on any AP, at any TPL. It does not
+  wait for the event to be signaled. Queuing an event that is already queued
+  has no effect. The event must not be closed before it was signaled.
+
+  @param  UserEvent              The event to signal.
+
+  @retval EFI_SUCCESS            The event was queued, or already was.
+  @retval EFI_INVALID_PARAMETER  Event is not a valid event.
+
+**/
+EFI_STATUS
+EFIAPI
+CoreApSignalEvent (
+  IN EFI_EVENT  UserEvent
+  );
+
 /**
   Stops execution until an event is signaled.
 
@@ -2360,6 +2555,18 @@ CoreInitializeDebugImageInfoTable (
   VOID
   );
 
+/**
+  Build the index of the HOB list and install it into the EFI System Table's
+  Configuration Table.
+
+  @param  HobStart              The HOB list.
+
+**/
+VOID
+CoreInstallHobIndex (
+  IN VOID  *HobStart
+  );
+
 /**
   Update the CRC32 in the Debug Table.
   Since the CRC32 service is made available by the Runtime driver, we have to
@@ -27,7 +27,8 @@ EFI_WATCHDOG_TIMER_ARCH_PROTOCOL  *gWatchdogTimer = NULL;
 //
 // DXE Core globals for optional protocol dependencies
 //
-EFI_SMM_BASE2_PROTOCOL  *gSmmBase2 = NULL;
+EFI_SMM_BASE2_PROTOCOL        *gSmmBase2     = NULL;
+EDKII_MEMORY_ACCEPT_PROTOCOL  *gMemoryAccept = NULL;
 
 //
 // DXE Core Global used to update core loaded image protocol handle
@@ -361,6 +362,11 @@ DxeMain (
   Status = CoreInstallConfigurationTable (&gEfiHobListGuid, HobStart);
   ASSERT_EFI_ERROR (Status);
 
+  //
+  // Index the HOB list, so that HobLib does not walk it for every lookup
+  //
+  CoreInstallHobIndex (HobStart);
+
   //
   // Install Memory Type Information Table into the EFI System Tables's Configuration Table
   //
@@ -516,6 +522,28 @@ DxeMain (
              );
   ASSERT_EFI_ERROR (Status);
 
+  //
+  // Let the procedures run on the APs signal events
+  //
+  Status = CoreInstallMultipleProtocolInterfaces (
+             &gDxeCoreImageHandle,
+             &gEdkiiApSignalEventProtocolGuid,
+             &gApSignalEvent,
+             NULL
+             );
+  ASSERT_EFI_ERROR (Status);
+
+  //
+  // Report the counters of the pool and page services
+  //
+  Status = CoreInstallMultipleProtocolInterfaces (
+             &gDxeCoreImageHandle,
+             &gEdkiiMemoryTelemetryProtocolGuid,
+             &gMemoryTelemetry,
+             NULL
+             );
+  ASSERT_EFI_ERROR (Status);
+
   //
   // Register for the GUIDs of the Architectural Protocols, so the rest of the
   // EFI Boot Services and EFI Runtime Services tables can be filled in.
@@ -523,6 +551,8 @@ DxeMain (
   //
   CoreNotifyOnProtocolInstallation ();
 
+  CoreInitializeDriverBindingCache ();
+
   //
   // Produce Firmware Volume Protocols, one for each FV in the HOB list.
   //
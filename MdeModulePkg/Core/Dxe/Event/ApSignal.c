@@ -0,0 +1,125 @@
+/** @file
+  Let the APs signal events through the AP Signal Event protocol.
+
+  The APs must not take gEventQueueLock, which is only a TPL lock. They push
+  the events to signal on gApSignalQueue, a singly linked list of IEVENT
+  updated with compare-and-exchange only, and the BSP takes the whole list at
+  once and signals its events when it lowers its TPL. As elements are never
+  removed one at a time, the list does not suffer from the ABA problem.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeMain.h"
+#include "Event.h"
+
+///
+/// gApSignalQueue - The events queued by CoreApSignalEvent (), most recent
+/// first
+///
+IEVENT *volatile  gApSignalQueue = NULL;
+
+EDKII_AP_SIGNAL_EVENT_PROTOCOL  gApSignalEvent = {
+  CoreApSignalEvent
+};
+
+/**
+  Queue an event to be signaled by the BSP.
+
+  This function may be called on the BSP or on any AP, at any TPL. It does not
+  wait for the event to be signaled. Queuing an event that is already queued
+  has no effect. The event must not be closed before it was signaled.
+
+  @param  UserEvent              The event to signal.
+
+  @retval EFI_SUCCESS            The event was queued, or already was.
+  @retval EFI_INVALID_PARAMETER  Event is not a valid event.
+
+**/
+EFI_STATUS
+EFIAPI
+CoreApSignalEvent (
+  IN EFI_EVENT  UserEvent
+  )
+{
+  IEVENT  *Event;
+  IEVENT  *Head;
+
+  Event = UserEvent;
+
+  if (Event == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Event->Signature != EVENT_SIGNATURE) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // Only the processor that flips ApSignalQueued may link the event
+  //
+  if (InterlockedCompareExchange32 (&Event->ApSignalQueued, 0, 1) != 0) {
+    return EFI_SUCCESS;
+  }
+
+  do {
+    Head                = gApSignalQueue;
+    Event->ApSignalNext = Head;
+  } while (InterlockedCompareExchangePointer ((VOID *volatile *)&gApSignalQueue, Head, Event) != Head);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Signal the events queued by CoreApSignalEvent (), in the order they were
+  queued.
+
+  This function must run on the BSP, at a TPL where SignalEvent () may be
+  called.
+
+**/
+VOID
+CoreDrainApSignalQueue (
+  VOID
+  )
+{
+  IEVENT  *Queue;
+  IEVENT  *Events;
+  IEVENT  *Event;
+
+  if (gApSignalQueue == NULL) {
+    return;
+  }
+
+  //
+  // Take the whole queue
+  //
+  do {
+    Queue = gApSignalQueue;
+  } while (InterlockedCompareExchangePointer ((VOID *volatile *)&gApSignalQueue, Queue, NULL) != Queue);
+
+  //
+  // Reverse it, to signal the oldest event first
+  //
+  Events = NULL;
+  while (Queue != NULL) {
+    Event               = Queue;
+    Queue               = Event->ApSignalNext;
+    Event->ApSignalNext = Events;
+    Events              = Event;
+  }
+
+  while (Events != NULL) {
+    Event               = Events;
+    Events              = Event->ApSignalNext;
+    Event->ApSignalNext = NULL;
+
+    //
+    // From here on, an AP may queue the event again
+    //
+    InterlockedCompareExchange32 (&Event->ApSignalQueued, 1, 0);
+    CoreSignalEvent (Event);
+  }
+}
@@ -603,6 +603,13 @@ CoreCheckEvent (
     return EFI_INVALID_PARAMETER;
   }
 
+  //
+  // Pick up the signal if an AP queued it
+  //
+  if (Event->ApSignalQueued != 0) {
+    CoreDrainApSignalQueue ();
+  }
+
   Status = EFI_NOT_READY;
 
   if ((Event->SignalCount == 0) && ((Event->Type & EVT_NOTIFY_WAIT) != 0)) {
@@ -733,6 +740,13 @@ CoreCloseEvent (
     CoreSetTimer (Event, TimerCancel, 0);
   }
 
+  //
+  // Do not leave it in the queue of the events signaled by the APs
+  //
+  if (Event->ApSignalQueued != 0) {
+    CoreDrainApSignalQueue ();
+  }
+
   CoreAcquireEventLock ();
 
   //
@@ -29,14 +29,25 @@ extern  UINTN  gEventPending;
 ///
 /// Timer event information
 ///
-typedef struct {
-  LIST_ENTRY    Link;
-  UINT64        TriggerTime;
-  UINT64        Period;
+typedef struct _TIMER_EVENT_INFO {
+  ///
+  /// Node of the timer pairing heap: the first child, the next sibling, and
+  /// the previous sibling or the parent if this is the first child
+  ///
+  struct _TIMER_EVENT_INFO    *Child;
+  struct _TIMER_EVENT_INFO    *Sibling;
+  struct _TIMER_EVENT_INFO    *Prev;
+  BOOLEAN                     Queued;
+  ///
+  /// Orders timers with the same TriggerTime by arming order
+  ///
+  UINT64                      Sequence;
+  UINT64                      TriggerTime;
+  UINT64                      Period;
 } TIMER_EVENT_INFO;
 
 #define EVENT_SIGNATURE  SIGNATURE_32('e','v','n','t')
-typedef struct {
+typedef struct _IEVENT {
   UINTN                      Signature;
   UINT32                     Type;
   UINT32                     SignalCount;
@@ -58,8 +69,15 @@ typedef struct {
   ///
   EFI_RUNTIME_EVENT_ENTRY    RuntimeData;
   TIMER_EVENT_INFO           Timer;
+  ///
+  /// Entry in gApSignalQueue, valid while ApSignalQueued is not 0
+  ///
+  struct _IEVENT             *ApSignalNext;
+  volatile UINT32            ApSignalQueued;
 } IEVENT;
 
+extern IEVENT *volatile  gApSignalQueue;
+
 //
 // Internal prototypes
 //
@@ -76,6 +94,19 @@ CoreDispatchEventNotifies (
   IN EFI_TPL  Priority
   );
 
+/**
+  Signal the events queued by CoreApSignalEvent (), in the order they were
+  queued.
+
+  This function must run on the BSP, at a TPL where SignalEvent () may be
+  called.
+
+**/
+VOID
+CoreDrainApSignalQueue (
+  VOID
+  );
+
 /**
   Initializes timer support.
 
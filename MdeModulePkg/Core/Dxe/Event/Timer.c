@@ -12,10 +12,15 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 //
 // Internal data
 //
+// The armed timers are kept in a pairing heap ordered by trigger time, so
+// arming a timer is O(1) and cancelling or expiring one is O(log n) amortized.
+// The heap is intrusive, so it never allocates memory under mEfiTimerLock.
+//
 
-LIST_ENTRY  mEfiTimerList       = INITIALIZE_LIST_HEAD_VARIABLE (mEfiTimerList);
-EFI_LOCK    mEfiTimerLock       = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL - 1);
-EFI_EVENT   mEfiCheckTimerEvent = NULL;
+TIMER_EVENT_INFO  *mEfiTimerHeap      = NULL;
+UINT64            mEfiTimerSequence   = 0;
+EFI_LOCK          mEfiTimerLock       = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL - 1);
+EFI_EVENT         mEfiCheckTimerEvent = NULL;
 
 EFI_LOCK  mEfiSystemTimeLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL);
 UINT64    mEfiSystemTime     = 0;
@@ -24,6 +29,139 @@ UINT64    mEfiSystemTime     = 0;
 // Timer functions
 //
 
+/**
+  Checks whether a timer expires before another one. Timers that expire at the
+  same time are ordered by the time they were armed.
+
+  @param  Timer1                 The first timer
+  @param  Timer2                 The second timer
+
+  @retval TRUE                   Timer1 expires before Timer2
+  @retval FALSE                  Timer2 expires before Timer1
+
+**/
+STATIC
+BOOLEAN
+CoreTimerBefore (
+  IN TIMER_EVENT_INFO  *Timer1,
+  IN TIMER_EVENT_INFO  *Timer2
+  )
+{
+  if (Timer1->TriggerTime != Timer2->TriggerTime) {
+    return (BOOLEAN)(Timer1->TriggerTime < Timer2->TriggerTime);
+  }
+
+  return (BOOLEAN)(Timer1->Sequence < Timer2->Sequence);
+}
+
+/**
+  Melds two timer heaps.
+
+  @param  Heap1                  The root of the first heap, or NULL. It must
+                                 have no sibling and no parent.
+  @param  Heap2                  The root of the second heap, or NULL. It must
+                                 have no sibling and no parent.
+
+  @return The root of the melded heap.
+
+**/
+STATIC
+TIMER_EVENT_INFO *
+CoreMeldTimerHeaps (
+  IN TIMER_EVENT_INFO  *Heap1,
+  IN TIMER_EVENT_INFO  *Heap2
+  )
+{
+  TIMER_EVENT_INFO  *Root;
+  TIMER_EVENT_INFO  *Child;
+
+  if (Heap1 == NULL) {
+    return Heap2;
+  }
+
+  if (Heap2 == NULL) {
+    return Heap1;
+  }
+
+  if (CoreTimerBefore (Heap2, Heap1)) {
+    Root  = Heap2;
+    Child = Heap1;
+  } else {
+    Root  = Heap1;
+    Child = Heap2;
+  }
+
+  //
+  // Child becomes the first child of Root
+  //
+  Child->Sibling = Root->Child;
+  if (Root->Child != NULL) {
+    Root->Child->Prev = Child;
+  }
+
+  Child->Prev = Root;
+  Root->Child = Child;
+
+  return Root;
+}
+
+/**
+  Melds a list of sibling timer heaps into a single heap, using the two pass
+  method of the pairing heap.
+
+  @param  First                  The first heap of the sibling list, or NULL.
+
+  @return The root of the melded heap.
+
+**/
+STATIC
+TIMER_EVENT_INFO *
+CoreMeldTimerSiblings (
+  IN TIMER_EVENT_INFO  *First
+  )
+{
+  TIMER_EVENT_INFO  *Pairs;
+  TIMER_EVENT_INFO  *Heap1;
+  TIMER_EVENT_INFO  *Heap2;
+  TIMER_EVENT_INFO  *Next;
+
+  //
+  // First pass: meld the siblings in pairs from left to right. The melded
+  // pairs are pushed on a stack linked through their Sibling field.
+  //
+  Pairs = NULL;
+  while (First != NULL) {
+    Heap1 = First;
+    Heap2 = Heap1->Sibling;
+    Next  = (Heap2 == NULL) ? NULL : Heap2->Sibling;
+
+    Heap1->Sibling = NULL;
+    Heap1->Prev    = NULL;
+    if (Heap2 != NULL) {
+      Heap2->Sibling = NULL;
+      Heap2->Prev    = NULL;
+      Heap1          = CoreMeldTimerHeaps (Heap1, Heap2);
+    }
+
+    Heap1->Sibling = Pairs;
+    Pairs          = Heap1;
+    First          = Next;
+  }
+
+  //
+  // Second pass: meld the pairs from right to left
+  //
+  Heap1 = NULL;
+  while (Pairs != NULL) {
+    Next           = Pairs->Sibling;
+    Pairs->Sibling = NULL;
+    Heap1          = CoreMeldTimerHeaps (Heap1, Pairs);
+    Pairs          = Next;
+  }
+
+  return Heap1;
+}
+
 /**
   Inserts the timer event.
 
@@ -36,29 +174,62 @@ CoreInsertEventTimer (
   IN IEVENT  *Event
   )
 {
-  UINT64      TriggerTime;
-  LIST_ENTRY  *Link;
-  IEVENT      *Event2;
-
   ASSERT_LOCKED (&mEfiTimerLock);
+  ASSERT (!Event->Timer.Queued);
 
-  //
-  // Get the timer's trigger time
-  //
-  TriggerTime = Event->Timer.TriggerTime;
+  Event->Timer.Child    = NULL;
+  Event->Timer.Sibling  = NULL;
+  Event->Timer.Prev     = NULL;
+  Event->Timer.Queued   = TRUE;
+  Event->Timer.Sequence = mEfiTimerSequence++;
 
-  //
-  // Insert the timer into the timer database in assending sorted order
-  //
-  for (Link = mEfiTimerList.ForwardLink; Link != &mEfiTimerList; Link = Link->ForwardLink) {
-    Event2 = CR (Link, IEVENT, Timer.Link, EVENT_SIGNATURE);
+  mEfiTimerHeap = CoreMeldTimerHeaps (mEfiTimerHeap, &Event->Timer);
+}
 
-    if (Event2->Timer.TriggerTime > TriggerTime) {
-      break;
+/**
+  Removes the timer event from the timer database.
+
+  @param  Event                  Points to the internal structure of timer event
+                                 to be removed
+
+**/
+STATIC
+VOID
+CoreRemoveEventTimer (
+  IN IEVENT  *Event
+  )
+{
+  TIMER_EVENT_INFO  *Timer;
+  TIMER_EVENT_INFO  *SubHeap;
+
+  ASSERT_LOCKED (&mEfiTimerLock);
+  ASSERT (Event->Timer.Queued);
+
+  Timer = &Event->Timer;
+  if (Timer == mEfiTimerHeap) {
+    mEfiTimerHeap = CoreMeldTimerSiblings (Timer->Child);
+  } else {
+    //
+    // Unlink the subtree of the timer from its parent or previous sibling
+    //
+    if (Timer->Prev->Child == Timer) {
+      Timer->Prev->Child = Timer->Sibling;
+    } else {
+      Timer->Prev->Sibling = Timer->Sibling;
+    }
+
+    if (Timer->Sibling != NULL) {
+      Timer->Sibling->Prev = Timer->Prev;
     }
+
+    SubHeap       = CoreMeldTimerSiblings (Timer->Child);
+    mEfiTimerHeap = CoreMeldTimerHeaps (mEfiTimerHeap, SubHeap);
   }
 
-  InsertTailList (Link, &Event->Timer.Link);
+  Timer->Child   = NULL;
+  Timer->Sibling = NULL;
+  Timer->Prev    = NULL;
+  Timer->Queued  = FALSE;
 }
 
 /**
@@ -82,7 +253,7 @@ CoreCurrentSystemTime (
 }
 
 /**
-  Checks the sorted timer list against the current system time.
+  Checks the timer heap against the current system time.
   Signals any expired event timer.
 
   @param  CheckEvent             Not used
@@ -105,8 +276,8 @@ CoreCheckTimers (
   CoreAcquireLock (&mEfiTimerLock);
   SystemTime = CoreCurrentSystemTime ();
 
-  while (!IsListEmpty (&mEfiTimerList)) {
-    Event = CR (mEfiTimerList.ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
+  while (mEfiTimerHeap != NULL) {
+    Event = CR (mEfiTimerHeap, IEVENT, Timer, EVENT_SIGNATURE);
 
     //
     // If this timer is not expired, then we're done
@@ -119,8 +290,7 @@ CoreCheckTimers (
     // Remove this timer from the timer queue
     //
 
-    RemoveEntryList (&Event->Timer.Link);
-    Event->Timer.Link.ForwardLink = NULL;
+    CoreRemoveEventTimer (Event);
 
     //
     // Signal it
@@ -202,11 +372,11 @@ CoreTimerTick (
   mEfiSystemTime += Duration;
 
   //
-  // If the head of the list is expired, fire the timer event
+  // If the root of the heap is expired, fire the timer event
   // to process it
   //
-  if (!IsListEmpty (&mEfiTimerList)) {
-    Event = CR (mEfiTimerList.ForwardLink, IEVENT, Timer.Link, EVENT_SIGNATURE);
+  if (mEfiTimerHeap != NULL) {
+    Event = CR (mEfiTimerHeap, IEVENT, Timer, EVENT_SIGNATURE);
 
     if (Event->Timer.TriggerTime <= mEfiSystemTime) {
       CoreSignalEvent (mEfiCheckTimerEvent);
@@ -260,9 +430,8 @@ CoreSetTimer (
   //
   // If the timer is queued to the timer database, remove it
   //
-  if (Event->Timer.Link.ForwardLink != NULL) {
-    RemoveEntryList (&Event->Timer.Link);
-    Event->Timer.Link.ForwardLink = NULL;
+  if (Event->Timer.Queued) {
+    CoreRemoveEventTimer (Event);
   }
 
   Event->Timer.TriggerTime = 0;
@@ -107,6 +107,13 @@ CoreRestoreTpl (
 
   ASSERT (VALID_TPL (NewTpl));
 
+  //
+  // Signal the events that the APs queued
+  //
+  if ((gApSignalQueue != NULL) && (NewTpl < TPL_HIGH_LEVEL)) {
+    CoreDrainApSignalQueue ();
+  }
+
   //
   // If lowering below HIGH_LEVEL, make sure
   // interrupts are enabled
@@ -1,7 +1,7 @@
 /** @file
   Support functions to connect/disconnect UEFI Driver model Protocol
 
-Copyright (c) 2006 - 2018, Intel Corporation. All rights reserved.<BR>
+Copyright (c) 2006 - 2026, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
@@ -9,6 +9,13 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "DxeMain.h"
 #include "Handle.h"
 
+//
+// Number of Supported() calls made by ConnectController(), and number of calls
+// avoided because the driver binding was known to not support the controller.
+//
+UINT64  gDriverBindingSupportedCount     = 0;
+UINT64  gDriverBindingSupportedSkipCount = 0;
+
 //
 // Driver Support Functions
 //
@@ -368,6 +375,218 @@ AddSortedDriverBindingProtocol (
   }
 }
 
+/**
+  Record that the protocols on a handle changed, which discards the driver
+  binding Supported() results remembered for it.
+  The gProtocolDatabaseLock must be owned
+
+  @param  Handle                 The handle whose protocols changed
+  @param  Protocol               The protocol that was added, removed or
+                                 reinstalled, or NULL if unknown
+
+**/
+VOID
+CoreInvalidateDriverBindingCache (
+  IN IHANDLE   *Handle,
+  IN EFI_GUID  *Protocol OPTIONAL
+  )
+{
+  ASSERT_LOCKED (&gProtocolDatabaseLock);
+
+  Handle->ChangeCount++;
+
+  //
+  // A new or updated driver binding may support any controller
+  //
+  if ((Protocol != NULL) && CompareGuid (Protocol, &gEfiDriverBindingProtocolGuid)) {
+    gDriverBindingGeneration++;
+  }
+}
+
+/**
+  Free the driver binding Supported() results remembered for a handle.
+  The gProtocolDatabaseLock must be owned
+
+  @param  Handle                 The handle
+
+**/
+VOID
+CoreFreeDriverBindingCache (
+  IN IHANDLE  *Handle
+  )
+{
+  UNSUPPORTED_DRIVER_BINDING  *Unsupported;
+
+  ASSERT_LOCKED (&gProtocolDatabaseLock);
+
+  while (!IsListEmpty (&Handle->UnsupportedDrivers)) {
+    Unsupported = CR (
+                    Handle->UnsupportedDrivers.ForwardLink,
+                    UNSUPPORTED_DRIVER_BINDING,
+                    Link,
+                    UNSUPPORTED_DRIVER_BINDING_SIGNATURE
+                    );
+    RemoveEntryList (&Unsupported->Link);
+    Unsupported->Signature = 0;
+    CoreFreePool (Unsupported);
+  }
+}
+
+/**
+  Check whether a driver binding is known to not support a controller.
+
+  @param  ControllerHandle       The handle of the controller
+  @param  DriverBinding          The driver binding to check
+  @param  Stamp                  Returns the state of the controller handle and
+                                 of the driver bindings, to be passed to
+                                 CoreRecordDriverBindingUnsupported ().
+
+  @retval TRUE                   Supported() of DriverBinding returned
+                                 EFI_UNSUPPORTED for ControllerHandle, and
+                                 nothing changed since.
+  @retval FALSE                  Supported() of DriverBinding must be called.
+
+**/
+STATIC
+BOOLEAN
+CoreIsDriverBindingUnsupported (
+  IN  EFI_HANDLE                   ControllerHandle,
+  IN  EFI_DRIVER_BINDING_PROTOCOL  *DriverBinding,
+  OUT UINT64                       *Stamp
+  )
+{
+  IHANDLE                     *Handle;
+  LIST_ENTRY                  *Link;
+  UNSUPPORTED_DRIVER_BINDING  *Unsupported;
+  BOOLEAN                     Found;
+
+  Found  = FALSE;
+  *Stamp = 0;
+
+  CoreAcquireProtocolLock ();
+
+  if (!EFI_ERROR (CoreValidateHandle (ControllerHandle))) {
+    Handle = (IHANDLE *)ControllerHandle;
+
+    //
+    // Both counters only grow, so their sum changes whenever one of them does
+    //
+    *Stamp = Handle->ChangeCount + gDriverBindingGeneration;
+    if (Handle->UnsupportedStamp != *Stamp) {
+      CoreFreeDriverBindingCache (Handle);
+      Handle->UnsupportedStamp = *Stamp;
+    }
+
+    for (Link = Handle->UnsupportedDrivers.ForwardLink; Link != &Handle->UnsupportedDrivers; Link = Link->ForwardLink) {
+      Unsupported = CR (Link, UNSUPPORTED_DRIVER_BINDING, Link, UNSUPPORTED_DRIVER_BINDING_SIGNATURE);
+      if (Unsupported->DriverBinding == DriverBinding) {
+        Found = TRUE;
+        break;
+      }
+    }
+  }
+
+  CoreReleaseProtocolLock ();
+
+  return Found;
+}
+
+/**
+  Remember that Supported() of a driver binding returned EFI_UNSUPPORTED for a
+  controller.
+
+  @param  ControllerHandle       The handle of the controller
+  @param  DriverBinding          The driver binding
+  @param  Stamp                  The value returned by
+                                 CoreIsDriverBindingUnsupported () before
+                                 Supported() was called.
+
+**/
+STATIC
+VOID
+CoreRecordDriverBindingUnsupported (
+  IN EFI_HANDLE                   ControllerHandle,
+  IN EFI_DRIVER_BINDING_PROTOCOL  *DriverBinding,
+  IN UINT64                       Stamp
+  )
+{
+  IHANDLE                     *Handle;
+  UNSUPPORTED_DRIVER_BINDING  *Unsupported;
+
+  CoreAcquireProtocolLock ();
+
+  //
+  // Drop the result if the controller or the driver bindings changed while
+  // Supported() was running
+  //
+  if (!EFI_ERROR (CoreValidateHandle (ControllerHandle))) {
+    Handle = (IHANDLE *)ControllerHandle;
+    if ((Handle->UnsupportedStamp == Stamp) &&
+        (Handle->ChangeCount + gDriverBindingGeneration == Stamp))
+    {
+      Unsupported = AllocatePool (sizeof (UNSUPPORTED_DRIVER_BINDING));
+      if (Unsupported != NULL) {
+        Unsupported->Signature     = UNSUPPORTED_DRIVER_BINDING_SIGNATURE;
+        Unsupported->DriverBinding = DriverBinding;
+        InsertTailList (&Handle->UnsupportedDrivers, &Unsupported->Link);
+      }
+    }
+  }
+
+  CoreReleaseProtocolLock ();
+}
+
+/**
+  Report how many driver binding Supported() calls ConnectController() made,
+  and how many it avoided by remembering EFI_UNSUPPORTED results.
+
+  @param[in] Event      The Event this notify function registered to.
+  @param[in] Context    Pointer to the context data registered to the Event.
+**/
+STATIC
+VOID
+EFIAPI
+CoreReportDriverBindingCacheStatistics (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  DEBUG ((
+    DEBUG_INFO,
+    "ConnectController: %Lu driver binding Supported() calls, %Lu skipped as known unsupported\n",
+    gDriverBindingSupportedCount,
+    gDriverBindingSupportedSkipCount
+    ));
+}
+
+/**
+  Initialize the driver binding Supported() cache. Its statistics are
+  reported at ReadyToBoot.
+
+**/
+VOID
+CoreInitializeDriverBindingCache (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  EFI_EVENT   ReadyToBootEvent;
+
+  if (!FeaturePcdGet (PcdDriverBindingSupportedCacheEnable)) {
+    return;
+  }
+
+  Status = CoreCreateEventInternal (
+             EVT_NOTIFY_SIGNAL,
+             TPL_CALLBACK,
+             CoreReportDriverBindingCacheStatistics,
+             NULL,
+             &gEfiEventReadyToBootGuid,
+             &ReadyToBootEvent
+             );
+  ASSERT_EFI_ERROR (Status);
+}
+
 /**
   Connects a controller to a driver.
 
@@ -415,6 +634,8 @@ CoreConnectSingleController (
   UINTN                                      SortIndex;
   BOOLEAN                                    OneStarted;
   BOOLEAN                                    DriverFound;
+  BOOLEAN                                    UseCache;
+  UINT64                                     CacheStamp;
 
   //
   // Initialize local variables
@@ -426,6 +647,12 @@ CoreConnectSingleController (
   PlatformDriverOverride               = NULL;
   NewDriverBindingHandleBuffer         = NULL;
 
+  //
+  // Supported() results are only remembered for the whole controller, as they
+  // may depend on RemainingDevicePath.
+  //
+  UseCache = (BOOLEAN)(FeaturePcdGet (PcdDriverBindingSupportedCacheEnable) && (RemainingDevicePath == NULL));
+
   //
   // Get list of all Driver Binding Protocol Instances
   //
@@ -639,6 +866,12 @@ CoreConnectSingleController (
     for (Index = 0; (Index < NumberOfSortedDriverBindingProtocols) && !DriverFound; Index++) {
       if (SortedDriverBindingProtocols[Index] != NULL) {
         DriverBinding = SortedDriverBindingProtocols[Index];
+        if (UseCache && CoreIsDriverBindingUnsupported (ControllerHandle, DriverBinding, &CacheStamp)) {
+          gDriverBindingSupportedSkipCount++;
+          continue;
+        }
+
+        gDriverBindingSupportedCount++;
         PERF_DRIVER_BINDING_SUPPORT_BEGIN (DriverBinding->DriverBindingHandle, ControllerHandle);
         Status = DriverBinding->Supported (
                                   DriverBinding,
@@ -646,6 +879,10 @@ CoreConnectSingleController (
                                   RemainingDevicePath
                                   );
         PERF_DRIVER_BINDING_SUPPORT_END (DriverBinding->DriverBindingHandle, ControllerHandle);
+        if (UseCache && (Status == EFI_UNSUPPORTED)) {
+          CoreRecordDriverBindingUnsupported (ControllerHandle, DriverBinding, CacheStamp);
+        }
+
         if (!EFI_ERROR (Status)) {
           SortedDriverBindingProtocols[Index] = NULL;
           DriverFound                         = TRUE;
@@ -986,6 +1223,20 @@ CoreDisconnectController (
 
 Done:
 
+  //
+  // Stopped drivers close the protocols they opened BY_DRIVER, which may let
+  // other drivers support the controller again. This is done once every Stop()
+  // returned, so a result recorded by a Supported() call made from Stop() is
+  // dropped as well. The controller handle is gone if Stop() uninstalled all
+  // of its protocols.
+  //
+  CoreAcquireProtocolLock ();
+  if (!EFI_ERROR (CoreValidateHandle (ControllerHandle))) {
+    CoreInvalidateDriverBindingCache ((IHANDLE *)ControllerHandle, NULL);
+  }
+
+  CoreReleaseProtocolLock ();
+
   if (DriverImageHandleBuffer != NULL) {
     CoreFreePool (DriverImageHandleBuffer);
   }
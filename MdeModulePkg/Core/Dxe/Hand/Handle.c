@@ -10,16 +10,45 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "Handle.h"
 
 //
-// mProtocolDatabase     - A list of all protocols in the system.  (simple list for now)
+// The protocol hash table has a fixed number of buckets, as a platform rarely
+// installs more than a few hundred different protocols.
+//
+#define PROTOCOL_HASH_BUCKET_BITS   7
+#define PROTOCOL_HASH_BUCKET_COUNT  (1U << PROTOCOL_HASH_BUCKET_BITS)
+
+//
+// The handle hash table is doubled whenever the handles outnumber the buckets
+// by more than HANDLE_HASH_MAX_LOAD, so that handle lookups stay O(1) as
+// drivers create more handles.
+//
+#define HANDLE_HASH_MIN_BUCKET_BITS  6
+#define HANDLE_HASH_MAX_BUCKET_BITS  16
+#define HANDLE_HASH_MAX_LOAD         2
+
+//
+// Multiplier of the Fibonacci hash used for both tables.
+//
+#define HASH_MULTIPLIER  0x9E3779B1U
+
+//
+// mProtocolDatabase     - A list of all protocols in the system.
+// mProtocolHashTable    - The protocols in mProtocolDatabase hashed by GUID
 // gHandleList           - A list of all the handles in the system
+// mHandleHashTable      - The handles in gHandleList hashed by address
 // gProtocolDatabaseLock - Lock to protect the mProtocolDatabase
 // gHandleDatabaseKey    -  The Key to show that the handle has been created/modified
+// gDriverBindingGeneration - Incremented whenever a Driver Binding Protocol is
+//                         installed, uninstalled or reinstalled
 //
-LIST_ENTRY          mProtocolDatabase     = INITIALIZE_LIST_HEAD_VARIABLE (mProtocolDatabase);
-LIST_ENTRY          gHandleList           = INITIALIZE_LIST_HEAD_VARIABLE (gHandleList);
-EFI_LOCK            gProtocolDatabaseLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_NOTIFY);
-UINT64              gHandleDatabaseKey    = 0;
-ORDERED_COLLECTION  *gOrderedHandleList   = NULL;
+LIST_ENTRY  mProtocolDatabase = INITIALIZE_LIST_HEAD_VARIABLE (mProtocolDatabase);
+LIST_ENTRY  mProtocolHashTable[PROTOCOL_HASH_BUCKET_COUNT];
+LIST_ENTRY  gHandleList           = INITIALIZE_LIST_HEAD_VARIABLE (gHandleList);
+LIST_ENTRY  *mHandleHashTable     = NULL;
+UINTN       mHandleHashBits       = 0;
+UINTN       mHandleCount          = 0;
+EFI_LOCK    gProtocolDatabaseLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_NOTIFY);
+UINT64      gHandleDatabaseKey    = 0;
+UINT64      gDriverBindingGeneration = 0;
 
 /**
   Acquire lock on gProtocolDatabaseLock.
@@ -46,37 +75,118 @@ CoreReleaseProtocolLock (
 }
 
 /**
-  Comparator function for two opaque pointers, ordering on (unsigned) pointer
-  value itself.
-  Can be used as both Key and UserStruct comparator.
+  Get the bucket of a hash table that a 32-bit value falls into.
 
-  @param[in] Pointer1  First pointer.
+  @param  Value                  The value to hash.
+  @param  Bits                   Log2 of the number of buckets, 1 to 32.
 
-  @param[in] Pointer2  Second pointer.
+  @return The bucket index.
 
-  @retval <0  If Pointer1 compares less than Pointer2.
+**/
+STATIC
+UINTN
+HashToBucket (
+  IN UINT32  Value,
+  IN UINTN   Bits
+  )
+{
+  return (UINTN)((UINT32)(Value * HASH_MULTIPLIER) >> (32 - Bits));
+}
+
+/**
+  Get the protocol hash bucket of a protocol GUID.
 
-  @retval  0  If Pointer1 compares equal to Pointer2.
+  @param  Protocol               The ID of the protocol
+
+  @return The protocol hash bucket.
 
-  @retval >0  If Pointer1 compares greater than Pointer2.
 **/
 STATIC
-INTN
-EFIAPI
-PointerCompare (
-  IN CONST VOID  *Pointer1,
-  IN CONST VOID  *Pointer2
+LIST_ENTRY *
+ProtocolHashBucket (
+  IN EFI_GUID  *Protocol
+  )
+{
+  UINT32  Value;
+
+  Value = ReadUnaligned32 ((UINT32 *)Protocol) ^
+          ReadUnaligned32 ((UINT32 *)Protocol + 1) ^
+          ReadUnaligned32 ((UINT32 *)Protocol + 2) ^
+          ReadUnaligned32 ((UINT32 *)Protocol + 3);
+
+  return &mProtocolHashTable[HashToBucket (Value, PROTOCOL_HASH_BUCKET_BITS)];
+}
+
+/**
+  Get the hash bucket index of a handle.
+
+  @param  Handle                 The handle, which does not need to be valid.
+  @param  Bits                   Log2 of the number of buckets.
+
+  @return The bucket index.
+
+**/
+STATIC
+UINTN
+HandleHashBucketIndex (
+  IN EFI_HANDLE  Handle,
+  IN UINTN       Bits
   )
 {
-  if (Pointer1 == Pointer2) {
-    return 0;
+  UINT64  Value;
+
+  //
+  // Handles are pool allocations, so the low bits carry no information.
+  //
+  Value = RShiftU64 ((UINT64)(UINTN)Handle, 3);
+  return HashToBucket ((UINT32)Value ^ (UINT32)RShiftU64 (Value, 32), Bits);
+}
+
+/**
+  Double the number of buckets of the handle hash table.
+  The gProtocolDatabaseLock must be owned
+
+  If memory for the larger table cannot be allocated, the current table is
+  kept. It is still correct, only slower.
+
+**/
+STATIC
+VOID
+CoreGrowHandleHashTable (
+  VOID
+  )
+{
+  LIST_ENTRY  *NewTable;
+  UINTN       NewBits;
+  UINTN       Index;
+  LIST_ENTRY  *Link;
+  IHANDLE     *Handle;
+
+  ASSERT_LOCKED (&gProtocolDatabaseLock);
+
+  if (mHandleHashBits >= HANDLE_HASH_MAX_BUCKET_BITS) {
+    return;
+  }
+
+  NewBits  = mHandleHashBits + 1;
+  NewTable = AllocatePool (sizeof (LIST_ENTRY) << NewBits);
+  if (NewTable == NULL) {
+    return;
+  }
+
+  for (Index = 0; Index < ((UINTN)1 << NewBits); Index++) {
+    InitializeListHead (&NewTable[Index]);
   }
 
-  if ((UINTN)Pointer1 < (UINTN)Pointer2) {
-    return -1;
+  for (Link = gHandleList.ForwardLink; Link != &gHandleList; Link = Link->ForwardLink) {
+    Handle = CR (Link, IHANDLE, AllHandles, EFI_HANDLE_SIGNATURE);
+    RemoveEntryList (&Handle->HashLink);
+    InsertTailList (&NewTable[HandleHashBucketIndex (Handle, NewBits)], &Handle->HashLink);
   }
 
-  return 1;
+  CoreFreePool (mHandleHashTable);
+  mHandleHashTable = NewTable;
+  mHandleHashBits  = NewBits;
 }
 
 /**
@@ -90,12 +200,22 @@ CoreInitializeHandleServices (
   VOID
   )
 {
-  gOrderedHandleList = OrderedCollectionInit (PointerCompare, PointerCompare);
+  UINTN  Index;
 
-  if (gOrderedHandleList == NULL) {
+  for (Index = 0; Index < PROTOCOL_HASH_BUCKET_COUNT; Index++) {
+    InitializeListHead (&mProtocolHashTable[Index]);
+  }
+
+  mHandleHashTable = AllocatePool (sizeof (LIST_ENTRY) << HANDLE_HASH_MIN_BUCKET_BITS);
+  if (mHandleHashTable == NULL) {
     return EFI_OUT_OF_RESOURCES;
   }
 
+  mHandleHashBits = HANDLE_HASH_MIN_BUCKET_BITS;
+  for (Index = 0; Index < ((UINTN)1 << mHandleHashBits); Index++) {
+    InitializeListHead (&mHandleHashTable[Index]);
+  }
+
   return EFI_SUCCESS;
 }
 
@@ -114,7 +234,8 @@ CoreValidateHandle (
   IN  EFI_HANDLE  UserHandle
   )
 {
-  ORDERED_COLLECTION_ENTRY  *Entry;
+  LIST_ENTRY  *Bucket;
+  LIST_ENTRY  *Link;
 
   if (UserHandle == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -122,9 +243,15 @@ CoreValidateHandle (
 
   ASSERT_LOCKED (&gProtocolDatabaseLock);
 
-  Entry = OrderedCollectionFind (gOrderedHandleList, UserHandle);
-  if (Entry != NULL) {
-    return EFI_SUCCESS;
+  //
+  // Only compare addresses, UserHandle must not be dereferenced before it
+  // is known to be valid.
+  //
+  Bucket = &mHandleHashTable[HandleHashBucketIndex (UserHandle, mHandleHashBits)];
+  for (Link = Bucket->ForwardLink; Link != Bucket; Link = Link->ForwardLink) {
+    if (BASE_CR (Link, IHANDLE, HashLink) == UserHandle) {
+      return EFI_SUCCESS;
+    }
   }
 
   return EFI_INVALID_PARAMETER;
@@ -146,6 +273,7 @@ CoreFindProtocolEntry (
   IN BOOLEAN   Create
   )
 {
+  LIST_ENTRY      *Bucket;
   LIST_ENTRY      *Link;
   PROTOCOL_ENTRY  *Item;
   PROTOCOL_ENTRY  *ProtEntry;
@@ -153,15 +281,13 @@ CoreFindProtocolEntry (
   ASSERT_LOCKED (&gProtocolDatabaseLock);
 
   //
-  // Search the database for the matching GUID
+  // Search the hash bucket of the GUID for the matching entry
   //
 
   ProtEntry = NULL;
-  for (Link = mProtocolDatabase.ForwardLink;
-       Link != &mProtocolDatabase;
-       Link = Link->ForwardLink)
-  {
-    Item = CR (Link, PROTOCOL_ENTRY, AllEntries, PROTOCOL_ENTRY_SIGNATURE);
+  Bucket    = ProtocolHashBucket (Protocol);
+  for (Link = Bucket->ForwardLink; Link != Bucket; Link = Link->ForwardLink) {
+    Item = CR (Link, PROTOCOL_ENTRY, HashLink, PROTOCOL_ENTRY_SIGNATURE);
     if (CompareGuid (&Item->ProtocolID, Protocol)) {
       //
       // This is the protocol entry
@@ -192,6 +318,7 @@ CoreFindProtocolEntry (
       // Add it to protocol database
       //
       InsertTailList (&mProtocolDatabase, &ProtEntry->AllEntries);
+      InsertTailList (Bucket, &ProtEntry->HashLink);
     }
   }
 
@@ -504,21 +631,12 @@ CoreInstallProtocolInterfaceNotify (
       goto Done;
     }
 
-    //
-    // Add this handle to the ordered list of all handles
-    // in the system
-    //
-    Status = OrderedCollectionInsert (gOrderedHandleList, NULL, Handle);
-    if (EFI_ERROR (Status)) {
-      CoreFreePool (Handle);
-      goto Done;
-    }
-
     //
     // Initialize new handler structure
     //
     Handle->Signature = EFI_HANDLE_SIGNATURE;
     InitializeListHead (&Handle->Protocols);
+    InitializeListHead (&Handle->UnsupportedDrivers);
 
     //
     // Initialize the Key to show that the handle has been created/modified
@@ -531,6 +649,18 @@ CoreInstallProtocolInterfaceNotify (
     // in the system
     //
     InsertTailList (&gHandleList, &Handle->AllHandles);
+
+    //
+    // Add this handle to the hash table used to validate handles
+    //
+    InsertTailList (
+      &mHandleHashTable[HandleHashBucketIndex (Handle, mHandleHashBits)],
+      &Handle->HashLink
+      );
+    mHandleCount++;
+    if (mHandleCount > (HANDLE_HASH_MAX_LOAD << mHandleHashBits)) {
+      CoreGrowHandleHashTable ();
+    }
   } else {
     Status = CoreValidateHandle (Handle);
     if (EFI_ERROR (Status)) {
@@ -570,6 +700,9 @@ CoreInstallProtocolInterfaceNotify (
   //
   InsertTailList (&ProtEntry->Protocols, &Prot->ByProtocol);
 
+  CoreInvalidateDriverBindingCache (Handle, Protocol);
+  CoreDepexIndexProtocolInstalled (Protocol);
+
   //
   // Notify the notification list for this protocol
   //
@@ -873,6 +1006,7 @@ CoreUninstallProtocolInterface (
     // Remove the protocol interface from the handle
     //
     RemoveEntryList (&Prot->Link);
+    CoreInvalidateDriverBindingCache (Handle, Protocol);
 
     //
     // Free the memory
@@ -887,12 +1021,10 @@ CoreUninstallProtocolInterface (
   //
   if (IsListEmpty (&Handle->Protocols)) {
     Handle->Signature = 0;
-    OrderedCollectionDelete (
-      gOrderedHandleList,
-      OrderedCollectionFind (gOrderedHandleList, Handle),
-      NULL
-      );
+    RemoveEntryList (&Handle->HashLink);
+    mHandleCount--;
     RemoveEntryList (&Handle->AllHandles);
+    CoreFreeDriverBindingCache (Handle);
     CoreFreePool (Handle);
   }
 
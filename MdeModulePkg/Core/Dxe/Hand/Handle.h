@@ -23,6 +23,14 @@ typedef struct {
   UINTN         LocateRequest;
   /// The Handle Database Key value when this handle was last created or modified
   UINT64        Key;
+  /// Link on the handle hash bucket used to validate handles
+  LIST_ENTRY    HashLink;
+  /// Incremented whenever the protocols on this handle change
+  UINT64        ChangeCount;
+  /// List of UNSUPPORTED_DRIVER_BINDING's that do not support this handle
+  LIST_ENTRY    UnsupportedDrivers;
+  /// ChangeCount plus gDriverBindingGeneration when UnsupportedDrivers was filled
+  UINT64        UnsupportedStamp;
 } IHANDLE;
 
 #define ASSERT_IS_HANDLE(a)  ASSERT((a)->Signature == EFI_HANDLE_SIGNATURE)
@@ -44,6 +52,8 @@ typedef struct {
   LIST_ENTRY    Protocols;
   /// Registerd notification handlers
   LIST_ENTRY    Notify;
+  /// Link on the protocol hash bucket selected by ProtocolID
+  LIST_ENTRY    HashLink;
 } PROTOCOL_ENTRY;
 
 #define PROTOCOL_INTERFACE_SIGNATURE  SIGNATURE_32('p','i','f','c')
@@ -82,6 +92,19 @@ typedef struct {
   UINT32        OpenCount;
 } OPEN_PROTOCOL_DATA;
 
+#define UNSUPPORTED_DRIVER_BINDING_SIGNATURE  SIGNATURE_32('u','d','r','b')
+
+///
+/// UNSUPPORTED_DRIVER_BINDING - a driver binding whose Supported() returned
+/// EFI_UNSUPPORTED for a controller handle
+///
+typedef struct {
+  UINTN                          Signature;
+  /// Link on IHANDLE.UnsupportedDrivers
+  LIST_ENTRY                     Link;
+  EFI_DRIVER_BINDING_PROTOCOL    *DriverBinding;
+} UNSUPPORTED_DRIVER_BINDING;
+
 #define PROTOCOL_NOTIFY_SIGNATURE  SIGNATURE_32('p','r','t','n')
 
 ///
@@ -209,6 +232,34 @@ CoreDisconnectControllersUsingProtocolInterface (
   IN PROTOCOL_INTERFACE  *Prot
   );
 
+/**
+  Record that the protocols on a handle changed, which discards the driver
+  binding Supported() results remembered for it.
+  The gProtocolDatabaseLock must be owned
+
+  @param  Handle                 The handle whose protocols changed
+  @param  Protocol               The protocol that was added, removed or
+                                 reinstalled, or NULL if unknown
+
+**/
+VOID
+CoreInvalidateDriverBindingCache (
+  IN IHANDLE   *Handle,
+  IN EFI_GUID  *Protocol OPTIONAL
+  );
+
+/**
+  Free the driver binding Supported() results remembered for a handle.
+  The gProtocolDatabaseLock must be owned
+
+  @param  Handle                 The handle
+
+**/
+VOID
+CoreFreeDriverBindingCache (
+  IN IHANDLE  *Handle
+  );
+
 /**
   Acquire lock on gProtocolDatabaseLock.
 
@@ -248,5 +299,8 @@ CoreValidateHandle (
 extern EFI_LOCK    gProtocolDatabaseLock;
 extern LIST_ENTRY  gHandleList;
 extern UINT64      gHandleDatabaseKey;
+extern UINT64      gDriverBindingGeneration;
+extern UINT64      gDriverBindingSupportedCount;
+extern UINT64      gDriverBindingSupportedSkipCount;
 
 #endif
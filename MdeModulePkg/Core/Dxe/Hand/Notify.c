@@ -248,6 +248,7 @@ CoreReinstallProtocolInterface (
   //
   gHandleDatabaseKey++;
   Handle->Key = gHandleDatabaseKey;
+  CoreInvalidateDriverBindingCache (Handle, Protocol);
 
   //
   // Release the lock and connect all drivers to UserHandle
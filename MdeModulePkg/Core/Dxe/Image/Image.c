@@ -549,6 +549,43 @@ CoreIsImageTypeSupported (
          EFI_IMAGE_MACHINE_CROSS_TYPE_SUPPORTED (Image->ImageContext.Machine);
 }
 
+/**
+  Set the memory types of the code and data of an image from its subsystem.
+
+  @param  ImageContext           The context of the image, filled in by
+                                 PeCoffLoaderGetImageInfo ().
+
+  @retval EFI_SUCCESS            The memory types were set.
+  @retval EFI_UNSUPPORTED        The subsystem of the image is not supported.
+
+**/
+EFI_STATUS
+CoreSetImageMemoryType (
+  IN OUT PE_COFF_LOADER_IMAGE_CONTEXT  *ImageContext
+  )
+{
+  switch (ImageContext->ImageType) {
+    case EFI_IMAGE_SUBSYSTEM_EFI_APPLICATION:
+      ImageContext->ImageCodeMemoryType = EfiLoaderCode;
+      ImageContext->ImageDataMemoryType = EfiLoaderData;
+      break;
+    case EFI_IMAGE_SUBSYSTEM_EFI_BOOT_SERVICE_DRIVER:
+      ImageContext->ImageCodeMemoryType = EfiBootServicesCode;
+      ImageContext->ImageDataMemoryType = EfiBootServicesData;
+      break;
+    case EFI_IMAGE_SUBSYSTEM_EFI_RUNTIME_DRIVER:
+    case EFI_IMAGE_SUBSYSTEM_SAL_RUNTIME_DRIVER:
+      ImageContext->ImageCodeMemoryType = EfiRuntimeServicesCode;
+      ImageContext->ImageDataMemoryType = EfiRuntimeServicesData;
+      break;
+    default:
+      ImageContext->ImageError = IMAGE_ERROR_INVALID_SUBSYSTEM;
+      return EFI_UNSUPPORTED;
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
   Loads, relocates, and invokes a PE/COFF image
 
@@ -562,6 +599,9 @@ CoreIsImageTypeSupported (
   @param  EntryPoint              A pointer to the entry point
   @param  Attribute               The bit mask of attributes to set for the load
                                   PE image
+  @param  Prefetch                The image prefetched by CoreImagePrefetchLoad (),
+                                  or NULL. If it was loaded ahead, its pages are
+                                  handed over to Image.
 
   @retval EFI_SUCCESS             The file was loaded, relocated, and invoked
   @retval EFI_OUT_OF_RESOURCES    There was not enough memory to load and
@@ -577,11 +617,13 @@ CoreLoadPeImage (
   IN LOADED_IMAGE_PRIVATE_DATA  *Image,
   IN EFI_PHYSICAL_ADDRESS       DstBuffer    OPTIONAL,
   OUT EFI_PHYSICAL_ADDRESS      *EntryPoint  OPTIONAL,
-  IN  UINT32                    Attribute
+  IN  UINT32                    Attribute,
+  IN  IMAGE_PREFETCH            *Prefetch    OPTIONAL
   )
 {
   EFI_STATUS  Status;
   BOOLEAN     DstBufAlocated;
+  BOOLEAN     Prefetched;
   UINTN       Size;
   UINTN       Index;
   UINTN       StartIndex;
@@ -617,30 +659,28 @@ CoreLoadPeImage (
   //
   // Set EFI memory type based on ImageType
   //
-  switch (Image->ImageContext.ImageType) {
-    case EFI_IMAGE_SUBSYSTEM_EFI_APPLICATION:
-      Image->ImageContext.ImageCodeMemoryType = EfiLoaderCode;
-      Image->ImageContext.ImageDataMemoryType = EfiLoaderData;
-      break;
-    case EFI_IMAGE_SUBSYSTEM_EFI_BOOT_SERVICE_DRIVER:
-      Image->ImageContext.ImageCodeMemoryType = EfiBootServicesCode;
-      Image->ImageContext.ImageDataMemoryType = EfiBootServicesData;
-      break;
-    case EFI_IMAGE_SUBSYSTEM_EFI_RUNTIME_DRIVER:
-    case EFI_IMAGE_SUBSYSTEM_SAL_RUNTIME_DRIVER:
-      Image->ImageContext.ImageCodeMemoryType = EfiRuntimeServicesCode;
-      Image->ImageContext.ImageDataMemoryType = EfiRuntimeServicesData;
-      break;
-    default:
-      Image->ImageContext.ImageError = IMAGE_ERROR_INVALID_SUBSYSTEM;
-      return EFI_UNSUPPORTED;
+  Status = CoreSetImageMemoryType (&Image->ImageContext);
+  if (EFI_ERROR (Status)) {
+    return Status;
   }
 
   //
   // Allocate memory of the correct memory type aligned on the required image boundary
   //
   DstBufAlocated = FALSE;
-  if (DstBuffer == 0) {
+  Prefetched     = FALSE;
+  if ((Prefetch != NULL) && Prefetch->Loaded && (DstBuffer == 0)) {
+    //
+    // The image was already loaded into its buffer by CoreImagePrefetchLoad ()
+    //
+    CopyMem (&Image->ImageContext, &Prefetch->ImageContext, sizeof (Image->ImageContext));
+    Image->ImageContext.Handle = Pe32Handle;
+    Image->NumberOfPages       = Prefetch->NumberOfPages;
+    Image->ImageBasePage       = Prefetch->ImageBasePage;
+    Prefetch->Loaded           = FALSE;
+    DstBufAlocated             = TRUE;
+    Prefetched                 = TRUE;
+  } else if (DstBuffer == 0) {
     //
     // Allocate Destination Buffer as caller did not pass it in
     //
@@ -734,19 +774,21 @@ CoreLoadPeImage (
     Image->ImageContext.ImageAddress = DstBuffer;
   }
 
-  Image->ImageBasePage = Image->ImageContext.ImageAddress;
-  if (!Image->ImageContext.IsTeImage) {
-    Image->ImageContext.ImageAddress =
-      (Image->ImageContext.ImageAddress + Image->ImageContext.SectionAlignment - 1) &
-      ~((UINTN)Image->ImageContext.SectionAlignment - 1);
-  }
+  if (!Prefetched) {
+    Image->ImageBasePage = Image->ImageContext.ImageAddress;
+    if (!Image->ImageContext.IsTeImage) {
+      Image->ImageContext.ImageAddress =
+        (Image->ImageContext.ImageAddress + Image->ImageContext.SectionAlignment - 1) &
+        ~((UINTN)Image->ImageContext.SectionAlignment - 1);
+    }
 
-  //
-  // Load the image from the file into the allocated memory
-  //
-  Status = PeCoffLoaderLoadImage (&Image->ImageContext);
-  if (EFI_ERROR (Status)) {
-    goto Done;
+    //
+    // Load the image from the file into the allocated memory
+    //
+    Status = PeCoffLoaderLoadImage (&Image->ImageContext);
+    if (EFI_ERROR (Status)) {
+      goto Done;
+    }
   }
 
   //
@@ -882,7 +924,7 @@ Done:
   //
 
   if (DstBufAlocated) {
-    CoreFreePages (Image->ImageContext.ImageAddress, Image->NumberOfPages);
+    CoreFreePages (Image->ImageBasePage, Image->NumberOfPages);
     Image->ImageContext.ImageAddress = 0;
     Image->ImageBasePage             = 0;
   }
@@ -1086,6 +1128,78 @@ CoreUnloadAndCloseImage (
   CoreFreePool (Image);
 }
 
+/**
+  Check an image file through the Security2 and the Security Architectural
+  Protocols, before the image is loaded.
+
+  @param  FilePath               The device path the image is loaded from.
+  @param  Source                 The image file.
+  @param  SourceSize             The size of Source in bytes.
+  @param  AuthenticationStatus   The authentication status returned when the
+                                 file was read from its firmware volume.
+  @param  BootPolicy             The boot policy of the load request.
+  @param  ImageIsFromFv          TRUE if the file was read from a firmware
+                                 volume.
+
+  @retval EFI_SUCCESS            The image may be loaded, or no security
+                                 handler is installed.
+  @retval others                 The status returned by the security handlers.
+
+**/
+EFI_STATUS
+CoreCheckImageFileSecurity (
+  IN EFI_DEVICE_PATH_PROTOCOL  *FilePath,
+  IN VOID                      *Source,
+  IN UINTN                     SourceSize,
+  IN UINT32                    AuthenticationStatus,
+  IN BOOLEAN                   BootPolicy,
+  IN BOOLEAN                   ImageIsFromFv
+  )
+{
+  EFI_STATUS  SecurityStatus;
+
+  SecurityStatus = EFI_SUCCESS;
+  if (gSecurity2 != NULL) {
+    //
+    // Verify File Authentication through the Security2 Architectural Protocol
+    //
+    SecurityStatus = gSecurity2->FileAuthentication (
+                                   gSecurity2,
+                                   FilePath,
+                                   Source,
+                                   SourceSize,
+                                   BootPolicy
+                                   );
+    if (!EFI_ERROR (SecurityStatus) && ImageIsFromFv) {
+      //
+      // When Security2 is installed, Security Architectural Protocol must be published.
+      //
+      ASSERT (gSecurity != NULL);
+
+      //
+      // Verify the Authentication Status through the Security Architectural Protocol
+      // Only on images that have been read using Firmware Volume protocol.
+      //
+      SecurityStatus = gSecurity->FileAuthenticationState (
+                                    gSecurity,
+                                    AuthenticationStatus,
+                                    FilePath
+                                    );
+    }
+  } else if ((gSecurity != NULL) && (FilePath != NULL)) {
+    //
+    // Verify the Authentication Status through the Security Architectural Protocol
+    //
+    SecurityStatus = gSecurity->FileAuthenticationState (
+                                  gSecurity,
+                                  AuthenticationStatus,
+                                  FilePath
+                                  );
+  }
+
+  return SecurityStatus;
+}
+
 /**
   Loads an EFI image into memory and returns a handle to the image.
 
@@ -1158,6 +1272,7 @@ CoreLoadImageCommon (
   UINTN                      FilePathSize;
   BOOLEAN                    ImageIsFromFv;
   BOOLEAN                    ImageIsFromLoadFile;
+  IMAGE_PREFETCH             *Prefetch;
 
   SecurityStatus = EFI_SUCCESS;
 
@@ -1187,6 +1302,7 @@ CoreLoadImageCommon (
   AuthenticationStatus = 0;
   ImageIsFromFv        = FALSE;
   ImageIsFromLoadFile  = FALSE;
+  Prefetch             = NULL;
 
   //
   // If the caller passed a copy of the file, then just use it
@@ -1237,14 +1353,26 @@ CoreLoadImageCommon (
     }
 
     //
-    // Get the source file buffer by its device path.
+    // Get the source file buffer by its device path, unless the dispatcher
+    // already read it.
     //
-    FHand.Source = GetFileBufferByFilePath (
-                     BootPolicy,
-                     FilePath,
-                     &FHand.SourceSize,
-                     &AuthenticationStatus
-                     );
+    if (!BootPolicy) {
+      Prefetch = CoreImagePrefetchTake (FilePath);
+    }
+
+    if (Prefetch != NULL) {
+      FHand.Source           = Prefetch->FHand.Source;
+      FHand.SourceSize       = Prefetch->FHand.SourceSize;
+      AuthenticationStatus   = Prefetch->AuthenticationStatus;
+      Prefetch->FHand.Source = NULL;
+    } else {
+      FHand.Source = GetFileBufferByFilePath (
+                       BootPolicy,
+                       FilePath,
+                       &FHand.SourceSize,
+                       &AuthenticationStatus
+                       );
+    }
     if (FHand.Source == NULL) {
       Status = EFI_NOT_FOUND;
     } else {
@@ -1263,42 +1391,23 @@ CoreLoadImageCommon (
     goto Done;
   }
 
-  if (gSecurity2 != NULL) {
-    //
-    // Verify File Authentication through the Security2 Architectural Protocol
-    //
-    SecurityStatus = gSecurity2->FileAuthentication (
-                                   gSecurity2,
-                                   OriginalFilePath,
-                                   FHand.Source,
-                                   FHand.SourceSize,
-                                   BootPolicy
-                                   );
-    if (!EFI_ERROR (SecurityStatus) && ImageIsFromFv) {
-      //
-      // When Security2 is installed, Security Architectural Protocol must be published.
-      //
-      ASSERT (gSecurity != NULL);
-
-      //
-      // Verify the Authentication Status through the Security Architectural Protocol
-      // Only on images that have been read using Firmware Volume protocol.
-      //
-      SecurityStatus = gSecurity->FileAuthenticationState (
-                                    gSecurity,
-                                    AuthenticationStatus,
-                                    OriginalFilePath
-                                    );
-    }
-  } else if ((gSecurity != NULL) && (OriginalFilePath != NULL)) {
+  if ((Prefetch != NULL) && Prefetch->SecurityChecked && ImageIsFromFv &&
+      (Prefetch->Security == gSecurity) && (Prefetch->Security2 == gSecurity2))
+  {
     //
-    // Verify the Authentication Status through the Security Architectural Protocol
+    // CoreImagePrefetchLoad () ran the same security handlers on the same
+    // file before it parsed it, do not run them twice.
     //
-    SecurityStatus = gSecurity->FileAuthenticationState (
-                                  gSecurity,
-                                  AuthenticationStatus,
-                                  OriginalFilePath
-                                  );
+    SecurityStatus = Prefetch->SecurityStatus;
+  } else {
+    SecurityStatus = CoreCheckImageFileSecurity (
+                       OriginalFilePath,
+                       FHand.Source,
+                       FHand.SourceSize,
+                       AuthenticationStatus,
+                       BootPolicy,
+                       ImageIsFromFv
+                       );
   }
 
   //
@@ -1373,7 +1482,7 @@ CoreLoadImageCommon (
   //
   // Load the image.  If EntryPoint is Null, it will not be set.
   //
-  Status = CoreLoadPeImage (BootPolicy, &FHand, Image, DstBuffer, EntryPoint, Attribute);
+  Status = CoreLoadPeImage (BootPolicy, &FHand, Image, DstBuffer, EntryPoint, Attribute, Prefetch);
   if (EFI_ERROR (Status)) {
     if ((Status == EFI_BUFFER_TOO_SMALL) || (Status == EFI_OUT_OF_RESOURCES)) {
       if (NumberOfPages != NULL) {
@@ -1470,6 +1579,10 @@ Done:
     CoreFreePool (FHand.Source);
   }
 
+  if (Prefetch != NULL) {
+    CoreImagePrefetchRelease (Prefetch);
+  }
+
   if (OriginalFilePath != InputFilePath) {
     CoreFreePool (OriginalFilePath);
   }
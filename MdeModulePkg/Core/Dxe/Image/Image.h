@@ -20,4 +20,124 @@ typedef struct {
   UINTN      SourceSize;
 } IMAGE_FILE_HANDLE;
 
+//
+// An image of the scheduled queue that was read, and possibly loaded into
+// its buffer, before the dispatcher got to it
+//
+#define IMAGE_PREFETCH_SIGNATURE  SIGNATURE_32('i','m','g','p')
+typedef struct {
+  UINTN                           Signature;
+  LIST_ENTRY                      Link;
+  EFI_DEVICE_PATH_PROTOCOL        *FilePath;
+  IMAGE_FILE_HANDLE               FHand;
+  UINT32                          AuthenticationStatus;
+  //
+  // Result of the security handlers, run before the file is parsed, and the
+  // handlers that were installed then
+  //
+  BOOLEAN                         SecurityChecked;
+  EFI_STATUS                      SecurityStatus;
+  EFI_SECURITY_ARCH_PROTOCOL      *Security;
+  EFI_SECURITY2_ARCH_PROTOCOL     *Security2;
+  //
+  // TRUE if the pages of the image are allocated and its sections loaded
+  //
+  BOOLEAN                         Loaded;
+  EFI_STATUS                      LoadStatus;
+  PE_COFF_LOADER_IMAGE_CONTEXT    ImageContext;
+  EFI_PHYSICAL_ADDRESS            ImageBasePage;
+  UINTN                           NumberOfPages;
+} IMAGE_PREFETCH;
+
+/**
+  Read image file (specified by UserHandle) into user specified buffer with specified offset
+  and length.
+
+  @param  UserHandle             Image file handle
+  @param  Offset                 Offset to the source file
+  @param  ReadSize               For input, pointer of size to read; For output,
+                                 pointer of size actually read.
+  @param  Buffer                 Buffer to write into
+
+  @retval EFI_SUCCESS            Successfully read the specified part of file
+                                 into buffer.
+
+**/
+EFI_STATUS
+EFIAPI
+CoreReadImageFile (
+  IN     VOID   *UserHandle,
+  IN     UINTN  Offset,
+  IN OUT UINTN  *ReadSize,
+  OUT    VOID   *Buffer
+  );
+
+/**
+  Set the memory types of the code and data of an image from its subsystem.
+
+  @param  ImageContext           The context of the image, filled in by
+                                 PeCoffLoaderGetImageInfo ().
+
+  @retval EFI_SUCCESS            The memory types were set.
+  @retval EFI_UNSUPPORTED        The subsystem of the image is not supported.
+
+**/
+EFI_STATUS
+CoreSetImageMemoryType (
+  IN OUT PE_COFF_LOADER_IMAGE_CONTEXT  *ImageContext
+  );
+
+/**
+  Check an image file through the Security2 and the Security Architectural
+  Protocols, before the image is loaded.
+
+  @param  FilePath               The device path the image is loaded from.
+  @param  Source                 The image file.
+  @param  SourceSize             The size of Source in bytes.
+  @param  AuthenticationStatus   The authentication status returned when the
+                                 file was read from its firmware volume.
+  @param  BootPolicy             The boot policy of the load request.
+  @param  ImageIsFromFv          TRUE if the file was read from a firmware
+                                 volume.
+
+  @retval EFI_SUCCESS            The image may be loaded, or no security
+                                 handler is installed.
+  @retval others                 The status returned by the security handlers.
+
+**/
+EFI_STATUS
+CoreCheckImageFileSecurity (
+  IN EFI_DEVICE_PATH_PROTOCOL  *FilePath,
+  IN VOID                      *Source,
+  IN UINTN                     SourceSize,
+  IN UINT32                    AuthenticationStatus,
+  IN BOOLEAN                   BootPolicy,
+  IN BOOLEAN                   ImageIsFromFv
+  );
+
+/**
+  Take the prefetched copy of an image out of the prefetch list.
+
+  @param  FilePath               The device path the image is loaded from.
+
+  @return The prefetched image, or NULL if the image was not prefetched.
+
+**/
+IMAGE_PREFETCH *
+CoreImagePrefetchTake (
+  IN EFI_DEVICE_PATH_PROTOCOL  *FilePath
+  );
+
+/**
+  Free a prefetched image, along with its pages if they were not handed over
+  to the loaded image.
+
+  @param  Prefetch               The prefetched image.
+
+**/
+VOID
+CoreImagePrefetchRelease (
+  IN IMAGE_PREFETCH  *Prefetch
+  );
+
 #endif
@@ -0,0 +1,476 @@
+/** @file
+  Load the images of the scheduled DXE drivers on all the processors.
+
+  Before the dispatcher drains its scheduled queue, the BSP reads the image of
+  every scheduled driver from its firmware volume, runs the security handlers
+  on it, and allocates the pages it will be loaded into. The BSP and the APs
+  then copy the sections of those images into their pages, in parallel,
+  through the MP Services protocol.
+
+  An image is only parsed once the security handlers let it load, and the
+  same handlers are not run again by CoreLoadImageCommon (). If the security
+  architectural protocols changed in between, CoreLoadImageCommon () runs them
+  again. The image is still relocated and protected in dispatch order on the
+  BSP. Only the images that CoreLoadPeImage () would load at any address are
+  loaded ahead, the other ones only have their file read.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeMain.h"
+#include "Image.h"
+
+//
+// Work shared by the processors running CoreImagePrefetchWorker ()
+//
+typedef struct {
+  IMAGE_PREFETCH     **Images;
+  UINT32             Count;
+  volatile UINT32    Next;
+} IMAGE_PREFETCH_WORK;
+
+//
+// Images waiting for CoreLoadImageCommon (), list of IMAGE_PREFETCH
+//
+STATIC LIST_ENTRY  mImagePrefetchList = INITIALIZE_LIST_HEAD_VARIABLE (mImagePrefetchList);
+
+STATIC EFI_MP_SERVICES_PROTOCOL  *mMpServices = NULL;
+
+/**
+  Find an image in the prefetch list.
+
+  @param  FilePath               The device path the image is loaded from.
+
+  @return The prefetched image, or NULL if there is none.
+
+**/
+STATIC
+IMAGE_PREFETCH *
+CoreImagePrefetchFind (
+  IN EFI_DEVICE_PATH_PROTOCOL  *FilePath
+  )
+{
+  LIST_ENTRY      *Link;
+  IMAGE_PREFETCH  *Prefetch;
+
+  for (Link = mImagePrefetchList.ForwardLink; Link != &mImagePrefetchList; Link = Link->ForwardLink) {
+    Prefetch = CR (Link, IMAGE_PREFETCH, Link, IMAGE_PREFETCH_SIGNATURE);
+    if (Prefetch->FilePath == FilePath) {
+      return Prefetch;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Free a prefetched image, along with its pages if they were not handed over
+  to the loaded image.
+
+  @param  Prefetch               The prefetched image.
+
+**/
+VOID
+CoreImagePrefetchRelease (
+  IN IMAGE_PREFETCH  *Prefetch
+  )
+{
+  ASSERT (Prefetch->Signature == IMAGE_PREFETCH_SIGNATURE);
+
+  if (Prefetch->Loaded) {
+    CoreFreePages (Prefetch->ImageBasePage, Prefetch->NumberOfPages);
+  }
+
+  if (Prefetch->FHand.FreeBuffer && (Prefetch->FHand.Source != NULL)) {
+    CoreFreePool (Prefetch->FHand.Source);
+  }
+
+  CoreFreePool (Prefetch);
+}
+
+/**
+  Free all the images of the prefetch list.
+
+**/
+STATIC
+VOID
+CoreImagePrefetchFlush (
+  VOID
+  )
+{
+  IMAGE_PREFETCH  *Prefetch;
+
+  while (!IsListEmpty (&mImagePrefetchList)) {
+    Prefetch = CR (mImagePrefetchList.ForwardLink, IMAGE_PREFETCH, Link, IMAGE_PREFETCH_SIGNATURE);
+    RemoveEntryList (&Prefetch->Link);
+    CoreImagePrefetchRelease (Prefetch);
+  }
+}
+
+/**
+  Read the file of an image, run the security handlers on it and, if they let
+  it load and CoreLoadPeImage () would load it at any address, allocate the
+  pages to load it into.
+
+  @param  Prefetch               The image to read.
+
+  @retval TRUE                   The pages of the image are allocated, its
+                                 sections have to be loaded.
+  @retval FALSE                  The image is not loaded ahead. Its file was
+                                 read if Prefetch->FHand.Source is not NULL.
+
+**/
+STATIC
+BOOLEAN
+CoreImagePrefetchRead (
+  IN OUT IMAGE_PREFETCH  *Prefetch
+  )
+{
+  EFI_STATUS                    Status;
+  PE_COFF_LOADER_IMAGE_CONTEXT  *ImageContext;
+  UINTN                         Size;
+
+  Prefetch->FHand.Source = GetFileBufferByFilePath (
+                             FALSE,
+                             Prefetch->FilePath,
+                             &Prefetch->FHand.SourceSize,
+                             &Prefetch->AuthenticationStatus
+                             );
+  if (Prefetch->FHand.Source == NULL) {
+    return FALSE;
+  }
+
+  Prefetch->FHand.Signature  = IMAGE_FILE_HANDLE_SIGNATURE;
+  Prefetch->FHand.FreeBuffer = TRUE;
+
+  //
+  // Do not parse a file that no security handler has checked yet, the
+  // architectural protocols may be installed by a driver of this dispatch.
+  //
+  if ((gSecurity == NULL) && (gSecurity2 == NULL)) {
+    return FALSE;
+  }
+
+  Prefetch->Security        = gSecurity;
+  Prefetch->Security2       = gSecurity2;
+  Prefetch->SecurityStatus  = CoreCheckImageFileSecurity (
+                                Prefetch->FilePath,
+                                Prefetch->FHand.Source,
+                                Prefetch->FHand.SourceSize,
+                                Prefetch->AuthenticationStatus,
+                                FALSE,
+                                TRUE
+                                );
+  Prefetch->SecurityChecked = TRUE;
+  if (EFI_ERROR (Prefetch->SecurityStatus)) {
+    return FALSE;
+  }
+
+  ImageContext            = &Prefetch->ImageContext;
+  ImageContext->Handle    = &Prefetch->FHand;
+  ImageContext->ImageRead = (PE_COFF_LOADER_READ_FILE)CoreReadImageFile;
+
+  Status = PeCoffLoaderGetImageInfo (ImageContext);
+  if (EFI_ERROR (Status) || !EFI_IMAGE_MACHINE_TYPE_SUPPORTED (ImageContext->Machine)) {
+    return FALSE;
+  }
+
+  //
+  // Leave the images loaded at a given address to CoreLoadPeImage ()
+  //
+  if ((PcdGet64 (PcdLoadModuleAtFixAddressEnable) != 0) ||
+      ImageContext->RelocationsStripped ||
+      (PcdGetBool (PcdImageLargeAddressLoad) && (ImageContext->ImageAddress >= 0x100000)))
+  {
+    return FALSE;
+  }
+
+  Status = CoreSetImageMemoryType (ImageContext);
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  if (ImageContext->SectionAlignment > EFI_PAGE_SIZE) {
+    Size = (UINTN)ImageContext->ImageSize + ImageContext->SectionAlignment;
+  } else {
+    Size = (UINTN)ImageContext->ImageSize;
+  }
+
+  Prefetch->NumberOfPages = EFI_SIZE_TO_PAGES (Size);
+  Status                  = CoreAllocatePages (
+                              AllocateAnyPages,
+                              (EFI_MEMORY_TYPE)(ImageContext->ImageCodeMemoryType),
+                              Prefetch->NumberOfPages,
+                              &ImageContext->ImageAddress
+                              );
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  Prefetch->ImageBasePage = ImageContext->ImageAddress;
+  if (!ImageContext->IsTeImage) {
+    ImageContext->ImageAddress =
+      (ImageContext->ImageAddress + ImageContext->SectionAlignment - 1) &
+      ~((UINTN)ImageContext->SectionAlignment - 1);
+  }
+
+  Prefetch->Loaded = TRUE;
+  return TRUE;
+}
+
+/**
+  Load the sections of the prefetched images into their pages, until there is
+  no image left.
+
+  This function runs on the BSP and the APs, it must not use any boot service.
+
+  @param  Buffer                 The IMAGE_PREFETCH_WORK shared by the
+                                 processors.
+
+**/
+STATIC
+VOID
+EFIAPI
+CoreImagePrefetchWorker (
+  IN OUT VOID  *Buffer
+  )
+{
+  IMAGE_PREFETCH_WORK  *Work;
+  IMAGE_PREFETCH       *Prefetch;
+  UINT32               Index;
+
+  Work = (IMAGE_PREFETCH_WORK *)Buffer;
+  for ( ; ;) {
+    Index = InterlockedIncrement (&Work->Next) - 1;
+    if (Index >= Work->Count) {
+      break;
+    }
+
+    Prefetch             = Work->Images[Index];
+    Prefetch->LoadStatus = PeCoffLoaderLoadImage (&Prefetch->ImageContext);
+  }
+}
+
+/**
+  Add an image to the images that the next CoreImagePrefetchLoad () reads and
+  loads.
+
+  @param  FilePath               The device path of the image. It must remain
+                                 valid until the image is loaded.
+
+**/
+VOID
+CoreImagePrefetchAdd (
+  IN EFI_DEVICE_PATH_PROTOCOL  *FilePath
+  )
+{
+  IMAGE_PREFETCH  *Prefetch;
+
+  if (!FeaturePcdGet (PcdDxeImagePrefetchEnable)) {
+    return;
+  }
+
+  Prefetch = CoreImagePrefetchFind (FilePath);
+  if (Prefetch != NULL) {
+    if (Prefetch->FHand.Source == NULL) {
+      return;
+    }
+
+    //
+    // Read for a previous dispatch that did not load it, read it again
+    //
+    RemoveEntryList (&Prefetch->Link);
+    CoreImagePrefetchRelease (Prefetch);
+  }
+
+  Prefetch = AllocateZeroPool (sizeof (IMAGE_PREFETCH));
+  if (Prefetch == NULL) {
+    return;
+  }
+
+  Prefetch->Signature = IMAGE_PREFETCH_SIGNATURE;
+  Prefetch->FilePath  = FilePath;
+  InsertTailList (&mImagePrefetchList, &Prefetch->Link);
+}
+
+/**
+  Read the images added by CoreImagePrefetchAdd (), and load the sections of
+  those that can be loaded ahead on all the enabled processors.
+
+  Nothing is prefetched unless the MP Services protocol is installed and at
+  least one AP is enabled.
+
+**/
+VOID
+CoreImagePrefetchLoad (
+  VOID
+  )
+{
+  EFI_STATUS           Status;
+  LIST_ENTRY           *Link;
+  IMAGE_PREFETCH       *Prefetch;
+  IMAGE_PREFETCH_WORK  Work;
+  EFI_EVENT            Event;
+  UINTN                ImageCount;
+  UINTN                ProcessorCount;
+  UINTN                EnabledProcessorCount;
+  UINT32               Index;
+
+  if (!FeaturePcdGet (PcdDxeImagePrefetchEnable)) {
+    return;
+  }
+
+  //
+  // Drop the images that were not picked up by the previous dispatch, and
+  // those that are to be read now if there is no AP to help.
+  //
+  ImageCount            = 0;
+  EnabledProcessorCount = 1;
+  if (mMpServices == NULL) {
+    CoreLocateProtocol (&gEfiMpServiceProtocolGuid, NULL, (VOID **)&mMpServices);
+  }
+
+  if (mMpServices != NULL) {
+    Status = mMpServices->GetNumberOfProcessors (mMpServices, &ProcessorCount, &EnabledProcessorCount);
+    if (EFI_ERROR (Status)) {
+      EnabledProcessorCount = 1;
+    }
+  }
+
+  for (Link = mImagePrefetchList.ForwardLink; Link != &mImagePrefetchList; ) {
+    Prefetch = CR (Link, IMAGE_PREFETCH, Link, IMAGE_PREFETCH_SIGNATURE);
+    Link     = Link->ForwardLink;
+    if ((Prefetch->FHand.Source != NULL) || (EnabledProcessorCount < 2)) {
+      RemoveEntryList (&Prefetch->Link);
+      CoreImagePrefetchRelease (Prefetch);
+    } else {
+      ImageCount++;
+    }
+  }
+
+  if (ImageCount < 2) {
+    //
+    // Not worth it, let CoreLoadImageCommon () read the file
+    //
+    CoreImagePrefetchFlush ();
+    return;
+  }
+
+  Work.Images = AllocatePool (ImageCount * sizeof (IMAGE_PREFETCH *));
+  if (Work.Images == NULL) {
+    CoreImagePrefetchFlush ();
+    return;
+  }
+
+  PERF_INMODULE_BEGIN ("DxeImagePrefetch");
+
+  //
+  // Read the files and allocate the pages on the BSP
+  //
+  Work.Count = 0;
+  Work.Next  = 0;
+  for (Link = mImagePrefetchList.ForwardLink; Link != &mImagePrefetchList; ) {
+    Prefetch = CR (Link, IMAGE_PREFETCH, Link, IMAGE_PREFETCH_SIGNATURE);
+    Link     = Link->ForwardLink;
+    if (CoreImagePrefetchRead (Prefetch)) {
+      Work.Images[Work.Count++] = Prefetch;
+    } else if (Prefetch->FHand.Source == NULL) {
+      RemoveEntryList (&Prefetch->Link);
+      CoreImagePrefetchRelease (Prefetch);
+    }
+  }
+
+  //
+  // Load the sections on the BSP and the APs. The APs are started in
+  // non-blocking mode so that the BSP takes images too, and the MP Services
+  // protocol only checks for their completion in a timer event, so they only
+  // help up to TPL_CALLBACK. The BSP loads everything if they are not started.
+  //
+  if (Work.Count != 0) {
+    Event  = NULL;
+    Status = EFI_UNSUPPORTED;
+    if (gEfiCurrentTpl <= TPL_CALLBACK) {
+      Status = CoreCreateEvent (0, TPL_CALLBACK, NULL, NULL, &Event);
+      if (!EFI_ERROR (Status)) {
+        Status = mMpServices->StartupAllAPs (
+                                mMpServices,
+                                CoreImagePrefetchWorker,
+                                FALSE,
+                                Event,
+                                0,
+                                &Work,
+                                NULL
+                                );
+      }
+    }
+
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_WARN, "Image prefetch: APs not started - %r\n", Status));
+    }
+
+    CoreImagePrefetchWorker (&Work);
+
+    if (!EFI_ERROR (Status)) {
+      while (CoreCheckEvent (Event) == EFI_NOT_READY) {
+        CpuPause ();
+      }
+    }
+
+    if (Event != NULL) {
+      CoreCloseEvent (Event);
+    }
+  }
+
+  for (Index = 0; Index < Work.Count; Index++) {
+    Prefetch = Work.Images[Index];
+    if (EFI_ERROR (Prefetch->LoadStatus)) {
+      //
+      // CoreLoadPeImage () loads it again, and reports the error
+      //
+      CoreFreePages (Prefetch->ImageBasePage, Prefetch->NumberOfPages);
+      Prefetch->Loaded = FALSE;
+    }
+  }
+
+  PERF_INMODULE_END ("DxeImagePrefetch");
+
+  DEBUG ((
+    DEBUG_INFO,
+    "Image prefetch: %Lu images, %Lu loaded ahead on %Lu processors\n",
+    (UINT64)ImageCount,
+    (UINT64)Work.Count,
+    (UINT64)EnabledProcessorCount
+    ));
+
+  CoreFreePool (Work.Images);
+}
+
+/**
+  Take the prefetched copy of an image out of the prefetch list.
+
+  @param  FilePath               The device path the image is loaded from.
+
+  @return The prefetched image, or NULL if the image was not prefetched.
+
+**/
+IMAGE_PREFETCH *
+CoreImagePrefetchTake (
+  IN EFI_DEVICE_PATH_PROTOCOL  *FilePath
+  )
+{
+  IMAGE_PREFETCH  *Prefetch;
+
+  if (!FeaturePcdGet (PcdDxeImagePrefetchEnable)) {
+    return NULL;
+  }
+
+  Prefetch = CoreImagePrefetchFind (FilePath);
+  if ((Prefetch == NULL) || (Prefetch->FHand.Source == NULL)) {
+    return NULL;
+  }
+
+  RemoveEntryList (&Prefetch->Link);
+  return Prefetch;
+}
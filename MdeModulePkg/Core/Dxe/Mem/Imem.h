@@ -14,17 +14,28 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 //
 
 #define MEMORY_MAP_SIGNATURE  SIGNATURE_32('m','m','a','p')
-typedef struct {
-  UINTN              Signature;
-  LIST_ENTRY         Link;
-  BOOLEAN            FromPages;
-
-  EFI_MEMORY_TYPE    Type;
-  UINT64             Start;
-  UINT64             End;
-
-  UINT64             VirtualStart;
-  UINT64             Attribute;
+typedef struct _MEMORY_MAP {
+  UINTN                 Signature;
+  LIST_ENTRY            Link;
+  BOOLEAN               FromPages;
+
+  EFI_MEMORY_TYPE       Type;
+  UINT64                Start;
+  UINT64                End;
+
+  UINT64                VirtualStart;
+  UINT64                Attribute;
+
+  //
+  // Node of the address ordered AVL tree that indexes gMemoryMap.
+  // MaxFreeBytes is the size of the largest allocatable free entry
+  // in the subtree rooted at this node.
+  //
+  struct _MEMORY_MAP    *Parent;
+  struct _MEMORY_MAP    *Left;
+  struct _MEMORY_MAP    *Right;
+  UINTN                 Height;
+  UINT64                MaxFreeBytes;
 } MEMORY_MAP;
 
 //
@@ -64,6 +75,25 @@ CoreFreePoolPages (
   IN UINTN                 NumberOfPages
   );
 
+/**
+  Internal function.  Used by the pool functions to accept unaccepted memory
+  when CoreAllocatePoolPages () could not find free pages to grow the pool.
+
+  The caller must hold neither the pool lock nor the memory lock.
+
+  @param  NumberOfPages          The number of pages the pool needs
+  @param  Alignment              Bits to align.
+
+  @retval TRUE                   Memory was accepted and added to the memory map.
+  @retval FALSE                  No memory was accepted.
+
+**/
+BOOLEAN
+CoreAcceptPoolPages (
+  IN UINTN  NumberOfPages,
+  IN UINTN  Alignment
+  );
+
 /**
   Internal function to allocate pool of a particular type.
   Caller must have the memory lock held
@@ -117,6 +147,100 @@ CoreReleaseMemoryLock (
   VOID
   );
 
+//
+// Locks of the memory services whose hold time is measured
+//
+typedef enum {
+  MemoryTelemetryPoolLock,
+  MemoryTelemetryPageLock,
+  MemoryTelemetryLockMax
+} MEMORY_TELEMETRY_LOCK_ID;
+
+/**
+  Account a pool allocation. Called with the pool lock held.
+
+  @param  MemoryType             The memory type of the allocation.
+  @param  Size                   The size of the pool block, including the
+                                 pool head and tail.
+  @param  PageFallback           TRUE if the page allocator was called to
+                                 serve the allocation.
+  @param  Success                FALSE if the allocation failed.
+
+**/
+VOID
+CoreTelemetryPoolAllocate (
+  IN EFI_MEMORY_TYPE  MemoryType,
+  IN UINTN            Size,
+  IN BOOLEAN          PageFallback,
+  IN BOOLEAN          Success
+  );
+
+/**
+  Account a pool free. Called with the pool lock held.
+
+  @param  MemoryType             The memory type of the pool block.
+  @param  Size                   The size of the pool block, including the
+                                 pool head and tail.
+
+**/
+VOID
+CoreTelemetryPoolFree (
+  IN EFI_MEMORY_TYPE  MemoryType,
+  IN UINTN            Size
+  );
+
+/**
+  Account a page allocation. Called with gMemoryLock held.
+
+  @param  MemoryType             The memory type of the allocation.
+  @param  NumberOfPages          The number of pages allocated.
+  @param  Success                FALSE if the allocation failed.
+
+**/
+VOID
+CoreTelemetryPageAllocate (
+  IN EFI_MEMORY_TYPE  MemoryType,
+  IN UINTN            NumberOfPages,
+  IN BOOLEAN          Success
+  );
+
+/**
+  Account a page free. Called with gMemoryLock held.
+
+  @param  MemoryType             The memory type of the pages.
+  @param  NumberOfPages          The number of pages freed.
+
+**/
+VOID
+CoreTelemetryPageFree (
+  IN EFI_MEMORY_TYPE  MemoryType,
+  IN UINTN            NumberOfPages
+  );
+
+/**
+  Account the acquisition of a lock of the memory services. Called right
+  after the lock was acquired.
+
+  @param  Lock                   The lock.
+
+**/
+VOID
+CoreTelemetryLockAcquired (
+  IN MEMORY_TELEMETRY_LOCK_ID  Lock
+  );
+
+/**
+  Account the hold time of a lock of the memory services. Called right
+  before the lock is released.
+
+  @param  Lock                   The lock.
+
+**/
+VOID
+CoreTelemetryLockReleased (
+  IN MEMORY_TELEMETRY_LOCK_ID  Lock
+  );
+
 /**
   Allocates pages from the memory map.
 
@@ -146,6 +270,84 @@ CoreInternalAllocatePages (
   IN BOOLEAN                   NeedGuard
   );
 
+/**
+  Internal function.  Adds a memory map entry to the memory map index.
+  Caller must have the memory lock held
+
+  @param  Entry                  The entry to add. It must not overlap any
+                                 entry already in the index.
+
+**/
+VOID
+CoreMemoryMapIndexInsert (
+  IN OUT MEMORY_MAP  *Entry
+  );
+
+/**
+  Internal function.  Removes a memory map entry from the memory map index.
+  Caller must have the memory lock held
+
+  @param  Entry                  The entry to remove
+
+**/
+VOID
+CoreMemoryMapIndexRemove (
+  IN OUT MEMORY_MAP  *Entry
+  );
+
+/**
+  Internal function.  Refreshes the index after the range, type or attribute
+  of an entry was changed without moving it past any of its neighbors.
+  Caller must have the memory lock held
+
+  @param  Entry                  The entry that was changed
+
+**/
+VOID
+CoreMemoryMapIndexUpdate (
+  IN OUT MEMORY_MAP  *Entry
+  );
+
+/**
+  Internal function.  Finds the memory map entry that covers an address.
+  Caller must have the memory lock held
+
+  @param  Address                The address to look up
+
+  @return The entry that covers Address, or NULL if there is none.
+
+**/
+MEMORY_MAP *
+CoreMemoryMapIndexLookup (
+  IN UINT64  Address
+  );
+
+/**
+  Internal function.  Gets the memory map entry with the next higher address.
+  Caller must have the memory lock held
+
+  @param  Entry                  The entry to start from
+
+  @return The next entry, or NULL if Entry is the highest one.
+
+**/
+MEMORY_MAP *
+CoreMemoryMapIndexNext (
+  IN MEMORY_MAP  *Entry
+  );
+
+/**
+  Internal function.  Gets the root of the memory map index.
+  Caller must have the memory lock held
+
+  @return The root entry, or NULL if the memory map is empty.
+
+**/
+MEMORY_MAP *
+CoreMemoryMapIndexRoot (
+  VOID
+  );
+
 //
 // Internal Global data
 //
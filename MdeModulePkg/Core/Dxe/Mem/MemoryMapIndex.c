@@ -0,0 +1,432 @@
+/** @file
+  Address ordered index of the UEFI memory map.
+
+  gMemoryMap keeps the memory map descriptors in the order they are reported
+  by GetMemoryMap (). This file maintains an AVL tree of the same descriptors
+  keyed by start address, so that the descriptor covering an address and the
+  neighbors of a range are found in O(log n).
+
+  Each node is also augmented with the size of the largest allocatable free
+  descriptor in its subtree, which lets the page allocator skip subtrees that
+  cannot satisfy a request.
+
+  The tree is intrusive: its links live in MEMORY_MAP, so maintaining it never
+  allocates memory. That is required because all of these functions run with
+  gMemoryLock held, while the memory map itself is being changed.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeMain.h"
+#include "Imem.h"
+
+STATIC MEMORY_MAP  *mMemoryMapRoot = NULL;
+
+/**
+  Get the height of a subtree.
+
+  @param  Node                   The root of the subtree, or NULL.
+
+  @return The height of the subtree.
+
+**/
+STATIC
+UINTN
+NodeHeight (
+  IN MEMORY_MAP  *Node
+  )
+{
+  return (Node == NULL) ? 0 : Node->Height;
+}
+
+/**
+  Get the size of the largest allocatable free entry in a subtree.
+
+  @param  Node                   The root of the subtree, or NULL.
+
+  @return The size in bytes.
+
+**/
+STATIC
+UINT64
+NodeMaxFreeBytes (
+  IN MEMORY_MAP  *Node
+  )
+{
+  return (Node == NULL) ? 0 : Node->MaxFreeBytes;
+}
+
+/**
+  Get the number of bytes of an entry that CoreFindFreePagesI () may allocate.
+
+  @param  Entry                  The memory map entry.
+
+  @return The size of the entry if it is free, non Special-Purpose memory.
+          0 otherwise.
+
+**/
+STATIC
+UINT64
+EntryFreeBytes (
+  IN MEMORY_MAP  *Entry
+  )
+{
+  if ((Entry->Type != EfiConventionalMemory) ||
+      ((Entry->Attribute & EFI_MEMORY_SP) != 0) ||
+      (Entry->End < Entry->Start))
+  {
+    return 0;
+  }
+
+  return Entry->End - Entry->Start + 1;
+}
+
+/**
+  Recompute the height and the free size of a node from its children.
+
+  @param  Node                   The node to refresh.
+
+**/
+STATIC
+VOID
+RefreshNode (
+  IN OUT MEMORY_MAP  *Node
+  )
+{
+  Node->Height       = MAX (NodeHeight (Node->Left), NodeHeight (Node->Right)) + 1;
+  Node->MaxFreeBytes = MAX (
+                         EntryFreeBytes (Node),
+                         MAX (NodeMaxFreeBytes (Node->Left), NodeMaxFreeBytes (Node->Right))
+                         );
+}
+
+/**
+  Make a node take the place of another one under the parent of the latter.
+
+  @param  Parent                 The parent of OldNode, or NULL if OldNode is
+                                 the root.
+  @param  OldNode                The node to be replaced.
+  @param  NewNode                The node to put in place, or NULL.
+
+**/
+STATIC
+VOID
+ReplaceChild (
+  IN OUT MEMORY_MAP  *Parent,
+  IN     MEMORY_MAP  *OldNode,
+  IN OUT MEMORY_MAP  *NewNode
+  )
+{
+  if (Parent == NULL) {
+    mMemoryMapRoot = NewNode;
+  } else if (Parent->Left == OldNode) {
+    Parent->Left = NewNode;
+  } else {
+    ASSERT (Parent->Right == OldNode);
+    Parent->Right = NewNode;
+  }
+
+  if (NewNode != NULL) {
+    NewNode->Parent = Parent;
+  }
+}
+
+/**
+  Rotate a subtree to the left.
+
+  @param  Node                   The root of the subtree. Its right child must
+                                 not be NULL.
+
+  @return The new root of the subtree.
+
+**/
+STATIC
+MEMORY_MAP *
+RotateLeft (
+  IN OUT MEMORY_MAP  *Node
+  )
+{
+  MEMORY_MAP  *Pivot;
+
+  Pivot       = Node->Right;
+  Node->Right = Pivot->Left;
+  if (Pivot->Left != NULL) {
+    Pivot->Left->Parent = Node;
+  }
+
+  ReplaceChild (Node->Parent, Node, Pivot);
+  Pivot->Left  = Node;
+  Node->Parent = Pivot;
+
+  RefreshNode (Node);
+  RefreshNode (Pivot);
+  return Pivot;
+}
+
+/**
+  Rotate a subtree to the right.
+
+  @param  Node                   The root of the subtree. Its left child must
+                                 not be NULL.
+
+  @return The new root of the subtree.
+
+**/
+STATIC
+MEMORY_MAP *
+RotateRight (
+  IN OUT MEMORY_MAP  *Node
+  )
+{
+  MEMORY_MAP  *Pivot;
+
+  Pivot      = Node->Left;
+  Node->Left = Pivot->Right;
+  if (Pivot->Right != NULL) {
+    Pivot->Right->Parent = Node;
+  }
+
+  ReplaceChild (Node->Parent, Node, Pivot);
+  Pivot->Right = Node;
+  Node->Parent = Pivot;
+
+  RefreshNode (Node);
+  RefreshNode (Pivot);
+  return Pivot;
+}
+
+/**
+  Refresh and rebalance every node from a node up to the root.
+
+  @param  Node                   The lowest node whose subtree changed, or NULL.
+
+**/
+STATIC
+VOID
+RebalanceToRoot (
+  IN OUT MEMORY_MAP  *Node
+  )
+{
+  INTN  Balance;
+
+  while (Node != NULL) {
+    RefreshNode (Node);
+    Balance = (INTN)NodeHeight (Node->Left) - (INTN)NodeHeight (Node->Right);
+
+    if (Balance > 1) {
+      if (NodeHeight (Node->Left->Left) < NodeHeight (Node->Left->Right)) {
+        RotateLeft (Node->Left);
+      }
+
+      Node = RotateRight (Node);
+    } else if (Balance < -1) {
+      if (NodeHeight (Node->Right->Right) < NodeHeight (Node->Right->Left)) {
+        RotateRight (Node->Right);
+      }
+
+      Node = RotateLeft (Node);
+    }
+
+    Node = Node->Parent;
+  }
+}
+
+/**
+  Internal function.  Adds a memory map entry to the memory map index.
+  Caller must have the memory lock held
+
+  @param  Entry                  The entry to add. It must not overlap any
+                                 entry already in the index.
+
+**/
+VOID
+CoreMemoryMapIndexInsert (
+  IN OUT MEMORY_MAP  *Entry
+  )
+{
+  MEMORY_MAP  *Parent;
+  MEMORY_MAP  *Node;
+
+  ASSERT_LOCKED (&gMemoryLock);
+
+  Parent = NULL;
+  Node   = mMemoryMapRoot;
+  while (Node != NULL) {
+    ASSERT ((Entry->End < Node->Start) || (Entry->Start > Node->End));
+    Parent = Node;
+    Node   = (Entry->Start < Node->Start) ? Node->Left : Node->Right;
+  }
+
+  Entry->Left   = NULL;
+  Entry->Right  = NULL;
+  Entry->Parent = Parent;
+  if (Parent == NULL) {
+    mMemoryMapRoot = Entry;
+  } else if (Entry->Start < Parent->Start) {
+    Parent->Left = Entry;
+  } else {
+    Parent->Right = Entry;
+  }
+
+  RebalanceToRoot (Entry);
+}
+
+/**
+  Internal function.  Removes a memory map entry from the memory map index.
+  Caller must have the memory lock held
+
+  @param  Entry                  The entry to remove
+
+**/
+VOID
+CoreMemoryMapIndexRemove (
+  IN OUT MEMORY_MAP  *Entry
+  )
+{
+  MEMORY_MAP  *Successor;
+  MEMORY_MAP  *Lowest;
+
+  ASSERT_LOCKED (&gMemoryLock);
+  ASSERT ((Entry->Parent != NULL) || (mMemoryMapRoot == Entry));
+
+  if ((Entry->Left != NULL) && (Entry->Right != NULL)) {
+    //
+    // Put the leftmost node of the right subtree in place of Entry
+    //
+    Successor = Entry->Right;
+    while (Successor->Left != NULL) {
+      Successor = Successor->Left;
+    }
+
+    if (Successor->Parent == Entry) {
+      Lowest = Successor;
+    } else {
+      Lowest = Successor->Parent;
+      ReplaceChild (Successor->Parent, Successor, Successor->Right);
+      Successor->Right     = Entry->Right;
+      Entry->Right->Parent = Successor;
+    }
+
+    Successor->Left     = Entry->Left;
+    Entry->Left->Parent = Successor;
+    ReplaceChild (Entry->Parent, Entry, Successor);
+  } else {
+    Lowest = Entry->Parent;
+    ReplaceChild (Entry->Parent, Entry, (Entry->Left != NULL) ? Entry->Left : Entry->Right);
+  }
+
+  Entry->Parent = NULL;
+  Entry->Left   = NULL;
+  Entry->Right  = NULL;
+
+  RebalanceToRoot (Lowest);
+}
+
+/**
+  Internal function.  Refreshes the index after the range, type or attribute
+  of an entry was changed without moving it past any of its neighbors.
+  Caller must have the memory lock held
+
+  @param  Entry                  The entry that was changed
+
+**/
+VOID
+CoreMemoryMapIndexUpdate (
+  IN OUT MEMORY_MAP  *Entry
+  )
+{
+  MEMORY_MAP  *Node;
+
+  ASSERT_LOCKED (&gMemoryLock);
+
+  //
+  // The shape of the tree does not change, only the free sizes on the path
+  // to the root have to be recomputed.
+  //
+  for (Node = Entry; Node != NULL; Node = Node->Parent) {
+    RefreshNode (Node);
+  }
+}
+
+/**
+  Internal function.  Finds the memory map entry that covers an address.
+  Caller must have the memory lock held
+
+  @param  Address                The address to look up
+
+  @return The entry that covers Address, or NULL if there is none.
+
+**/
+MEMORY_MAP *
+CoreMemoryMapIndexLookup (
+  IN UINT64  Address
+  )
+{
+  MEMORY_MAP  *Node;
+
+  ASSERT_LOCKED (&gMemoryLock);
+
+  Node = mMemoryMapRoot;
+  while (Node != NULL) {
+    if (Address < Node->Start) {
+      Node = Node->Left;
+    } else if (Address > Node->End) {
+      Node = Node->Right;
+    } else {
+      return Node;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Internal function.  Gets the memory map entry with the next higher address.
+  Caller must have the memory lock held
+
+  @param  Entry                  The entry to start from
+
+  @return The next entry, or NULL if Entry is the highest one.
+
+**/
+MEMORY_MAP *
+CoreMemoryMapIndexNext (
+  IN MEMORY_MAP  *Entry
+  )
+{
+  MEMORY_MAP  *Node;
+
+  if (Entry->Right != NULL) {
+    Node = Entry->Right;
+    while (Node->Left != NULL) {
+      Node = Node->Left;
+    }
+
+    return Node;
+  }
+
+  for (Node = Entry; Node->Parent != NULL; Node = Node->Parent) {
+    if (Node->Parent->Left == Node) {
+      return Node->Parent;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Internal function.  Gets the root of the memory map index.
+  Caller must have the memory lock held
+
+  @return The root entry, or NULL if the memory map is empty.
+
+**/
+MEMORY_MAP *
+CoreMemoryMapIndexRoot (
+  VOID
+  )
+{
+  return mMemoryMapRoot;
+}
@@ -0,0 +1,384 @@
+/** @file
+  Always-on counters of the pool and page services, reported through the
+  Memory Telemetry protocol.
+
+  The pool counters are updated with the pool lock held, and the page counters
+  and lock hold times with the lock they describe held, so plain additions are
+  enough. Both locks are TPL_NOTIFY locks, so raising the TPL to TPL_NOTIFY is
+  enough to take a consistent snapshot.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeMain.h"
+#include "Imem.h"
+
+//
+// Pool block size classes: class 0 holds the blocks up to
+// 1 << MEMORY_TELEMETRY_POOL_MIN_SHIFT bytes, every following class doubles
+// the size, and the last class holds all the larger blocks.
+//
+#define MEMORY_TELEMETRY_POOL_MIN_SHIFT    6
+#define MEMORY_TELEMETRY_POOL_CLASS_COUNT  16
+
+//
+// The last memory type record accumulates the OEM and OS reserved types
+//
+#define MEMORY_TELEMETRY_TYPE_COUNT  (EfiMaxMemoryType + 1)
+
+typedef struct {
+  EDKII_MEMORY_TELEMETRY_LOCK    Counters;
+  //
+  // Timer value when the lock was acquired, or 0 if it was not measured
+  //
+  UINT64                         StartTicks;
+} MEMORY_TELEMETRY_LOCK_STATE;
+
+STATIC EDKII_MEMORY_TELEMETRY_TYPE        mTelemetryType[MEMORY_TELEMETRY_TYPE_COUNT];
+STATIC EDKII_MEMORY_TELEMETRY_POOL_CLASS  mTelemetryPoolClass[MEMORY_TELEMETRY_POOL_CLASS_COUNT];
+STATIC MEMORY_TELEMETRY_LOCK_STATE        mTelemetryLock[MemoryTelemetryLockMax];
+STATIC UINT64                             mTelemetryTimerPeriod;
+
+EDKII_MEMORY_TELEMETRY_PROTOCOL  gMemoryTelemetry = {
+  CoreGetMemoryTelemetry,
+  CoreResetMemoryTelemetry
+};
+
+/**
+  Get the telemetry record of a memory type.
+
+  @param  MemoryType             The memory type.
+
+  @return The record of the memory type.
+
+**/
+STATIC
+EDKII_MEMORY_TELEMETRY_TYPE *
+TelemetryGetType (
+  IN EFI_MEMORY_TYPE  MemoryType
+  )
+{
+  if ((UINT32)MemoryType < EfiMaxMemoryType) {
+    return &mTelemetryType[MemoryType];
+  }
+
+  return &mTelemetryType[MEMORY_TELEMETRY_TYPE_COUNT - 1];
+}
+
+/**
+  Get the telemetry record of a pool block size.
+
+  @param  Size                   The size of the pool block, including the
+                                 pool head and tail.
+
+  @return The record of the size class of the block.
+
+**/
+STATIC
+EDKII_MEMORY_TELEMETRY_POOL_CLASS *
+TelemetryGetPoolClass (
+  IN UINTN  Size
+  )
+{
+  UINTN  Index;
+
+  if (Size <= (1U << MEMORY_TELEMETRY_POOL_MIN_SHIFT)) {
+    return &mTelemetryPoolClass[0];
+  }
+
+  Index = (UINTN)HighBitSet64 ((UINT64)Size - 1) + 1 - MEMORY_TELEMETRY_POOL_MIN_SHIFT;
+  return &mTelemetryPoolClass[MIN (Index, MEMORY_TELEMETRY_POOL_CLASS_COUNT - 1)];
+}
+
+/**
+  Read the timer of the CPU Architectural Protocol.
+
+  @return The timer value, or 0 if the timer is not available.
+
+**/
+STATIC
+UINT64
+TelemetryReadTimer (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      Value;
+  UINT64      Period;
+
+  if (gCpu == NULL) {
+    return 0;
+  }
+
+  Status = gCpu->GetTimerValue (gCpu, 0, &Value, &Period);
+  if (EFI_ERROR (Status)) {
+    return 0;
+  }
+
+  mTelemetryTimerPeriod = Period;
+  return Value;
+}
+
+/**
+  Account a pool allocation. Called with the pool lock held.
+
+  @param  MemoryType             The memory type of the allocation.
+  @param  Size                   The size of the pool block, including the
+                                 pool head and tail.
+  @param  PageFallback           TRUE if the page allocator was called to
+                                 serve the allocation.
+  @param  Success                FALSE if the allocation failed.
+
+**/
+VOID
+CoreTelemetryPoolAllocate (
+  IN EFI_MEMORY_TYPE  MemoryType,
+  IN UINTN            Size,
+  IN BOOLEAN          PageFallback,
+  IN BOOLEAN          Success
+  )
+{
+  EDKII_MEMORY_TELEMETRY_TYPE        *Type;
+  EDKII_MEMORY_TELEMETRY_POOL_CLASS  *Class;
+
+  Type = TelemetryGetType (MemoryType);
+  if (!Success) {
+    Type->PoolFailures++;
+    return;
+  }
+
+  Class = TelemetryGetPoolClass (Size);
+  Type->PoolAllocations++;
+  Type->PoolBytesAllocated += Size;
+  Class->Allocations++;
+  Class->BytesAllocated += Size;
+  if (PageFallback) {
+    Type->PoolPageFallbacks++;
+    Class->PageFallbacks++;
+  }
+}
+
+/**
+  Account a pool free. Called with the pool lock held.
+
+  @param  MemoryType             The memory type of the pool block.
+  @param  Size                   The size of the pool block, including the
+                                 pool head and tail.
+
+**/
+VOID
+CoreTelemetryPoolFree (
+  IN EFI_MEMORY_TYPE  MemoryType,
+  IN UINTN            Size
+  )
+{
+  EDKII_MEMORY_TELEMETRY_TYPE  *Type;
+
+  Type = TelemetryGetType (MemoryType);
+  Type->PoolFrees++;
+  Type->PoolBytesFreed += Size;
+  TelemetryGetPoolClass (Size)->Frees++;
+}
+
+/**
+  Account a page allocation. Called with gMemoryLock held.
+
+  @param  MemoryType             The memory type of the allocation.
+  @param  NumberOfPages          The number of pages allocated.
+  @param  Success                FALSE if the allocation failed.
+
+**/
+VOID
+CoreTelemetryPageAllocate (
+  IN EFI_MEMORY_TYPE  MemoryType,
+  IN UINTN            NumberOfPages,
+  IN BOOLEAN          Success
+  )
+{
+  EDKII_MEMORY_TELEMETRY_TYPE  *Type;
+
+  Type = TelemetryGetType (MemoryType);
+  if (!Success) {
+    Type->PageFailures++;
+    return;
+  }
+
+  Type->PageAllocations++;
+  Type->PagesAllocated += NumberOfPages;
+}
+
+/**
+  Account a page free. Called with gMemoryLock held.
+
+  @param  MemoryType             The memory type of the pages.
+  @param  NumberOfPages          The number of pages freed.
+
+**/
+VOID
+CoreTelemetryPageFree (
+  IN EFI_MEMORY_TYPE  MemoryType,
+  IN UINTN            NumberOfPages
+  )
+{
+  EDKII_MEMORY_TELEMETRY_TYPE  *Type;
+
+  Type = TelemetryGetType (MemoryType);
+  Type->PageFrees++;
+  Type->PagesFreed += NumberOfPages;
+}
+
+/**
+  Account the acquisition of a lock of the memory services. Called right
+  after the lock was acquired.
+
+  @param  Lock                   The lock.
+
+**/
+VOID
+CoreTelemetryLockAcquired (
+  IN MEMORY_TELEMETRY_LOCK_ID  Lock
+  )
+{
+  mTelemetryLock[Lock].Counters.Acquisitions++;
+  mTelemetryLock[Lock].StartTicks = TelemetryReadTimer ();
+}
+
+/**
+  Account the hold time of a lock of the memory services. Called right
+  before the lock is released.
+
+  @param  Lock                   The lock.
+
+**/
+VOID
+CoreTelemetryLockReleased (
+  IN MEMORY_TELEMETRY_LOCK_ID  Lock
+  )
+{
+  MEMORY_TELEMETRY_LOCK_STATE  *State;
+  UINT64                       EndTicks;
+  UINT64                       HoldTicks;
+
+  State = &mTelemetryLock[Lock];
+  if (State->StartTicks == 0) {
+    return;
+  }
+
+  EndTicks = TelemetryReadTimer ();
+  if (EndTicks > State->StartTicks) {
+    HoldTicks                    = EndTicks - State->StartTicks;
+    State->Counters.HoldTicks   += HoldTicks;
+    State->Counters.MaxHoldTicks = MAX (State->Counters.MaxHoldTicks, HoldTicks);
+  }
+
+  State->StartTicks = 0;
+}
+
+/**
+  Get a snapshot of the memory telemetry counters.
+
+  @param  This                   The EDKII_MEMORY_TELEMETRY_PROTOCOL instance.
+  @param  DataSize               On entry, the size of Data. On return, the
+                                 size of the telemetry data.
+  @param  Data                   The buffer to receive the telemetry data.
+
+  @retval EFI_SUCCESS            The telemetry data was returned.
+  @retval EFI_INVALID_PARAMETER  DataSize is NULL, or Data is NULL and
+                                 *DataSize is not 0.
+  @retval EFI_BUFFER_TOO_SMALL   *DataSize is too small; it was updated with
+                                 the size needed.
+
+**/
+EFI_STATUS
+EFIAPI
+CoreGetMemoryTelemetry (
+  IN     EDKII_MEMORY_TELEMETRY_PROTOCOL  *This,
+  IN OUT UINTN                            *DataSize,
+  OUT    VOID                             *Data
+  )
+{
+  UINTN                              Size;
+  EDKII_MEMORY_TELEMETRY_HEADER      *Header;
+  EDKII_MEMORY_TELEMETRY_TYPE        *Type;
+  EDKII_MEMORY_TELEMETRY_POOL_CLASS  *Class;
+  EFI_TPL                            OldTpl;
+  UINTN                              Index;
+
+  if ((DataSize == NULL) || ((Data == NULL) && (*DataSize != 0))) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Size = sizeof (EDKII_MEMORY_TELEMETRY_HEADER) + sizeof (mTelemetryType) + sizeof (mTelemetryPoolClass);
+  if (*DataSize < Size) {
+    *DataSize = Size;
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  *DataSize = Size;
+
+  Header = Data;
+  Type   = (EDKII_MEMORY_TELEMETRY_TYPE *)(Header + 1);
+  Class  = (EDKII_MEMORY_TELEMETRY_POOL_CLASS *)(Type + MEMORY_TELEMETRY_TYPE_COUNT);
+
+  //
+  // Keep the pool and page services out while copying
+  //
+  OldTpl = CoreRaiseTpl (TPL_NOTIFY);
+  CopyMem (Type, mTelemetryType, sizeof (mTelemetryType));
+  CopyMem (Class, mTelemetryPoolClass, sizeof (mTelemetryPoolClass));
+  CopyMem (&Header->PoolLock, &mTelemetryLock[MemoryTelemetryPoolLock].Counters, sizeof (Header->PoolLock));
+  CopyMem (&Header->PageLock, &mTelemetryLock[MemoryTelemetryPageLock].Counters, sizeof (Header->PageLock));
+  Header->TimerPeriod = (Header->PoolLock.HoldTicks + Header->PageLock.HoldTicks != 0) ? mTelemetryTimerPeriod : 0;
+  CoreRestoreTpl (OldTpl);
+
+  Header->Signature       = EDKII_MEMORY_TELEMETRY_SIGNATURE;
+  Header->Length          = sizeof (EDKII_MEMORY_TELEMETRY_HEADER);
+  Header->Revision        = EDKII_MEMORY_TELEMETRY_REVISION;
+  Header->MemoryTypeCount = MEMORY_TELEMETRY_TYPE_COUNT;
+  Header->PoolClassCount  = MEMORY_TELEMETRY_POOL_CLASS_COUNT;
+
+  for (Index = 0; Index < MEMORY_TELEMETRY_TYPE_COUNT - 1; Index++) {
+    Type[Index].MemoryType = (UINT32)Index;
+  }
+
+  Type[Index].MemoryType = MEMORY_TYPE_OEM_RESERVED_MIN;
+
+  for (Index = 0; Index < MEMORY_TELEMETRY_POOL_CLASS_COUNT - 1; Index++) {
+    Class[Index].MaxSize = LShiftU64 (1, MEMORY_TELEMETRY_POOL_MIN_SHIFT + Index);
+  }
+
+  Class[Index].MaxSize = MAX_UINT64;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Reset all the memory telemetry counters to 0.
+
+  @param  This                   The EDKII_MEMORY_TELEMETRY_PROTOCOL instance.
+
+  @retval EFI_SUCCESS            The counters were reset.
+
+**/
+EFI_STATUS
+EFIAPI
+CoreResetMemoryTelemetry (
+  IN EDKII_MEMORY_TELEMETRY_PROTOCOL  *This
+  )
+{
+  EFI_TPL  OldTpl;
+  UINTN    Index;
+
+  OldTpl = CoreRaiseTpl (TPL_NOTIFY);
+  ZeroMem (mTelemetryType, sizeof (mTelemetryType));
+  ZeroMem (mTelemetryPoolClass, sizeof (mTelemetryPoolClass));
+  for (Index = 0; Index < MemoryTelemetryLockMax; Index++) {
+    ZeroMem (&mTelemetryLock[Index].Counters, sizeof (mTelemetryLock[Index].Counters));
+  }
+
+  CoreRestoreTpl (OldTpl);
+
+  return EFI_SUCCESS;
+}
@@ -31,6 +31,12 @@ UINTN  mMemoryMapKey = 0;
 
 #define MAX_MAP_DEPTH  6
 
+//
+// Minimum amount of unaccepted memory accepted when an allocation runs out of
+// accepted memory.
+//
+#define ACCEPT_MEMORY_GRANULARITY  SIZE_256MB
+
 ///
 /// mMapDepth - depth of new descriptor stack
 ///
@@ -45,6 +51,10 @@ UINTN       mFreeMapStack = 0;
 ///
 LIST_ENTRY  mFreeMemoryMapEntryList           = INITIALIZE_LIST_HEAD_VARIABLE (mFreeMemoryMapEntryList);
 BOOLEAN     mMemoryTypeInformationInitialized = FALSE;
+///
+/// TRUE while AcceptMemoryResource () has released the memory lock
+///
+BOOLEAN  mAcceptingMemory = FALSE;
 
 EFI_MEMORY_TYPE_STATISTICS  mMemoryTypeStatistics[EfiMaxMemoryType + 1] = {
   { 0, MAX_ALLOC_ADDRESS, 0, 0, EfiMaxMemoryType, TRUE,  FALSE },  // EfiReservedMemoryType
@@ -105,6 +115,7 @@ CoreAcquireMemoryLock (
   )
 {
   CoreAcquireLock (&gMemoryLock);
+  CoreTelemetryLockAcquired (MemoryTelemetryPageLock);
 }
 
 /**
@@ -116,6 +127,7 @@ CoreReleaseMemoryLock (
   VOID
   )
 {
+  CoreTelemetryLockReleased (MemoryTelemetryPageLock);
   CoreReleaseLock (&gMemoryLock);
 }
 
@@ -130,6 +142,7 @@ RemoveMemoryMapEntry (
   IN OUT MEMORY_MAP  *Entry
   )
 {
+  CoreMemoryMapIndexRemove (Entry);
   RemoveEntryList (&Entry->Link);
   Entry->Link.ForwardLink = NULL;
 
@@ -161,7 +174,6 @@ CoreAddRange (
   IN UINT64                Attribute
   )
 {
-  LIST_ENTRY  *Link;
   MEMORY_MAP  *Entry;
 
   ASSERT ((Start & EFI_PAGE_MASK) == 0);
@@ -207,29 +219,23 @@ CoreAddRange (
   //
 
   // Two memory descriptors can only be merged if they have the same Type
-  // and the same Attribute
+  // and the same Attribute. As descriptors never overlap, only the ones
+  // covering Start - 1 and End + 1 can adjoin the new range.
   //
+  Entry = (Start == 0) ? NULL : CoreMemoryMapIndexLookup (Start - 1);
+  if ((Entry != NULL) && (Entry->Type == Type) && (Entry->Attribute == Attribute) &&
+      (Entry->End + 1 == Start))
+  {
+    Start = Entry->Start;
+    RemoveMemoryMapEntry (Entry);
+  }
 
-  Link = gMemoryMap.ForwardLink;
-  while (Link != &gMemoryMap) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-    Link  = Link->ForwardLink;
-
-    if (Entry->Type != Type) {
-      continue;
-    }
-
-    if (Entry->Attribute != Attribute) {
-      continue;
-    }
-
-    if (Entry->End + 1 == Start) {
-      Start = Entry->Start;
-      RemoveMemoryMapEntry (Entry);
-    } else if (Entry->Start == End + 1) {
-      End = Entry->End;
-      RemoveMemoryMapEntry (Entry);
-    }
+  Entry = (End == MAX_UINT64) ? NULL : CoreMemoryMapIndexLookup (End + 1);
+  if ((Entry != NULL) && (Entry->Type == Type) && (Entry->Attribute == Attribute) &&
+      (Entry->Start == End + 1))
+  {
+    End = Entry->End;
+    RemoveMemoryMapEntry (Entry);
   }
 
   //
@@ -244,6 +250,7 @@ CoreAddRange (
   mMapStack[mMapDepth].VirtualStart = 0;
   mMapStack[mMapDepth].Attribute    = Attribute;
   InsertTailList (&gMemoryMap, &mMapStack[mMapDepth].Link);
+  CoreMemoryMapIndexInsert (&mMapStack[mMapDepth]);
 
   mMapDepth += 1;
   ASSERT (mMapDepth < MAX_MAP_DEPTH);
@@ -317,7 +324,6 @@ CoreFreeMemoryMapStack (
 {
   MEMORY_MAP  *Entry;
   MEMORY_MAP  *Entry2;
-  LIST_ENTRY  *Link2;
 
   ASSERT_LOCKED (&gMemoryLock);
 
@@ -347,26 +353,27 @@ CoreFreeMemoryMapStack (
     mMapDepth -= 1;
 
     if (mMapStack[mMapDepth].Link.ForwardLink != NULL) {
+      //
+      // Find insertion location. Entries from pages are kept sorted by address
+      // in gMemoryMap, so the entry goes in front of the next higher one.
+      //
+      Entry2 = CoreMemoryMapIndexNext (&mMapStack[mMapDepth]);
+      while ((Entry2 != NULL) && !Entry2->FromPages) {
+        Entry2 = CoreMemoryMapIndexNext (Entry2);
+      }
+
       //
       // Move this entry to general memory
       //
+      CoreMemoryMapIndexRemove (&mMapStack[mMapDepth]);
       RemoveEntryList (&mMapStack[mMapDepth].Link);
       mMapStack[mMapDepth].Link.ForwardLink = NULL;
 
       CopyMem (Entry, &mMapStack[mMapDepth], sizeof (MEMORY_MAP));
       Entry->FromPages = TRUE;
 
-      //
-      // Find insertion location
-      //
-      for (Link2 = gMemoryMap.ForwardLink; Link2 != &gMemoryMap; Link2 = Link2->ForwardLink) {
-        Entry2 = CR (Link2, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-        if (Entry2->FromPages && (Entry2->Start > Entry->Start)) {
-          break;
-        }
-      }
-
-      InsertTailList (Link2, &Entry->Link);
+      InsertTailList ((Entry2 != NULL) ? &Entry2->Link : &gMemoryMap, &Entry->Link);
+      CoreMemoryMapIndexInsert (Entry);
     } else {
       //
       // This item of mMapStack[mMapDepth] has already been dequeued from gMemoryMap list,
@@ -464,6 +471,157 @@ PromoteMemoryResource (
   return Promoted;
 }
 
+/**
+  Accept unaccepted memory large enough to satisfy an allocation, and add it
+  to the memory map as conventional memory.
+
+  Unaccepted memory is only accepted when an allocation cannot be satisfied
+  from the memory accepted so far, so that the memory not used by the boot is
+  left for the OS to accept. At least ACCEPT_MEMORY_GRANULARITY bytes are
+  accepted at a time to bound the number of updates of the GCD map.
+
+  The caller must hold the memory lock. The lock is released while the memory
+  is accepted, since the memory accept protocol and the GCD services allocate
+  memory themselves.
+
+  @param  Type                   The type of allocation to perform
+  @param  Start                  The address of the allocation for
+                                 AllocateAddress
+  @param  MaxAddress             The address that the allocation must be below
+  @param  NumberOfPages          The number of pages of the allocation
+  @param  Alignment              The alignment of the allocation
+
+  @retval TRUE                   Memory was accepted and added to the memory map.
+  @retval FALSE                  No memory was accepted.
+
+**/
+BOOLEAN
+AcceptMemoryResource (
+  IN EFI_ALLOCATE_TYPE     Type,
+  IN EFI_PHYSICAL_ADDRESS  Start,
+  IN EFI_PHYSICAL_ADDRESS  MaxAddress,
+  IN UINTN                 NumberOfPages,
+  IN UINTN                 Alignment
+  )
+{
+  EFI_STATUS            Status;
+  LIST_ENTRY            *Link;
+  EFI_GCD_MAP_ENTRY     *Entry;
+  UINT64                Length;
+  EFI_PHYSICAL_ADDRESS  AcceptStart;
+  EFI_PHYSICAL_ADDRESS  AcceptEnd;
+  UINT64                Capabilities;
+  BOOLEAN               Found;
+
+  ASSERT_LOCKED (&gMemoryLock);
+
+  //
+  // The memory accept protocol may allocate pages, which must not accept
+  // memory again.
+  //
+  if ((gMemoryAccept == NULL) || mAcceptingMemory) {
+    return FALSE;
+  }
+
+  if (Type == AllocateAddress) {
+    Length = LShiftU64 (NumberOfPages, EFI_PAGE_SHIFT);
+  } else {
+    //
+    // Leave room for the alignment and the guard pages of the allocation.
+    //
+    Length = LShiftU64 (NumberOfPages + 2, EFI_PAGE_SHIFT) + Alignment;
+    if (MaxAddress < EFI_PAGE_SIZE) {
+      return FALSE;
+    }
+
+    if ((MaxAddress & EFI_PAGE_MASK) != EFI_PAGE_MASK) {
+      MaxAddress = (MaxAddress & ~(UINT64)EFI_PAGE_MASK) - 1;
+    }
+  }
+
+  DEBUG ((DEBUG_PAGE, "Accept the memory resource\n"));
+
+  AcceptStart  = 0;
+  AcceptEnd    = 0;
+  Capabilities = 0;
+  Found        = FALSE;
+
+  CoreAcquireGcdMemoryLock ();
+
+  for (Link = mGcdMemorySpaceMap.ForwardLink; Link != &mGcdMemorySpaceMap; Link = Link->ForwardLink) {
+    Entry = CR (Link, EFI_GCD_MAP_ENTRY, Link, EFI_GCD_MAP_SIGNATURE);
+    if (Entry->GcdMemoryType != EfiGcdMemoryTypeUnaccepted) {
+      continue;
+    }
+
+    if (Type == AllocateAddress) {
+      //
+      // The whole requested range must be unaccepted.
+      //
+      if ((Start < Entry->BaseAddress) || (Start + Length - 1 > Entry->EndAddress)) {
+        continue;
+      }
+
+      AcceptStart = Start;
+      AcceptEnd   = Entry->EndAddress;
+    } else {
+      //
+      // Take the memory from the bottom of the lowest unaccepted range below
+      // MaxAddress that is large enough.
+      //
+      if (Entry->BaseAddress > MaxAddress) {
+        break;
+      }
+
+      AcceptStart = Entry->BaseAddress;
+      AcceptEnd   = MIN (Entry->EndAddress, MaxAddress);
+      if (AcceptEnd - AcceptStart + 1 < Length) {
+        continue;
+      }
+    }
+
+    AcceptEnd    = MIN (AcceptEnd, AcceptStart + MAX (Length, ACCEPT_MEMORY_GRANULARITY) - 1);
+    Capabilities = Entry->Capabilities;
+    Found        = TRUE;
+    break;
+  }
+
+  CoreReleaseGcdMemoryLock ();
+
+  if (!Found) {
+    return FALSE;
+  }
+
+  mAcceptingMemory = TRUE;
+  CoreReleaseMemoryLock ();
+
+  DEBUG ((DEBUG_PAGE, "AcceptMemory: %lx-%lx\n", AcceptStart, AcceptEnd));
+
+  Length = AcceptEnd - AcceptStart + 1;
+  Status = gMemoryAccept->AcceptMemory (gMemoryAccept, AcceptStart, (UINTN)Length);
+  if (!EFI_ERROR (Status)) {
+    Status = CoreRemoveMemorySpace (AcceptStart, Length);
+    if (!EFI_ERROR (Status)) {
+      //
+      // Add the range back as system memory, which also adds it to the memory
+      // map as conventional memory.
+      //
+      Status = CoreAddMemorySpace (
+                 EfiGcdMemoryTypeSystemMemory,
+                 AcceptStart,
+                 Length,
+                 Capabilities & ~(EFI_MEMORY_PRESENT | EFI_MEMORY_INITIALIZED | EFI_MEMORY_TESTED | EFI_MEMORY_RUNTIME)
+                 );
+      ASSERT_EFI_ERROR (Status);
+    }
+  }
+
+  CoreAcquireMemoryLock ();
+  mAcceptingMemory = FALSE;
+
+  return !EFI_ERROR (Status);
+}
+
 /**
   This function try to allocate Runtime code & Boot time code memory range. If LMFA enabled, 2 patchable PCD
   PcdLoadFixAddressRuntimeCodePageNumber & PcdLoadFixAddressBootTimeCodePageNumber which are set by tools will record the
@@ -843,7 +1001,6 @@ CoreConvertPagesEx (
   UINT64           RangeEnd;
   UINT64           Attribute;
   EFI_MEMORY_TYPE  MemType;
-  LIST_ENTRY       *Link;
   MEMORY_MAP       *Entry;
 
   Entry         = NULL;
@@ -868,15 +1025,8 @@ CoreConvertPagesEx (
     //
     // Find the entry that the covers the range
     //
-    for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-      Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-
-      if ((Entry->Start <= Start) && (Entry->End > Start)) {
-        break;
-      }
-    }
-
-    if (Link == &gMemoryMap) {
+    Entry = CoreMemoryMapIndexLookup (Start);
+    if (Entry == NULL) {
       DEBUG ((DEBUG_ERROR | DEBUG_PAGE, "ConvertPages: failed to find range %lx - %lx\n", Start, End));
       return EFI_NOT_FOUND;
     }
@@ -962,11 +1112,13 @@ CoreConvertPagesEx (
       // Clip start
       //
       Entry->Start = RangeEnd + 1;
+      CoreMemoryMapIndexUpdate (Entry);
     } else if (Entry->End == RangeEnd) {
       //
       // Clip end
       //
       Entry->End = Start - 1;
+      CoreMemoryMapIndexUpdate (Entry);
     } else {
       //
       // Pull it out of the center, clip current
@@ -988,9 +1140,11 @@ CoreConvertPagesEx (
 
       Entry->End = Start - 1;
       ASSERT (Entry->Start < Entry->End);
+      CoreMemoryMapIndexUpdate (Entry);
 
       Entry = &mMapStack[mMapDepth];
       InsertTailList (&gMemoryMap, &Entry->Link);
+      CoreMemoryMapIndexInsert (Entry);
 
       mMapDepth += 1;
       ASSERT (mMapDepth < MAX_MAP_DEPTH);
@@ -1112,6 +1266,159 @@ CoreUpdateMemoryAttributes (
   CoreReleaseMemoryLock ();
 }
 
+/**
+  Internal function. Checks whether a free memory map entry can hold a page
+  range below the requested address.
+
+  @param  Entry                  The memory map entry to check
+  @param  MaxAddress             The address that the range must be below
+  @param  MinAddress             The address that the range must be above
+  @param  NumberOfBytes          Number of bytes needed
+  @param  Alignment              Bits to align with
+  @param  NeedGuard              Flag to indicate Guard page is needed or not
+
+  @return The last address of the highest range of the entry that fits, or 0
+          if the range does not fit in the entry.
+
+**/
+STATIC
+UINT64
+FindFreePagesInEntry (
+  IN MEMORY_MAP  *Entry,
+  IN UINT64      MaxAddress,
+  IN UINT64      MinAddress,
+  IN UINT64      NumberOfBytes,
+  IN UINTN       Alignment,
+  IN BOOLEAN     NeedGuard
+  )
+{
+  UINT64  DescStart;
+  UINT64  DescEnd;
+  UINT64  DescNumberOfBytes;
+
+  //
+  // If it's not a free entry, don't bother with it
+  //
+  if (Entry->Type != EfiConventionalMemory) {
+    return 0;
+  }
+
+  //
+  // Don't allocate out of Special-Purpose memory.
+  //
+  if ((Entry->Attribute & EFI_MEMORY_SP) != 0) {
+    return 0;
+  }
+
+  DescStart = Entry->Start;
+  DescEnd   = Entry->End;
+
+  //
+  // If desc is past max allowed address or below min allowed address, skip it
+  //
+  if ((DescStart >= MaxAddress) || (DescEnd < MinAddress)) {
+    return 0;
+  }
+
+  //
+  // If desc ends past max allowed address, clip the end
+  //
+  if (DescEnd >= MaxAddress) {
+    DescEnd = MaxAddress;
+  }
+
+  DescEnd = ((DescEnd + 1) & (~((UINT64)Alignment - 1))) - 1;
+
+  // Skip if DescEnd is less than DescStart after alignment clipping
+  if (DescEnd < DescStart) {
+    return 0;
+  }
+
+  //
+  // Compute the number of bytes we can used from this
+  // descriptor, and see it's enough to satisfy the request
+  //
+  DescNumberOfBytes = DescEnd - DescStart + 1;
+
+  if (DescNumberOfBytes < NumberOfBytes) {
+    return 0;
+  }
+
+  //
+  // If the start of the allocated range is below the min address allowed, skip it
+  //
+  if ((DescEnd - NumberOfBytes + 1) < MinAddress) {
+    return 0;
+  }
+
+  if (NeedGuard) {
+    DescEnd = AdjustMemoryS (
+                DescEnd + 1 - DescNumberOfBytes,
+                DescNumberOfBytes,
+                NumberOfBytes
+                );
+  }
+
+  return DescEnd;
+}
+
+/**
+  Internal function. Finds the highest free page range below the requested
+  address in a subtree of the memory map index.
+
+  Entries do not overlap, so the first entry that fits when walking the
+  subtree from the highest address down gives the best match. Subtrees whose
+  largest free entry is smaller than the request are skipped.
+
+  @param  Node                   The root of the subtree to search
+  @param  MaxAddress             The address that the range must be below
+  @param  MinAddress             The address that the range must be above
+  @param  NumberOfBytes          Number of bytes needed
+  @param  Alignment              Bits to align with
+  @param  NeedGuard              Flag to indicate Guard page is needed or not
+
+  @return The last address of the range, or 0 if the range was not found.
+
+**/
+STATIC
+UINT64
+FindFreePagesInIndex (
+  IN MEMORY_MAP  *Node,
+  IN UINT64      MaxAddress,
+  IN UINT64      MinAddress,
+  IN UINT64      NumberOfBytes,
+  IN UINTN       Alignment,
+  IN BOOLEAN     NeedGuard
+  )
+{
+  UINT64  Target;
+
+  while ((Node != NULL) && (Node->MaxFreeBytes >= NumberOfBytes)) {
+    if (Node->Start < MaxAddress) {
+      Target = FindFreePagesInIndex (Node->Right, MaxAddress, MinAddress, NumberOfBytes, Alignment, NeedGuard);
+      if (Target != 0) {
+        return Target;
+      }
+
+      Target = FindFreePagesInEntry (Node, MaxAddress, MinAddress, NumberOfBytes, Alignment, NeedGuard);
+      if (Target != 0) {
+        return Target;
+      }
+
+      //
+      // Everything on the left ends below MinAddress
+      //
+      if (Node->Start <= MinAddress) {
+        return 0;
+      }
+    }
+
+    Node = Node->Left;
+  }
+
+  return 0;
+}
+
 /**
   Internal function. Finds a consecutive free page range below
   the requested address.
@@ -1137,13 +1444,8 @@ CoreFindFreePagesI (
   IN BOOLEAN          NeedGuard
   )
 {
-  UINT64      NumberOfBytes;
-  UINT64      Target;
-  UINT64      DescStart;
-  UINT64      DescEnd;
-  UINT64      DescNumberOfBytes;
-  LIST_ENTRY  *Link;
-  MEMORY_MAP  *Entry;
+  UINT64  NumberOfBytes;
+  UINT64  Target;
 
   if ((MaxAddress < EFI_PAGE_MASK) || (NumberOfPages == 0)) {
     return 0;
@@ -1171,82 +1473,14 @@ CoreFindFreePagesI (
   }
 
   NumberOfBytes = LShiftU64 (NumberOfPages, EFI_PAGE_SHIFT);
-  Target        = 0;
-
-  for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-
-    //
-    // If it's not a free entry, don't bother with it
-    //
-    if (Entry->Type != EfiConventionalMemory) {
-      continue;
-    }
-
-    //
-    // Don't allocate out of Special-Purpose memory.
-    //
-    if ((Entry->Attribute & EFI_MEMORY_SP) != 0) {
-      continue;
-    }
-
-    DescStart = Entry->Start;
-    DescEnd   = Entry->End;
-
-    //
-    // If desc is past max allowed address or below min allowed address, skip it
-    //
-    if ((DescStart >= MaxAddress) || (DescEnd < MinAddress)) {
-      continue;
-    }
-
-    //
-    // If desc ends past max allowed address, clip the end
-    //
-    if (DescEnd >= MaxAddress) {
-      DescEnd = MaxAddress;
-    }
-
-    DescEnd = ((DescEnd + 1) & (~((UINT64)Alignment - 1))) - 1;
-
-    // Skip if DescEnd is less than DescStart after alignment clipping
-    if (DescEnd < DescStart) {
-      continue;
-    }
-
-    //
-    // Compute the number of bytes we can used from this
-    // descriptor, and see it's enough to satisfy the request
-    //
-    DescNumberOfBytes = DescEnd - DescStart + 1;
-
-    if (DescNumberOfBytes >= NumberOfBytes) {
-      //
-      // If the start of the allocated range is below the min address allowed, skip it
-      //
-      if ((DescEnd - NumberOfBytes + 1) < MinAddress) {
-        continue;
-      }
-
-      //
-      // If this is the best match so far remember it
-      //
-      if (DescEnd > Target) {
-        if (NeedGuard) {
-          DescEnd = AdjustMemoryS (
-                      DescEnd + 1 - DescNumberOfBytes,
-                      DescNumberOfBytes,
-                      NumberOfBytes
-                      );
-          if (DescEnd == 0) {
-            continue;
-          }
-        }
-
-        Target = DescEnd;
-      }
-    }
-  }
+  Target        = FindFreePagesInIndex (
+                    CoreMemoryMapIndexRoot (),
+                    MaxAddress,
+                    MinAddress,
+                    NumberOfBytes,
+                    Alignment,
+                    NeedGuard
+                    );
 
   //
   // If this is a grow down, adjust target to be the allocation base
@@ -1531,6 +1765,19 @@ CoreInternalAllocatePages (
               Alignment,
               NeedGuard
               );
+    if ((Start == 0) && AcceptMemoryResource (Type, 0, MaxAddress, NumberOfPages, Alignment)) {
+      //
+      // Unaccepted memory was accepted, then re-attempt the allocation
+      //
+      Start = FindFreePages (
+                MaxAddress,
+                NumberOfPages,
+                MemoryType,
+                Alignment,
+                NeedGuard
+                );
+    }
+
     if (Start == 0) {
       Status = EFI_OUT_OF_RESOURCES;
       goto Done;
@@ -1548,10 +1795,13 @@ CoreInternalAllocatePages (
 
   if (EFI_ERROR (Status)) {
     //
-    // If requested memory region is unavailable it may be untested memory
-    // Attempt to promote memory resources, then re-attempt the allocation
+    // If requested memory region is unavailable it may be untested or
+    // unaccepted memory. Attempt to promote or accept memory resources, then
+    // re-attempt the allocation
     //
-    if (PromoteMemoryResource ()) {
+    if (PromoteMemoryResource () ||
+        ((Type == AllocateAddress) && AcceptMemoryResource (Type, Start, MaxAddress, NumberOfPages, Alignment)))
+    {
       if (NeedGuard) {
         Status = CoreConvertPagesWithGuard (Start, NumberOfPages, MemoryType);
       } else {
@@ -1561,6 +1811,7 @@ CoreInternalAllocatePages (
   }
 
 Done:
+  CoreTelemetryPageAllocate (MemoryType, NumberOfPages, (BOOLEAN) !EFI_ERROR (Status));
   CoreReleaseMemoryLock ();
 
   if (!EFI_ERROR (Status)) {
@@ -1653,11 +1904,11 @@ CoreInternalFreePages (
   OUT EFI_MEMORY_TYPE      *MemoryType OPTIONAL
   )
 {
-  EFI_STATUS  Status;
-  LIST_ENTRY  *Link;
-  MEMORY_MAP  *Entry;
-  UINTN       Alignment;
-  BOOLEAN     IsGuarded;
+  EFI_STATUS       Status;
+  MEMORY_MAP       *Entry;
+  UINTN            Alignment;
+  BOOLEAN          IsGuarded;
+  EFI_MEMORY_TYPE  EntryType;
 
   //
   // Free the range
@@ -1668,21 +1919,8 @@ CoreInternalFreePages (
   // Find the entry that the covers the range
   //
   IsGuarded = FALSE;
-  Entry     = NULL;
-  for (Link = gMemoryMap.ForwardLink; Link != &gMemoryMap; Link = Link->ForwardLink) {
-    Entry = CR (Link, MEMORY_MAP, Link, MEMORY_MAP_SIGNATURE);
-    if ((Entry->Start <= Memory) && (Entry->End > Memory)) {
-      break;
-    }
-  }
-
-  if (Link == &gMemoryMap) {
-    Status = EFI_NOT_FOUND;
-    goto Done;
-  }
-
+  Entry     = CoreMemoryMapIndexLookup (Memory);
   if (Entry == NULL) {
-    ASSERT (Entry != NULL);
     Status = EFI_NOT_FOUND;
     goto Done;
   }
@@ -1705,8 +1943,9 @@ CoreInternalFreePages (
   NumberOfPages += EFI_SIZE_TO_PAGES (Alignment) - 1;
   NumberOfPages &= ~(EFI_SIZE_TO_PAGES (Alignment) - 1);
 
+  EntryType = Entry->Type;
   if (MemoryType != NULL) {
-    *MemoryType = Entry->Type;
+    *MemoryType = EntryType;
   }
 
   IsGuarded = IsPageTypeToGuard (Entry->Type, AllocateAnyPages) &&
@@ -1721,6 +1960,10 @@ CoreInternalFreePages (
     Status = CoreConvertPages (Memory, NumberOfPages, EfiConventionalMemory);
   }
 
+  if (!EFI_ERROR (Status)) {
+    CoreTelemetryPageFree (EntryType, NumberOfPages);
+  }
+
 Done:
   CoreReleaseMemoryLock ();
   return Status;
@@ -2266,6 +2509,41 @@ CoreAllocatePoolPages (
   return (VOID *)(UINTN)Start;
 }
 
+/**
+  Internal function.  Used by the pool functions to accept unaccepted memory
+  when CoreAllocatePoolPages () could not find free pages to grow the pool.
+
+  CoreAllocatePoolPages () cannot accept memory itself: it runs with the pool
+  lock held, and also while the memory map is being updated, whereas accepting
+  memory allocates pool for the GCD map. The caller must hold neither the pool
+  lock nor the memory lock, and re-attempt the allocation on success.
+
+  @param  NumberOfPages          The number of pages the pool needs
+  @param  Alignment              Bits to align.
+
+  @retval TRUE                   Memory was accepted and added to the memory map.
+  @retval FALSE                  No memory was accepted.
+
+**/
+BOOLEAN
+CoreAcceptPoolPages (
+  IN UINTN  NumberOfPages,
+  IN UINTN  Alignment
+  )
+{
+  BOOLEAN  Accepted;
+
+  if (EFI_ERROR (CoreAcquireLockOrFail (&gMemoryLock))) {
+    return FALSE;
+  }
+
+  CoreTelemetryLockAcquired (MemoryTelemetryPageLock);
+  Accepted = AcceptMemoryResource (AllocateAnyPages, 0, MAX_ALLOC_ADDRESS, NumberOfPages, Alignment);
+  CoreReleaseMemoryLock ();
+
+  return Accepted;
+}
+
 /**
   Internal function.  Frees pool pages allocated via AllocatePoolPages ()
 
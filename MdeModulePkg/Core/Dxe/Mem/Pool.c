@@ -9,6 +9,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "DxeMain.h"
 #include "Imem.h"
 #include "HeapGuard.h"
+#include "PoolSlab.h"
 
 STATIC EFI_LOCK  mPoolMemoryLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_NOTIFY);
 
@@ -21,6 +22,7 @@ typedef struct {
 
 #define POOL_HEAD_SIGNATURE      SIGNATURE_32('p','h','d','0')
 #define POOLPAGE_HEAD_SIGNATURE  SIGNATURE_32('p','h','d','1')
+#define POOLSLAB_HEAD_SIGNATURE  SIGNATURE_32('p','h','d','2')
 typedef struct {
   UINT32             Signature;
   UINT32             Reserved;
@@ -70,6 +72,7 @@ typedef struct {
   EFI_MEMORY_TYPE    MemoryType;
   LIST_ENTRY         FreeList[MAX_POOL_LIST];
   LIST_ENTRY         Link;
+  POOL_SLAB_CLASS    SlabClass[POOL_SLAB_CLASS_COUNT];
 } POOL;
 
 //
@@ -126,6 +129,10 @@ CoreInitializePool (
     for (Index = 0; Index < MAX_POOL_LIST; Index++) {
       InitializeListHead (&mPoolHead[Type].FreeList[Index]);
     }
+
+    for (Index = 0; Index < POOL_SLAB_CLASS_COUNT; Index++) {
+      PoolSlabInitializeClass (&mPoolHead[Type].SlabClass[Index], Index);
+    }
   }
 }
 
@@ -175,6 +182,10 @@ LookupPoolHead (
       InitializeListHead (&Pool->FreeList[Index]);
     }
 
+    for (Index = 0; Index < POOL_SLAB_CLASS_COUNT; Index++) {
+      PoolSlabInitializeClass (&Pool->SlabClass[Index], Index);
+    }
+
     InsertHeadList (&mPoolHeadList, &Pool->Link);
 
     return Pool;
@@ -242,8 +253,33 @@ CoreInternalAllocatePool (
     return EFI_OUT_OF_RESOURCES;
   }
 
+  CoreTelemetryLockAcquired (MemoryTelemetryPoolLock);
   *Buffer = CoreAllocatePoolI (PoolType, Size, NeedGuard);
+  CoreTelemetryLockReleased (MemoryTelemetryPoolLock);
   CoreReleaseLock (&mPoolMemoryLock);
+
+  //
+  // The pool could not grow. Accept unaccepted memory the same way the page
+  // allocator does, then re-attempt the allocation. This is done without the
+  // pool lock, as accepting memory allocates pool itself.
+  //
+  if ((*Buffer == NULL) &&
+      CoreAcceptPoolPages (
+        EFI_SIZE_TO_PAGES (Size) + EFI_SIZE_TO_PAGES (POOL_OVERHEAD + RUNTIME_PAGE_ALLOCATION_GRANULARITY),
+        RUNTIME_PAGE_ALLOCATION_GRANULARITY
+        ))
+  {
+    Status = CoreAcquireLockOrFail (&mPoolMemoryLock);
+    if (EFI_ERROR (Status)) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    CoreTelemetryLockAcquired (MemoryTelemetryPoolLock);
+    *Buffer = CoreAllocatePoolI (PoolType, Size, NeedGuard);
+    CoreTelemetryLockReleased (MemoryTelemetryPoolLock);
+    CoreReleaseLock (&mPoolMemoryLock);
+  }
+
   return (*Buffer != NULL) ? EFI_SUCCESS : EFI_OUT_OF_RESOURCES;
 }
 
@@ -317,6 +353,7 @@ CoreAllocatePoolPagesI (
     return NULL;
   }
 
+  CoreTelemetryLockAcquired (MemoryTelemetryPageLock);
   Buffer = CoreAllocatePoolPages (PoolType, NoPages, Granularity, NeedGuard);
   CoreReleaseMemoryLock ();
 
@@ -336,6 +373,53 @@ CoreAllocatePoolPagesI (
   return Buffer;
 }
 
+/**
+  Internal function.  Allocates one object of a slab size class, adding a
+  new slab page to the class if all of its slabs are full.
+
+  @param  Pool                   The pool head of the memory type
+  @param  ClassIndex             The slab size class index
+  @param  PageFallback           Set to TRUE if a slab page was allocated
+
+  @return The allocated object, or NULL
+
+**/
+STATIC
+VOID *
+CoreAllocatePoolSlabI (
+  IN  POOL     *Pool,
+  IN  UINTN    ClassIndex,
+  OUT BOOLEAN  *PageFallback
+  )
+{
+  POOL_SLAB_CLASS  *Class;
+  VOID             *Object;
+  VOID             *NewPage;
+
+  Class  = &Pool->SlabClass[ClassIndex];
+  Object = PoolSlabAllocate (Class);
+  if (Object != NULL) {
+    return Object;
+  }
+
+  //
+  // Only go to the page allocator when the class is exhausted
+  //
+  *PageFallback = TRUE;
+  NewPage = CoreAllocatePoolPagesI (
+              Pool->MemoryType,
+              EFI_SIZE_TO_PAGES (POOL_SLAB_SIZE),
+              POOL_SLAB_SIZE,
+              FALSE
+              );
+  if (NewPage == NULL) {
+    return NULL;
+  }
+
+  PoolSlabAddSlab (Class, NewPage, (UINT32)Pool->MemoryType);
+  return PoolSlabAllocate (Class);
+}
+
 /**
   Internal function to allocate pool of a particular type.
   Caller must have the memory lock held
@@ -361,12 +445,15 @@ CoreAllocatePoolI (
   CHAR8      *NewPage;
   VOID       *Buffer;
   UINTN      Index;
+  UINTN      SlabIndex;
   UINTN      FSize;
   UINTN      Offset, MaxOffset;
   UINTN      NoPages;
   UINTN      Granularity;
   BOOLEAN    HasPoolTail;
   BOOLEAN    PageAsPool;
+  BOOLEAN    FromSlab;
+  BOOLEAN    PageFallback;
 
   ASSERT_LOCKED (&mPoolMemoryLock);
 
@@ -413,7 +500,24 @@ CoreAllocatePoolI (
     return NULL;
   }
 
-  Head = NULL;
+  Head         = NULL;
+  FromSlab     = FALSE;
+  PageFallback = FALSE;
+
+  //
+  // Small allocations are served from per size class slabs when enabled.
+  // Guarded pools and freed-memory guard need page granular allocations.
+  //
+  if (FeaturePcdGet (PcdPoolSlabAllocatorEnable) &&
+      !NeedGuard && !PageAsPool && (Granularity == POOL_SLAB_SIZE))
+  {
+    SlabIndex = PoolSlabSizeToClass (Size);
+    if (SlabIndex < POOL_SLAB_CLASS_COUNT) {
+      Head     = CoreAllocatePoolSlabI (Pool, SlabIndex, &PageFallback);
+      FromSlab = TRUE;
+      goto Done;
+    }
+  }
 
   //
   // If allocation is over max size, just allocate pages for the request
@@ -424,9 +528,10 @@ CoreAllocatePoolI (
       Size -= sizeof (POOL_TAIL);
     }
 
-    NoPages  = EFI_SIZE_TO_PAGES (Size) + EFI_SIZE_TO_PAGES (Granularity) - 1;
-    NoPages &= ~(UINTN)(EFI_SIZE_TO_PAGES (Granularity) - 1);
-    Head     = CoreAllocatePoolPagesI (PoolType, NoPages, Granularity, NeedGuard);
+    NoPages      = EFI_SIZE_TO_PAGES (Size) + EFI_SIZE_TO_PAGES (Granularity) - 1;
+    NoPages     &= ~(UINTN)(EFI_SIZE_TO_PAGES (Granularity) - 1);
+    Head         = CoreAllocatePoolPagesI (PoolType, NoPages, Granularity, NeedGuard);
+    PageFallback = TRUE;
     if (NeedGuard) {
       Head = AdjustPoolHeadA ((EFI_PHYSICAL_ADDRESS)(UINTN)Head, NoPages, Size);
     }
@@ -457,12 +562,13 @@ CoreAllocatePoolI (
     //
     // Get another page
     //
-    NewPage = CoreAllocatePoolPagesI (
-                PoolType,
-                EFI_SIZE_TO_PAGES (Granularity),
-                Granularity,
-                NeedGuard
-                );
+    PageFallback = TRUE;
+    NewPage      = CoreAllocatePoolPagesI (
+                     PoolType,
+                     EFI_SIZE_TO_PAGES (Granularity),
+                     Granularity,
+                     NeedGuard
+                     );
     if (NewPage == NULL) {
       goto Done;
     }
@@ -507,6 +613,7 @@ Carve:
 Done:
   Buffer = NULL;
 
+  CoreTelemetryPoolAllocate (PoolType, Size, PageFallback, (BOOLEAN)(Head != NULL));
   if (Head != NULL) {
     //
     // Account the allocation
@@ -516,10 +623,17 @@ Done:
     //
     // If we have a pool buffer, fill in the header & tail info
     //
-    Head->Signature = (PageAsPool) ? POOLPAGE_HEAD_SIGNATURE : POOL_HEAD_SIGNATURE;
-    Head->Size      = Size;
-    Head->Type      = (EFI_MEMORY_TYPE)PoolType;
-    Buffer          = Head->Data;
+    if (PageAsPool) {
+      Head->Signature = POOLPAGE_HEAD_SIGNATURE;
+    } else if (FromSlab) {
+      Head->Signature = POOLSLAB_HEAD_SIGNATURE;
+    } else {
+      Head->Signature = POOL_HEAD_SIGNATURE;
+    }
+
+    Head->Size = Size;
+    Head->Type = (EFI_MEMORY_TYPE)PoolType;
+    Buffer     = Head->Data;
 
     if (HasPoolTail) {
       Tail            = HEAD_TO_TAIL (Head);
@@ -572,7 +686,9 @@ CoreInternalFreePool (
   }
 
   CoreAcquireLock (&mPoolMemoryLock);
+  CoreTelemetryLockAcquired (MemoryTelemetryPoolLock);
   Status = CoreFreePoolI (Buffer, PoolType);
+  CoreTelemetryLockReleased (MemoryTelemetryPoolLock);
   CoreReleaseLock (&mPoolMemoryLock);
   return Status;
 }
@@ -707,6 +823,7 @@ CoreFreePoolI (
   BOOLEAN    IsGuarded;
   BOOLEAN    HasPoolTail;
   BOOLEAN    PageAsPool;
+  POOL_SLAB  *Slab;
 
   ASSERT (Buffer != NULL);
   //
@@ -716,15 +833,26 @@ CoreFreePoolI (
   ASSERT (Head != NULL);
 
   if ((Head->Signature != POOL_HEAD_SIGNATURE) &&
-      (Head->Signature != POOLPAGE_HEAD_SIGNATURE))
+      (Head->Signature != POOLPAGE_HEAD_SIGNATURE) &&
+      (Head->Signature != POOLSLAB_HEAD_SIGNATURE))
   {
     ASSERT (
       Head->Signature == POOL_HEAD_SIGNATURE ||
-      Head->Signature == POOLPAGE_HEAD_SIGNATURE
+      Head->Signature == POOLPAGE_HEAD_SIGNATURE ||
+      Head->Signature == POOLSLAB_HEAD_SIGNATURE
       );
     return EFI_INVALID_PARAMETER;
   }
 
+  Slab = NULL;
+  if (Head->Signature == POOLSLAB_HEAD_SIGNATURE) {
+    Slab = PoolSlabFromObject (Head);
+    ASSERT (Slab != NULL);
+    if ((Slab == NULL) || (Slab->MemoryType != (UINT32)Head->Type)) {
+      return EFI_INVALID_PARAMETER;
+    }
+  }
+
   IsGuarded = IsPoolTypeToGuard (Head->Type) &&
               IsMemoryGuarded ((EFI_PHYSICAL_ADDRESS)(UINTN)Head);
   HasPoolTail = !(IsGuarded &&
@@ -762,6 +890,7 @@ CoreFreePoolI (
   }
 
   Pool->Used -= Size;
+  CoreTelemetryPoolFree (Head->Type, Size);
   DEBUG ((DEBUG_POOL, "FreePool: %p (len %lx) %,ld\n", Head->Data, (UINT64)(Head->Size - POOL_OVERHEAD), (UINT64)Pool->Used));
 
   if ((Head->Type == EfiReservedMemoryType) ||
@@ -784,11 +913,22 @@ CoreFreePoolI (
   Index = SIZE_TO_LIST (Size);
   DEBUG_CLEAR_MEMORY (Head, Size);
 
-  //
-  // If it's not on the list, it must be pool pages
-  //
-  if ((Index >= SIZE_TO_LIST (Granularity)) || IsGuarded || PageAsPool) {
+  if (Slab != NULL) {
     //
+    // Return the object to its slab, and the slab page to free memory if
+    // it is no longer needed
+    //
+    NewPage = PoolSlabFree (Slab, Head);
+    if (NewPage != NULL) {
+      CoreFreePoolPagesI (
+        Pool->MemoryType,
+        (EFI_PHYSICAL_ADDRESS)(UINTN)NewPage,
+        EFI_SIZE_TO_PAGES (POOL_SLAB_SIZE)
+        );
+    }
+  } else if ((Index >= SIZE_TO_LIST (Granularity)) || IsGuarded || PageAsPool) {
+    //
+    // If it's not on the list, it must be pool pages.
     // Return the memory pages back to free memory
     //
     NoPages  = EFI_SIZE_TO_PAGES (Size) + EFI_SIZE_TO_PAGES (Granularity) - 1;
@@ -874,6 +1014,22 @@ CoreFreePoolI (
   // list entry for that memory type
   //
   if (((UINT32)Pool->MemoryType >= MEMORY_TYPE_OEM_RESERVED_MIN) && (Pool->Used == 0)) {
+    //
+    // Release the slabs cached for this memory type before the pool head
+    // they point to goes away
+    //
+    for (Index = 0; Index < POOL_SLAB_CLASS_COUNT; Index++) {
+      NewPage = PoolSlabReclaim (&Pool->SlabClass[Index]);
+      while (NewPage != NULL) {
+        CoreFreePoolPagesI (
+          Pool->MemoryType,
+          (EFI_PHYSICAL_ADDRESS)(UINTN)NewPage,
+          EFI_SIZE_TO_PAGES (POOL_SLAB_SIZE)
+          );
+        NewPage = PoolSlabReclaim (&Pool->SlabClass[Index]);
+      }
+    }
+
     RemoveEntryList (&Pool->Link);
     CoreFreePoolI (Pool, NULL);
   }
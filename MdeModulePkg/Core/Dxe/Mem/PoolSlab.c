@@ -0,0 +1,285 @@
+/** @file
+  Slab allocator for small pool allocations.
+
+  This file only manages the slab bookkeeping. Getting pages for new slabs,
+  releasing empty slabs and locking are done by the caller in Pool.c.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+
+#include "PoolSlab.h"
+
+/**
+  Initialize the slab list of one size class.
+
+  @param  Class                  The size class to initialize.
+  @param  ClassIndex             Index of the size class, less than
+                                 POOL_SLAB_CLASS_COUNT.
+
+**/
+VOID
+PoolSlabInitializeClass (
+  OUT POOL_SLAB_CLASS  *Class,
+  IN  UINTN            ClassIndex
+  )
+{
+  ASSERT (ClassIndex < POOL_SLAB_CLASS_COUNT);
+  ASSERT (sizeof (POOL_SLAB) <= POOL_SLAB_MIN_OBJECT_SIZE);
+
+  InitializeListHead (&Class->PartialList);
+  Class->Shift = (UINT32)(POOL_SLAB_MIN_SHIFT + ClassIndex);
+  //
+  // The first object slot holds the slab header.
+  //
+  Class->ObjectsPerSlab = (POOL_SLAB_SIZE >> Class->Shift) - 1;
+  ASSERT (Class->ObjectsPerSlab <= 64);
+
+  Class->Allocations    = 0;
+  Class->Frees          = 0;
+  Class->SlabsAllocated = 0;
+  Class->SlabsFreed     = 0;
+  Class->SlabCount      = 0;
+  Class->ObjectsInUse   = 0;
+}
+
+/**
+  Get the slab size class index that serves an object of the given size.
+
+  @param  Size                   Object size, including pool head and tail.
+
+  @return The size class index, or POOL_SLAB_CLASS_COUNT if Size is too large
+          to be served from a slab.
+
+**/
+UINTN
+PoolSlabSizeToClass (
+  IN UINTN  Size
+  )
+{
+  INTN  Shift;
+
+  if (Size > POOL_SLAB_MAX_OBJECT_SIZE) {
+    return POOL_SLAB_CLASS_COUNT;
+  }
+
+  if (Size <= POOL_SLAB_MIN_OBJECT_SIZE) {
+    return 0;
+  }
+
+  //
+  // Round up to the next power of two.
+  //
+  Shift = HighBitSet32 ((UINT32)Size - 1) + 1;
+  return (UINTN)Shift - POOL_SLAB_MIN_SHIFT;
+}
+
+/**
+  Allocate one object from the partially used slabs of a size class.
+
+  @param  Class                  The size class to allocate from.
+
+  @return The allocated object, or NULL if every slab of the class is full and
+          a new slab has to be added with PoolSlabAddSlab ().
+
+**/
+VOID *
+PoolSlabAllocate (
+  IN OUT POOL_SLAB_CLASS  *Class
+  )
+{
+  POOL_SLAB  *Slab;
+  UINTN      Index;
+
+  if (IsListEmpty (&Class->PartialList)) {
+    return NULL;
+  }
+
+  Slab = CR (Class->PartialList.ForwardLink, POOL_SLAB, Link, POOL_SLAB_SIGNATURE);
+  ASSERT (Slab->FreeMap != 0);
+
+  Index          = (UINTN)LowBitSet64 (Slab->FreeMap);
+  Slab->FreeMap &= ~LShiftU64 (1, Index);
+  Slab->FreeCount--;
+
+  //
+  // A full slab is no longer a candidate for allocation.
+  //
+  if (Slab->FreeMap == 0) {
+    RemoveEntryList (&Slab->Link);
+    InitializeListHead (&Slab->Link);
+  }
+
+  Class->Allocations++;
+  Class->ObjectsInUse++;
+
+  return (UINT8 *)Slab + ((Index + 1) << Slab->Shift);
+}
+
+/**
+  Turn a free page into a slab of a size class.
+
+  @param  Class                  The size class the slab belongs to.
+  @param  Page                   POOL_SLAB_SIZE bytes, aligned on POOL_SLAB_SIZE.
+  @param  MemoryType             Memory type of the page.
+
+**/
+VOID
+PoolSlabAddSlab (
+  IN OUT POOL_SLAB_CLASS  *Class,
+  IN     VOID             *Page,
+  IN     UINT32           MemoryType
+  )
+{
+  POOL_SLAB  *Slab;
+
+  ASSERT (((UINTN)Page & (POOL_SLAB_SIZE - 1)) == 0);
+
+  Slab             = (POOL_SLAB *)Page;
+  Slab->Signature  = POOL_SLAB_SIGNATURE;
+  Slab->MemoryType = MemoryType;
+  Slab->Shift      = (UINT16)Class->Shift;
+  Slab->FreeCount  = (UINT16)Class->ObjectsPerSlab;
+  Slab->Reserved   = 0;
+  Slab->FreeMap    = RShiftU64 (MAX_UINT64, 64 - Class->ObjectsPerSlab);
+  Slab->Class      = Class;
+
+  //
+  // New slabs go to the head of the list so that they are used before the
+  // sparsely populated ones left behind by frees.
+  //
+  InsertHeadList (&Class->PartialList, &Slab->Link);
+
+  Class->SlabsAllocated++;
+  Class->SlabCount++;
+}
+
+/**
+  Get the slab that contains an object.
+
+  @param  Object                 The object allocated by PoolSlabAllocate ().
+
+  @return The slab header, or NULL if Object does not belong to a valid slab.
+
+**/
+POOL_SLAB *
+PoolSlabFromObject (
+  IN VOID  *Object
+  )
+{
+  POOL_SLAB  *Slab;
+  UINTN      Offset;
+
+  Slab   = (POOL_SLAB *)((UINTN)Object & ~(UINTN)(POOL_SLAB_SIZE - 1));
+  Offset = (UINTN)Object - (UINTN)Slab;
+
+  if ((Slab->Signature != POOL_SLAB_SIGNATURE) ||
+      (Slab->Shift < POOL_SLAB_MIN_SHIFT) ||
+      (Slab->Shift > POOL_SLAB_MAX_SHIFT))
+  {
+    return NULL;
+  }
+
+  //
+  // Object must be on an object boundary and not in the header slot.
+  //
+  if ((Offset == 0) || ((Offset & ((1U << Slab->Shift) - 1)) != 0)) {
+    return NULL;
+  }
+
+  return Slab;
+}
+
+/**
+  Return an object to its slab.
+
+  A slab that becomes completely free is unlinked and returned to the caller
+  for release, unless it is the only slab of its class with free objects; it
+  is then kept to avoid bouncing a page in and out of the memory map.
+
+  @param  Slab                   The slab returned by PoolSlabFromObject ().
+  @param  Object                 The object to free.
+
+  @return The slab page to be released, or NULL if nothing is to be released.
+
+**/
+VOID *
+PoolSlabFree (
+  IN OUT POOL_SLAB  *Slab,
+  IN     VOID       *Object
+  )
+{
+  POOL_SLAB_CLASS  *Class;
+  UINTN            Index;
+  UINT64           Bit;
+
+  Class = Slab->Class;
+  Index = (((UINTN)Object - (UINTN)Slab) >> Slab->Shift) - 1;
+  Bit   = LShiftU64 (1, Index);
+
+  ASSERT (Index < Class->ObjectsPerSlab);
+  ASSERT ((Slab->FreeMap & Bit) == 0);
+
+  //
+  // A full slab becomes a candidate for allocation again.
+  //
+  if (Slab->FreeMap == 0) {
+    InsertTailList (&Class->PartialList, &Slab->Link);
+  }
+
+  Slab->FreeMap |= Bit;
+  Slab->FreeCount++;
+
+  Class->Frees++;
+  Class->ObjectsInUse--;
+
+  if ((Slab->FreeCount < Class->ObjectsPerSlab) ||
+      (Class->PartialList.ForwardLink == Class->PartialList.BackLink))
+  {
+    return NULL;
+  }
+
+  RemoveEntryList (&Slab->Link);
+  Slab->Signature = 0;
+
+  Class->SlabsFreed++;
+  Class->SlabCount--;
+
+  return Slab;
+}
+
+/**
+  Unlink one completely free slab from a size class.
+
+  @param  Class                  The size class to reclaim a slab from.
+
+  @return The slab page to be released, or NULL if the class has no free slab.
+
+**/
+VOID *
+PoolSlabReclaim (
+  IN OUT POOL_SLAB_CLASS  *Class
+  )
+{
+  LIST_ENTRY  *Link;
+  POOL_SLAB   *Slab;
+
+  for (Link = Class->PartialList.ForwardLink; Link != &Class->PartialList; Link = Link->ForwardLink) {
+    Slab = CR (Link, POOL_SLAB, Link, POOL_SLAB_SIGNATURE);
+    if (Slab->FreeCount == Class->ObjectsPerSlab) {
+      RemoveEntryList (&Slab->Link);
+      Slab->Signature = 0;
+
+      Class->SlabsFreed++;
+      Class->SlabCount--;
+      return Slab;
+    }
+  }
+
+  return NULL;
+}
@@ -0,0 +1,175 @@
+/** @file
+  Data structure and functions of the slab allocator that backs small pool
+  allocations when PcdPoolSlabAllocatorEnable is TRUE.
+
+  A slab is one EFI_PAGE_SIZE page carved into equally sized objects. The
+  first object slot of every slab holds the POOL_SLAB header, so the header of
+  any object is found by masking the object address with the page size, and
+  the object index is found with a single shift. Free objects of a slab are
+  tracked in a 64-bit bitmap, so both allocate and free are O(1).
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _POOL_SLAB_H_
+#define _POOL_SLAB_H_
+
+//
+// Object sizes (including pool head and tail) served from slabs. Every size
+// class is a power of two so that a size is mapped to its class with one
+// HighBitSet32 () call instead of a table walk.
+//
+#define POOL_SLAB_MIN_SHIFT    6
+#define POOL_SLAB_MAX_SHIFT    10
+#define POOL_SLAB_CLASS_COUNT  (POOL_SLAB_MAX_SHIFT - POOL_SLAB_MIN_SHIFT + 1)
+
+#define POOL_SLAB_MIN_OBJECT_SIZE  (1U << POOL_SLAB_MIN_SHIFT)
+#define POOL_SLAB_MAX_OBJECT_SIZE  (1U << POOL_SLAB_MAX_SHIFT)
+
+#define POOL_SLAB_SIZE  EFI_PAGE_SIZE
+
+#define POOL_SLAB_SIGNATURE  SIGNATURE_32('p','s','l','b')
+
+//
+// Per memory type and size class slab list and counters.
+//
+typedef struct {
+  //
+  // Slabs that still have at least one free object.
+  //
+  LIST_ENTRY    PartialList;
+  UINT32        Shift;
+  UINT32        ObjectsPerSlab;
+  //
+  // Statistics.
+  //
+  UINT64        Allocations;
+  UINT64        Frees;
+  UINT64        SlabsAllocated;
+  UINT64        SlabsFreed;
+  UINTN         SlabCount;
+  UINTN         ObjectsInUse;
+} POOL_SLAB_CLASS;
+
+//
+// Header stored in the first object slot of each slab page.
+//
+typedef struct {
+  UINT32             Signature;
+  UINT32             MemoryType;
+  UINT16             Shift;
+  UINT16             FreeCount;
+  UINT32             Reserved;
+  //
+  // Bit N set means object N is free.
+  //
+  UINT64             FreeMap;
+  LIST_ENTRY         Link;
+  POOL_SLAB_CLASS    *Class;
+} POOL_SLAB;
+
+/**
+  Initialize the slab list of one size class.
+
+  @param  Class                  The size class to initialize.
+  @param  ClassIndex             Index of the size class, less than
+                                 POOL_SLAB_CLASS_COUNT.
+
+**/
+VOID
+PoolSlabInitializeClass (
+  OUT POOL_SLAB_CLASS  *Class,
+  IN  UINTN            ClassIndex
+  );
+
+/**
+  Get the slab size class index that serves an object of the given size.
+
+  @param  Size                   Object size, including pool head and tail.
+
+  @return The size class index, or POOL_SLAB_CLASS_COUNT if Size is too large
+          to be served from a slab.
+
+**/
+UINTN
+PoolSlabSizeToClass (
+  IN UINTN  Size
+  );
+
+/**
+  Allocate one object from the partially used slabs of a size class.
+
+  @param  Class                  The size class to allocate from.
+
+  @return The allocated object, or NULL if every slab of the class is full and
+          a new slab has to be added with PoolSlabAddSlab ().
+
+**/
+VOID *
+PoolSlabAllocate (
+  IN OUT POOL_SLAB_CLASS  *Class
+  );
+
+/**
+  Turn a free page into a slab of a size class.
+
+  @param  Class                  The size class the slab belongs to.
+  @param  Page                   POOL_SLAB_SIZE bytes, aligned on POOL_SLAB_SIZE.
+  @param  MemoryType             Memory type of the page.
+
+**/
+VOID
+PoolSlabAddSlab (
+  IN OUT POOL_SLAB_CLASS  *Class,
+  IN     VOID             *Page,
+  IN     UINT32           MemoryType
+  );
+
+/**
+  Get the slab that contains an object.
+
+  @param  Object                 The object allocated by PoolSlabAllocate ().
+
+  @return The slab header, or NULL if Object does not belong to a valid slab.
+
+**/
+POOL_SLAB *
+PoolSlabFromObject (
+  IN VOID  *Object
+  );
+
+/**
+  Return an object to its slab.
+
+  A slab that becomes completely free is unlinked and returned to the caller
+  for release, unless it is the only slab of its class with free objects; it
+  is then kept to avoid bouncing a page in and out of the memory map.
+
+  @param  Slab                   The slab returned by PoolSlabFromObject ().
+  @param  Object                 The object to free.
+
+  @return The slab page to be released, or NULL if nothing is to be released.
+
+**/
+VOID *
+PoolSlabFree (
+  IN OUT POOL_SLAB  *Slab,
+  IN     VOID       *Object
+  );
+
+/**
+  Unlink one completely free slab from a size class.
+
+  @param  Class                  The size class to reclaim a slab from.
+
+  @return The slab page to be released, or NULL if the class has no free slab.
+
+**/
+VOID *
+PoolSlabReclaim (
+  IN OUT POOL_SLAB_CLASS  *Class
+  );
+
+#endif
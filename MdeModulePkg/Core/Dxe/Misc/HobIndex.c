@@ -0,0 +1,43 @@
+/** @file
+  Build the HOB index configuration table.
+
+  The index lets HobLib find the HOBs of a type, or the GUID extension HOBs of
+  a GUID, with a binary search instead of a walk of the whole HOB list.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeMain.h"
+#include "HobIndexBuild.h"
+
+/**
+  Build the index of the HOB list and install it into the EFI System Table's
+  Configuration Table. The HOB list is read only from now on, so the index is
+  built once. If it cannot be built, HobLib walks the HOB list.
+
+  @param  HobStart              The HOB list.
+
+**/
+VOID
+CoreInstallHobIndex (
+  IN VOID  *HobStart
+  )
+{
+  EDKII_HOB_INDEX  *HobIndex;
+  EFI_STATUS       Status;
+
+  HobIndex = HobIndexBuild (HobStart);
+  if (HobIndex == NULL) {
+    return;
+  }
+
+  Status = CoreInstallConfigurationTable (&gEdkiiHobIndexGuid, HobIndex);
+  if (EFI_ERROR (Status)) {
+    FreePool (HobIndex);
+    return;
+  }
+
+  DEBUG ((DEBUG_INFO, "HOB index: %u HOBs indexed\n", HobIndex->EntryCount));
+}
@@ -0,0 +1,119 @@
+/** @file
+  Build the index of a HOB list.
+
+  This file only builds the index. Installing it as a configuration table is
+  done by the caller in HobIndex.c.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiDxe.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/HobLib.h>
+#include <Library/MemoryAllocationLib.h>
+
+#include "HobIndexBuild.h"
+
+/**
+  Compare two HOB index entries by HOB type, then GUID, then offset.
+
+  @param  Buffer1               The first EDKII_HOB_INDEX_ENTRY.
+  @param  Buffer2               The second EDKII_HOB_INDEX_ENTRY.
+
+  @retval 0                     Buffer1 equals Buffer2.
+  @retval <0                    Buffer1 is less than Buffer2.
+  @retval >0                    Buffer1 is greater than Buffer2.
+
+**/
+STATIC
+INTN
+EFIAPI
+HobIndexCompare (
+  IN CONST VOID  *Buffer1,
+  IN CONST VOID  *Buffer2
+  )
+{
+  CONST EDKII_HOB_INDEX_ENTRY  *Entry1;
+  CONST EDKII_HOB_INDEX_ENTRY  *Entry2;
+  INTN                         Result;
+
+  Entry1 = Buffer1;
+  Entry2 = Buffer2;
+  if (Entry1->HobType != Entry2->HobType) {
+    return (INTN)Entry1->HobType - (INTN)Entry2->HobType;
+  }
+
+  Result = CompareMem (&Entry1->Name, &Entry2->Name, sizeof (EFI_GUID));
+  if (Result != 0) {
+    return Result;
+  }
+
+  return (Entry1->Offset < Entry2->Offset) ? -1 : (Entry1->Offset > Entry2->Offset);
+}
+
+/**
+  Build the index of a HOB list. The entries are sorted by HOB type, then
+  GUID, then offset, and HOBs of type EFI_HOB_TYPE_UNUSED are left out.
+
+  @param  HobStart              The HOB list.
+
+  @return The HOB index, allocated with AllocatePool (), or NULL if the HOB
+          list is too large to index or out of resources.
+
+**/
+EDKII_HOB_INDEX *
+HobIndexBuild (
+  IN VOID  *HobStart
+  )
+{
+  EFI_PEI_HOB_POINTERS   Hob;
+  EDKII_HOB_INDEX        *HobIndex;
+  EDKII_HOB_INDEX_ENTRY  *Entry;
+  EDKII_HOB_INDEX_ENTRY  Swap;
+  UINTN                  Count;
+
+  Count = 0;
+  for (Hob.Raw = HobStart; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if (Hob.Header->HobType != EFI_HOB_TYPE_UNUSED) {
+      Count++;
+    }
+  }
+
+  if ((UINTN)(Hob.Raw - (UINT8 *)HobStart) > MAX_UINT32) {
+    return NULL;
+  }
+
+  HobIndex = AllocatePool (sizeof (EDKII_HOB_INDEX) + Count * sizeof (EDKII_HOB_INDEX_ENTRY));
+  if (HobIndex == NULL) {
+    return NULL;
+  }
+
+  HobIndex->Signature     = EDKII_HOB_INDEX_SIGNATURE;
+  HobIndex->EntryCount    = (UINT32)Count;
+  HobIndex->HobList       = (EFI_PHYSICAL_ADDRESS)(UINTN)HobStart;
+  HobIndex->HobListLength = (UINT64)(Hob.Raw - (UINT8 *)HobStart);
+
+  Entry = (EDKII_HOB_INDEX_ENTRY *)(HobIndex + 1);
+  for (Hob.Raw = HobStart; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if (Hob.Header->HobType == EFI_HOB_TYPE_UNUSED) {
+      continue;
+    }
+
+    if (Hob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) {
+      CopyGuid (&Entry->Name, &Hob.Guid->Name);
+    } else {
+      ZeroMem (&Entry->Name, sizeof (EFI_GUID));
+    }
+
+    Entry->HobType  = Hob.Header->HobType;
+    Entry->Reserved = 0;
+    Entry->Offset   = (UINT32)(Hob.Raw - (UINT8 *)HobStart);
+    Entry++;
+  }
+
+  QuickSort (HobIndex + 1, Count, sizeof (EDKII_HOB_INDEX_ENTRY), HobIndexCompare, &Swap);
+  return HobIndex;
+}
@@ -0,0 +1,32 @@
+/** @file
+  Build the index of a HOB list.
+
+  The index lets HobLib find the HOBs of a type, or the GUID extension HOBs of
+  a GUID, with a binary search instead of a walk of the whole HOB list.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _HOB_INDEX_BUILD_H_
+#define _HOB_INDEX_BUILD_H_
+
+#include <Guid/HobIndex.h>
+
+/**
+  Build the index of a HOB list. The entries are sorted by HOB type, then
+  GUID, then offset, and HOBs of type EFI_HOB_TYPE_UNUSED are left out.
+
+  @param  HobStart              The HOB list.
+
+  @return The HOB index, allocated with AllocatePool (), or NULL if the HOB
+          list is too large to index or out of resources.
+
+**/
+EDKII_HOB_INDEX *
+HobIndexBuild (
+  IN VOID  *HobStart
+  );
+
+#endif
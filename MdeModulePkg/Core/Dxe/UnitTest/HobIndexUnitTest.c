@@ -0,0 +1,594 @@
+/** @file
+  Unit tests and microbenchmark of the HOB index built by the DXE core and
+  looked up by DxeHobLib.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <time.h>
+
+#include <PiDxe.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/HobLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+
+#include "../../../../MdePkg/Library/DxeHobLib/DxeHobLibInternal.h"
+#include "../Misc/HobIndexBuild.h"
+
+#define UNIT_TEST_APP_NAME     "DxeCore HOB Index Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+//
+// Number of distinct GUIDs of the GUID extension HOBs of the test HOB lists
+//
+#define TEST_GUID_COUNT        32
+#define TEST_HOB_COUNT         2048
+#define BENCHMARK_MIN_HOBS     256
+#define BENCHMARK_MAX_HOBS     16384
+#define BENCHMARK_LOOKUPS      4096
+
+typedef struct {
+  VOID               *HobList;
+  EDKII_HOB_INDEX    *HobIndex;
+} TEST_HOB_LIST;
+
+STATIC UINT32  mRandomSeed;
+
+/**
+  Return a pseudo random number.
+
+  @return A pseudo random number.
+
+**/
+STATIC
+UINT32
+TestRandom (
+  VOID
+  )
+{
+  mRandomSeed = mRandomSeed * 1103515245 + 12345;
+  return mRandomSeed >> 8;
+}
+
+/**
+  Return the GUID of the test GUID extension HOBs with the given number.
+
+  @param  Number        The number of the GUID.
+  @param  Guid          The GUID.
+
+**/
+STATIC
+VOID
+TestGuid (
+  IN  UINTN     Number,
+  OUT EFI_GUID  *Guid
+  )
+{
+  ZeroMem (Guid, sizeof (*Guid));
+  Guid->Data1    = 0x5a5a0000 | (UINT32)Number;
+  Guid->Data4[7] = (UINT8)Number;
+}
+
+/**
+  Build a HOB list of HobCount HOBs of random types and GUIDs, and its index.
+
+  The list starts with a PHIT HOB, like the HOB list handed off by PEI.
+
+  @param  HobCount      The number of HOBs, not including the end HOB.
+  @param  TestHobList   The HOB list and its index.
+
+  @retval TRUE          The HOB list was built.
+  @retval FALSE         Out of resources.
+
+**/
+STATIC
+BOOLEAN
+TestBuildHobList (
+  IN  UINTN          HobCount,
+  OUT TEST_HOB_LIST  *TestHobList
+  )
+{
+  EFI_PEI_HOB_POINTERS  Hob;
+  UINTN                 Index;
+  UINT16                Length;
+
+  TestHobList->HobIndex = NULL;
+  TestHobList->HobList  = AllocateZeroPool ((HobCount + 1) * (sizeof (EFI_HOB_GUID_TYPE) + 64));
+  if (TestHobList->HobList == NULL) {
+    return FALSE;
+  }
+
+  Hob.Raw = TestHobList->HobList;
+  for (Index = 0; Index < HobCount; Index++) {
+    if (Index == 0) {
+      Hob.Header->HobType = EFI_HOB_TYPE_HANDOFF;
+      Length              = sizeof (EFI_HOB_HANDOFF_INFO_TABLE);
+    } else {
+      switch (TestRandom () % 8) {
+        case 0:
+          Hob.Header->HobType = EFI_HOB_TYPE_RESOURCE_DESCRIPTOR;
+          Length              = sizeof (EFI_HOB_RESOURCE_DESCRIPTOR);
+          break;
+        case 1:
+          Hob.Header->HobType = EFI_HOB_TYPE_FV;
+          Length              = sizeof (EFI_HOB_FIRMWARE_VOLUME);
+          break;
+        case 2:
+        case 3:
+          Hob.Header->HobType = EFI_HOB_TYPE_MEMORY_ALLOCATION;
+          Length              = sizeof (EFI_HOB_MEMORY_ALLOCATION);
+          break;
+        default:
+          Hob.Header->HobType = EFI_HOB_TYPE_GUID_EXTENSION;
+          TestGuid (TestRandom () % TEST_GUID_COUNT, &Hob.Guid->Name);
+          Length = (UINT16)(sizeof (EFI_HOB_GUID_TYPE) + 8 * (TestRandom () % 8));
+          break;
+      }
+    }
+
+    Hob.Header->HobLength = Length;
+    Hob.Raw               = GET_NEXT_HOB (Hob);
+  }
+
+  Hob.Header->HobType   = EFI_HOB_TYPE_END_OF_HOB_LIST;
+  Hob.Header->HobLength = sizeof (EFI_HOB_GENERIC_HEADER);
+
+  TestHobList->HobIndex = HobIndexBuild (TestHobList->HobList);
+  if (TestHobList->HobIndex == NULL) {
+    FreePool (TestHobList->HobList);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Free a HOB list built by TestBuildHobList ().
+
+  @param  TestHobList   The HOB list and its index.
+
+**/
+STATIC
+VOID
+TestFreeHobList (
+  IN TEST_HOB_LIST  *TestHobList
+  )
+{
+  FreePool (TestHobList->HobIndex);
+  FreePool (TestHobList->HobList);
+}
+
+/**
+  Find a HOB the way GetNextHob () and GetNextGuidHob () do, optionally
+  starting the walk from where the HOB index points.
+
+  @param  HobIndex      The HOB index, or NULL to walk from HobStart.
+  @param  Type          The HOB type to search.
+  @param  Guid          The GUID to search for a GUID extension HOB, or NULL.
+  @param  HobStart      The HOB to search from.
+
+  @return The HOB found, or NULL.
+
+**/
+STATIC
+VOID *
+TestFindNext (
+  IN CONST EDKII_HOB_INDEX  *HobIndex  OPTIONAL,
+  IN UINT16                 Type,
+  IN CONST EFI_GUID         *Guid      OPTIONAL,
+  IN CONST VOID             *HobStart
+  )
+{
+  EFI_PEI_HOB_POINTERS  Hob;
+
+  Hob.Raw = HobIndexFindNext (HobIndex, Type, Guid, HobStart);
+  while (!END_OF_HOB_LIST (Hob)) {
+    if ((Hob.Header->HobType == Type) && ((Guid == NULL) || CompareGuid (&Hob.Guid->Name, Guid))) {
+      return Hob.Raw;
+    }
+
+    Hob.Raw = GET_NEXT_HOB (Hob);
+  }
+
+  return NULL;
+}
+
+/**
+  Check that walking all the HOBs of a type, or of a GUID, finds the same HOBs
+  with and without the index.
+
+  @param  TestHobList   The HOB list and its index.
+  @param  Type          The HOB type to search.
+  @param  Guid          The GUID to search for a GUID extension HOB, or NULL.
+
+  @return The number of HOBs found.
+
+**/
+STATIC
+UINTN
+TestCompareWalks (
+  IN TEST_HOB_LIST   *TestHobList,
+  IN UINT16          Type,
+  IN CONST EFI_GUID  *Guid  OPTIONAL
+  )
+{
+  EFI_PEI_HOB_POINTERS  Linear;
+  EFI_PEI_HOB_POINTERS  Indexed;
+  UINTN                 Count;
+
+  Count       = 0;
+  Linear.Raw  = TestFindNext (NULL, Type, Guid, TestHobList->HobList);
+  Indexed.Raw = TestFindNext (TestHobList->HobIndex, Type, Guid, TestHobList->HobList);
+  while (Linear.Raw != NULL) {
+    UT_ASSERT_EQUAL ((UINTN)Indexed.Raw, (UINTN)Linear.Raw);
+    Count++;
+    Linear.Raw  = TestFindNext (NULL, Type, Guid, GET_NEXT_HOB (Linear));
+    Indexed.Raw = TestFindNext (TestHobList->HobIndex, Type, Guid, GET_NEXT_HOB (Indexed));
+  }
+
+  UT_ASSERT_EQUAL ((UINTN)Indexed.Raw, (UINTN)NULL);
+  return Count;
+}
+
+/**
+  Check that the index built by the DXE core lists every HOB that is not of
+  type EFI_HOB_TYPE_UNUSED once, sorted by HOB type, then GUID, then offset.
+
+  @param[in]  Context    [Optional] An optional parameter.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+IndexShouldListEveryHob (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_HOB_LIST          TestHobList;
+  EFI_PEI_HOB_POINTERS   Hob;
+  EDKII_HOB_INDEX_ENTRY  *Entry;
+  UINTN                  Count;
+  UINTN                  Index;
+  INTN                   Order;
+
+  mRandomSeed = 4;
+  UT_ASSERT_TRUE (TestBuildHobList (TEST_HOB_COUNT, &TestHobList));
+
+  //
+  // Mark some HOBs unused and index the list again
+  //
+  Count = 0;
+  for (Hob.Raw = TestHobList.HobList; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if ((TestRandom () % 5) == 0) {
+      Hob.Header->HobType = EFI_HOB_TYPE_UNUSED;
+    } else {
+      Count++;
+    }
+  }
+
+  FreePool (TestHobList.HobIndex);
+  TestHobList.HobIndex = HobIndexBuild (TestHobList.HobList);
+  UT_ASSERT_NOT_NULL (TestHobList.HobIndex);
+
+  UT_ASSERT_EQUAL (TestHobList.HobIndex->Signature, EDKII_HOB_INDEX_SIGNATURE);
+  UT_ASSERT_EQUAL (TestHobList.HobIndex->HobList, (UINTN)TestHobList.HobList);
+  UT_ASSERT_EQUAL (TestHobList.HobIndex->HobListLength, (UINTN)(Hob.Raw - (UINT8 *)TestHobList.HobList));
+  UT_ASSERT_EQUAL (TestHobList.HobIndex->EntryCount, Count);
+
+  Entry = (EDKII_HOB_INDEX_ENTRY *)(TestHobList.HobIndex + 1);
+  for (Index = 0; Index < Count; Index++) {
+    UT_ASSERT_TRUE (Entry[Index].Offset < TestHobList.HobIndex->HobListLength);
+    Hob.Raw = (UINT8 *)TestHobList.HobList + Entry[Index].Offset;
+    UT_ASSERT_EQUAL (Hob.Header->HobType, Entry[Index].HobType);
+    UT_ASSERT_NOT_EQUAL (Entry[Index].HobType, EFI_HOB_TYPE_UNUSED);
+    if (Entry[Index].HobType == EFI_HOB_TYPE_GUID_EXTENSION) {
+      UT_ASSERT_TRUE (CompareGuid (&Hob.Guid->Name, &Entry[Index].Name));
+    } else {
+      UT_ASSERT_TRUE (IsZeroGuid (&Entry[Index].Name));
+    }
+
+    if (Index > 0) {
+      Order = (INTN)Entry[Index].HobType - (INTN)Entry[Index - 1].HobType;
+      if (Order == 0) {
+        Order = CompareMem (&Entry[Index].Name, &Entry[Index - 1].Name, sizeof (EFI_GUID));
+      }
+
+      if (Order == 0) {
+        Order = (Entry[Index].Offset > Entry[Index - 1].Offset) ? 1 : -1;
+      }
+
+      UT_ASSERT_TRUE (Order > 0);
+    }
+  }
+
+  TestFreeHobList (&TestHobList);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that the GUID extension HOBs found with the index are the ones found
+  by walking the HOB list.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+GuidLookupShouldMatchWalk (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_HOB_LIST  TestHobList;
+  EFI_GUID       Guid;
+  UINTN          Number;
+  UINTN          Count;
+
+  mRandomSeed = 1;
+  UT_ASSERT_TRUE (TestBuildHobList (TEST_HOB_COUNT, &TestHobList));
+
+  Count = 0;
+  for (Number = 0; Number <= TEST_GUID_COUNT; Number++) {
+    //
+    // The last GUID is not in the HOB list
+    //
+    TestGuid (Number, &Guid);
+    Count += TestCompareWalks (&TestHobList, EFI_HOB_TYPE_GUID_EXTENSION, &Guid);
+  }
+
+  UT_ASSERT_NOT_EQUAL (Count, 0);
+  TestFreeHobList (&TestHobList);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that the HOBs of a type found with the index are the ones found by
+  walking the HOB list, including for the types the index does not answer.
+
+  @param[in]  Context    [Optional] An optional parameter.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TypeLookupShouldMatchWalk (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_HOB_LIST  TestHobList;
+  UINT16         Type;
+
+  mRandomSeed = 2;
+  UT_ASSERT_TRUE (TestBuildHobList (TEST_HOB_COUNT, &TestHobList));
+
+  for (Type = EFI_HOB_TYPE_HANDOFF; Type <= EFI_HOB_TYPE_FV3; Type++) {
+    TestCompareWalks (&TestHobList, Type, NULL);
+  }
+
+  TestCompareWalks (&TestHobList, EFI_HOB_TYPE_UNUSED, NULL);
+  TestFreeHobList (&TestHobList);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that HOBs changed to EFI_HOB_TYPE_UNUSED after the index was built are
+  not returned, and that a HOB index of another HOB list is ignored.
+
+  @param[in]  Context    [Optional] An optional parameter.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+StaleEntriesShouldBeSkipped (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_HOB_LIST         TestHobList;
+  TEST_HOB_LIST         OtherHobList;
+  EFI_PEI_HOB_POINTERS  Hob;
+  EFI_GUID              Guid;
+  UINTN                 Number;
+
+  mRandomSeed = 3;
+  UT_ASSERT_TRUE (TestBuildHobList (TEST_HOB_COUNT, &TestHobList));
+  UT_ASSERT_TRUE (TestBuildHobList (TEST_HOB_COUNT, &OtherHobList));
+
+  for (Hob.Raw = TestHobList.HobList; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if ((TestRandom () % 3) == 0) {
+      Hob.Header->HobType = EFI_HOB_TYPE_UNUSED;
+    }
+  }
+
+  for (Number = 0; Number < TEST_GUID_COUNT; Number++) {
+    TestGuid (Number, &Guid);
+    TestCompareWalks (&TestHobList, EFI_HOB_TYPE_GUID_EXTENSION, &Guid);
+    UT_ASSERT_EQUAL (
+      (UINTN)HobIndexFindNext (TestHobList.HobIndex, EFI_HOB_TYPE_GUID_EXTENSION, &Guid, OtherHobList.HobList),
+      (UINTN)OtherHobList.HobList
+      );
+  }
+
+  TestCompareWalks (&TestHobList, EFI_HOB_TYPE_MEMORY_ALLOCATION, NULL);
+  TestCompareWalks (&TestHobList, EFI_HOB_TYPE_RESOURCE_DESCRIPTOR, NULL);
+
+  TestFreeHobList (&OtherHobList);
+  TestFreeHobList (&TestHobList);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Measure the time of GetFirstGuidHob () style lookups with and without the
+  HOB index, for HOB lists of increasing size. Half of the GUIDs looked up are
+  not in the HOB list, like the GUIDs of the optional HOBs of a platform.
+
+  @param[in]  Context    [Optional] An optional parameter.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+MeasureLookupLatency (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_HOB_LIST  TestHobList;
+  EFI_GUID       Guid[2 * TEST_GUID_COUNT];
+  UINTN          HobCount;
+  UINTN          Lookup;
+  UINTN          Found[2];
+  clock_t        Start;
+  clock_t        Ticks[2];
+  UINTN          Pass;
+
+  for (Lookup = 0; Lookup < ARRAY_SIZE (Guid); Lookup++) {
+    TestGuid (Lookup, &Guid[Lookup]);
+  }
+
+  for (HobCount = BENCHMARK_MIN_HOBS; HobCount <= BENCHMARK_MAX_HOBS; HobCount *= 4) {
+    mRandomSeed = (UINT32)HobCount;
+    UT_ASSERT_TRUE (TestBuildHobList (HobCount, &TestHobList));
+
+    for (Pass = 0; Pass < 2; Pass++) {
+      Found[Pass] = 0;
+      Start       = clock ();
+      for (Lookup = 0; Lookup < BENCHMARK_LOOKUPS; Lookup++) {
+        if (TestFindNext (
+              (Pass == 0) ? NULL : TestHobList.HobIndex,
+              EFI_HOB_TYPE_GUID_EXTENSION,
+              &Guid[Lookup % ARRAY_SIZE (Guid)],
+              TestHobList.HobList
+              ) != NULL)
+        {
+          Found[Pass]++;
+        }
+      }
+
+      Ticks[Pass] = clock () - Start;
+    }
+
+    UT_ASSERT_EQUAL (Found[0], Found[1]);
+    UT_LOG_INFO (
+      "%d HOBs: %d ns per lookup linear, %d ns per lookup indexed\n",
+      HobCount,
+      (UINTN)((UINT64)Ticks[0] * 1000000000 / CLOCKS_PER_SEC / BENCHMARK_LOOKUPS),
+      (UINTN)((UINT64)Ticks[1] * 1000000000 / CLOCKS_PER_SEC / BENCHMARK_LOOKUPS)
+      );
+
+    TestFreeHobList (&TestHobList);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  HOB index and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      HobIndexTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&HobIndexTests, Framework, "HOB Index Tests", "DxeCore.HobIndex", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for HOB Index Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // --------------Suite------------Description------------------------------Name------------Function---------------------------Pre---Post---Context-----------
+  //
+  AddTestCase (HobIndexTests, "Index lists every HOB in order", "Build", IndexShouldListEveryHob, NULL, NULL, NULL);
+  AddTestCase (HobIndexTests, "GUID lookup matches the HOB walk", "GuidLookup", GuidLookupShouldMatchWalk, NULL, NULL, NULL);
+  AddTestCase (HobIndexTests, "Type lookup matches the HOB walk", "TypeLookup", TypeLookupShouldMatchWalk, NULL, NULL, NULL);
+  AddTestCase (HobIndexTests, "Skip stale index entries", "StaleEntries", StaleEntriesShouldBeSkipped, NULL, NULL, NULL);
+  AddTestCase (HobIndexTests, "Lookup latency", "Latency", MeasureLookupLatency, NULL, NULL, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define HobIndexUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+HobIndexUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
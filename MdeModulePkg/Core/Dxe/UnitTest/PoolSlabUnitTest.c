@@ -0,0 +1,523 @@
+/** @file
+  Unit tests of the DXE core pool slab allocator.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+
+#include "../Mem/PoolSlab.h"
+
+#define UNIT_TEST_APP_NAME     "DxeCore Pool Slab Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define STRESS_OBJECT_COUNT     4096
+#define STRESS_ITERATIONS       100000
+#define REUSE_OBJECT_COUNT      1024
+#define REUSE_ROUNDS            200
+
+//
+// Memory type recorded in the slabs created by the tests.
+//
+#define TEST_MEMORY_TYPE  EfiBootServicesData
+
+/**
+  Allocate one object, adding a new slab when the class is exhausted, the same
+  way CoreAllocatePoolI () does it.
+
+  @param  Class   The size class to allocate from.
+
+  @return The allocated object, or NULL.
+
+**/
+STATIC
+VOID *
+TestSlabAllocate (
+  IN POOL_SLAB_CLASS  *Class
+  )
+{
+  VOID  *Object;
+  VOID  *Page;
+
+  Object = PoolSlabAllocate (Class);
+  if (Object != NULL) {
+    return Object;
+  }
+
+  Page = AllocateAlignedPages (EFI_SIZE_TO_PAGES (POOL_SLAB_SIZE), POOL_SLAB_SIZE);
+  if (Page == NULL) {
+    return NULL;
+  }
+
+  PoolSlabAddSlab (Class, Page, TEST_MEMORY_TYPE);
+  return PoolSlabAllocate (Class);
+}
+
+/**
+  Free one object and release its slab page if the slab allocator asks for it.
+
+  @param  Object   The object to free.
+
+**/
+STATIC
+VOID
+TestSlabFree (
+  IN VOID  *Object
+  )
+{
+  POOL_SLAB  *Slab;
+  VOID       *Page;
+
+  Slab = PoolSlabFromObject (Object);
+  ASSERT (Slab != NULL);
+
+  Page = PoolSlabFree (Slab, Object);
+  if (Page != NULL) {
+    FreeAlignedPages (Page, EFI_SIZE_TO_PAGES (POOL_SLAB_SIZE));
+  }
+}
+
+/**
+  Release every empty slab left in a size class.
+
+  @param  Class   The size class to drain.
+
+**/
+STATIC
+VOID
+TestSlabDrain (
+  IN POOL_SLAB_CLASS  *Class
+  )
+{
+  VOID  *Page;
+
+  for (Page = PoolSlabReclaim (Class); Page != NULL; Page = PoolSlabReclaim (Class)) {
+    FreeAlignedPages (Page, EFI_SIZE_TO_PAGES (POOL_SLAB_SIZE));
+  }
+}
+
+/**
+  Verify that object sizes are mapped to the smallest power of two class that
+  can hold them.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+SizeToClassShouldRoundUp (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Size;
+  UINTN  ClassIndex;
+
+  UT_ASSERT_EQUAL (PoolSlabSizeToClass (1), 0);
+  UT_ASSERT_EQUAL (PoolSlabSizeToClass (POOL_SLAB_MIN_OBJECT_SIZE), 0);
+  UT_ASSERT_EQUAL (PoolSlabSizeToClass (POOL_SLAB_MIN_OBJECT_SIZE + 1), 1);
+  UT_ASSERT_EQUAL (PoolSlabSizeToClass (POOL_SLAB_MAX_OBJECT_SIZE), POOL_SLAB_CLASS_COUNT - 1);
+  UT_ASSERT_EQUAL (PoolSlabSizeToClass (POOL_SLAB_MAX_OBJECT_SIZE + 1), POOL_SLAB_CLASS_COUNT);
+
+  for (Size = 1; Size <= POOL_SLAB_MAX_OBJECT_SIZE; Size++) {
+    ClassIndex = PoolSlabSizeToClass (Size);
+    UT_ASSERT_TRUE (ClassIndex < POOL_SLAB_CLASS_COUNT);
+    UT_ASSERT_TRUE (Size <= (POOL_SLAB_MIN_OBJECT_SIZE << ClassIndex));
+    if (ClassIndex > 0) {
+      UT_ASSERT_TRUE (Size > (POOL_SLAB_MIN_OBJECT_SIZE << (ClassIndex - 1)));
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Fill one slab of every class and verify object placement, then free all
+  objects and verify the last slab of a class is kept for reuse.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+FillAndEmptySlabShouldSucceed (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  POOL_SLAB_CLASS  Class;
+  UINTN            ClassIndex;
+  UINTN            Index;
+  VOID             *Objects[64];
+  POOL_SLAB        *Slab;
+  UINTN            ObjectSize;
+
+  for (ClassIndex = 0; ClassIndex < POOL_SLAB_CLASS_COUNT; ClassIndex++) {
+    PoolSlabInitializeClass (&Class, ClassIndex);
+    ObjectSize = POOL_SLAB_MIN_OBJECT_SIZE << ClassIndex;
+    UT_ASSERT_EQUAL (Class.ObjectsPerSlab, POOL_SLAB_SIZE / ObjectSize - 1);
+
+    UT_ASSERT_TRUE (PoolSlabAllocate (&Class) == NULL);
+
+    for (Index = 0; Index < Class.ObjectsPerSlab; Index++) {
+      Objects[Index] = TestSlabAllocate (&Class);
+      UT_ASSERT_NOT_NULL (Objects[Index]);
+      UT_ASSERT_EQUAL ((UINTN)Objects[Index] & (ObjectSize - 1), 0);
+
+      Slab = PoolSlabFromObject (Objects[Index]);
+      UT_ASSERT_NOT_NULL (Slab);
+      UT_ASSERT_EQUAL (Slab->MemoryType, TEST_MEMORY_TYPE);
+      UT_ASSERT_TRUE ((UINT8 *)Objects[Index] + ObjectSize <= (UINT8 *)Slab + POOL_SLAB_SIZE);
+      if (Index > 0) {
+        UT_ASSERT_TRUE (PoolSlabFromObject (Objects[Index - 1]) == Slab);
+        UT_ASSERT_TRUE (Objects[Index] != Objects[Index - 1]);
+      }
+
+      //
+      // The caller owns the whole object.
+      //
+      SetMem (Objects[Index], ObjectSize, 0xA5);
+    }
+
+    UT_ASSERT_EQUAL (Class.SlabCount, 1);
+    UT_ASSERT_TRUE (IsListEmpty (&Class.PartialList));
+    UT_ASSERT_TRUE (PoolSlabAllocate (&Class) == NULL);
+
+    for (Index = 0; Index < Class.ObjectsPerSlab; Index++) {
+      UT_ASSERT_TRUE (PoolSlabFree (PoolSlabFromObject (Objects[Index]), Objects[Index]) == NULL);
+    }
+
+    UT_ASSERT_EQUAL (Class.SlabCount, 1);
+    UT_ASSERT_EQUAL (Class.ObjectsInUse, 0);
+    UT_ASSERT_EQUAL (Class.Allocations, Class.Frees);
+
+    TestSlabDrain (&Class);
+    UT_ASSERT_EQUAL (Class.SlabCount, 0);
+    UT_ASSERT_EQUAL (Class.SlabsAllocated, Class.SlabsFreed);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Verify that addresses not allocated from a slab are rejected.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+InvalidObjectShouldBeRejected (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  POOL_SLAB_CLASS  Class;
+  UINT8            *Object;
+  VOID             *Page;
+
+  Page = AllocateAlignedPages (EFI_SIZE_TO_PAGES (POOL_SLAB_SIZE), POOL_SLAB_SIZE);
+  UT_ASSERT_NOT_NULL (Page);
+  ZeroMem (Page, POOL_SLAB_SIZE);
+  UT_ASSERT_TRUE (PoolSlabFromObject ((UINT8 *)Page + POOL_SLAB_MIN_OBJECT_SIZE) == NULL);
+  FreeAlignedPages (Page, EFI_SIZE_TO_PAGES (POOL_SLAB_SIZE));
+
+  PoolSlabInitializeClass (&Class, 1);
+  Object = TestSlabAllocate (&Class);
+  UT_ASSERT_NOT_NULL (Object);
+
+  //
+  // Header slot and addresses inside an object are not objects.
+  //
+  UT_ASSERT_TRUE (PoolSlabFromObject ((VOID *)((UINTN)Object & ~(UINTN)(POOL_SLAB_SIZE - 1))) == NULL);
+  UT_ASSERT_TRUE (PoolSlabFromObject (Object + 8) == NULL);
+  UT_ASSERT_NOT_NULL (PoolSlabFromObject (Object));
+
+  TestSlabFree (Object);
+  TestSlabDrain (&Class);
+  UT_ASSERT_EQUAL (Class.SlabCount, 0);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Randomly allocate and free objects of all classes and verify that no object
+  is handed out twice and that slabs are returned once empty.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+RandomAllocateFreeShouldSucceed (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  POOL_SLAB_CLASS  Classes[POOL_SLAB_CLASS_COUNT];
+  UINT8            **Objects;
+  UINT8            *Sizes;
+  UINTN            Iteration;
+  UINTN            Slot;
+  UINTN            ClassIndex;
+  UINTN            Index;
+
+  Objects = AllocateZeroPool (STRESS_OBJECT_COUNT * sizeof (*Objects));
+  Sizes   = AllocateZeroPool (STRESS_OBJECT_COUNT * sizeof (*Sizes));
+  UT_ASSERT_NOT_NULL (Objects);
+  UT_ASSERT_NOT_NULL (Sizes);
+
+  for (ClassIndex = 0; ClassIndex < POOL_SLAB_CLASS_COUNT; ClassIndex++) {
+    PoolSlabInitializeClass (&Classes[ClassIndex], ClassIndex);
+  }
+
+  srand (1);
+  for (Iteration = 0; Iteration < STRESS_ITERATIONS; Iteration++) {
+    Slot = (UINTN)rand () % STRESS_OBJECT_COUNT;
+    if (Objects[Slot] != NULL) {
+      //
+      // The object must still hold the pattern written at allocation time.
+      //
+      for (Index = 0; Index < (POOL_SLAB_MIN_OBJECT_SIZE << Sizes[Slot]); Index++) {
+        UT_ASSERT_EQUAL (Objects[Slot][Index], (UINT8)Slot);
+      }
+
+      TestSlabFree (Objects[Slot]);
+      Objects[Slot] = NULL;
+    } else {
+      ClassIndex    = (UINTN)rand () % POOL_SLAB_CLASS_COUNT;
+      Objects[Slot] = TestSlabAllocate (&Classes[ClassIndex]);
+      UT_ASSERT_NOT_NULL (Objects[Slot]);
+      Sizes[Slot] = (UINT8)ClassIndex;
+      SetMem (Objects[Slot], POOL_SLAB_MIN_OBJECT_SIZE << ClassIndex, (UINT8)Slot);
+    }
+  }
+
+  for (Slot = 0; Slot < STRESS_OBJECT_COUNT; Slot++) {
+    if (Objects[Slot] != NULL) {
+      TestSlabFree (Objects[Slot]);
+    }
+  }
+
+  for (ClassIndex = 0; ClassIndex < POOL_SLAB_CLASS_COUNT; ClassIndex++) {
+    UT_ASSERT_EQUAL (Classes[ClassIndex].ObjectsInUse, 0);
+    UT_ASSERT_EQUAL (Classes[ClassIndex].Allocations, Classes[ClassIndex].Frees);
+    //
+    // At most one empty slab is cached per class.
+    //
+    UT_ASSERT_TRUE (Classes[ClassIndex].SlabCount <= 1);
+    TestSlabDrain (&Classes[ClassIndex]);
+  }
+
+  FreePool (Objects);
+  FreePool (Sizes);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Verify that repeated allocate/free rounds keep exactly one empty slab cached
+  per size class and only add the slabs a round needs beyond that one.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+RepeatedRoundsShouldReuseCachedSlab (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  POOL_SLAB_CLASS  Classes[POOL_SLAB_CLASS_COUNT];
+  UINTN            Counts[POOL_SLAB_CLASS_COUNT];
+  VOID             **Objects;
+  UINTN            ClassIndex;
+  UINTN            Round;
+  UINTN            Index;
+  UINTN            SlabsPerRound;
+
+  Objects = AllocateZeroPool (REUSE_OBJECT_COUNT * sizeof (*Objects));
+  UT_ASSERT_NOT_NULL (Objects);
+
+  for (ClassIndex = 0; ClassIndex < POOL_SLAB_CLASS_COUNT; ClassIndex++) {
+    PoolSlabInitializeClass (&Classes[ClassIndex], ClassIndex);
+    Counts[ClassIndex] = 0;
+  }
+
+  for (Index = 0; Index < REUSE_OBJECT_COUNT; Index++) {
+    Counts[Index % POOL_SLAB_CLASS_COUNT]++;
+  }
+
+  for (Round = 0; Round < REUSE_ROUNDS; Round++) {
+    for (Index = 0; Index < REUSE_OBJECT_COUNT; Index++) {
+      Objects[Index] = TestSlabAllocate (&Classes[Index % POOL_SLAB_CLASS_COUNT]);
+      UT_ASSERT_NOT_NULL (Objects[Index]);
+    }
+
+    for (Index = 0; Index < REUSE_OBJECT_COUNT; Index++) {
+      TestSlabFree (Objects[Index]);
+    }
+
+    //
+    // Freeing the objects in allocation order empties the first slab while all
+    // others are still full, so it is the one kept; every other slab is
+    // released as soon as it is empty.
+    //
+    for (ClassIndex = 0; ClassIndex < POOL_SLAB_CLASS_COUNT; ClassIndex++) {
+      UT_ASSERT_EQUAL (Classes[ClassIndex].ObjectsInUse, 0);
+      UT_ASSERT_EQUAL (Classes[ClassIndex].SlabCount, 1);
+      UT_ASSERT_EQUAL (Classes[ClassIndex].SlabsAllocated - Classes[ClassIndex].SlabsFreed, 1);
+    }
+  }
+
+  for (ClassIndex = 0; ClassIndex < POOL_SLAB_CLASS_COUNT; ClassIndex++) {
+    SlabsPerRound = (Counts[ClassIndex] + Classes[ClassIndex].ObjectsPerSlab - 1) / Classes[ClassIndex].ObjectsPerSlab;
+    UT_ASSERT_EQUAL (Classes[ClassIndex].Allocations, (UINT64)Counts[ClassIndex] * REUSE_ROUNDS);
+    UT_ASSERT_EQUAL (Classes[ClassIndex].Frees, (UINT64)Counts[ClassIndex] * REUSE_ROUNDS);
+    UT_ASSERT_EQUAL (Classes[ClassIndex].SlabsAllocated, 1 + (UINT64)(SlabsPerRound - 1) * REUSE_ROUNDS);
+    TestSlabDrain (&Classes[ClassIndex]);
+    UT_ASSERT_EQUAL (Classes[ClassIndex].SlabCount, 0);
+  }
+
+  FreePool (Objects);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  pool slab allocator and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      SlabTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&SlabTests, Framework, "Pool Slab Tests", "DxeCore.PoolSlab", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for Pool Slab Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // --------------Suite--------Description------------------------------Name---------------Function-------------------------Pre---Post---Context-----------
+  //
+  AddTestCase (SlabTests, "Size to class rounds up", "SizeToClass", SizeToClassShouldRoundUp, NULL, NULL, NULL);
+  AddTestCase (SlabTests, "Fill and empty one slab per class", "FillAndEmpty", FillAndEmptySlabShouldSucceed, NULL, NULL, NULL);
+  AddTestCase (SlabTests, "Reject non slab objects", "InvalidObject", InvalidObjectShouldBeRejected, NULL, NULL, NULL);
+  AddTestCase (SlabTests, "Random allocate and free", "Random", RandomAllocateFreeShouldSucceed, NULL, NULL, NULL);
+  AddTestCase (SlabTests, "Repeated rounds reuse the cached slab", "Reuse", RepeatedRoundsShouldReuseCachedSlab, NULL, NULL, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define PoolSlabUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+PoolSlabUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
@@ -784,11 +784,153 @@ VerifyGuidedSectionGuid (
   return FALSE;
 }
 
+/**
+  Find the cache entry of the data extracted from an encapsulation section.
+
+  @param PrivateData       Pointer to the PEI_CORE_INSTANCE.
+  @param FvIndex           Index of the FV of the file in PrivateData->Fv.
+  @param FileName          The name of the file.
+  @param Parent            The cache entry the section was extracted to, or
+                           CACHE_SECTION_NO_PARENT.
+  @param Offset            The offset of the section in the file, or in the
+                           data of the Parent entry.
+
+  @return The index of the cache entry, or CACHE_SETION_MAX_NUMBER if the
+          section is not cached.
+
+**/
+UINTN
+FindCachedSection (
+  IN PEI_CORE_INSTANCE  *PrivateData,
+  IN UINTN              FvIndex,
+  IN CONST EFI_GUID     *FileName,
+  IN UINTN              Parent,
+  IN UINT32             Offset
+  )
+{
+  CACHE_SECTION_ENTRY  *Entry;
+  UINTN                Index;
+
+  for (Index = 0; Index < CACHE_SETION_MAX_NUMBER; Index++) {
+    Entry = &PrivateData->CacheSection.Entry[Index];
+    if ((Entry->SectionData != NULL) && (Entry->FvIndex == FvIndex) &&
+        (Entry->Parent == Parent) && (Entry->Offset == Offset) &&
+        CompareGuid (&Entry->FileName, FileName))
+    {
+      return Index;
+    }
+  }
+
+  return CACHE_SETION_MAX_NUMBER;
+}
+
+/**
+  Free a section cache entry, and the entries of the sections nested in it
+  since their key refers to it.
+
+  @param PrivateData       Pointer to the PEI_CORE_INSTANCE.
+  @param Index             The index of the cache entry.
+
+**/
+VOID
+FreeCachedSection (
+  IN PEI_CORE_INSTANCE  *PrivateData,
+  IN UINTN              Index
+  )
+{
+  CACHE_SECTION_ENTRY  *Entry;
+  UINTN                Child;
+
+  PrivateData->CacheSection.Entry[Index].SectionData = NULL;
+  for (Child = 0; Child < CACHE_SETION_MAX_NUMBER; Child++) {
+    Entry = &PrivateData->CacheSection.Entry[Child];
+    if ((Entry->SectionData != NULL) && (Entry->Parent == Index)) {
+      FreeCachedSection (PrivateData, Child);
+    }
+  }
+}
+
+/**
+  Cache the data extracted from an encapsulation section.
+
+  The entries are replaced in turn, except the ones of the encapsulation
+  sections that the section is nested in.
+
+  @param PrivateData          Pointer to the PEI_CORE_INSTANCE.
+  @param FvIndex              Index of the FV of the file in PrivateData->Fv.
+  @param FileName             The name of the file.
+  @param Parent               The cache entry the section was extracted to, or
+                              CACHE_SECTION_NO_PARENT.
+  @param Offset               The offset of the section in the file, or in the
+                              data of the Parent entry.
+  @param SectionData          The data extracted from the section.
+  @param SectionSize          The size of the data extracted from the section.
+  @param AuthenticationStatus The authentication status of the extracted data.
+
+  @return The index of the cache entry, or CACHE_SETION_MAX_NUMBER if the
+          section was not cached.
+
+**/
+UINTN
+AddCachedSection (
+  IN PEI_CORE_INSTANCE  *PrivateData,
+  IN UINTN              FvIndex,
+  IN CONST EFI_GUID     *FileName,
+  IN UINTN              Parent,
+  IN UINT32             Offset,
+  IN VOID               *SectionData,
+  IN UINTN              SectionSize,
+  IN UINT32             AuthenticationStatus
+  )
+{
+  CACHE_SECTION_DATA   *Cache;
+  CACHE_SECTION_ENTRY  *Entry;
+  UINTN                Index;
+  UINTN                Ancestor;
+  UINTN                Tries;
+
+  Cache = &PrivateData->CacheSection;
+  for (Tries = 0; Tries < CACHE_SETION_MAX_NUMBER; Tries++) {
+    Index               = Cache->SectionIndex;
+    Cache->SectionIndex = (Cache->SectionIndex + 1) % CACHE_SETION_MAX_NUMBER;
+
+    Ancestor = Parent;
+    while ((Ancestor != CACHE_SECTION_NO_PARENT) && (Ancestor != Index)) {
+      Ancestor = Cache->Entry[Ancestor].Parent;
+    }
+
+    if (Ancestor == Index) {
+      continue;
+    }
+
+    if (Cache->Entry[Index].SectionData != NULL) {
+      FreeCachedSection (PrivateData, Index);
+    }
+
+    Entry                       = &Cache->Entry[Index];
+    Entry->FvIndex              = FvIndex;
+    Entry->Parent               = Parent;
+    Entry->Offset               = Offset;
+    Entry->SectionData          = SectionData;
+    Entry->SectionSize          = SectionSize;
+    Entry->AuthenticationStatus = AuthenticationStatus;
+    CopyGuid (&Entry->FileName, FileName);
+    return Index;
+  }
+
+  return CACHE_SETION_MAX_NUMBER;
+}
+
 /**
   Go through the file to search SectionType section.
   Search within encapsulation sections (compression and GUIDed) recursively,
   until the match section is found.
 
+  The data extracted from the encapsulation sections is cached, keyed by FvIndex,
+  FileName and the offset of the section in Section, or in the data extracted
+  from the Parent cache entry, so that searching the same file again does not
+  extract and authenticate the sections again.
+
   @param PeiServices       An indirect pointer to the EFI_PEI_SERVICES table published by the PEI Foundation.
   @param SectionType       Filter to find only section of this type.
   @param SectionInstance   Pointer to the filter to find the specific instance of section.
@@ -798,6 +940,12 @@ VerifyGuidedSectionGuid (
                            NULL if section not found
   @param AuthenticationStatus Updated upon return to point to the authentication status for this section.
   @param IsFfs3Fv          Indicates the FV format.
+  @param FvIndex           Index of the FV of the file in PEI_CORE_INSTANCE.Fv.
+  @param FileName          The name of the file, or NULL if the extracted data
+                           must not be cached.
+  @param Parent            The cache entry Section was extracted to, or
+                           CACHE_SECTION_NO_PARENT if Section is at the top
+                           level of the file.
 
   @return EFI_NOT_FOUND    The match section is not found.
   @return EFI_SUCCESS      The match section is found.
@@ -812,7 +960,10 @@ ProcessSection (
   IN UINTN                      SectionSize,
   OUT VOID                      **OutputBuffer,
   OUT UINT32                    *AuthenticationStatus,
-  IN BOOLEAN                    IsFfs3Fv
+  IN BOOLEAN                    IsFfs3Fv,
+  IN UINTN                      FvIndex,
+  IN CONST EFI_GUID             *FileName OPTIONAL,
+  IN UINTN                      Parent
   )
 {
   EFI_STATUS                             Status;
@@ -822,11 +973,10 @@ ProcessSection (
   EFI_PEI_DECOMPRESS_PPI                 *DecompressPpi;
   VOID                                   *PpiOutput;
   UINTN                                  PpiOutputSize;
-  UINTN                                  Index;
+  UINTN                                  CacheIndex;
   UINT32                                 Authentication;
   PEI_CORE_INSTANCE                      *PrivateData;
   EFI_GUID                               *SectionDefinitionGuid;
-  BOOLEAN                                SectionCached;
   VOID                                   *TempOutputBuffer;
   UINT32                                 TempAuthenticationStatus;
   UINT16                                 GuidedSectionAttributes;
@@ -834,7 +984,6 @@ ProcessSection (
   PrivateData   = PEI_CORE_INSTANCE_FROM_PS_THIS (PeiServices);
   *OutputBuffer = NULL;
   ParsedLength  = 0;
-  Index         = 0;
   Status        = EFI_NOT_FOUND;
   PpiOutput     = NULL;
   PpiOutputSize = 0;
@@ -901,39 +1050,27 @@ ProcessSection (
       //
       // Check the encapsulated section is extracted into the cache data.
       //
-      SectionCached = FALSE;
-      for (Index = 0; Index < PrivateData->CacheSection.AllSectionCount; Index++) {
-        if (Section == PrivateData->CacheSection.Section[Index]) {
-          SectionCached  = TRUE;
-          PpiOutput      = PrivateData->CacheSection.SectionData[Index];
-          PpiOutputSize  = PrivateData->CacheSection.SectionSize[Index];
-          Authentication = PrivateData->CacheSection.AuthenticationStatus[Index];
-          //
-          // Search section directly from the cache data.
-          //
-          TempAuthenticationStatus = 0;
-          Status                   = ProcessSection (
-                                       PeiServices,
-                                       SectionType,
-                                       SectionInstance,
-                                       PpiOutput,
-                                       PpiOutputSize,
-                                       &TempOutputBuffer,
-                                       &TempAuthenticationStatus,
-                                       IsFfs3Fv
-                                       );
-          if (!EFI_ERROR (Status)) {
-            *OutputBuffer         = TempOutputBuffer;
-            *AuthenticationStatus = TempAuthenticationStatus | Authentication;
-            return EFI_SUCCESS;
-          }
-        }
+      CacheIndex = CACHE_SETION_MAX_NUMBER;
+      if (FileName != NULL) {
+        CacheIndex = FindCachedSection (PrivateData, FvIndex, FileName, Parent, ParsedLength);
       }
 
-      //
-      // If SectionCached is TRUE, the section data has been cached and scanned.
-      //
-      if (!SectionCached) {
+      if (CacheIndex < CACHE_SETION_MAX_NUMBER) {
+        //
+        // Search section directly from the cache data.
+        //
+        PrivateData->CacheSection.HitCount++;
+        PERF_EVENT ("SectionCacheHit");
+        Status         = EFI_SUCCESS;
+        PpiOutput      = PrivateData->CacheSection.Entry[CacheIndex].SectionData;
+        PpiOutputSize  = PrivateData->CacheSection.Entry[CacheIndex].SectionSize;
+        Authentication = PrivateData->CacheSection.Entry[CacheIndex].AuthenticationStatus;
+      } else {
+        if (FileName != NULL) {
+          PrivateData->CacheSection.MissCount++;
+        }
+
+        PERF_INMODULE_BEGIN ("SectionExtract");
         Status         = EFI_NOT_FOUND;
         Authentication = 0;
         if (Section->Type == EFI_SECTION_GUID_DEFINED) {
@@ -982,38 +1119,48 @@ ProcessSection (
           }
         }
 
-        if (!EFI_ERROR (Status)) {
-          if ((Authentication & EFI_AUTH_STATUS_NOT_TESTED) == 0) {
-            //
-            // Update cache section data.
-            //
-            if (PrivateData->CacheSection.AllSectionCount < CACHE_SETION_MAX_NUMBER) {
-              PrivateData->CacheSection.AllSectionCount++;
-            }
+        PERF_INMODULE_END ("SectionExtract");
 
-            PrivateData->CacheSection.Section[PrivateData->CacheSection.SectionIndex]              = Section;
-            PrivateData->CacheSection.SectionData[PrivateData->CacheSection.SectionIndex]          = PpiOutput;
-            PrivateData->CacheSection.SectionSize[PrivateData->CacheSection.SectionIndex]          = PpiOutputSize;
-            PrivateData->CacheSection.AuthenticationStatus[PrivateData->CacheSection.SectionIndex] = Authentication;
-            PrivateData->CacheSection.SectionIndex                                                 = (PrivateData->CacheSection.SectionIndex + 1)%CACHE_SETION_MAX_NUMBER;
-          }
+        //
+        // Update cache section data.
+        //
+        if (!EFI_ERROR (Status) && (FileName != NULL) && ((Authentication & EFI_AUTH_STATUS_NOT_TESTED) == 0)) {
+          CacheIndex = AddCachedSection (
+                         PrivateData,
+                         FvIndex,
+                         FileName,
+                         Parent,
+                         ParsedLength,
+                         PpiOutput,
+                         PpiOutputSize,
+                         Authentication
+                         );
+        }
+      }
 
-          TempAuthenticationStatus = 0;
-          Status                   = ProcessSection (
-                                       PeiServices,
-                                       SectionType,
-                                       SectionInstance,
-                                       PpiOutput,
-                                       PpiOutputSize,
-                                       &TempOutputBuffer,
-                                       &TempAuthenticationStatus,
-                                       IsFfs3Fv
-                                       );
-          if (!EFI_ERROR (Status)) {
-            *OutputBuffer         = TempOutputBuffer;
-            *AuthenticationStatus = TempAuthenticationStatus | Authentication;
-            return EFI_SUCCESS;
-          }
+      if (!EFI_ERROR (Status)) {
+        //
+        // The sections nested in a section that is not cached are not cached
+        // either, as their key refers to the cache entry of their parent.
+        //
+        TempAuthenticationStatus = 0;
+        Status                   = ProcessSection (
+                                     PeiServices,
+                                     SectionType,
+                                     SectionInstance,
+                                     PpiOutput,
+                                     PpiOutputSize,
+                                     &TempOutputBuffer,
+                                     &TempAuthenticationStatus,
+                                     IsFfs3Fv,
+                                     FvIndex,
+                                     (CacheIndex < CACHE_SETION_MAX_NUMBER) ? FileName : NULL,
+                                     CacheIndex
+                                     );
+        if (!EFI_ERROR (Status)) {
+          *OutputBuffer         = TempOutputBuffer;
+          *AuthenticationStatus = TempAuthenticationStatus | Authentication;
+          return EFI_SUCCESS;
         }
       }
     }
@@ -2072,6 +2219,7 @@ PeiFfsFvPpiFindSectionByType2 (
   EFI_COMMON_SECTION_HEADER  *Section;
   PEI_FW_VOL_INSTANCE        *FwVolInstance;
   PEI_CORE_FV_HANDLE         *CoreFvHandle;
+  PEI_CORE_INSTANCE          *PrivateData;
   UINTN                      Instance;
   UINT32                     ExtractedAuthenticationStatus;
 
@@ -2080,6 +2228,7 @@ PeiFfsFvPpiFindSectionByType2 (
   }
 
   FwVolInstance = PEI_FW_VOL_INSTANCE_FROM_FV_THIS (This);
+  PrivateData   = PEI_CORE_INSTANCE_FROM_PS_THIS (GetPeiServicesTablePointer ());
 
   //
   // Retrieve the FirmwareVolume which the file resides in.
@@ -2115,7 +2264,10 @@ PeiFfsFvPpiFindSectionByType2 (
                                     FileSize,
                                     SectionData,
                                     &ExtractedAuthenticationStatus,
-                                    FwVolInstance->IsFfs3Fv
+                                    FwVolInstance->IsFfs3Fv,
+                                    (UINTN)(CoreFvHandle - PrivateData->Fv),
+                                    &FfsFileHeader->Name,
+                                    CACHE_SECTION_NO_PARENT
                                     );
   if (!EFI_ERROR (Status)) {
     //
@@ -163,13 +163,34 @@ typedef struct {
 } PEI_CORE_UNKNOW_FORMAT_FV_INFO;
 
 #define CACHE_SETION_MAX_NUMBER  0x10
+
+//
+// CACHE_SECTION_ENTRY.Parent of the sections at the top level of a file
+//
+#define CACHE_SECTION_NO_PARENT  MAX_UINTN
+
+///
+/// The data extracted from a GUIDed or compression section. The entry is keyed
+/// by the FV and the file the section is in, and by the offset of the section
+/// in the file, or in the data extracted from the Parent entry for the sections
+/// nested in another encapsulation section. An entry with a NULL SectionData
+/// is free.
+///
+typedef struct {
+  UINTN       FvIndex;
+  EFI_GUID    FileName;
+  UINTN       Parent;
+  UINT32      Offset;
+  VOID        *SectionData;
+  UINTN       SectionSize;
+  UINT32      AuthenticationStatus;
+} CACHE_SECTION_ENTRY;
+
 typedef struct {
-  EFI_COMMON_SECTION_HEADER    *Section[CACHE_SETION_MAX_NUMBER];
-  VOID                         *SectionData[CACHE_SETION_MAX_NUMBER];
-  UINTN                        SectionSize[CACHE_SETION_MAX_NUMBER];
-  UINT32                       AuthenticationStatus[CACHE_SETION_MAX_NUMBER];
-  UINTN                        AllSectionCount;
-  UINTN                        SectionIndex;
+  CACHE_SECTION_ENTRY    Entry[CACHE_SETION_MAX_NUMBER];
+  UINTN                  SectionIndex;
+  UINTN                  HitCount;
+  UINTN                  MissCount;
 } CACHE_SECTION_DATA;
 
 #define HOLE_MAX_NUMBER  0x3
@@ -922,6 +943,10 @@ PeiFfsFindNextFile (
   Search within encapsulation sections (compression and GUIDed) recursively,
   until the match section is found.
 
+  The data extracted from the encapsulation sections is cached, keyed by FvIndex,
+  FileName and the offset of the section in Section, or in the data extracted
+  from the Parent cache entry.
+
   @param PeiServices          An indirect pointer to the EFI_PEI_SERVICES table published by the PEI Foundation.
   @param SectionType          Filter to find only section of this type.
   @param SectionInstance      Pointer to the filter to find the specific instance of section.
@@ -931,6 +956,12 @@ PeiFfsFindNextFile (
                               NULL if section not found.
   @param AuthenticationStatus Updated upon return to point to the authentication status for this section.
   @param IsFfs3Fv             Indicates the FV format.
+  @param FvIndex              Index of the FV of the file in PEI_CORE_INSTANCE.Fv.
+  @param FileName             The name of the file, or NULL if the extracted data
+                              must not be cached.
+  @param Parent               The cache entry Section was extracted to, or
+                              CACHE_SECTION_NO_PARENT if Section is at the top
+                              level of the file.
 
   @return EFI_NOT_FOUND       The match section is not found.
   @return EFI_SUCCESS         The match section is found.
@@ -945,7 +976,10 @@ ProcessSection (
   IN UINTN                      SectionSize,
   OUT VOID                      **OutputBuffer,
   OUT UINT32                    *AuthenticationStatus,
-  IN BOOLEAN                    IsFfs3Fv
+  IN BOOLEAN                    IsFfs3Fv,
+  IN UINTN                      FvIndex,
+  IN CONST EFI_GUID             *FileName OPTIONAL,
+  IN UINTN                      Parent
   );
 
 /**
@@ -282,6 +282,11 @@ PeiCore (
         OldCoreData->TempFileHandles = (EFI_PEI_FILE_HANDLE *)((UINT8 *)OldCoreData->TempFileHandles - OldCoreData->HeapOffset);
       }
 
+      //
+      // The section cache points to data extracted to temporary RAM, drop it.
+      //
+      ZeroMem (OldCoreData->CacheSection.Entry, sizeof (OldCoreData->CacheSection.Entry));
+
       // Force relocating the dispatch table
       OldCoreData->DelayedDispatchTable = NULL;
 
@@ -549,6 +554,13 @@ PeiCore (
     CpuDeadLoop ();
   }
 
+  DEBUG ((
+    DEBUG_INFO,
+    "PEI section cache: %Lu hits, %Lu misses\n",
+    (UINT64)PrivateData.CacheSection.HitCount,
+    (UINT64)PrivateData.CacheSection.MissCount
+    ));
+
   //
   // Enter DxeIpl to load Dxe core.
   //
@@ -0,0 +1,50 @@
+/** @file
+  GUID used as the FV filename of the DXE dispatch plan file, and the layout
+  of the file.
+
+  The dispatch plan is generated by GenFds for an FV that has a DISPATCH_PLAN
+  DXE statement in the FDF. It lists the drivers of the FV whose dependency
+  expressions can be resolved at build time, with the dispatch round in which
+  the DXE dispatcher is expected to find each of them ready. The DXE core
+  schedules a planned driver without evaluating its dependency expression once
+  the planned drivers of all earlier rounds were dispatched.
+
+  The file contains one EFI_SECTION_RAW section holding an
+  EDKII_DISPATCH_PLAN_HEADER followed by EntryCount EFI_GUID file names, and
+  then by EntryCount UINT32 dispatch rounds in ascending order.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __DXE_DISPATCH_PLAN_GUID_H__
+#define __DXE_DISPATCH_PLAN_GUID_H__
+
+#define EDKII_DXE_DISPATCH_PLAN_FILE_GUID \
+  { \
+    0xee2da7dd, 0xb46f, 0x43ca, { 0x98, 0xc0, 0xc9, 0xbb, 0x75, 0x12, 0xbc, 0xcc } \
+  }
+
+#define EDKII_DISPATCH_PLAN_SIGNATURE  SIGNATURE_32 ('D', 'P', 'L', 'N')
+#define EDKII_DISPATCH_PLAN_VERSION    2
+
+typedef struct {
+  UINT32    Signature;
+  UINT32    Version;
+  ///
+  /// Number of EFI_GUID file names following the header.
+  ///
+  UINT32    EntryCount;
+  ///
+  /// CRC32 of the file name and round arrays. It is an integrity check that
+  /// rejects a damaged plan, and does not authenticate the plan.
+  ///
+  UINT32    Crc32;
+  // EFI_GUID  FileName[EntryCount];
+  // UINT32    Round[EntryCount];
+} EDKII_DISPATCH_PLAN_HEADER;
+
+extern EFI_GUID  gEdkiiDxeDispatchPlanFileGuid;
+
+#endif
@@ -23,7 +23,33 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define LZMAF86_CUSTOM_DECOMPRESS_GUID  \
   { 0xD42AE6BD, 0x1352, 0x4bfb, { 0x90, 0x9A, 0xCA, 0x72, 0xA6, 0xEA, 0xE8, 0x89 } }
 
+///
+/// The Global ID used to identify a section of an FFS file of type
+/// EFI_SECTION_GUID_DEFINED, whose contents have been split in chunks that
+/// were compressed using LZMA independently, so they can be decompressed in
+/// parallel.
+///
+#define LZMA_PARALLEL_CUSTOM_DECOMPRESS_GUID  \
+  { 0x7F6BD9BF, 0x3307, 0x4700, { 0x8F, 0xDF, 0x92, 0x1C, 0x57, 0x73, 0x65, 0x71 } }
+
+#define LZMA_PARALLEL_SIGNATURE  SIGNATURE_32 ('L', 'Z', 'M', 'P')
+
+///
+/// Header of the data of a LZMA_PARALLEL_CUSTOM_DECOMPRESS_GUID section. It is
+/// followed by ChunkCount UINT32 holding the compressed size of each chunk,
+/// then by the compressed chunks, back to back. Each compressed chunk is a
+/// complete LZMA stream, as found in a LZMA_CUSTOM_DECOMPRESS_GUID section.
+/// All the chunks but the last one decompress to ChunkSize bytes.
+///
+typedef struct {
+  UINT32    Signature;
+  UINT32    ChunkCount;
+  UINT32    ChunkSize;
+  UINT32    DecompressedSize;
+} LZMA_PARALLEL_HEADER;
+
 extern GUID  gLzmaCustomDecompressGuid;
 extern GUID  gLzmaF86CustomDecompressGuid;
+extern GUID  gLzmaParallelCustomDecompressGuid;
 
 #endif
@@ -0,0 +1,52 @@
+/** @file
+  Measure intervals with the performance counter of TimerLib.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef ELAPSED_TIME_LIB_H_
+#define ELAPSED_TIME_LIB_H_
+
+/**
+  Return the number of performance counter ticks between two values read from
+  GetPerformanceCounter().
+
+  The counter may count up or down, and may roll over once between Start and
+  End.
+
+  @param  Start           The counter value at the start of the interval.
+  @param  End             The counter value at the end of the interval.
+
+  @return The number of ticks between Start and End.
+
+**/
+UINT64
+EFIAPI
+GetElapsedTicks (
+  IN UINT64  Start,
+  IN UINT64  End
+  );
+
+/**
+  Return the time in nanoseconds between two values read from
+  GetPerformanceCounter().
+
+  The counter may count up or down, and may roll over once between Start and
+  End.
+
+  @param  Start           The counter value at the start of the interval.
+  @param  End             The counter value at the end of the interval.
+
+  @return The time between Start and End in nanoseconds.
+
+**/
+UINT64
+EFIAPI
+GetElapsedTimeInNanoSecond (
+  IN UINT64  Start,
+  IN UINT64  End
+  );
+
+#endif
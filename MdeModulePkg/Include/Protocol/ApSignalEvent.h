@@ -0,0 +1,52 @@
+/** @file
+  AP Signal Event protocol.
+
+  The DXE core produces this protocol to let the procedures that run on the
+  APs through the MP Services protocol signal events, typically to report that
+  a piece of work completed. Boot services, including SignalEvent (), may only
+  be called on the BSP.
+
+  SignalEvent () of this protocol only queues the event, without any lock, and
+  the BSP signals the queued events the next time it lowers its TPL below
+  TPL_HIGH_LEVEL, which it does at least on every timer tick. The events are
+  signaled in the order they were queued.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef AP_SIGNAL_EVENT_H_
+#define AP_SIGNAL_EVENT_H_
+
+#define EDKII_AP_SIGNAL_EVENT_PROTOCOL_GUID \
+  { 0x929f397a, 0xf600, 0x4781, { 0xa8, 0x9f, 0x09, 0xc5, 0x0b, 0xa9, 0xf6, 0xf4 } }
+
+typedef struct _EDKII_AP_SIGNAL_EVENT_PROTOCOL EDKII_AP_SIGNAL_EVENT_PROTOCOL;
+
+/**
+  Queue an event to be signaled by the BSP.
+
+  This function may be called on the BSP or on any AP, at any TPL. It does not
+  wait for the event to be signaled. Queuing an event that is already queued
+  has no effect. The event must not be closed before it was signaled.
+
+  @param[in]  Event               The event to signal.
+
+  @retval EFI_SUCCESS             The event was queued, or already was.
+  @retval EFI_INVALID_PARAMETER   Event is not a valid event.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_AP_SIGNAL_EVENT)(
+  IN EFI_EVENT  Event
+  );
+
+struct _EDKII_AP_SIGNAL_EVENT_PROTOCOL {
+  EDKII_AP_SIGNAL_EVENT    SignalEvent;
+};
+
+extern EFI_GUID  gEdkiiApSignalEventProtocolGuid;
+
+#endif
@@ -0,0 +1,142 @@
+/** @file
+  Disk I/O Cache protocol.
+
+  The Disk I/O driver produces this protocol on the disks whose blocks it
+  caches. It reports the hit and miss counters of the cache, and lets the
+  callers that access the Block I/O protocol of the disk directly write back
+  or drop the cached blocks beforehand.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef DISK_IO_CACHE_H_
+#define DISK_IO_CACHE_H_
+
+#define EDKII_DISK_IO_CACHE_PROTOCOL_GUID \
+  { 0xc8dbcedc, 0x82ca, 0x4759, { 0xb1, 0x3f, 0x3d, 0x9e, 0x26, 0x39, 0xe6, 0x62 } }
+
+typedef struct _EDKII_DISK_IO_CACHE_PROTOCOL EDKII_DISK_IO_CACHE_PROTOCOL;
+
+#define EDKII_DISK_IO_CACHE_PROTOCOL_REVISION  0x00010000
+
+///
+/// The configuration and the counters of the cache of one disk. The block
+/// counters count blocks of BlockSize bytes, the device counters count the
+/// calls the cache made to the Block I/O protocol.
+///
+typedef struct {
+  UINT32    BlockSize;
+  ///
+  /// Number of blocks the cache holds.
+  ///
+  UINT32    CacheBlocks;
+  ///
+  /// Maximum number of modified blocks the cache holds before writing them
+  /// back, or 0 if the writes go through to the device.
+  ///
+  UINT32    MaxDirtyBlocks;
+  ///
+  /// Number of modified blocks not written back yet.
+  ///
+  UINT32    DirtyBlocks;
+  UINT64    ReadHits;
+  UINT64    ReadMisses;
+  UINT64    WriteHits;
+  UINT64    WriteMisses;
+  ///
+  /// Blocks read past the end of sequential read requests, and those of them
+  /// later read from the cache.
+  ///
+  UINT64    ReadAheadBlocks;
+  UINT64    ReadAheadHits;
+  UINT64    Evictions;
+  ///
+  /// Modified blocks written back to the device.
+  ///
+  UINT64    WriteBacks;
+  UINT64    DeviceReads;
+  UINT64    DeviceWrites;
+  ///
+  /// Requests that went to the device without the cache: non-blocking, too
+  /// large or invalid requests.
+  ///
+  UINT64    Bypasses;
+} EDKII_DISK_IO_CACHE_STATISTICS;
+
+/**
+  Get the configuration and the counters of the cache.
+
+  @param[in]  This              The EDKII_DISK_IO_CACHE_PROTOCOL instance.
+  @param[out] Statistics        The configuration and the counters of the cache.
+
+  @retval EFI_SUCCESS           The statistics were returned.
+  @retval EFI_INVALID_PARAMETER Statistics is NULL.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_DISK_IO_CACHE_GET_STATISTICS)(
+  IN  EDKII_DISK_IO_CACHE_PROTOCOL    *This,
+  OUT EDKII_DISK_IO_CACHE_STATISTICS  *Statistics
+  );
+
+/**
+  Reset the counters of the cache to 0.
+
+  @param[in]  This              The EDKII_DISK_IO_CACHE_PROTOCOL instance.
+
+  @retval EFI_SUCCESS           The counters were reset.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_DISK_IO_CACHE_RESET_STATISTICS)(
+  IN EDKII_DISK_IO_CACHE_PROTOCOL  *This
+  );
+
+/**
+  Write the modified blocks of the cache back to the device.
+
+  @param[in]  This              The EDKII_DISK_IO_CACHE_PROTOCOL instance.
+
+  @retval EFI_SUCCESS           All the modified blocks were written back.
+  @retval Others                The device reported an error while writing the
+                                blocks back.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_DISK_IO_CACHE_FLUSH)(
+  IN EDKII_DISK_IO_CACHE_PROTOCOL  *This
+  );
+
+/**
+  Write the modified blocks of the cache back to the device, then drop all
+  the blocks of the cache.
+
+  @param[in]  This              The EDKII_DISK_IO_CACHE_PROTOCOL instance.
+
+  @retval EFI_SUCCESS           The cache was written back and emptied.
+  @retval Others                The device reported an error while writing the
+                                blocks back. The cache was not emptied.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_DISK_IO_CACHE_INVALIDATE)(
+  IN EDKII_DISK_IO_CACHE_PROTOCOL  *This
+  );
+
+struct _EDKII_DISK_IO_CACHE_PROTOCOL {
+  UINT64                                  Revision;
+  EDKII_DISK_IO_CACHE_GET_STATISTICS      GetStatistics;
+  EDKII_DISK_IO_CACHE_RESET_STATISTICS    ResetStatistics;
+  EDKII_DISK_IO_CACHE_FLUSH               Flush;
+  EDKII_DISK_IO_CACHE_INVALIDATE          Invalidate;
+};
+
+extern EFI_GUID  gEdkiiDiskIoCacheProtocolGuid;
+
+#endif
@@ -0,0 +1,140 @@
+/** @file
+  Memory Telemetry protocol.
+
+  The DXE core produces this protocol to report the counters it keeps on every
+  pool and page allocation: allocations, frees and bytes per memory type and
+  per pool block size class, pool allocations that had to fall back to the page
+  allocator, and the time the pool and page locks were held. Unlike the memory
+  profile, the counters are always maintained and cost a few additions per
+  allocation.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef MEMORY_TELEMETRY_H_
+#define MEMORY_TELEMETRY_H_
+
+#define EDKII_MEMORY_TELEMETRY_PROTOCOL_GUID \
+  { 0x5d1e3a4c, 0x8b27, 0x4f90, { 0xb6, 0x1d, 0x2e, 0x94, 0x7c, 0x03, 0xa5, 0x68 } }
+
+typedef struct _EDKII_MEMORY_TELEMETRY_PROTOCOL EDKII_MEMORY_TELEMETRY_PROTOCOL;
+
+#define EDKII_MEMORY_TELEMETRY_SIGNATURE  SIGNATURE_32 ('M','T','E','L')
+#define EDKII_MEMORY_TELEMETRY_REVISION   0x0001
+
+///
+/// Counters of one lock of the memory services. The hold times are in ticks
+/// of the timer of the CPU Architectural Protocol, and are only measured once
+/// that protocol is installed.
+///
+typedef struct {
+  UINT64    Acquisitions;
+  UINT64    HoldTicks;
+  UINT64    MaxHoldTicks;
+} EDKII_MEMORY_TELEMETRY_LOCK;
+
+///
+/// Counters of one memory type. Pool bytes include the pool head and tail.
+/// Pool page fallbacks count the pool allocations that had to get pages from
+/// the page allocator, to back a pool bin or slab or a large allocation.
+/// Page counters only cover AllocatePages () and FreePages ().
+///
+typedef struct {
+  UINT32    MemoryType;
+  UINT32    Reserved;
+  UINT64    PoolAllocations;
+  UINT64    PoolFrees;
+  UINT64    PoolFailures;
+  UINT64    PoolBytesAllocated;
+  UINT64    PoolBytesFreed;
+  UINT64    PoolPageFallbacks;
+  UINT64    PageAllocations;
+  UINT64    PageFrees;
+  UINT64    PageFailures;
+  UINT64    PagesAllocated;
+  UINT64    PagesFreed;
+} EDKII_MEMORY_TELEMETRY_TYPE;
+
+///
+/// Counters of the pool blocks, of all memory types, whose size including the
+/// pool head and tail is greater than the MaxSize of the previous class and
+/// at most MaxSize.
+///
+typedef struct {
+  UINT64    MaxSize;
+  UINT64    Allocations;
+  UINT64    Frees;
+  UINT64    BytesAllocated;
+  UINT64    PageFallbacks;
+} EDKII_MEMORY_TELEMETRY_POOL_CLASS;
+
+///
+/// The data returned by GetData (). The header is followed by MemoryTypeCount
+/// EDKII_MEMORY_TELEMETRY_TYPE, then PoolClassCount
+/// EDKII_MEMORY_TELEMETRY_POOL_CLASS. The last memory type record accumulates
+/// all the OEM and OS reserved memory types, and has its MemoryType set to
+/// MEMORY_TYPE_OEM_RESERVED_MIN.
+///
+typedef struct {
+  UINT32                         Signature;
+  UINT16                         Length;
+  UINT16                         Revision;
+  UINT32                         MemoryTypeCount;
+  UINT32                         PoolClassCount;
+  ///
+  /// Period of a lock hold time tick, in femtoseconds, or 0 if no hold time
+  /// was measured.
+  ///
+  UINT64                         TimerPeriod;
+  EDKII_MEMORY_TELEMETRY_LOCK    PoolLock;
+  EDKII_MEMORY_TELEMETRY_LOCK    PageLock;
+} EDKII_MEMORY_TELEMETRY_HEADER;
+
+/**
+  Get a snapshot of the memory telemetry counters.
+
+  @param[in]      This          The EDKII_MEMORY_TELEMETRY_PROTOCOL instance.
+  @param[in, out] DataSize      On entry, the size of Data. On return, the size
+                                of the telemetry data.
+  @param[out]     Data          The buffer to receive the telemetry data,
+                                starting with EDKII_MEMORY_TELEMETRY_HEADER.
+
+  @retval EFI_SUCCESS           The telemetry data was returned.
+  @retval EFI_INVALID_PARAMETER DataSize is NULL, or Data is NULL and
+                                *DataSize is not 0.
+  @retval EFI_BUFFER_TOO_SMALL  *DataSize is too small; it was updated with the
+                                size needed.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_MEMORY_TELEMETRY_GET_DATA)(
+  IN     EDKII_MEMORY_TELEMETRY_PROTOCOL  *This,
+  IN OUT UINTN                            *DataSize,
+  OUT    VOID                             *Data
+  );
+
+/**
+  Reset all the memory telemetry counters to 0.
+
+  @param[in]  This              The EDKII_MEMORY_TELEMETRY_PROTOCOL instance.
+
+  @retval EFI_SUCCESS           The counters were reset.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_MEMORY_TELEMETRY_RESET)(
+  IN EDKII_MEMORY_TELEMETRY_PROTOCOL  *This
+  );
+
+struct _EDKII_MEMORY_TELEMETRY_PROTOCOL {
+  EDKII_MEMORY_TELEMETRY_GET_DATA    GetData;
+  EDKII_MEMORY_TELEMETRY_RESET       Reset;
+};
+
+extern EFI_GUID  gEdkiiMemoryTelemetryProtocolGuid;
+
+#endif
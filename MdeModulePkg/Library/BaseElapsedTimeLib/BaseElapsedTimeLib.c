@@ -0,0 +1,80 @@
+/** @file
+  Measure intervals with the performance counter of TimerLib.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+#include <Library/ElapsedTimeLib.h>
+#include <Library/TimerLib.h>
+
+/**
+  Return the number of performance counter ticks between two values read from
+  GetPerformanceCounter().
+
+  The counter may count up or down, and may roll over once between Start and
+  End.
+
+  @param  Start           The counter value at the start of the interval.
+  @param  End             The counter value at the end of the interval.
+
+  @return The number of ticks between Start and End.
+
+**/
+UINT64
+EFIAPI
+GetElapsedTicks (
+  IN UINT64  Start,
+  IN UINT64  End
+  )
+{
+  UINT64  CounterStart;
+  UINT64  CounterEnd;
+
+  GetPerformanceCounterProperties (&CounterStart, &CounterEnd);
+  if (CounterStart < CounterEnd) {
+    if (End >= Start) {
+      return End - Start;
+    }
+
+    //
+    // The counter rolled over from CounterEnd to CounterStart, which is one
+    // tick.
+    //
+    return (CounterEnd - Start) + (End - CounterStart) + 1;
+  }
+
+  if (Start >= End) {
+    return Start - End;
+  }
+
+  //
+  // The counter counts down, and rolled over from CounterEnd to CounterStart.
+  //
+  return (Start - CounterEnd) + (CounterStart - End) + 1;
+}
+
+/**
+  Return the time in nanoseconds between two values read from
+  GetPerformanceCounter().
+
+  The counter may count up or down, and may roll over once between Start and
+  End.
+
+  @param  Start           The counter value at the start of the interval.
+  @param  End             The counter value at the end of the interval.
+
+  @return The time between Start and End in nanoseconds.
+
+**/
+UINT64
+EFIAPI
+GetElapsedTimeInNanoSecond (
+  IN UINT64  Start,
+  IN UINT64  End
+  )
+{
+  return GetTimeInNanoSecond (GetElapsedTicks (Start, End));
+}
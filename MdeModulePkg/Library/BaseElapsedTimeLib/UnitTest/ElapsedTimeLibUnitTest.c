@@ -0,0 +1,234 @@
+/** @file
+  Unit tests of BaseElapsedTimeLib against simulated performance counters.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/ElapsedTimeLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_APP_NAME     "ElapsedTimeLib Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+//
+// Range of a simulated 24-bit counter, like the ACPI PM timer
+//
+#define TEST_COUNTER_24_MAX  0xFFFFFF
+
+STATIC UINT64  mCounterStart;
+STATIC UINT64  mCounterEnd;
+
+/**
+  Retrieves the 64-bit frequency in Hz and the range of the simulated
+  performance counter.
+
+  @param  StartValue  The value the performance counter starts with when it
+                      rolls over.
+  @param  EndValue    The value that the performance counter ends with before
+                      it rolls over.
+
+  @return The frequency in Hz.
+
+**/
+UINT64
+EFIAPI
+GetPerformanceCounterProperties (
+  OUT UINT64  *StartValue  OPTIONAL,
+  OUT UINT64  *EndValue    OPTIONAL
+  )
+{
+  if (StartValue != NULL) {
+    *StartValue = mCounterStart;
+  }
+
+  if (EndValue != NULL) {
+    *EndValue = mCounterEnd;
+  }
+
+  return 1000000000;
+}
+
+/**
+  Converts elapsed ticks of the simulated performance counter, which runs at
+  1 GHz, to time in nanoseconds.
+
+  @param  Ticks     The number of elapsed ticks.
+
+  @return The elapsed time in nanoseconds.
+
+**/
+UINT64
+EFIAPI
+GetTimeInNanoSecond (
+  IN UINT64  Ticks
+  )
+{
+  return Ticks;
+}
+
+/**
+  Measure the intervals of a counter that counts up.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The intervals were measured.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+CountUpIntervalsShouldBeMeasured (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  mCounterStart = 0;
+  mCounterEnd   = TEST_COUNTER_24_MAX;
+  UT_ASSERT_EQUAL (GetElapsedTicks (0x100, 0x100), 0);
+  UT_ASSERT_EQUAL (GetElapsedTicks (0x100, 0x180), 0x80);
+  UT_ASSERT_EQUAL (GetElapsedTicks (0, TEST_COUNTER_24_MAX), TEST_COUNTER_24_MAX);
+
+  //
+  // Rolling over from the end to the start of the range is one tick
+  //
+  UT_ASSERT_EQUAL (GetElapsedTicks (TEST_COUNTER_24_MAX, 0), 1);
+  UT_ASSERT_EQUAL (GetElapsedTicks (TEST_COUNTER_24_MAX - 0xF, 0x10), 0x20);
+  UT_ASSERT_EQUAL (GetElapsedTimeInNanoSecond (TEST_COUNTER_24_MAX - 0xF, 0x10), 0x20);
+
+  mCounterStart = 0x100;
+  mCounterEnd   = 0x1FF;
+  UT_ASSERT_EQUAL (GetElapsedTicks (0x1F0, 0x110), 0x20);
+
+  mCounterStart = 0;
+  mCounterEnd   = MAX_UINT64;
+  UT_ASSERT_EQUAL (GetElapsedTicks (MAX_UINT64 - 1, 1), 3);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Measure the intervals of a counter that counts down.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The intervals were measured.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+CountDownIntervalsShouldBeMeasured (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  mCounterStart = TEST_COUNTER_24_MAX;
+  mCounterEnd   = 0;
+  UT_ASSERT_EQUAL (GetElapsedTicks (0x100, 0x100), 0);
+  UT_ASSERT_EQUAL (GetElapsedTicks (0x180, 0x100), 0x80);
+  UT_ASSERT_EQUAL (GetElapsedTicks (TEST_COUNTER_24_MAX, 0), TEST_COUNTER_24_MAX);
+
+  //
+  // Rolling over from the end to the start of the range is one tick
+  //
+  UT_ASSERT_EQUAL (GetElapsedTicks (0, TEST_COUNTER_24_MAX), 1);
+  UT_ASSERT_EQUAL (GetElapsedTicks (0x10, TEST_COUNTER_24_MAX - 0xF), 0x20);
+  UT_ASSERT_EQUAL (GetElapsedTimeInNanoSecond (0x10, TEST_COUNTER_24_MAX - 0xF), 0x20);
+
+  mCounterStart = 0x1FF;
+  mCounterEnd   = 0x100;
+  UT_ASSERT_EQUAL (GetElapsedTicks (0x110, 0x1F0), 0x20);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for
+  BaseElapsedTimeLib and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      ElapsedTimeTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&ElapsedTimeTests, Framework, "Elapsed Time Tests", "ElapsedTimeLib", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for Elapsed Time Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // --------------Suite-----------Description----------------------------Name--------Function-----------------------------Pre---Post---Context-----------
+  //
+  AddTestCase (ElapsedTimeTests, "Intervals of a counter counting up", "CountUp", CountUpIntervalsShouldBeMeasured, NULL, NULL, NULL);
+  AddTestCase (ElapsedTimeTests, "Intervals of a counter counting down", "CountDown", CountDownIntervalsShouldBeMeasured, NULL, NULL, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define ElapsedTimeLibUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+ElapsedTimeLibUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
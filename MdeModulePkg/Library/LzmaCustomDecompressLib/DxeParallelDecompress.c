@@ -0,0 +1,82 @@
+/** @file
+  Run the LZMA parallel decompression on the BSP and on the APs through the
+  MP Services protocol.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiDxe.h>
+#include "LzmaDecompressLibInternal.h"
+#include <Protocol/MpService.h>
+#include <Library/UefiBootServicesTableLib.h>
+
+/**
+  Run a procedure on the BSP and on all the enabled APs, and wait for all of
+  them to finish.
+
+  The APs are started in non-blocking mode, so that the BSP runs the procedure
+  while they do. The MP Services protocol is only used up to TPL_CALLBACK, so
+  the sections decompressed from notification functions are decompressed on
+  the BSP.
+
+  @param  Procedure       The procedure to run.
+  @param  Argument        The argument passed to Procedure.
+
+  @retval  RETURN_SUCCESS Procedure ran on the BSP and on the APs.
+  @retval  others         The APs could not be started. Procedure did not run.
+**/
+RETURN_STATUS
+LzmaParallelStartupAllCpus (
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *Argument
+  )
+{
+  EFI_STATUS                Status;
+  EFI_MP_SERVICES_PROTOCOL  *MpServices;
+  EFI_TPL                   OldTpl;
+  EFI_EVENT                 Event;
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  gBS->RestoreTPL (OldTpl);
+  if (OldTpl > TPL_CALLBACK) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  Status = gBS->LocateProtocol (&gEfiMpServiceProtocolGuid, NULL, (VOID **)&MpServices);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &Event);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = MpServices->StartupAllAPs (
+                         MpServices,
+                         Procedure,
+                         FALSE,
+                         Event,
+                         0,
+                         Argument,
+                         NULL
+                         );
+  if (EFI_ERROR (Status)) {
+    gBS->CloseEvent (Event);
+    return Status;
+  }
+
+  Procedure (Argument);
+
+  //
+  // The event is signaled once all the APs returned from Procedure
+  //
+  while (gBS->CheckEvent (Event) == EFI_NOT_READY) {
+    CpuPause ();
+  }
+
+  gBS->CloseEvent (Event);
+  return RETURN_SUCCESS;
+}
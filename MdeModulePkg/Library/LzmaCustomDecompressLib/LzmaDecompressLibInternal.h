@@ -91,4 +91,24 @@ LzmaUefiDecompress (
   IN OUT VOID    *Scratch
   );
 
+/**
+  Run a procedure on the BSP and on all the enabled APs, and wait for all of
+  them to finish.
+
+  This function is implemented once per boot phase by the libraries producing
+  the LZMA_PARALLEL_CUSTOM_DECOMPRESS_GUID handler.
+
+  @param  Procedure       The procedure to run.
+  @param  Argument        The argument passed to Procedure.
+
+  @retval  RETURN_SUCCESS Procedure ran on the BSP and on the APs.
+  @retval  others         The APs could not be started. Procedure may not
+                          have run.
+**/
+RETURN_STATUS
+LzmaParallelStartupAllCpus (
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *Argument
+  );
+
 #endif
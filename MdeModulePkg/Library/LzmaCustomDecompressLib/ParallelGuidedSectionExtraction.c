@@ -0,0 +1,438 @@
+/** @file
+  LZMA Parallel Decompress GUIDed Section Extraction Library.
+  It decompresses the independent LZMA streams of a
+  LZMA_PARALLEL_CUSTOM_DECOMPRESS_GUID section on all the processors, and
+  registers its handlers into GUIDed handler table.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "LzmaDecompressLibInternal.h"
+#include "Sdk/C/7zTypes.h"
+#include "Sdk/C/LzmaDec.h"
+#include <Library/SynchronizationLib.h>
+
+#define LZMA_HEADER_SIZE  (LZMA_PROPS_SIZE + 8)
+
+//
+// Alignment of the scratch buffer of each chunk
+//
+#define LZMA_PARALLEL_SCRATCH_ALIGNMENT  8
+
+//
+// Size of the table of the stream offsets, at the start of the scratch buffer
+//
+#define LZMA_PARALLEL_OFFSET_TABLE_SIZE(ChunkCount) \
+  ALIGN_VALUE ((ChunkCount) * sizeof (UINT32), LZMA_PARALLEL_SCRATCH_ALIGNMENT)
+
+typedef struct {
+  CONST LZMA_PARALLEL_HEADER    *Header;
+  CONST UINT32                  *CompressedSize;
+  CONST UINT8                   *Streams;
+  UINT8                         *Destination;
+  UINT32                        *StreamOffset;
+  UINT8                         *Scratch;
+  UINT32                        ChunkScratchSize;
+  UINT32                        ScratchSize;
+  volatile UINT32               NextChunk;
+  volatile UINT32               Failed;
+} LZMA_PARALLEL_CONTEXT;
+
+/**
+  Get the data of a LZMA_PARALLEL_CUSTOM_DECOMPRESS_GUID section.
+
+  @param[in]  InputSection       A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] Data               The data of the section.
+  @param[out] DataSize           The size of the data of the section.
+  @param[out] SectionAttribute   The attributes of the GUIDed section.
+
+  @retval  RETURN_SUCCESS            The data of the section was returned.
+  @retval  RETURN_INVALID_PARAMETER  The GUID of the section does not match.
+
+**/
+STATIC
+RETURN_STATUS
+LzmaParallelGetSectionData (
+  IN  CONST VOID   *InputSection,
+  OUT CONST UINT8  **Data,
+  OUT UINT32       *DataSize,
+  OUT UINT16       *SectionAttribute
+  )
+{
+  if (IS_SECTION2 (InputSection)) {
+    if (!CompareGuid (
+           &gLzmaParallelCustomDecompressGuid,
+           &(((EFI_GUID_DEFINED_SECTION2 *)InputSection)->SectionDefinitionGuid)
+           ))
+    {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    *Data             = (UINT8 *)InputSection + ((EFI_GUID_DEFINED_SECTION2 *)InputSection)->DataOffset;
+    *DataSize         = SECTION2_SIZE (InputSection) - ((EFI_GUID_DEFINED_SECTION2 *)InputSection)->DataOffset;
+    *SectionAttribute = ((EFI_GUID_DEFINED_SECTION2 *)InputSection)->Attributes;
+  } else {
+    if (!CompareGuid (
+           &gLzmaParallelCustomDecompressGuid,
+           &(((EFI_GUID_DEFINED_SECTION *)InputSection)->SectionDefinitionGuid)
+           ))
+    {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    *Data             = (UINT8 *)InputSection + ((EFI_GUID_DEFINED_SECTION *)InputSection)->DataOffset;
+    *DataSize         = SECTION_SIZE (InputSection) - ((EFI_GUID_DEFINED_SECTION *)InputSection)->DataOffset;
+    *SectionAttribute = ((EFI_GUID_DEFINED_SECTION *)InputSection)->Attributes;
+  }
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Validate the chunk table of a LZMA_PARALLEL_CUSTOM_DECOMPRESS_GUID section
+  and set up a decompression context from it.
+
+  @param[in]  Data               The data of the section.
+  @param[in]  DataSize           The size of the data of the section.
+  @param[out] Context            The context to set up. Destination,
+                                 StreamOffset and Scratch are not set.
+
+  @retval  RETURN_SUCCESS            The section is valid.
+  @retval  RETURN_INVALID_PARAMETER  The section is corrupted.
+
+**/
+STATIC
+RETURN_STATUS
+LzmaParallelParse (
+  IN  CONST UINT8            *Data,
+  IN  UINT32                 DataSize,
+  OUT LZMA_PARALLEL_CONTEXT  *Context
+  )
+{
+  CONST LZMA_PARALLEL_HEADER  *Header;
+  CONST UINT8                 *Stream;
+  UINT32                      StreamsSize;
+  UINT32                      ChunkDecompressedSize;
+  UINT32                      ScratchSize;
+  UINT32                      OffsetTableSize;
+  UINT64                      Decompressed;
+  UINT32                      Index;
+  RETURN_STATUS               Status;
+
+  if (DataSize < sizeof (LZMA_PARALLEL_HEADER)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Header = (CONST LZMA_PARALLEL_HEADER *)Data;
+  if ((Header->Signature != LZMA_PARALLEL_SIGNATURE) ||
+      (Header->ChunkCount == 0) || (Header->ChunkSize == 0) ||
+      (Header->ChunkCount > (DataSize - sizeof (LZMA_PARALLEL_HEADER)) / sizeof (UINT32)))
+  {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Context->Header         = Header;
+  Context->CompressedSize = (CONST UINT32 *)(Header + 1);
+  Context->Streams        = (CONST UINT8 *)(Context->CompressedSize + Header->ChunkCount);
+  StreamsSize             = DataSize - (UINT32)(Context->Streams - Data);
+
+  //
+  // Every chunk but the last one must decompress to ChunkSize bytes, and all
+  // the streams must lie in the section
+  //
+  Stream       = Context->Streams;
+  Decompressed = 0;
+  ScratchSize  = 0;
+  for (Index = 0; Index < Header->ChunkCount; Index++) {
+    if ((Context->CompressedSize[Index] < LZMA_HEADER_SIZE) ||
+        (Context->CompressedSize[Index] > StreamsSize))
+    {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    Status = LzmaUefiDecompressGetInfo (
+               Stream,
+               Context->CompressedSize[Index],
+               &ChunkDecompressedSize,
+               &ScratchSize
+               );
+    if (RETURN_ERROR (Status)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    if (Index + 1 < Header->ChunkCount) {
+      if (ChunkDecompressedSize != Header->ChunkSize) {
+        return RETURN_INVALID_PARAMETER;
+      }
+    } else if ((ChunkDecompressedSize == 0) || (ChunkDecompressedSize > Header->ChunkSize)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    Decompressed += ChunkDecompressedSize;
+    Stream       += Context->CompressedSize[Index];
+    StreamsSize  -= Context->CompressedSize[Index];
+  }
+
+  if (Decompressed != Header->DecompressedSize) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  //
+  // The scratch buffer starts with the offset of every stream, followed by
+  // the scratch buffer of every chunk. ChunkCount is bounded by DataSize / 4,
+  // so the size of the offset table does not overflow.
+  //
+  ScratchSize     = ALIGN_VALUE (ScratchSize, LZMA_PARALLEL_SCRATCH_ALIGNMENT);
+  OffsetTableSize = (UINT32)LZMA_PARALLEL_OFFSET_TABLE_SIZE (Header->ChunkCount);
+  if (ScratchSize > (MAX_UINT32 - OffsetTableSize) / Header->ChunkCount) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Context->ChunkScratchSize = ScratchSize;
+  Context->ScratchSize      = OffsetTableSize + ScratchSize * Header->ChunkCount;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Decompress chunks of a LZMA_PARALLEL_CUSTOM_DECOMPRESS_GUID section until
+  none is left. Runs on the BSP and on the APs.
+
+  @param[in, out] Buffer         The LZMA_PARALLEL_CONTEXT.
+
+**/
+STATIC
+VOID
+EFIAPI
+LzmaParallelWorker (
+  IN OUT VOID  *Buffer
+  )
+{
+  LZMA_PARALLEL_CONTEXT  *Context;
+  UINT32                 Chunk;
+  RETURN_STATUS          Status;
+
+  Context = Buffer;
+
+  for ( ; ;) {
+    Chunk = InterlockedIncrement (&Context->NextChunk) - 1;
+    if ((Chunk >= Context->Header->ChunkCount) || (Context->Failed != 0)) {
+      break;
+    }
+
+    Status = LzmaUefiDecompress (
+               Context->Streams + Context->StreamOffset[Chunk],
+               Context->CompressedSize[Chunk],
+               Context->Destination + (UINTN)Chunk * Context->Header->ChunkSize,
+               Context->Scratch + (UINTN)Chunk * Context->ChunkScratchSize
+               );
+    if (RETURN_ERROR (Status)) {
+      Context->Failed = 1;
+    }
+  }
+}
+
+/**
+  Examines a GUIDed section and returns the size of the decoded buffer and the
+  size of an scratch buffer required to actually decode the data in a GUIDed section.
+
+  Examines a GUIDed section specified by InputSection.
+  If GUID for InputSection does not match the GUID that this handler supports,
+  then RETURN_UNSUPPORTED is returned.
+  If the required information can not be retrieved from InputSection,
+  then RETURN_INVALID_PARAMETER is returned.
+  If the GUID of InputSection does match the GUID that this handler supports,
+  then the size required to hold the decoded buffer is returned in OututBufferSize,
+  the size of an optional scratch buffer is returned in ScratchSize, and the Attributes field
+  from EFI_GUID_DEFINED_SECTION header of InputSection is returned in SectionAttribute.
+
+  If InputSection is NULL, then ASSERT().
+  If OutputBufferSize is NULL, then ASSERT().
+  If ScratchBufferSize is NULL, then ASSERT().
+  If SectionAttribute is NULL, then ASSERT().
+
+
+  @param[in]  InputSection       A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] OutputBufferSize   A pointer to the size, in bytes, of an output buffer required
+                                 if the buffer specified by InputSection were decoded.
+  @param[out] ScratchBufferSize  A pointer to the size, in bytes, required as scratch space
+                                 if the buffer specified by InputSection were decoded.
+  @param[out] SectionAttribute   A pointer to the attributes of the GUIDed section. See the Attributes
+                                 field of EFI_GUID_DEFINED_SECTION in the PI Specification.
+
+  @retval  RETURN_SUCCESS            The information about InputSection was returned.
+  @retval  RETURN_UNSUPPORTED        The section specified by InputSection does not match the GUID this handler supports.
+  @retval  RETURN_INVALID_PARAMETER  The information can not be retrieved from the section specified by InputSection.
+
+**/
+RETURN_STATUS
+EFIAPI
+LzmaParallelGuidedSectionGetInfo (
+  IN  CONST VOID  *InputSection,
+  OUT UINT32      *OutputBufferSize,
+  OUT UINT32      *ScratchBufferSize,
+  OUT UINT16      *SectionAttribute
+  )
+{
+  CONST UINT8            *Data;
+  UINT32                 DataSize;
+  LZMA_PARALLEL_CONTEXT  Context;
+  RETURN_STATUS          Status;
+
+  ASSERT (InputSection != NULL);
+  ASSERT (OutputBufferSize != NULL);
+  ASSERT (ScratchBufferSize != NULL);
+  ASSERT (SectionAttribute != NULL);
+
+  Status = LzmaParallelGetSectionData (InputSection, &Data, &DataSize, SectionAttribute);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = LzmaParallelParse (Data, DataSize, &Context);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // The scratch buffer holds the stream offsets, and every chunk gets its own
+  // scratch buffer in it
+  //
+  *OutputBufferSize  = Context.Header->DecompressedSize;
+  *ScratchBufferSize = Context.ScratchSize;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Decompress a LZMA parallel compressed GUIDed section into a caller allocated output buffer.
+
+  Decodes the GUIDed section specified by InputSection.
+  If GUID for InputSection does not match the GUID that this handler supports, then RETURN_UNSUPPORTED is returned.
+  If the data in InputSection can not be decoded, then RETURN_INVALID_PARAMETER is returned.
+  If the GUID of InputSection does match the GUID that this handler supports, then InputSection
+  is decoded into the buffer specified by OutputBuffer and the authentication status of this
+  decode operation is returned in AuthenticationStatus.  If the decoded buffer is identical to the
+  data in InputSection, then OutputBuffer is set to point at the data in InputSection.  Otherwise,
+  the decoded data will be placed in caller allocated buffer specified by OutputBuffer.
+
+  If InputSection is NULL, then ASSERT().
+  If OutputBuffer is NULL, then ASSERT().
+  If ScratchBuffer is NULL and this decode operation requires a scratch buffer, then ASSERT().
+  If AuthenticationStatus is NULL, then ASSERT().
+
+
+  @param[in]  InputSection  A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] OutputBuffer  A pointer to a buffer that contains the result of a decode operation.
+  @param[out] ScratchBuffer A caller allocated buffer that may be required by this function
+                            as a scratch buffer to perform the decode operation.
+  @param[out] AuthenticationStatus
+                            A pointer to the authentication status of the decoded output buffer.
+                            See the definition of authentication status in the EFI_PEI_GUIDED_SECTION_EXTRACTION_PPI
+                            section of the PI Specification. EFI_AUTH_STATUS_PLATFORM_OVERRIDE must
+                            never be set by this handler.
+
+  @retval  RETURN_SUCCESS            The buffer specified by InputSection was decoded.
+  @retval  RETURN_UNSUPPORTED        The section specified by InputSection does not match the GUID this handler supports.
+  @retval  RETURN_INVALID_PARAMETER  The section specified by InputSection can not be decoded.
+
+**/
+RETURN_STATUS
+EFIAPI
+LzmaParallelGuidedSectionExtraction (
+  IN CONST  VOID    *InputSection,
+  OUT       VOID    **OutputBuffer,
+  OUT       VOID    *ScratchBuffer         OPTIONAL,
+  OUT       UINT32  *AuthenticationStatus
+  )
+{
+  CONST UINT8            *Data;
+  UINT32                 DataSize;
+  UINT16                 SectionAttribute;
+  LZMA_PARALLEL_CONTEXT  Context;
+  RETURN_STATUS          Status;
+  BOOLEAN                OnAps;
+  UINT32                 Offset;
+  UINT32                 Index;
+
+  ASSERT (OutputBuffer != NULL);
+  ASSERT (InputSection != NULL);
+
+  Status = LzmaParallelGetSectionData (InputSection, &Data, &DataSize, &SectionAttribute);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = LzmaParallelParse (Data, DataSize, &Context);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  ASSERT (ScratchBuffer != NULL);
+
+  //
+  // Authentication is set to Zero, which may be ignored.
+  //
+  *AuthenticationStatus = 0;
+
+  Context.Destination  = *OutputBuffer;
+  Context.StreamOffset = ScratchBuffer;
+  Context.Scratch      = (UINT8 *)ScratchBuffer + LZMA_PARALLEL_OFFSET_TABLE_SIZE (Context.Header->ChunkCount);
+  Context.NextChunk    = 0;
+  Context.Failed       = 0;
+
+  //
+  // Locate every stream once, so that the workers find their stream in
+  // constant time
+  //
+  Offset = 0;
+  for (Index = 0; Index < Context.Header->ChunkCount; Index++) {
+    Context.StreamOffset[Index] = Offset;
+    Offset                     += Context.CompressedSize[Index];
+  }
+
+  //
+  // The BSP and the APs take chunks until none is left. The BSP then
+  // decompresses the chunks left, which are all of them if the APs could not
+  // run.
+  //
+  OnAps = FALSE;
+  if (Context.Header->ChunkCount > 1) {
+    OnAps = !RETURN_ERROR (LzmaParallelStartupAllCpus (LzmaParallelWorker, &Context));
+  }
+
+  LzmaParallelWorker (&Context);
+
+  DEBUG ((
+    DEBUG_INFO,
+    "LzmaParallel: %u chunks decompressed %a\n",
+    Context.Header->ChunkCount,
+    OnAps ? "on all the processors" : "on the BSP"
+    ));
+
+  if (Context.Failed != 0) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Register LzmaParallelGuidedSectionGetInfo and LzmaParallelGuidedSectionExtraction
+  handlers with LzmaParallelCustomDecompressGuid.
+
+  @retval  RETURN_SUCCESS            Register successfully.
+  @retval  RETURN_OUT_OF_RESOURCES   No enough memory to store this handler.
+**/
+EFI_STATUS
+EFIAPI
+LzmaParallelDecompressLibConstructor (
+  VOID
+  )
+{
+  return ExtractGuidedSectionRegisterHandlers (
+           &gLzmaParallelCustomDecompressGuid,
+           LzmaParallelGuidedSectionGetInfo,
+           LzmaParallelGuidedSectionExtraction
+           );
+}
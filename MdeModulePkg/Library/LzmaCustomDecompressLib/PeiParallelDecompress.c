@@ -0,0 +1,49 @@
+/** @file
+  Run the LZMA parallel decompression on the BSP and on the APs through the
+  PEI MP Services 2 PPI.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "LzmaDecompressLibInternal.h"
+#include <Ppi/MpServices2.h>
+#include <Library/PeiServicesLib.h>
+
+/**
+  Run a procedure on the BSP and on all the enabled APs, and wait for all of
+  them to finish.
+
+  StartupAllCPUs() runs the procedure on the BSP while the APs run it. The APs
+  are only available once the MP Services 2 PPI is installed, which is after
+  the permanent memory was installed.
+
+  @param  Procedure       The procedure to run.
+  @param  Argument        The argument passed to Procedure.
+
+  @retval  RETURN_SUCCESS Procedure ran on the BSP and on the APs.
+  @retval  others         The APs could not be started. Procedure may not
+                          have run.
+**/
+RETURN_STATUS
+LzmaParallelStartupAllCpus (
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *Argument
+  )
+{
+  EFI_STATUS                Status;
+  EFI_PEI_MP_SERVICES2_PPI  *MpServices;
+
+  Status = PeiServicesLocatePpi (
+             &gEfiPeiMpServices2PpiGuid,
+             0,
+             NULL,
+             (VOID **)&MpServices
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return MpServices->StartupAllCPUs (MpServices, Procedure, 0, Argument);
+}
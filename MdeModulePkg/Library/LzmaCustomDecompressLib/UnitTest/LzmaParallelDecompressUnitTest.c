@@ -0,0 +1,542 @@
+/** @file
+  Unit tests of the LZMA parallel decompress GUIDed section handler, run
+  against sections produced by LzmaCompress --chunked.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../LzmaDecompressLibInternal.h"
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_APP_NAME     "LZMA Parallel Decompress Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+//
+// Number of processors simulated by LzmaParallelStartupAllCpus()
+//
+#define TEST_CPU_COUNT  4
+
+//
+// Sizes of the data compressed into mMultiChunkData and mSingleChunkData
+//
+#define TEST_MULTI_CHUNK_SIZE   2600
+#define TEST_SINGLE_CHUNK_SIZE  700
+
+//
+// Number of corruptions applied by CorruptHeaderShouldBeRejected()
+//
+#define TEST_CORRUPTION_COUNT  10
+
+RETURN_STATUS
+EFIAPI
+LzmaParallelGuidedSectionGetInfo (
+  IN  CONST VOID  *InputSection,
+  OUT UINT32      *OutputBufferSize,
+  OUT UINT32      *ScratchBufferSize,
+  OUT UINT16      *SectionAttribute
+  );
+
+RETURN_STATUS
+EFIAPI
+LzmaParallelGuidedSectionExtraction (
+  IN CONST  VOID    *InputSection,
+  OUT       VOID    **OutputBuffer,
+  OUT       VOID    *ScratchBuffer         OPTIONAL,
+  OUT       UINT32  *AuthenticationStatus
+  );
+
+//
+// TestPattern (TEST_MULTI_CHUNK_SIZE) compressed by
+// "LzmaCompress -e --chunked --chunk-size 1": 3 chunks of 1 KB at most.
+//
+STATIC CONST UINT8  mMultiChunkData[] = {
+  0x4c, 0x5a, 0x4d, 0x50, 0x03, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00,
+  0x28, 0x0a, 0x00, 0x00, 0x48, 0x00, 0x00, 0x00, 0x48, 0x00, 0x00, 0x00,
+  0x44, 0x00, 0x00, 0x00, 0x5d, 0x00, 0x00, 0x00, 0x01, 0x00, 0x04, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x26, 0x16, 0x85, 0xbc, 0x45, 0xf1,
+  0x1e, 0x5a, 0xb0, 0x98, 0xe2, 0xca, 0x89, 0x38, 0x93, 0x6f, 0x4d, 0x36,
+  0x05, 0x0f, 0x56, 0xe6, 0xd6, 0xcc, 0x47, 0x55, 0x62, 0xbd, 0x5b, 0x85,
+  0x52, 0x1e, 0xd3, 0x02, 0x02, 0xc6, 0xde, 0xd0, 0xe5, 0xdd, 0x24, 0x50,
+  0xe4, 0xbb, 0x04, 0xd7, 0xfb, 0x4d, 0x70, 0x01, 0x82, 0x11, 0xe6, 0xb3,
+  0x4f, 0x29, 0x00, 0x00, 0x5d, 0x00, 0x00, 0x00, 0x01, 0x00, 0x04, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x36, 0x88, 0x4a, 0x86, 0xa3, 0xce,
+  0x88, 0xe9, 0xdd, 0x51, 0x16, 0xf8, 0x63, 0x7e, 0x56, 0xee, 0xab, 0xb9,
+  0x8d, 0x05, 0x68, 0x44, 0xd3, 0x8c, 0x32, 0x91, 0x9f, 0xaf, 0x61, 0xae,
+  0xb0, 0x7f, 0x2d, 0x22, 0xdb, 0x2e, 0xb9, 0xc5, 0xce, 0x40, 0x07, 0xb7,
+  0x18, 0xb7, 0xae, 0x3d, 0x7b, 0x37, 0x06, 0xb4, 0x52, 0x12, 0x2d, 0x9b,
+  0x2e, 0x7d, 0x70, 0x00, 0x5d, 0x00, 0x00, 0x00, 0x01, 0x28, 0x02, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x27, 0x90, 0xc0, 0x46, 0x11, 0x69,
+  0xed, 0xb8, 0xb9, 0xaa, 0x88, 0x85, 0x67, 0x79, 0x57, 0xae, 0x06, 0x5f,
+  0x2e, 0x2f, 0x84, 0x82, 0x0f, 0xb2, 0xba, 0x6d, 0x3a, 0xae, 0x4b, 0xa4,
+  0xa0, 0xb9, 0x50, 0x24, 0x8d, 0x61, 0x4e, 0x56, 0xf4, 0xf4, 0x57, 0x39,
+  0x61, 0x73, 0xe9, 0x05, 0x4e, 0xce, 0x9d, 0x36, 0x54, 0x9c, 0x94, 0x00
+};
+
+//
+// TestPattern (TEST_SINGLE_CHUNK_SIZE) compressed by
+// "LzmaCompress -e --chunked --chunk-size 1": a single chunk.
+//
+STATIC CONST UINT8  mSingleChunkData[] = {
+  0x4c, 0x5a, 0x4d, 0x50, 0x01, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00,
+  0xbc, 0x02, 0x00, 0x00, 0x2f, 0x00, 0x00, 0x00, 0x5d, 0x00, 0x00, 0x00,
+  0x01, 0xbc, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x26, 0x16,
+  0x85, 0xbc, 0x45, 0xf1, 0x1e, 0x5a, 0xb0, 0x98, 0xe2, 0xca, 0x89, 0x38,
+  0x93, 0x6f, 0x4d, 0x36, 0x05, 0x0f, 0x56, 0xe6, 0xd6, 0xcc, 0x47, 0x55,
+  0x62, 0xbd, 0x5b, 0x74, 0xa8, 0x00, 0x00
+};
+
+STATIC RETURN_STATUS  mStartupStatus;
+STATIC UINTN          mStartupCount;
+
+/**
+  Run a procedure on the BSP and on all the enabled APs, and wait for all of
+  them to finish.
+
+  The processors are simulated by running Procedure TEST_CPU_COUNT times in a
+  row, unless mStartupStatus reports that the APs could not be started.
+
+  @param  Procedure       The procedure to run.
+  @param  Argument        The argument passed to Procedure.
+
+  @return mStartupStatus
+**/
+RETURN_STATUS
+LzmaParallelStartupAllCpus (
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *Argument
+  )
+{
+  UINTN  Index;
+
+  mStartupCount++;
+  if (RETURN_ERROR (mStartupStatus)) {
+    return mStartupStatus;
+  }
+
+  for (Index = 0; Index < TEST_CPU_COUNT; Index++) {
+    Procedure (Argument);
+  }
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Register a GUIDed section handler. The tests call the handlers directly.
+
+  @param[in]  SectionGuid    The GUID of the sections to handle.
+  @param[in]  GetInfoHandler The GetInfo handler.
+  @param[in]  DecodeHandler  The decode handler.
+
+  @retval  RETURN_SUCCESS    Always.
+**/
+RETURN_STATUS
+EFIAPI
+ExtractGuidedSectionRegisterHandlers (
+  IN CONST  GUID                                     *SectionGuid,
+  IN        EXTRACT_GUIDED_SECTION_GET_INFO_HANDLER  GetInfoHandler,
+  IN        EXTRACT_GUIDED_SECTION_DECODE_HANDLER    DecodeHandler
+  )
+{
+  return RETURN_SUCCESS;
+}
+
+/**
+  Fill a buffer with the data compressed into the test sections.
+
+  @param  Buffer        The buffer to fill.
+  @param  Size          The size of Buffer in bytes.
+
+**/
+STATIC
+VOID
+TestPattern (
+  OUT UINT8  *Buffer,
+  IN  UINTN  Size
+  )
+{
+  STATIC CONST CHAR8  Text[] = "LZMA parallel section ";
+  UINTN               Index;
+
+  for (Index = 0; Index < Size; Index++) {
+    Buffer[Index] = (UINT8)(Text[Index % (sizeof (Text) - 1)] + Index / 700);
+  }
+}
+
+/**
+  Build a LZMA_PARALLEL_CUSTOM_DECOMPRESS_GUID section holding some data.
+
+  @param  Data          The data of the section.
+  @param  DataSize      The size of Data in bytes.
+
+  @return The section, to be freed with FreePool().
+**/
+STATIC
+EFI_GUID_DEFINED_SECTION *
+TestBuildSection (
+  IN CONST UINT8  *Data,
+  IN UINTN        DataSize
+  )
+{
+  EFI_GUID_DEFINED_SECTION  *Section;
+  UINT32                    SectionSize;
+
+  SectionSize = (UINT32)(sizeof (*Section) + DataSize);
+  Section     = AllocatePool (SectionSize);
+  if (Section == NULL) {
+    return NULL;
+  }
+
+  Section->CommonHeader.Size[0] = (UINT8)SectionSize;
+  Section->CommonHeader.Size[1] = (UINT8)(SectionSize >> 8);
+  Section->CommonHeader.Size[2] = (UINT8)(SectionSize >> 16);
+  Section->CommonHeader.Type    = EFI_SECTION_GUID_DEFINED;
+  CopyGuid (&Section->SectionDefinitionGuid, &gLzmaParallelCustomDecompressGuid);
+  Section->DataOffset = sizeof (*Section);
+  Section->Attributes = EFI_GUIDED_SECTION_PROCESSING_REQUIRED;
+  CopyMem (Section + 1, Data, DataSize);
+  return Section;
+}
+
+/**
+  Decompress a section and check its data against TestPattern().
+
+  @param  Section       The section to decompress.
+  @param  ExpectedSize  The size of the data compressed into Section.
+
+  @retval  UNIT_TEST_PASSED              The section decompressed to the
+                                         expected data.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED   The section did not decompress to
+                                         the expected data.
+**/
+STATIC
+UNIT_TEST_STATUS
+TestRoundTrip (
+  IN EFI_GUID_DEFINED_SECTION  *Section,
+  IN UINT32                    ExpectedSize
+  )
+{
+  RETURN_STATUS  Status;
+  UINT32         OutputSize;
+  UINT32         ScratchSize;
+  UINT16         Attributes;
+  UINT32         AuthenticationStatus;
+  UINT8          *Expected;
+  VOID           *Output;
+  VOID           *Scratch;
+
+  Status = LzmaParallelGuidedSectionGetInfo (Section, &OutputSize, &ScratchSize, &Attributes);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (OutputSize, ExpectedSize);
+  UT_ASSERT_EQUAL (Attributes, EFI_GUIDED_SECTION_PROCESSING_REQUIRED);
+
+  Expected = AllocatePool (OutputSize);
+  Output   = AllocatePool (OutputSize);
+  Scratch  = AllocatePool (ScratchSize);
+  UT_ASSERT_NOT_NULL (Expected);
+  UT_ASSERT_NOT_NULL (Output);
+  UT_ASSERT_NOT_NULL (Scratch);
+
+  //
+  // The handler must not rely on the content of the buffers it is given
+  //
+  SetMem (Output, OutputSize, 0xCC);
+  SetMem (Scratch, ScratchSize, 0xCC);
+  TestPattern (Expected, OutputSize);
+
+  Status = LzmaParallelGuidedSectionExtraction (Section, &Output, Scratch, &AuthenticationStatus);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_EQUAL (AuthenticationStatus, 0);
+  UT_ASSERT_MEM_EQUAL (Output, Expected, OutputSize);
+
+  FreePool (Scratch);
+  FreePool (Output);
+  FreePool (Expected);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Decompress a section of several chunks on the simulated processors.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The section was decompressed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+MultiChunkShouldRoundTrip (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_GUID_DEFINED_SECTION  *Section;
+  UNIT_TEST_STATUS          TestStatus;
+
+  Section = TestBuildSection (mMultiChunkData, sizeof (mMultiChunkData));
+  UT_ASSERT_NOT_NULL (Section);
+  UT_ASSERT_EQUAL (((LZMA_PARALLEL_HEADER *)(Section + 1))->ChunkCount, 3);
+
+  mStartupStatus = RETURN_SUCCESS;
+  mStartupCount  = 0;
+  TestStatus     = TestRoundTrip (Section, TEST_MULTI_CHUNK_SIZE);
+  UT_ASSERT_EQUAL (TestStatus, UNIT_TEST_PASSED);
+  UT_ASSERT_EQUAL (mStartupCount, 1);
+
+  FreePool (Section);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Decompress a section of several chunks on the BSP alone, when the APs can
+  not be started.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The section was decompressed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+MultiChunkShouldRoundTripOnBsp (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_GUID_DEFINED_SECTION  *Section;
+  UNIT_TEST_STATUS          TestStatus;
+
+  Section = TestBuildSection (mMultiChunkData, sizeof (mMultiChunkData));
+  UT_ASSERT_NOT_NULL (Section);
+
+  mStartupStatus = RETURN_UNSUPPORTED;
+  mStartupCount  = 0;
+  TestStatus     = TestRoundTrip (Section, TEST_MULTI_CHUNK_SIZE);
+  UT_ASSERT_EQUAL (TestStatus, UNIT_TEST_PASSED);
+  UT_ASSERT_EQUAL (mStartupCount, 1);
+
+  FreePool (Section);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Decompress a section of a single chunk, which does not start the APs.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The section was decompressed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+SingleChunkShouldRoundTrip (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_GUID_DEFINED_SECTION  *Section;
+  UNIT_TEST_STATUS          TestStatus;
+
+  Section = TestBuildSection (mSingleChunkData, sizeof (mSingleChunkData));
+  UT_ASSERT_NOT_NULL (Section);
+  UT_ASSERT_EQUAL (((LZMA_PARALLEL_HEADER *)(Section + 1))->ChunkCount, 1);
+
+  mStartupStatus = RETURN_SUCCESS;
+  mStartupCount  = 0;
+  TestStatus     = TestRoundTrip (Section, TEST_SINGLE_CHUNK_SIZE);
+  UT_ASSERT_EQUAL (TestStatus, UNIT_TEST_PASSED);
+  UT_ASSERT_EQUAL (mStartupCount, 0);
+
+  FreePool (Section);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Reject the sections whose header or chunk table is corrupted, in both the
+  GetInfo and the decode handlers.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             All the corrupted sections were
+                                        rejected.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+CorruptHeaderShouldBeRejected (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_GUID_DEFINED_SECTION  *Section;
+  LZMA_PARALLEL_HEADER      *Header;
+  UINT32                    *CompressedSize;
+  UINT32                    OutputSize;
+  UINT32                    ScratchSize;
+  UINT16                    Attributes;
+  UINT32                    AuthenticationStatus;
+  UINT8                     Output[TEST_MULTI_CHUNK_SIZE];
+  VOID                      *OutputBuffer;
+  UINT8                     Scratch[64];
+  UINTN                     Corruption;
+
+  mStartupStatus = RETURN_SUCCESS;
+  mStartupCount  = 0;
+
+  for (Corruption = 0; Corruption < TEST_CORRUPTION_COUNT; Corruption++) {
+    Section = TestBuildSection (mMultiChunkData, sizeof (mMultiChunkData));
+    UT_ASSERT_NOT_NULL (Section);
+    Header         = (LZMA_PARALLEL_HEADER *)(Section + 1);
+    CompressedSize = (UINT32 *)(Header + 1);
+
+    switch (Corruption) {
+      case 0:
+        Header->Signature = SIGNATURE_32 ('L', 'Z', 'M', 'A');
+        break;
+      case 1:
+        Header->ChunkCount = 0;
+        break;
+      case 2:
+        //
+        // The chunk table does not fit in the section
+        //
+        Header->ChunkCount = sizeof (mMultiChunkData) / sizeof (UINT32);
+        break;
+      case 3:
+        Header->ChunkSize = 0;
+        break;
+      case 4:
+        //
+        // The first chunks do not decompress to ChunkSize bytes
+        //
+        Header->ChunkSize *= 2;
+        break;
+      case 5:
+        Header->DecompressedSize++;
+        break;
+      case 6:
+        //
+        // A stream runs past the end of the section
+        //
+        CompressedSize[1] = sizeof (mMultiChunkData);
+        break;
+      case 7:
+        CompressedSize[2]++;
+        break;
+      case 8:
+        //
+        // A stream is shorter than the LZMA header
+        //
+        CompressedSize[0] = 4;
+        break;
+      default:
+        Section->SectionDefinitionGuid.Data1++;
+        break;
+    }
+
+    UT_ASSERT_STATUS_EQUAL (
+      LzmaParallelGuidedSectionGetInfo (Section, &OutputSize, &ScratchSize, &Attributes),
+      RETURN_INVALID_PARAMETER
+      );
+
+    OutputBuffer = Output;
+    UT_ASSERT_STATUS_EQUAL (
+      LzmaParallelGuidedSectionExtraction (Section, &OutputBuffer, Scratch, &AuthenticationStatus),
+      RETURN_INVALID_PARAMETER
+      );
+
+    FreePool (Section);
+  }
+
+  UT_ASSERT_EQUAL (mStartupCount, 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  LZMA parallel decompress handler and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      LzmaParallelTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&LzmaParallelTests, Framework, "LZMA Parallel Decompress Tests", "LzmaParallel", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for LZMA Parallel Decompress Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // --------------Suite----------------Description-------------------------------------Name-------------------Function-------------------------Pre---Post---Context-----------
+  //
+  AddTestCase (LzmaParallelTests, "Several chunks round trip on all the processors", "MultiChunk", MultiChunkShouldRoundTrip, NULL, NULL, NULL);
+  AddTestCase (LzmaParallelTests, "Several chunks round trip on the BSP alone", "MultiChunkOnBsp", MultiChunkShouldRoundTripOnBsp, NULL, NULL, NULL);
+  AddTestCase (LzmaParallelTests, "A single chunk round trips", "SingleChunk", SingleChunkShouldRoundTrip, NULL, NULL, NULL);
+  AddTestCase (LzmaParallelTests, "Corrupted headers are rejected", "CorruptHeader", CorruptHeaderShouldBeRejected, NULL, NULL, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define LzmaParallelDecompressUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+LzmaParallelDecompressUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
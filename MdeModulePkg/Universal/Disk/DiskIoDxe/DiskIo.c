@@ -9,7 +9,7 @@
     Aligned  - A read of N contiguous sectors.
     OverRun  - The last byte is not on a sector boundary.
 
-Copyright (c) 2006 - 2018, Intel Corporation. All rights reserved.<BR>
+Copyright (c) 2006 - 2026, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
@@ -186,6 +186,8 @@ DiskIoDriverBindingStart (
     goto ErrorExit;
   }
 
+  DiskIoCacheCreate (Instance);
+
   //
   // Install protocol interfaces for the Disk IO device.
   //
@@ -207,6 +209,23 @@ DiskIoDriverBindingStart (
                     );
   }
 
+  if (!EFI_ERROR (Status) && (Instance->Cache != NULL)) {
+    Status = gBS->InstallProtocolInterface (
+                    &ControllerHandle,
+                    &gEdkiiDiskIoCacheProtocolGuid,
+                    EFI_NATIVE_INTERFACE,
+                    &Instance->Cache->Protocol
+                    );
+    if (EFI_ERROR (Status)) {
+      //
+      // The Disk IO protocols are installed, keep them without the cache.
+      //
+      DEBUG ((DEBUG_WARN, "DiskIo: Failed to install the Disk IO Cache protocol - %r\n", Status));
+      DiskIoCacheDestroy (Instance);
+      Status = EFI_SUCCESS;
+    }
+  }
+
 ErrorExit:
   if (EFI_ERROR (Status)) {
     if ((Instance != NULL) && (Instance->SharedWorkingBuffer != NULL)) {
@@ -217,6 +236,7 @@ ErrorExit:
     }
 
     if (Instance != NULL) {
+      DiskIoCacheDestroy (Instance);
       FreePool (Instance);
     }
 
@@ -291,6 +311,24 @@ DiskIoDriverBindingStop (
 
   Instance = DISK_IO_PRIVATE_DATA_FROM_DISK_IO (DiskIo);
 
+  if (Instance->Cache != NULL) {
+    //
+    // Write the modified blocks back while the Block IO protocol is open.
+    //
+    EfiAcquireLock (&Instance->Cache->Lock);
+    DiskIoCacheWriteBack (Instance->Cache);
+    EfiReleaseLock (&Instance->Cache->Lock);
+
+    Status = gBS->UninstallProtocolInterface (
+                    ControllerHandle,
+                    &gEdkiiDiskIoCacheProtocolGuid,
+                    &Instance->Cache->Protocol
+                    );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
   if (DiskIo2 != NULL) {
     //
     // Call BlockIo2::Reset() to terminate any in-flight non-blocking I/O requests
@@ -298,7 +336,7 @@ DiskIoDriverBindingStop (
     ASSERT (Instance->BlockIo2 != NULL);
     Status = Instance->BlockIo2->Reset (Instance->BlockIo2, FALSE);
     if (EFI_ERROR (Status)) {
-      return Status;
+      goto ErrorExit;
     }
 
     Status = gBS->UninstallMultipleProtocolInterfaces (
@@ -325,6 +363,7 @@ DiskIoDriverBindingStop (
       EfiReleaseLock (&Instance->TaskQueueLock);
     } while (!AllTaskDone);
 
+    DiskIoCacheDestroy (Instance);
     FreeAlignedPages (
       Instance->SharedWorkingBuffer,
       EFI_SIZE_TO_PAGES (PcdGet32 (PcdDiskIoDataBufferBlockNum) * Instance->BlockIo->Media->BlockSize)
@@ -348,6 +387,20 @@ DiskIoDriverBindingStop (
     }
 
     FreePool (Instance);
+    return Status;
+  }
+
+ErrorExit:
+  if (Instance->Cache != NULL) {
+    //
+    // The Disk IO protocols are still in use, so is the cache.
+    //
+    gBS->InstallProtocolInterface (
+           &ControllerHandle,
+           &gEdkiiDiskIoCacheProtocolGuid,
+           EFI_NATIVE_INTERFACE,
+           &Instance->Cache->Protocol
+           );
   }
 
   return Status;
@@ -814,7 +867,7 @@ DiskIo2RemoveCompletedTask (
 }
 
 /**
-  Common routine to access the disk.
+  Read/Write data from/to the device, without the cache.
 
   @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
   @param Write       TRUE: Write operation; FALSE: Read operation.
@@ -827,7 +880,7 @@ DiskIo2RemoveCompletedTask (
                                 The caller is responsible either having implicit or explicit ownership of the buffer.
 **/
 EFI_STATUS
-DiskIo2ReadWriteDisk (
+DiskIo2ReadWriteDiskUncached (
   IN DISK_IO_PRIVATE_DATA  *Instance,
   IN BOOLEAN               Write,
   IN UINT32                MediaId,
@@ -1019,6 +1072,50 @@ DiskIo2ReadWriteDisk (
   return Status;
 }
 
+/**
+  Common routine to access the disk.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Write       TRUE: Write operation; FALSE: Read operation.
+  @param MediaId     ID of the medium to access.
+  @param Offset      The starting byte offset on the logical block I/O device to access.
+  @param Token       A pointer to the token associated with the transaction.
+                     If this field is NULL, synchronous/blocking IO is performed.
+  @param  BufferSize            The size in bytes of Buffer. The number of bytes to read from the device.
+  @param  Buffer                A pointer to the destination buffer for the data.
+                                The caller is responsible either having implicit or explicit ownership of the buffer.
+**/
+EFI_STATUS
+DiskIo2ReadWriteDisk (
+  IN DISK_IO_PRIVATE_DATA  *Instance,
+  IN BOOLEAN               Write,
+  IN UINT32                MediaId,
+  IN UINT64                Offset,
+  IN EFI_DISK_IO2_TOKEN    *Token,
+  IN UINTN                 BufferSize,
+  IN UINT8                 *Buffer
+  )
+{
+  EFI_STATUS  Status;
+
+  if (Instance->Cache == NULL) {
+    return DiskIo2ReadWriteDiskUncached (Instance, Write, MediaId, Offset, Token, BufferSize, Buffer);
+  }
+
+  //
+  // Hold the cache lock while accessing the device directly, so that the
+  // blocks are not read into the cache in the meantime.
+  //
+  EfiAcquireLock (&Instance->Cache->Lock);
+  if (!DiskIoCacheReadWrite (Instance, Write, MediaId, Offset, Token, BufferSize, Buffer, &Status)) {
+    Status = DiskIo2ReadWriteDiskUncached (Instance, Write, MediaId, Offset, Token, BufferSize, Buffer);
+  }
+
+  EfiReleaseLock (&Instance->Cache->Lock);
+
+  return Status;
+}
+
 /**
   Reads a specified number of bytes from a device.
 
@@ -1160,6 +1257,15 @@ DiskIo2FlushDiskEx (
 
   Private = DISK_IO_PRIVATE_DATA_FROM_DISK_IO2 (This);
 
+  if (Private->Cache != NULL) {
+    EfiAcquireLock (&Private->Cache->Lock);
+    Status = DiskIoCacheWriteBack (Private->Cache);
+    EfiReleaseLock (&Private->Cache->Lock);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
   if ((Token != NULL) && (Token->Event != NULL)) {
     Task = AllocatePool (sizeof (DISK_IO2_FLUSH_TASK));
     if (Task == NULL) {
@@ -1,7 +1,7 @@
 /** @file
   Master header file for DiskIo driver. It includes the module private defininitions.
 
-Copyright (c) 2006 - 2018, Intel Corporation. All rights reserved.<BR>
+Copyright (c) 2006 - 2026, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
@@ -16,6 +16,9 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/ComponentName.h>
 #include <Protocol/DriverBinding.h>
 #include <Protocol/DiskIo.h>
+#include <Protocol/DiskIoCache.h>
+#include <Protocol/ResetNotification.h>
+#include <Guid/EventGroup.h>
 #include <Library/DebugLib.h>
 #include <Library/UefiDriverEntryPoint.h>
 #include <Library/UefiLib.h>
@@ -24,6 +27,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 
+typedef struct _DISK_IO_CACHE DISK_IO_CACHE;
+
 #define DISK_IO_PRIVATE_DATA_SIGNATURE  SIGNATURE_32 ('d', 's', 'k', 'I')
 typedef struct {
   UINT32                    Signature;
@@ -37,6 +42,8 @@ typedef struct {
 
   EFI_LOCK                  TaskQueueLock;
   LIST_ENTRY                TaskQueue;
+
+  DISK_IO_CACHE             *Cache;               /// < NULL when the blocks are not cached
 } DISK_IO_PRIVATE_DATA;
 #define DISK_IO_PRIVATE_DATA_FROM_DISK_IO(a)   CR (a, DISK_IO_PRIVATE_DATA, DiskIo,  DISK_IO_PRIVATE_DATA_SIGNATURE)
 #define DISK_IO_PRIVATE_DATA_FROM_DISK_IO2(a)  CR (a, DISK_IO_PRIVATE_DATA, DiskIo2, DISK_IO_PRIVATE_DATA_SIGNATURE)
@@ -82,6 +89,56 @@ typedef struct {
   EFI_BLOCK_IO2_TOKEN    BlockIo2Token;
 } DISK_IO_SUBTASK;
 
+//
+// One block of the cache. The cached blocks are kept in a hash table by LBA,
+// and in a list from the most to the least recently used, the unused blocks
+// being at the end of the list.
+//
+typedef struct {
+  LIST_ENTRY    LruLink;
+  LIST_ENTRY    HashLink;
+  LIST_ENTRY    DirtyLink;
+  UINT64        Lba;
+  UINT8         *Data;
+  BOOLEAN       Valid;
+  BOOLEAN       Dirty;
+  BOOLEAN       ReadAhead;                      /// < Read ahead and not accessed yet
+} DISK_IO_CACHE_BLOCK;
+
+#define DISK_IO_CACHE_SIGNATURE  SIGNATURE_32 ('d', 'i', 'c', 'a')
+struct _DISK_IO_CACHE {
+  UINT32                            Signature;
+  EDKII_DISK_IO_CACHE_PROTOCOL      Protocol;
+  DISK_IO_PRIVATE_DATA              *Instance;
+  LIST_ENTRY                        WriteBackLink;        /// < Link in the list of the write-back caches
+
+  EFI_LOCK                          Lock;
+  UINT32                            MediaId;
+  UINT32                            BlockSize;
+  UINT32                            BlockNum;
+  UINT32                            MaxIoBlockNum;        /// < Largest request served by the cache, in blocks
+  UINT32                            MaxDirtyBlockNum;     /// < 0 for write-through
+  UINT32                            DirtyBlockNum;
+
+  UINT8                             *Data;
+  DISK_IO_CACHE_BLOCK               *Blocks;
+  LIST_ENTRY                        *Buckets;
+  UINTN                             BucketMask;
+  LIST_ENTRY                        Lru;
+  LIST_ENTRY                        DirtyBlocks;
+
+  //
+  // Sequential read detection: LBA of the block holding the byte following
+  // the last read request, and number of blocks to read ahead.
+  //
+  UINT64                            NextLba;
+  UINT32                            ReadAheadBlockNum;
+
+  EFI_EVENT                         ExitBootServicesEvent;
+  EDKII_DISK_IO_CACHE_STATISTICS    Statistics;
+};
+#define DISK_IO_CACHE_FROM_PROTOCOL(a)  CR (a, DISK_IO_CACHE, Protocol, DISK_IO_CACHE_SIGNATURE)
+
 //
 // Global Variables
 //
@@ -335,6 +392,123 @@ DiskIo2FlushDiskEx (
   IN OUT EFI_DISK_IO2_TOKEN  *Token
   );
 
+/**
+  Remove the completed tasks from Instance->TaskQueue. Completed tasks are those who don't have any subtasks.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+
+  @retval TRUE       The Instance->TaskQueue is empty after the completed tasks are removed.
+  @retval FALSE      The Instance->TaskQueue is not empty after the completed tasks are removed.
+**/
+BOOLEAN
+DiskIo2RemoveCompletedTask (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  );
+
+/**
+  Read/Write data from/to the device, without the cache.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Write       TRUE: Write request; FALSE: Read request.
+  @param MediaId     ID of the medium to access.
+  @param Offset      The starting byte offset on the logical block I/O device to access.
+  @param Token       A pointer to the token associated with the transaction.
+                     If this field is NULL, synchronous/blocking IO is performed.
+  @param BufferSize  The size in bytes of Buffer. The number of bytes to read from the device.
+  @param Buffer      A pointer to the destination buffer for the data.
+                     The caller is responsible either having implicit or explicit ownership of the buffer.
+
+  @return The status of the request, as DiskIo2ReadWriteDisk ().
+**/
+EFI_STATUS
+DiskIo2ReadWriteDiskUncached (
+  IN DISK_IO_PRIVATE_DATA  *Instance,
+  IN BOOLEAN               Write,
+  IN UINT32                MediaId,
+  IN UINT64                Offset,
+  IN EFI_DISK_IO2_TOKEN    *Token,
+  IN UINTN                 BufferSize,
+  IN UINT8                 *Buffer
+  );
+
+//
+// Block cache functions
+//
+
+/**
+  Create the cache of a disk, if PcdDiskIoCacheSize is not 0. The blocks of
+  logical partitions are not cached, the partition driver accesses them through
+  the Disk I/O protocol of their disk.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+**/
+VOID
+DiskIoCacheCreate (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  );
+
+/**
+  Free the cache of a disk.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+**/
+VOID
+DiskIoCacheDestroy (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  );
+
+/**
+  Write the modified blocks of the cache back to the device. The runs of
+  consecutive modified blocks are written at once.
+
+  The caller must hold Cache->Lock.
+
+  @param Cache    Pointer to the DISK_IO_CACHE.
+
+  @retval EFI_SUCCESS  All the modified blocks were written back.
+  @retval Others       The device reported an error.
+**/
+EFI_STATUS
+DiskIoCacheWriteBack (
+  IN DISK_IO_CACHE  *Cache
+  );
+
+/**
+  Serve a request from the cache.
+
+  Blocking requests that fit in the working buffer are served from the cache.
+  For the other requests, the modified blocks are written back and the blocks
+  a write request overwrites are dropped, so that the caller can access the
+  device directly.
+
+  The caller must hold Cache->Lock, up to the end of the direct access.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Write       TRUE: Write request; FALSE: Read request.
+  @param MediaId     ID of the medium to access.
+  @param Offset      The starting byte offset on the logical block I/O device to access.
+  @param Token       A pointer to the token associated with the transaction.
+                     If this field is NULL, synchronous/blocking IO is performed.
+  @param BufferSize  The size in bytes of Buffer.
+  @param Buffer      A pointer to the buffer for the data.
+  @param Status      The status of the request when it is served from the
+                     cache, or of the write back otherwise.
+
+  @retval TRUE       The request was served from the cache, or failed.
+  @retval FALSE      The caller must access the device directly.
+**/
+BOOLEAN
+DiskIoCacheReadWrite (
+  IN  DISK_IO_PRIVATE_DATA  *Instance,
+  IN  BOOLEAN               Write,
+  IN  UINT32                MediaId,
+  IN  UINT64                Offset,
+  IN  EFI_DISK_IO2_TOKEN    *Token,
+  IN  UINTN                 BufferSize,
+  IN  UINT8                 *Buffer,
+  OUT EFI_STATUS            *Status
+  );
+
 //
 // EFI Component Name Functions
 //
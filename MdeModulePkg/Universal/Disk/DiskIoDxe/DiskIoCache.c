@@ -0,0 +1,1063 @@
+/** @file
+  Block cache of the DiskIo driver.
+
+  File systems and partition drivers read the same metadata blocks many times,
+  most of them through small and unaligned requests. When PcdDiskIoCacheSize is
+  not 0, the blocks of the disks (not of their partitions, that go through the
+  Disk I/O protocol of their disk) are kept in a cache, evicting the least
+  recently used blocks first.
+
+  - The runs of consecutive blocks missing from the cache are read at once,
+    and sequential reads are detected to read the following blocks ahead.
+  - Writes go through to the device, unless PcdDiskIoCacheDirtyBlockNum is
+    not 0. The modified blocks are then written back, run by run, when there
+    are that many of them, and by FlushDiskEx (), the Disk I/O Cache protocol,
+    the driver stop, before ExitBootServices () and on ResetSystem ().
+  - Non-blocking requests, and requests larger than the working buffer, go to
+    the device directly once the modified blocks are written back and the
+    blocks they overwrite are dropped.
+
+  Callers that write the Block I/O protocol of a cached disk directly must
+  invalidate the cache through the Disk I/O Cache protocol.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DiskIo.h"
+
+//
+// Smallest cache, in blocks, and number of blocks read ahead first when a
+// sequential read is detected. The read ahead doubles for each following
+// sequential read, up to the working buffer size.
+//
+#define DISK_IO_CACHE_MIN_BLOCK_NUM         8
+#define DISK_IO_CACHE_READ_AHEAD_BLOCK_NUM  8
+
+//
+// The write-back caches, written back by the reset notification.
+//
+LIST_ENTRY  mDiskIoWriteBackCaches = INITIALIZE_LIST_HEAD_VARIABLE (mDiskIoWriteBackCaches);
+BOOLEAN     mDiskIoResetNotifyRegistered;
+
+/**
+  Look up a block in the cache.
+
+  @param Cache    Pointer to the DISK_IO_CACHE.
+  @param Lba      The logical block address of the block.
+
+  @return The cached block, or NULL if the block is not in the cache.
+**/
+DISK_IO_CACHE_BLOCK *
+DiskIoCacheLookup (
+  IN DISK_IO_CACHE  *Cache,
+  IN UINT64         Lba
+  )
+{
+  LIST_ENTRY           *Bucket;
+  LIST_ENTRY           *Link;
+  DISK_IO_CACHE_BLOCK  *Block;
+
+  Bucket = &Cache->Buckets[(UINTN)Lba & Cache->BucketMask];
+  for (Link = GetFirstNode (Bucket); !IsNull (Bucket, Link); Link = GetNextNode (Bucket, Link)) {
+    Block = BASE_CR (Link, DISK_IO_CACHE_BLOCK, HashLink);
+    if (Block->Lba == Lba) {
+      return Block;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Mark a block as the most recently used one.
+
+  @param Cache    Pointer to the DISK_IO_CACHE.
+  @param Block    The cached block.
+**/
+VOID
+DiskIoCacheTouch (
+  IN DISK_IO_CACHE        *Cache,
+  IN DISK_IO_CACHE_BLOCK  *Block
+  )
+{
+  RemoveEntryList (&Block->LruLink);
+  InsertHeadList (&Cache->Lru, &Block->LruLink);
+}
+
+/**
+  Mark a block as modified.
+
+  @param Cache    Pointer to the DISK_IO_CACHE.
+  @param Block    The cached block.
+**/
+VOID
+DiskIoCacheMarkDirty (
+  IN DISK_IO_CACHE        *Cache,
+  IN DISK_IO_CACHE_BLOCK  *Block
+  )
+{
+  if (!Block->Dirty) {
+    Block->Dirty = TRUE;
+    InsertTailList (&Cache->DirtyBlocks, &Block->DirtyLink);
+    Cache->DirtyBlockNum++;
+  }
+}
+
+/**
+  Mark a block as written back.
+
+  @param Cache    Pointer to the DISK_IO_CACHE.
+  @param Block    The cached block.
+**/
+VOID
+DiskIoCacheMarkClean (
+  IN DISK_IO_CACHE        *Cache,
+  IN DISK_IO_CACHE_BLOCK  *Block
+  )
+{
+  if (Block->Dirty) {
+    Block->Dirty = FALSE;
+    RemoveEntryList (&Block->DirtyLink);
+    Cache->DirtyBlockNum--;
+  }
+}
+
+/**
+  Drop a block from the cache, even if it is modified.
+
+  @param Cache    Pointer to the DISK_IO_CACHE.
+  @param Block    The cached block.
+**/
+VOID
+DiskIoCacheDropBlock (
+  IN DISK_IO_CACHE        *Cache,
+  IN DISK_IO_CACHE_BLOCK  *Block
+  )
+{
+  ASSERT (Block->Valid);
+
+  DiskIoCacheMarkClean (Cache, Block);
+  RemoveEntryList (&Block->HashLink);
+  Block->Valid     = FALSE;
+  Block->ReadAhead = FALSE;
+
+  RemoveEntryList (&Block->LruLink);
+  InsertTailList (&Cache->Lru, &Block->LruLink);
+}
+
+/**
+  Get a cache block for a block not in the cache, evicting the least recently
+  used unmodified block. The data of the block is left undefined.
+
+  @param Cache    Pointer to the DISK_IO_CACHE.
+  @param Lba      The logical block address of the block.
+
+  @return The cache block, marked as the most recently used one.
+**/
+DISK_IO_CACHE_BLOCK *
+DiskIoCacheAllocateBlock (
+  IN DISK_IO_CACHE  *Cache,
+  IN UINT64         Lba
+  )
+{
+  LIST_ENTRY           *Link;
+  DISK_IO_CACHE_BLOCK  *Block;
+
+  ASSERT (DiskIoCacheLookup (Cache, Lba) == NULL);
+
+  //
+  // At most half of the blocks are modified, so an unmodified block is always
+  // found.
+  //
+  Block = NULL;
+  for (Link = GetPreviousNode (&Cache->Lru, &Cache->Lru); !IsNull (&Cache->Lru, Link); Link = GetPreviousNode (&Cache->Lru, Link)) {
+    Block = BASE_CR (Link, DISK_IO_CACHE_BLOCK, LruLink);
+    if (!Block->Dirty) {
+      break;
+    }
+  }
+
+  ASSERT (!IsNull (&Cache->Lru, Link));
+
+  if (Block->Valid) {
+    RemoveEntryList (&Block->HashLink);
+    Cache->Statistics.Evictions++;
+  }
+
+  Block->Lba       = Lba;
+  Block->Valid     = TRUE;
+  Block->ReadAhead = FALSE;
+  InsertTailList (&Cache->Buckets[(UINTN)Lba & Cache->BucketMask], &Block->HashLink);
+  DiskIoCacheTouch (Cache, Block);
+
+  return Block;
+}
+
+/**
+  Drop all the blocks of the cache, even the modified ones.
+
+  @param Cache    Pointer to the DISK_IO_CACHE.
+**/
+VOID
+DiskIoCacheDiscard (
+  IN DISK_IO_CACHE  *Cache
+  )
+{
+  UINT32  Index;
+
+  if (Cache->DirtyBlockNum != 0) {
+    DEBUG ((DEBUG_WARN, "DiskIo: Drop %u modified blocks of the cache\n", (UINT32)Cache->DirtyBlockNum));
+  }
+
+  for (Index = 0; Index < Cache->BlockNum; Index++) {
+    if (Cache->Blocks[Index].Valid) {
+      DiskIoCacheDropBlock (Cache, &Cache->Blocks[Index]);
+    }
+  }
+
+  ASSERT (Cache->DirtyBlockNum == 0);
+  Cache->NextLba           = MAX_UINT64;
+  Cache->ReadAheadBlockNum = 0;
+}
+
+/**
+  Drop the blocks of the cache that hold bytes of a range of the disk.
+  The blocks must have been written back.
+
+  @param Cache       Pointer to the DISK_IO_CACHE.
+  @param Offset      The starting byte offset of the range.
+  @param BufferSize  The size in bytes of the range.
+**/
+VOID
+DiskIoCacheInvalidateRange (
+  IN DISK_IO_CACHE  *Cache,
+  IN UINT64         Offset,
+  IN UINTN          BufferSize
+  )
+{
+  UINT64               Lba;
+  UINT64               LastLba;
+  UINT32               Index;
+  DISK_IO_CACHE_BLOCK  *Block;
+
+  if (BufferSize == 0) {
+    return;
+  }
+
+  Lba = DivU64x32 (Offset, Cache->BlockSize);
+  if (BufferSize - 1 > MAX_UINT64 - Offset) {
+    LastLba = MAX_UINT64;
+  } else {
+    LastLba = DivU64x32 (Offset + BufferSize - 1, Cache->BlockSize);
+  }
+
+  for (Index = 0; Index < Cache->BlockNum; Index++) {
+    Block = &Cache->Blocks[Index];
+    if (Block->Valid && (Block->Lba >= Lba) && (Block->Lba <= LastLba)) {
+      ASSERT (!Block->Dirty);
+      DiskIoCacheDropBlock (Cache, Block);
+    }
+  }
+}
+
+/**
+  Read blocks from the device into the working buffer and into the cache.
+  The blocks must not be in the cache.
+
+  @param Cache              Pointer to the DISK_IO_CACHE.
+  @param Lba                The logical block address of the first block.
+  @param BlockNum           The number of blocks requested.
+  @param ReadAheadBlockNum  The number of blocks to read ahead, past the
+                            requested ones.
+
+  @retval EFI_SUCCESS       The requested blocks were read. They are at the
+                            start of the working buffer.
+  @retval Others            The device reported an error.
+**/
+EFI_STATUS
+DiskIoCacheFill (
+  IN DISK_IO_CACHE  *Cache,
+  IN UINT64         Lba,
+  IN UINT32         BlockNum,
+  IN UINT32         ReadAheadBlockNum
+  )
+{
+  EFI_STATUS             Status;
+  EFI_BLOCK_IO_PROTOCOL  *BlockIo;
+  UINT8                  *WorkingBuffer;
+  UINT32                 Index;
+  DISK_IO_CACHE_BLOCK    *Block;
+
+  ASSERT (BlockNum + ReadAheadBlockNum <= Cache->MaxIoBlockNum);
+
+  BlockIo       = Cache->Instance->BlockIo;
+  WorkingBuffer = Cache->Instance->SharedWorkingBuffer;
+
+  Status = BlockIo->ReadBlocks (
+                      BlockIo,
+                      Cache->MediaId,
+                      Lba,
+                      (UINTN)(BlockNum + ReadAheadBlockNum) * Cache->BlockSize,
+                      WorkingBuffer
+                      );
+  Cache->Statistics.DeviceReads++;
+  if (EFI_ERROR (Status) && (ReadAheadBlockNum != 0)) {
+    //
+    // Do not fail the request for the blocks read ahead.
+    //
+    ReadAheadBlockNum = 0;
+    Status            = BlockIo->ReadBlocks (
+                                   BlockIo,
+                                   Cache->MediaId,
+                                   Lba,
+                                   (UINTN)BlockNum * Cache->BlockSize,
+                                   WorkingBuffer
+                                   );
+    Cache->Statistics.DeviceReads++;
+  }
+
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Cache->Statistics.ReadAheadBlocks += ReadAheadBlockNum;
+  for (Index = 0; Index < BlockNum + ReadAheadBlockNum; Index++) {
+    Block = DiskIoCacheAllocateBlock (Cache, Lba + Index);
+    CopyMem (Block->Data, WorkingBuffer + (UINTN)Index * Cache->BlockSize, Cache->BlockSize);
+    Block->ReadAhead = (BOOLEAN)(Index >= BlockNum);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Write the modified blocks of the cache back to the device. The runs of
+  consecutive modified blocks are written at once.
+
+  The caller must hold Cache->Lock.
+
+  @param Cache    Pointer to the DISK_IO_CACHE.
+
+  @retval EFI_SUCCESS  All the modified blocks were written back.
+  @retval Others       The device reported an error.
+**/
+EFI_STATUS
+DiskIoCacheWriteBack (
+  IN DISK_IO_CACHE  *Cache
+  )
+{
+  EFI_STATUS             Status;
+  EFI_BLOCK_IO_PROTOCOL  *BlockIo;
+  UINT8                  *WorkingBuffer;
+  DISK_IO_CACHE_BLOCK    *Block;
+  DISK_IO_CACHE_BLOCK    *RunBlock;
+  UINT64                 Lba;
+  UINT32                 Count;
+  UINT32                 Index;
+
+  BlockIo       = Cache->Instance->BlockIo;
+  WorkingBuffer = Cache->Instance->SharedWorkingBuffer;
+
+  while (!IsListEmpty (&Cache->DirtyBlocks)) {
+    Block = BASE_CR (GetFirstNode (&Cache->DirtyBlocks), DISK_IO_CACHE_BLOCK, DirtyLink);
+
+    //
+    // Find the start of the run of modified blocks, as long as the run up to
+    // this block fits in the working buffer.
+    //
+    Lba = Block->Lba;
+    while ((Lba > 0) && (Block->Lba - Lba + 1 < Cache->MaxIoBlockNum)) {
+      RunBlock = DiskIoCacheLookup (Cache, Lba - 1);
+      if ((RunBlock == NULL) || !RunBlock->Dirty) {
+        break;
+      }
+
+      Lba--;
+    }
+
+    for (Count = 0; Count < Cache->MaxIoBlockNum; Count++) {
+      RunBlock = DiskIoCacheLookup (Cache, Lba + Count);
+      if ((RunBlock == NULL) || !RunBlock->Dirty) {
+        break;
+      }
+
+      CopyMem (WorkingBuffer + (UINTN)Count * Cache->BlockSize, RunBlock->Data, Cache->BlockSize);
+    }
+
+    ASSERT (Lba + Count > Block->Lba);
+
+    Status = BlockIo->WriteBlocks (
+                        BlockIo,
+                        Cache->MediaId,
+                        Lba,
+                        (UINTN)Count * Cache->BlockSize,
+                        WorkingBuffer
+                        );
+    Cache->Statistics.DeviceWrites++;
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "DiskIo: Failed to write back %u blocks at Lba %lx - %r\n", (UINT32)Count, Lba, Status));
+      return Status;
+    }
+
+    for (Index = 0; Index < Count; Index++) {
+      DiskIoCacheMarkClean (Cache, DiskIoCacheLookup (Cache, Lba + Index));
+    }
+
+    Cache->Statistics.WriteBacks += Count;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Update the sequential read detection with a read request, and the number of
+  blocks to read ahead.
+
+  @param Cache       Pointer to the DISK_IO_CACHE.
+  @param Lba         The logical block address of the first byte read.
+  @param EndOffset   The byte offset following the last byte read.
+**/
+VOID
+DiskIoCacheDetectSequentialRead (
+  IN DISK_IO_CACHE  *Cache,
+  IN UINT64         Lba,
+  IN UINT64         EndOffset
+  )
+{
+  if (Lba == Cache->NextLba) {
+    if (Cache->ReadAheadBlockNum == 0) {
+      Cache->ReadAheadBlockNum = MIN (DISK_IO_CACHE_READ_AHEAD_BLOCK_NUM, Cache->MaxIoBlockNum);
+    } else {
+      Cache->ReadAheadBlockNum = MIN (Cache->ReadAheadBlockNum * 2, Cache->MaxIoBlockNum);
+    }
+  } else {
+    Cache->ReadAheadBlockNum = 0;
+  }
+
+  Cache->NextLba = DivU64x32 (EndOffset, Cache->BlockSize);
+}
+
+/**
+  Serve a request from the cache.
+
+  Blocking requests that fit in the working buffer are served from the cache.
+  For the other requests, the modified blocks are written back and the blocks
+  a write request overwrites are dropped, so that the caller can access the
+  device directly.
+
+  The caller must hold Cache->Lock, up to the end of the direct access.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+  @param Write       TRUE: Write request; FALSE: Read request.
+  @param MediaId     ID of the medium to access.
+  @param Offset      The starting byte offset on the logical block I/O device to access.
+  @param Token       A pointer to the token associated with the transaction.
+                     If this field is NULL, synchronous/blocking IO is performed.
+  @param BufferSize  The size in bytes of Buffer.
+  @param Buffer      A pointer to the buffer for the data.
+  @param Status      The status of the request when it is served from the
+                     cache, or of the write back otherwise.
+
+  @retval TRUE       The request was served from the cache, or failed.
+  @retval FALSE      The caller must access the device directly.
+**/
+BOOLEAN
+DiskIoCacheReadWrite (
+  IN  DISK_IO_PRIVATE_DATA  *Instance,
+  IN  BOOLEAN               Write,
+  IN  UINT32                MediaId,
+  IN  UINT64                Offset,
+  IN  EFI_DISK_IO2_TOKEN    *Token,
+  IN  UINTN                 BufferSize,
+  IN  UINT8                 *Buffer,
+  OUT EFI_STATUS            *Status
+  )
+{
+  DISK_IO_CACHE        *Cache;
+  EFI_BLOCK_IO_MEDIA   *Media;
+  DISK_IO_CACHE_BLOCK  *Block;
+  UINT8                *WorkingBuffer;
+  UINT32               BlockSize;
+  UINT32               BlockOffset;
+  UINT64               Lba;
+  UINT64               LastLba;
+  UINTN                Length;
+  UINT32               MissBlockNum;
+  UINT32               ReadAheadBlockNum;
+  UINT32               DirtyLimit;
+  UINT32               Index;
+  BOOLEAN              Cacheable;
+
+  Cache         = Instance->Cache;
+  Media         = Instance->BlockIo->Media;
+  WorkingBuffer = Instance->SharedWorkingBuffer;
+  BlockSize     = Cache->BlockSize;
+  *Status       = EFI_SUCCESS;
+
+  //
+  // Drop the blocks of a removed or replaced medium.
+  //
+  if ((Media->MediaId != Cache->MediaId) || !Media->MediaPresent) {
+    DiskIoCacheDiscard (Cache);
+    Cache->MediaId = Media->MediaId;
+  }
+
+  Lba     = DivU64x32Remainder (Offset, BlockSize, &BlockOffset);
+  LastLba = Lba;
+  Cacheable = (BOOLEAN)(((Token == NULL) || (Token->Event == NULL)) &&
+                        (BufferSize != 0) &&
+                        (BufferSize - 1 <= MAX_UINT64 - Offset) &&
+                        (MediaId == Media->MediaId) &&
+                        Media->MediaPresent &&
+                        (Media->BlockSize == BlockSize) &&
+                        !(Write && Media->ReadOnly));
+  if (Cacheable) {
+    LastLba   = DivU64x32 (Offset + BufferSize - 1, BlockSize);
+    Cacheable = (BOOLEAN)((LastLba <= Media->LastBlock) && (LastLba - Lba < Cache->MaxIoBlockNum));
+  }
+
+  if (!Cacheable) {
+    Cache->Statistics.Bypasses++;
+    *Status = DiskIoCacheWriteBack (Cache);
+    if (EFI_ERROR (*Status)) {
+      return TRUE;
+    }
+
+    if (Write) {
+      DiskIoCacheInvalidateRange (Cache, Offset, BufferSize);
+    }
+
+    return FALSE;
+  }
+
+  //
+  // Wait till pending async task is completed, its blocks must not be read
+  // into the cache before.
+  //
+  while (!DiskIo2RemoveCompletedTask (Instance)) {
+  }
+
+  if (!Write) {
+    DiskIoCacheDetectSequentialRead (Cache, Lba, Offset + BufferSize);
+  }
+
+  //
+  // Write-through caches write the modified blocks back at the end of the
+  // request, but still within the working buffer size.
+  //
+  DirtyLimit = (Cache->MaxDirtyBlockNum != 0) ? Cache->MaxDirtyBlockNum : Cache->MaxIoBlockNum;
+
+  while (BufferSize > 0) {
+    Block = DiskIoCacheLookup (Cache, Lba);
+    if (!Write && (Block == NULL)) {
+      //
+      // Read the run of missing blocks at once. Read ahead if the run reaches
+      // the end of a sequential read.
+      //
+      for (MissBlockNum = 1; Lba + MissBlockNum <= LastLba; MissBlockNum++) {
+        if (DiskIoCacheLookup (Cache, Lba + MissBlockNum) != NULL) {
+          break;
+        }
+      }
+
+      ReadAheadBlockNum = 0;
+      if (Lba + MissBlockNum > LastLba) {
+        while ((ReadAheadBlockNum < Cache->ReadAheadBlockNum) &&
+               (MissBlockNum + ReadAheadBlockNum < Cache->MaxIoBlockNum) &&
+               (LastLba + ReadAheadBlockNum < Media->LastBlock) &&
+               (DiskIoCacheLookup (Cache, LastLba + ReadAheadBlockNum + 1) == NULL))
+        {
+          ReadAheadBlockNum++;
+        }
+      }
+
+      *Status = DiskIoCacheFill (Cache, Lba, MissBlockNum, ReadAheadBlockNum);
+      if (EFI_ERROR (*Status)) {
+        return TRUE;
+      }
+
+      Cache->Statistics.ReadMisses += MissBlockNum;
+      for (Index = 0; Index < MissBlockNum; Index++) {
+        Length = MIN (BlockSize - BlockOffset, BufferSize);
+        CopyMem (Buffer, WorkingBuffer + (UINTN)Index * BlockSize + BlockOffset, Length);
+        Buffer     += Length;
+        BufferSize -= Length;
+        BlockOffset = 0;
+      }
+
+      Lba += MissBlockNum;
+      continue;
+    }
+
+    Length = MIN (BlockSize - BlockOffset, BufferSize);
+    if (Block != NULL) {
+      if (Write) {
+        Cache->Statistics.WriteHits++;
+      } else {
+        Cache->Statistics.ReadHits++;
+        if (Block->ReadAhead) {
+          Cache->Statistics.ReadAheadHits++;
+          Block->ReadAhead = FALSE;
+        }
+      }
+
+      DiskIoCacheTouch (Cache, Block);
+    } else {
+      Cache->Statistics.WriteMisses++;
+      if (Length < BlockSize) {
+        //
+        // Read the part of the block the request does not write.
+        //
+        *Status = DiskIoCacheFill (Cache, Lba, 1, 0);
+        if (EFI_ERROR (*Status)) {
+          break;
+        }
+
+        Block = DiskIoCacheLookup (Cache, Lba);
+      } else {
+        Block = DiskIoCacheAllocateBlock (Cache, Lba);
+      }
+    }
+
+    if (Write) {
+      if (!Block->Dirty && (Cache->DirtyBlockNum >= DirtyLimit)) {
+        *Status = DiskIoCacheWriteBack (Cache);
+        if (EFI_ERROR (*Status)) {
+          break;
+        }
+      }
+
+      CopyMem (Block->Data + BlockOffset, Buffer, Length);
+      DiskIoCacheMarkDirty (Cache, Block);
+    } else {
+      CopyMem (Buffer, Block->Data + BlockOffset, Length);
+    }
+
+    Buffer     += Length;
+    BufferSize -= Length;
+    BlockOffset = 0;
+    Lba++;
+  }
+
+  if (Write && (Cache->MaxDirtyBlockNum == 0)) {
+    if (!EFI_ERROR (*Status)) {
+      *Status = DiskIoCacheWriteBack (Cache);
+    }
+
+    if (EFI_ERROR (*Status)) {
+      //
+      // Do not keep data the device did not get.
+      //
+      while (!IsListEmpty (&Cache->DirtyBlocks)) {
+        DiskIoCacheDropBlock (Cache, BASE_CR (GetFirstNode (&Cache->DirtyBlocks), DISK_IO_CACHE_BLOCK, DirtyLink));
+      }
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Get the configuration and the counters of the cache.
+
+  @param[in]  This              The EDKII_DISK_IO_CACHE_PROTOCOL instance.
+  @param[out] Statistics        The configuration and the counters of the cache.
+
+  @retval EFI_SUCCESS           The statistics were returned.
+  @retval EFI_INVALID_PARAMETER Statistics is NULL.
+**/
+EFI_STATUS
+EFIAPI
+DiskIoCacheGetStatistics (
+  IN  EDKII_DISK_IO_CACHE_PROTOCOL    *This,
+  OUT EDKII_DISK_IO_CACHE_STATISTICS  *Statistics
+  )
+{
+  DISK_IO_CACHE  *Cache;
+
+  if (Statistics == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Cache = DISK_IO_CACHE_FROM_PROTOCOL (This);
+
+  EfiAcquireLock (&Cache->Lock);
+  Cache->Statistics.DirtyBlocks = Cache->DirtyBlockNum;
+  CopyMem (Statistics, &Cache->Statistics, sizeof (EDKII_DISK_IO_CACHE_STATISTICS));
+  EfiReleaseLock (&Cache->Lock);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Reset the counters of the cache to 0.
+
+  @param[in]  This              The EDKII_DISK_IO_CACHE_PROTOCOL instance.
+
+  @retval EFI_SUCCESS           The counters were reset.
+**/
+EFI_STATUS
+EFIAPI
+DiskIoCacheResetStatistics (
+  IN EDKII_DISK_IO_CACHE_PROTOCOL  *This
+  )
+{
+  DISK_IO_CACHE  *Cache;
+
+  Cache = DISK_IO_CACHE_FROM_PROTOCOL (This);
+
+  EfiAcquireLock (&Cache->Lock);
+  ZeroMem (&Cache->Statistics, sizeof (EDKII_DISK_IO_CACHE_STATISTICS));
+  Cache->Statistics.BlockSize      = Cache->BlockSize;
+  Cache->Statistics.CacheBlocks    = Cache->BlockNum;
+  Cache->Statistics.MaxDirtyBlocks = Cache->MaxDirtyBlockNum;
+  EfiReleaseLock (&Cache->Lock);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Write the modified blocks of the cache back to the device.
+
+  @param[in]  This              The EDKII_DISK_IO_CACHE_PROTOCOL instance.
+
+  @retval EFI_SUCCESS           All the modified blocks were written back.
+  @retval Others                The device reported an error while writing the
+                                blocks back.
+**/
+EFI_STATUS
+EFIAPI
+DiskIoCacheFlush (
+  IN EDKII_DISK_IO_CACHE_PROTOCOL  *This
+  )
+{
+  DISK_IO_CACHE  *Cache;
+  EFI_STATUS     Status;
+
+  Cache = DISK_IO_CACHE_FROM_PROTOCOL (This);
+
+  EfiAcquireLock (&Cache->Lock);
+  Status = DiskIoCacheWriteBack (Cache);
+  EfiReleaseLock (&Cache->Lock);
+
+  return Status;
+}
+
+/**
+  Write the modified blocks of the cache back to the device, then drop all
+  the blocks of the cache.
+
+  @param[in]  This              The EDKII_DISK_IO_CACHE_PROTOCOL instance.
+
+  @retval EFI_SUCCESS           The cache was written back and emptied.
+  @retval Others                The device reported an error while writing the
+                                blocks back. The cache was not emptied.
+**/
+EFI_STATUS
+EFIAPI
+DiskIoCacheInvalidate (
+  IN EDKII_DISK_IO_CACHE_PROTOCOL  *This
+  )
+{
+  DISK_IO_CACHE  *Cache;
+  EFI_STATUS     Status;
+
+  Cache = DISK_IO_CACHE_FROM_PROTOCOL (This);
+
+  EfiAcquireLock (&Cache->Lock);
+  Status = DiskIoCacheWriteBack (Cache);
+  if (!EFI_ERROR (Status)) {
+    DiskIoCacheDiscard (Cache);
+  }
+
+  EfiReleaseLock (&Cache->Lock);
+
+  return Status;
+}
+
+/**
+  Write the modified blocks of the cache back, unless the cache is being
+  accessed by the code interrupted.
+
+  @param Cache    Pointer to the DISK_IO_CACHE.
+**/
+VOID
+DiskIoCacheWriteBackIfIdle (
+  IN DISK_IO_CACHE  *Cache
+  )
+{
+  if (!EFI_ERROR (EfiAcquireLockOrFail (&Cache->Lock))) {
+    DiskIoCacheWriteBack (Cache);
+    EfiReleaseLock (&Cache->Lock);
+  }
+}
+
+/**
+  Write the modified blocks of the cache back before ExitBootServices ().
+
+  @param  Event                 Event whose notification function is being invoked.
+  @param  Context               The pointer to the notification function's context,
+                                which points to the DISK_IO_CACHE instance.
+**/
+VOID
+EFIAPI
+DiskIoCacheOnExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  DISK_IO_CACHE  *Cache;
+
+  Cache = (DISK_IO_CACHE *)Context;
+  ASSERT (Cache->Signature == DISK_IO_CACHE_SIGNATURE);
+
+  DiskIoCacheWriteBackIfIdle (Cache);
+}
+
+/**
+  Write the modified blocks of all the write-back caches back before the
+  system resets.
+
+  @param[in] ResetType          The type of reset to perform.
+  @param[in] ResetStatus        The status code for the reset.
+  @param[in] DataSize           The size, in bytes, of ResetData.
+  @param[in] ResetData          The reset data.
+**/
+VOID
+EFIAPI
+DiskIoCacheOnResetSystem (
+  IN EFI_RESET_TYPE  ResetType,
+  IN EFI_STATUS      ResetStatus,
+  IN UINTN           DataSize,
+  IN VOID            *ResetData OPTIONAL
+  )
+{
+  LIST_ENTRY  *Link;
+  EFI_TPL     OldTpl;
+
+  //
+  // The device cannot be accessed when the system resets above TPL_CALLBACK.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  gBS->RestoreTPL (OldTpl);
+  if (OldTpl > TPL_CALLBACK) {
+    return;
+  }
+
+  for (Link = GetFirstNode (&mDiskIoWriteBackCaches);
+       !IsNull (&mDiskIoWriteBackCaches, Link);
+       Link = GetNextNode (&mDiskIoWriteBackCaches, Link))
+  {
+    DiskIoCacheWriteBackIfIdle (BASE_CR (Link, DISK_IO_CACHE, WriteBackLink));
+  }
+}
+
+/**
+  Add a write-back cache to the caches written back on ResetSystem (), and
+  register the reset notification with the first one.
+
+  @param Cache    Pointer to the DISK_IO_CACHE.
+**/
+VOID
+DiskIoCacheRegisterResetNotification (
+  IN DISK_IO_CACHE  *Cache
+  )
+{
+  EFI_STATUS                       Status;
+  EFI_RESET_NOTIFICATION_PROTOCOL  *ResetNotify;
+
+  InsertTailList (&mDiskIoWriteBackCaches, &Cache->WriteBackLink);
+  if (mDiskIoResetNotifyRegistered) {
+    return;
+  }
+
+  Status = gBS->LocateProtocol (&gEfiResetNotificationProtocolGuid, NULL, (VOID **)&ResetNotify);
+  if (!EFI_ERROR (Status)) {
+    Status = ResetNotify->RegisterResetNotify (ResetNotify, DiskIoCacheOnResetSystem);
+    ASSERT_EFI_ERROR (Status);
+    mDiskIoResetNotifyRegistered = (BOOLEAN)!EFI_ERROR (Status);
+  } else {
+    DEBUG ((DEBUG_WARN, "DiskIo: ResetNotification absent, cache not written back on reset\n"));
+  }
+}
+
+/**
+  Remove a write-back cache from the caches written back on ResetSystem (), and
+  unregister the reset notification with the last one.
+
+  @param Cache    Pointer to the DISK_IO_CACHE.
+**/
+VOID
+DiskIoCacheUnregisterResetNotification (
+  IN DISK_IO_CACHE  *Cache
+  )
+{
+  EFI_STATUS                       Status;
+  EFI_RESET_NOTIFICATION_PROTOCOL  *ResetNotify;
+
+  RemoveEntryList (&Cache->WriteBackLink);
+  if (!mDiskIoResetNotifyRegistered || !IsListEmpty (&mDiskIoWriteBackCaches)) {
+    return;
+  }
+
+  Status = gBS->LocateProtocol (&gEfiResetNotificationProtocolGuid, NULL, (VOID **)&ResetNotify);
+  if (!EFI_ERROR (Status)) {
+    Status = ResetNotify->UnregisterResetNotify (ResetNotify, DiskIoCacheOnResetSystem);
+    ASSERT_EFI_ERROR (Status);
+  }
+
+  mDiskIoResetNotifyRegistered = FALSE;
+}
+
+/**
+  Free the cache of a disk.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+**/
+VOID
+DiskIoCacheDestroy (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  )
+{
+  DISK_IO_CACHE  *Cache;
+
+  Cache = Instance->Cache;
+  if (Cache == NULL) {
+    return;
+  }
+
+  Instance->Cache = NULL;
+
+  if (Cache->ExitBootServicesEvent != NULL) {
+    gBS->CloseEvent (Cache->ExitBootServicesEvent);
+    DiskIoCacheUnregisterResetNotification (Cache);
+  }
+
+  if (Cache->Data != NULL) {
+    FreePages (Cache->Data, EFI_SIZE_TO_PAGES ((UINTN)Cache->BlockNum * Cache->BlockSize));
+  }
+
+  if (Cache->Buckets != NULL) {
+    FreePool (Cache->Buckets);
+  }
+
+  if (Cache->Blocks != NULL) {
+    FreePool (Cache->Blocks);
+  }
+
+  FreePool (Cache);
+}
+
+/**
+  Create the cache of a disk, if PcdDiskIoCacheSize is not 0. The blocks of
+  logical partitions are not cached, the partition driver accesses them through
+  the Disk I/O protocol of their disk.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+**/
+VOID
+DiskIoCacheCreate (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  )
+{
+  EFI_STATUS          Status;
+  EFI_BLOCK_IO_MEDIA  *Media;
+  DISK_IO_CACHE       *Cache;
+  UINT32              BlockNum;
+  UINT32              BucketNum;
+  UINT32              Index;
+
+  Media = Instance->BlockIo->Media;
+  if ((PcdGet32 (PcdDiskIoCacheSize) == 0) || Media->LogicalPartition || (Media->BlockSize == 0)) {
+    return;
+  }
+
+  BlockNum = PcdGet32 (PcdDiskIoCacheSize) / Media->BlockSize;
+  if ((BlockNum < DISK_IO_CACHE_MIN_BLOCK_NUM) || (PcdGet32 (PcdDiskIoDataBufferBlockNum) == 0)) {
+    DEBUG ((DEBUG_WARN, "DiskIo: Cache too small for block size %u, disabled\n", (UINT32)Media->BlockSize));
+    return;
+  }
+
+  Cache = AllocateZeroPool (sizeof (DISK_IO_CACHE));
+  if (Cache == NULL) {
+    return;
+  }
+
+  Instance->Cache = Cache;
+
+  BucketNum      = GetPowerOfTwo32 (BlockNum);
+  Cache->Blocks  = AllocateZeroPool (BlockNum * sizeof (DISK_IO_CACHE_BLOCK));
+  Cache->Buckets = AllocatePool (BucketNum * sizeof (LIST_ENTRY));
+  Cache->Data    = AllocatePages (EFI_SIZE_TO_PAGES ((UINTN)BlockNum * Media->BlockSize));
+  if ((Cache->Blocks == NULL) || (Cache->Buckets == NULL) || (Cache->Data == NULL)) {
+    Cache->BlockNum  = BlockNum;
+    Cache->BlockSize = Media->BlockSize;
+    DiskIoCacheDestroy (Instance);
+    return;
+  }
+
+  Cache->Signature                = DISK_IO_CACHE_SIGNATURE;
+  Cache->Protocol.Revision        = EDKII_DISK_IO_CACHE_PROTOCOL_REVISION;
+  Cache->Protocol.GetStatistics   = DiskIoCacheGetStatistics;
+  Cache->Protocol.ResetStatistics = DiskIoCacheResetStatistics;
+  Cache->Protocol.Flush           = DiskIoCacheFlush;
+  Cache->Protocol.Invalidate      = DiskIoCacheInvalidate;
+  Cache->Instance                 = Instance;
+  EfiInitializeLock (&Cache->Lock, TPL_CALLBACK);
+
+  Cache->MediaId   = Media->MediaId;
+  Cache->BlockSize = Media->BlockSize;
+  Cache->BlockNum  = BlockNum;
+
+  //
+  // The largest requests served by the cache, and the modified blocks, take
+  // at most a quarter and half of the cache, so that a request never evicts
+  // the blocks it reads or writes.
+  //
+  Cache->MaxIoBlockNum    = MIN (PcdGet32 (PcdDiskIoDataBufferBlockNum), BlockNum / 4);
+  Cache->MaxDirtyBlockNum = MIN (PcdGet32 (PcdDiskIoCacheDirtyBlockNum), BlockNum / 2);
+
+  Cache->BucketMask = BucketNum - 1;
+  for (Index = 0; Index < BucketNum; Index++) {
+    InitializeListHead (&Cache->Buckets[Index]);
+  }
+
+  InitializeListHead (&Cache->Lru);
+  InitializeListHead (&Cache->DirtyBlocks);
+  for (Index = 0; Index < BlockNum; Index++) {
+    Cache->Blocks[Index].Data = Cache->Data + (UINTN)Index * Media->BlockSize;
+    InsertTailList (&Cache->Lru, &Cache->Blocks[Index].LruLink);
+  }
+
+  Cache->NextLba                   = MAX_UINT64;
+  Cache->Statistics.BlockSize      = Cache->BlockSize;
+  Cache->Statistics.CacheBlocks    = Cache->BlockNum;
+  Cache->Statistics.MaxDirtyBlocks = Cache->MaxDirtyBlockNum;
+
+  if (Cache->MaxDirtyBlockNum != 0) {
+    Status = gBS->CreateEventEx (
+                    EVT_NOTIFY_SIGNAL,
+                    TPL_CALLBACK,
+                    DiskIoCacheOnExitBootServices,
+                    Cache,
+                    &gEfiEventBeforeExitBootServicesGuid,
+                    &Cache->ExitBootServicesEvent
+                    );
+    if (EFI_ERROR (Status)) {
+      DiskIoCacheDestroy (Instance);
+      return;
+    }
+
+    DiskIoCacheRegisterResetNotification (Cache);
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "DiskIo: Cache %u blocks of %u bytes, %a\n",
+    (UINT32)Cache->BlockNum,
+    (UINT32)Cache->BlockSize,
+    (Cache->MaxDirtyBlockNum != 0) ? "write-back" : "write-through"
+    ));
+}
@@ -0,0 +1,975 @@
+/** @file
+  Unit tests of the block cache of the DiskIo driver.
+
+  The cache is created on a Block I/O protocol backed by a memory disk, with
+  the PCD values set by MdeModulePkgHostTest.dsc: 64 blocks of 512 bytes,
+  requests of up to 16 blocks and up to 8 modified blocks.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+
+#include "../DiskIo.h"
+
+#define UNIT_TEST_APP_NAME     "DiskIo Cache Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_BLOCK_SIZE  512
+#define TEST_BLOCK_NUM   1024
+
+//
+// Geometry of the cache, following the PCD values of the test.
+//
+#define TEST_CACHE_BLOCK_NUM   64
+#define TEST_MAX_IO_BLOCK_NUM  16
+#define TEST_MAX_DIRTY_NUM     8
+
+EFI_BOOT_SERVICES  *gBS;
+
+STATIC UINT8                 mDisk[TEST_BLOCK_NUM * TEST_BLOCK_SIZE];
+STATIC UINT8                 mExpected[TEST_BLOCK_NUM * TEST_BLOCK_SIZE];
+STATIC UINTN                 mDeviceReads;
+STATIC UINTN                 mDeviceWrites;
+STATIC EFI_TPL               mTpl;
+STATIC EFI_EVENT_NOTIFY      mExitBootServicesNotify;
+STATIC VOID                  *mExitBootServicesContext;
+STATIC EFI_RESET_SYSTEM      mResetNotify;
+STATIC DISK_IO_PRIVATE_DATA  mInstance;
+
+STATIC EFI_BLOCK_IO_MEDIA  mMedia = {
+  0,                    // MediaId
+  FALSE,                // RemovableMedia
+  TRUE,                 // MediaPresent
+  FALSE,                // LogicalPartition
+  FALSE,                // ReadOnly
+  FALSE,                // WriteCaching
+  TEST_BLOCK_SIZE,      // BlockSize
+  0,                    // IoAlign
+  TEST_BLOCK_NUM - 1    // LastBlock
+};
+
+/**
+  Read blocks from the memory disk.
+
+  @param[in]  This        Indicates a pointer to the calling context.
+  @param[in]  MediaId     Id of the media, changes every time the media is replaced.
+  @param[in]  Lba         The starting Logical Block Address to read from.
+  @param[in]  BufferSize  Size of Buffer, must be a multiple of device block size.
+  @param[out] Buffer      A pointer to the destination buffer for the data.
+
+  @retval EFI_SUCCESS           The data was read.
+  @retval EFI_INVALID_PARAMETER The blocks are past the end of the disk.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestReadBlocks (
+  IN  EFI_BLOCK_IO_PROTOCOL  *This,
+  IN  UINT32                 MediaId,
+  IN  EFI_LBA                Lba,
+  IN  UINTN                  BufferSize,
+  OUT VOID                   *Buffer
+  )
+{
+  mDeviceReads++;
+  if ((BufferSize % TEST_BLOCK_SIZE != 0) || (Lba * TEST_BLOCK_SIZE + BufferSize > sizeof (mDisk))) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  CopyMem (Buffer, &mDisk[Lba * TEST_BLOCK_SIZE], BufferSize);
+  return EFI_SUCCESS;
+}
+
+/**
+  Write blocks to the memory disk.
+
+  @param[in]  This        Indicates a pointer to the calling context.
+  @param[in]  MediaId     The media ID that the write request is for.
+  @param[in]  Lba         The starting logical block address to be written.
+  @param[in]  BufferSize  Size of Buffer, must be a multiple of device block size.
+  @param[in]  Buffer      A pointer to the source buffer for the data.
+
+  @retval EFI_SUCCESS           The data was written.
+  @retval EFI_INVALID_PARAMETER The blocks are past the end of the disk.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestWriteBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL  *This,
+  IN UINT32                 MediaId,
+  IN EFI_LBA                Lba,
+  IN UINTN                  BufferSize,
+  IN VOID                   *Buffer
+  )
+{
+  mDeviceWrites++;
+  if ((BufferSize % TEST_BLOCK_SIZE != 0) || (Lba * TEST_BLOCK_SIZE + BufferSize > sizeof (mDisk))) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  CopyMem (&mDisk[Lba * TEST_BLOCK_SIZE], Buffer, BufferSize);
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_BLOCK_IO_PROTOCOL  mBlockIo = {
+  EFI_BLOCK_IO_PROTOCOL_REVISION,
+  &mMedia,
+  NULL,
+  TestReadBlocks,
+  TestWriteBlocks,
+  NULL
+};
+
+/**
+  Raise the TPL of the test.
+
+  @param[in]  NewTpl  The new TPL.
+
+  @return The previous TPL.
+**/
+STATIC
+EFI_TPL
+EFIAPI
+TestRaiseTpl (
+  IN EFI_TPL  NewTpl
+  )
+{
+  EFI_TPL  OldTpl;
+
+  OldTpl = mTpl;
+  mTpl   = NewTpl;
+  return OldTpl;
+}
+
+/**
+  Restore the TPL of the test.
+
+  @param[in]  OldTpl  The TPL to restore.
+**/
+STATIC
+VOID
+EFIAPI
+TestRestoreTpl (
+  IN EFI_TPL  OldTpl
+  )
+{
+  mTpl = OldTpl;
+}
+
+/**
+  Record the notification function of the before ExitBootServices () event.
+
+  @param[in]  Type            The type of event to create.
+  @param[in]  NotifyTpl       The task priority level of event notifications.
+  @param[in]  NotifyFunction  Pointer to the event's notification function.
+  @param[in]  NotifyContext   Pointer to the notification function's context.
+  @param[in]  EventGroup      Pointer to the unique identifier of the group.
+  @param[out] Event           Pointer to the newly created event.
+
+  @retval EFI_SUCCESS           The event was recorded.
+  @retval EFI_UNSUPPORTED       The event is not the one of the cache.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestCreateEventEx (
+  IN       UINT32            Type,
+  IN       EFI_TPL           NotifyTpl,
+  IN       EFI_EVENT_NOTIFY  NotifyFunction OPTIONAL,
+  IN CONST VOID              *NotifyContext OPTIONAL,
+  IN CONST EFI_GUID          *EventGroup OPTIONAL,
+  OUT      EFI_EVENT         *Event
+  )
+{
+  if ((EventGroup == NULL) || !CompareGuid (EventGroup, &gEfiEventBeforeExitBootServicesGuid)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  mExitBootServicesNotify  = NotifyFunction;
+  mExitBootServicesContext = (VOID *)NotifyContext;
+  *Event                   = (EFI_EVENT)&mExitBootServicesNotify;
+  return EFI_SUCCESS;
+}
+
+/**
+  Forget the before ExitBootServices () event.
+
+  @param[in]  Event  The event to close.
+
+  @retval EFI_SUCCESS  The event was closed.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestCloseEvent (
+  IN EFI_EVENT  Event
+  )
+{
+  mExitBootServicesNotify  = NULL;
+  mExitBootServicesContext = NULL;
+  return EFI_SUCCESS;
+}
+
+/**
+  Record the reset notification function.
+
+  @param[in]  This           A pointer to the EFI_RESET_NOTIFICATION_PROTOCOL instance.
+  @param[in]  ResetFunction  Points to the function to be called when a ResetSystem() is executed.
+
+  @retval EFI_SUCCESS           The reset notification function was registered.
+  @retval EFI_ALREADY_STARTED   A reset notification function is registered.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestRegisterResetNotify (
+  IN EFI_RESET_NOTIFICATION_PROTOCOL  *This,
+  IN EFI_RESET_SYSTEM                 ResetFunction
+  )
+{
+  if (mResetNotify != NULL) {
+    return EFI_ALREADY_STARTED;
+  }
+
+  mResetNotify = ResetFunction;
+  return EFI_SUCCESS;
+}
+
+/**
+  Forget the reset notification function.
+
+  @param[in]  This           A pointer to the EFI_RESET_NOTIFICATION_PROTOCOL instance.
+  @param[in]  ResetFunction  The pointer to the ResetFunction being unregistered.
+
+  @retval EFI_SUCCESS           The reset notification function was unregistered.
+  @retval EFI_INVALID_PARAMETER The reset notification function is not registered.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestUnregisterResetNotify (
+  IN EFI_RESET_NOTIFICATION_PROTOCOL  *This,
+  IN EFI_RESET_SYSTEM                 ResetFunction
+  )
+{
+  if (mResetNotify != ResetFunction) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  mResetNotify = NULL;
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_RESET_NOTIFICATION_PROTOCOL  mResetNotification = {
+  TestRegisterResetNotify,
+  TestUnregisterResetNotify
+};
+
+/**
+  Locate the reset notification protocol.
+
+  @param[in]  Protocol      Provides the protocol to search for.
+  @param[in]  Registration  Optional registration key.
+  @param[out] Interface     On return, a pointer to the protocol interface.
+
+  @retval EFI_SUCCESS    The protocol was found.
+  @retval EFI_NOT_FOUND  The protocol is not the reset notification protocol.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TestLocateProtocol (
+  IN  EFI_GUID  *Protocol,
+  IN  VOID      *Registration OPTIONAL,
+  OUT VOID      **Interface
+  )
+{
+  if (!CompareGuid (Protocol, &gEfiResetNotificationProtocolGuid)) {
+    return EFI_NOT_FOUND;
+  }
+
+  *Interface = &mResetNotification;
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_BOOT_SERVICES  mBootServices;
+
+/**
+  Initialize a basic mutual exclusion lock.
+
+  @param  Lock     A pointer to the lock data structure to initialize.
+  @param  Priority The EFI TPL associated with the lock.
+
+  @return The lock.
+**/
+EFI_LOCK *
+EFIAPI
+EfiInitializeLock (
+  IN OUT EFI_LOCK  *Lock,
+  IN EFI_TPL       Priority
+  )
+{
+  Lock->Tpl      = Priority;
+  Lock->OwnerTpl = TPL_APPLICATION;
+  Lock->Lock     = EfiLockReleased;
+  return Lock;
+}
+
+/**
+  Acquire ownership of a lock.
+
+  @param  Lock  A pointer to the lock to acquire.
+**/
+VOID
+EFIAPI
+EfiAcquireLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockReleased);
+  Lock->Lock = EfiLockAcquired;
+}
+
+/**
+  Acquire ownership of a lock, unless it is already owned.
+
+  @param  Lock  A pointer to the lock to acquire.
+
+  @retval EFI_SUCCESS        The lock was acquired.
+  @retval EFI_ACCESS_DENIED  The lock is already owned.
+**/
+EFI_STATUS
+EFIAPI
+EfiAcquireLockOrFail (
+  IN EFI_LOCK  *Lock
+  )
+{
+  if (Lock->Lock == EfiLockAcquired) {
+    return EFI_ACCESS_DENIED;
+  }
+
+  Lock->Lock = EfiLockAcquired;
+  return EFI_SUCCESS;
+}
+
+/**
+  Release ownership of a lock.
+
+  @param  Lock  A pointer to the lock to release.
+**/
+VOID
+EFIAPI
+EfiReleaseLock (
+  IN EFI_LOCK  *Lock
+  )
+{
+  ASSERT (Lock->Lock == EfiLockAcquired);
+  Lock->Lock = EfiLockReleased;
+}
+
+/**
+  The tests issue no non-blocking request, so there is no task to wait for.
+
+  @param Instance    Pointer to the DISK_IO_PRIVATE_DATA.
+
+  @retval TRUE       The Instance->TaskQueue is empty after the completed tasks are removed.
+**/
+BOOLEAN
+DiskIo2RemoveCompletedTask (
+  IN DISK_IO_PRIVATE_DATA  *Instance
+  )
+{
+  return TRUE;
+}
+
+/**
+  Get the counters of the cache.
+
+  @return The counters of the cache.
+**/
+STATIC
+EDKII_DISK_IO_CACHE_STATISTICS
+GetStatistics (
+  VOID
+  )
+{
+  EDKII_DISK_IO_CACHE_STATISTICS  Statistics;
+  EFI_STATUS                      Status;
+
+  Status = mInstance.Cache->Protocol.GetStatistics (&mInstance.Cache->Protocol, &Statistics);
+  ASSERT_EFI_ERROR (Status);
+  return Statistics;
+}
+
+/**
+  Read or write the disk through the cache, the way DiskIoReadDisk () and
+  DiskIoWriteDisk () do it.
+
+  @param  Write       TRUE: Write request; FALSE: Read request.
+  @param  Offset      The starting byte offset on the disk.
+  @param  BufferSize  The size in bytes of Buffer.
+  @param  Buffer      A pointer to the buffer for the data.
+
+  @retval TRUE        The request was served from the cache.
+  @retval FALSE       The request was not served from the cache, or failed.
+**/
+STATIC
+BOOLEAN
+CachedReadWrite (
+  IN BOOLEAN  Write,
+  IN UINT64   Offset,
+  IN UINTN    BufferSize,
+  IN VOID     *Buffer
+  )
+{
+  EFI_STATUS  Status;
+  BOOLEAN     Served;
+
+  EfiAcquireLock (&mInstance.Cache->Lock);
+  Served = DiskIoCacheReadWrite (&mInstance, Write, mMedia.MediaId, Offset, NULL, BufferSize, Buffer, &Status);
+  EfiReleaseLock (&mInstance.Cache->Lock);
+
+  if (Write && Served && !EFI_ERROR (Status)) {
+    CopyMem (&mExpected[Offset], Buffer, BufferSize);
+  }
+
+  return (BOOLEAN)(Served && !EFI_ERROR (Status));
+}
+
+/**
+  Read one block through the cache and check its data.
+
+  @param  Lba     The logical block address of the block.
+
+  @retval TRUE    The block was read from the cache and holds the expected data.
+  @retval FALSE   The block was not read, or its data is wrong.
+**/
+STATIC
+BOOLEAN
+CheckReadBlock (
+  IN UINT64  Lba
+  )
+{
+  UINT8  Buffer[TEST_BLOCK_SIZE];
+
+  if (!CachedReadWrite (FALSE, Lba * TEST_BLOCK_SIZE, TEST_BLOCK_SIZE, Buffer)) {
+    return FALSE;
+  }
+
+  return (BOOLEAN)(CompareMem (Buffer, &mExpected[Lba * TEST_BLOCK_SIZE], TEST_BLOCK_SIZE) == 0);
+}
+
+/**
+  Write one block, filled with a byte, through the cache.
+
+  @param  Lba     The logical block address of the block.
+  @param  Value   The byte to fill the block with.
+
+  @retval TRUE    The block was written to the cache.
+  @retval FALSE   The block was not written.
+**/
+STATIC
+BOOLEAN
+WriteBlock (
+  IN UINT64  Lba,
+  IN UINT8   Value
+  )
+{
+  UINT8  Buffer[TEST_BLOCK_SIZE];
+
+  SetMem (Buffer, sizeof (Buffer), Value);
+  return CachedReadWrite (TRUE, Lba * TEST_BLOCK_SIZE, TEST_BLOCK_SIZE, Buffer);
+}
+
+/**
+  Fill the memory disk with a pattern and create its cache.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED                      The cache was created.
+  @retval  UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The cache was not created.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+CreateCache (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < sizeof (mDisk); Index++) {
+    mDisk[Index] = (UINT8)(Index * 7 + Index / TEST_BLOCK_SIZE);
+  }
+
+  CopyMem (mExpected, mDisk, sizeof (mDisk));
+
+  mDeviceReads  = 0;
+  mDeviceWrites = 0;
+  mTpl          = TPL_APPLICATION;
+
+  ZeroMem (&mBootServices, sizeof (mBootServices));
+  mBootServices.RaiseTPL       = TestRaiseTpl;
+  mBootServices.RestoreTPL     = TestRestoreTpl;
+  mBootServices.CreateEventEx  = TestCreateEventEx;
+  mBootServices.CloseEvent     = TestCloseEvent;
+  mBootServices.LocateProtocol = TestLocateProtocol;
+  gBS                          = &mBootServices;
+
+  ZeroMem (&mInstance, sizeof (mInstance));
+  mInstance.Signature           = DISK_IO_PRIVATE_DATA_SIGNATURE;
+  mInstance.BlockIo             = &mBlockIo;
+  mInstance.SharedWorkingBuffer = AllocatePool (PcdGet32 (PcdDiskIoDataBufferBlockNum) * TEST_BLOCK_SIZE);
+  if (mInstance.SharedWorkingBuffer == NULL) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  DiskIoCacheCreate (&mInstance);
+  if ((mInstance.Cache == NULL) ||
+      (mInstance.Cache->BlockNum != TEST_CACHE_BLOCK_NUM) ||
+      (mInstance.Cache->MaxIoBlockNum != TEST_MAX_IO_BLOCK_NUM) ||
+      (mInstance.Cache->MaxDirtyBlockNum != TEST_MAX_DIRTY_NUM))
+  {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Free the cache of the memory disk.
+
+  @param[in]  Context    Unused.
+**/
+STATIC
+VOID
+EFIAPI
+DestroyCache (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  DiskIoCacheDestroy (&mInstance);
+  if (mInstance.SharedWorkingBuffer != NULL) {
+    FreePool (mInstance.SharedWorkingBuffer);
+    mInstance.SharedWorkingBuffer = NULL;
+  }
+}
+
+/**
+  Verify that a block is read from the device once, then from the cache, also
+  through an unaligned request.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ReadShouldHitAfterMiss (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EDKII_DISK_IO_CACHE_STATISTICS  Statistics;
+  UINT8                           Buffer[100];
+
+  UT_ASSERT_TRUE (CheckReadBlock (3));
+  Statistics = GetStatistics ();
+  UT_ASSERT_EQUAL (Statistics.ReadMisses, 1);
+  UT_ASSERT_EQUAL (Statistics.ReadHits, 0);
+  UT_ASSERT_EQUAL (mDeviceReads, 1);
+
+  UT_ASSERT_TRUE (CachedReadWrite (FALSE, 3 * TEST_BLOCK_SIZE + 200, sizeof (Buffer), Buffer));
+  UT_ASSERT_MEM_EQUAL (Buffer, &mExpected[3 * TEST_BLOCK_SIZE + 200], sizeof (Buffer));
+  Statistics = GetStatistics ();
+  UT_ASSERT_EQUAL (Statistics.ReadMisses, 1);
+  UT_ASSERT_EQUAL (Statistics.ReadHits, 1);
+  UT_ASSERT_EQUAL (mDeviceReads, 1);
+
+  //
+  // The bytes spanning two blocks read the missing block only.
+  //
+  UT_ASSERT_TRUE (CachedReadWrite (FALSE, 4 * TEST_BLOCK_SIZE - 50, sizeof (Buffer), Buffer));
+  UT_ASSERT_MEM_EQUAL (Buffer, &mExpected[4 * TEST_BLOCK_SIZE - 50], sizeof (Buffer));
+  Statistics = GetStatistics ();
+  UT_ASSERT_EQUAL (Statistics.ReadMisses, 2);
+  UT_ASSERT_EQUAL (Statistics.ReadHits, 2);
+  UT_ASSERT_EQUAL (mDeviceReads, 2);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Verify that a full cache evicts the least recently used block.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+FullCacheShouldEvictLeastRecentlyUsed (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EDKII_DISK_IO_CACHE_STATISTICS  Statistics;
+  UINT64                          Lba;
+
+  //
+  // Fill the cache with every other block, so that no read is sequential and
+  // no block is read ahead.
+  //
+  for (Lba = 0; Lba < 2 * TEST_CACHE_BLOCK_NUM; Lba += 2) {
+    UT_ASSERT_TRUE (CheckReadBlock (Lba));
+  }
+
+  Statistics = GetStatistics ();
+  UT_ASSERT_EQUAL (Statistics.ReadMisses, TEST_CACHE_BLOCK_NUM);
+  UT_ASSERT_EQUAL (Statistics.ReadAheadBlocks, 0);
+  UT_ASSERT_EQUAL (Statistics.Evictions, 0);
+
+  //
+  // Block 0 becomes the most recently used one, block 2 the least.
+  //
+  UT_ASSERT_TRUE (CheckReadBlock (0));
+  UT_ASSERT_TRUE (CheckReadBlock (2 * TEST_CACHE_BLOCK_NUM));
+  Statistics = GetStatistics ();
+  UT_ASSERT_EQUAL (Statistics.Evictions, 1);
+  UT_ASSERT_EQUAL (mDeviceReads, TEST_CACHE_BLOCK_NUM + 1);
+
+  UT_ASSERT_TRUE (CheckReadBlock (0));
+  UT_ASSERT_EQUAL (mDeviceReads, TEST_CACHE_BLOCK_NUM + 1);
+
+  UT_ASSERT_TRUE (CheckReadBlock (2));
+  UT_ASSERT_EQUAL (mDeviceReads, TEST_CACHE_BLOCK_NUM + 2);
+  Statistics = GetStatistics ();
+  UT_ASSERT_EQUAL (Statistics.Evictions, 2);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Verify that the modified blocks stay in the cache up to the limit, and that
+  one more modified block writes them back.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+DirtyLimitShouldWriteBack (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EDKII_DISK_IO_CACHE_STATISTICS  Statistics;
+  UINT64                          Lba;
+
+  for (Lba = 0; Lba < TEST_MAX_DIRTY_NUM; Lba++) {
+    UT_ASSERT_TRUE (WriteBlock (10 + 2 * Lba, (UINT8)(0xA0 + Lba)));
+  }
+
+  Statistics = GetStatistics ();
+  UT_ASSERT_EQUAL (Statistics.DirtyBlocks, TEST_MAX_DIRTY_NUM);
+  UT_ASSERT_EQUAL (Statistics.WriteMisses, TEST_MAX_DIRTY_NUM);
+  UT_ASSERT_EQUAL (mDeviceWrites, 0);
+  UT_ASSERT_EQUAL (mDeviceReads, 0);
+
+  //
+  // Rewriting a modified block does not write back.
+  //
+  UT_ASSERT_TRUE (WriteBlock (10, 0xB0));
+  UT_ASSERT_EQUAL (mDeviceWrites, 0);
+  UT_ASSERT_EQUAL (GetStatistics ().WriteHits, 1);
+
+  UT_ASSERT_TRUE (WriteBlock (100, 0xB1));
+  Statistics = GetStatistics ();
+  UT_ASSERT_EQUAL (Statistics.WriteBacks, TEST_MAX_DIRTY_NUM);
+  UT_ASSERT_EQUAL (Statistics.DirtyBlocks, 1);
+  UT_ASSERT_EQUAL (mDeviceWrites, TEST_MAX_DIRTY_NUM);
+
+  //
+  // All but the last block reached the disk.
+  //
+  UT_ASSERT_MEM_EQUAL (&mDisk[10 * TEST_BLOCK_SIZE], &mExpected[10 * TEST_BLOCK_SIZE], 2 * TEST_MAX_DIRTY_NUM * TEST_BLOCK_SIZE);
+  UT_ASSERT_TRUE (CompareMem (&mDisk[100 * TEST_BLOCK_SIZE], &mExpected[100 * TEST_BLOCK_SIZE], TEST_BLOCK_SIZE) != 0);
+  UT_ASSERT_TRUE (CheckReadBlock (100));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Verify that a write of part of a block not in the cache reads the block
+  first, and keeps the bytes the write does not cover.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+PartialBlockWriteShouldReadModifyWrite (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EDKII_DISK_IO_CACHE_STATISTICS  Statistics;
+  UINT8                           Buffer[TEST_BLOCK_SIZE + 100];
+
+  SetMem (Buffer, sizeof (Buffer), 0x5A);
+
+  //
+  // The head of block 5 and the tail of block 6 are read, block 6 is not.
+  //
+  UT_ASSERT_TRUE (CachedReadWrite (TRUE, 5 * TEST_BLOCK_SIZE + 10, TEST_BLOCK_SIZE - 10, Buffer));
+  UT_ASSERT_TRUE (CachedReadWrite (TRUE, 6 * TEST_BLOCK_SIZE, TEST_BLOCK_SIZE, Buffer));
+  UT_ASSERT_TRUE (CachedReadWrite (TRUE, 7 * TEST_BLOCK_SIZE, 110, Buffer));
+  Statistics = GetStatistics ();
+  UT_ASSERT_EQUAL (Statistics.WriteMisses, 3);
+  UT_ASSERT_EQUAL (Statistics.DirtyBlocks, 3);
+  UT_ASSERT_EQUAL (mDeviceReads, 2);
+  UT_ASSERT_EQUAL (mDeviceWrites, 0);
+
+  UT_ASSERT_TRUE (CheckReadBlock (5));
+  UT_ASSERT_TRUE (CheckReadBlock (7));
+  UT_ASSERT_EQUAL (mDeviceReads, 2);
+
+  UT_ASSERT_NOT_EFI_ERROR (mInstance.Cache->Protocol.Flush (&mInstance.Cache->Protocol));
+  UT_ASSERT_MEM_EQUAL (mDisk, mExpected, sizeof (mDisk));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Verify that Flush writes the modified blocks back, each run of consecutive
+  blocks at once.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+FlushShouldWriteBack (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EDKII_DISK_IO_CACHE_STATISTICS  Statistics;
+
+  UT_ASSERT_TRUE (WriteBlock (22, 0x01));
+  UT_ASSERT_TRUE (WriteBlock (20, 0x02));
+  UT_ASSERT_TRUE (WriteBlock (21, 0x03));
+  UT_ASSERT_TRUE (WriteBlock (40, 0x04));
+  UT_ASSERT_EQUAL (mDeviceWrites, 0);
+
+  UT_ASSERT_NOT_EFI_ERROR (mInstance.Cache->Protocol.Flush (&mInstance.Cache->Protocol));
+  Statistics = GetStatistics ();
+  UT_ASSERT_EQUAL (Statistics.DirtyBlocks, 0);
+  UT_ASSERT_EQUAL (Statistics.WriteBacks, 4);
+  UT_ASSERT_EQUAL (mDeviceWrites, 2);
+  UT_ASSERT_MEM_EQUAL (mDisk, mExpected, sizeof (mDisk));
+
+  //
+  // Nothing is left to write back.
+  //
+  UT_ASSERT_NOT_EFI_ERROR (mInstance.Cache->Protocol.Flush (&mInstance.Cache->Protocol));
+  UT_ASSERT_EQUAL (mDeviceWrites, 2);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Verify that the reset notification writes the modified blocks back, unless
+  the system resets above TPL_CALLBACK.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ResetSystemShouldWriteBack (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UT_ASSERT_NOT_NULL (mResetNotify);
+
+  UT_ASSERT_TRUE (WriteBlock (30, 0x11));
+  UT_ASSERT_TRUE (WriteBlock (31, 0x12));
+
+  mTpl = TPL_NOTIFY;
+  mResetNotify (EfiResetCold, EFI_SUCCESS, 0, NULL);
+  UT_ASSERT_EQUAL (mTpl, TPL_NOTIFY);
+  UT_ASSERT_EQUAL (mDeviceWrites, 0);
+  UT_ASSERT_EQUAL (GetStatistics ().DirtyBlocks, 2);
+
+  mTpl = TPL_CALLBACK;
+  mResetNotify (EfiResetCold, EFI_SUCCESS, 0, NULL);
+  UT_ASSERT_EQUAL (mTpl, TPL_CALLBACK);
+  UT_ASSERT_EQUAL (mDeviceWrites, 1);
+  UT_ASSERT_EQUAL (GetStatistics ().DirtyBlocks, 0);
+  UT_ASSERT_MEM_EQUAL (mDisk, mExpected, sizeof (mDisk));
+
+  //
+  // The notification is unregistered with the last write-back cache.
+  //
+  DiskIoCacheDestroy (&mInstance);
+  UT_ASSERT_TRUE (mResetNotify == NULL);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Verify that the before ExitBootServices () event writes the modified blocks
+  back, unless the cache is being accessed.
+
+  @param[in]  Context    Unused.
+
+  @retval  UNIT_TEST_PASSED             The test passed.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+ExitBootServicesShouldWriteBack (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UT_ASSERT_NOT_NULL (mExitBootServicesNotify);
+  UT_ASSERT_TRUE (mExitBootServicesContext == mInstance.Cache);
+
+  UT_ASSERT_TRUE (WriteBlock (50, 0x21));
+  UT_ASSERT_TRUE (WriteBlock (52, 0x22));
+
+  EfiAcquireLock (&mInstance.Cache->Lock);
+  mExitBootServicesNotify ((EFI_EVENT)&mExitBootServicesNotify, mExitBootServicesContext);
+  EfiReleaseLock (&mInstance.Cache->Lock);
+  UT_ASSERT_EQUAL (mDeviceWrites, 0);
+  UT_ASSERT_EQUAL (GetStatistics ().DirtyBlocks, 2);
+
+  mExitBootServicesNotify ((EFI_EVENT)&mExitBootServicesNotify, mExitBootServicesContext);
+  UT_ASSERT_EQUAL (mDeviceWrites, 2);
+  UT_ASSERT_EQUAL (GetStatistics ().DirtyBlocks, 0);
+  UT_ASSERT_MEM_EQUAL (mDisk, mExpected, sizeof (mDisk));
+
+  //
+  // The event is closed with the cache.
+  //
+  DiskIoCacheDestroy (&mInstance);
+  UT_ASSERT_TRUE (mExitBootServicesNotify == NULL);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the block
+  cache of the DiskIo driver and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      CacheTests;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&CacheTests, Framework, "DiskIo Cache Tests", "DiskIoDxe.Cache", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for DiskIo Cache Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // --------------Suite---------Description-----------------------------------Name------------------Function----------------------------------Pre----------Post----------Context
+  //
+  AddTestCase (CacheTests, "Read misses once, then hits", "ReadHitMiss", ReadShouldHitAfterMiss, CreateCache, DestroyCache, NULL);
+  AddTestCase (CacheTests, "Full cache evicts the LRU block", "LruEviction", FullCacheShouldEvictLeastRecentlyUsed, CreateCache, DestroyCache, NULL);
+  AddTestCase (CacheTests, "Dirty block limit writes back", "DirtyLimit", DirtyLimitShouldWriteBack, CreateCache, DestroyCache, NULL);
+  AddTestCase (CacheTests, "Partial block write reads the block", "PartialWrite", PartialBlockWriteShouldReadModifyWrite, CreateCache, DestroyCache, NULL);
+  AddTestCase (CacheTests, "Flush writes back", "Flush", FlushShouldWriteBack, CreateCache, DestroyCache, NULL);
+  AddTestCase (CacheTests, "ResetSystem writes back", "ResetSystem", ResetSystemShouldWriteBack, CreateCache, DestroyCache, NULL);
+  AddTestCase (CacheTests, "ExitBootServices writes back", "ExitBootServices", ExitBootServicesShouldWriteBack, CreateCache, DestroyCache, NULL);
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define DiskIoCacheUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+DiskIoCacheUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}
@@ -5,7 +5,7 @@
   MBR, and GPT partition schemes are supported.
 
 Copyright (c) 2018 Qualcomm Datacenter Technologies, Inc.
-Copyright (c) 2006 - 2018, Intel Corporation. All rights reserved.<BR>
+Copyright (c) 2006 - 2026, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
@@ -768,9 +768,26 @@ PartitionFlushBlocks (
   )
 {
   PARTITION_PRIVATE_DATA  *Private;
+  EFI_STATUS              Status;
 
   Private = PARTITION_DEVICE_FROM_BLOCK_IO_THIS (This);
 
+  //
+  // Flush through the Disk IO protocol, which writes its cached blocks back.
+  // Without Disk IO 2, write the cached blocks back through the Disk IO Cache
+  // protocol before flushing the parent Block IO.
+  //
+  if (Private->DiskIo2 != NULL) {
+    return Private->DiskIo2->FlushDiskEx (Private->DiskIo2, NULL);
+  }
+
+  if (Private->ParentDiskIoCache != NULL) {
+    Status = Private->ParentDiskIoCache->Flush (Private->ParentDiskIoCache);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
   return Private->ParentBlockIo->FlushBlocks (Private->ParentBlockIo);
 }
 
@@ -1167,6 +1184,15 @@ PartitionInstallChildHandle (
   Private->DiskIo         = ParentDiskIo;
   Private->DiskIo2        = ParentDiskIo2;
 
+  //
+  // The Disk IO Cache protocol is installed with the Disk IO protocol opened
+  // BY_DRIVER, so it stays valid as long as the child handle.
+  //
+  Status = gBS->HandleProtocol (ParentHandle, &gEdkiiDiskIoCacheProtocolGuid, (VOID **)&Private->ParentDiskIoCache);
+  if (EFI_ERROR (Status)) {
+    Private->ParentDiskIoCache = NULL;
+  }
+
   //
   // Set the BlockIO into Private Data.
   //
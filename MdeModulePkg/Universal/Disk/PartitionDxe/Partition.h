@@ -5,7 +5,7 @@
   MBR, and GPT partition schemes are supported.
 
 Copyright (c) 2018 Qualcomm Datacenter Technologies, Inc.
-Copyright (c) 2006 - 2018, Intel Corporation. All rights reserved.<BR>
+Copyright (c) 2006 - 2026, Intel Corporation. All rights reserved.<BR>
 SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
@@ -22,6 +22,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/DriverBinding.h>
 #include <Protocol/DiskIo.h>
 #include <Protocol/DiskIo2.h>
+#include <Protocol/DiskIoCache.h>
 #include <Protocol/PartitionInfo.h>
 #include <Library/DebugLib.h>
 #include <Library/UefiDriverEntryPoint.h>
@@ -55,6 +56,7 @@ typedef struct {
   EFI_DISK_IO2_PROTOCOL          *DiskIo2;
   EFI_BLOCK_IO_PROTOCOL          *ParentBlockIo;
   EFI_BLOCK_IO2_PROTOCOL         *ParentBlockIo2;
+  EDKII_DISK_IO_CACHE_PROTOCOL   *ParentDiskIoCache;
   UINT64                         Start;
   UINT64                         End;
   UINT32                         BlockSize;
@@ -0,0 +1,57 @@
+/** @file
+  GUID and data structure of the HOB index configuration table.
+
+  The DXE core installs this table to let HobLib find the HOBs of a type, or the
+  GUID extension HOBs of a GUID, without walking the whole HOB list. The index
+  holds one entry per HOB of the list, sorted by HOB type, then by GUID for the
+  GUID extension HOBs, then by offset in the HOB list.
+
+  The HOB list is read only in DXE, so the index stays valid. A HOB whose type
+  is changed after the index was built is not found through the index by its
+  new type.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef HOB_INDEX_H_
+#define HOB_INDEX_H_
+
+//
+// The HOB index table shall be stored in memory of type EfiBootServicesData.
+//
+#define EDKII_HOB_INDEX_GUID \
+  { \
+    0xb6251410, 0x8cbd, 0x47ee, { 0x98, 0x56, 0xc3, 0x5e, 0x18, 0x7c, 0x30, 0x76 } \
+  }
+
+#define EDKII_HOB_INDEX_SIGNATURE  SIGNATURE_32 ('H', 'I', 'D', 'X')
+
+///
+/// One HOB of the list. Name is the GUID of a GUID extension HOB, and is all
+/// zeroes for the other HOB types.
+///
+typedef struct {
+  EFI_GUID    Name;
+  UINT16      HobType;
+  UINT16      Reserved;
+  UINT32      Offset;
+} EDKII_HOB_INDEX_ENTRY;
+
+///
+/// The header of the HOB index, followed by EntryCount EDKII_HOB_INDEX_ENTRY.
+/// The index covers the HOBs of the list at HobList that start before
+/// HobListLength bytes; EFI_HOB_TYPE_UNUSED HOBs and the end of list HOB
+/// are not indexed.
+///
+typedef struct {
+  UINT32                  Signature;
+  UINT32                  EntryCount;
+  EFI_PHYSICAL_ADDRESS    HobList;
+  UINT64                  HobListLength;
+} EDKII_HOB_INDEX;
+
+extern EFI_GUID  gEdkiiHobIndexGuid;
+
+#endif
@@ -763,6 +763,7 @@ typedef struct {
 // Feature Identifier
 // (ref. spec. v2.1 Figure 32).
 //
+#define NUMBER_OF_QUEUES_FID             0x07  // Number of Queues
 #define POWER_LOSS_SIGNALING_CONFIG_FID  0x1B  // Power Loss Signaling Config
 
 //
@@ -883,8 +884,8 @@ typedef struct {
   //
   UINT8           Opc;       // Opcode
   UINT8           Fuse  : 2; // Fused Operation
-  UINT8           Rsvd1 : 5;
-  UINT8           Psdt  : 1; // PRP or SGL for Data Transfer
+  UINT8           Rsvd1 : 4;
+  UINT8           Psdt  : 2; // PRP or SGL for Data Transfer
   UINT16          Cid;       // Command Identifier
 
   //
@@ -910,6 +911,27 @@ typedef struct {
   NVME_PAYLOAD    Payload;
 } NVME_SQ;
 
+//
+// PRP or SGL for Data Transfer (PSDT)
+//
+#define NVME_PSDT_PRP         0x0 // PRPs are used for the data transfer
+#define NVME_PSDT_SGL_BUFFER  0x1 // SGLs are used, MPTR is the address of a contiguous buffer
+
+//
+// SGL Descriptor
+// (ref. spec. v1.4 Figure 112).
+//
+typedef struct {
+  UINT64    Address;
+  UINT32    Length;
+  UINT8     Rsvd[3];
+  UINT8     SubType : 4;    // SGL Descriptor Sub Type
+  UINT8     Type    : 4;    // SGL Descriptor Type
+} NVME_SGL_DESCRIPTOR;
+
+#define NVME_SGL_TYPE_DATA_BLOCK  0x0
+#define NVME_SGL_SUBTYPE_ADDRESS  0x0
+
 //
 // Completion Queue
 //
@@ -0,0 +1,113 @@
+;------------------------------------------------------------------------------
+;
+; CRC32 and CRC32c through the ARMv8 CRC32 instructions
+;
+; Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+;
+; SPDX-License-Identifier: BSD-2-Clause-Patent
+;
+;------------------------------------------------------------------------------
+
+  EXPORT InternalCrc32Armv8
+  EXPORT InternalCrc32cArmv8
+  AREA BaseLib_LowLevel, CODE, READONLY
+
+;/**
+;  Run the CRC32 of ITU-T V.42 over a buffer with the CRC32 instructions.
+;
+;  The 8-byte loads are aligned, so that the function also runs with the MMU
+;  disabled.
+;
+;  @param[in]  Crc          The CRC register, without the final inversion.
+;  @param[in]  Buffer       A pointer to the buffer.
+;  @param[in]  Length       The number of bytes in the buffer.
+;
+;  @return The CRC register after the buffer.
+;
+;**/
+;UINT32
+;EFIAPI
+;InternalCrc32Armv8 (
+;  IN UINT32       Crc,
+;  IN CONST UINT8  *Buffer,
+;  IN UINTN        Length
+;  );
+;
+InternalCrc32Armv8
+  cbz     x2, Crc32Done
+Crc32Align
+  tst     x1, #7                  ; align the buffer on 8 bytes
+  b.eq    Crc32Aligned
+  ldrb    w3, [x1], #1
+  crc32b  w0, w0, w3
+  subs    x2, x2, #1
+  b.ne    Crc32Align
+  ret
+Crc32Aligned
+  cmp     x2, #8
+  b.lo    Crc32Tail
+Crc32Loop
+  ldr     x3, [x1], #8
+  crc32x  w0, w0, x3
+  sub     x2, x2, #8
+  cmp     x2, #8
+  b.hs    Crc32Loop
+Crc32Tail
+  cbz     x2, Crc32Done
+  ldrb    w3, [x1], #1
+  crc32b  w0, w0, w3
+  sub     x2, x2, #1
+  b       Crc32Tail
+Crc32Done
+  ret
+
+;/**
+;  Run the CRC32c over a buffer with the CRC32C instructions.
+;
+;  The 8-byte loads are aligned, so that the function also runs with the MMU
+;  disabled.
+;
+;  @param[in]  Crc          The CRC register, without the final inversion.
+;  @param[in]  Buffer       A pointer to the buffer.
+;  @param[in]  Length       The number of bytes in the buffer.
+;
+;  @return The CRC register after the buffer.
+;
+;**/
+;UINT32
+;EFIAPI
+;InternalCrc32cArmv8 (
+;  IN UINT32       Crc,
+;  IN CONST UINT8  *Buffer,
+;  IN UINTN        Length
+;  );
+;
+InternalCrc32cArmv8
+  cbz     x2, Crc32cDone
+Crc32cAlign
+  tst     x1, #7                  ; align the buffer on 8 bytes
+  b.eq    Crc32cAligned
+  ldrb    w3, [x1], #1
+  crc32cb w0, w0, w3
+  subs    x2, x2, #1
+  b.ne    Crc32cAlign
+  ret
+Crc32cAligned
+  cmp     x2, #8
+  b.lo    Crc32cTail
+Crc32cLoop
+  ldr     x3, [x1], #8
+  crc32cx w0, w0, x3
+  sub     x2, x2, #8
+  cmp     x2, #8
+  b.hs    Crc32cLoop
+Crc32cTail
+  cbz     x2, Crc32cDone
+  ldrb    w3, [x1], #1
+  crc32cb w0, w0, w3
+  sub     x2, x2, #1
+  b       Crc32cTail
+Crc32cDone
+  ret
+
+  END
@@ -0,0 +1,122 @@
+/** @file
+  CRC32 and CRC32c through the ARMv8 CRC32 instructions.
+
+  The instructions are optional in ARMv8.0, so ID_AA64ISAR0_EL1 is read on
+  every call, which is cheap, as BaseLib has no writable global data to cache
+  it in.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseLibInternals.h"
+
+/**
+  Run the CRC32 of ITU-T V.42 over a buffer with the CRC32 instructions.
+
+  @param[in]  Crc          The CRC register, without the final inversion.
+  @param[in]  Buffer       A pointer to the buffer.
+  @param[in]  Length       The number of bytes in the buffer.
+
+  @return The CRC register after the buffer.
+
+**/
+UINT32
+EFIAPI
+InternalCrc32Armv8 (
+  IN UINT32       Crc,
+  IN CONST UINT8  *Buffer,
+  IN UINTN        Length
+  );
+
+/**
+  Run the CRC32c over a buffer with the CRC32C instructions.
+
+  @param[in]  Crc          The CRC register, without the final inversion.
+  @param[in]  Buffer       A pointer to the buffer.
+  @param[in]  Length       The number of bytes in the buffer.
+
+  @return The CRC register after the buffer.
+
+**/
+UINT32
+EFIAPI
+InternalCrc32cArmv8 (
+  IN UINT32       Crc,
+  IN CONST UINT8  *Buffer,
+  IN UINTN        Length
+  );
+
+/**
+  Check whether the CPU implements the CRC32 instructions.
+
+  @retval TRUE   The CPU implements the CRC32 and CRC32C instructions.
+  @retval FALSE  The CPU does not implement them.
+
+**/
+STATIC
+BOOLEAN
+InternalHasCrc32Instructions (
+  VOID
+  )
+{
+  return (BOOLEAN)(((ArmReadIdAA64Isar0Reg () >> ARM_ID_AA64ISAR0_EL1_CRC32_SHIFT) &
+                    ARM_ID_AA64ISAR0_EL1_CRC32_MASK) >= ARM_ID_AA64ISAR0_EL1_CRC32_HAVE_CRC32_MASK);
+}
+
+/**
+  Run the CRC32 of ITU-T V.42 over a buffer with the CPU CRC instructions.
+
+  The function processes the whole buffer when the CPU implements the CRC32
+  instructions, and none of it otherwise.
+
+  @param[in, out]  Crc     The CRC register, without the final inversion.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+InternalCrc32Accelerated (
+  IN OUT  UINT32       *Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  )
+{
+  if ((Length == 0) || !InternalHasCrc32Instructions ()) {
+    return 0;
+  }
+
+  *Crc = InternalCrc32Armv8 (*Crc, Buffer, Length);
+  return Length;
+}
+
+/**
+  Run the CRC32c over a buffer with the CPU CRC instructions.
+
+  The function processes the whole buffer when the CPU implements the CRC32
+  instructions, and none of it otherwise.
+
+  @param[in, out]  Crc     The CRC register, without the final inversion.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+InternalCrc32cAccelerated (
+  IN OUT  UINT32       *Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  )
+{
+  if ((Length == 0) || !InternalHasCrc32Instructions ()) {
+    return 0;
+  }
+
+  *Crc = InternalCrc32cArmv8 (*Crc, Buffer, Length);
+  return Length;
+}
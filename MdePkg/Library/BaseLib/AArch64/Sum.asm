@@ -0,0 +1,109 @@
+;------------------------------------------------------------------------------
+;
+; Sums of 8-bit, 16-bit and 32-bit values through AdvSIMD
+;
+; Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+;
+; SPDX-License-Identifier: BSD-2-Clause-Patent
+;
+;------------------------------------------------------------------------------
+
+  EXPORT InternalSum8Neon
+  EXPORT InternalSum16Neon
+  EXPORT InternalSum32Neon
+  AREA BaseLib_LowLevel, CODE, READONLY
+
+;/**
+;  Sum the 8-bit values of a buffer with AdvSIMD.
+;
+;  @param[in]  Buffer       A pointer to the buffer.
+;  @param[in]  Length       The number of bytes in the buffer, a non-zero
+;                           multiple of 64.
+;
+;  @return The sum in the low 8 bits, with the carry bits dropped.
+;
+;**/
+;UINT32
+;EFIAPI
+;InternalSum8Neon (
+;  IN CONST UINT8  *Buffer,
+;  IN UINTN        Length
+;  );
+;
+InternalSum8Neon
+  movi    v0.16b, #0
+Sum8Loop
+  ld1     {v1.16b, v2.16b, v3.16b, v4.16b}, [x0], #64  ; element loads, aligned as the buffer
+  add     v1.16b, v1.16b, v2.16b
+  add     v3.16b, v3.16b, v4.16b
+  add     v0.16b, v0.16b, v1.16b
+  add     v0.16b, v0.16b, v3.16b
+  subs    x1, x1, #64
+  b.ne    Sum8Loop
+  addv    b0, v0.16b
+  umov    w0, v0.b[0]
+  ret
+
+;/**
+;  Sum the 16-bit values of a buffer with AdvSIMD.
+;
+;  @param[in]  Buffer       A pointer to the buffer.
+;  @param[in]  Length       The number of bytes in the buffer, a non-zero
+;                           multiple of 64.
+;
+;  @return The sum in the low 16 bits, with the carry bits dropped.
+;
+;**/
+;UINT32
+;EFIAPI
+;InternalSum16Neon (
+;  IN CONST UINT16  *Buffer,
+;  IN UINTN         Length
+;  );
+;
+InternalSum16Neon
+  movi    v0.16b, #0
+Sum16Loop
+  ld1     {v1.8h, v2.8h, v3.8h, v4.8h}, [x0], #64  ; element loads, aligned as the buffer
+  add     v1.8h, v1.8h, v2.8h
+  add     v3.8h, v3.8h, v4.8h
+  add     v0.8h, v0.8h, v1.8h
+  add     v0.8h, v0.8h, v3.8h
+  subs    x1, x1, #64
+  b.ne    Sum16Loop
+  addv    h0, v0.8h
+  umov    w0, v0.h[0]
+  ret
+
+;/**
+;  Sum the 32-bit values of a buffer with AdvSIMD.
+;
+;  @param[in]  Buffer       A pointer to the buffer.
+;  @param[in]  Length       The number of bytes in the buffer, a non-zero
+;                           multiple of 64.
+;
+;  @return The sum in the low 32 bits, with the carry bits dropped.
+;
+;**/
+;UINT32
+;EFIAPI
+;InternalSum32Neon (
+;  IN CONST UINT32  *Buffer,
+;  IN UINTN         Length
+;  );
+;
+InternalSum32Neon
+  movi    v0.16b, #0
+Sum32Loop
+  ld1     {v1.4s, v2.4s, v3.4s, v4.4s}, [x0], #64  ; element loads, aligned as the buffer
+  add     v1.4s, v1.4s, v2.4s
+  add     v3.4s, v3.4s, v4.4s
+  add     v0.4s, v0.4s, v1.4s
+  add     v0.4s, v0.4s, v3.4s
+  subs    x1, x1, #64
+  b.ne    Sum32Loop
+  addv    s0, v0.4s
+  umov    w0, v0.s[0]
+  ret
+
+  END
@@ -0,0 +1,146 @@
+/** @file
+  Sums of 8-bit, 16-bit and 32-bit values through AdvSIMD (NEON).
+
+  AdvSIMD is part of ARMv8-A, so no ID register check is needed.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseLibInternals.h"
+
+//
+// The vector loop takes 64 bytes at a time. The buffers shorter than this
+// are left to the scalar loop.
+//
+#define SUM_ACCELERATED_MIN_LENGTH  64
+
+/**
+  Sum the 8-bit values of a buffer with AdvSIMD.
+
+  @param[in]  Buffer       A pointer to the buffer.
+  @param[in]  Length       The number of bytes in the buffer, a non-zero
+                           multiple of 64.
+
+  @return The sum in the low 8 bits, with the carry bits dropped.
+
+**/
+UINT32
+EFIAPI
+InternalSum8Neon (
+  IN CONST UINT8  *Buffer,
+  IN UINTN        Length
+  );
+
+/**
+  Sum the 16-bit values of a buffer with AdvSIMD.
+
+  @param[in]  Buffer       A pointer to the buffer.
+  @param[in]  Length       The number of bytes in the buffer, a non-zero
+                           multiple of 64.
+
+  @return The sum in the low 16 bits, with the carry bits dropped.
+
+**/
+UINT32
+EFIAPI
+InternalSum16Neon (
+  IN CONST UINT16  *Buffer,
+  IN UINTN         Length
+  );
+
+/**
+  Sum the 32-bit values of a buffer with AdvSIMD.
+
+  @param[in]  Buffer       A pointer to the buffer.
+  @param[in]  Length       The number of bytes in the buffer, a non-zero
+                           multiple of 64.
+
+  @return The sum in the low 32 bits, with the carry bits dropped.
+
+**/
+UINT32
+EFIAPI
+InternalSum32Neon (
+  IN CONST UINT32  *Buffer,
+  IN UINTN         Length
+  );
+
+/**
+  Add the 8-bit values of a buffer to a sum with the CPU vector instructions.
+
+  @param[in, out]  Sum     The sum, with the carry bits dropped.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+InternalSum8Accelerated (
+  IN OUT  UINT8        *Sum,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  )
+{
+  if (Length < SUM_ACCELERATED_MIN_LENGTH) {
+    return 0;
+  }
+
+  Length &= ~(UINTN)(SUM_ACCELERATED_MIN_LENGTH - 1);
+  *Sum    = (UINT8)(*Sum + InternalSum8Neon (Buffer, Length));
+  return Length;
+}
+
+/**
+  Add the 16-bit values of a buffer to a sum with the CPU vector instructions.
+
+  @param[in, out]  Sum     The sum, with the carry bits dropped.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+InternalSum16Accelerated (
+  IN OUT  UINT16        *Sum,
+  IN      CONST UINT16  *Buffer,
+  IN      UINTN         Length
+  )
+{
+  if (Length < SUM_ACCELERATED_MIN_LENGTH) {
+    return 0;
+  }
+
+  Length &= ~(UINTN)(SUM_ACCELERATED_MIN_LENGTH - 1);
+  *Sum    = (UINT16)(*Sum + InternalSum16Neon (Buffer, Length));
+  return Length;
+}
+
+/**
+  Add the 32-bit values of a buffer to a sum with the CPU vector instructions.
+
+  @param[in, out]  Sum     The sum, with the carry bits dropped.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+InternalSum32Accelerated (
+  IN OUT  UINT32        *Sum,
+  IN      CONST UINT32  *Buffer,
+  IN      UINTN         Length
+  )
+{
+  if (Length < SUM_ACCELERATED_MIN_LENGTH) {
+    return 0;
+  }
+
+  Length &= ~(UINTN)(SUM_ACCELERATED_MIN_LENGTH - 1);
+  *Sum    = (UINT32)(*Sum + InternalSum32Neon (Buffer, Length));
+  return Length;
+}
@@ -553,6 +553,111 @@ InternalAsciiHexCharToUintn (
   IN      CHAR8  Char
   );
 
+/**
+  Run the CRC32 of ITU-T V.42 over a buffer with the CPU CRC instructions.
+
+  The function processes as many bytes from the start of the buffer as the
+  CPU instructions can take, which may be none when the CPU lacks them or the
+  buffer is too short for them to pay off.
+
+  @param[in, out]  Crc     The CRC register, without the final inversion.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+InternalCrc32Accelerated (
+  IN OUT  UINT32       *Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  );
+
+/**
+  Run the CRC32c over a buffer with the CPU CRC instructions.
+
+  The function processes as many bytes from the start of the buffer as the
+  CPU instructions can take, which may be none when the CPU lacks them or the
+  buffer is too short for them to pay off.
+
+  @param[in, out]  Crc     The CRC register, without the final inversion.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+InternalCrc32cAccelerated (
+  IN OUT  UINT32       *Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  );
+
+/**
+  Add the 8-bit values of a buffer to a sum with the CPU vector instructions.
+
+  The function processes as many bytes from the start of the buffer as the
+  CPU instructions can take, which may be none when the buffer is too short
+  for them to pay off.
+
+  @param[in, out]  Sum     The sum, with the carry bits dropped.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+InternalSum8Accelerated (
+  IN OUT  UINT8        *Sum,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  );
+
+/**
+  Add the 16-bit values of a buffer to a sum with the CPU vector instructions.
+
+  The function processes as many bytes from the start of the buffer as the
+  CPU instructions can take, which may be none when the buffer is too short
+  for them to pay off.
+
+  @param[in, out]  Sum     The sum, with the carry bits dropped.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+InternalSum16Accelerated (
+  IN OUT  UINT16        *Sum,
+  IN      CONST UINT16  *Buffer,
+  IN      UINTN         Length
+  );
+
+/**
+  Add the 32-bit values of a buffer to a sum with the CPU vector instructions.
+
+  The function processes as many bytes from the start of the buffer as the
+  CPU instructions can take, which may be none when the buffer is too short
+  for them to pay off.
+
+  @param[in, out]  Sum     The sum, with the carry bits dropped.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+InternalSum32Accelerated (
+  IN OUT  UINT32        *Sum,
+  IN      CONST UINT32  *Buffer,
+  IN      UINTN         Length
+  );
+
 //
 // Ia32 and x64 specific functions
 //
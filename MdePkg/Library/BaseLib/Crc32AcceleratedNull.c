@@ -0,0 +1,49 @@
+/** @file
+  Null CRC acceleration, for the CPUs with no CRC instructions.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseLibInternals.h"
+
+/**
+  Run the CRC32 of ITU-T V.42 over a buffer with the CPU CRC instructions.
+
+  @param[in, out]  Crc     The CRC register, without the final inversion.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return 0, as the CPU has no CRC instructions.
+
+**/
+UINTN
+InternalCrc32Accelerated (
+  IN OUT  UINT32       *Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  )
+{
+  return 0;
+}
+
+/**
+  Run the CRC32c over a buffer with the CPU CRC instructions.
+
+  @param[in, out]  Crc     The CRC register, without the final inversion.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return 0, as the CPU has no CRC instructions.
+
+**/
+UINTN
+InternalCrc32cAccelerated (
+  IN OUT  UINT32       *Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  )
+{
+  return 0;
+}
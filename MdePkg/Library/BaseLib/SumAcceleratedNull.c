@@ -0,0 +1,69 @@
+/** @file
+  Null vector sums, for the CPUs with no vector instructions BaseLib can use.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseLibInternals.h"
+
+/**
+  Add the 8-bit values of a buffer to a sum with the CPU vector instructions.
+
+  @param[in, out]  Sum     The sum, with the carry bits dropped.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return 0, as no vector instructions are used.
+
+**/
+UINTN
+InternalSum8Accelerated (
+  IN OUT  UINT8        *Sum,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  )
+{
+  return 0;
+}
+
+/**
+  Add the 16-bit values of a buffer to a sum with the CPU vector instructions.
+
+  @param[in, out]  Sum     The sum, with the carry bits dropped.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return 0, as no vector instructions are used.
+
+**/
+UINTN
+InternalSum16Accelerated (
+  IN OUT  UINT16        *Sum,
+  IN      CONST UINT16  *Buffer,
+  IN      UINTN         Length
+  )
+{
+  return 0;
+}
+
+/**
+  Add the 32-bit values of a buffer to a sum with the CPU vector instructions.
+
+  @param[in, out]  Sum     The sum, with the carry bits dropped.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return 0, as no vector instructions are used.
+
+**/
+UINTN
+InternalSum32Accelerated (
+  IN OUT  UINT32        *Sum,
+  IN      CONST UINT32  *Buffer,
+  IN      UINTN         Length
+  )
+{
+  return 0;
+}
@@ -0,0 +1,132 @@
+/** @file
+  CRC32 and CRC32c through the PCLMULQDQ and SSE4.2 instructions.
+
+  BaseLib has no writable global data, as it also runs from flash, so the
+  CPU features are read with CPUID on every call. CPUID is slow, even more so
+  under a hypervisor, which is why the short buffers are left to the tables.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "BaseLibInternals.h"
+#include <Register/Intel/Cpuid.h>
+
+//
+// The buffers shorter than this are left to the tables.
+//
+#define CRC32_ACCELERATED_MIN_LENGTH  512
+
+/**
+  Run the CRC32 of ITU-T V.42 over a buffer with PCLMULQDQ folding.
+
+  @param[in]  Crc          The CRC register, without the final inversion.
+  @param[in]  Buffer       A pointer to the buffer.
+  @param[in]  Length       The number of bytes in the buffer, a multiple of 16,
+                           and at least 64.
+
+  @return The CRC register after the buffer.
+
+**/
+UINT32
+EFIAPI
+InternalCrc32Pclmul (
+  IN UINT32       Crc,
+  IN CONST UINT8  *Buffer,
+  IN UINTN        Length
+  );
+
+/**
+  Run the CRC32c over a buffer with the SSE4.2 CRC32 instruction.
+
+  @param[in]  Crc          The CRC register, without the final inversion.
+  @param[in]  Buffer       A pointer to the buffer.
+  @param[in]  Length       The number of bytes in the buffer.
+
+  @return The CRC register after the buffer.
+
+**/
+UINT32
+EFIAPI
+InternalCrc32cSse42 (
+  IN UINT32       Crc,
+  IN CONST UINT8  *Buffer,
+  IN UINTN        Length
+  );
+
+/**
+  Run the CRC32 of ITU-T V.42 over a buffer with the CPU CRC instructions.
+
+  The function processes as many bytes from the start of the buffer as the
+  CPU instructions can take, which may be none when the CPU lacks them or the
+  buffer is too short for them to pay off.
+
+  @param[in, out]  Crc     The CRC register, without the final inversion.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+InternalCrc32Accelerated (
+  IN OUT  UINT32       *Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  )
+{
+  CPUID_VERSION_INFO_ECX  Ecx;
+
+  if (Length < CRC32_ACCELERATED_MIN_LENGTH) {
+    return 0;
+  }
+
+  AsmCpuid (CPUID_VERSION_INFO, NULL, NULL, &Ecx.Uint32, NULL);
+  if ((Ecx.Bits.PCLMULQDQ == 0) || (Ecx.Bits.SSE4_1 == 0)) {
+    return 0;
+  }
+
+  //
+  // The folding takes whole 16-byte blocks only.
+  //
+  Length &= ~(UINTN)0xF;
+  *Crc    = InternalCrc32Pclmul (*Crc, Buffer, Length);
+  return Length;
+}
+
+/**
+  Run the CRC32c over a buffer with the CPU CRC instructions.
+
+  The function processes as many bytes from the start of the buffer as the
+  CPU instructions can take, which may be none when the CPU lacks them or the
+  buffer is too short for them to pay off.
+
+  @param[in, out]  Crc     The CRC register, without the final inversion.
+  @param[in]       Buffer  A pointer to the buffer.
+  @param[in]       Length  The number of bytes in the buffer.
+
+  @return The number of bytes processed from the start of the buffer.
+
+**/
+UINTN
+InternalCrc32cAccelerated (
+  IN OUT  UINT32       *Crc,
+  IN      CONST UINT8  *Buffer,
+  IN      UINTN        Length
+  )
+{
+  CPUID_VERSION_INFO_ECX  Ecx;
+
+  if (Length < CRC32_ACCELERATED_MIN_LENGTH) {
+    return 0;
+  }
+
+  AsmCpuid (CPUID_VERSION_INFO, NULL, NULL, &Ecx.Uint32, NULL);
+  if (Ecx.Bits.SSE4_2 == 0) {
+    return 0;
+  }
+
+  *Crc = InternalCrc32cSse42 (*Crc, Buffer, Length);
+  return Length;
+}
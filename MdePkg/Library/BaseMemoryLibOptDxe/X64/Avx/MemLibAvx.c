@@ -0,0 +1,241 @@
+/** @file
+  Selection of the X64 kernels of the Base Memory Library.
+
+  The AVX2 and AVX-512 kernels are used when the processor supports them and
+  the OS, the firmware here, enabled their state in XCR0. The processor is
+  checked once, on the first large request. All the processors are assumed
+  to have the same XSAVE configuration as the one doing the check.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Register/Intel/Cpuid.h>
+#include "MemLibAvx.h"
+
+//
+// XCR0 bits of the SSE, AVX and AVX-512 states.
+//
+#define XCR0_AVX2_STATE    (BIT1 | BIT2)
+#define XCR0_AVX512_STATE  (BIT1 | BIT2 | BIT5 | BIT6 | BIT7)
+
+STATIC MEM_LIB_AVX_LEVEL  mMemLibAvxLevel = MemLibAvxUnknown;
+
+/**
+  Get the widest vector extension usable by the kernels.
+
+  @return The AVX level of the processor.
+
+**/
+STATIC
+MEM_LIB_AVX_LEVEL
+InternalMemGetAvxLevel (
+  VOID
+  )
+{
+  UINT32                                       MaxLeaf;
+  CPUID_VERSION_INFO_ECX                       VersionEcx;
+  CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS_EBX  ExtendedEbx;
+  UINT64                                       Xcr0;
+  MEM_LIB_AVX_LEVEL                            Level;
+
+  if (mMemLibAvxLevel != MemLibAvxUnknown) {
+    return mMemLibAvxLevel;
+  }
+
+  Level = MemLibAvxNone;
+  AsmCpuid (CPUID_SIGNATURE, &MaxLeaf, NULL, NULL, NULL);
+  if (MaxLeaf >= CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS) {
+    AsmCpuid (CPUID_VERSION_INFO, NULL, NULL, &VersionEcx.Uint32, NULL);
+    if ((VersionEcx.Bits.OSXSAVE != 0) && (VersionEcx.Bits.AVX != 0)) {
+      AsmCpuidEx (
+        CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS,
+        CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS_SUB_LEAF_INFO,
+        NULL,
+        &ExtendedEbx.Uint32,
+        NULL,
+        NULL
+        );
+      Xcr0 = AsmXGetBv (0);
+      if ((ExtendedEbx.Bits.AVX2 != 0) && ((Xcr0 & XCR0_AVX2_STATE) == XCR0_AVX2_STATE)) {
+        Level = MemLibAvx2;
+        if ((ExtendedEbx.Bits.AVX512F != 0) && (ExtendedEbx.Bits.AVX512BW != 0) &&
+            ((Xcr0 & XCR0_AVX512_STATE) == XCR0_AVX512_STATE))
+        {
+          Level = MemLibAvx512;
+        }
+      }
+    }
+  }
+
+  mMemLibAvxLevel = Level;
+  return Level;
+}
+
+/**
+  Copy Length bytes from Source to Destination.
+
+  @param  DestinationBuffer The target of the copy request.
+  @param  SourceBuffer      The place to copy from.
+  @param  Length            The number of bytes to copy.
+
+  @return Destination.
+
+**/
+VOID *
+EFIAPI
+InternalMemCopyMem (
+  OUT     VOID        *DestinationBuffer,
+  IN      CONST VOID  *SourceBuffer,
+  IN      UINTN       Length
+  )
+{
+  //
+  // The AVX kernels only copy forward, so they only take the buffers that
+  // do not overlap.
+  //
+  if ((Length >= MEM_LIB_AVX_THRESHOLD) &&
+      ((UINTN)DestinationBuffer - (UINTN)SourceBuffer >= Length) &&
+      ((UINTN)SourceBuffer - (UINTN)DestinationBuffer >= Length))
+  {
+    switch (InternalMemGetAvxLevel ()) {
+      case MemLibAvx512:
+        return InternalMemCopyMemAvx512 (DestinationBuffer, SourceBuffer, Length);
+      case MemLibAvx2:
+        return InternalMemCopyMemAvx2 (DestinationBuffer, SourceBuffer, Length);
+      default:
+        break;
+    }
+  }
+
+  return InternalMemCopyMemDefault (DestinationBuffer, SourceBuffer, Length);
+}
+
+/**
+  Set Buffer to Value for Size bytes.
+
+  @param  Buffer   The memory to set.
+  @param  Length   The number of bytes to set.
+  @param  Value    The value of the set operation.
+
+  @return Buffer
+
+**/
+VOID *
+EFIAPI
+InternalMemSetMem (
+  OUT     VOID   *Buffer,
+  IN      UINTN  Length,
+  IN      UINT8  Value
+  )
+{
+  if (Length >= MEM_LIB_AVX_THRESHOLD) {
+    switch (InternalMemGetAvxLevel ()) {
+      case MemLibAvx512:
+        return InternalMemSetMemAvx512 (Buffer, Length, Value);
+      case MemLibAvx2:
+        return InternalMemSetMemAvx2 (Buffer, Length, Value);
+      default:
+        break;
+    }
+  }
+
+  return InternalMemSetMemDefault (Buffer, Length, Value);
+}
+
+/**
+  Set Buffer to 0 for Size bytes.
+
+  @param  Buffer   The memory to set.
+  @param  Length   The number of bytes to set.
+
+  @return Buffer
+
+**/
+VOID *
+EFIAPI
+InternalMemZeroMem (
+  OUT     VOID   *Buffer,
+  IN      UINTN  Length
+  )
+{
+  if (Length >= MEM_LIB_AVX_THRESHOLD) {
+    switch (InternalMemGetAvxLevel ()) {
+      case MemLibAvx512:
+        return InternalMemSetMemAvx512 (Buffer, Length, 0);
+      case MemLibAvx2:
+        return InternalMemSetMemAvx2 (Buffer, Length, 0);
+      default:
+        break;
+    }
+  }
+
+  return InternalMemZeroMemDefault (Buffer, Length);
+}
+
+/**
+  Compares two memory buffers of a given length.
+
+  @param  DestinationBuffer The first memory buffer.
+  @param  SourceBuffer      The second memory buffer.
+  @param  Length            The length of DestinationBuffer and SourceBuffer memory
+                            regions to compare. Must be non-zero.
+
+  @return 0                 All Length bytes of the two buffers are identical.
+  @retval Non-zero          The first mismatched byte in SourceBuffer subtracted from the first
+                            mismatched byte in DestinationBuffer.
+
+**/
+INTN
+EFIAPI
+InternalMemCompareMem (
+  IN      CONST VOID  *DestinationBuffer,
+  IN      CONST VOID  *SourceBuffer,
+  IN      UINTN       Length
+  )
+{
+  if (Length >= MEM_LIB_AVX_THRESHOLD) {
+    switch (InternalMemGetAvxLevel ()) {
+      case MemLibAvx512:
+        return InternalMemCompareMemAvx512 (DestinationBuffer, SourceBuffer, Length);
+      case MemLibAvx2:
+        return InternalMemCompareMemAvx2 (DestinationBuffer, SourceBuffer, Length);
+      default:
+        break;
+    }
+  }
+
+  return InternalMemCompareMemDefault (DestinationBuffer, SourceBuffer, Length);
+}
+
+/**
+  Checks whether the contents of a buffer are all zeros.
+
+  @param  Buffer  The pointer to the buffer to be checked.
+  @param  Length  The size of the buffer (in bytes) to be checked.
+
+  @retval TRUE    Contents of the buffer are all zeros.
+  @retval FALSE   Contents of the buffer are not all zeros.
+
+**/
+BOOLEAN
+EFIAPI
+InternalMemIsZeroBuffer (
+  IN CONST VOID  *Buffer,
+  IN UINTN       Length
+  )
+{
+  if (Length >= MEM_LIB_AVX_THRESHOLD) {
+    switch (InternalMemGetAvxLevel ()) {
+      case MemLibAvx512:
+        return InternalMemIsZeroBufferAvx512 (Buffer, Length);
+      case MemLibAvx2:
+        return InternalMemIsZeroBufferAvx2 (Buffer, Length);
+      default:
+        break;
+    }
+  }
+
+  return InternalMemIsZeroBufferDefault (Buffer, Length);
+}
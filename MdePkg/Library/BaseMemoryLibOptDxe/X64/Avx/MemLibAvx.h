@@ -0,0 +1,268 @@
+/** @file
+  Declaration of the X64 kernels of the Base Memory Library using AVX2 and
+  AVX-512.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef MEM_LIB_AVX_H_
+#define MEM_LIB_AVX_H_
+
+#include "MemLibInternals.h"
+
+//
+// Buffers shorter than this are handled by the REP and SSE2 kernels, which
+// do not pay for the AVX state transitions and the interrupt masking.
+//
+#define MEM_LIB_AVX_THRESHOLD  512
+
+typedef enum {
+  MemLibAvxUnknown,
+  MemLibAvxNone,
+  MemLibAvx2,
+  MemLibAvx512
+} MEM_LIB_AVX_LEVEL;
+
+/**
+  Copy Length bytes from Source to Destination using REP MOVSB and SSE2.
+
+  @param  DestinationBuffer The target of the copy request.
+  @param  SourceBuffer      The place to copy from.
+  @param  Length            The number of bytes to copy.
+
+  @return Destination.
+
+**/
+VOID *
+EFIAPI
+InternalMemCopyMemDefault (
+  OUT     VOID        *DestinationBuffer,
+  IN      CONST VOID  *SourceBuffer,
+  IN      UINTN       Length
+  );
+
+/**
+  Copy Length bytes from Source to Destination using AVX2.
+
+  @param  DestinationBuffer The target of the copy request. It must not overlap
+                            SourceBuffer.
+  @param  SourceBuffer      The place to copy from.
+  @param  Length            The number of bytes to copy, at least 64.
+
+  @return Destination.
+
+**/
+VOID *
+EFIAPI
+InternalMemCopyMemAvx2 (
+  OUT     VOID        *DestinationBuffer,
+  IN      CONST VOID  *SourceBuffer,
+  IN      UINTN       Length
+  );
+
+/**
+  Copy Length bytes from Source to Destination using AVX-512.
+
+  @param  DestinationBuffer The target of the copy request. It must not overlap
+                            SourceBuffer.
+  @param  SourceBuffer      The place to copy from.
+  @param  Length            The number of bytes to copy, at least 128.
+
+  @return Destination.
+
+**/
+VOID *
+EFIAPI
+InternalMemCopyMemAvx512 (
+  OUT     VOID        *DestinationBuffer,
+  IN      CONST VOID  *SourceBuffer,
+  IN      UINTN       Length
+  );
+
+/**
+  Set Buffer to Value for Size bytes using REP STOS.
+
+  @param  Buffer   The memory to set.
+  @param  Length   The number of bytes to set.
+  @param  Value    The value of the set operation.
+
+  @return Buffer
+
+**/
+VOID *
+EFIAPI
+InternalMemSetMemDefault (
+  OUT     VOID   *Buffer,
+  IN      UINTN  Length,
+  IN      UINT8  Value
+  );
+
+/**
+  Set Buffer to Value for Size bytes using AVX2.
+
+  @param  Buffer   The memory to set.
+  @param  Length   The number of bytes to set, at least 64.
+  @param  Value    The value of the set operation.
+
+  @return Buffer
+
+**/
+VOID *
+EFIAPI
+InternalMemSetMemAvx2 (
+  OUT     VOID   *Buffer,
+  IN      UINTN  Length,
+  IN      UINT8  Value
+  );
+
+/**
+  Set Buffer to Value for Size bytes using AVX-512.
+
+  @param  Buffer   The memory to set.
+  @param  Length   The number of bytes to set, at least 128.
+  @param  Value    The value of the set operation.
+
+  @return Buffer
+
+**/
+VOID *
+EFIAPI
+InternalMemSetMemAvx512 (
+  OUT     VOID   *Buffer,
+  IN      UINTN  Length,
+  IN      UINT8  Value
+  );
+
+/**
+  Set Buffer to 0 for Size bytes using REP STOS.
+
+  @param  Buffer   The memory to set.
+  @param  Length   The number of bytes to set.
+
+  @return Buffer
+
+**/
+VOID *
+EFIAPI
+InternalMemZeroMemDefault (
+  OUT     VOID   *Buffer,
+  IN      UINTN  Length
+  );
+
+/**
+  Compares two memory buffers of a given length using REPE CMPSB.
+
+  @param  DestinationBuffer The first memory buffer.
+  @param  SourceBuffer      The second memory buffer.
+  @param  Length            The length of DestinationBuffer and SourceBuffer memory
+                            regions to compare. Must be non-zero.
+
+  @return 0                 All Length bytes of the two buffers are identical.
+  @retval Non-zero          The first mismatched byte in SourceBuffer subtracted from the first
+                            mismatched byte in DestinationBuffer.
+
+**/
+INTN
+EFIAPI
+InternalMemCompareMemDefault (
+  IN      CONST VOID  *DestinationBuffer,
+  IN      CONST VOID  *SourceBuffer,
+  IN      UINTN       Length
+  );
+
+/**
+  Compares two memory buffers of a given length using AVX2.
+
+  @param  DestinationBuffer The first memory buffer.
+  @param  SourceBuffer      The second memory buffer.
+  @param  Length            The length of DestinationBuffer and SourceBuffer memory
+                            regions to compare, at least 32.
+
+  @return 0                 All Length bytes of the two buffers are identical.
+  @retval Non-zero          The first mismatched byte in SourceBuffer subtracted from the first
+                            mismatched byte in DestinationBuffer.
+
+**/
+INTN
+EFIAPI
+InternalMemCompareMemAvx2 (
+  IN      CONST VOID  *DestinationBuffer,
+  IN      CONST VOID  *SourceBuffer,
+  IN      UINTN       Length
+  );
+
+/**
+  Compares two memory buffers of a given length using AVX-512.
+
+  @param  DestinationBuffer The first memory buffer.
+  @param  SourceBuffer      The second memory buffer.
+  @param  Length            The length of DestinationBuffer and SourceBuffer memory
+                            regions to compare, at least 64.
+
+  @return 0                 All Length bytes of the two buffers are identical.
+  @retval Non-zero          The first mismatched byte in SourceBuffer subtracted from the first
+                            mismatched byte in DestinationBuffer.
+
+**/
+INTN
+EFIAPI
+InternalMemCompareMemAvx512 (
+  IN      CONST VOID  *DestinationBuffer,
+  IN      CONST VOID  *SourceBuffer,
+  IN      UINTN       Length
+  );
+
+/**
+  Checks whether the contents of a buffer are all zeros using REPE SCAS.
+
+  @param  Buffer  The pointer to the buffer to be checked.
+  @param  Length  The size of the buffer (in bytes) to be checked.
+
+  @retval TRUE    Contents of the buffer are all zeros.
+  @retval FALSE   Contents of the buffer are not all zeros.
+
+**/
+BOOLEAN
+EFIAPI
+InternalMemIsZeroBufferDefault (
+  IN CONST VOID  *Buffer,
+  IN UINTN       Length
+  );
+
+/**
+  Checks whether the contents of a buffer are all zeros using AVX2.
+
+  @param  Buffer  The pointer to the buffer to be checked.
+  @param  Length  The size of the buffer (in bytes) to be checked, at least 32.
+
+  @retval TRUE    Contents of the buffer are all zeros.
+  @retval FALSE   Contents of the buffer are not all zeros.
+
+**/
+BOOLEAN
+EFIAPI
+InternalMemIsZeroBufferAvx2 (
+  IN CONST VOID  *Buffer,
+  IN UINTN       Length
+  );
+
+/**
+  Checks whether the contents of a buffer are all zeros using AVX-512.
+
+  @param  Buffer  The pointer to the buffer to be checked.
+  @param  Length  The size of the buffer (in bytes) to be checked, at least 64.
+
+  @retval TRUE    Contents of the buffer are all zeros.
+  @retval FALSE   Contents of the buffer are not all zeros.
+
+**/
+BOOLEAN
+EFIAPI
+InternalMemIsZeroBufferAvx512 (
+  IN CONST VOID  *Buffer,
+  IN UINTN       Length
+  );
+
+#endif
@@ -0,0 +1,42 @@
+/** @file
+  Internal definitions of the HOB Library for Dxe Phase.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef DXE_HOB_LIB_INTERNAL_H_
+#define DXE_HOB_LIB_INTERNAL_H_
+
+#include <PiDxe.h>
+
+#include <Guid/HobIndex.h>
+
+/**
+  Find where to start the search of a HOB with the HOB index.
+
+  Returns the first indexed HOB at or after HobStart that is of type Type and,
+  for a GUID extension HOB, of GUID Guid. If there is none, returns the first
+  HOB that the index does not cover, normally the end of list HOB. If the
+  index cannot answer, returns HobStart. Either way, walking the HOB list from
+  the returned HOB finds the same HOB as walking it from HobStart.
+
+  @param  HobIndex      The HOB index, or NULL.
+  @param  Type          The HOB type to search.
+  @param  Guid          The GUID to search if Type is EFI_HOB_TYPE_GUID_EXTENSION,
+                        or NULL to search the HOBs of any GUID.
+  @param  HobStart      The HOB to search from.
+
+  @return The HOB to walk the HOB list from.
+
+**/
+VOID *
+HobIndexFindNext (
+  IN CONST EDKII_HOB_INDEX  *HobIndex  OPTIONAL,
+  IN UINT16                 Type,
+  IN CONST EFI_GUID         *Guid      OPTIONAL,
+  IN CONST VOID             *HobStart
+  );
+
+#endif
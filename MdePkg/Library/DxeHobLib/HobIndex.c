@@ -0,0 +1,144 @@
+/** @file
+  HOB index lookup for the HOB Library for Dxe Phase.
+
+Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeHobLibInternal.h"
+
+#include <Library/BaseMemoryLib.h>
+
+/**
+  Compare an index entry with a search key.
+
+  @param  Entry         The index entry.
+  @param  Type          The HOB type of the key.
+  @param  Name          The GUID of the key.
+  @param  Offset        The offset of the key.
+
+  @retval <0            Entry is before the key.
+  @retval 0             Entry equals the key.
+  @retval >0            Entry is after the key.
+
+**/
+STATIC
+INTN
+HobIndexCompare (
+  IN CONST EDKII_HOB_INDEX_ENTRY  *Entry,
+  IN UINT16                       Type,
+  IN CONST EFI_GUID               *Name,
+  IN UINT32                       Offset
+  )
+{
+  INTN  Result;
+
+  if (Entry->HobType != Type) {
+    return (INTN)Entry->HobType - (INTN)Type;
+  }
+
+  Result = CompareMem (&Entry->Name, Name, sizeof (EFI_GUID));
+  if (Result != 0) {
+    return Result;
+  }
+
+  if (Entry->Offset != Offset) {
+    return (Entry->Offset < Offset) ? -1 : 1;
+  }
+
+  return 0;
+}
+
+/**
+  Find where to start the search of a HOB with the HOB index.
+
+  Returns the first indexed HOB at or after HobStart that is of type Type and,
+  for a GUID extension HOB, of GUID Guid. If there is none, returns the first
+  HOB that the index does not cover, normally the end of list HOB. If the
+  index cannot answer, returns HobStart. Either way, walking the HOB list from
+  the returned HOB finds the same HOB as walking it from HobStart.
+
+  @param  HobIndex      The HOB index, or NULL.
+  @param  Type          The HOB type to search.
+  @param  Guid          The GUID to search if Type is EFI_HOB_TYPE_GUID_EXTENSION,
+                        or NULL to search the HOBs of any GUID.
+  @param  HobStart      The HOB to search from.
+
+  @return The HOB to walk the HOB list from.
+
+**/
+VOID *
+HobIndexFindNext (
+  IN CONST EDKII_HOB_INDEX  *HobIndex  OPTIONAL,
+  IN UINT16                 Type,
+  IN CONST EFI_GUID         *Guid      OPTIONAL,
+  IN CONST VOID             *HobStart
+  )
+{
+  CONST EDKII_HOB_INDEX_ENTRY  *Entry;
+  EFI_PEI_HOB_POINTERS         Hob;
+  EFI_GUID                     Name;
+  UINT8                        *HobList;
+  UINTN                        Offset;
+  UINTN                        Low;
+  UINTN                        High;
+  UINTN                        Middle;
+
+  if (HobIndex == NULL) {
+    return (VOID *)HobStart;
+  }
+
+  //
+  // The GUID extension HOBs are sorted by GUID, so they can only be looked
+  // up with their GUID. The unused HOBs are not indexed.
+  //
+  if ((Type == EFI_HOB_TYPE_UNUSED) || (Type == EFI_HOB_TYPE_END_OF_HOB_LIST) ||
+      ((Type == EFI_HOB_TYPE_GUID_EXTENSION) != (Guid != NULL)))
+  {
+    return (VOID *)HobStart;
+  }
+
+  HobList = (UINT8 *)(UINTN)HobIndex->HobList;
+  if (((UINT8 *)HobStart < HobList) || ((UINT8 *)HobStart > HobList + (UINTN)HobIndex->HobListLength)) {
+    return (VOID *)HobStart;
+  }
+
+  Offset = (UINT8 *)HobStart - HobList;
+  if (Guid != NULL) {
+    CopyGuid (&Name, Guid);
+  } else {
+    ZeroMem (&Name, sizeof (Name));
+  }
+
+  //
+  // Find the first entry that is not before the key (Type, Name, Offset)
+  //
+  Entry = (CONST EDKII_HOB_INDEX_ENTRY *)(HobIndex + 1);
+  Low   = 0;
+  High  = HobIndex->EntryCount;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    if (HobIndexCompare (&Entry[Middle], Type, &Name, (UINT32)Offset) < 0) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  //
+  // Skip the HOBs that changed type since the index was built
+  //
+  for ( ; Low < HobIndex->EntryCount; Low++) {
+    if ((Entry[Low].HobType != Type) || !CompareGuid (&Entry[Low].Name, &Name)) {
+      break;
+    }
+
+    Hob.Raw = HobList + Entry[Low].Offset;
+    if ((Hob.Header->HobType == Type) && ((Guid == NULL) || CompareGuid (&Hob.Guid->Name, Guid))) {
+      return Hob.Raw;
+    }
+  }
+
+  return HobList + (UINTN)HobIndex->HobListLength;
+}
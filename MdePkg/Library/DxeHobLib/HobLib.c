@@ -6,7 +6,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
 
-#include <PiDxe.h>
+#include "DxeHobLibInternal.h"
 
 #include <Guid/HobList.h>
 
@@ -15,7 +15,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
 
-VOID  *mHobList = NULL;
+VOID             *mHobList  = NULL;
+EDKII_HOB_INDEX  *mHobIndex = NULL;
 
 /**
   Returns the pointer to the HOB list.
@@ -30,7 +31,8 @@ VOID  *mHobList = NULL;
 
   If the pointer to the HOB list is NULL, then ASSERT().
 
-  This function also caches the pointer to the HOB list retrieved.
+  This function also caches the pointer to the HOB list retrieved, and the
+  pointer to the HOB index if the DXE core installed one for this HOB list.
 
   @return The pointer to the HOB list.
 
@@ -47,6 +49,14 @@ GetHobList (
     Status = EfiGetSystemConfigurationTable (&gEfiHobListGuid, &mHobList);
     ASSERT_EFI_ERROR (Status);
     ASSERT (mHobList != NULL);
+
+    Status = EfiGetSystemConfigurationTable (&gEdkiiHobIndexGuid, (VOID **)&mHobIndex);
+    if (EFI_ERROR (Status) ||
+        (mHobIndex->Signature != EDKII_HOB_INDEX_SIGNATURE) ||
+        (mHobIndex->HobList != (EFI_PHYSICAL_ADDRESS)(UINTN)mHobList))
+    {
+      mHobIndex = NULL;
+    }
   }
 
   return mHobList;
@@ -102,7 +112,7 @@ GetNextHob (
 
   ASSERT (HobStart != NULL);
 
-  Hob.Raw = (UINT8 *)HobStart;
+  Hob.Raw = HobIndexFindNext (mHobIndex, Type, NULL, HobStart);
   //
   // Parse the HOB list until end of list or matching type is found.
   //
@@ -173,7 +183,7 @@ GetNextGuidHob (
 {
   EFI_PEI_HOB_POINTERS  GuidHob;
 
-  GuidHob.Raw = (UINT8 *)HobStart;
+  GuidHob.Raw = HobIndexFindNext (mHobIndex, EFI_HOB_TYPE_GUID_EXTENSION, Guid, HobStart);
   while ((GuidHob.Raw = GetNextHob (EFI_HOB_TYPE_GUID_EXTENSION, GuidHob.Raw)) != NULL) {
     if (CompareGuid (Guid, &GuidHob.Guid->Name)) {
       break;
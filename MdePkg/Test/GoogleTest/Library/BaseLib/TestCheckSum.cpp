@@ -6,15 +6,114 @@
 **/
 
 #include <Library/GoogleTestLib.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
 extern "C" {
   #include <Base.h>
   #include <Library/BaseLib.h>
+ #if defined (MDE_CPU_IA32) || defined (MDE_CPU_X64)
+  #include <Library/UnitTestHostBaseLib.h>
+ #endif
 }
 
+#if defined (MDE_CPU_X64)
+  #if defined (_MSC_VER)
+    #include <intrin.h>
+  #else
+    #include <cpuid.h>
+  #endif
+#endif
+
 // Precomputed crc32c and crc16-ansi for "hello" (without the null byte)
 constexpr STATIC UINT32  mHelloCrc32c = 0x9A71BB4C;
 constexpr STATIC UINT16  mHelloCrc16  = 0x34F6;
 
+// Check values of the CRC catalogue, for "123456789"
+constexpr STATIC UINT32  mCheckCrc32  = 0xCBF43926;
+constexpr STATIC UINT32  mCheckCrc32c = 0xE3069283;
+
+// Reflected polynomials of CRC32 (ITU-T V.42) and CRC32c (Castagnoli)
+constexpr STATIC UINT32  mCrc32Polynomial  = 0xEDB88320;
+constexpr STATIC UINT32  mCrc32cPolynomial = 0x82F63B78;
+
+/**
+  Bit-wise reference implementation of a reflected 32-bit CRC.
+
+  @param[in]  Polynomial  The reflected polynomial.
+  @param[in]  Crc         The CRC register.
+  @param[in]  Buffer      The buffer.
+  @param[in]  Length      The number of bytes in the buffer.
+
+  @return The CRC register after the buffer.
+**/
+STATIC
+UINT32
+ReferenceCrc (
+  IN UINT32       Polynomial,
+  IN UINT32       Crc,
+  IN CONST UINT8  *Buffer,
+  IN UINTN        Length
+  )
+{
+  UINTN  Bit;
+
+  while (Length-- != 0) {
+    Crc ^= *(Buffer++);
+    for (Bit = 0; Bit < 8; Bit++) {
+      Crc = (Crc >> 1) ^ (((Crc & 1) != 0) ? Polynomial : 0);
+    }
+  }
+
+  return Crc;
+}
+
+#if defined (MDE_CPU_X64)
+
+/**
+  Run the CPUID instruction of the host, so that BaseLib uses the CRC
+  instructions of the host CPU.
+**/
+STATIC
+UINT32
+EFIAPI
+HostAsmCpuid (
+  IN      UINT32  Index,
+  OUT     UINT32  *Eax   OPTIONAL,
+  OUT     UINT32  *Ebx   OPTIONAL,
+  OUT     UINT32  *Ecx   OPTIONAL,
+  OUT     UINT32  *Edx   OPTIONAL
+  )
+{
+  UINT32  Registers[4];
+
+ #if defined (_MSC_VER)
+  __cpuid ((int *)Registers, (int)Index);
+ #else
+  __cpuid (Index, Registers[0], Registers[1], Registers[2], Registers[3]);
+ #endif
+  if (Eax != NULL) {
+    *Eax = Registers[0];
+  }
+
+  if (Ebx != NULL) {
+    *Ebx = Registers[1];
+  }
+
+  if (Ecx != NULL) {
+    *Ecx = Registers[2];
+  }
+
+  if (Edx != NULL) {
+    *Edx = Registers[3];
+  }
+
+  return Index;
+}
+
+#endif
+
 TEST (Crc32c, BasicCheck) {
   // Note: The magic numbers below are precomputed checksums
   // Check for basic operation on even and odd numbers of bytes
@@ -62,3 +161,279 @@ TEST (Crc16, MultipartCheck) {
   val = CalculateCrc16Ansi ("hel", 3, CRC16ANSI_INIT);
   EXPECT_EQ (CalculateCrc16Ansi (&"hello"[3], 2, val), mHelloCrc16);
 }
+
+// Test fixture running the CRC functions either with the tables only, or with
+// the CRC instructions of the host CPU when BaseLib has a path for them.
+class CrcAcceleration : public ::testing::TestWithParam<bool> {
+protected:
+ #if defined (MDE_CPU_IA32) || defined (MDE_CPU_X64)
+  UNIT_TEST_HOST_BASE_LIB_ASM_CPUID SavedAsmCpuid;
+ #endif
+  std::vector<UINT8> Buffer;
+
+  void
+  SetUp (
+    ) override
+  {
+    UINTN  Index;
+
+   #if defined (MDE_CPU_IA32) || defined (MDE_CPU_X64)
+    //
+    // The default CPUID of the host BaseLib reports no CRC instructions.
+    //
+    SavedAsmCpuid = gUnitTestHostBaseLib.X86->AsmCpuid;
+   #endif
+    if (GetParam ()) {
+     #if defined (MDE_CPU_X64)
+      gUnitTestHostBaseLib.X86->AsmCpuid = HostAsmCpuid;
+     #else
+      GTEST_SKIP () << "No CRC instructions path for this architecture";
+     #endif
+    }
+
+    Buffer.resize (SIZE_4MB + 16);
+    for (Index = 0; Index < Buffer.size (); Index++) {
+      Buffer[Index] = (UINT8)((Index * 2654435761U) >> 13);
+    }
+  }
+
+  void
+  TearDown (
+    ) override
+  {
+   #if defined (MDE_CPU_IA32) || defined (MDE_CPU_X64)
+    gUnitTestHostBaseLib.X86->AsmCpuid = SavedAsmCpuid;
+   #endif
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P (
+  TablesAndCpu,
+  CrcAcceleration,
+  ::testing::Values (false, true)
+  );
+
+TEST_P (CrcAcceleration, CheckValues) {
+  EXPECT_EQ (CalculateCrc32 ((VOID *)"123456789", 9), mCheckCrc32);
+  EXPECT_EQ (CalculateCrc32c ("123456789", 9, 0), mCheckCrc32c);
+  EXPECT_EQ (CalculateCrc32 ((VOID *)"", 0), 0U);
+}
+
+TEST_P (CrcAcceleration, MatchesReference) {
+  // Cover every alignment, the lengths around the 8-byte and 16-byte blocks,
+  // and the lengths on both sides of the point where the CRC instructions
+  // take over.
+  UINTN   Alignment;
+  UINTN   Length;
+  UINT8   *Data;
+  UINT32  Seed;
+
+  for (Alignment = 0; Alignment < 16; Alignment++) {
+    for (Length = 0; Length <= 1100; Length++) {
+      Data = &Buffer[Alignment];
+      Seed = (UINT32)(Length * 0x9E3779B9);
+      ASSERT_EQ (
+        CalculateCrc32 (Data, Length),
+        ~ReferenceCrc (mCrc32Polynomial, MAX_UINT32, Data, Length)
+        ) << "Alignment " << Alignment << " Length " << Length;
+      ASSERT_EQ (
+        CalculateCrc32c (Data, Length, Seed),
+        ~ReferenceCrc (mCrc32cPolynomial, ~Seed, Data, Length)
+        ) << "Alignment " << Alignment << " Length " << Length;
+    }
+  }
+
+  for (Length = SIZE_4MB - 1; Length <= SIZE_4MB + 1; Length++) {
+    Data = &Buffer[Length & 0xF];
+    ASSERT_EQ (
+      CalculateCrc32 (Data, Length),
+      ~ReferenceCrc (mCrc32Polynomial, MAX_UINT32, Data, Length)
+      ) << "Length " << Length;
+    ASSERT_EQ (
+      CalculateCrc32c (Data, Length, 0),
+      ~ReferenceCrc (mCrc32cPolynomial, MAX_UINT32, Data, Length)
+      ) << "Length " << Length;
+  }
+}
+
+TEST_P (CrcAcceleration, MultipartCheck) {
+  // A CRC32c split at any point matches the CRC32c of the whole buffer, also
+  // when one part goes through the CRC instructions and the other does not.
+  UINT32  Whole;
+  UINTN   Split;
+
+  Whole = CalculateCrc32c (&Buffer[0], 5000, 0);
+  for (Split = 0; Split <= 5000; Split += 97) {
+    EXPECT_EQ (
+      CalculateCrc32c (&Buffer[Split], 5000 - Split, CalculateCrc32c (&Buffer[0], Split, 0)),
+      Whole
+      ) << "Split " << Split;
+  }
+}
+
+TEST_P (CrcAcceleration, Throughput) {
+  // Report the throughput on multi-MiB buffers. The numbers are for
+  // information only, and do not fail the test.
+  STATIC CONST UINTN  Sizes[] = { SIZE_4MB, SIZE_16MB };
+  UINTN               SizeIndex;
+  UINTN               Size;
+  UINTN               Iteration;
+  UINT32              Crc;
+  double              Crc32Seconds;
+  double              Crc32cSeconds;
+
+  Crc = 0;
+  for (SizeIndex = 0; SizeIndex < ARRAY_SIZE (Sizes); SizeIndex++) {
+    Size = Sizes[SizeIndex];
+    Buffer.resize (Size);
+
+    auto  Start = std::chrono::steady_clock::now ();
+    for (Iteration = 0; Iteration < 4; Iteration++) {
+      Crc ^= CalculateCrc32 (&Buffer[0], Size);
+    }
+
+    auto  Middle = std::chrono::steady_clock::now ();
+    for (Iteration = 0; Iteration < 4; Iteration++) {
+      Crc ^= CalculateCrc32c (&Buffer[0], Size, Crc);
+    }
+
+    auto  End = std::chrono::steady_clock::now ();
+
+    Crc32Seconds  = std::chrono::duration<double>(Middle - Start).count ();
+    Crc32cSeconds = std::chrono::duration<double>(End - Middle).count ();
+    std::cout << (GetParam () ? "CPU   " : "Tables") << " " << (Size >> 20) << " MiB: "
+              << "CRC32 " << (UINT64)(4.0 * Size / (1 << 20) / Crc32Seconds) << " MiB/s, "
+              << "CRC32c " << (UINT64)(4.0 * Size / (1 << 20) / Crc32cSeconds) << " MiB/s"
+              << std::endl;
+  }
+}
+
+/**
+  Scalar reference sum of the values of type T of a buffer.
+
+  @param[in]  Buffer  The buffer.
+  @param[in]  Length  The number of bytes in the buffer, a multiple of the
+                      size of T.
+
+  @return The sum, with the carry bits dropped.
+**/
+template <typename T>
+STATIC
+T
+ReferenceSum (
+  IN CONST UINT8  *Buffer,
+  IN UINTN        Length
+  )
+{
+  T      Sum;
+  T      Value;
+  UINTN  Index;
+
+  Sum = 0;
+  for (Index = 0; Index < Length; Index += sizeof (T)) {
+    memcpy (&Value, &Buffer[Index], sizeof (T));
+    Sum = (T)(Sum + Value);
+  }
+
+  return Sum;
+}
+
+TEST (Sum, MatchesReference) {
+  // Cover every alignment the functions accept, and the lengths around the
+  // 64-byte blocks of the vector loops.
+  std::vector<UINT8>  Buffer (SIZE_64KB + 16);
+  UINTN               Index;
+  UINTN               Alignment;
+  UINTN               Length;
+  UINT8               *Data;
+
+  for (Index = 0; Index < Buffer.size (); Index++) {
+    Buffer[Index] = (UINT8)((Index * 2654435761U) >> 11);
+  }
+
+  for (Alignment = 0; Alignment < 16; Alignment++) {
+    Data = &Buffer[Alignment];
+    for (Length = 0; Length <= 600; Length++) {
+      ASSERT_EQ (CalculateSum8 (Data, Length), ReferenceSum<UINT8>(Data, Length))
+        << "Alignment " << Alignment << " Length " << Length;
+      ASSERT_EQ (
+        CalculateCheckSum8 (Data, Length),
+        (UINT8)(0x100 - ReferenceSum<UINT8>(Data, Length))
+        ) << "Alignment " << Alignment << " Length " << Length;
+      if (((Alignment | Length) & 0x1) == 0) {
+        ASSERT_EQ (CalculateSum16 ((UINT16 *)Data, Length), ReferenceSum<UINT16>(Data, Length))
+          << "Alignment " << Alignment << " Length " << Length;
+      }
+
+      if (((Alignment | Length) & 0x3) == 0) {
+        ASSERT_EQ (CalculateSum32 ((UINT32 *)Data, Length), ReferenceSum<UINT32>(Data, Length))
+          << "Alignment " << Alignment << " Length " << Length;
+      }
+    }
+  }
+
+  Length = SIZE_64KB;
+  Data   = &Buffer[0];
+  EXPECT_EQ (CalculateSum8 (Data, Length), ReferenceSum<UINT8>(Data, Length));
+  EXPECT_EQ (CalculateSum16 ((UINT16 *)Data, Length), ReferenceSum<UINT16>(Data, Length));
+  EXPECT_EQ (CalculateSum32 ((UINT32 *)Data, Length), ReferenceSum<UINT32>(Data, Length));
+}
+
+TEST (Sum, Throughput) {
+  // Report the throughput of the sums next to the scalar reference on a
+  // multi-MiB buffer, the size of a large firmware volume. The numbers are
+  // for information only, and do not fail the test. Note that the host
+  // compiler may vectorize the reference, which firmware builds at -Os do not.
+  STATIC CONST UINTN  Widths[] = { 1, 2, 4 };
+  std::vector<UINT8>  Buffer (SIZE_16MB);
+  UINTN               WidthIndex;
+  UINTN               Width;
+  UINT32              Sum;
+  UINT32              Reference;
+  double              Seconds;
+  double              ReferenceSeconds;
+
+  for (WidthIndex = 0; WidthIndex < Buffer.size (); WidthIndex++) {
+    Buffer[WidthIndex] = (UINT8)WidthIndex;
+  }
+
+  for (WidthIndex = 0; WidthIndex < ARRAY_SIZE (Widths); WidthIndex++) {
+    Width = Widths[WidthIndex];
+
+    auto  Start = std::chrono::steady_clock::now ();
+    switch (Width) {
+      case 1:
+        Sum = CalculateSum8 (&Buffer[0], Buffer.size ());
+        break;
+      case 2:
+        Sum = CalculateSum16 ((UINT16 *)&Buffer[0], Buffer.size ());
+        break;
+      default:
+        Sum = CalculateSum32 ((UINT32 *)&Buffer[0], Buffer.size ());
+        break;
+    }
+
+    auto  Middle = std::chrono::steady_clock::now ();
+    switch (Width) {
+      case 1:
+        Reference = ReferenceSum<UINT8>(&Buffer[0], Buffer.size ());
+        break;
+      case 2:
+        Reference = ReferenceSum<UINT16>(&Buffer[0], Buffer.size ());
+        break;
+      default:
+        Reference = ReferenceSum<UINT32>(&Buffer[0], Buffer.size ());
+        break;
+    }
+
+    auto  End = std::chrono::steady_clock::now ();
+
+    EXPECT_EQ (Sum, Reference);
+
+    Seconds          = std::chrono::duration<double>(Middle - Start).count ();
+    ReferenceSeconds = std::chrono::duration<double>(End - Middle).count ();
+    std::cout << "CalculateSum" << (8 * Width) << " 16 MiB: "
+              << (UINT64)(16.0 / Seconds) << " MiB/s, scalar reference "
+              << (UINT64)(16.0 / ReferenceSeconds) << " MiB/s" << std::endl;
+  }
+}
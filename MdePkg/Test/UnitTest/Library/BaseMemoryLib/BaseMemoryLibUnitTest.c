@@ -0,0 +1,792 @@
+/** @file
+  Unit tests and throughput benchmark of the BaseMemoryLib instances.
+
+  The same tests run from the host environment, against the instance of the
+  host build and against the AVX2 and AVX-512 flavor of BaseMemoryLibOptDxe,
+  and from the UEFI Shell, against the instance the application is linked
+  with. The results are checked against byte by byte reference loops, which
+  do what the generic BaseMemoryLib instance does.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_APP_NAME     "BaseMemoryLib Unit Test Application"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+//
+// The buffers are TEST_GUARD_SIZE bytes larger on both sides than the largest
+// request, so that the tests can check the bytes around each request are left
+// unchanged, and offset the requests by up to TEST_MAX_ALIGNMENT - 1 bytes.
+//
+#define TEST_MAX_ALIGNMENT  64
+#define TEST_GUARD_SIZE     64
+#define TEST_GUARD_BYTE     0xA5
+#define TEST_MAX_SIZE       SIZE_128KB
+#define TEST_BUFFER_SIZE    (TEST_MAX_SIZE + TEST_MAX_ALIGNMENT + 2 * TEST_GUARD_SIZE)
+
+//
+// Size of the part of the test buffers used by a request of Size bytes.
+//
+#define TEST_USED_SIZE(Size)  ((Size) + TEST_MAX_ALIGNMENT + 2 * TEST_GUARD_SIZE)
+
+//
+// Sizes of the requests above the size from which the AVX flavor of
+// BaseMemoryLibOptDxe uses non-temporal stores, 4MB, with and without tails.
+//
+#define TEST_LARGE_MAX_SIZE     (SIZE_4MB + SIZE_64KB + 97)
+#define TEST_LARGE_BUFFER_SIZE  (TEST_LARGE_MAX_SIZE + TEST_MAX_ALIGNMENT + 2 * TEST_GUARD_SIZE)
+
+#define BENCHMARK_MAX_SIZE     SIZE_8MB
+#define BENCHMARK_BYTES        SIZE_8MB
+#define BENCHMARK_BUFFER_SIZE  (BENCHMARK_MAX_SIZE + TEST_MAX_ALIGNMENT)
+
+typedef struct {
+  UINT8    *Buffer[3];
+} MEMORY_TEST_CONTEXT;
+
+typedef enum {
+  BenchmarkCopyMem,
+  BenchmarkSetMem,
+  BenchmarkZeroMem,
+  BenchmarkCompareMem,
+  BenchmarkIsZeroBuffer,
+  BenchmarkMax
+} BENCHMARK_OPERATION;
+
+//
+// Sizes around the thresholds and the vector widths of the instances.
+//
+STATIC CONST UINTN  mTestSizes[] = {
+  0,    1,    2,    3,    7,    8,     15,    16,    17,    31,    32,   33,
+  63,   64,   65,   127,  128,  129,   255,   256,   257,   511,   512,  513,
+  1000, 1023, 1024, 1025, 4095, 4096,  4097,  65535, 65536, 65537, 70001,
+  TEST_MAX_SIZE
+};
+
+STATIC CONST UINTN  mTestLargeSizes[] = {
+  SIZE_4MB, SIZE_4MB + 1, SIZE_4MB + 63, TEST_LARGE_MAX_SIZE
+};
+
+STATIC CONST UINTN  mBenchmarkSizes[] = {
+  64, 512, SIZE_4KB, SIZE_64KB, SIZE_1MB, SIZE_8MB
+};
+
+//
+// Destination and source alignments of the benchmark.
+//
+STATIC CONST UINTN  mBenchmarkAlignments[][2] = {
+  { 0,  0 },
+  { 1,  0 },
+  { 0,  1 },
+  { 33, 7 }
+};
+
+STATIC CONST CHAR8  *mBenchmarkNames[BenchmarkMax] = {
+  "CopyMem",
+  "SetMem",
+  "ZeroMem",
+  "CompareMem",
+  "IsZeroBuffer"
+};
+
+STATIC UINT32  mRandomSeed;
+
+/**
+  Get a pseudo random number.
+
+  @return A pseudo random number.
+
+**/
+STATIC
+UINT32
+TestRandom (
+  VOID
+  )
+{
+  mRandomSeed = mRandomSeed * 1103515245 + 12345;
+  return mRandomSeed >> 8;
+}
+
+/**
+  Fill a buffer with pseudo random bytes.
+
+  @param[out] Buffer  The buffer to fill.
+  @param[in]  Length  The size of Buffer in bytes.
+
+**/
+STATIC
+VOID
+TestFillRandom (
+  OUT UINT8  *Buffer,
+  IN  UINTN  Length
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Length; Index++) {
+    Buffer[Index] = (UINT8)TestRandom ();
+  }
+}
+
+/**
+  Compare two buffers byte by byte, without using BaseMemoryLib.
+
+  @param[in] Buffer1  The first buffer.
+  @param[in] Buffer2  The second buffer.
+  @param[in] Length   The size of the buffers in bytes.
+
+  @retval TRUE   The buffers are identical.
+  @retval FALSE  The buffers differ.
+
+**/
+STATIC
+BOOLEAN
+TestBuffersEqual (
+  IN CONST UINT8  *Buffer1,
+  IN CONST UINT8  *Buffer2,
+  IN UINTN        Length
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Length; Index++) {
+    if (Buffer1[Index] != Buffer2[Index]) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Check all the bytes of a buffer have a value, without using BaseMemoryLib.
+
+  @param[in] Buffer  The buffer.
+  @param[in] Length  The size of Buffer in bytes.
+  @param[in] Value   The value.
+
+  @retval TRUE   All the bytes of Buffer are Value.
+  @retval FALSE  Some bytes of Buffer are not Value.
+
+**/
+STATIC
+BOOLEAN
+TestBufferIs (
+  IN CONST UINT8  *Buffer,
+  IN UINTN        Length,
+  IN UINT8        Value
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Length; Index++) {
+    if (Buffer[Index] != Value) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Get the alignments to test for a size. All the alignments are tested for
+  the small sizes, and a few of them for the large sizes.
+
+  @param[in] Size  The size of the requests.
+
+  @return The increment between two tested alignments.
+
+**/
+STATIC
+UINTN
+TestAlignmentStep (
+  IN UINTN  Size
+  )
+{
+  return (Size <= SIZE_4KB) ? 1 : 13;
+}
+
+/**
+  Allocate the buffers of the tests.
+
+  @param[in] Context  The MEMORY_TEST_CONTEXT of the test.
+
+  @retval UNIT_TEST_PASSED                The buffers are allocated.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  Out of resources.
+
+**/
+STATIC
+UNIT_TEST_STATUS
+EFIAPI
+AllocateTestBuffers (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  MEMORY_TEST_CONTEXT  *TestContext;
+  UINTN                Index;
+
+  TestContext = (MEMORY_TEST_CONTEXT *)Context;
+  mRandomSeed = 0x5EED;
+  for (Index = 0; Index < ARRAY_SIZE (TestContext->Buffer); Index++) {
+    TestContext->Buffer[Index] = AllocatePool (TEST_BUFFER_SIZE);
+    if (TestContext->Buffer[Index] == NULL) {
+      return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Free the buffers of the tests.
+
+  @param[in] Context  The MEMORY_TEST_CONTEXT of the test.
+
+**/
+STATIC
+VOID
+EFIAPI
+FreeTestBuffers (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  MEMORY_TEST_CONTEXT  *TestContext;
+  UINTN                Index;
+
+  TestContext = (MEMORY_TEST_CONTEXT *)Context;
+  for (Index = 0; Index < ARRAY_SIZE (TestContext->Buffer); Index++) {
+    if (TestContext->Buffer[Index] != NULL) {
+      FreePool (TestContext->Buffer[Index]);
+      TestContext->Buffer[Index] = NULL;
+    }
+  }
+}
+
+/**
+  Check CopyMem () copies the sizes of mTestSizes between buffers of all the
+  alignments, and leaves the bytes around the destination unchanged.
+
+  @param[in] Context  The MEMORY_TEST_CONTEXT of the test.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+CopyMemShouldCopyAllSizesAndAlignments (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  MEMORY_TEST_CONTEXT  *TestContext;
+  UINT8                *Source;
+  UINT8                *Destination;
+  UINTN                SizeIndex;
+  UINTN                Size;
+  UINTN                DestinationAlignment;
+  UINTN                SourceAlignment;
+
+  TestContext = (MEMORY_TEST_CONTEXT *)Context;
+  TestFillRandom (TestContext->Buffer[0], TEST_BUFFER_SIZE);
+
+  for (SizeIndex = 0; SizeIndex < ARRAY_SIZE (mTestSizes); SizeIndex++) {
+    Size = mTestSizes[SizeIndex];
+    for (DestinationAlignment = 0; DestinationAlignment < TEST_MAX_ALIGNMENT; DestinationAlignment += TestAlignmentStep (Size)) {
+      for (SourceAlignment = 0; SourceAlignment < TEST_MAX_ALIGNMENT; SourceAlignment += 4 * TestAlignmentStep (Size) + 1) {
+        Source      = TestContext->Buffer[0] + TEST_GUARD_SIZE + SourceAlignment;
+        Destination = TestContext->Buffer[1] + TEST_GUARD_SIZE + DestinationAlignment;
+        SetMem (TestContext->Buffer[1], TEST_USED_SIZE (Size), TEST_GUARD_BYTE);
+
+        UT_ASSERT_TRUE (CopyMem (Destination, Source, Size) == Destination);
+        UT_ASSERT_TRUE (TestBuffersEqual (Destination, Source, Size));
+        UT_ASSERT_TRUE (TestBufferIs (TestContext->Buffer[1], TEST_GUARD_SIZE + DestinationAlignment, TEST_GUARD_BYTE));
+        UT_ASSERT_TRUE (TestBufferIs (Destination + Size, TEST_GUARD_SIZE, TEST_GUARD_BYTE));
+      }
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check CopyMem () copies overlapping buffers, in both directions, as if it
+  went through an intermediate buffer.
+
+  @param[in] Context  The MEMORY_TEST_CONTEXT of the test.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+CopyMemShouldCopyOverlappingBuffers (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  MEMORY_TEST_CONTEXT  *TestContext;
+  UINT8                *Buffer;
+  UINTN                SizeIndex;
+  UINTN                Size;
+  UINTN                Distance;
+
+  TestContext = (MEMORY_TEST_CONTEXT *)Context;
+  Buffer      = TestContext->Buffer[1];
+
+  for (SizeIndex = 0; SizeIndex < ARRAY_SIZE (mTestSizes); SizeIndex++) {
+    Size = MIN (mTestSizes[SizeIndex], TEST_MAX_SIZE - TEST_MAX_ALIGNMENT);
+    for (Distance = 1; Distance < TEST_MAX_ALIGNMENT; Distance += 7) {
+      //
+      // Destination after Source.
+      //
+      TestFillRandom (TestContext->Buffer[0], Size);
+      CopyMem (Buffer + TEST_GUARD_SIZE, TestContext->Buffer[0], Size);
+      CopyMem (Buffer + TEST_GUARD_SIZE + Distance, Buffer + TEST_GUARD_SIZE, Size);
+      UT_ASSERT_TRUE (TestBuffersEqual (Buffer + TEST_GUARD_SIZE + Distance, TestContext->Buffer[0], Size));
+
+      //
+      // Destination before Source.
+      //
+      CopyMem (Buffer + TEST_GUARD_SIZE + Distance, TestContext->Buffer[0], Size);
+      CopyMem (Buffer + TEST_GUARD_SIZE, Buffer + TEST_GUARD_SIZE + Distance, Size);
+      UT_ASSERT_TRUE (TestBuffersEqual (Buffer + TEST_GUARD_SIZE, TestContext->Buffer[0], Size));
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check SetMem () and ZeroMem () fill the sizes of mTestSizes at all the
+  alignments, and leave the bytes around the buffer unchanged.
+
+  @param[in] Context  The MEMORY_TEST_CONTEXT of the test.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+SetMemShouldFillAllSizesAndAlignments (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  MEMORY_TEST_CONTEXT  *TestContext;
+  UINT8                *Buffer;
+  UINTN                SizeIndex;
+  UINTN                Size;
+  UINTN                Alignment;
+  UINT8                Value;
+
+  TestContext = (MEMORY_TEST_CONTEXT *)Context;
+
+  for (SizeIndex = 0; SizeIndex < ARRAY_SIZE (mTestSizes); SizeIndex++) {
+    Size = mTestSizes[SizeIndex];
+    for (Alignment = 0; Alignment < TEST_MAX_ALIGNMENT; Alignment += TestAlignmentStep (Size)) {
+      Buffer = TestContext->Buffer[1] + TEST_GUARD_SIZE + Alignment;
+      Value  = (UINT8)(Size + Alignment);
+      if (Value == TEST_GUARD_BYTE) {
+        Value = 0;
+      }
+
+      SetMem (TestContext->Buffer[1], TEST_USED_SIZE (Size), TEST_GUARD_BYTE);
+      UT_ASSERT_TRUE (SetMem (Buffer, Size, Value) == Buffer);
+      UT_ASSERT_TRUE (TestBufferIs (Buffer, Size, Value));
+      UT_ASSERT_TRUE (TestBufferIs (TestContext->Buffer[1], TEST_GUARD_SIZE + Alignment, TEST_GUARD_BYTE));
+      UT_ASSERT_TRUE (TestBufferIs (Buffer + Size, TEST_GUARD_SIZE, TEST_GUARD_BYTE));
+
+      SetMem (TestContext->Buffer[1], TEST_USED_SIZE (Size), TEST_GUARD_BYTE);
+      UT_ASSERT_TRUE (ZeroMem (Buffer, Size) == Buffer);
+      UT_ASSERT_TRUE (TestBufferIs (Buffer, Size, 0));
+      UT_ASSERT_TRUE (TestBufferIs (TestContext->Buffer[1], TEST_GUARD_SIZE + Alignment, TEST_GUARD_BYTE));
+      UT_ASSERT_TRUE (TestBufferIs (Buffer + Size, TEST_GUARD_SIZE, TEST_GUARD_BYTE));
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check CompareMem () and IsZeroBuffer () find the first difference and the
+  first non-zero byte at the start, the middle and the end of the sizes of
+  mTestSizes, at all the alignments.
+
+  @param[in] Context  The MEMORY_TEST_CONTEXT of the test.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+CompareMemShouldFindFirstDifference (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  MEMORY_TEST_CONTEXT  *TestContext;
+  UINT8                *Buffer1;
+  UINT8                *Buffer2;
+  UINT8                *Zero;
+  UINTN                SizeIndex;
+  UINTN                Size;
+  UINTN                Alignment;
+  UINTN                Positions[5];
+  UINTN                Index;
+  UINT8                Byte;
+
+  TestContext = (MEMORY_TEST_CONTEXT *)Context;
+  TestFillRandom (TestContext->Buffer[0], TEST_BUFFER_SIZE);
+
+  for (SizeIndex = 1; SizeIndex < ARRAY_SIZE (mTestSizes); SizeIndex++) {
+    Size         = mTestSizes[SizeIndex];
+    Positions[0] = 0;
+    Positions[1] = Size / 2;
+    Positions[2] = Size - 1;
+    Positions[3] = (Size > 33) ? Size - 33 : 0;
+    Positions[4] = (Size > 65) ? Size - 65 : 0;
+    for (Alignment = 0; Alignment < TEST_MAX_ALIGNMENT; Alignment += TestAlignmentStep (Size)) {
+      Buffer1 = TestContext->Buffer[0] + TEST_GUARD_SIZE;
+      Buffer2 = TestContext->Buffer[1] + TEST_GUARD_SIZE + Alignment;
+      Zero    = TestContext->Buffer[2] + TEST_GUARD_SIZE + Alignment;
+      CopyMem (Buffer2, Buffer1, Size);
+      ZeroMem (Zero, Size);
+      UT_ASSERT_EQUAL (CompareMem (Buffer2, Buffer1, Size), 0);
+      UT_ASSERT_TRUE (IsZeroBuffer (Zero, Size));
+
+      for (Index = 0; Index < ARRAY_SIZE (Positions); Index++) {
+        Byte                      = Buffer2[Positions[Index]];
+        Buffer2[Positions[Index]] = (UINT8)(Byte + 1 + TestRandom () % 254);
+        UT_ASSERT_EQUAL (
+          CompareMem (Buffer2, Buffer1, Size),
+          (INTN)Buffer2[Positions[Index]] - (INTN)Buffer1[Positions[Index]]
+          );
+        Buffer2[Positions[Index]] = Byte;
+
+        Zero[Positions[Index]] = 1;
+        UT_ASSERT_FALSE (IsZeroBuffer (Zero, Size));
+        Zero[Positions[Index]] = 0;
+      }
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check CopyMem (), SetMem (), ZeroMem (), CompareMem () and IsZeroBuffer ()
+  handle the sizes of mTestLargeSizes, at a few alignments, and leave the
+  bytes around the destination unchanged.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED                      The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED           The test failed.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The buffers could not be
+                                                allocated.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+LargeBuffersShouldBeHandled (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8  *SourceBuffer;
+  UINT8  *DestinationBuffer;
+  UINT8  *Source;
+  UINT8  *Destination;
+  UINTN  SizeIndex;
+  UINTN  Size;
+  UINTN  Alignment;
+
+  SourceBuffer      = AllocatePool (TEST_LARGE_BUFFER_SIZE);
+  DestinationBuffer = AllocatePool (TEST_LARGE_BUFFER_SIZE);
+  if ((SourceBuffer == NULL) || (DestinationBuffer == NULL)) {
+    if (SourceBuffer != NULL) {
+      FreePool (SourceBuffer);
+    }
+
+    if (DestinationBuffer != NULL) {
+      FreePool (DestinationBuffer);
+    }
+
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  mRandomSeed = 0x5EED;
+  TestFillRandom (SourceBuffer, TEST_LARGE_BUFFER_SIZE);
+
+  for (SizeIndex = 0; SizeIndex < ARRAY_SIZE (mTestLargeSizes); SizeIndex++) {
+    Size = mTestLargeSizes[SizeIndex];
+    for (Alignment = 0; Alignment < TEST_MAX_ALIGNMENT; Alignment += 31) {
+      Source      = SourceBuffer + TEST_GUARD_SIZE + (Alignment * 3 + 5) % TEST_MAX_ALIGNMENT;
+      Destination = DestinationBuffer + TEST_GUARD_SIZE + Alignment;
+
+      SetMem (DestinationBuffer, TEST_LARGE_BUFFER_SIZE, TEST_GUARD_BYTE);
+      UT_ASSERT_TRUE (CopyMem (Destination, Source, Size) == Destination);
+      UT_ASSERT_TRUE (TestBuffersEqual (Destination, Source, Size));
+      UT_ASSERT_TRUE (TestBufferIs (DestinationBuffer, TEST_GUARD_SIZE + Alignment, TEST_GUARD_BYTE));
+      UT_ASSERT_TRUE (TestBufferIs (Destination + Size, TEST_GUARD_SIZE, TEST_GUARD_BYTE));
+
+      UT_ASSERT_EQUAL (CompareMem (Destination, Source, Size), 0);
+      Destination[Size - 1]++;
+      UT_ASSERT_EQUAL (
+        CompareMem (Destination, Source, Size),
+        (INTN)Destination[Size - 1] - (INTN)Source[Size - 1]
+        );
+
+      UT_ASSERT_TRUE (SetMem (Destination, Size, 0x5A) == Destination);
+      UT_ASSERT_TRUE (TestBufferIs (Destination, Size, 0x5A));
+      UT_ASSERT_TRUE (TestBufferIs (DestinationBuffer, TEST_GUARD_SIZE + Alignment, TEST_GUARD_BYTE));
+      UT_ASSERT_TRUE (TestBufferIs (Destination + Size, TEST_GUARD_SIZE, TEST_GUARD_BYTE));
+
+      UT_ASSERT_TRUE (ZeroMem (Destination, Size) == Destination);
+      UT_ASSERT_TRUE (TestBufferIs (Destination, Size, 0));
+      UT_ASSERT_TRUE (TestBufferIs (DestinationBuffer, TEST_GUARD_SIZE + Alignment, TEST_GUARD_BYTE));
+      UT_ASSERT_TRUE (TestBufferIs (Destination + Size, TEST_GUARD_SIZE, TEST_GUARD_BYTE));
+
+      UT_ASSERT_TRUE (IsZeroBuffer (Destination, Size));
+      Destination[Size - 1] = 1;
+      UT_ASSERT_FALSE (IsZeroBuffer (Destination, Size));
+    }
+  }
+
+  FreePool (SourceBuffer);
+  FreePool (DestinationBuffer);
+  return UNIT_TEST_PASSED;
+}
+
+#if defined (MDE_CPU_IA32) || defined (MDE_CPU_X64)
+
+/**
+  Run an operation of the benchmark.
+
+  @param[in] Operation    The operation.
+  @param[in] Destination  The destination buffer.
+  @param[in] Source       The source buffer.
+  @param[in] Size         The size of the buffers in bytes.
+
+**/
+STATIC
+VOID
+BenchmarkRun (
+  IN BENCHMARK_OPERATION  Operation,
+  IN UINT8                *Destination,
+  IN UINT8                *Source,
+  IN UINTN                Size
+  )
+{
+  switch (Operation) {
+    case BenchmarkCopyMem:
+      CopyMem (Destination, Source, Size);
+      break;
+    case BenchmarkSetMem:
+      SetMem (Destination, Size, 0x5A);
+      break;
+    case BenchmarkZeroMem:
+      ZeroMem (Destination, Size);
+      break;
+    case BenchmarkCompareMem:
+      CompareMem (Destination, Source, Size);
+      break;
+    default:
+      IsZeroBuffer (Destination, Size);
+      break;
+  }
+}
+
+/**
+  Measure the throughput of the operations for the sizes of mBenchmarkSizes
+  and the alignments of mBenchmarkAlignments, in bytes per 1000 time stamp
+  counter ticks. CompareMem () compares identical buffers and IsZeroBuffer ()
+  checks a zero buffer, so that both go through the whole buffers.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED                      The benchmark ran.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  Out of resources.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+MeasureThroughput (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT8                *Source;
+  UINT8                *Destination;
+  BENCHMARK_OPERATION  Operation;
+  UINTN                SizeIndex;
+  UINTN                Size;
+  UINTN                AlignmentIndex;
+  UINTN                Iterations;
+  UINTN                Iteration;
+  UINT64               Start;
+  UINT64               Ticks;
+
+  Source      = AllocatePool (BENCHMARK_BUFFER_SIZE);
+  Destination = AllocatePool (BENCHMARK_BUFFER_SIZE);
+  if ((Source == NULL) || (Destination == NULL)) {
+    if (Source != NULL) {
+      FreePool (Source);
+    }
+
+    if (Destination != NULL) {
+      FreePool (Destination);
+    }
+
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  UT_LOG_INFO ("Operation     Size      Alignment  Bytes/KTick\n");
+  for (Operation = 0; Operation < BenchmarkMax; Operation++) {
+    for (SizeIndex = 0; SizeIndex < ARRAY_SIZE (mBenchmarkSizes); SizeIndex++) {
+      Size       = mBenchmarkSizes[SizeIndex];
+      Iterations = BENCHMARK_BYTES / Size;
+      for (AlignmentIndex = 0; AlignmentIndex < ARRAY_SIZE (mBenchmarkAlignments); AlignmentIndex++) {
+        ZeroMem (Source, BENCHMARK_BUFFER_SIZE);
+        ZeroMem (Destination, BENCHMARK_BUFFER_SIZE);
+
+        //
+        // Warm the caches and the translations once, then measure.
+        //
+        BenchmarkRun (
+          Operation,
+          Destination + mBenchmarkAlignments[AlignmentIndex][0],
+          Source + mBenchmarkAlignments[AlignmentIndex][1],
+          Size
+          );
+        Start = AsmReadTsc ();
+        for (Iteration = 0; Iteration < Iterations; Iteration++) {
+          BenchmarkRun (
+            Operation,
+            Destination + mBenchmarkAlignments[AlignmentIndex][0],
+            Source + mBenchmarkAlignments[AlignmentIndex][1],
+            Size
+            );
+        }
+
+        Ticks = MAX (AsmReadTsc () - Start, 1);
+        UT_LOG_INFO (
+          "%-12a  %8ld  %3ld/%-3ld   %8ld\n",
+          mBenchmarkNames[Operation],
+          (UINT64)Size,
+          (UINT64)mBenchmarkAlignments[AlignmentIndex][0],
+          (UINT64)mBenchmarkAlignments[AlignmentIndex][1],
+          DivU64x64Remainder (MultU64x32 ((UINT64)Iterations * Size, 1000), Ticks, NULL)
+          );
+      }
+    }
+  }
+
+  FreePool (Source);
+  FreePool (Destination);
+  return UNIT_TEST_PASSED;
+}
+
+#endif
+
+/**
+  Initialize the unit test framework, suites, and unit tests for the
+  BaseMemoryLib and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      MemoryTests;
+  UNIT_TEST_SUITE_HANDLE      BenchmarkTests;
+  STATIC MEMORY_TEST_CONTEXT  TestContext;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&MemoryTests, Framework, "BaseMemoryLib Tests", "BaseMemoryLib.Memory", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for BaseMemoryLib Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (MemoryTests, "CopyMem copies all sizes and alignments", "CopyMem", CopyMemShouldCopyAllSizesAndAlignments, AllocateTestBuffers, FreeTestBuffers, &TestContext);
+  AddTestCase (MemoryTests, "CopyMem copies overlapping buffers", "CopyMemOverlap", CopyMemShouldCopyOverlappingBuffers, AllocateTestBuffers, FreeTestBuffers, &TestContext);
+  AddTestCase (MemoryTests, "SetMem and ZeroMem fill all sizes and alignments", "SetMem", SetMemShouldFillAllSizesAndAlignments, AllocateTestBuffers, FreeTestBuffers, &TestContext);
+  AddTestCase (MemoryTests, "CompareMem and IsZeroBuffer find the first difference", "CompareMem", CompareMemShouldFindFirstDifference, AllocateTestBuffers, FreeTestBuffers, &TestContext);
+  AddTestCase (MemoryTests, "All operations handle buffers above 4MB", "LargeBuffers", LargeBuffersShouldBeHandled, NULL, NULL, NULL);
+
+  Status = CreateUnitTestSuite (&BenchmarkTests, Framework, "BaseMemoryLib Throughput", "BaseMemoryLib.Throughput", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for BaseMemoryLib Throughput\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+ #if defined (MDE_CPU_IA32) || defined (MDE_CPU_X64)
+  AddTestCase (BenchmarkTests, "Throughput across sizes and alignments", "Throughput", MeasureThroughput, NULL, NULL, NULL);
+ #endif
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard UEFI entry point for target based unit test execution from UEFI Shell.
+**/
+EFI_STATUS
+EFIAPI
+BaseMemoryLibUnitTestAppEntry (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  return UnitTestingEntry ();
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UnitTestingEntry ();
+}
@@ -1234,9 +1234,11 @@ PlatformQemuInitializeRam (
   IN EFI_HOB_PLATFORM_INFO  *PlatformInfoHob
   )
 {
-  UINT64         UpperMemorySize;
-  MTRR_SETTINGS  MtrrSettings;
-  EFI_STATUS     Status;
+  UINT64             UpperMemorySize;
+  MTRR_SETTINGS      MtrrSettings;
+  MTRR_TRANSACTION   Transaction;
+  MTRR_MEMORY_RANGE  TransactionRanges[2];
+  EFI_STATUS         Status;
 
   DEBUG ((DEBUG_INFO, "%a called\n", __func__));
 
@@ -1330,28 +1332,44 @@ PlatformQemuInitializeRam (
     SetMem (&MtrrSettings.Fixed, sizeof MtrrSettings.Fixed, MTRR_CACHE_WRITE_BACK);
     ZeroMem (&MtrrSettings.Variables, sizeof MtrrSettings.Variables);
     MtrrSettings.MtrrDefType |= BIT10;
-    MtrrSetAllMtrrs (&MtrrSettings);
 
     //
-    // Set memory range from 640KB to 1MB to uncacheable
+    // Collect both uncacheable ranges in one transaction, so that the MTRR
+    // layout is calculated once and the MTRRs are programmed once.
     //
-    Status = MtrrSetMemoryAttribute (
-               BASE_512KB + BASE_128KB,
-               BASE_1MB - (BASE_512KB + BASE_128KB),
-               CacheUncacheable
+    Status = MtrrTransactionBegin (
+               &Transaction,
+               &MtrrSettings,
+               TransactionRanges,
+               ARRAY_SIZE (TransactionRanges)
                );
     ASSERT_EFI_ERROR (Status);
 
+    //
+    // Set memory range from 640KB to 1MB to uncacheable
+    //
+    MtrrTransactionAddRange (
+      &Transaction,
+      BASE_512KB + BASE_128KB,
+      BASE_1MB - (BASE_512KB + BASE_128KB),
+      CacheUncacheable
+      );
+
     //
     // Set the memory range from the start of the 32-bit PCI MMIO
     // aperture to 4GB as uncacheable.
     //
-    Status = MtrrSetMemoryAttribute (
-               PlatformInfoHob->Uc32Base,
-               SIZE_4GB - PlatformInfoHob->Uc32Base,
-               CacheUncacheable
-               );
+    MtrrTransactionAddRange (
+      &Transaction,
+      PlatformInfoHob->Uc32Base,
+      SIZE_4GB - PlatformInfoHob->Uc32Base,
+      CacheUncacheable
+      );
+
+    Status = MtrrTransactionCommit (&Transaction, NULL, NULL);
     ASSERT_EFI_ERROR (Status);
+
+    MtrrSetAllMtrrs (&MtrrSettings);
   }
 }
 
@@ -1,25 +1,27 @@
 /** @file
 
-  This driver produces Block I/O Protocol instances for virtio-blk devices.
+  This driver produces Block I/O and Block I/O 2 Protocol instances for
+  virtio-blk devices.
 
   The implementation is basic:
 
   - No attach/detach (ie. removable media).
 
-  - Although the non-blocking interfaces of EFI_BLOCK_IO2_PROTOCOL could be a
-    good match for multiple in-flight virtio-blk requests, we stick to
-    synchronous requests and EFI_BLOCK_IO_PROTOCOL for now.
+  Requests, blocking or not, are split into chunks and kept in flight on up to
+  VBLK_MAX_QUEUES request virtqueues (VIRTIO_BLK_F_MQ), each request in a
+  single ring descriptor when VIRTIO_F_RING_INDIRECT_DESC is available; see
+  VirtioBlkQueue.c.
 
   Copyright (C) 2012, Red Hat, Inc.
   Copyright (c) 2012 - 2018, Intel Corporation. All rights reserved.<BR>
   Copyright (c) 2017, AMD Inc, All rights reserved.<BR>
   Copyright (c) 2024, Arm Limited. All rights reserved.<BR>
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
 
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
 
-#include <IndustryStandard/VirtioBlk.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
@@ -72,6 +74,13 @@
                                                 (Pointer)                  \
                                                 ))
 
+STATIC
+EFI_STATUS
+EFIAPI
+VirtioBlkInit (
+  IN OUT VBLK_DEV  *Dev
+  );
+
 //
 // UEFI Spec 2.3.1 + Errata C, 12.8 EFI Block I/O Protocol
 // Driver Writer's Guide for UEFI 2.3.1 v1.01,
@@ -175,298 +184,6 @@ VerifyReadWriteRequest (
   return EFI_SUCCESS;
 }
 
-/**
-
-  Format a read / write / flush request as three consecutive virtio
-  descriptors, push them to the host, and poll for the response.
-
-  This is the main workhorse function. Two use cases are supported, read/write
-  and flush. The function may only be called after the request parameters have
-  been verified by
-  - specific checks in ReadBlocks() / WriteBlocks() / FlushBlocks(), and
-  - VerifyReadWriteRequest() (for read/write only).
-
-  Parameters handled commonly:
-
-    @param[in] Dev             The virtio-blk device the request is targeted
-                               at.
-
-  Flush request:
-
-    @param[in] Lba             Must be zero.
-
-    @param[in] BufferSize      Must be zero.
-
-    @param[in out] Buffer      Ignored by the function.
-
-    @param[in] RequestIsWrite  Must be TRUE.
-
-  Read/Write request:
-
-    @param[in] Lba             Logical Block Address: number of logical blocks
-                               to skip from the beginning of the device.
-
-    @param[in] BufferSize      Size of buffer to transfer, in bytes. The caller
-                               is responsible to ensure this parameter is
-                               positive.
-
-    @param[in out] Buffer      The guest side area to read data from the device
-                               into, or write data to the device from.
-
-    @param[in] RequestIsWrite  TRUE iff data transfer goes from guest to
-                               device.
-
-  Return values are common to both use cases, and are appropriate to be
-  forwarded by the EFI_BLOCK_IO_PROTOCOL functions (ReadBlocks(),
-  WriteBlocks(), FlushBlocks()).
-
-
-  @retval EFI_SUCCESS          Transfer complete.
-
-  @retval EFI_DEVICE_ERROR     Failed to notify host side via VirtIo write, or
-                               unable to parse host response, or host response
-                               is not VIRTIO_BLK_S_OK or failed to map Buffer
-                               for a bus master operation.
-
-**/
-STATIC
-EFI_STATUS
-EFIAPI
-SynchronousRequest (
-  IN              VBLK_DEV  *Dev,
-  IN              EFI_LBA   Lba,
-  IN              UINTN     BufferSize,
-  IN OUT volatile VOID      *Buffer,
-  IN              BOOLEAN   RequestIsWrite
-  )
-{
-  UINT32                   BlockSize;
-  volatile VIRTIO_BLK_REQ  *Request;
-  volatile UINT8           *HostStatus;
-  VOID                     *HostStatusBuffer;
-  DESC_INDICES             Indices;
-  VOID                     *RequestMapping;
-  VOID                     *StatusMapping;
-  VOID                     *BufferMapping;
-  EFI_PHYSICAL_ADDRESS     BufferDeviceAddress;
-  EFI_PHYSICAL_ADDRESS     HostStatusDeviceAddress;
-  EFI_PHYSICAL_ADDRESS     RequestDeviceAddress;
-  EFI_STATUS               Status;
-  EFI_STATUS               UnmapStatus;
-
-  BlockSize = Dev->BlockIoMedia.BlockSize;
-
-  //
-  // Set BufferMapping and BufferDeviceAddress to suppress incorrect
-  // compiler/analyzer warnings.
-  //
-  BufferMapping       = NULL;
-  BufferDeviceAddress = 0;
-
-  //
-  // ensured by VirtioBlkInit()
-  //
-  ASSERT (BlockSize > 0);
-  ASSERT (BlockSize % 512 == 0);
-
-  //
-  // ensured by contract above, plus VerifyReadWriteRequest()
-  //
-  ASSERT (BufferSize % BlockSize == 0);
-
-  Request = AllocateZeroPool (sizeof (*Request));
-  if (Request == NULL) {
-    return EFI_DEVICE_ERROR;
-  }
-
-  //
-  // Prepare virtio-blk request header, setting zero size for flush.
-  // IO Priority is homogeneously 0.
-  //
-  Request->Type = RequestIsWrite ?
-                  (BufferSize == 0 ? VIRTIO_BLK_T_FLUSH : VIRTIO_BLK_T_OUT) :
-                  VIRTIO_BLK_T_IN;
-  Request->IoPrio = 0;
-  Request->Sector = MultU64x32 (Lba, BlockSize / 512);
-
-  //
-  // Host status is bi-directional (we preset with a value and expect the
-  // device to update it). Allocate a host status buffer which can be mapped
-  // to access equally by both processor and the device.
-  //
-  Status = Dev->VirtIo->AllocateSharedPages (
-                          Dev->VirtIo,
-                          EFI_SIZE_TO_PAGES (sizeof *HostStatus),
-                          &HostStatusBuffer
-                          );
-  if (EFI_ERROR (Status)) {
-    Status = EFI_DEVICE_ERROR;
-    goto FreeBlkRequest;
-  }
-
-  HostStatus = HostStatusBuffer;
-
-  //
-  // Map virtio-blk request header (must be done after request header is
-  // populated)
-  //
-  Status = VirtioMapAllBytesInSharedBuffer (
-             Dev->VirtIo,
-             VirtioOperationBusMasterRead,
-             (VOID *)Request,
-             sizeof (*Request),
-             &RequestDeviceAddress,
-             &RequestMapping
-             );
-  if (EFI_ERROR (Status)) {
-    Status = EFI_DEVICE_ERROR;
-    goto FreeHostStatusBuffer;
-  }
-
-  //
-  // Map data buffer
-  //
-  if (BufferSize > 0) {
-    Status = VirtioMapAllBytesInSharedBuffer (
-               Dev->VirtIo,
-               (RequestIsWrite ?
-                VirtioOperationBusMasterRead :
-                VirtioOperationBusMasterWrite),
-               (VOID *)Buffer,
-               BufferSize,
-               &BufferDeviceAddress,
-               &BufferMapping
-               );
-    if (EFI_ERROR (Status)) {
-      Status = EFI_DEVICE_ERROR;
-      goto UnmapRequestBuffer;
-    }
-  }
-
-  //
-  // preset a host status for ourselves that we do not accept as success
-  //
-  *HostStatus = VIRTIO_BLK_S_IOERR;
-
-  //
-  // Map the Status Buffer with VirtioOperationBusMasterCommonBuffer so that
-  // both processor and device can access it.
-  //
-  Status = VirtioMapAllBytesInSharedBuffer (
-             Dev->VirtIo,
-             VirtioOperationBusMasterCommonBuffer,
-             HostStatusBuffer,
-             sizeof *HostStatus,
-             &HostStatusDeviceAddress,
-             &StatusMapping
-             );
-  if (EFI_ERROR (Status)) {
-    Status = EFI_DEVICE_ERROR;
-    goto UnmapDataBuffer;
-  }
-
-  VirtioPrepare (&Dev->Ring, &Indices);
-
-  //
-  // ensured by VirtioBlkInit() -- this predicate, in combination with the
-  // lock-step progress, ensures we don't have to track free descriptors.
-  //
-  ASSERT (Dev->Ring.QueueSize >= 3);
-
-  //
-  // virtio-blk header in first desc
-  //
-  VirtioAppendDesc (
-    &Dev->Ring,
-    RequestDeviceAddress,
-    sizeof (*Request),
-    VRING_DESC_F_NEXT,
-    &Indices
-    );
-
-  //
-  // data buffer for read/write in second desc
-  //
-  if (BufferSize > 0) {
-    //
-    // From virtio-0.9.5, 2.3.2 Descriptor Table:
-    // "no descriptor chain may be more than 2^32 bytes long in total".
-    //
-    // The predicate is ensured by the call contract above (for flush), or
-    // VerifyReadWriteRequest() (for read/write). It also implies that
-    // converting BufferSize to UINT32 will not truncate it.
-    //
-    ASSERT (BufferSize <= SIZE_1GB);
-
-    //
-    // VRING_DESC_F_WRITE is interpreted from the host's point of view.
-    //
-    VirtioAppendDesc (
-      &Dev->Ring,
-      BufferDeviceAddress,
-      (UINT32)BufferSize,
-      VRING_DESC_F_NEXT | (RequestIsWrite ? 0 : VRING_DESC_F_WRITE),
-      &Indices
-      );
-  }
-
-  //
-  // host status in last (second or third) desc
-  //
-  VirtioAppendDesc (
-    &Dev->Ring,
-    HostStatusDeviceAddress,
-    sizeof *HostStatus,
-    VRING_DESC_F_WRITE,
-    &Indices
-    );
-
-  //
-  // virtio-blk's only virtqueue is #0, called "requestq" (see Appendix D).
-  //
-  if ((VirtioFlush (
-         Dev->VirtIo,
-         0,
-         &Dev->Ring,
-         &Indices,
-         NULL
-         ) == EFI_SUCCESS) &&
-      (*HostStatus == VIRTIO_BLK_S_OK))
-  {
-    Status = EFI_SUCCESS;
-  } else {
-    Status = EFI_DEVICE_ERROR;
-  }
-
-  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, StatusMapping);
-
-UnmapDataBuffer:
-  if (BufferSize > 0) {
-    UnmapStatus = Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, BufferMapping);
-    if (EFI_ERROR (UnmapStatus) && !RequestIsWrite && !EFI_ERROR (Status)) {
-      //
-      // Data from the bus master may not reach the caller; fail the request.
-      //
-      Status = EFI_DEVICE_ERROR;
-    }
-  }
-
-UnmapRequestBuffer:
-  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, RequestMapping);
-
-FreeHostStatusBuffer:
-  Dev->VirtIo->FreeSharedPages (
-                 Dev->VirtIo,
-                 EFI_SIZE_TO_PAGES (sizeof *HostStatus),
-                 HostStatusBuffer
-                 );
-
-FreeBlkRequest:
-  FreePool ((VOID *)Request);
-
-  return Status;
-}
-
 /**
 
   ReadBlocks() operation for virtio-blk.
@@ -478,7 +195,7 @@ FreeBlkRequest:
     ReadBlocksEx() Implementation.
 
   Parameter checks and conformant return values are implemented in
-  VerifyReadWriteRequest() and SynchronousRequest().
+  VerifyReadWriteRequest() and VirtioBlkExecute().
 
   A zero BufferSize doesn't seem to be prohibited, so do nothing in that case,
   successfully.
@@ -512,12 +229,13 @@ VirtioBlkReadBlocks (
     return Status;
   }
 
-  return SynchronousRequest (
+  return VirtioBlkExecute (
            Dev,
+           NULL,       // Token
+           VIRTIO_BLK_T_IN,
            Lba,
            BufferSize,
-           Buffer,
-           FALSE       // RequestIsWrite
+           Buffer
            );
 }
 
@@ -532,7 +250,7 @@ VirtioBlkReadBlocks (
     WriteBlockEx() Implementation.
 
   Parameter checks and conformant return values are implemented in
-  VerifyReadWriteRequest() and SynchronousRequest().
+  VerifyReadWriteRequest() and VirtioBlkExecute().
 
   A zero BufferSize doesn't seem to be prohibited, so do nothing in that case,
   successfully.
@@ -566,12 +284,13 @@ VirtioBlkWriteBlocks (
     return Status;
   }
 
-  return SynchronousRequest (
+  return VirtioBlkExecute (
            Dev,
+           NULL,       // Token
+           VIRTIO_BLK_T_OUT,
            Lba,
            BufferSize,
-           Buffer,
-           TRUE        // RequestIsWrite
+           Buffer
            );
 }
 
@@ -601,16 +320,227 @@ VirtioBlkFlushBlocks (
 
   Dev = VIRTIO_BLK_FROM_BLOCK_IO (This);
   return Dev->BlockIoMedia.WriteCaching ?
-         SynchronousRequest (
+         VirtioBlkExecute (
            Dev,
+           NULL,   // Token
+           VIRTIO_BLK_T_FLUSH,
            0,      // Lba
            0,      // BufferSize
-           NULL,   // Buffer
-           TRUE    // RequestIsWrite
+           NULL    // Buffer
            ) :
          EFI_SUCCESS;
 }
 
+/**
+
+  Complete a non-blocking EFI_BLOCK_IO2_PROTOCOL request that requires no
+  device access.
+
+  @param[in out] Token  The token of the request; may be NULL, or have a NULL
+                        Event, for a blocking request.
+
+**/
+STATIC
+VOID
+CompleteTokenNow (
+  IN OUT EFI_BLOCK_IO2_TOKEN  *Token
+  )
+{
+  if ((Token != NULL) && (Token->Event != NULL)) {
+    Token->TransactionStatus = EFI_SUCCESS;
+    gBS->SignalEvent (Token->Event);
+  }
+}
+
+//
+// UEFI Spec 2.10, 13.10 EFI Block I/O 2 Protocol
+//
+EFI_STATUS
+EFIAPI
+VirtioBlkResetEx (
+  IN EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN BOOLEAN                 ExtendedVerification
+  )
+{
+  VBLK_DEV    *Dev;
+  EFI_TPL     OldTpl;
+  EFI_STATUS  Status;
+  UINT16      Index;
+
+  Dev = VIRTIO_BLK_FROM_BLOCK_IO2 (This);
+
+  //
+  // Abort the queued requests, and let the device finish the submitted ones.
+  //
+  VirtioBlkDrain (Dev);
+  if (!ExtendedVerification) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // Reset the device, release the virtqueues it knew about, and run the whole
+  // initialization sequence again. This also picks up a changed capacity.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
+  Dev->VirtIo->SetDeviceStatus (Dev->VirtIo, 0);
+  for (Index = 0; Index < Dev->NumQueues; ++Index) {
+    VirtioBlkQueueUninit (Dev, Index);
+  }
+
+  Dev->NumQueues = 0;
+  Status         = VirtioBlkInit (Dev);
+
+  gBS->RestoreTPL (OldTpl);
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: reinitialization failed: %r\n", __func__, Status));
+    return EFI_DEVICE_ERROR;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+
+  ReadBlocksEx() operation for virtio-blk.
+
+  See UEFI Spec 2.10, 13.10 EFI Block I/O 2 Protocol,
+  EFI_BLOCK_IO2_PROTOCOL.ReadBlocksEx().
+
+  If Token is NULL, or Token->Event is NULL, the request is blocking, like
+  ReadBlocks(). Otherwise the request is queued, and Token->Event is signaled
+  when it completes.
+
+**/
+EFI_STATUS
+EFIAPI
+VirtioBlkReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN     UINT32                  MediaId,
+  IN     EFI_LBA                 Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN     *Token,
+  IN     UINTN                   BufferSize,
+  OUT    VOID                    *Buffer
+  )
+{
+  VBLK_DEV    *Dev;
+  EFI_STATUS  Status;
+
+  if (BufferSize == 0) {
+    CompleteTokenNow (Token);
+    return EFI_SUCCESS;
+  }
+
+  Dev    = VIRTIO_BLK_FROM_BLOCK_IO2 (This);
+  Status = VerifyReadWriteRequest (
+             &Dev->BlockIoMedia,
+             Lba,
+             BufferSize,
+             FALSE               // RequestIsWrite
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return VirtioBlkExecute (
+           Dev,
+           (Token != NULL && Token->Event != NULL) ? Token : NULL,
+           VIRTIO_BLK_T_IN,
+           Lba,
+           BufferSize,
+           Buffer
+           );
+}
+
+/**
+
+  WriteBlocksEx() operation for virtio-blk.
+
+  See UEFI Spec 2.10, 13.10 EFI Block I/O 2 Protocol,
+  EFI_BLOCK_IO2_PROTOCOL.WriteBlocksEx().
+
+  If Token is NULL, or Token->Event is NULL, the request is blocking, like
+  WriteBlocks(). Otherwise the request is queued, and Token->Event is signaled
+  when it completes.
+
+**/
+EFI_STATUS
+EFIAPI
+VirtioBlkWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN     UINT32                  MediaId,
+  IN     EFI_LBA                 Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN     *Token,
+  IN     UINTN                   BufferSize,
+  IN     VOID                    *Buffer
+  )
+{
+  VBLK_DEV    *Dev;
+  EFI_STATUS  Status;
+
+  if (BufferSize == 0) {
+    CompleteTokenNow (Token);
+    return EFI_SUCCESS;
+  }
+
+  Dev    = VIRTIO_BLK_FROM_BLOCK_IO2 (This);
+  Status = VerifyReadWriteRequest (
+             &Dev->BlockIoMedia,
+             Lba,
+             BufferSize,
+             TRUE                // RequestIsWrite
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return VirtioBlkExecute (
+           Dev,
+           (Token != NULL && Token->Event != NULL) ? Token : NULL,
+           VIRTIO_BLK_T_OUT,
+           Lba,
+           BufferSize,
+           Buffer
+           );
+}
+
+/**
+
+  FlushBlocksEx() operation for virtio-blk.
+
+  See UEFI Spec 2.10, 13.10 EFI Block I/O 2 Protocol,
+  EFI_BLOCK_IO2_PROTOCOL.FlushBlocksEx().
+
+  The flush is submitted to the device only after all the requests queued
+  before it have completed.
+
+**/
+EFI_STATUS
+EFIAPI
+VirtioBlkFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN     *Token
+  )
+{
+  VBLK_DEV  *Dev;
+
+  Dev = VIRTIO_BLK_FROM_BLOCK_IO2 (This);
+  if (!Dev->BlockIoMedia.WriteCaching) {
+    CompleteTokenNow (Token);
+    return EFI_SUCCESS;
+  }
+
+  return VirtioBlkExecute (
+           Dev,
+           (Token != NULL && Token->Event != NULL) ? Token : NULL,
+           VIRTIO_BLK_T_FLUSH,
+           0,      // Lba
+           0,      // BufferSize
+           NULL    // Buffer
+           );
+}
+
 /**
 
   Device probe function for this driver.
@@ -708,9 +638,8 @@ VirtioBlkDriverBindingSupported (
   @retval EFI_UNSUPPORTED  The driver is unable to work with the virtio ring or
                            virtio-blk attributes the host provides.
 
-  @return                  Error codes from VirtioRingInit() or
-                           VIRTIO_CFG_READ() / VIRTIO_CFG_WRITE or
-                           VirtioRingMap().
+  @return                  Error codes from VirtioBlkQueueInit() or
+                           VIRTIO_CFG_READ() / VIRTIO_CFG_WRITE.
 
 **/
 STATIC
@@ -729,12 +658,13 @@ VirtioBlkInit (
   UINT8   PhysicalBlockExp;
   UINT8   AlignmentOffset;
   UINT32  OptIoSize;
-  UINT16  QueueSize;
-  UINT64  RingBaseShift;
+  UINT16  NumQueues;
+  UINT16  Index;
 
   PhysicalBlockExp = 0;
   AlignmentOffset  = 0;
   OptIoSize        = 0;
+  NumQueues        = 1;
 
   //
   // Execute virtio-0.9.5, 2.2.1 Device Initialization Sequence.
@@ -829,10 +759,22 @@ VirtioBlkInit (
     }
   }
 
+  if (Features & VIRTIO_BLK_F_MQ) {
+    Status = VIRTIO_CFG_READ (Dev, NumQueues, &NumQueues);
+    if (EFI_ERROR (Status)) {
+      goto Failed;
+    }
+
+    NumQueues = (UINT16)MIN (MAX (NumQueues, 1), VBLK_MAX_QUEUES);
+  }
+
   Features &= VIRTIO_BLK_F_BLK_SIZE | VIRTIO_BLK_F_TOPOLOGY | VIRTIO_BLK_F_RO |
-              VIRTIO_BLK_F_FLUSH | VIRTIO_F_VERSION_1 |
+              VIRTIO_BLK_F_FLUSH | VIRTIO_BLK_F_MQ |
+              VIRTIO_F_RING_INDIRECT_DESC | VIRTIO_F_VERSION_1 |
               VIRTIO_F_IOMMU_PLATFORM;
 
+  Dev->IndirectDesc = (BOOLEAN)((Features & VIRTIO_F_RING_INDIRECT_DESC) != 0);
+
   //
   // In virtio-1.0, feature negotiation is expected to complete before queue
   // discovery, and the device can also reject the selected set of features.
@@ -845,66 +787,14 @@ VirtioBlkInit (
   }
 
   //
-  // step 4b -- allocate virtqueue
-  //
-  Status = Dev->VirtIo->SetQueueSel (Dev->VirtIo, 0);
-  if (EFI_ERROR (Status)) {
-    goto Failed;
-  }
-
-  Status = Dev->VirtIo->GetQueueNumMax (Dev->VirtIo, &QueueSize);
-  if (EFI_ERROR (Status)) {
-    goto Failed;
-  }
-
-  if (QueueSize < 3) {
-    // SynchronousRequest() uses at most three descriptors
-    Status = EFI_UNSUPPORTED;
-    goto Failed;
-  }
-
-  Status = VirtioRingInit (Dev->VirtIo, QueueSize, &Dev->Ring);
-  if (EFI_ERROR (Status)) {
-    goto Failed;
-  }
-
-  //
-  // If anything fails from here on, we must release the ring resources
-  //
-  Status = VirtioRingMap (
-             Dev->VirtIo,
-             &Dev->Ring,
-             &RingBaseShift,
-             &Dev->RingMap
-             );
-  if (EFI_ERROR (Status)) {
-    goto ReleaseQueue;
-  }
-
-  //
-  // Additional steps for MMIO: align the queue appropriately, and set the
-  // size. If anything fails from here on, we must unmap the ring resources.
-  //
-  Status = Dev->VirtIo->SetQueueNum (Dev->VirtIo, QueueSize);
-  if (EFI_ERROR (Status)) {
-    goto UnmapQueue;
-  }
-
-  Status = Dev->VirtIo->SetQueueAlign (Dev->VirtIo, EFI_PAGE_SIZE);
-  if (EFI_ERROR (Status)) {
-    goto UnmapQueue;
-  }
-
-  //
-  // step 4c -- Report GPFN (guest-physical frame number) of queue.
+  // steps 4b and 4c -- allocate and report the request virtqueues. The device
+  // keeps the virtqueues beyond NumQueues disabled.
   //
-  Status = Dev->VirtIo->SetQueueAddress (
-                          Dev->VirtIo,
-                          &Dev->Ring,
-                          RingBaseShift
-                          );
-  if (EFI_ERROR (Status)) {
-    goto UnmapQueue;
+  for (Index = 0; Index < NumQueues; ++Index) {
+    Status = VirtioBlkQueueInit (Dev, Index);
+    if (EFI_ERROR (Status)) {
+      goto ReleaseQueues;
+    }
   }
 
   //
@@ -914,7 +804,7 @@ VirtioBlkInit (
     Features &= ~(UINT64)(VIRTIO_F_VERSION_1 | VIRTIO_F_IOMMU_PLATFORM);
     Status    = Dev->VirtIo->SetGuestFeatures (Dev->VirtIo, Features);
     if (EFI_ERROR (Status)) {
-      goto UnmapQueue;
+      goto ReleaseQueues;
     }
   }
 
@@ -924,9 +814,14 @@ VirtioBlkInit (
   NextDevStat |= VSTAT_DRIVER_OK;
   Status       = Dev->VirtIo->SetDeviceStatus (Dev->VirtIo, NextDevStat);
   if (EFI_ERROR (Status)) {
-    goto UnmapQueue;
+    goto ReleaseQueues;
   }
 
+  Dev->NumQueues = NumQueues;
+  Dev->NextQueue = 0;
+  Dev->InFlight  = 0;
+  InitializeListHead (&Dev->PendingRequests);
+
   //
   // Populate the exported interface's attributes; see UEFI spec v2.4, 12.9 EFI
   // Block I/O Protocol.
@@ -937,6 +832,11 @@ VirtioBlkInit (
   Dev->BlockIo.ReadBlocks            = &VirtioBlkReadBlocks;
   Dev->BlockIo.WriteBlocks           = &VirtioBlkWriteBlocks;
   Dev->BlockIo.FlushBlocks           = &VirtioBlkFlushBlocks;
+  Dev->BlockIo2.Media                = &Dev->BlockIoMedia;
+  Dev->BlockIo2.Reset                = &VirtioBlkResetEx;
+  Dev->BlockIo2.ReadBlocksEx         = &VirtioBlkReadBlocksEx;
+  Dev->BlockIo2.WriteBlocksEx        = &VirtioBlkWriteBlocksEx;
+  Dev->BlockIo2.FlushBlocksEx        = &VirtioBlkFlushBlocksEx;
   Dev->BlockIoMedia.MediaId          = 0;
   Dev->BlockIoMedia.RemovableMedia   = FALSE;
   Dev->BlockIoMedia.MediaPresent     = TRUE;
@@ -957,6 +857,13 @@ VirtioBlkInit (
     Dev->BlockIoMedia.BlockSize,
     Dev->BlockIoMedia.LastBlock + 1
     ));
+  DEBUG ((
+    DEBUG_INFO,
+    "%a: NumQueues=%u IndirectDesc=%d\n",
+    __func__,
+    Dev->NumQueues,
+    Dev->IndirectDesc
+    ));
 
   if (Features & VIRTIO_BLK_F_TOPOLOGY) {
     Dev->BlockIo.Revision = EFI_BLOCK_IO_PROTOCOL_REVISION3;
@@ -982,11 +889,14 @@ VirtioBlkInit (
 
   return EFI_SUCCESS;
 
-UnmapQueue:
-  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Dev->RingMap);
-
-ReleaseQueue:
-  VirtioRingUninit (Dev->VirtIo, &Dev->Ring);
+ReleaseQueues:
+  //
+  // Reset the device before releasing the virtqueues it knows about.
+  //
+  Dev->VirtIo->SetDeviceStatus (Dev->VirtIo, 0);
+  while (Index > 0) {
+    VirtioBlkQueueUninit (Dev, --Index);
+  }
 
 Failed:
   //
@@ -1014,6 +924,8 @@ VirtioBlkUninit (
   IN OUT VBLK_DEV  *Dev
   )
 {
+  UINT16  Index;
+
   //
   // Reset the virtual device -- see virtio-0.9.5, 2.2.2.1 Device Status. When
   // VIRTIO_CFG_WRITE() returns, the host will have learned to stay away from
@@ -1021,10 +933,14 @@ VirtioBlkUninit (
   //
   Dev->VirtIo->SetDeviceStatus (Dev->VirtIo, 0);
 
-  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Dev->RingMap);
-  VirtioRingUninit (Dev->VirtIo, &Dev->Ring);
+  for (Index = 0; Index < Dev->NumQueues; ++Index) {
+    VirtioBlkQueueUninit (Dev, Index);
+  }
+
+  Dev->NumQueues = 0;
 
   SetMem (&Dev->BlockIo, sizeof Dev->BlockIo, 0x00);
+  SetMem (&Dev->BlockIo2, sizeof Dev->BlockIo2, 0x00);
   SetMem (&Dev->BlockIoMedia, sizeof Dev->BlockIoMedia, 0x00);
 }
 
@@ -1078,13 +994,16 @@ VirtioBlkExitBoot (
 
   @retval EFI_SUCCESS           Driver instance has been created and
                                 initialized  for the virtio-blk device, it
-                                is now accessible via EFI_BLOCK_IO_PROTOCOL.
+                                is now accessible via EFI_BLOCK_IO_PROTOCOL
+                                and EFI_BLOCK_IO2_PROTOCOL.
 
   @retval EFI_OUT_OF_RESOURCES  Memory allocation failed.
 
   @return                       Error codes from the OpenProtocol() boot
                                 service, the VirtIo protocol, VirtioBlkInit(),
-                                or the InstallProtocolInterface() boot service.
+                                the CreateEvent() boot service, or the
+                                InstallMultipleProtocolInterfaces() boot
+                                service.
 
 **/
 EFI_STATUS
@@ -1135,21 +1054,42 @@ VirtioBlkDriverBindingStart (
   }
 
   //
-  // Setup complete, attempt to export the driver instance's BlockIo interface.
+  // The timer is armed only while EFI_BLOCK_IO2_PROTOCOL requests are
+  // outstanding.
+  //
+  Status = gBS->CreateEvent (
+                  EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                  TPL_NOTIFY,
+                  &VirtioBlkPollTimer,
+                  Dev,
+                  &Dev->PollTimer
+                  );
+  if (EFI_ERROR (Status)) {
+    goto CloseExitBoot;
+  }
+
+  //
+  // Setup complete, attempt to export the driver instance's BlockIo and
+  // BlockIo2 interfaces.
   //
   Dev->Signature = VBLK_SIG;
-  Status         = gBS->InstallProtocolInterface (
+  Status         = gBS->InstallMultipleProtocolInterfaces (
                           &DeviceHandle,
                           &gEfiBlockIoProtocolGuid,
-                          EFI_NATIVE_INTERFACE,
-                          &Dev->BlockIo
+                          &Dev->BlockIo,
+                          &gEfiBlockIo2ProtocolGuid,
+                          &Dev->BlockIo2,
+                          NULL
                           );
   if (EFI_ERROR (Status)) {
-    goto CloseExitBoot;
+    goto ClosePollTimer;
   }
 
   return EFI_SUCCESS;
 
+ClosePollTimer:
+  gBS->CloseEvent (Dev->PollTimer);
+
 CloseExitBoot:
   gBS->CloseEvent (Dev->ExitBoot);
 
@@ -1172,11 +1112,13 @@ FreeVirtioBlk:
 
 /**
 
-  Stop driving a virtio-blk device and remove its BlockIo interface.
+  Stop driving a virtio-blk device and remove its BlockIo and BlockIo2
+  interfaces.
 
   This function replays the success path of DriverBindingStart() in reverse.
-  The host side virtio-blk device is reset, so that the OS boot loader or the
-  OS may reinitialize it.
+  Queued requests that have not reached the device yet are aborted, and the
+  others are waited for. The host side virtio-blk device is reset, so that the
+  OS boot loader or the OS may reinitialize it.
 
   @param[in] This               The EFI_DRIVER_BINDING_PROTOCOL object
                                 incorporating this driver (independently of any
@@ -1222,15 +1164,21 @@ VirtioBlkDriverBindingStop (
   //
   // Handle Stop() requests for in-use driver instances gracefully.
   //
-  Status = gBS->UninstallProtocolInterface (
+  Status = gBS->UninstallMultipleProtocolInterfaces (
                   DeviceHandle,
                   &gEfiBlockIoProtocolGuid,
-                  &Dev->BlockIo
+                  &Dev->BlockIo,
+                  &gEfiBlockIo2ProtocolGuid,
+                  &Dev->BlockIo2,
+                  NULL
                   );
   if (EFI_ERROR (Status)) {
     return Status;
   }
 
+  VirtioBlkDrain (Dev);
+
+  gBS->CloseEvent (Dev->PollTimer);
   gBS->CloseEvent (Dev->ExitBoot);
 
   VirtioBlkUninit (Dev);
@@ -1,7 +1,7 @@
 /** @file
 
   Internal definitions for the virtio-blk driver, which produces Block I/O
-  Protocol instances for virtio-blk devices.
+  and Block I/O 2 Protocol instances for virtio-blk devices.
 
   Copyright (C) 2012, Red Hat, Inc.
 
@@ -13,13 +13,99 @@
 #define _VIRTIO_BLK_DXE_H_
 
 #include <Protocol/BlockIo.h>
+#include <Protocol/BlockIo2.h>
 #include <Protocol/ComponentName.h>
 #include <Protocol/DriverBinding.h>
 
 #include <IndustryStandard/Virtio.h>
+#include <IndustryStandard/VirtioBlk.h>
 
 #define VBLK_SIG  SIGNATURE_32 ('V', 'B', 'L', 'K')
 
+//
+// The number of request virtqueues we drive at most, if the device offers
+// VIRTIO_BLK_F_MQ.
+//
+#define VBLK_MAX_QUEUES  4
+
+//
+// Read and write requests are split into chunks of at most this size, so that
+// a large request keeps all the virtqueues busy, and the device can work on
+// its chunks in parallel.
+//
+#define VBLK_MAX_CHUNK_SIZE  SIZE_256KB
+
+//
+// The period of the timer that reaps the completed requests, and submits the
+// pending ones, while EFI_BLOCK_IO2_PROTOCOL requests are outstanding.
+//
+#define VBLK_POLL_PERIOD  EFI_TIMER_PERIOD_MILLISECONDS (1)
+
+//
+// The part of a request slot that the device accesses: the request header, the
+// host status byte, and, when VIRTIO_F_RING_INDIRECT_DESC has been negotiated,
+// the indirect descriptor table of the request. The structure is padded to 16
+// bytes, so that the descriptor tables in an array of slots stay aligned.
+//
+#pragma pack(1)
+typedef struct {
+  VRING_DESC        Indirect[3];
+  VIRTIO_BLK_REQ    Header;
+  UINT8             HostStatus;
+  UINT8             Reserved[15];
+} VBLK_SHARED_SLOT;
+#pragma pack()
+
+#define VBLK_REQ_SIG  SIGNATURE_32 ('V', 'B', 'R', 'Q')
+
+//
+// A read, write or flush request. Read and write requests are submitted to the
+// virtqueues in chunks of at most VBLK_MAX_CHUNK_SIZE bytes; the request stays
+// on VBLK_DEV.PendingRequests until all its chunks have been submitted, and is
+// completed when the last of them has been reaped.
+//
+typedef struct {
+  UINT32                 Signature;
+  LIST_ENTRY             Link;
+  EFI_BLOCK_IO2_TOKEN    *Token;         // NULL for a blocking request
+  UINT32                 Type;           // VIRTIO_BLK_T_IN, _OUT or _FLUSH
+  EFI_LBA                Lba;            // of the next chunk to submit
+  UINT8                  *Buffer;        // of the next chunk to submit
+  UINTN                  RemainingSize;  // not submitted yet
+  UINTN                  InFlight;       // chunks submitted, not reaped yet
+  EFI_STATUS             Status;
+  volatile BOOLEAN       Done;
+} VBLK_REQUEST;
+
+#define VBLK_REQUEST_FROM_LINK(LinkPointer) \
+        CR (LinkPointer, VBLK_REQUEST, Link, VBLK_REQ_SIG)
+
+//
+// The driver's side of a request slot.
+//
+typedef struct {
+  VBLK_REQUEST    *Request;
+  VOID            *BufferMapping;  // NULL for a flush
+} VBLK_SLOT;
+
+//
+// A request virtqueue. Each slot can hold one chunk in flight. With indirect
+// descriptors, slot N uses descriptor N of the ring; otherwise it uses the
+// descriptors 3*N to 3*N+2.
+//
+typedef struct {
+  VRING                   Ring;
+  VOID                    *RingMap;
+  UINT16                  LastUsed;
+  UINT16                  NumSlots;
+  UINT16                  NumFree;
+  UINT16                  *FreeStack;
+  VBLK_SLOT               *Slots;
+  VBLK_SHARED_SLOT        *Shared;
+  VOID                    *SharedMap;
+  EFI_PHYSICAL_ADDRESS    SharedDeviceAddress;
+} VBLK_QUEUE;
+
 typedef struct {
   //
   // Parts of this structure are initialized / torn down in various functions
@@ -31,15 +117,26 @@ typedef struct {
   UINT32                    Signature;         // DriverBindingStart  0
   VIRTIO_DEVICE_PROTOCOL    *VirtIo;           // DriverBindingStart  0
   EFI_EVENT                 ExitBoot;          // DriverBindingStart  0
-  VRING                     Ring;              // VirtioRingInit      2
+  EFI_EVENT                 PollTimer;         // DriverBindingStart  0
   EFI_BLOCK_IO_PROTOCOL     BlockIo;           // VirtioBlkInit       1
+  EFI_BLOCK_IO2_PROTOCOL    BlockIo2;          // VirtioBlkInit       1
   EFI_BLOCK_IO_MEDIA        BlockIoMedia;      // VirtioBlkInit       1
-  VOID                      *RingMap;          // VirtioRingMap       2
+  BOOLEAN                   IndirectDesc;      // VirtioBlkInit       1
+  UINT16                    NumQueues;         // VirtioBlkInit       1
+  VBLK_QUEUE                Queues[VBLK_MAX_QUEUES];
+                                               // VirtioBlkQueueInit  2
+  UINT16                    NextQueue;         // VirtioBlkInit       1
+  LIST_ENTRY                PendingRequests;   // VirtioBlkInit       1
+  UINTN                     InFlight;          // VirtioBlkInit       1
+  UINTN                     AsyncRequests;     // VirtioBlkInit       1
 } VBLK_DEV;
 
 #define VIRTIO_BLK_FROM_BLOCK_IO(BlockIoPointer) \
         CR (BlockIoPointer, VBLK_DEV, BlockIo, VBLK_SIG)
 
+#define VIRTIO_BLK_FROM_BLOCK_IO2(BlockIo2Pointer) \
+        CR (BlockIo2Pointer, VBLK_DEV, BlockIo2, VBLK_SIG)
+
 /**
 
   Device probe function for this driver.
@@ -244,6 +341,200 @@ VirtioBlkFlushBlocks (
   IN EFI_BLOCK_IO_PROTOCOL  *This
   );
 
+//
+// UEFI Spec 2.10, 13.10 EFI Block I/O 2 Protocol
+//
+EFI_STATUS
+EFIAPI
+VirtioBlkResetEx (
+  IN EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN BOOLEAN                 ExtendedVerification
+  );
+
+/**
+
+  ReadBlocksEx() operation for virtio-blk.
+
+  See UEFI Spec 2.10, 13.10 EFI Block I/O 2 Protocol,
+  EFI_BLOCK_IO2_PROTOCOL.ReadBlocksEx().
+
+  If Token is NULL, or Token->Event is NULL, the request is blocking, like
+  ReadBlocks(). Otherwise the request is queued, and Token->Event is signaled
+  when it completes.
+
+**/
+EFI_STATUS
+EFIAPI
+VirtioBlkReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN     UINT32                  MediaId,
+  IN     EFI_LBA                 Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN     *Token,
+  IN     UINTN                   BufferSize,
+  OUT    VOID                    *Buffer
+  );
+
+/**
+
+  WriteBlocksEx() operation for virtio-blk.
+
+  See UEFI Spec 2.10, 13.10 EFI Block I/O 2 Protocol,
+  EFI_BLOCK_IO2_PROTOCOL.WriteBlocksEx().
+
+  If Token is NULL, or Token->Event is NULL, the request is blocking, like
+  WriteBlocks(). Otherwise the request is queued, and Token->Event is signaled
+  when it completes.
+
+**/
+EFI_STATUS
+EFIAPI
+VirtioBlkWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN     UINT32                  MediaId,
+  IN     EFI_LBA                 Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN     *Token,
+  IN     UINTN                   BufferSize,
+  IN     VOID                    *Buffer
+  );
+
+/**
+
+  FlushBlocksEx() operation for virtio-blk.
+
+  See UEFI Spec 2.10, 13.10 EFI Block I/O 2 Protocol,
+  EFI_BLOCK_IO2_PROTOCOL.FlushBlocksEx().
+
+  The flush is submitted to the device only after all the requests queued
+  before it have completed.
+
+**/
+EFI_STATUS
+EFIAPI
+VirtioBlkFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN     *Token
+  );
+
+//
+// Request virtqueue management, in VirtioBlkQueue.c.
+//
+
+/**
+
+  Allocate and report a request virtqueue (virtio-0.9.5, 2.2.1 Device
+  Initialization Sequence, steps 4b and 4c), then allocate and map its slots,
+  and lay out the descriptors that do not change from request to request.
+
+  @param[in out] Dev  The virtio-blk device. Dev->IndirectDesc must be valid,
+                      and the features must have been negotiated already for
+                      virtio-1.0 devices.
+
+  @param[in] Index    The index of the virtqueue, and of Dev->Queues[].
+
+  @retval EFI_SUCCESS           The virtqueue is ready.
+
+  @retval EFI_UNSUPPORTED       The virtqueue is too small.
+
+  @retval EFI_OUT_OF_RESOURCES  Memory allocation failed.
+
+  @return                       Error codes from the VirtIo protocol,
+                                VirtioRingInit(), VirtioRingMap() or
+                                VirtioMapAllBytesInSharedBuffer().
+
+**/
+EFI_STATUS
+VirtioBlkQueueInit (
+  IN OUT VBLK_DEV  *Dev,
+  IN     UINT16    Index
+  );
+
+/**
+
+  Release a request virtqueue set up with VirtioBlkQueueInit(). The device must
+  have been reset.
+
+  @param[in out] Dev  The virtio-blk device.
+
+  @param[in] Index    The index of the virtqueue, and of Dev->Queues[].
+
+**/
+VOID
+VirtioBlkQueueUninit (
+  IN OUT VBLK_DEV  *Dev,
+  IN     UINT16    Index
+  );
+
+/**
+
+  Queue a request, and, if it is blocking, wait for its completion.
+
+  The request parameters must have been verified by the caller.
+
+  @param[in] Dev         The virtio-blk device.
+
+  @param[in] Token       The EFI_BLOCK_IO2_PROTOCOL token of the request, or
+                         NULL for a blocking request. Token->Event must not be
+                         NULL.
+
+  @param[in] Type        VIRTIO_BLK_T_IN, VIRTIO_BLK_T_OUT or
+                         VIRTIO_BLK_T_FLUSH.
+
+  @param[in] Lba         The first block to transfer; zero for a flush.
+
+  @param[in] BufferSize  The size of Buffer in bytes, a multiple of the block
+                         size; zero for a flush.
+
+  @param[in] Buffer      The buffer to read the data into, or write the data
+                         from; NULL for a flush.
+
+  @retval EFI_SUCCESS           The blocking request completed, or the
+                                non-blocking request was queued.
+
+  @retval EFI_OUT_OF_RESOURCES  The non-blocking request could not be queued.
+
+  @retval EFI_DEVICE_ERROR      The blocking request failed.
+
+**/
+EFI_STATUS
+VirtioBlkExecute (
+  IN VBLK_DEV             *Dev,
+  IN EFI_BLOCK_IO2_TOKEN  *Token,
+  IN UINT32               Type,
+  IN EFI_LBA              Lba,
+  IN UINTN                BufferSize,
+  IN VOID                 *Buffer
+  );
+
+/**
+
+  Abort the requests that have not been submitted to the device yet, and wait
+  for the device to complete the others.
+
+  @param[in] Dev  The virtio-blk device.
+
+**/
+VOID
+VirtioBlkDrain (
+  IN VBLK_DEV  *Dev
+  );
+
+/**
+
+  Timer notification function that reaps the completed requests, and submits
+  the pending ones.
+
+  @param[in] Event    The Dev->PollTimer event.
+
+  @param[in] Context  Pointer to the VBLK_DEV structure.
+
+**/
+VOID
+EFIAPI
+VirtioBlkPollTimer (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  );
+
 //
 // The purpose of the following scaffolding (EFI_COMPONENT_NAME_PROTOCOL and
 // EFI_COMPONENT_NAME2_PROTOCOL implementation) is to format the driver's name
@@ -0,0 +1,804 @@
+/** @file
+
+  Request virtqueue management for the virtio-blk driver.
+
+  Requests are queued on VBLK_DEV.PendingRequests, and submitted in chunks to
+  the request virtqueues as long as the virtqueues have free slots. Completed
+  chunks are reaped by polling the used rings: in a loop for blocking
+  requests, and from a periodic timer while EFI_BLOCK_IO2_PROTOCOL requests
+  are outstanding. The device never interrupts us.
+
+  Every function that accesses the virtqueues or the request lists runs at
+  TPL_NOTIFY, the TPL of the timer.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+#include <Library/VirtioLib.h>
+
+#include "VirtioBlk.h"
+
+/**
+
+  Allocate and report a request virtqueue (virtio-0.9.5, 2.2.1 Device
+  Initialization Sequence, steps 4b and 4c), then allocate and map its slots,
+  and lay out the descriptors that do not change from request to request.
+
+  @param[in out] Dev  The virtio-blk device. Dev->IndirectDesc must be valid,
+                      and the features must have been negotiated already for
+                      virtio-1.0 devices.
+
+  @param[in] Index    The index of the virtqueue, and of Dev->Queues[].
+
+  @retval EFI_SUCCESS           The virtqueue is ready.
+
+  @retval EFI_UNSUPPORTED       The virtqueue is too small.
+
+  @retval EFI_OUT_OF_RESOURCES  Memory allocation failed.
+
+  @return                       Error codes from the VirtIo protocol,
+                                VirtioRingInit(), VirtioRingMap() or
+                                VirtioMapAllBytesInSharedBuffer().
+
+**/
+EFI_STATUS
+VirtioBlkQueueInit (
+  IN OUT VBLK_DEV  *Dev,
+  IN     UINT16    Index
+  )
+{
+  VBLK_QUEUE            *Queue;
+  EFI_STATUS            Status;
+  UINT16                QueueSize;
+  UINT64                RingBaseShift;
+  UINTN                 SharedSize;
+  VOID                  *SharedBuffer;
+  UINT16                Slot;
+  UINT16                Base;
+  EFI_PHYSICAL_ADDRESS  SlotDeviceAddress;
+  volatile VRING_DESC   *Desc;
+
+  ASSERT (Index < VBLK_MAX_QUEUES);
+  Queue = &Dev->Queues[Index];
+
+  Status = Dev->VirtIo->SetQueueSel (Dev->VirtIo, Index);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = Dev->VirtIo->GetQueueNumMax (Dev->VirtIo, &QueueSize);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (QueueSize < 3) {
+    //
+    // A request takes at most three descriptors.
+    //
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = VirtioRingInit (Dev->VirtIo, QueueSize, &Queue->Ring);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // If anything fails from here on, we must release the ring resources
+  //
+  Status = VirtioRingMap (
+             Dev->VirtIo,
+             &Queue->Ring,
+             &RingBaseShift,
+             &Queue->RingMap
+             );
+  if (EFI_ERROR (Status)) {
+    goto ReleaseQueue;
+  }
+
+  //
+  // Additional steps for MMIO: align the queue appropriately, and set the
+  // size. If anything fails from here on, we must unmap the ring resources.
+  //
+  Status = Dev->VirtIo->SetQueueNum (Dev->VirtIo, QueueSize);
+  if (EFI_ERROR (Status)) {
+    goto UnmapQueue;
+  }
+
+  Status = Dev->VirtIo->SetQueueAlign (Dev->VirtIo, EFI_PAGE_SIZE);
+  if (EFI_ERROR (Status)) {
+    goto UnmapQueue;
+  }
+
+  //
+  // step 4c -- Report GPFN (guest-physical frame number) of queue.
+  //
+  Status = Dev->VirtIo->SetQueueAddress (
+                          Dev->VirtIo,
+                          &Queue->Ring,
+                          RingBaseShift
+                          );
+  if (EFI_ERROR (Status)) {
+    goto UnmapQueue;
+  }
+
+  //
+  // With indirect descriptors, every request takes a single descriptor of the
+  // ring; otherwise it takes three.
+  //
+  Queue->NumSlots  = Dev->IndirectDesc ? QueueSize : QueueSize / 3;
+  Queue->FreeStack = AllocatePool (Queue->NumSlots * sizeof *Queue->FreeStack);
+  Queue->Slots     = AllocateZeroPool (Queue->NumSlots * sizeof *Queue->Slots);
+  if ((Queue->FreeStack == NULL) || (Queue->Slots == NULL)) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto FreeSlots;
+  }
+
+  //
+  // The request headers, the host status bytes and the indirect descriptor
+  // tables are accessed by both the processor and the device.
+  //
+  SharedSize = Queue->NumSlots * sizeof *Queue->Shared;
+  Status     = Dev->VirtIo->AllocateSharedPages (
+                              Dev->VirtIo,
+                              EFI_SIZE_TO_PAGES (SharedSize),
+                              &SharedBuffer
+                              );
+  if (EFI_ERROR (Status)) {
+    goto FreeSlots;
+  }
+
+  ZeroMem (SharedBuffer, SharedSize);
+
+  Status = VirtioMapAllBytesInSharedBuffer (
+             Dev->VirtIo,
+             VirtioOperationBusMasterCommonBuffer,
+             SharedBuffer,
+             SharedSize,
+             &Queue->SharedDeviceAddress,
+             &Queue->SharedMap
+             );
+  if (EFI_ERROR (Status)) {
+    goto FreeSharedBuffer;
+  }
+
+  Queue->Shared = SharedBuffer;
+
+  for (Slot = 0; Slot < Queue->NumSlots; ++Slot) {
+    Queue->FreeStack[Slot] = Slot;
+    SlotDeviceAddress      = Queue->SharedDeviceAddress +
+                             Slot * sizeof *Queue->Shared;
+
+    if (Dev->IndirectDesc) {
+      //
+      // The descriptor of the ring points to the table of the slot, in which
+      // the "Next" fields index the table itself.
+      //
+      Queue->Ring.Desc[Slot].Addr  = SlotDeviceAddress +
+                                     OFFSET_OF (VBLK_SHARED_SLOT, Indirect);
+      Queue->Ring.Desc[Slot].Len   = sizeof Queue->Shared->Indirect;
+      Queue->Ring.Desc[Slot].Flags = VRING_DESC_F_INDIRECT;
+      Queue->Ring.Desc[Slot].Next  = 0;
+
+      Base = 0;
+      Desc = Queue->Shared[Slot].Indirect;
+    } else {
+      Base = (UINT16)(3 * Slot);
+      Desc = &Queue->Ring.Desc[Base];
+    }
+
+    //
+    // The first descriptor always holds the virtio-blk header, and the last
+    // one the host status. The data buffer descriptor in between, and the
+    // "Next" field of the first descriptor, are set for each request.
+    //
+    Desc[0].Addr  = SlotDeviceAddress + OFFSET_OF (VBLK_SHARED_SLOT, Header);
+    Desc[0].Len   = sizeof Queue->Shared->Header;
+    Desc[0].Flags = VRING_DESC_F_NEXT;
+    Desc[0].Next  = (UINT16)(Base + 1);
+
+    Desc[2].Addr  = SlotDeviceAddress + OFFSET_OF (VBLK_SHARED_SLOT, HostStatus);
+    Desc[2].Len   = sizeof Queue->Shared->HostStatus;
+    Desc[2].Flags = VRING_DESC_F_WRITE;
+    Desc[2].Next  = 0;
+  }
+
+  Queue->NumFree = Queue->NumSlots;
+
+  //
+  // virtio-0.9.5, 2.4.2 Receiving Used Buffers From the Device
+  //
+  MemoryFence ();
+  Queue->LastUsed = *Queue->Ring.Used.Idx;
+  ASSERT (Queue->LastUsed == 0);
+
+  //
+  // want no interrupt when a request completes
+  //
+  *Queue->Ring.Avail.Flags = (UINT16)VRING_AVAIL_F_NO_INTERRUPT;
+
+  return EFI_SUCCESS;
+
+FreeSharedBuffer:
+  Dev->VirtIo->FreeSharedPages (
+                 Dev->VirtIo,
+                 EFI_SIZE_TO_PAGES (SharedSize),
+                 SharedBuffer
+                 );
+
+FreeSlots:
+  if (Queue->Slots != NULL) {
+    FreePool (Queue->Slots);
+  }
+
+  if (Queue->FreeStack != NULL) {
+    FreePool (Queue->FreeStack);
+  }
+
+UnmapQueue:
+  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Queue->RingMap);
+
+ReleaseQueue:
+  VirtioRingUninit (Dev->VirtIo, &Queue->Ring);
+
+  ZeroMem (Queue, sizeof *Queue);
+  return Status;
+}
+
+/**
+
+  Release a request virtqueue set up with VirtioBlkQueueInit(). The device must
+  have been reset.
+
+  @param[in out] Dev  The virtio-blk device.
+
+  @param[in] Index    The index of the virtqueue, and of Dev->Queues[].
+
+**/
+VOID
+VirtioBlkQueueUninit (
+  IN OUT VBLK_DEV  *Dev,
+  IN     UINT16    Index
+  )
+{
+  VBLK_QUEUE  *Queue;
+
+  Queue = &Dev->Queues[Index];
+
+  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Queue->SharedMap);
+  Dev->VirtIo->FreeSharedPages (
+                 Dev->VirtIo,
+                 EFI_SIZE_TO_PAGES (Queue->NumSlots * sizeof *Queue->Shared),
+                 Queue->Shared
+                 );
+  FreePool (Queue->Slots);
+  FreePool (Queue->FreeStack);
+
+  Dev->VirtIo->UnmapSharedBuffer (Dev->VirtIo, Queue->RingMap);
+  VirtioRingUninit (Dev->VirtIo, &Queue->Ring);
+
+  ZeroMem (Queue, sizeof *Queue);
+}
+
+/**
+
+  Complete a request whose chunks have all been reaped, or that was aborted
+  before any of its chunks was submitted. The request must not be on
+  Dev->PendingRequests.
+
+  A non-blocking request is released, and its token is signaled. A blocking
+  request is marked done, for the waiting VirtioBlkExecute() to return.
+
+  @param[in] Dev      The virtio-blk device.
+
+  @param[in] Request  The request to complete.
+
+**/
+STATIC
+VOID
+VirtioBlkCompleteRequest (
+  IN VBLK_DEV      *Dev,
+  IN VBLK_REQUEST  *Request
+  )
+{
+  EFI_BLOCK_IO2_TOKEN  *Token;
+
+  ASSERT (Request->InFlight == 0);
+  ASSERT (Request->RemainingSize == 0);
+
+  Token = Request->Token;
+  if (Token == NULL) {
+    Request->Done = TRUE;
+    return;
+  }
+
+  Token->TransactionStatus = Request->Status;
+  FreePool (Request);
+
+  ASSERT (Dev->AsyncRequests > 0);
+  if (--Dev->AsyncRequests == 0) {
+    gBS->SetTimer (Dev->PollTimer, TimerCancel, 0);
+  }
+
+  gBS->SignalEvent (Token->Event);
+}
+
+/**
+
+  Submit the next chunk of a request to a virtqueue that has a free slot.
+
+  The chunk is published in the available ring at AvailIdx, but the index of
+  the available ring itself is not updated.
+
+  @param[in] Dev           The virtio-blk device.
+
+  @param[in out] Queue     The virtqueue, with at least one free slot.
+
+  @param[in out] AvailIdx  The next free index of the available ring of Queue,
+                           incremented on success.
+
+  @param[in out] Request   The request. On success, its next chunk is
+                           accounted for as submitted.
+
+  @retval EFI_SUCCESS       The chunk has been submitted.
+
+  @retval EFI_DEVICE_ERROR  The data buffer of the chunk could not be mapped
+                            for bus master access.
+
+**/
+STATIC
+EFI_STATUS
+VirtioBlkSubmitChunk (
+  IN     VBLK_DEV      *Dev,
+  IN OUT VBLK_QUEUE    *Queue,
+  IN OUT UINT16        *AvailIdx,
+  IN OUT VBLK_REQUEST  *Request
+  )
+{
+  UINTN                 ChunkSize;
+  EFI_PHYSICAL_ADDRESS  BufferDeviceAddress;
+  VOID                  *BufferMapping;
+  UINT16                Slot;
+  UINT16                Base;
+  VBLK_SHARED_SLOT      *Shared;
+  volatile VRING_DESC   *Desc;
+  EFI_STATUS            Status;
+
+  ASSERT (Queue->NumFree > 0);
+
+  ChunkSize           = MIN (Request->RemainingSize, VBLK_MAX_CHUNK_SIZE);
+  BufferDeviceAddress = 0;
+  BufferMapping       = NULL;
+
+  if (ChunkSize > 0) {
+    Status = VirtioMapAllBytesInSharedBuffer (
+               Dev->VirtIo,
+               (Request->Type == VIRTIO_BLK_T_OUT ?
+                VirtioOperationBusMasterRead :
+                VirtioOperationBusMasterWrite),
+               Request->Buffer,
+               ChunkSize,
+               &BufferDeviceAddress,
+               &BufferMapping
+               );
+    if (EFI_ERROR (Status)) {
+      return EFI_DEVICE_ERROR;
+    }
+  }
+
+  Slot   = Queue->FreeStack[--Queue->NumFree];
+  Shared = &Queue->Shared[Slot];
+
+  //
+  // Prepare virtio-blk request header. IO Priority is homogeneously 0. Preset
+  // a host status for ourselves that we do not accept as success.
+  //
+  Shared->Header.Type   = Request->Type;
+  Shared->Header.IoPrio = 0;
+  Shared->Header.Sector = MultU64x32 (
+                            Request->Lba,
+                            Dev->BlockIoMedia.BlockSize / 512
+                            );
+  Shared->HostStatus    = VIRTIO_BLK_S_IOERR;
+
+  if (Dev->IndirectDesc) {
+    Base = 0;
+    Desc = Shared->Indirect;
+  } else {
+    Base = (UINT16)(3 * Slot);
+    Desc = &Queue->Ring.Desc[Base];
+  }
+
+  if (ChunkSize == 0) {
+    //
+    // flush: the header is followed by the host status directly
+    //
+    Desc[0].Next = (UINT16)(Base + 2);
+  } else {
+    //
+    // VRING_DESC_F_WRITE is interpreted from the host's point of view.
+    // VBLK_MAX_CHUNK_SIZE ensures that the length fits in the descriptor.
+    //
+    Desc[0].Next  = (UINT16)(Base + 1);
+    Desc[1].Addr  = BufferDeviceAddress;
+    Desc[1].Len   = (UINT32)ChunkSize;
+    Desc[1].Flags = (UINT16)(VRING_DESC_F_NEXT |
+                             (Request->Type == VIRTIO_BLK_T_IN ?
+                              VRING_DESC_F_WRITE : 0));
+    Desc[1].Next  = (UINT16)(Base + 2);
+  }
+
+  //
+  // virtio-0.9.5, 2.4.1.2 Updating the Available Ring
+  //
+  Queue->Ring.Avail.Ring[(*AvailIdx)++ % Queue->Ring.QueueSize] =
+    Dev->IndirectDesc ? Slot : Base;
+
+  Queue->Slots[Slot].Request       = Request;
+  Queue->Slots[Slot].BufferMapping = BufferMapping;
+
+  Request->Lba           += ChunkSize / Dev->BlockIoMedia.BlockSize;
+  Request->Buffer        += ChunkSize;
+  Request->RemainingSize -= ChunkSize;
+  ++Request->InFlight;
+  ++Dev->InFlight;
+
+  return EFI_SUCCESS;
+}
+
+/**
+
+  Reap the chunks that the device has completed, complete the requests whose
+  last chunk has been reaped, and submit as many pending chunks as the
+  virtqueues have free slots for.
+
+  Must be called at TPL_NOTIFY.
+
+  @param[in] Dev  The virtio-blk device.
+
+**/
+STATIC
+VOID
+VirtioBlkProcessQueues (
+  IN VBLK_DEV  *Dev
+  )
+{
+  UINT16        Index;
+  VBLK_QUEUE    *Queue;
+  UINT16        CurUsed;
+  UINT16        UsedElemIdx;
+  UINT32        DescIdx;
+  UINT16        Slot;
+  VBLK_REQUEST  *Request;
+  EFI_STATUS    Status;
+  UINT16        AvailIdx[VBLK_MAX_QUEUES];
+  BOOLEAN       Submitted[VBLK_MAX_QUEUES];
+  UINT16        Tried;
+
+  //
+  // virtio-0.9.5, 2.4.2 Receiving Used Buffers From the Device
+  //
+  for (Index = 0; Index < Dev->NumQueues; ++Index) {
+    Queue = &Dev->Queues[Index];
+
+    MemoryFence ();
+    CurUsed = *Queue->Ring.Used.Idx;
+    MemoryFence ();
+
+    while (Queue->LastUsed != CurUsed) {
+      UsedElemIdx = Queue->LastUsed++ % Queue->Ring.QueueSize;
+      DescIdx     = Queue->Ring.Used.UsedElem[UsedElemIdx].Id;
+      Slot        = (UINT16)(Dev->IndirectDesc ? DescIdx : DescIdx / 3);
+      ASSERT (Slot < Queue->NumSlots);
+      ASSERT (Queue->NumFree < Queue->NumSlots);
+
+      Request = Queue->Slots[Slot].Request;
+      ASSERT (Request != NULL);
+      ASSERT (Request->InFlight > 0);
+
+      Status = (Queue->Shared[Slot].HostStatus == VIRTIO_BLK_S_OK) ?
+               EFI_SUCCESS :
+               EFI_DEVICE_ERROR;
+
+      if (Queue->Slots[Slot].BufferMapping != NULL) {
+        if (EFI_ERROR (
+              Dev->VirtIo->UnmapSharedBuffer (
+                             Dev->VirtIo,
+                             Queue->Slots[Slot].BufferMapping
+                             )
+              ) &&
+            (Request->Type == VIRTIO_BLK_T_IN))
+        {
+          //
+          // Data from the bus master may not reach the caller; fail the
+          // request.
+          //
+          Status = EFI_DEVICE_ERROR;
+        }
+      }
+
+      Queue->Slots[Slot].Request         = NULL;
+      Queue->Slots[Slot].BufferMapping   = NULL;
+      Queue->FreeStack[Queue->NumFree++] = Slot;
+      --Dev->InFlight;
+
+      if (EFI_ERROR (Status)) {
+        Request->Status = Status;
+      }
+
+      //
+      // The request is complete when its last chunk has been reaped, and no
+      // chunk is left to submit.
+      //
+      if ((--Request->InFlight == 0) && (Request->RemainingSize == 0)) {
+        VirtioBlkCompleteRequest (Dev, Request);
+      }
+    }
+  }
+
+  //
+  // Submit the pending requests in order, spreading their chunks over the
+  // virtqueues round-robin.
+  //
+  for (Index = 0; Index < Dev->NumQueues; ++Index) {
+    AvailIdx[Index]  = *Dev->Queues[Index].Ring.Avail.Idx;
+    Submitted[Index] = FALSE;
+  }
+
+  while (!IsListEmpty (&Dev->PendingRequests)) {
+    Request = VBLK_REQUEST_FROM_LINK (GetFirstNode (&Dev->PendingRequests));
+
+    //
+    // A flush covers the requests completed before it is submitted, so it has
+    // to wait for all the requests queued before it.
+    //
+    if ((Request->Type == VIRTIO_BLK_T_FLUSH) && (Dev->InFlight > 0)) {
+      break;
+    }
+
+    for (Tried = 0; Tried < Dev->NumQueues; ++Tried) {
+      Index          = Dev->NextQueue;
+      Dev->NextQueue = (UINT16)((Index + 1) % Dev->NumQueues);
+      if (Dev->Queues[Index].NumFree > 0) {
+        break;
+      }
+    }
+
+    if (Tried == Dev->NumQueues) {
+      //
+      // All the slots are in flight.
+      //
+      break;
+    }
+
+    Status = VirtioBlkSubmitChunk (
+               Dev,
+               &Dev->Queues[Index],
+               &AvailIdx[Index],
+               Request
+               );
+    if (EFI_ERROR (Status)) {
+      //
+      // Drop the rest of the request; it fails once its submitted chunks have
+      // been reaped.
+      //
+      Request->Status        = Status;
+      Request->RemainingSize = 0;
+    } else {
+      Submitted[Index] = TRUE;
+    }
+
+    if (Request->RemainingSize == 0) {
+      RemoveEntryList (&Request->Link);
+      if (Request->InFlight == 0) {
+        VirtioBlkCompleteRequest (Dev, Request);
+      }
+    }
+  }
+
+  //
+  // Expose the new chunks to the device in one go per virtqueue, and notify
+  // the device about them.
+  //
+  for (Index = 0; Index < Dev->NumQueues; ++Index) {
+    if (!Submitted[Index]) {
+      continue;
+    }
+
+    MemoryFence ();
+    *Dev->Queues[Index].Ring.Avail.Idx = AvailIdx[Index];
+    MemoryFence ();
+
+    Status = Dev->VirtIo->SetQueueNotify (Dev->VirtIo, Index);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((
+        DEBUG_ERROR,
+        "%a: failed to notify queue %u: %r\n",
+        __func__,
+        Index,
+        Status
+        ));
+    }
+  }
+}
+
+/**
+
+  Queue a request, and, if it is blocking, wait for its completion.
+
+  The request parameters must have been verified by the caller.
+
+  @param[in] Dev         The virtio-blk device.
+
+  @param[in] Token       The EFI_BLOCK_IO2_PROTOCOL token of the request, or
+                         NULL for a blocking request. Token->Event must not be
+                         NULL.
+
+  @param[in] Type        VIRTIO_BLK_T_IN, VIRTIO_BLK_T_OUT or
+                         VIRTIO_BLK_T_FLUSH.
+
+  @param[in] Lba         The first block to transfer; zero for a flush.
+
+  @param[in] BufferSize  The size of Buffer in bytes, a multiple of the block
+                         size; zero for a flush.
+
+  @param[in] Buffer      The buffer to read the data into, or write the data
+                         from; NULL for a flush.
+
+  @retval EFI_SUCCESS           The blocking request completed, or the
+                                non-blocking request was queued.
+
+  @retval EFI_OUT_OF_RESOURCES  The non-blocking request could not be queued.
+
+  @retval EFI_DEVICE_ERROR      The blocking request failed, or the device has
+                                no virtqueue since an extended reset failed.
+
+**/
+EFI_STATUS
+VirtioBlkExecute (
+  IN VBLK_DEV             *Dev,
+  IN EFI_BLOCK_IO2_TOKEN  *Token,
+  IN UINT32               Type,
+  IN EFI_LBA              Lba,
+  IN UINTN                BufferSize,
+  IN VOID                 *Buffer
+  )
+{
+  VBLK_REQUEST  BlockingRequest;
+  VBLK_REQUEST  *Request;
+  EFI_TPL       OldTpl;
+  UINTN         PollPeriodUsecs;
+
+  ASSERT ((Type == VIRTIO_BLK_T_FLUSH) == (BufferSize == 0));
+  ASSERT (BufferSize % Dev->BlockIoMedia.BlockSize == 0);
+
+  if (Dev->NumQueues == 0) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  if (Token == NULL) {
+    Request = &BlockingRequest;
+  } else {
+    ASSERT (Token->Event != NULL);
+    Request = AllocatePool (sizeof *Request);
+    if (Request == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  Request->Signature     = VBLK_REQ_SIG;
+  Request->Token         = Token;
+  Request->Type          = Type;
+  Request->Lba           = Lba;
+  Request->Buffer        = Buffer;
+  Request->RemainingSize = BufferSize;
+  Request->InFlight      = 0;
+  Request->Status        = EFI_SUCCESS;
+  Request->Done          = FALSE;
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
+  InsertTailList (&Dev->PendingRequests, &Request->Link);
+  if ((Token != NULL) && (Dev->AsyncRequests++ == 0)) {
+    gBS->SetTimer (Dev->PollTimer, TimerPeriodic, VBLK_POLL_PERIOD);
+  }
+
+  VirtioBlkProcessQueues (Dev);
+
+  gBS->RestoreTPL (OldTpl);
+
+  if (Token != NULL) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // Keep slowing down until we reach a poll period of slightly above 1 ms.
+  //
+  PollPeriodUsecs = 1;
+  while (!Request->Done) {
+    gBS->Stall (PollPeriodUsecs);
+
+    if (PollPeriodUsecs < 1024) {
+      PollPeriodUsecs *= 2;
+    }
+
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    VirtioBlkProcessQueues (Dev);
+    gBS->RestoreTPL (OldTpl);
+  }
+
+  return EFI_ERROR (Request->Status) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
+}
+
+/**
+
+  Abort the requests that have not been submitted to the device yet, and wait
+  for the device to complete the others.
+
+  @param[in] Dev  The virtio-blk device.
+
+**/
+VOID
+VirtioBlkDrain (
+  IN VBLK_DEV  *Dev
+  )
+{
+  EFI_TPL       OldTpl;
+  VBLK_REQUEST  *Request;
+  BOOLEAN       Idle;
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  while (!IsListEmpty (&Dev->PendingRequests)) {
+    Request = VBLK_REQUEST_FROM_LINK (GetFirstNode (&Dev->PendingRequests));
+    RemoveEntryList (&Request->Link);
+
+    Request->Status        = EFI_ABORTED;
+    Request->RemainingSize = 0;
+    if (Request->InFlight == 0) {
+      VirtioBlkCompleteRequest (Dev, Request);
+    }
+  }
+
+  gBS->RestoreTPL (OldTpl);
+
+  while (TRUE) {
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    VirtioBlkProcessQueues (Dev);
+    Idle = (BOOLEAN)(Dev->InFlight == 0);
+    gBS->RestoreTPL (OldTpl);
+
+    if (Idle) {
+      break;
+    }
+
+    gBS->Stall (100);
+  }
+}
+
+/**
+
+  Timer notification function that reaps the completed requests, and submits
+  the pending ones.
+
+  @param[in] Event    The Dev->PollTimer event.
+
+  @param[in] Context  Pointer to the VBLK_DEV structure.
+
+**/
+VOID
+EFIAPI
+VirtioBlkPollTimer (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  VirtioBlkProcessQueues (Context);
+}
@@ -0,0 +1,202 @@
+/** @file
+  Shell application to measure how memory zeroing scales across the APs.
+
+  The application zeroes a buffer with ZeroMem () on the BSP, then with a
+  parallel-for of TaskPoolLib limited to 1, 2, 4 and up to all the processors,
+  and reports the average time, the throughput and the speedup over the BSP
+  of each configuration.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PrintLib.h>
+#include <Library/TaskPoolLib.h>
+#include <Library/UefiLib.h>
+#include <Library/UefiApplicationEntryPoint.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/TimerLib.h>
+#include <Library/ElapsedTimeLib.h>
+
+#include <Protocol/ShellParameters.h>
+
+#define PERF_DEFAULT_SIZE_MB     256
+#define PERF_DEFAULT_ITERATIONS  10
+
+//
+// Each index of the parallel-for zeroes one block.
+//
+#define PERF_BLOCK_SIZE  SIZE_64KB
+
+/**
+  Zero the blocks [Start, End) of the buffer.
+
+  @param[in] Start    The first block.
+  @param[in] End      The block following the last block.
+  @param[in] Context  The buffer.
+
+**/
+VOID
+EFIAPI
+PerfZeroBlocks (
+  IN UINTN  Start,
+  IN UINTN  End,
+  IN VOID   *Context
+  )
+{
+  ZeroMem ((UINT8 *)Context + Start * PERF_BLOCK_SIZE, (End - Start) * PERF_BLOCK_SIZE);
+}
+
+/**
+  Print the results of a configuration.
+
+  @param  Label                  The configuration.
+  @param  SizeMb                 The number of MB zeroed by each iteration.
+  @param  NanoSeconds            The average time of an iteration.
+  @param  BspNanoSeconds         The average time of an iteration on the BSP.
+
+**/
+VOID
+PerfPrintResult (
+  IN CHAR16  *Label,
+  IN UINTN   SizeMb,
+  IN UINT64  NanoSeconds,
+  IN UINT64  BspNanoSeconds
+  )
+{
+  UINT64  Speedup;
+  UINT64  Remainder;
+
+  NanoSeconds = MAX (NanoSeconds, 1);
+  Speedup     = DivU64x64Remainder (BspNanoSeconds, NanoSeconds, &Remainder);
+  Print (
+    L"%-12s %8lu us %8lu MB/s %4lu.%02lux\n",
+    Label,
+    DivU64x32 (NanoSeconds, 1000),
+    DivU64x64Remainder (MultU64x32 (SizeMb, 1000000000), NanoSeconds, NULL),
+    Speedup,
+    DivU64x64Remainder (MultU64x32 (Remainder, 100), NanoSeconds, NULL)
+    );
+}
+
+/**
+  The user Entry Point for Application. The user code starts with this function
+  as the real entry point for the image goes into a library that calls this
+  function.
+
+  @param[in] ImageHandle    The firmware allocated handle for the EFI image.
+  @param[in] SystemTable    A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS       The entry point is executed successfully.
+  @retval other             Some error occurs when executing this entry point.
+
+**/
+EFI_STATUS
+EFIAPI
+UefiMain (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS                     Status;
+  EFI_SHELL_PARAMETERS_PROTOCOL  *ShellParameters;
+  TASK_POOL                      *Pool;
+  UINTN                          SizeMb;
+  UINTN                          Size;
+  UINTN                          Iterations;
+  UINTN                          Iteration;
+  UINTN                          MaxWorkers;
+  UINTN                          Workers;
+  VOID                           *Buffer;
+  UINT64                         Start;
+  UINT64                         BspNanoSeconds;
+  UINT64                         NanoSeconds;
+  CHAR16                         Label[16];
+
+  SizeMb     = PERF_DEFAULT_SIZE_MB;
+  Iterations = PERF_DEFAULT_ITERATIONS;
+  Status     = gBS->HandleProtocol (
+                      ImageHandle,
+                      &gEfiShellParametersProtocolGuid,
+                      (VOID **)&ShellParameters
+                      );
+  if (!EFI_ERROR (Status)) {
+    if (ShellParameters->Argc > 3) {
+      Print (L"Usage: TaskPoolPerf [SizeInMB] [Iterations]\n");
+      return EFI_INVALID_PARAMETER;
+    }
+
+    if (ShellParameters->Argc >= 2) {
+      SizeMb = StrDecimalToUintn (ShellParameters->Argv[1]);
+    }
+
+    if (ShellParameters->Argc == 3) {
+      Iterations = StrDecimalToUintn (ShellParameters->Argv[2]);
+    }
+  }
+
+  if ((SizeMb == 0) || (SizeMb > MAX_UINTN / SIZE_1MB) || (Iterations == 0) || (Iterations > MAX_UINT32)) {
+    Print (L"TaskPoolPerf: invalid size or iteration count\n");
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Size   = SizeMb * SIZE_1MB;
+  Buffer = AllocatePages (EFI_SIZE_TO_PAGES (Size));
+  if (Buffer == NULL) {
+    Print (L"TaskPoolPerf: cannot allocate %lu MB\n", (UINT64)SizeMb);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Touch the buffer once so that no run pays for the first access.
+  //
+  ZeroMem (Buffer, Size);
+
+  Start = GetPerformanceCounter ();
+  for (Iteration = 0; Iteration < Iterations; Iteration++) {
+    ZeroMem (Buffer, Size);
+  }
+
+  BspNanoSeconds = DivU64x32 (GetElapsedTimeInNanoSecond (Start, GetPerformanceCounter ()), (UINT32)Iterations);
+  PerfPrintResult (L"BSP ZeroMem", SizeMb, BspNanoSeconds, BspNanoSeconds);
+
+  Status = TaskPoolCreate (0, 0, &Pool);
+  if (EFI_ERROR (Status)) {
+    Print (L"TaskPoolPerf: cannot create the task pool - %r\n", Status);
+    FreePages (Buffer, EFI_SIZE_TO_PAGES (Size));
+    return Status;
+  }
+
+  MaxWorkers = TaskPoolGetWorkerCount (Pool);
+  TaskPoolDestroy (Pool);
+
+  for (Workers = 1; ; Workers = MIN (Workers * 2, MaxWorkers)) {
+    Status = TaskPoolCreate (0, Workers, &Pool);
+    if (EFI_ERROR (Status)) {
+      Print (L"TaskPoolPerf: cannot create the task pool - %r\n", Status);
+      break;
+    }
+
+    Start = GetPerformanceCounter ();
+    for (Iteration = 0; Iteration < Iterations; Iteration++) {
+      TaskPoolParallelFor (Pool, 0, Size / PERF_BLOCK_SIZE, 0, PerfZeroBlocks, Buffer);
+    }
+
+    NanoSeconds = DivU64x32 (GetElapsedTimeInNanoSecond (Start, GetPerformanceCounter ()), (UINT32)Iterations);
+    TaskPoolDestroy (Pool);
+
+    UnicodeSPrint (Label, sizeof (Label), L"%lu workers", (UINT64)Workers);
+    PerfPrintResult (Label, SizeMb, NanoSeconds, BspNanoSeconds);
+    if (Workers == MaxWorkers) {
+      break;
+    }
+  }
+
+  FreePages (Buffer, EFI_SIZE_TO_PAGES (Size));
+  return EFI_SUCCESS;
+}
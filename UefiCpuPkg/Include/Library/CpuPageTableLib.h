@@ -111,6 +111,99 @@ PageTableMap (
   OUT    BOOLEAN             *IsModified   OPTIONAL
   );
 
+///
+/// One range to map with PageTableMapBatch ().
+///
+typedef struct {
+  UINT64                LinearAddress;
+  UINT64                Length;
+  IA32_MAP_ATTRIBUTE    Attribute;
+  IA32_MAP_ATTRIBUTE    Mask;
+} IA32_MAP_REQUEST;
+
+/**
+  Map the ranges of one task of PageTableMapBatch ().
+
+  @param[in] TaskContext  The context passed to PAGE_TABLE_RUN_TASKS.
+  @param[in] TaskIndex    The index of the task to run.
+**/
+typedef
+VOID
+(EFIAPI *PAGE_TABLE_MAP_TASK)(
+  IN VOID   *TaskContext,
+  IN UINTN  TaskIndex
+  );
+
+/**
+  Run Task (TaskContext, TaskIndex) once for every TaskIndex below TaskCount.
+
+  The tasks update disjoint parts of the page table, so they can run in any order
+  and concurrently on any processors. The function returns when all the tasks are done.
+
+  @param[in] Context      The RunTasksContext passed to PageTableMapBatch ().
+  @param[in] Task         The task function.
+  @param[in] TaskContext  The context to pass to the task function.
+  @param[in] TaskCount    The number of tasks.
+**/
+typedef
+VOID
+(EFIAPI *PAGE_TABLE_RUN_TASKS)(
+  IN VOID                 *Context,
+  IN PAGE_TABLE_MAP_TASK  Task,
+  IN VOID                 *TaskContext,
+  IN UINTN                TaskCount
+  );
+
+/**
+  Create or update page table to map several linear address ranges, each with its own attribute.
+
+  The requests are sorted by linear address and the adjacent requests that continue each other
+  with the same attribute and mask are merged. The paging structures above the 1GB entries are
+  then updated on the calling processor, and the 1GB regions are split into tasks that populate
+  independent subtrees. When RunTasks is not NULL, it runs the tasks, possibly in parallel.
+
+  The requests must not overlap. The resulting mappings are the same as the ones of calling
+  PageTableMap () for each request in turn.
+
+  @param[in, out] PageTable        The pointer to the page table to update, or pointer to NULL if a new page table is to be created.
+                                   If not pointer to NULL, the value it points to won't be changed in this function.
+  @param[in]      PagingMode       The paging mode.
+  @param[in]      Buffer           The free buffer to be used for page table creation/updating.
+  @param[in, out] BufferSize       The buffer size.
+                                   On return, the remaining buffer size. The free buffer is used from the end.
+                                   The size needed may be larger than the total of the PageTableMap () calls because
+                                   the paging structures shared by requests are counted once per request, and when the
+                                   tasks run in parallel, the unused part of the buffer of each task but the last one is
+                                   not returned.
+  @param[in, out] Requests         The ranges to map. On return, they are sorted and merged.
+  @param[in, out] RequestCount     On input, the number of requests. On output, the number of requests after merging.
+  @param[in]      RunTasks         The function to run the tasks in parallel, or NULL to run them on the calling processor.
+  @param[in]      RunTasksContext  The context passed to RunTasks.
+  @param[out]     IsModified       TRUE means page table is modified by software or hardware. FALSE means page table is not modified by software.
+
+  @retval RETURN_UNSUPPORTED        PagingMode is not supported.
+  @retval RETURN_INVALID_PARAMETER  PageTable, BufferSize or RequestCount is NULL, or Requests is NULL and *RequestCount is not 0.
+  @retval RETURN_INVALID_PARAMETER  A request is invalid for PageTableMap (), or two requests overlap.
+                                    The page table is not modified.
+  @retval RETURN_INVALID_PARAMETER  *BufferSize is not multiple of 4KB.
+  @retval RETURN_BUFFER_TOO_SMALL   The buffer is too small for page table creation/updating.
+                                    BufferSize is updated to indicate the expected buffer size.
+  @retval RETURN_SUCCESS            PageTable is created/updated successfully or there is nothing to map.
+**/
+RETURN_STATUS
+EFIAPI
+PageTableMapBatch (
+  IN OUT UINTN                 *PageTable  OPTIONAL,
+  IN     PAGING_MODE           PagingMode,
+  IN     VOID                  *Buffer,
+  IN OUT UINTN                 *BufferSize,
+  IN OUT IA32_MAP_REQUEST      *Requests,
+  IN OUT UINTN                 *RequestCount,
+  IN     PAGE_TABLE_RUN_TASKS  RunTasks         OPTIONAL,
+  IN     VOID                  *RunTasksContext OPTIONAL,
+  OUT    BOOLEAN               *IsModified      OPTIONAL
+  );
+
 typedef struct {
   UINT64                LinearAddress;
   UINT64                Length;
@@ -105,6 +105,18 @@ typedef struct {
   MTRR_MEMORY_CACHE_TYPE    Type;
 } MTRR_MEMORY_RANGE;
 
+///
+/// Memory ranges collected by MtrrTransactionAddRange () and set together by
+/// MtrrTransactionCommit (). The fields are private to MtrrLib.
+///
+typedef struct {
+  MTRR_SETTINGS        *MtrrSetting;
+  MTRR_MEMORY_RANGE    *Ranges;
+  UINTN                RangeCount;
+  UINTN                MaxRangeCount;
+  RETURN_STATUS        Status;
+} MTRR_TRANSACTION;
+
 /**
   Returns the variable MTRR count for the CPU.
 
@@ -384,4 +396,91 @@ MtrrGetMemoryAttributesInMtrrSettings (
   IN OUT   UINTN              *RangeCount
   );
 
+/**
+  Start collecting memory ranges whose attributes are set together.
+
+  Calling MtrrSetMemoryAttribute () for each range recalculates the MTRRs and
+  reprograms them with caches disabled every time. A transaction instead
+  calculates the MTRRs once for all the ranges, and programs them at most once.
+  To set the same MTRRs on all processors, commit into an MTRR_SETTINGS buffer
+  and then pass it to MtrrSetAllMtrrs () on each processor.
+
+  @param[out] Transaction    The transaction to start.
+  @param[in]  MtrrSetting    MTRR setting buffer to update in the commit,
+                             or NULL to program the MTRRs of the calling processor.
+  @param[in]  Ranges         Caller buffer to hold the memory ranges.
+  @param[in]  MaxRangeCount  Count of MTRR_MEMORY_RANGE the Ranges can hold.
+
+  @retval RETURN_SUCCESS            The transaction was started.
+  @retval RETURN_INVALID_PARAMETER  Transaction is NULL, or Ranges is NULL and MaxRangeCount is not 0.
+**/
+RETURN_STATUS
+EFIAPI
+MtrrTransactionBegin (
+  OUT MTRR_TRANSACTION   *Transaction,
+  IN  MTRR_SETTINGS      *MtrrSetting  OPTIONAL,
+  IN  MTRR_MEMORY_RANGE  *Ranges,
+  IN  UINTN              MaxRangeCount
+  );
+
+/**
+  Add a memory range to a transaction.
+
+  When ranges overlap, the last one added takes higher priority. A range that
+  continues the previous one with the same attribute is merged into it.
+  A failure is remembered and returned by MtrrTransactionCommit (), so that
+  either all the ranges or none of them are set.
+
+  @param[in, out] Transaction  The transaction.
+  @param[in]      BaseAddress  The physical address that is the start address
+                               of a memory range.
+  @param[in]      Length       The size in bytes of the memory range.
+  @param[in]      Attribute    The attribute to set for the memory range.
+
+  @retval RETURN_SUCCESS            The memory range was added.
+  @retval RETURN_INVALID_PARAMETER  Transaction is NULL, or Length is zero.
+  @retval RETURN_OUT_OF_RESOURCES   The Ranges buffer of the transaction is full.
+  @retval Others                    An earlier call failed with this status.
+**/
+RETURN_STATUS
+EFIAPI
+MtrrTransactionAddRange (
+  IN OUT MTRR_TRANSACTION        *Transaction,
+  IN     PHYSICAL_ADDRESS        BaseAddress,
+  IN     UINT64                  Length,
+  IN     MTRR_MEMORY_CACHE_TYPE  Attribute
+  );
+
+/**
+  Set the attributes of all the memory ranges of a transaction.
+
+  The MTRRs are calculated once for all the ranges, then written to the
+  MTRR setting buffer of the transaction, or to the MTRRs of the calling
+  processor in one cache-disabled sequence.
+
+  The transaction is emptied unless RETURN_BUFFER_TOO_SMALL is returned, in
+  which case the commit can be retried with a larger scratch buffer.
+
+  @param[in, out] Transaction  The transaction.
+  @param[in]      Scratch      A temporary scratch buffer that is used to perform the calculation,
+                               or NULL to use an internal buffer.
+  @param[in, out] ScratchSize  Pointer to the size in bytes of the scratch buffer.
+                               It may be updated to the actual required size when the calculation
+                               needs more scratch buffer. When Scratch is NULL, it may be NULL,
+                               and is only updated when the internal buffer is too small.
+
+  @retval RETURN_SUCCESS            The attributes were set for all the memory ranges.
+  @retval RETURN_INVALID_PARAMETER  Transaction is NULL, or Scratch is not NULL and ScratchSize is NULL.
+  @retval RETURN_BUFFER_TOO_SMALL   The scratch buffer is too small for MTRR calculation.
+  @retval Others                    The status of a failed MtrrTransactionAddRange (), or
+                                    of MtrrSetMemoryAttributesInMtrrSettings ().
+**/
+RETURN_STATUS
+EFIAPI
+MtrrTransactionCommit (
+  IN OUT MTRR_TRANSACTION  *Transaction,
+  IN     VOID              *Scratch      OPTIONAL,
+  IN OUT UINTN             *ScratchSize  OPTIONAL
+  );
+
 #endif // _MTRR_LIB_H_
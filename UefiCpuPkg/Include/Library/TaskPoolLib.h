@@ -0,0 +1,216 @@
+/** @file
+  Task pool library.
+
+  The task pool runs small tasks on the BSP and the APs. Every processor owns a
+  deque of tasks: it pushes and pops the tasks it submits at the tail, and a
+  processor running out of tasks steals the oldest task at the head of the
+  deque of another processor. Tasks may submit more tasks and wait for their
+  completion through futures, and a parallel-for splits an index range into
+  tasks that are balanced across the processors by the stealing.
+
+  The processors are started with the MP Services PPI in PEI and the MP
+  Services protocol in DXE, both produced by MpInitLib. When they are not
+  available, all the tasks run on the BSP.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef TASK_POOL_LIB_H_
+#define TASK_POOL_LIB_H_
+
+typedef struct _TASK_POOL         TASK_POOL;
+typedef struct _TASK_POOL_TASK    TASK_POOL_FUTURE;
+
+/**
+  A task submitted to the task pool.
+
+  Tasks run on any of the processors, so they must follow the rules of
+  procedures started on the APs: they cannot use the boot services, the PEI
+  services or any other service that is not MP safe.
+
+  @param[in] Context  The context passed when the task was submitted.
+
+**/
+typedef
+VOID
+(EFIAPI *TASK_POOL_PROCEDURE)(
+  IN VOID  *Context
+  );
+
+/**
+  The body of a parallel-for, run for a part of its index range.
+
+  @param[in] Start    The first index of the part.
+  @param[in] End      The index following the last index of the part.
+  @param[in] Context  The context passed to TaskPoolParallelFor ().
+
+**/
+typedef
+VOID
+(EFIAPI *TASK_POOL_RANGE_PROCEDURE)(
+  IN UINTN  Start,
+  IN UINTN  End,
+  IN VOID   *Context
+  );
+
+/**
+  Create a task pool.
+
+  Must be called on the BSP.
+
+  @param[in]  MaxTasks      The number of tasks that can be pending at the same
+                            time. When all of them are pending, the task
+                            submitted next runs at once on the submitting
+                            processor. 0 selects 64 tasks per processor.
+  @param[in]  MaxWorkers    The number of processors running the tasks, or 0
+                            for all the enabled processors.
+  @param[out] Pool          The created task pool.
+
+  @retval RETURN_SUCCESS            The task pool was created.
+  @retval RETURN_INVALID_PARAMETER  Pool is NULL.
+  @retval RETURN_OUT_OF_RESOURCES   There is not enough memory for the pool.
+
+**/
+RETURN_STATUS
+EFIAPI
+TaskPoolCreate (
+  IN  UINTN      MaxTasks,
+  IN  UINTN      MaxWorkers,
+  OUT TASK_POOL  **Pool
+  );
+
+/**
+  Free a task pool.
+
+  Must be called on the BSP, when no TaskPoolRun () is in progress.
+
+  @param[in] Pool  The task pool to free.
+
+**/
+VOID
+EFIAPI
+TaskPoolDestroy (
+  IN TASK_POOL  *Pool
+  );
+
+/**
+  Return the number of processors that may run the tasks of a task pool.
+
+  @param[in] Pool  The task pool.
+
+  @return The number of processors, at least 1.
+
+**/
+UINTN
+EFIAPI
+TaskPoolGetWorkerCount (
+  IN TASK_POOL  *Pool
+  );
+
+/**
+  Run a task and all the tasks it submits, and return when they all completed.
+
+  Must be called on the BSP, outside of any task. The APs run the tasks for the
+  whole duration of the call, and the BSP joins them when the MP services allow
+  it to go on while the APs run.
+
+  @param[in] Pool       The task pool.
+  @param[in] Procedure  The first task.
+  @param[in] Context    The context passed to Procedure.
+
+  @retval RETURN_SUCCESS            All the tasks completed.
+  @retval RETURN_INVALID_PARAMETER  Pool or Procedure is NULL.
+  @retval RETURN_ALREADY_STARTED    The task pool is already running.
+
+**/
+RETURN_STATUS
+EFIAPI
+TaskPoolRun (
+  IN TASK_POOL            *Pool,
+  IN TASK_POOL_PROCEDURE  Procedure,
+  IN VOID                 *Context
+  );
+
+/**
+  Submit a task from a running task.
+
+  The task is pushed to the deque of the calling processor. When all the tasks
+  of the pool are pending, the task runs before this function returns, and
+  *Future is set to NULL.
+
+  A returned future must be passed to TaskPoolWait () once. The futures that
+  are not waited for are released when TaskPoolRun () returns.
+
+  @param[in]  Pool       The task pool.
+  @param[in]  Procedure  The task.
+  @param[in]  Context    The context passed to Procedure.
+  @param[out] Future     The future of the task, or NULL to not wait for it.
+
+  @retval RETURN_SUCCESS            The task was submitted or ran.
+  @retval RETURN_INVALID_PARAMETER  Pool or Procedure is NULL.
+  @retval RETURN_NOT_STARTED        The task pool is not running.
+
+**/
+RETURN_STATUS
+EFIAPI
+TaskPoolSubmit (
+  IN  TASK_POOL            *Pool,
+  IN  TASK_POOL_PROCEDURE  Procedure,
+  IN  VOID                 *Context,
+  OUT TASK_POOL_FUTURE     **Future OPTIONAL
+  );
+
+/**
+  Wait for a task submitted by TaskPoolSubmit () to complete, and release its
+  future.
+
+  The calling processor runs other tasks while it waits.
+
+  @param[in] Pool    The task pool.
+  @param[in] Future  The future of the task. NULL returns at once.
+
+**/
+VOID
+EFIAPI
+TaskPoolWait (
+  IN TASK_POOL         *Pool,
+  IN TASK_POOL_FUTURE  *Future
+  );
+
+/**
+  Run Procedure over the index range [Start, End), split in parts of about
+  Grain indexes that run in parallel.
+
+  Called on the BSP outside of any task, the function runs the parallel-for
+  with TaskPoolRun (). Called from a running task, the parts run as tasks of
+  the current run. In both cases the function returns when all the parts
+  completed.
+
+  @param[in] Pool       The task pool.
+  @param[in] Start      The first index.
+  @param[in] End        The index following the last index.
+  @param[in] Grain      The number of indexes under which a part is not split
+                        further, or 0 to select it from the number of
+                        processors.
+  @param[in] Procedure  The body of the parallel-for.
+  @param[in] Context    The context passed to Procedure.
+
+  @retval RETURN_SUCCESS            All the parts completed.
+  @retval RETURN_INVALID_PARAMETER  Pool or Procedure is NULL, or End is
+                                    below Start.
+
+**/
+RETURN_STATUS
+EFIAPI
+TaskPoolParallelFor (
+  IN TASK_POOL                  *Pool,
+  IN UINTN                      Start,
+  IN UINTN                      End,
+  IN UINTN                      Grain,
+  IN TASK_POOL_RANGE_PROCEDURE  Procedure,
+  IN VOID                       *Context
+  );
+
+#endif
@@ -230,4 +230,88 @@ PageTableLibGetPnleMapAttribute (
   IN IA32_MAP_ATTRIBUTE        *ParentMapAttribute
   );
 
+/**
+  Set the IA32_PDPTE_1G, IA32_PDE_2M or IA32_PTE_4K.
+
+  @param[in] Level     3, 2 or 1.
+  @param[in] Ple       Pointer to PDPTE_1G, PDE_2M or IA32_PTE_4K, depending on the Level.
+  @param[in] Offset    The offset within the linear address range.
+  @param[in] Attribute The attribute of the linear address range.
+  @param[in] Mask      The mask used for attribute. The corresponding field in Attribute is ignored if that in Mask is 0.
+**/
+VOID
+PageTableLibSetPle (
+  IN UINTN                           Level,
+  IN OUT volatile IA32_PAGING_ENTRY  *Ple,
+  IN UINT64                          Offset,
+  IN IA32_MAP_ATTRIBUTE              *Attribute,
+  IN IA32_MAP_ATTRIBUTE              *Mask
+  );
+
+/**
+  Set the IA32_PML5, IA32_PML4, IA32_PDPTE or IA32_PDE.
+
+  @param[in] Pnle      Pointer to IA32_PML5, IA32_PML4, IA32_PDPTE or IA32_PDE. All share the same structure definition.
+  @param[in] Attribute The attribute of the page directory referenced by the non-leaf.
+  @param[in] Mask      The mask of the page directory referenced by the non-leaf.
+**/
+VOID
+PageTableLibSetPnle (
+  IN OUT volatile IA32_PAGE_NON_LEAF_ENTRY  *Pnle,
+  IN IA32_MAP_ATTRIBUTE                     *Attribute,
+  IN IA32_MAP_ATTRIBUTE                     *Mask
+  );
+
+/**
+  Check if the combination for Attribute and Mask is valid for non-present entry.
+
+  @param[in] Attribute    The attribute of the linear address range.
+  @param[in] Mask         The mask used for attribute to check.
+
+  @retval RETURN_INVALID_PARAMETER  The combination is invalid for a non-present range.
+  @retval RETURN_SUCCESS            The combination for Attribute and Mask is valid.
+**/
+RETURN_STATUS
+IsAttributesAndMaskValidForNonPresentEntry (
+  IN     IA32_MAP_ATTRIBUTE  *Attribute,
+  IN     IA32_MAP_ATTRIBUTE  *Mask
+  );
+
+/**
+  Update page table to map [LinearAddress, LinearAddress + Length) with specified attribute in the specified level.
+
+  @param[in]      ParentPagingEntry The pointer to the page table entry to update.
+  @param[in]      ParentAttribute   The accumulated attribute of all parents' attribute.
+  @param[in]      Modify            FALSE to indicate Buffer is not used and BufferSize is increased by the required buffer size.
+  @param[in]      Buffer            The free buffer to be used for page table creation/updating.
+  @param[in, out] BufferSize        The available buffer size.
+  @param[in]      Level             Page table level. Could be 5, 4, 3, 2, or 1.
+  @param[in]      MaxLeafLevel      Maximum level that can be a leaf entry. Could be 1, 2 or 3 (if Page 1G is supported).
+  @param[in]      LinearAddress     The start of the linear address range.
+  @param[in]      Length            The length of the linear address range.
+  @param[in]      Offset            The offset within the linear address range.
+  @param[in]      Attribute         The attribute of the linear address range.
+  @param[in]      Mask              The mask used for attribute. The corresponding field in Attribute is ignored if that in Mask is 0.
+  @param[in, out] IsModified        Change IsModified to True if page table is modified and input parameter Modify is TRUE.
+
+  @retval RETURN_INVALID_PARAMETER  The attribute and mask are invalid for a non-present range.
+  @retval RETURN_SUCCESS            PageTable is created/updated successfully.
+**/
+RETURN_STATUS
+PageTableLibMapInLevel (
+  IN     IA32_PAGING_ENTRY   *ParentPagingEntry,
+  IN     IA32_MAP_ATTRIBUTE  *ParentAttribute,
+  IN     BOOLEAN             Modify,
+  IN     VOID                *Buffer,
+  IN OUT INTN                *BufferSize,
+  IN     IA32_PAGE_LEVEL     Level,
+  IN     IA32_PAGE_LEVEL     MaxLeafLevel,
+  IN     UINT64              LinearAddress,
+  IN     UINT64              Length,
+  IN     UINT64              Offset,
+  IN     IA32_MAP_ATTRIBUTE  *Attribute,
+  IN     IA32_MAP_ATTRIBUTE  *Mask,
+  IN OUT BOOLEAN             *IsModified
+  );
+
 #endif
@@ -0,0 +1,789 @@
+/** @file
+  This library implements the batched page table mapping of CpuPageTableLib.
+
+  The paging structures above the 1GB entries are shared by all the requests, so they are
+  created and updated on the calling processor first. The 1GB regions are then split into
+  tasks that only update their own PDPTEs and the subtrees below them, so the tasks can run
+  in parallel.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "CpuPageTable.h"
+
+//
+// Maximum number of tasks a batch is split into.
+//
+#define PAGE_TABLE_MAP_MAX_TASKS  32
+
+//
+// A request needs a new page table under a non-present entry when it maps the range as present.
+//
+#define PAGE_TABLE_MAP_NEEDS_TABLE(Request)  (((Request)->Mask.Bits.Present == 1) && ((Request)->Attribute.Bits.Present == 1))
+
+typedef struct {
+  //
+  // The task maps the part of the requests in [Start, End). Start and End are 1GB aligned.
+  //
+  UINT64           Start;
+  UINT64           End;
+  //
+  // When sizing, the negated buffer size the task needs. When mapping, the end of the
+  // free buffer of the task, used from the end.
+  //
+  INTN             BufferSize;
+  RETURN_STATUS    Status;
+  BOOLEAN          IsModified;
+} PAGE_TABLE_MAP_TASK_DATA;
+
+typedef struct {
+  IA32_PAGING_ENTRY           *TopPagingEntry;
+  IA32_PAGE_LEVEL             MaxLevel;
+  IA32_PAGE_LEVEL             MaxLeafLevel;
+  BOOLEAN                     Modify;
+  VOID                        *Buffer;
+  IA32_MAP_REQUEST            *Requests;
+  UINTN                       RequestCount;
+  UINTN                       TaskCount;
+  PAGE_TABLE_MAP_TASK_DATA    Task[PAGE_TABLE_MAP_MAX_TASKS];
+} PAGE_TABLE_MAP_BATCH;
+
+/**
+  Compare two map requests by linear address.
+
+  @param[in] Buffer1  The first IA32_MAP_REQUEST.
+  @param[in] Buffer2  The second IA32_MAP_REQUEST.
+
+  @retval <0  Buffer1 starts below Buffer2.
+  @retval 0   Buffer1 and Buffer2 start at the same linear address.
+  @retval >0  Buffer1 starts above Buffer2.
+**/
+INTN
+EFIAPI
+PageTableLibCompareRequest (
+  IN CONST VOID  *Buffer1,
+  IN CONST VOID  *Buffer2
+  )
+{
+  CONST IA32_MAP_REQUEST  *Request1;
+  CONST IA32_MAP_REQUEST  *Request2;
+
+  Request1 = Buffer1;
+  Request2 = Buffer2;
+  if (Request1->LinearAddress < Request2->LinearAddress) {
+    return -1;
+  }
+
+  return (Request1->LinearAddress > Request2->LinearAddress) ? 1 : 0;
+}
+
+/**
+  Sort the requests by linear address, drop the empty ones and merge the adjacent requests
+  that continue each other with the same attribute and mask.
+
+  @param[in, out] Requests      The requests.
+  @param[in, out] RequestCount  On input, the number of requests. On output, the number of requests after merging.
+
+  @retval RETURN_INVALID_PARAMETER  Two requests overlap.
+  @retval RETURN_SUCCESS            The requests are sorted and merged.
+**/
+RETURN_STATUS
+PageTableLibSortAndMergeRequests (
+  IN OUT IA32_MAP_REQUEST  *Requests,
+  IN OUT UINTN             *RequestCount
+  )
+{
+  IA32_MAP_REQUEST  Swap;
+  IA32_MAP_REQUEST  *Last;
+  UINT64            LastEnd;
+  UINTN             Index;
+  UINTN             Count;
+
+  QuickSort (Requests, *RequestCount, sizeof (IA32_MAP_REQUEST), PageTableLibCompareRequest, &Swap);
+
+  LastEnd = 0;
+  for (Index = 0; Index < *RequestCount; Index++) {
+    if (Requests[Index].Length == 0) {
+      continue;
+    }
+
+    if (Requests[Index].LinearAddress < LastEnd) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    LastEnd = Requests[Index].LinearAddress + Requests[Index].Length;
+  }
+
+  Count = 0;
+  for (Index = 0; Index < *RequestCount; Index++) {
+    if (Requests[Index].Length == 0) {
+      continue;
+    }
+
+    if (Count != 0) {
+      Last = &Requests[Count - 1];
+      if ((Requests[Index].LinearAddress == Last->LinearAddress + Last->Length) &&
+          (Requests[Index].Mask.Uint64 == Last->Mask.Uint64) &&
+          (IA32_MAP_ATTRIBUTE_ATTRIBUTES (&Requests[Index].Attribute) == IA32_MAP_ATTRIBUTE_ATTRIBUTES (&Last->Attribute)) &&
+          (IA32_MAP_ATTRIBUTE_PAGE_TABLE_BASE_ADDRESS (&Requests[Index].Attribute) ==
+           IA32_MAP_ATTRIBUTE_PAGE_TABLE_BASE_ADDRESS (&Last->Attribute) + Last->Length))
+      {
+        Last->Length += Requests[Index].Length;
+        continue;
+      }
+    }
+
+    if (Count != Index) {
+      CopyMem (&Requests[Count], &Requests[Index], sizeof (IA32_MAP_REQUEST));
+    }
+
+    Count++;
+  }
+
+  *RequestCount = Count;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Loosen the inheritable attributes of a present non-leaf entry above the 1GB entries
+  that conflict with the request, and let the child entries take the parent attributes,
+  the same way PageTableLibMapInLevel () does it.
+
+  @param[in]      PagingEntry  The non-leaf entry.
+  @param[in]      Level        The level of the entry. Could be 5 or 4.
+  @param[in]      Request      The request.
+  @param[in, out] IsModified   Set to TRUE if the page table is modified.
+**/
+VOID
+PageTableLibLoosenUpperEntry (
+  IN     IA32_PAGING_ENTRY  *PagingEntry,
+  IN     IA32_PAGE_LEVEL    Level,
+  IN     IA32_MAP_REQUEST   *Request,
+  IN OUT BOOLEAN            *IsModified
+  )
+{
+  IA32_MAP_ATTRIBUTE  ChildAttribute;
+  IA32_MAP_ATTRIBUTE  ChildMask;
+  IA32_PAGING_ENTRY   *ChildPagingEntry;
+  UINTN               Index;
+
+  ChildAttribute.Uint64 = 0;
+  ChildMask.Uint64      = 0;
+
+  if ((PagingEntry->Pnle.Bits.ReadWrite == 0) && (Request->Mask.Bits.ReadWrite == 1) && (Request->Attribute.Bits.ReadWrite == 1)) {
+    PagingEntry->Pnle.Bits.ReadWrite = 1;
+    ChildAttribute.Bits.ReadWrite    = 0;
+    ChildMask.Bits.ReadWrite         = 1;
+  }
+
+  if ((PagingEntry->Pnle.Bits.UserSupervisor == 0) && (Request->Mask.Bits.UserSupervisor == 1) && (Request->Attribute.Bits.UserSupervisor == 1)) {
+    PagingEntry->Pnle.Bits.UserSupervisor = 1;
+    ChildAttribute.Bits.UserSupervisor    = 0;
+    ChildMask.Bits.UserSupervisor         = 1;
+  }
+
+  if ((PagingEntry->Pnle.Bits.Nx == 1) && (Request->Mask.Bits.Nx == 1) && (Request->Attribute.Bits.Nx == 0)) {
+    PagingEntry->Pnle.Bits.Nx = 0;
+    ChildAttribute.Bits.Nx    = 1;
+    ChildMask.Bits.Nx         = 1;
+  }
+
+  if (ChildMask.Uint64 == 0) {
+    return;
+  }
+
+  ChildPagingEntry = (IA32_PAGING_ENTRY *)(UINTN)IA32_PNLE_PAGE_TABLE_BASE_ADDRESS (&PagingEntry->Pnle);
+  for (Index = 0; Index < 512; Index++) {
+    if (ChildPagingEntry[Index].Pce.Present == 0) {
+      continue;
+    }
+
+    if (IsPle (&ChildPagingEntry[Index], Level - 1)) {
+      PageTableLibSetPle (Level - 1, &ChildPagingEntry[Index], 0, &ChildAttribute, &ChildMask);
+    } else {
+      PageTableLibSetPnle (&ChildPagingEntry[Index].Pnle, &ChildAttribute, &ChildMask);
+    }
+  }
+
+  *IsModified = TRUE;
+}
+
+/**
+  Create and update the entries above the 1GB entries that map a linear address for a request.
+
+  When sizing, the tables that would be created are counted once, using CreatedKey to remember
+  the tables already counted for the previous requests.
+
+  @param[in]      Batch          The batch.
+  @param[in]      Request        The request.
+  @param[in]      LinearAddress  A linear address of the request.
+  @param[in, out] BufferSize     The end of the free buffer when mapping, or the negated size needed when sizing.
+  @param[in, out] CreatedKey     The key of the last table counted per level, when sizing.
+  @param[in, out] IsModified     Set to TRUE if the page table is modified.
+
+  @retval RETURN_INVALID_PARAMETER  The attribute and mask of the request are invalid for a non-present range.
+  @retval RETURN_SUCCESS            The entries are created and updated.
+**/
+RETURN_STATUS
+PageTableLibPrepareUpperLevels (
+  IN     PAGE_TABLE_MAP_BATCH  *Batch,
+  IN     IA32_MAP_REQUEST      *Request,
+  IN     UINT64                LinearAddress,
+  IN OUT INTN                  *BufferSize,
+  IN OUT UINT64                *CreatedKey,
+  IN OUT BOOLEAN               *IsModified
+  )
+{
+  RETURN_STATUS       Status;
+  IA32_PAGING_ENTRY   *PagingEntry;
+  IA32_PAGING_ENTRY   *NewPagingEntry;
+  IA32_PAGING_ENTRY   TempPagingEntry;
+  IA32_MAP_ATTRIBUTE  NopAttribute;
+  IA32_MAP_ATTRIBUTE  AllOneMask;
+  UINTN               Level;
+  UINT64              Key;
+
+  AllOneMask.Uint64 = ~0ull;
+
+  NopAttribute.Uint64              = 0;
+  NopAttribute.Bits.Present        = 1;
+  NopAttribute.Bits.ReadWrite      = 1;
+  NopAttribute.Bits.UserSupervisor = 1;
+
+  //
+  // PagingEntry is the entry of level Level that maps LinearAddress, or NULL when it is in a
+  // table that is only counted when sizing. The top level entry is CR3.
+  //
+  PagingEntry = Batch->TopPagingEntry;
+  for (Level = Batch->MaxLevel + 1; ; Level--) {
+    if ((PagingEntry == NULL) || (PagingEntry->Pce.Present == 0)) {
+      Status = IsAttributesAndMaskValidForNonPresentEntry (&Request->Attribute, &Request->Mask);
+      if (RETURN_ERROR (Status)) {
+        return Status;
+      }
+
+      if (!PAGE_TABLE_MAP_NEEDS_TABLE (Request)) {
+        return RETURN_SUCCESS;
+      }
+
+      if (!Batch->Modify) {
+        Key = RShiftU64 (LinearAddress, 12 + (Level - 1) * 9);
+        if (CreatedKey[Level] != Key) {
+          CreatedKey[Level] = Key;
+          *BufferSize      -= SIZE_4KB;
+        }
+
+        PagingEntry = NULL;
+      } else {
+        *BufferSize   -= SIZE_4KB;
+        NewPagingEntry = (IA32_PAGING_ENTRY *)((UINTN)Batch->Buffer + *BufferSize);
+        ZeroMem (NewPagingEntry, SIZE_4KB);
+
+        TempPagingEntry.Uint64 = PagingEntry->Uint64;
+        PageTableLibSetPnle (&TempPagingEntry.Pnle, &NopAttribute, &AllOneMask);
+        TempPagingEntry.Uint64                     = ((UINTN)(VOID *)NewPagingEntry) | (TempPagingEntry.Uint64 & (~IA32_PE_BASE_ADDRESS_MASK_40));
+        *(volatile UINT64 *)&(PagingEntry->Uint64) = TempPagingEntry.Uint64;
+        *IsModified                                = TRUE;
+      }
+    } else if (Batch->Modify && (Level <= Batch->MaxLevel)) {
+      PageTableLibLoosenUpperEntry (PagingEntry, (IA32_PAGE_LEVEL)Level, Request, IsModified);
+    }
+
+    if (Level == Pdpte + 1) {
+      return RETURN_SUCCESS;
+    }
+
+    if (PagingEntry != NULL) {
+      PagingEntry  = (IA32_PAGING_ENTRY *)(UINTN)IA32_PNLE_PAGE_TABLE_BASE_ADDRESS (&PagingEntry->Pnle);
+      PagingEntry += (UINTN)BitFieldRead64 (LinearAddress, 12 + (Level - 2) * 9, 12 + (Level - 1) * 9 - 1);
+    }
+  }
+}
+
+/**
+  Return the entry that references the page directory pointer table mapping a linear address.
+
+  @param[in]  Batch            The batch.
+  @param[in]  LinearAddress    The linear address.
+  @param[out] ParentAttribute  The accumulated attribute of the entries above the returned entry.
+
+  @return The PML4 entry, or CR3 in PAE paging, or NULL if an entry above it is not present.
+**/
+IA32_PAGING_ENTRY *
+PageTableLibGetPdptParent (
+  IN  PAGE_TABLE_MAP_BATCH  *Batch,
+  IN  UINT64                LinearAddress,
+  OUT IA32_MAP_ATTRIBUTE    *ParentAttribute
+  )
+{
+  IA32_PAGING_ENTRY  *PagingEntry;
+  UINTN              Level;
+
+  ParentAttribute->Uint64                       = 0;
+  ParentAttribute->Bits.PageTableBaseAddressLow = 1;
+  ParentAttribute->Bits.Present                 = 1;
+  ParentAttribute->Bits.ReadWrite               = 1;
+  ParentAttribute->Bits.UserSupervisor          = 1;
+  ParentAttribute->Bits.Nx                      = 0;
+
+  PagingEntry = Batch->TopPagingEntry;
+  for (Level = Batch->MaxLevel + 1; Level > Pdpte + 1; Level--) {
+    if (PagingEntry->Pce.Present == 0) {
+      return NULL;
+    }
+
+    ParentAttribute->Uint64 = PageTableLibGetPnleMapAttribute (&PagingEntry->Pnle, ParentAttribute);
+    PagingEntry             = (IA32_PAGING_ENTRY *)(UINTN)IA32_PNLE_PAGE_TABLE_BASE_ADDRESS (&PagingEntry->Pnle);
+    PagingEntry            += (UINTN)BitFieldRead64 (LinearAddress, 12 + (Level - 2) * 9, 12 + (Level - 1) * 9 - 1);
+  }
+
+  return PagingEntry;
+}
+
+/**
+  Map, or size when Batch->Modify is FALSE, the part of the requests that belongs to a task.
+
+  The entries above the 1GB entries must have been prepared by PageTableLibPrepareUpperLevels (),
+  so only the PDPTEs in [Task->Start, Task->End) and the subtrees below them are updated.
+
+  @param[in]      Batch  The batch.
+  @param[in, out] Task   The task.
+
+  @retval RETURN_INVALID_PARAMETER  The attribute and mask of a request are invalid for a non-present range.
+  @retval RETURN_SUCCESS            The part of the requests is mapped or sized.
+**/
+RETURN_STATUS
+PageTableLibMapTaskRequests (
+  IN     PAGE_TABLE_MAP_BATCH      *Batch,
+  IN OUT PAGE_TABLE_MAP_TASK_DATA  *Task
+  )
+{
+  RETURN_STATUS       Status;
+  IA32_MAP_REQUEST    *Request;
+  IA32_PAGING_ENTRY   *ParentPagingEntry;
+  IA32_PAGING_ENTRY   ZeroPagingEntry;
+  IA32_MAP_ATTRIBUTE  ParentAttribute;
+  UINT64              Start;
+  UINT64              End;
+  UINT64              PieceEnd;
+  UINTN               Index;
+
+  for (Index = 0; Index < Batch->RequestCount; Index++) {
+    Request = &Batch->Requests[Index];
+    if (Request->LinearAddress >= Task->End) {
+      break;
+    }
+
+    Start = MAX (Request->LinearAddress, Task->Start);
+    End   = MIN (Request->LinearAddress + Request->Length, Task->End);
+    while (Start < End) {
+      //
+      // Each piece is mapped by one PML4 entry.
+      //
+      PieceEnd          = MIN (End, (Start & ~(REGION_LENGTH (Pml4) - 1)) + REGION_LENGTH (Pml4));
+      ParentPagingEntry = PageTableLibGetPdptParent (Batch, Start, &ParentAttribute);
+      if (!Batch->Modify && ((ParentPagingEntry == NULL) || (ParentPagingEntry->Pce.Present == 0))) {
+        //
+        // The page directory pointer table is created by PageTableLibPrepareUpperLevels (), which
+        // already counted it. Size the piece under an empty table.
+        //
+        ZeroPagingEntry.Uint64 = 0;
+        Status                 = PageTableLibMapInLevel (
+                                   &ZeroPagingEntry,
+                                   &ParentAttribute,
+                                   FALSE,
+                                   NULL,
+                                   &Task->BufferSize,
+                                   Pdpte,
+                                   Batch->MaxLeafLevel,
+                                   Request->LinearAddress,
+                                   PieceEnd - Request->LinearAddress,
+                                   Start - Request->LinearAddress,
+                                   &Request->Attribute,
+                                   &Request->Mask,
+                                   &Task->IsModified
+                                   );
+        if (!RETURN_ERROR (Status) && PAGE_TABLE_MAP_NEEDS_TABLE (Request)) {
+          Task->BufferSize += SIZE_4KB;
+        }
+      } else if (ParentPagingEntry != NULL) {
+        Status = PageTableLibMapInLevel (
+                   ParentPagingEntry,
+                   &ParentAttribute,
+                   Batch->Modify,
+                   Batch->Buffer,
+                   &Task->BufferSize,
+                   Pdpte,
+                   Batch->MaxLeafLevel,
+                   Request->LinearAddress,
+                   PieceEnd - Request->LinearAddress,
+                   Start - Request->LinearAddress,
+                   &Request->Attribute,
+                   &Request->Mask,
+                   &Task->IsModified
+                   );
+      } else {
+        //
+        // Nothing is mapped as present under a non-present upper entry.
+        //
+        Status = RETURN_SUCCESS;
+      }
+
+      if (RETURN_ERROR (Status)) {
+        return Status;
+      }
+
+      Start = PieceEnd;
+    }
+  }
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Map the part of the requests that belongs to a task.
+
+  @param[in] TaskContext  The batch.
+  @param[in] TaskIndex    The index of the task to run.
+**/
+VOID
+EFIAPI
+PageTableLibMapTask (
+  IN VOID   *TaskContext,
+  IN UINTN  TaskIndex
+  )
+{
+  PAGE_TABLE_MAP_BATCH  *Batch;
+
+  Batch = (PAGE_TABLE_MAP_BATCH *)TaskContext;
+  ASSERT (TaskIndex < Batch->TaskCount);
+  Batch->Task[TaskIndex].Status = PageTableLibMapTaskRequests (Batch, &Batch->Task[TaskIndex]);
+}
+
+/**
+  Split the 1GB regions touched by the requests into tasks of about the same mapped length.
+
+  @param[in, out] Batch     The batch.
+  @param[in]      Parallel  TRUE to split the requests in several tasks.
+**/
+VOID
+PageTableLibSplitTasks (
+  IN OUT PAGE_TABLE_MAP_BATCH  *Batch,
+  IN     BOOLEAN               Parallel
+  )
+{
+  IA32_MAP_REQUEST  *Requests;
+  UINT64            Total;
+  UINT64            Regions;
+  UINT64            Done;
+  UINT64            Target;
+  UINT64            Boundary;
+  UINTN             Index;
+  UINTN             TaskIndex;
+
+  Requests = Batch->Requests;
+  Total    = 0;
+  Regions  = 0;
+  for (Index = 0; Index < Batch->RequestCount; Index++) {
+    Total   += Requests[Index].Length;
+    Regions += RShiftU64 (Requests[Index].LinearAddress + Requests[Index].Length - 1, 30) - RShiftU64 (Requests[Index].LinearAddress, 30) + 1;
+  }
+
+  Batch->TaskCount = Parallel ? (UINTN)MIN (Regions, PAGE_TABLE_MAP_MAX_TASKS) : 1;
+
+  Batch->Task[0].Start                  = 0;
+  Batch->Task[Batch->TaskCount - 1].End = MAX_UINT64;
+  Index                                 = 0;
+  Done                                  = 0;
+  for (TaskIndex = 1; TaskIndex < Batch->TaskCount; TaskIndex++) {
+    Target = DivU64x32 (MultU64x32 (Total, (UINT32)TaskIndex), (UINT32)Batch->TaskCount);
+    while (Done + Requests[Index].Length <= Target) {
+      Done += Requests[Index].Length;
+      Index++;
+    }
+
+    Boundary                       = ALIGN_VALUE (Requests[Index].LinearAddress + (Target - Done), SIZE_1GB);
+    Boundary                       = MAX (Boundary, Batch->Task[TaskIndex - 1].Start);
+    Batch->Task[TaskIndex - 1].End = Boundary;
+    Batch->Task[TaskIndex].Start   = Boundary;
+  }
+}
+
+/**
+  Create or update page table to map several linear address ranges, each with its own attribute.
+
+  The requests are sorted by linear address and the adjacent requests that continue each other
+  with the same attribute and mask are merged. The paging structures above the 1GB entries are
+  then updated on the calling processor, and the 1GB regions are split into tasks that populate
+  independent subtrees. When RunTasks is not NULL, it runs the tasks, possibly in parallel.
+
+  The requests must not overlap. The resulting mappings are the same as the ones of calling
+  PageTableMap () for each request in turn.
+
+  @param[in, out] PageTable        The pointer to the page table to update, or pointer to NULL if a new page table is to be created.
+                                   If not pointer to NULL, the value it points to won't be changed in this function.
+  @param[in]      PagingMode       The paging mode.
+  @param[in]      Buffer           The free buffer to be used for page table creation/updating.
+  @param[in, out] BufferSize       The buffer size.
+                                   On return, the remaining buffer size. The free buffer is used from the end.
+                                   The size needed may be larger than the total of the PageTableMap () calls because
+                                   the paging structures shared by requests are counted once per request, and when the
+                                   tasks run in parallel, the unused part of the buffer of each task but the last one is
+                                   not returned.
+  @param[in, out] Requests         The ranges to map. On return, they are sorted and merged.
+  @param[in, out] RequestCount     On input, the number of requests. On output, the number of requests after merging.
+  @param[in]      RunTasks         The function to run the tasks in parallel, or NULL to run them on the calling processor.
+  @param[in]      RunTasksContext  The context passed to RunTasks.
+  @param[out]     IsModified       TRUE means page table is modified by software or hardware. FALSE means page table is not modified by software.
+
+  @retval RETURN_UNSUPPORTED        PagingMode is not supported.
+  @retval RETURN_INVALID_PARAMETER  PageTable, BufferSize or RequestCount is NULL, or Requests is NULL and *RequestCount is not 0.
+  @retval RETURN_INVALID_PARAMETER  A request is invalid for PageTableMap (), or two requests overlap.
+                                    The page table is not modified.
+  @retval RETURN_INVALID_PARAMETER  *BufferSize is not multiple of 4KB.
+  @retval RETURN_BUFFER_TOO_SMALL   The buffer is too small for page table creation/updating.
+                                    BufferSize is updated to indicate the expected buffer size.
+  @retval RETURN_SUCCESS            PageTable is created/updated successfully or there is nothing to map.
+**/
+RETURN_STATUS
+EFIAPI
+PageTableMapBatch (
+  IN OUT UINTN                 *PageTable  OPTIONAL,
+  IN     PAGING_MODE           PagingMode,
+  IN     VOID                  *Buffer,
+  IN OUT UINTN                 *BufferSize,
+  IN OUT IA32_MAP_REQUEST      *Requests,
+  IN OUT UINTN                 *RequestCount,
+  IN     PAGE_TABLE_RUN_TASKS  RunTasks         OPTIONAL,
+  IN     VOID                  *RunTasksContext OPTIONAL,
+  OUT    BOOLEAN               *IsModified      OPTIONAL
+  )
+{
+  RETURN_STATUS         Status;
+  PAGE_TABLE_MAP_BATCH  Batch;
+  IA32_PAGING_ENTRY     TopPagingEntry;
+  IA32_PAGING_ENTRY     *PagingEntry;
+  IA32_MAP_REQUEST      *Request;
+  UINT64                MaxLinearAddress;
+  UINT64                Start;
+  UINT64                PieceEnd;
+  UINT64                CreatedKey[Pml5 + 2];
+  INTN                  RequiredSize;
+  INTN                  FreeEnd;
+  INTN                  TaskSize;
+  BOOLEAN               LocalIsModified;
+  UINTN                 Index;
+  UINTN                 Pass;
+  UINT8                 BufferInStack[SIZE_4KB - 1 + MAX_PAE_PDPTE_NUM * sizeof (IA32_PAGING_ENTRY)];
+
+  if ((PagingMode == Paging32bit) || (PagingMode >= PagingModeMax)) {
+    //
+    // 32bit paging is never supported.
+    //
+    return RETURN_UNSUPPORTED;
+  }
+
+  if ((PageTable == NULL) || (BufferSize == NULL) || (RequestCount == NULL) || ((Requests == NULL) && (*RequestCount != 0))) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  if (*BufferSize % SIZE_4KB != 0) {
+    //
+    // BufferSize should be multiple of 4K.
+    //
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  if ((*BufferSize != 0) && (Buffer == NULL)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Batch.MaxLeafLevel = (IA32_PAGE_LEVEL)(UINT8)PagingMode;
+  Batch.MaxLevel     = (IA32_PAGE_LEVEL)(UINT8)(PagingMode >> 8);
+  MaxLinearAddress   = (PagingMode == PagingPae) ? LShiftU64 (1, 32) : LShiftU64 (1, 12 + Batch.MaxLevel * 9);
+
+  //
+  // Check every request the same way as PageTableMap () before changing anything.
+  //
+  for (Index = 0; Index < *RequestCount; Index++) {
+    Request = &Requests[Index];
+    if (((UINTN)Request->LinearAddress % SIZE_4KB != 0) || ((UINTN)Request->Length % SIZE_4KB != 0)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    if ((Request->Attribute.Bits.Present == 0) && (Request->Mask.Bits.Present == 1) && (Request->Mask.Uint64 > 1)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    if ((Request->LinearAddress > MaxLinearAddress) || (Request->Length > MaxLinearAddress - Request->LinearAddress)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+  }
+
+  if (*RequestCount != 0) {
+    Status = PageTableLibSortAndMergeRequests (Requests, RequestCount);
+    if (RETURN_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  if (IsModified == NULL) {
+    IsModified = &LocalIsModified;
+  }
+
+  *IsModified = FALSE;
+
+  if (*RequestCount == 0) {
+    return RETURN_SUCCESS;
+  }
+
+  TopPagingEntry.Uintn = *PageTable;
+  if (TopPagingEntry.Uintn != 0) {
+    if (PagingMode == PagingPae) {
+      //
+      // Create 4 temporary PDPTE at a 4k-aligned address.
+      // Copy the original PDPTE content and set ReadWrite, UserSupervisor to 1, set Nx to 0.
+      //
+      TopPagingEntry.Uintn = ALIGN_VALUE ((UINTN)BufferInStack, BASE_4KB);
+      PagingEntry          = (IA32_PAGING_ENTRY *)(TopPagingEntry.Uintn);
+      CopyMem (PagingEntry, (VOID *)(*PageTable), MAX_PAE_PDPTE_NUM * sizeof (IA32_PAGING_ENTRY));
+      for (Index = 0; Index < MAX_PAE_PDPTE_NUM; Index++) {
+        PagingEntry[Index].Pnle.Bits.ReadWrite      = 1;
+        PagingEntry[Index].Pnle.Bits.UserSupervisor = 1;
+        PagingEntry[Index].Pnle.Bits.Nx             = 0;
+      }
+    }
+
+    TopPagingEntry.Pce.Present        = 1;
+    TopPagingEntry.Pce.ReadWrite      = 1;
+    TopPagingEntry.Pce.UserSupervisor = 1;
+    TopPagingEntry.Pce.Nx             = 0;
+  }
+
+  Batch.TopPagingEntry = &TopPagingEntry;
+  Batch.Buffer         = Buffer;
+  Batch.Requests       = Requests;
+  Batch.RequestCount   = *RequestCount;
+  PageTableLibSplitTasks (&Batch, (BOOLEAN)(RunTasks != NULL));
+
+  //
+  // The first pass queries the required buffer size without modifying the page table.
+  // The second pass prepares the shared upper levels, then runs the tasks.
+  //
+  RequiredSize = 0;
+  FreeEnd      = (INTN)*BufferSize;
+  for (Pass = 0; Pass < 2; Pass++) {
+    Batch.Modify = (BOOLEAN)(Pass == 1);
+    SetMem64 (CreatedKey, sizeof (CreatedKey), MAX_UINT64);
+    for (Index = 0; Index < Batch.RequestCount; Index++) {
+      Request = &Requests[Index];
+      for (Start = Request->LinearAddress; Start < Request->LinearAddress + Request->Length; Start = PieceEnd) {
+        PieceEnd = MIN (Request->LinearAddress + Request->Length, (Start & ~(REGION_LENGTH (Pml4) - 1)) + REGION_LENGTH (Pml4));
+        Status   = PageTableLibPrepareUpperLevels (
+                     &Batch,
+                     Request,
+                     Start,
+                     Batch.Modify ? &FreeEnd : &RequiredSize,
+                     CreatedKey,
+                     IsModified
+                     );
+        if (RETURN_ERROR (Status)) {
+          ASSERT (!Batch.Modify);
+          return Status;
+        }
+      }
+    }
+
+    if (!Batch.Modify) {
+      for (Index = 0; Index < Batch.TaskCount; Index++) {
+        Batch.Task[Index].BufferSize = 0;
+        Batch.Task[Index].IsModified = FALSE;
+        Status                       = PageTableLibMapTaskRequests (&Batch, &Batch.Task[Index]);
+        if (RETURN_ERROR (Status)) {
+          return Status;
+        }
+
+        ASSERT (Batch.Task[Index].IsModified == FALSE);
+        RequiredSize += Batch.Task[Index].BufferSize;
+      }
+
+      RequiredSize = -RequiredSize;
+      if ((UINTN)RequiredSize > *BufferSize) {
+        *BufferSize = RequiredSize;
+        return RETURN_BUFFER_TOO_SMALL;
+      }
+
+      if ((RequiredSize != 0) && (Buffer == NULL)) {
+        return RETURN_INVALID_PARAMETER;
+      }
+    }
+  }
+
+  //
+  // Give each task its own part of the buffer, below the part used by the upper levels.
+  //
+  for (Index = 0; Index < Batch.TaskCount; Index++) {
+    TaskSize                     = -Batch.Task[Index].BufferSize;
+    Batch.Task[Index].BufferSize = FreeEnd;
+    Batch.Task[Index].Status     = RETURN_SUCCESS;
+    FreeEnd                     -= TaskSize;
+  }
+
+  if ((RunTasks != NULL) && (Batch.TaskCount > 1)) {
+    RunTasks (RunTasksContext, PageTableLibMapTask, &Batch, Batch.TaskCount);
+  } else {
+    for (Index = 0; Index < Batch.TaskCount; Index++) {
+      PageTableLibMapTask (&Batch, Index);
+    }
+  }
+
+  Status = RETURN_SUCCESS;
+  for (Index = 0; Index < Batch.TaskCount; Index++) {
+    if (RETURN_ERROR (Batch.Task[Index].Status) && !RETURN_ERROR (Status)) {
+      Status = Batch.Task[Index].Status;
+    }
+
+    if (Batch.Task[Index].IsModified) {
+      *IsModified = TRUE;
+    }
+  }
+
+  //
+  // The free buffer left is the one below the used part of the last task.
+  //
+  *BufferSize = (UINTN)Batch.Task[Batch.TaskCount - 1].BufferSize;
+
+  if (!RETURN_ERROR (Status) && (TopPagingEntry.Pce.Present == 1)) {
+    PagingEntry = (IA32_PAGING_ENTRY *)(UINTN)(TopPagingEntry.Uintn & IA32_PE_BASE_ADDRESS_MASK_40);
+
+    if (PagingMode == PagingPae) {
+      //
+      // These MustBeZero fields are treated as RW and other attributes by the common map logic. So they might be set to 1.
+      //
+      for (Index = 0; Index < MAX_PAE_PDPTE_NUM; Index++) {
+        PagingEntry[Index].PdptePae.Bits.MustBeZero  = 0;
+        PagingEntry[Index].PdptePae.Bits.MustBeZero2 = 0;
+        PagingEntry[Index].PdptePae.Bits.MustBeZero3 = 0;
+      }
+
+      if (*PageTable != 0) {
+        //
+        // Copy temp PDPTE to original PDPTE.
+        //
+        CopyMem ((VOID *)(*PageTable), PagingEntry, MAX_PAE_PDPTE_NUM * sizeof (IA32_PAGING_ENTRY));
+      }
+    }
+
+    if (*PageTable == 0) {
+      //
+      // Do not assign the *PageTable when it's an existing page table.
+      // If it's an existing PAE page table, PagingEntry is the temp buffer in stack.
+      //
+      *PageTable = (UINTN)PagingEntry;
+    }
+  }
+
+  return Status;
+}
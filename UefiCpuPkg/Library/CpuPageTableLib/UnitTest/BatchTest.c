@@ -0,0 +1,591 @@
+/** @file
+  Batch test cases for Unit tests of the CpuPageTableLib instance of the CpuPageTableLib class
+
+  PageTableMapBatch () is checked against PageTableMap () called for each request in turn:
+  both must produce the same mappings.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "CpuPageTableLibUnitTest.h"
+
+#define BATCH_TEST_REQUESTS_PER_CLUSTER  150
+#define BATCH_TEST_MAX_CLUSTERS          4
+#define BATCH_TEST_MAX_REQUESTS          (BATCH_TEST_REQUESTS_PER_CLUSTER * BATCH_TEST_MAX_CLUSTERS)
+#define BATCH_TEST_BENCHMARK_LENGTH      SIZE_4GB
+#define BATCH_TEST_BENCHMARK_CHUNK       SIZE_2MB
+
+typedef struct {
+  UINT64    Base;
+  UINT64    Limit;
+} BATCH_TEST_CLUSTER;
+
+STATIC UINT32  mBatchTestSeed;
+
+/**
+  Return a pseudo random number.
+
+  @return A pseudo random number.
+**/
+STATIC
+UINT32
+BatchTestRandom (
+  VOID
+  )
+{
+  mBatchTestSeed = mBatchTestSeed * 1103515245 + 12345;
+  return mBatchTestSeed >> 8;
+}
+
+/**
+  Run the tasks of PageTableMapBatch () in reverse order, to check they don't depend on each other.
+
+  @param[in] Context      Pointer to the number of tasks run.
+  @param[in] Task         The task function.
+  @param[in] TaskContext  The context to pass to the task function.
+  @param[in] TaskCount    The number of tasks.
+**/
+VOID
+EFIAPI
+BatchTestRunTasksReversed (
+  IN VOID                 *Context,
+  IN PAGE_TABLE_MAP_TASK  Task,
+  IN VOID                 *TaskContext,
+  IN UINTN                TaskCount
+  )
+{
+  UINTN  Index;
+
+  for (Index = TaskCount; Index > 0; Index--) {
+    Task (TaskContext, Index - 1);
+  }
+
+  *(UINTN *)Context += TaskCount;
+}
+
+/**
+  Map the requests with one PageTableMap () call per request.
+
+  @param[in, out] PageTable     The page table.
+  @param[in]      PagingMode    The paging mode.
+  @param[in]      Requests      The requests.
+  @param[in]      RequestCount  The number of requests.
+
+  @retval RETURN_SUCCESS  The requests are mapped.
+  @retval Others          PageTableMap () failed.
+**/
+RETURN_STATUS
+BatchTestMapSequential (
+  IN OUT UINTN             *PageTable,
+  IN     PAGING_MODE       PagingMode,
+  IN     IA32_MAP_REQUEST  *Requests,
+  IN     UINTN             RequestCount
+  )
+{
+  RETURN_STATUS  Status;
+  VOID           *Buffer;
+  UINTN          BufferSize;
+  UINTN          Index;
+
+  for (Index = 0; Index < RequestCount; Index++) {
+    BufferSize = 0;
+    Status     = PageTableMap (
+                   PageTable,
+                   PagingMode,
+                   NULL,
+                   &BufferSize,
+                   Requests[Index].LinearAddress,
+                   Requests[Index].Length,
+                   &Requests[Index].Attribute,
+                   &Requests[Index].Mask,
+                   NULL
+                   );
+    if (Status == RETURN_BUFFER_TOO_SMALL) {
+      Buffer = AllocatePages (EFI_SIZE_TO_PAGES (BufferSize));
+      Status = PageTableMap (
+                 PageTable,
+                 PagingMode,
+                 Buffer,
+                 &BufferSize,
+                 Requests[Index].LinearAddress,
+                 Requests[Index].Length,
+                 &Requests[Index].Attribute,
+                 &Requests[Index].Mask,
+                 NULL
+                 );
+    }
+
+    if (RETURN_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Map the requests with PageTableMapBatch ().
+
+  @param[in, out] PageTable     The page table.
+  @param[in]      PagingMode    The paging mode.
+  @param[in]      Requests      The requests. They are copied, so they are not sorted.
+  @param[in]      RequestCount  The number of requests.
+  @param[in]      RunTasks      The function to run the tasks, or NULL.
+  @param[in]      TasksRun      Incremented by the number of tasks run by RunTasks.
+
+  @retval RETURN_SUCCESS  The requests are mapped.
+  @retval Others          PageTableMapBatch () failed.
+**/
+RETURN_STATUS
+BatchTestMapBatch (
+  IN OUT UINTN                 *PageTable,
+  IN     PAGING_MODE           PagingMode,
+  IN     IA32_MAP_REQUEST      *Requests,
+  IN     UINTN                 RequestCount,
+  IN     PAGE_TABLE_RUN_TASKS  RunTasks  OPTIONAL,
+  IN OUT UINTN                 *TasksRun
+  )
+{
+  RETURN_STATUS     Status;
+  IA32_MAP_REQUEST  *Copy;
+  UINTN             Count;
+  VOID              *Buffer;
+  UINTN             BufferSize;
+
+  Copy = AllocateCopyPool (RequestCount * sizeof (IA32_MAP_REQUEST), Requests);
+  if (Copy == NULL) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  Count      = RequestCount;
+  BufferSize = 0;
+  Status     = PageTableMapBatch (PageTable, PagingMode, NULL, &BufferSize, Copy, &Count, RunTasks, TasksRun, NULL);
+  if (Status == RETURN_BUFFER_TOO_SMALL) {
+    Buffer = AllocatePages (EFI_SIZE_TO_PAGES (BufferSize));
+    Status = PageTableMapBatch (PageTable, PagingMode, Buffer, &BufferSize, Copy, &Count, RunTasks, TasksRun, NULL);
+  }
+
+  FreePool (Copy);
+  return Status;
+}
+
+/**
+  Check that two page tables have the same mappings.
+
+  @param[in] PageTable1  The first page table.
+  @param[in] PageTable2  The second page table.
+  @param[in] PagingMode  The paging mode.
+
+  @retval  UNIT_TEST_PASSED             The mappings are the same.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  The mappings are different.
+**/
+UNIT_TEST_STATUS
+BatchTestCompareMappings (
+  IN UINTN        PageTable1,
+  IN UINTN        PageTable2,
+  IN PAGING_MODE  PagingMode
+  )
+{
+  IA32_MAP_ENTRY  *Map1;
+  IA32_MAP_ENTRY  *Map2;
+  UINTN           MapCount1;
+  UINTN           MapCount2;
+
+  MapCount1 = 0;
+  MapCount2 = 0;
+  UT_ASSERT_EQUAL (PageTableParse (PageTable1, PagingMode, NULL, &MapCount1), (PageTable1 == 0) ? RETURN_SUCCESS : RETURN_BUFFER_TOO_SMALL);
+  UT_ASSERT_EQUAL (PageTableParse (PageTable2, PagingMode, NULL, &MapCount2), (PageTable2 == 0) ? RETURN_SUCCESS : RETURN_BUFFER_TOO_SMALL);
+  UT_ASSERT_EQUAL (MapCount1, MapCount2);
+  if (MapCount1 == 0) {
+    return UNIT_TEST_PASSED;
+  }
+
+  Map1 = AllocatePages (EFI_SIZE_TO_PAGES (MapCount1 * sizeof (IA32_MAP_ENTRY)));
+  Map2 = AllocatePages (EFI_SIZE_TO_PAGES (MapCount2 * sizeof (IA32_MAP_ENTRY)));
+  UT_ASSERT_NOT_NULL (Map1);
+  UT_ASSERT_NOT_NULL (Map2);
+  UT_ASSERT_NOT_EFI_ERROR (PageTableParse (PageTable1, PagingMode, Map1, &MapCount1));
+  UT_ASSERT_NOT_EFI_ERROR (PageTableParse (PageTable2, PagingMode, Map2, &MapCount2));
+  UT_ASSERT_MEM_EQUAL (Map1, Map2, MapCount1 * sizeof (IA32_MAP_ENTRY));
+
+  FreePages (Map1, EFI_SIZE_TO_PAGES (MapCount1 * sizeof (IA32_MAP_ENTRY)));
+  FreePages (Map2, EFI_SIZE_TO_PAGES (MapCount2 * sizeof (IA32_MAP_ENTRY)));
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Generate random non-overlapping requests in a few clusters of the linear address space,
+  in a random order.
+
+  @param[in]  PagingMode  The paging mode.
+  @param[out] Requests    The requests, BATCH_TEST_MAX_REQUESTS at most.
+
+  @return The number of requests.
+**/
+UINTN
+BatchTestGenerateRequests (
+  IN  PAGING_MODE       PagingMode,
+  OUT IA32_MAP_REQUEST  *Requests
+  )
+{
+  BATCH_TEST_CLUSTER  Clusters[BATCH_TEST_MAX_CLUSTERS];
+  IA32_MAP_REQUEST    Swap;
+  UINTN               ClusterCount;
+  UINTN               ClusterIndex;
+  UINTN               Count;
+  UINTN               Index;
+  UINTN               Other;
+  UINT64              Address;
+  UINT64              Length;
+  UINT32              Kind;
+
+  //
+  // Clusters cross the 1GB, 512GB (PML4) and 256TB (PML5) boundaries.
+  //
+  ClusterCount = 0;
+  if (PagingMode == PagingPae) {
+    Clusters[ClusterCount].Base  = SIZE_1GB - SIZE_512MB;
+    Clusters[ClusterCount].Limit = SIZE_2GB;
+    ClusterCount++;
+    Clusters[ClusterCount].Base  = SIZE_2GB + SIZE_1GB - SIZE_512MB;
+    Clusters[ClusterCount].Limit = SIZE_4GB;
+    ClusterCount++;
+  } else {
+    Clusters[ClusterCount].Base  = 0;
+    Clusters[ClusterCount].Limit = SIZE_4GB;
+    ClusterCount++;
+    Clusters[ClusterCount].Base  = SIZE_512GB - SIZE_2GB;
+    Clusters[ClusterCount].Limit = SIZE_512GB + SIZE_2GB;
+    ClusterCount++;
+    if ((PagingMode >> 8) == 5) {
+      Clusters[ClusterCount].Base  = SIZE_256TB - SIZE_2GB;
+      Clusters[ClusterCount].Limit = SIZE_256TB + SIZE_2GB;
+      ClusterCount++;
+    }
+  }
+
+  Count = 0;
+  for (ClusterIndex = 0; ClusterIndex < ClusterCount; ClusterIndex++) {
+    Address = Clusters[ClusterIndex].Base;
+    for (Index = 0; Index < BATCH_TEST_REQUESTS_PER_CLUSTER; Index++) {
+      //
+      // Leave a gap of 0 to 3 pages, then map 4KB to 64KB, 2MB to 8MB or 1GB.
+      //
+      Address += SIZE_4KB * (BatchTestRandom () % 4);
+      Kind     = BatchTestRandom () % 16;
+      if (Kind == 0) {
+        Address = ALIGN_VALUE (Address, SIZE_1GB);
+        Length  = SIZE_1GB;
+      } else if (Kind < 6) {
+        Length = SIZE_2MB * (1 + BatchTestRandom () % 4);
+      } else {
+        Length = SIZE_4KB * (1 + BatchTestRandom () % 16);
+      }
+
+      if (Address + Length > Clusters[ClusterIndex].Limit) {
+        break;
+      }
+
+      ZeroMem (&Requests[Count], sizeof (IA32_MAP_REQUEST));
+      Requests[Count].LinearAddress = Address;
+      Requests[Count].Length        = Length;
+      if (BatchTestRandom () % 8 == 0) {
+        //
+        // Map as non-present.
+        //
+        Requests[Count].Mask.Bits.Present = 1;
+      } else {
+        //
+        // Remapped ranges keep the offset of the linear address in 1GB, as the result of
+        // PageTableMap () on a split big page otherwise depends on the order of the calls.
+        //
+        Requests[Count].Attribute.Uint64         = Address + ((BatchTestRandom () % 4 == 0) ? SIZE_1GB : 0);
+        Requests[Count].Attribute.Bits.Present   = 1;
+        Requests[Count].Attribute.Bits.ReadWrite = BatchTestRandom () & 1;
+        Requests[Count].Attribute.Bits.Nx        = BatchTestRandom () & 1;
+        Requests[Count].Mask.Uint64              = MAX_UINT64;
+      }
+
+      Address += Length;
+      Count++;
+    }
+  }
+
+  for (Index = Count; Index > 1; Index--) {
+    Other = BatchTestRandom () % Index;
+    CopyMem (&Swap, &Requests[Index - 1], sizeof (Swap));
+    CopyMem (&Requests[Index - 1], &Requests[Other], sizeof (Swap));
+    CopyMem (&Requests[Other], &Swap, sizeof (Swap));
+  }
+
+  return Count;
+}
+
+/**
+  Create a page table that maps the clusters of BatchTestGenerateRequests () as read-only,
+  so that the requests update an existing page table.
+
+  @param[in]  PagingMode  The paging mode.
+  @param[out] PageTable   The page table.
+
+  @retval RETURN_SUCCESS  The page table is created.
+**/
+RETURN_STATUS
+BatchTestCreateInitialPageTable (
+  IN  PAGING_MODE  PagingMode,
+  OUT UINTN        *PageTable
+  )
+{
+  IA32_MAP_REQUEST  Requests[3];
+  UINTN             Count;
+  UINTN             Index;
+
+  ZeroMem (Requests, sizeof (Requests));
+  Count = 0;
+  if (PagingMode == PagingPae) {
+    Requests[Count].LinearAddress = 0;
+    Requests[Count].Length        = SIZE_4GB;
+    Count++;
+  } else {
+    Requests[Count].LinearAddress = 0;
+    Requests[Count].Length        = SIZE_8GB;
+    Count++;
+    Requests[Count].LinearAddress = SIZE_512GB - SIZE_4GB;
+    Requests[Count].Length        = SIZE_8GB;
+    Count++;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    Requests[Index].Attribute.Uint64       = Requests[Index].LinearAddress;
+    Requests[Index].Attribute.Bits.Present = 1;
+    Requests[Index].Mask.Uint64            = MAX_UINT64;
+  }
+
+  *PageTable = 0;
+  return BatchTestMapSequential (PageTable, PagingMode, Requests, Count);
+}
+
+/**
+  Check that PageTableMapBatch () produces the same mappings as PageTableMap (),
+  for a new and for an existing page table.
+
+  @param[in]  Context    Pointer to the PAGING_MODE to test.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestCaseForBatchMatchesSequential (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  PAGING_MODE       PagingMode;
+  IA32_MAP_REQUEST  *Requests;
+  UINTN             RequestCount;
+  UINTN             Existing;
+  UINTN             PageTable1;
+  UINTN             PageTable2;
+  UINTN             PageTable3;
+  UINTN             TasksRun;
+  UNIT_TEST_STATUS  TestStatus;
+
+  PagingMode     = *(PAGING_MODE *)Context;
+  mBatchTestSeed = (UINT32)PagingMode;
+  Requests       = AllocatePool (BATCH_TEST_MAX_REQUESTS * sizeof (IA32_MAP_REQUEST));
+  UT_ASSERT_NOT_NULL (Requests);
+  RequestCount = BatchTestGenerateRequests (PagingMode, Requests);
+  UT_ASSERT_NOT_EQUAL (RequestCount, 0);
+
+  for (Existing = 0; Existing < 2; Existing++) {
+    PageTable1 = 0;
+    PageTable2 = 0;
+    PageTable3 = 0;
+    if (Existing == 1) {
+      UT_ASSERT_NOT_EFI_ERROR (BatchTestCreateInitialPageTable (PagingMode, &PageTable1));
+      UT_ASSERT_NOT_EFI_ERROR (BatchTestCreateInitialPageTable (PagingMode, &PageTable2));
+      UT_ASSERT_NOT_EFI_ERROR (BatchTestCreateInitialPageTable (PagingMode, &PageTable3));
+    }
+
+    TasksRun = 0;
+    UT_ASSERT_NOT_EFI_ERROR (BatchTestMapSequential (&PageTable1, PagingMode, Requests, RequestCount));
+    UT_ASSERT_NOT_EFI_ERROR (BatchTestMapBatch (&PageTable2, PagingMode, Requests, RequestCount, NULL, &TasksRun));
+    UT_ASSERT_NOT_EFI_ERROR (BatchTestMapBatch (&PageTable3, PagingMode, Requests, RequestCount, BatchTestRunTasksReversed, &TasksRun));
+    UT_ASSERT_TRUE (TasksRun > 1);
+
+    TestStatus = IsPageTableValid (PageTable2, PagingMode);
+    if (TestStatus != UNIT_TEST_PASSED) {
+      return TestStatus;
+    }
+
+    TestStatus = IsPageTableValid (PageTable3, PagingMode);
+    if (TestStatus != UNIT_TEST_PASSED) {
+      return TestStatus;
+    }
+
+    TestStatus = BatchTestCompareMappings (PageTable1, PageTable2, PagingMode);
+    if (TestStatus != UNIT_TEST_PASSED) {
+      return TestStatus;
+    }
+
+    TestStatus = BatchTestCompareMappings (PageTable1, PageTable3, PagingMode);
+    if (TestStatus != UNIT_TEST_PASSED) {
+      return TestStatus;
+    }
+  }
+
+  FreePool (Requests);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check the parameter checks, the merging of the requests, and the buffer size returned.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestCaseForBatchParameter (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  IA32_MAP_REQUEST  Requests[3];
+  UINTN             Count;
+  UINTN             PageTable;
+  UINTN             BufferSize;
+  UINTN             BatchBufferSize;
+  VOID              *Buffer;
+  BOOLEAN           IsModified;
+  UINTN             Index;
+
+  ZeroMem (Requests, sizeof (Requests));
+  for (Index = 0; Index < ARRAY_SIZE (Requests); Index++) {
+    Requests[Index].LinearAddress          = SIZE_2MB * (ARRAY_SIZE (Requests) - Index);
+    Requests[Index].Length                 = SIZE_2MB;
+    Requests[Index].Attribute.Uint64       = Requests[Index].LinearAddress;
+    Requests[Index].Attribute.Bits.Present = 1;
+    Requests[Index].Mask.Uint64            = MAX_UINT64;
+  }
+
+  PageTable  = 0;
+  BufferSize = 0;
+
+  //
+  // Misaligned requests and overlapping requests are rejected.
+  //
+  Count                     = ARRAY_SIZE (Requests);
+  Requests[1].LinearAddress = SIZE_4MB + 1;
+  UT_ASSERT_EQUAL (PageTableMapBatch (&PageTable, Paging4Level, NULL, &BufferSize, Requests, &Count, NULL, NULL, NULL), RETURN_INVALID_PARAMETER);
+  Requests[1].LinearAddress = SIZE_4MB + SIZE_4KB;
+  UT_ASSERT_EQUAL (PageTableMapBatch (&PageTable, Paging4Level, NULL, &BufferSize, Requests, &Count, NULL, NULL, NULL), RETURN_INVALID_PARAMETER);
+  UT_ASSERT_EQUAL (PageTableMapBatch (&PageTable, Paging32bit, NULL, &BufferSize, Requests, &Count, NULL, NULL, NULL), RETURN_UNSUPPORTED);
+  UT_ASSERT_EQUAL (PageTableMapBatch (&PageTable, Paging4Level, NULL, &BufferSize, NULL, &Count, NULL, NULL, NULL), RETURN_INVALID_PARAMETER);
+  Requests[1].LinearAddress = SIZE_4MB;
+
+  //
+  // The three adjacent 2MB requests are merged into one 6MB request, which needs the
+  // same buffer as one PageTableMap () call.
+  //
+  UT_ASSERT_EQUAL (PageTableMap (&PageTable, Paging4Level, NULL, &BufferSize, SIZE_2MB, SIZE_2MB * 3, &Requests[0].Attribute, &Requests[0].Mask, NULL), RETURN_BUFFER_TOO_SMALL);
+  BatchBufferSize = 0;
+  UT_ASSERT_EQUAL (PageTableMapBatch (&PageTable, Paging4Level, NULL, &BatchBufferSize, Requests, &Count, NULL, NULL, NULL), RETURN_BUFFER_TOO_SMALL);
+  UT_ASSERT_EQUAL (Count, 1);
+  UT_ASSERT_EQUAL (Requests[0].LinearAddress, SIZE_2MB);
+  UT_ASSERT_EQUAL (Requests[0].Length, SIZE_2MB * 3);
+  UT_ASSERT_EQUAL (BatchBufferSize, BufferSize);
+
+  Buffer = AllocatePages (EFI_SIZE_TO_PAGES (BatchBufferSize));
+  UT_ASSERT_NOT_NULL (Buffer);
+  UT_ASSERT_EQUAL (PageTableMapBatch (&PageTable, Paging4Level, Buffer, &BatchBufferSize, Requests, &Count, NULL, NULL, &IsModified), RETURN_SUCCESS);
+  UT_ASSERT_EQUAL (BatchBufferSize, 0);
+  UT_ASSERT_TRUE (IsModified);
+
+  //
+  // Mapping again with the same attributes doesn't modify the page table.
+  //
+  BatchBufferSize = 0;
+  UT_ASSERT_EQUAL (PageTableMapBatch (&PageTable, Paging4Level, NULL, &BatchBufferSize, Requests, &Count, NULL, NULL, &IsModified), RETURN_SUCCESS);
+  UT_ASSERT_EQUAL (IsModified, FALSE);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Measure the time to map 4GB with 4KB pages and alternating attributes per 2MB, with
+  PageTableMap () and with PageTableMapBatch ().
+
+  @param[in]  Context    [Optional] An optional parameter.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestCaseForBatchPerformance (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  IA32_MAP_REQUEST  *Requests;
+  UINTN             RequestCount;
+  UINTN             Index;
+  UINTN             PageTable1;
+  UINTN             PageTable2;
+  UINTN             PageTable3;
+  UINTN             TasksRun;
+  clock_t           Start;
+  clock_t           Ticks[3];
+
+  RequestCount = (UINTN)(BATCH_TEST_BENCHMARK_LENGTH / BATCH_TEST_BENCHMARK_CHUNK);
+  Requests     = AllocateZeroPool (RequestCount * sizeof (IA32_MAP_REQUEST));
+  UT_ASSERT_NOT_NULL (Requests);
+  for (Index = 0; Index < RequestCount; Index++) {
+    Requests[Index].LinearAddress          = MultU64x32 (BATCH_TEST_BENCHMARK_CHUNK, (UINT32)Index);
+    Requests[Index].Length                 = BATCH_TEST_BENCHMARK_CHUNK;
+    Requests[Index].Attribute.Uint64       = Requests[Index].LinearAddress;
+    Requests[Index].Attribute.Bits.Present = 1;
+    Requests[Index].Attribute.Bits.Nx      = Index & 1;
+    Requests[Index].Mask.Uint64            = MAX_UINT64;
+  }
+
+  PageTable1 = 0;
+  PageTable2 = 0;
+  PageTable3 = 0;
+  TasksRun   = 0;
+
+  Start = clock ();
+  UT_ASSERT_NOT_EFI_ERROR (BatchTestMapSequential (&PageTable1, Paging4Level4KB, Requests, RequestCount));
+  Ticks[0] = clock () - Start;
+
+  Start = clock ();
+  UT_ASSERT_NOT_EFI_ERROR (BatchTestMapBatch (&PageTable2, Paging4Level4KB, Requests, RequestCount, NULL, &TasksRun));
+  Ticks[1] = clock () - Start;
+
+  Start = clock ();
+  UT_ASSERT_NOT_EFI_ERROR (BatchTestMapBatch (&PageTable3, Paging4Level4KB, Requests, RequestCount, BatchTestRunTasksReversed, &TasksRun));
+  Ticks[2] = clock () - Start;
+
+  UT_LOG_INFO (
+    "Map 4GB with 4KB pages: PageTableMap %d us, PageTableMapBatch %d us, %d tasks on one CPU %d us\n",
+    (UINTN)((UINT64)Ticks[0] * 1000000 / CLOCKS_PER_SEC),
+    (UINTN)((UINT64)Ticks[1] * 1000000 / CLOCKS_PER_SEC),
+    TasksRun,
+    (UINTN)((UINT64)Ticks[2] * 1000000 / CLOCKS_PER_SEC)
+    );
+
+  FreePool (Requests);
+  return BatchTestCompareMappings (PageTable1, PageTable3, Paging4Level4KB);
+}
@@ -78,6 +78,51 @@ TestCaseforRandomTest (
   IN UNIT_TEST_CONTEXT  Context
   );
 
+/**
+  Check the parameters of PageTableMapBatch.
+
+  @param[in]  Context    [Optional] An optional parameter.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestCaseForBatchParameter (
+  IN UNIT_TEST_CONTEXT  Context
+  );
+
+/**
+  Check that PageTableMapBatch produces the same mappings as PageTableMap.
+
+  @param[in]  Context    Pointer to the PAGING_MODE to test.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestCaseForBatchMatchesSequential (
+  IN UNIT_TEST_CONTEXT  Context
+  );
+
+/**
+  Measure PageTableMapBatch against PageTableMap.
+
+  @param[in]  Context    [Optional] An optional parameter.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestCaseForBatchPerformance (
+  IN UNIT_TEST_CONTEXT  Context
+  );
+
 /**
   Init global data
 
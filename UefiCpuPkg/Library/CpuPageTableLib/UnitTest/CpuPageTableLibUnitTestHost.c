@@ -15,6 +15,10 @@
 // static CPU_PAGE_TABLE_LIB_RANDOM_TEST_CONTEXT  mTestContextPaging5Level1GB = { Paging5Level1GB, 30, 20, USE_RANDOM_ARRAY };
 // static CPU_PAGE_TABLE_LIB_RANDOM_TEST_CONTEXT  mTestContextPagingPae       = { PagingPae, 30, 20, USE_RANDOM_ARRAY };
 
+static PAGING_MODE  mBatchPaging4Level    = Paging4Level;
+static PAGING_MODE  mBatchPaging5Level1GB = Paging5Level1GB;
+static PAGING_MODE  mBatchPagingPae       = PagingPae;
+
 /**
   Check if the input parameters are not supported.
 
@@ -838,6 +842,7 @@ UefiTestMain (
   EFI_STATUS                  Status;
   UNIT_TEST_FRAMEWORK_HANDLE  Framework;
   UNIT_TEST_SUITE_HANDLE      ManualTestCase;
+  UNIT_TEST_SUITE_HANDLE      BatchTestCase;
 
   // UNIT_TEST_SUITE_HANDLE      RandomTestCase;
 
@@ -872,6 +877,23 @@ UefiTestMain (
   AddTestCase (ManualTestCase, "Check if the parent entry has different Nx attribute", "Manual Test Case6", TestCaseManualChangeNx, NULL, NULL, NULL);
   AddTestCase (ManualTestCase, "Check if the needed size is expected", "Manual Test Case7", TestCaseManualSizeNotMatch, NULL, NULL, NULL);
   AddTestCase (ManualTestCase, "Check MapMask when creating new page table or mapping not-present range", "Manual Test Case8", TestCaseToCheckMapMaskAndAttr, NULL, NULL, NULL);
+
+  //
+  // Populate the Batch Test Cases.
+  //
+  Status = CreateUnitTestSuite (&BatchTestCase, Framework, "Batch Test Cases", "CpuPageTableLib.Batch", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for Batch Test Cases\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (BatchTestCase, "Check the parameters and the request merging of PageTableMapBatch", "Batch Test Case1", TestCaseForBatchParameter, NULL, NULL, NULL);
+  AddTestCase (BatchTestCase, "Check PageTableMapBatch matches PageTableMap for Paging4Level", "Batch Test Case2", TestCaseForBatchMatchesSequential, NULL, NULL, &mBatchPaging4Level);
+  AddTestCase (BatchTestCase, "Check PageTableMapBatch matches PageTableMap for Paging5Level1GB", "Batch Test Case3", TestCaseForBatchMatchesSequential, NULL, NULL, &mBatchPaging5Level1GB);
+  AddTestCase (BatchTestCase, "Check PageTableMapBatch matches PageTableMap for PagingPae", "Batch Test Case4", TestCaseForBatchMatchesSequential, NULL, NULL, &mBatchPagingPae);
+  AddTestCase (BatchTestCase, "Measure PageTableMapBatch against PageTableMap", "Batch Test Case5", TestCaseForBatchPerformance, NULL, NULL, NULL);
+
   //
   // Populate the Random Test Cases.
   //
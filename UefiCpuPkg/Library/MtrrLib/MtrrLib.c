@@ -2788,6 +2788,178 @@ MtrrSetMemoryAttribute (
   return MtrrSetMemoryAttributeInMtrrSettings (NULL, BaseAddress, Length, Attribute);
 }
 
+/**
+  Start collecting memory ranges whose attributes are set together.
+
+  Calling MtrrSetMemoryAttribute () for each range recalculates the MTRRs and
+  reprograms them with caches disabled every time. A transaction instead
+  calculates the MTRRs once for all the ranges, and programs them at most once.
+  To set the same MTRRs on all processors, commit into an MTRR_SETTINGS buffer
+  and then pass it to MtrrSetAllMtrrs () on each processor.
+
+  @param[out] Transaction    The transaction to start.
+  @param[in]  MtrrSetting    MTRR setting buffer to update in the commit,
+                             or NULL to program the MTRRs of the calling processor.
+  @param[in]  Ranges         Caller buffer to hold the memory ranges.
+  @param[in]  MaxRangeCount  Count of MTRR_MEMORY_RANGE the Ranges can hold.
+
+  @retval RETURN_SUCCESS            The transaction was started.
+  @retval RETURN_INVALID_PARAMETER  Transaction is NULL, or Ranges is NULL and MaxRangeCount is not 0.
+**/
+RETURN_STATUS
+EFIAPI
+MtrrTransactionBegin (
+  OUT MTRR_TRANSACTION   *Transaction,
+  IN  MTRR_SETTINGS      *MtrrSetting  OPTIONAL,
+  IN  MTRR_MEMORY_RANGE  *Ranges,
+  IN  UINTN              MaxRangeCount
+  )
+{
+  if ((Transaction == NULL) || ((Ranges == NULL) && (MaxRangeCount != 0))) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Transaction->MtrrSetting   = MtrrSetting;
+  Transaction->Ranges        = Ranges;
+  Transaction->RangeCount    = 0;
+  Transaction->MaxRangeCount = MaxRangeCount;
+  Transaction->Status        = RETURN_SUCCESS;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Add a memory range to a transaction.
+
+  When ranges overlap, the last one added takes higher priority. A range that
+  continues the previous one with the same attribute is merged into it.
+  A failure is remembered and returned by MtrrTransactionCommit (), so that
+  either all the ranges or none of them are set.
+
+  @param[in, out] Transaction  The transaction.
+  @param[in]      BaseAddress  The physical address that is the start address
+                               of a memory range.
+  @param[in]      Length       The size in bytes of the memory range.
+  @param[in]      Attribute    The attribute to set for the memory range.
+
+  @retval RETURN_SUCCESS            The memory range was added.
+  @retval RETURN_INVALID_PARAMETER  Transaction is NULL, or Length is zero.
+  @retval RETURN_OUT_OF_RESOURCES   The Ranges buffer of the transaction is full.
+  @retval Others                    An earlier call failed with this status.
+**/
+RETURN_STATUS
+EFIAPI
+MtrrTransactionAddRange (
+  IN OUT MTRR_TRANSACTION        *Transaction,
+  IN     PHYSICAL_ADDRESS        BaseAddress,
+  IN     UINT64                  Length,
+  IN     MTRR_MEMORY_CACHE_TYPE  Attribute
+  )
+{
+  MTRR_MEMORY_RANGE  *Last;
+
+  if (Transaction == NULL) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  if (RETURN_ERROR (Transaction->Status)) {
+    return Transaction->Status;
+  }
+
+  if (Length == 0) {
+    Transaction->Status = RETURN_INVALID_PARAMETER;
+    return Transaction->Status;
+  }
+
+  //
+  // The new range doesn't overlap the last one, so extending the last one
+  // doesn't change the priority between them.
+  //
+  if (Transaction->RangeCount != 0) {
+    Last = &Transaction->Ranges[Transaction->RangeCount - 1];
+    if ((Last->Type == Attribute) && (Last->BaseAddress + Last->Length == BaseAddress)) {
+      Last->Length += Length;
+      return RETURN_SUCCESS;
+    }
+  }
+
+  if (Transaction->RangeCount == Transaction->MaxRangeCount) {
+    Transaction->Status = RETURN_OUT_OF_RESOURCES;
+    return Transaction->Status;
+  }
+
+  Transaction->Ranges[Transaction->RangeCount].BaseAddress = BaseAddress;
+  Transaction->Ranges[Transaction->RangeCount].Length      = Length;
+  Transaction->Ranges[Transaction->RangeCount].Type        = Attribute;
+  Transaction->RangeCount++;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Set the attributes of all the memory ranges of a transaction.
+
+  The MTRRs are calculated once for all the ranges, then written to the
+  MTRR setting buffer of the transaction, or to the MTRRs of the calling
+  processor in one cache-disabled sequence.
+
+  The transaction is emptied unless RETURN_BUFFER_TOO_SMALL is returned, in
+  which case the commit can be retried with a larger scratch buffer.
+
+  @param[in, out] Transaction  The transaction.
+  @param[in]      Scratch      A temporary scratch buffer that is used to perform the calculation,
+                               or NULL to use an internal buffer.
+  @param[in, out] ScratchSize  Pointer to the size in bytes of the scratch buffer.
+                               It may be updated to the actual required size when the calculation
+                               needs more scratch buffer. When Scratch is NULL, it may be NULL,
+                               and is only updated when the internal buffer is too small.
+
+  @retval RETURN_SUCCESS            The attributes were set for all the memory ranges.
+  @retval RETURN_INVALID_PARAMETER  Transaction is NULL, or Scratch is not NULL and ScratchSize is NULL.
+  @retval RETURN_BUFFER_TOO_SMALL   The scratch buffer is too small for MTRR calculation.
+  @retval Others                    The status of a failed MtrrTransactionAddRange (), or
+                                    of MtrrSetMemoryAttributesInMtrrSettings ().
+**/
+RETURN_STATUS
+EFIAPI
+MtrrTransactionCommit (
+  IN OUT MTRR_TRANSACTION  *Transaction,
+  IN     VOID              *Scratch      OPTIONAL,
+  IN OUT UINTN             *ScratchSize  OPTIONAL
+  )
+{
+  RETURN_STATUS  Status;
+  UINT8          LocalScratch[SCRATCH_BUFFER_SIZE];
+  UINTN          LocalScratchSize;
+  BOOLEAN        UseLocalScratch;
+
+  if ((Transaction == NULL) || ((Scratch != NULL) && (ScratchSize == NULL))) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Status = Transaction->Status;
+  if (!RETURN_ERROR (Status) && (Transaction->RangeCount != 0)) {
+    UseLocalScratch  = (BOOLEAN)(Scratch == NULL);
+    LocalScratchSize = sizeof (LocalScratch);
+    Status           = MtrrSetMemoryAttributesInMtrrSettings (
+                         Transaction->MtrrSetting,
+                         UseLocalScratch ? LocalScratch : Scratch,
+                         UseLocalScratch ? &LocalScratchSize : ScratchSize,
+                         Transaction->Ranges,
+                         Transaction->RangeCount
+                         );
+    if (Status == RETURN_BUFFER_TOO_SMALL) {
+      if (UseLocalScratch && (ScratchSize != NULL)) {
+        *ScratchSize = LocalScratchSize;
+      }
+
+      return Status;
+    }
+  }
+
+  Transaction->RangeCount = 0;
+  Transaction->Status     = RETURN_SUCCESS;
+  return Status;
+}
+
 /**
   Worker function setting variable MTRRs
 
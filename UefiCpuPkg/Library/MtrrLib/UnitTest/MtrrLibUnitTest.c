@@ -1167,6 +1167,348 @@ UnitTestMtrrSetMemoryAttributeAndGetMemoryAttributesInMtrrSettings (
   return UNIT_TEST_PASSED;
 }
 
+/**
+  Unit test of MtrrLib services MtrrTransactionBegin(), MtrrTransactionAddRange()
+  and MtrrTransactionCommit().
+
+  @param[in]  Context    Pointer to MTRR_LIB_SYSTEM_PARAMETER.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestMtrrTransaction (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  CONST MTRR_LIB_SYSTEM_PARAMETER  *SystemParameter;
+  RETURN_STATUS                    Status;
+  UINT32                           UcCount;
+  UINT32                           WtCount;
+  UINT32                           WbCount;
+  UINT32                           WpCount;
+  UINT32                           WcCount;
+
+  UINTN             MtrrIndex;
+  UINTN             Index;
+  MTRR_SETTINGS     LocalMtrrs;
+  MTRR_SETTINGS     OriginalMtrrs;
+  MTRR_TRANSACTION  Transaction;
+  UINT8             *Scratch;
+  UINTN             ScratchSize;
+
+  MTRR_MEMORY_RANGE  RawMtrrRange[MTRR_NUMBER_OF_VARIABLE_MTRR];
+  MTRR_MEMORY_RANGE  ExpectedMemoryRanges[MTRR_NUMBER_OF_FIXED_MTRR * sizeof (UINT64) + 2 * MTRR_NUMBER_OF_VARIABLE_MTRR + 1];
+  UINT32             ExpectedVariableMtrrUsage;
+  UINTN              ExpectedMemoryRangesCount;
+
+  MTRR_MEMORY_RANGE  ActualMemoryRanges[MTRR_NUMBER_OF_FIXED_MTRR * sizeof (UINT64) + 2 * MTRR_NUMBER_OF_VARIABLE_MTRR + 1];
+  UINT32             ActualVariableMtrrUsage;
+  UINTN              ActualMemoryRangesCount;
+
+  MTRR_MEMORY_RANGE  TransactionRanges[MTRR_NUMBER_OF_FIXED_MTRR * sizeof (UINT64) + 2 * MTRR_NUMBER_OF_VARIABLE_MTRR + 1];
+
+  MTRR_SETTINGS  *Mtrrs[2];
+
+  SystemParameter = (MTRR_LIB_SYSTEM_PARAMETER *)Context;
+  GenerateRandomMemoryTypeCombination (
+    SystemParameter->VariableMtrrCount - PatchPcdGet32 (PcdCpuNumberOfReservedVariableMtrrs),
+    &UcCount,
+    &WtCount,
+    &WbCount,
+    &WpCount,
+    &WcCount
+    );
+  GenerateValidAndConfigurableMtrrPairs (
+    SystemParameter->PhysicalAddressBits - SystemParameter->MkTmeKeyidBits,
+    RawMtrrRange,
+    UcCount,
+    WtCount,
+    WbCount,
+    WpCount,
+    WcCount
+    );
+
+  ExpectedVariableMtrrUsage = UcCount + WtCount + WbCount + WpCount + WcCount;
+  ExpectedMemoryRangesCount = ARRAY_SIZE (ExpectedMemoryRanges);
+  GetEffectiveMemoryRanges (
+    SystemParameter->DefaultCacheType,
+    SystemParameter->PhysicalAddressBits - SystemParameter->MkTmeKeyidBits,
+    RawMtrrRange,
+    ExpectedVariableMtrrUsage,
+    ExpectedMemoryRanges,
+    &ExpectedMemoryRangesCount
+    );
+
+  UT_LOG_INFO ("--- Expected Memory Ranges [%d] ---\n", ExpectedMemoryRangesCount);
+  DumpMemoryRanges (ExpectedMemoryRanges, ExpectedMemoryRangesCount);
+
+  //
+  // Default cache type is always an INPUT
+  //
+  ZeroMem (&LocalMtrrs, sizeof (LocalMtrrs));
+  LocalMtrrs.MtrrDefType = MtrrGetDefaultMemoryType ();
+  ScratchSize            = SCRATCH_BUFFER_SIZE;
+  Scratch                = calloc (ScratchSize, sizeof (UINT8));
+  Mtrrs[0]               = &LocalMtrrs;
+  Mtrrs[1]               = NULL;
+
+  for (MtrrIndex = 0; MtrrIndex < ARRAY_SIZE (Mtrrs); MtrrIndex++) {
+    Status = MtrrTransactionBegin (&Transaction, Mtrrs[MtrrIndex], TransactionRanges, ARRAY_SIZE (TransactionRanges));
+    UT_ASSERT_STATUS_EQUAL (Status, RETURN_SUCCESS);
+
+    //
+    // Add the ranges in reverse order, so that adjacent ranges are not merged.
+    //
+    for (Index = ExpectedMemoryRangesCount; Index > 0; Index--) {
+      Status = MtrrTransactionAddRange (
+                 &Transaction,
+                 ExpectedMemoryRanges[Index - 1].BaseAddress,
+                 ExpectedMemoryRanges[Index - 1].Length,
+                 ExpectedMemoryRanges[Index - 1].Type
+                 );
+      UT_ASSERT_STATUS_EQUAL (Status, RETURN_SUCCESS);
+    }
+
+    mMtrrProgramCount = 0;
+    Status            = MtrrTransactionCommit (&Transaction, Scratch, &ScratchSize);
+    if (Status == RETURN_BUFFER_TOO_SMALL) {
+      Scratch = realloc (Scratch, ScratchSize);
+      Status  = MtrrTransactionCommit (&Transaction, Scratch, &ScratchSize);
+    }
+
+    UT_ASSERT_STATUS_EQUAL (Status, RETURN_SUCCESS);
+
+    //
+    // The MTRRs are programmed at most once for all the ranges.
+    //
+    UT_ASSERT_TRUE (mMtrrProgramCount <= 1);
+
+    if (Mtrrs[MtrrIndex] == NULL) {
+      ZeroMem (&LocalMtrrs, sizeof (LocalMtrrs));
+      MtrrGetAllMtrrs (&LocalMtrrs);
+    }
+
+    ActualMemoryRangesCount = ARRAY_SIZE (ActualMemoryRanges);
+    CollectTestResult (
+      SystemParameter->DefaultCacheType,
+      SystemParameter->PhysicalAddressBits - SystemParameter->MkTmeKeyidBits,
+      SystemParameter->VariableMtrrCount,
+      &LocalMtrrs,
+      ActualMemoryRanges,
+      &ActualMemoryRangesCount,
+      &ActualVariableMtrrUsage
+      );
+    UT_LOG_INFO ("--- Actual Memory Ranges [%d] ---\n", ActualMemoryRangesCount);
+    DumpMemoryRanges (ActualMemoryRanges, ActualMemoryRangesCount);
+    VerifyMemoryRanges (ExpectedMemoryRanges, ExpectedMemoryRangesCount, ActualMemoryRanges, ActualMemoryRangesCount);
+    UT_ASSERT_TRUE (ExpectedVariableMtrrUsage >= ActualVariableMtrrUsage);
+
+    //
+    // A failed MtrrTransactionAddRange () fails the commit, and none of the ranges is set.
+    //
+    CopyMem (&OriginalMtrrs, &LocalMtrrs, sizeof (OriginalMtrrs));
+    Status = MtrrTransactionBegin (&Transaction, Mtrrs[MtrrIndex], TransactionRanges, 1);
+    UT_ASSERT_STATUS_EQUAL (Status, RETURN_SUCCESS);
+    Status = MtrrTransactionAddRange (&Transaction, 0, SIZE_4KB, CacheUncacheable);
+    UT_ASSERT_STATUS_EQUAL (Status, RETURN_SUCCESS);
+    Status = MtrrTransactionAddRange (&Transaction, SIZE_4KB, SIZE_4KB, CacheUncacheable);
+    UT_ASSERT_STATUS_EQUAL (Status, RETURN_SUCCESS);
+    Status = MtrrTransactionAddRange (&Transaction, SIZE_16KB, SIZE_4KB, CacheWriteBack);
+    UT_ASSERT_STATUS_EQUAL (Status, RETURN_OUT_OF_RESOURCES);
+    Status = MtrrTransactionAddRange (&Transaction, SIZE_32KB, SIZE_4KB, CacheWriteBack);
+    UT_ASSERT_STATUS_EQUAL (Status, RETURN_OUT_OF_RESOURCES);
+    UT_ASSERT_EQUAL (TransactionRanges[0].Length, SIZE_8KB);
+
+    mMtrrProgramCount = 0;
+    Status            = MtrrTransactionCommit (&Transaction, NULL, NULL);
+    UT_ASSERT_STATUS_EQUAL (Status, RETURN_OUT_OF_RESOURCES);
+    UT_ASSERT_EQUAL (mMtrrProgramCount, 0);
+    if (Mtrrs[MtrrIndex] == NULL) {
+      MtrrGetAllMtrrs (&LocalMtrrs);
+    }
+
+    UT_ASSERT_MEM_EQUAL (&LocalMtrrs, &OriginalMtrrs, sizeof (LocalMtrrs));
+
+    Status = MtrrTransactionAddRange (&Transaction, 0, 0, CacheUncacheable);
+    UT_ASSERT_STATUS_EQUAL (Status, RETURN_INVALID_PARAMETER);
+    Status = MtrrTransactionCommit (&Transaction, NULL, NULL);
+    UT_ASSERT_STATUS_EQUAL (Status, RETURN_INVALID_PARAMETER);
+
+    //
+    // The commit empties the transaction.
+    //
+    Status = MtrrTransactionCommit (&Transaction, NULL, NULL);
+    UT_ASSERT_STATUS_EQUAL (Status, RETURN_SUCCESS);
+
+    ZeroMem (&LocalMtrrs, sizeof (LocalMtrrs));
+  }
+
+  free (Scratch);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Measure the time to calculate the MTRRs for random range sets, with one
+  MtrrSetMemoryAttributeInMtrrSettings() call per range and with one transaction.
+
+  @param[in]  Context    Pointer to MTRR_LIB_SYSTEM_PARAMETER.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+UnitTestMtrrTransactionSolverTime (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  CONST MTRR_LIB_SYSTEM_PARAMETER  *SystemParameter;
+  RETURN_STATUS                    Status;
+  UINT32                           UcCount;
+  UINT32                           WtCount;
+  UINT32                           WbCount;
+  UINT32                           WpCount;
+  UINT32                           WcCount;
+
+  UINTN             Iteration;
+  UINTN             Index;
+  UINTN             RangeTotal;
+  UINTN             SequentialCount;
+  UINTN             SequentialProgramCount;
+  UINTN             TransactionProgramCount;
+  MTRR_SETTINGS     LocalMtrrs;
+  MTRR_TRANSACTION  Transaction;
+  UINT8             *Scratch;
+  UINTN             ScratchSize;
+  clock_t           Start;
+  clock_t           SequentialTicks;
+  clock_t           TransactionTicks;
+
+  MTRR_MEMORY_RANGE  RawMtrrRange[MTRR_NUMBER_OF_VARIABLE_MTRR];
+  MTRR_MEMORY_RANGE  ExpectedMemoryRanges[MTRR_NUMBER_OF_FIXED_MTRR * sizeof (UINT64) + 2 * MTRR_NUMBER_OF_VARIABLE_MTRR + 1];
+  UINTN              ExpectedMemoryRangesCount;
+  MTRR_MEMORY_RANGE  TransactionRanges[MTRR_NUMBER_OF_FIXED_MTRR * sizeof (UINT64) + 2 * MTRR_NUMBER_OF_VARIABLE_MTRR + 1];
+
+  SystemParameter         = (MTRR_LIB_SYSTEM_PARAMETER *)Context;
+  ScratchSize             = SCRATCH_BUFFER_SIZE;
+  Scratch                 = calloc (ScratchSize, sizeof (UINT8));
+  RangeTotal              = 0;
+  SequentialCount         = 0;
+  SequentialTicks         = 0;
+  TransactionTicks        = 0;
+  SequentialProgramCount  = 0;
+  TransactionProgramCount = 0;
+
+  for (Iteration = 0; Iteration < 100; Iteration++) {
+    GenerateRandomMemoryTypeCombination (
+      SystemParameter->VariableMtrrCount - PatchPcdGet32 (PcdCpuNumberOfReservedVariableMtrrs),
+      &UcCount,
+      &WtCount,
+      &WbCount,
+      &WpCount,
+      &WcCount
+      );
+    GenerateValidAndConfigurableMtrrPairs (
+      SystemParameter->PhysicalAddressBits - SystemParameter->MkTmeKeyidBits,
+      RawMtrrRange,
+      UcCount,
+      WtCount,
+      WbCount,
+      WpCount,
+      WcCount
+      );
+    ExpectedMemoryRangesCount = ARRAY_SIZE (ExpectedMemoryRanges);
+    GetEffectiveMemoryRanges (
+      SystemParameter->DefaultCacheType,
+      SystemParameter->PhysicalAddressBits - SystemParameter->MkTmeKeyidBits,
+      RawMtrrRange,
+      UcCount + WtCount + WbCount + WpCount + WcCount,
+      ExpectedMemoryRanges,
+      &ExpectedMemoryRangesCount
+      );
+    RangeTotal += ExpectedMemoryRangesCount;
+
+    //
+    // One call per range. It may run out of MTRRs, as the layout of the ranges set
+    // so far may need more MTRRs than the final layout.
+    //
+    InitializeMtrrRegs ((MTRR_LIB_SYSTEM_PARAMETER *)SystemParameter);
+    Start = clock ();
+    for (Index = 0; Index < ExpectedMemoryRangesCount; Index++) {
+      Status = MtrrSetMemoryAttribute (
+                 ExpectedMemoryRanges[Index].BaseAddress,
+                 ExpectedMemoryRanges[Index].Length,
+                 ExpectedMemoryRanges[Index].Type
+                 );
+      if (RETURN_ERROR (Status)) {
+        break;
+      }
+    }
+
+    SequentialTicks        += clock () - Start;
+    SequentialProgramCount += mMtrrProgramCount;
+    if (Index == ExpectedMemoryRangesCount) {
+      SequentialCount++;
+    }
+
+    //
+    // One transaction.
+    //
+    InitializeMtrrRegs ((MTRR_LIB_SYSTEM_PARAMETER *)SystemParameter);
+    Start = clock ();
+    MtrrTransactionBegin (&Transaction, NULL, TransactionRanges, ARRAY_SIZE (TransactionRanges));
+    for (Index = 0; Index < ExpectedMemoryRangesCount; Index++) {
+      MtrrTransactionAddRange (
+        &Transaction,
+        ExpectedMemoryRanges[Index].BaseAddress,
+        ExpectedMemoryRanges[Index].Length,
+        ExpectedMemoryRanges[Index].Type
+        );
+    }
+
+    Status = MtrrTransactionCommit (&Transaction, Scratch, &ScratchSize);
+    if (Status == RETURN_BUFFER_TOO_SMALL) {
+      Scratch = realloc (Scratch, ScratchSize);
+      Status  = MtrrTransactionCommit (&Transaction, Scratch, &ScratchSize);
+    }
+
+    TransactionTicks        += clock () - Start;
+    TransactionProgramCount += mMtrrProgramCount;
+    UT_ASSERT_STATUS_EQUAL (Status, RETURN_SUCCESS);
+    UT_ASSERT_TRUE (mMtrrProgramCount <= 1);
+
+    ZeroMem (&LocalMtrrs, sizeof (LocalMtrrs));
+    MtrrGetAllMtrrs (&LocalMtrrs);
+  }
+
+  UT_LOG_INFO (
+    "%d range sets, %d ranges: one call per range %d us, %d programming sequences, %d sets succeeded\n",
+    Iteration,
+    RangeTotal,
+    (UINTN)((UINT64)SequentialTicks * 1000000 / CLOCKS_PER_SEC),
+    SequentialProgramCount,
+    SequentialCount
+    );
+  UT_LOG_INFO (
+    "%d range sets, %d ranges: one transaction per set %d us, %d programming sequences\n",
+    Iteration,
+    RangeTotal,
+    (UINTN)((UINT64)TransactionTicks * 1000000 / CLOCKS_PER_SEC),
+    TransactionProgramCount
+    );
+
+  free (Scratch);
+
+  return UNIT_TEST_PASSED;
+}
+
 /**
   Prep routine for UnitTestGetFirmwareVariableMtrrCount().
 
@@ -1271,9 +1613,12 @@ UnitTestingEntry (
       AddTestCase (MtrrApiTests, "Test InvalidMemoryLayouts", "InvalidMemoryLayouts", UnitTestInvalidMemoryLayouts, InitializeSystem, NULL, &mSystemParameters[SystemIndex]);
       AddTestCase (MtrrApiTests, "Test MtrrSetMemoryAttributeInMtrrSettings and MtrrGetMemoryAttributesInMtrrSettings", "MtrrSetMemoryAttributeInMtrrSettings and MtrrGetMemoryAttributesInMtrrSettings", UnitTestMtrrSetMemoryAttributeAndGetMemoryAttributesInMtrrSettings, InitializeSystem, NULL, &mSystemParameters[SystemIndex]);
       AddTestCase (MtrrApiTests, "Test MtrrSetMemoryAttributesInMtrrSettings and MtrrGetMemoryAttributesInMtrrSettings", "MtrrSetMemoryAttributesInMtrrSettings and MtrrGetMemoryAttributesInMtrrSetting", UnitTestMtrrSetAndGetMemoryAttributesInMtrrSettings, InitializeSystem, NULL, &mSystemParameters[SystemIndex]);
+      AddTestCase (MtrrApiTests, "Test MtrrTransactionBegin, MtrrTransactionAddRange and MtrrTransactionCommit", "MtrrTransaction", UnitTestMtrrTransaction, InitializeSystem, NULL, &mSystemParameters[SystemIndex]);
     }
   }
 
+  AddTestCase (MtrrApiTests, "Measure MtrrTransactionCommit against MtrrSetMemoryAttribute", "MtrrTransactionSolverTime", UnitTestMtrrTransactionSolverTime, InitializeSystem, NULL, (UNIT_TEST_CONTEXT)&mDefaultSystemParameter);
+
   //
   // Execute the tests.
   //
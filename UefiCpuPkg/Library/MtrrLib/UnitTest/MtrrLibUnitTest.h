@@ -45,6 +45,7 @@ typedef struct {
 
 extern UINT32   mFixedMtrrsIndex[];
 extern BOOLEAN  mRandomInput;
+extern UINTN    mMtrrProgramCount;
 
 /**
   Initialize the MTRR registers.
@@ -23,6 +23,7 @@ CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS_ECX  mCpuidExtendedFeatureFlagsEcx;
 CPUID_VIR_PHY_ADDRESS_SIZE_EAX               mCpuidVirPhyAddressSizeEax;
 
 BOOLEAN       mRandomInput;
+UINTN         mMtrrProgramCount;
 UINTN         mNumberIndex = 0;
 extern UINTN  mNumbers[];
 extern UINTN  mNumberCount;
@@ -332,6 +333,13 @@ UnitTestMtrrLibAsmWriteMsr64 (
       UT_ASSERT_EQUAL (mMtrrCapMsr.Bits.FIX, 1);
     }
 
+    //
+    // Count the MTRR programming sequences, which start by disabling the MTRRs.
+    //
+    if ((mDefTypeMsr.Bits.E == 1) && (((MSR_IA32_MTRR_DEF_TYPE_REGISTER *)&Value)->Bits.E == 0)) {
+      mMtrrProgramCount++;
+    }
+
     mDefTypeMsr.Uint64 = Value;
     return Value;
   }
@@ -374,6 +382,7 @@ InitializeMtrrRegs (
   mDefTypeMsr.Bits.Reserved1 = 0;
   mDefTypeMsr.Bits.Reserved2 = 0;
   mDefTypeMsr.Bits.Reserved3 = 0;
+  mMtrrProgramCount          = 0;
 
   mMtrrCapMsr.Bits.SMRR      = 0;
   mMtrrCapMsr.Bits.WC        = 0;
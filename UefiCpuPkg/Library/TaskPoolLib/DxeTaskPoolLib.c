@@ -0,0 +1,132 @@
+/** @file
+  Start the task pool workers through the MP Services protocol.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiDxe.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include "InternalTaskPoolLib.h"
+
+/**
+  Get EFI_MP_SERVICES_PROTOCOL pointer.
+
+  @param[out] MpServices    A pointer to the buffer where EFI_MP_SERVICES_PROTOCOL is stored
+
+  @retval EFI_SUCCESS       EFI_MP_SERVICES_PROTOCOL interface is returned
+  @retval EFI_NOT_FOUND     EFI_MP_SERVICES_PROTOCOL interface is not found
+**/
+EFI_STATUS
+TaskPoolGetMpServices (
+  OUT MP_SERVICES  *MpServices
+  )
+{
+  return gBS->LocateProtocol (&gEfiMpServiceProtocolGuid, NULL, (VOID **)&MpServices->Protocol);
+}
+
+/**
+  Run a procedure on all the enabled logical processors, the BSP included, and
+  wait for all of them to finish.
+
+  The APs are started in non-blocking mode so that the BSP runs the procedure
+  at the same time. The MP Services protocol only checks for the completion
+  of the APs in a timer event, so the APs are only used up to TPL_CALLBACK.
+
+  @param[in]  MpServices          MP_SERVICES structure.
+  @param[in]  Procedure           A pointer to the function to be run on enabled logical processors.
+  @param[in]  ProcedureArgument   The parameter passed into Procedure for all enabled logical processors.
+
+  @retval EFI_SUCCESS       Procedure ran on the enabled logical processors.
+  @retval others            Procedure may not have run on some of them.
+**/
+EFI_STATUS
+TaskPoolStartupAllCpus (
+  IN MP_SERVICES       MpServices,
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *ProcedureArgument
+  )
+{
+  EFI_STATUS  Status;
+  EFI_EVENT   Event;
+  EFI_TPL     OldTpl;
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  gBS->RestoreTPL (OldTpl);
+  if (OldTpl > TPL_CALLBACK) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &Event);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = MpServices.Protocol->StartupAllAPs (
+                                  MpServices.Protocol,
+                                  Procedure,
+                                  FALSE,
+                                  Event,
+                                  0,
+                                  ProcedureArgument,
+                                  NULL
+                                  );
+  if (!EFI_ERROR (Status)) {
+    Procedure (ProcedureArgument);
+    while (gBS->CheckEvent (Event) == EFI_NOT_READY) {
+      CpuPause ();
+    }
+  }
+
+  gBS->CloseEvent (Event);
+  return Status;
+}
+
+/**
+  Get the logical processor number.
+
+  @param[in]  MpServices          MP_SERVICES structure.
+
+  @retval  Return the logical processor number.
+**/
+UINTN
+TaskPoolWhoAmI (
+  IN MP_SERVICES  MpServices
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       ProcessorNum;
+
+  Status = MpServices.Protocol->WhoAmI (MpServices.Protocol, &ProcessorNum);
+  ASSERT_EFI_ERROR (Status);
+
+  return ProcessorNum;
+}
+
+/**
+  Get the number of logical processors in the platform.
+
+  @param[in]  MpServices                 MP_SERVICES structure.
+  @param[out] NumberOfEnabledProcessors  The number of enabled logical processors.
+
+  @retval  Return the total number of logical processors.
+**/
+UINTN
+TaskPoolGetNumberOfProcessors (
+  IN  MP_SERVICES  MpServices,
+  OUT UINTN        *NumberOfEnabledProcessors
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       NumberOfProcessors;
+
+  Status = MpServices.Protocol->GetNumberOfProcessors (MpServices.Protocol, &NumberOfProcessors, NumberOfEnabledProcessors);
+  ASSERT_EFI_ERROR (Status);
+  if (EFI_ERROR (Status)) {
+    NumberOfProcessors         = 1;
+    *NumberOfEnabledProcessors = 1;
+  }
+
+  return NumberOfProcessors;
+}
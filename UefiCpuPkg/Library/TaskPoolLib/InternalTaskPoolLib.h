@@ -0,0 +1,159 @@
+/** @file
+  Internal header file for the Task Pool Library.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef INTERNAL_TASK_POOL_LIB_H_
+#define INTERNAL_TASK_POOL_LIB_H_
+
+#include <PiPei.h>
+#include <Ppi/MpServices2.h>
+#include <Protocol/MpService.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/SynchronizationLib.h>
+#include <Library/TaskPoolLib.h>
+
+//
+// Number of tasks per processor when TaskPoolCreate () gets 0 for MaxTasks.
+//
+#define TASK_POOL_TASKS_PER_PROCESSOR  64
+
+//
+// Number of parts per processor a parallel-for is split into when
+// TaskPoolParallelFor () gets 0 for Grain.
+//
+#define TASK_POOL_PARTS_PER_PROCESSOR  8
+
+typedef union {
+  EFI_PEI_MP_SERVICES2_PPI    *Ppi;
+  EFI_MP_SERVICES_PROTOCOL    *Protocol;
+} MP_SERVICES;
+
+///
+/// A parallel-for, shared by all the tasks running a part of it.
+///
+typedef struct {
+  TASK_POOL_RANGE_PROCEDURE    Procedure;
+  VOID                         *Context;
+  UINTN                        Grain;
+} TASK_POOL_FOR;
+
+typedef struct _TASK_POOL_TASK TASK_POOL_TASK;
+
+///
+/// A task. The task runs Procedure (Context), or the range [Start, End) of
+/// the parallel-for For when For is not NULL.
+///
+struct _TASK_POOL_TASK {
+  TASK_POOL_PROCEDURE    Procedure;
+  VOID                   *Context;
+  TASK_POOL_FOR          *For;
+  UINTN                  Start;
+  UINTN                  End;
+  //
+  // TRUE when no future was returned for the task, so that the task is
+  // released as soon as it completed.
+  //
+  BOOLEAN                Detached;
+  volatile BOOLEAN       Done;
+  TASK_POOL_TASK         *NextFree;
+};
+
+///
+/// The deque of a processor. Tasks[] holds the tasks from Head to Tail - 1,
+/// both counting up forever and used modulo the number of tasks of the pool.
+/// No deque overflows because no more tasks than that can be pending.
+///
+typedef struct {
+  SPIN_LOCK         Lock;
+  volatile UINTN    Head;
+  volatile UINTN    Tail;
+  TASK_POOL_TASK    **Tasks;
+} TASK_POOL_DEQUE;
+
+struct _TASK_POOL {
+  MP_SERVICES         MpServices;
+  UINTN               ProcessorCount;
+  UINTN               WorkerCount;
+  UINTN               MaxTasks;
+  //
+  // The deques are DequeSize bytes apart, so that the deques of different
+  // processors do not share a cache line.
+  //
+  VOID                *DequeBuffer;
+  UINT8               *Deques;
+  UINTN               DequeSize;
+  TASK_POOL_TASK      *Tasks;
+  TASK_POOL_TASK      **DequeTasks;
+  SPIN_LOCK           FreeLock;
+  TASK_POOL_TASK      *FreeList;
+  volatile UINT32     PendingTasks;
+  volatile UINT32     ActiveWorkers;
+  volatile BOOLEAN    Running;
+};
+
+/**
+  Get EFI_PEI_MP_SERVICES2_PPI or EFI_MP_SERVICES_PROTOCOL pointer.
+
+  @param[out] MpServices    A pointer to the buffer where EFI_PEI_MP_SERVICES2_PPI or
+                            EFI_MP_SERVICES_PROTOCOL is stored
+
+  @retval EFI_SUCCESS       EFI_PEI_MP_SERVICES2_PPI or EFI_MP_SERVICES_PROTOCOL interface is returned
+  @retval EFI_NOT_FOUND     EFI_PEI_MP_SERVICES2_PPI or EFI_MP_SERVICES_PROTOCOL interface is not found
+**/
+EFI_STATUS
+TaskPoolGetMpServices (
+  OUT MP_SERVICES  *MpServices
+  );
+
+/**
+  Run a procedure on all the enabled logical processors, the BSP included, and
+  wait for all of them to finish.
+
+  @param[in]  MpServices          MP_SERVICES structure.
+  @param[in]  Procedure           A pointer to the function to be run on enabled logical processors.
+  @param[in]  ProcedureArgument   The parameter passed into Procedure for all enabled logical processors.
+
+  @retval EFI_SUCCESS       Procedure ran on the enabled logical processors.
+  @retval others            Procedure may not have run on some of them.
+**/
+EFI_STATUS
+TaskPoolStartupAllCpus (
+  IN MP_SERVICES       MpServices,
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *ProcedureArgument
+  );
+
+/**
+  Get the logical processor number.
+
+  @param[in]  MpServices          MP_SERVICES structure.
+
+  @retval  Return the logical processor number.
+**/
+UINTN
+TaskPoolWhoAmI (
+  IN MP_SERVICES  MpServices
+  );
+
+/**
+  Get the number of logical processors in the platform.
+
+  @param[in]  MpServices                 MP_SERVICES structure.
+  @param[out] NumberOfEnabledProcessors  The number of enabled logical processors.
+
+  @retval  Return the total number of logical processors.
+**/
+UINTN
+TaskPoolGetNumberOfProcessors (
+  IN  MP_SERVICES  MpServices,
+  OUT UINTN        *NumberOfEnabledProcessors
+  );
+
+#endif
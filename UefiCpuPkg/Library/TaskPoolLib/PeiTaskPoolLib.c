@@ -0,0 +1,98 @@
+/** @file
+  Start the task pool workers through the PEI MP Services 2 PPI.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalTaskPoolLib.h"
+#include <Library/PeiServicesLib.h>
+
+/**
+  Get EFI_PEI_MP_SERVICES2_PPI pointer.
+
+  The PPI is installed by CpuMpPei once the permanent memory is installed, so
+  a task pool created before runs all the tasks on the BSP.
+
+  @param[out] MpServices    A pointer to the buffer where EFI_PEI_MP_SERVICES2_PPI is stored
+
+  @retval EFI_SUCCESS       EFI_PEI_MP_SERVICES2_PPI interface is returned
+  @retval EFI_NOT_FOUND     EFI_PEI_MP_SERVICES2_PPI interface is not found
+**/
+EFI_STATUS
+TaskPoolGetMpServices (
+  OUT MP_SERVICES  *MpServices
+  )
+{
+  return PeiServicesLocatePpi (&gEfiPeiMpServices2PpiGuid, 0, NULL, (VOID **)&MpServices->Ppi);
+}
+
+/**
+  Run a procedure on all the enabled logical processors, the BSP included, and
+  wait for all of them to finish.
+
+  @param[in]  MpServices          MP_SERVICES structure.
+  @param[in]  Procedure           A pointer to the function to be run on enabled logical processors.
+  @param[in]  ProcedureArgument   The parameter passed into Procedure for all enabled logical processors.
+
+  @retval EFI_SUCCESS       Procedure ran on the enabled logical processors.
+  @retval others            Procedure may not have run on some of them.
+**/
+EFI_STATUS
+TaskPoolStartupAllCpus (
+  IN MP_SERVICES       MpServices,
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *ProcedureArgument
+  )
+{
+  return MpServices.Ppi->StartupAllCPUs (MpServices.Ppi, Procedure, 0, ProcedureArgument);
+}
+
+/**
+  Get the logical processor number.
+
+  @param[in]  MpServices          MP_SERVICES structure.
+
+  @retval  Return the logical processor number.
+**/
+UINTN
+TaskPoolWhoAmI (
+  IN MP_SERVICES  MpServices
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       ProcessorNum;
+
+  Status = MpServices.Ppi->WhoAmI (MpServices.Ppi, &ProcessorNum);
+  ASSERT_EFI_ERROR (Status);
+
+  return ProcessorNum;
+}
+
+/**
+  Get the number of logical processors in the platform.
+
+  @param[in]  MpServices                 MP_SERVICES structure.
+  @param[out] NumberOfEnabledProcessors  The number of enabled logical processors.
+
+  @retval  Return the total number of logical processors.
+**/
+UINTN
+TaskPoolGetNumberOfProcessors (
+  IN  MP_SERVICES  MpServices,
+  OUT UINTN        *NumberOfEnabledProcessors
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       NumberOfProcessors;
+
+  Status = MpServices.Ppi->GetNumberOfProcessors (MpServices.Ppi, &NumberOfProcessors, NumberOfEnabledProcessors);
+  ASSERT_EFI_ERROR (Status);
+  if (EFI_ERROR (Status)) {
+    NumberOfProcessors         = 1;
+    *NumberOfEnabledProcessors = 1;
+  }
+
+  return NumberOfProcessors;
+}
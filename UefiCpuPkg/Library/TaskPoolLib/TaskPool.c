@@ -0,0 +1,765 @@
+/** @file
+  Run tasks on the BSP and the APs with per-processor deques and work stealing.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalTaskPoolLib.h"
+
+/**
+  Return the deque of a processor.
+
+  @param[in] Pool       The task pool.
+  @param[in] Processor  The processor number.
+
+  @return The deque of the processor.
+**/
+STATIC
+TASK_POOL_DEQUE *
+TaskPoolGetDeque (
+  IN TASK_POOL  *Pool,
+  IN UINTN      Processor
+  )
+{
+  return (TASK_POOL_DEQUE *)(Pool->Deques + Processor * Pool->DequeSize);
+}
+
+/**
+  Return the number of the calling processor.
+
+  @param[in] Pool  The task pool.
+
+  @return The processor number.
+**/
+STATIC
+UINTN
+TaskPoolGetProcessor (
+  IN TASK_POOL  *Pool
+  )
+{
+  if (Pool->MpServices.Ppi == NULL) {
+    return 0;
+  }
+
+  return TaskPoolWhoAmI (Pool->MpServices);
+}
+
+/**
+  Put all the tasks of a pool in its free list.
+
+  @param[in] Pool  The task pool.
+**/
+STATIC
+VOID
+TaskPoolResetTasks (
+  IN TASK_POOL  *Pool
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Pool->MaxTasks; Index++) {
+    Pool->Tasks[Index].NextFree = (Index + 1 < Pool->MaxTasks) ? &Pool->Tasks[Index + 1] : NULL;
+  }
+
+  Pool->FreeList = &Pool->Tasks[0];
+}
+
+/**
+  Take a task from the free list.
+
+  @param[in] Pool  The task pool.
+
+  @return The task, or NULL when all the tasks are pending.
+**/
+STATIC
+TASK_POOL_TASK *
+TaskPoolAllocateTask (
+  IN TASK_POOL  *Pool
+  )
+{
+  TASK_POOL_TASK  *Task;
+
+  AcquireSpinLock (&Pool->FreeLock);
+  Task = Pool->FreeList;
+  if (Task != NULL) {
+    Pool->FreeList = Task->NextFree;
+  }
+
+  ReleaseSpinLock (&Pool->FreeLock);
+
+  if (Task != NULL) {
+    Task->Procedure = NULL;
+    Task->Context   = NULL;
+    Task->For       = NULL;
+    Task->Detached  = FALSE;
+    Task->Done      = FALSE;
+  }
+
+  return Task;
+}
+
+/**
+  Return a task to the free list.
+
+  @param[in] Pool  The task pool.
+  @param[in] Task  The task.
+**/
+STATIC
+VOID
+TaskPoolFreeTask (
+  IN TASK_POOL       *Pool,
+  IN TASK_POOL_TASK  *Task
+  )
+{
+  AcquireSpinLock (&Pool->FreeLock);
+  Task->NextFree = Pool->FreeList;
+  Pool->FreeList = Task;
+  ReleaseSpinLock (&Pool->FreeLock);
+}
+
+/**
+  Push a task at the tail of the deque of a processor, and count it as pending.
+
+  @param[in] Pool       The task pool.
+  @param[in] Processor  The processor number.
+  @param[in] Task       The task.
+**/
+STATIC
+VOID
+TaskPoolPushTask (
+  IN TASK_POOL       *Pool,
+  IN UINTN           Processor,
+  IN TASK_POOL_TASK  *Task
+  )
+{
+  TASK_POOL_DEQUE  *Deque;
+
+  InterlockedIncrement (&Pool->PendingTasks);
+
+  Deque = TaskPoolGetDeque (Pool, Processor);
+  AcquireSpinLock (&Deque->Lock);
+  ASSERT (Deque->Tail - Deque->Head < Pool->MaxTasks);
+  Deque->Tasks[Deque->Tail % Pool->MaxTasks] = Task;
+  Deque->Tail++;
+  ReleaseSpinLock (&Deque->Lock);
+}
+
+/**
+  Take a task from a deque.
+
+  @param[in] Pool       The task pool.
+  @param[in] Processor  The processor number owning the deque.
+  @param[in] Steal      TRUE to take the oldest task at the head of the deque,
+                        FALSE to take the newest task at its tail.
+
+  @return The task, or NULL when the deque is empty.
+**/
+STATIC
+TASK_POOL_TASK *
+TaskPoolPopTask (
+  IN TASK_POOL  *Pool,
+  IN UINTN      Processor,
+  IN BOOLEAN    Steal
+  )
+{
+  TASK_POOL_DEQUE  *Deque;
+  TASK_POOL_TASK   *Task;
+
+  Deque = TaskPoolGetDeque (Pool, Processor);
+  if (Deque->Head == Deque->Tail) {
+    //
+    // Do not take the lock of an empty deque, so that the idle processors
+    // looking for work do not slow down the owner.
+    //
+    return NULL;
+  }
+
+  Task = NULL;
+  AcquireSpinLock (&Deque->Lock);
+  if (Deque->Head != Deque->Tail) {
+    if (Steal) {
+      Task = Deque->Tasks[Deque->Head % Pool->MaxTasks];
+      Deque->Head++;
+    } else {
+      Deque->Tail--;
+      Task = Deque->Tasks[Deque->Tail % Pool->MaxTasks];
+    }
+  }
+
+  ReleaseSpinLock (&Deque->Lock);
+  return Task;
+}
+
+/**
+  Take the newest task of the deque of a processor or, when it is empty, steal
+  the oldest task of the deque of another processor.
+
+  @param[in] Pool       The task pool.
+  @param[in] Processor  The processor number.
+
+  @return The task, or NULL when all the deques are empty.
+**/
+STATIC
+TASK_POOL_TASK *
+TaskPoolTakeTask (
+  IN TASK_POOL  *Pool,
+  IN UINTN      Processor
+  )
+{
+  TASK_POOL_TASK  *Task;
+  UINTN           Index;
+
+  Task = TaskPoolPopTask (Pool, Processor, FALSE);
+  for (Index = 1; Task == NULL && Index < Pool->ProcessorCount; Index++) {
+    Task = TaskPoolPopTask (Pool, (Processor + Index) % Pool->ProcessorCount, TRUE);
+  }
+
+  return Task;
+}
+
+/**
+  Wait for a task to complete, running other tasks meanwhile, and release it.
+
+  @param[in] Pool       The task pool.
+  @param[in] Processor  The number of the calling processor.
+  @param[in] Task       The task.
+**/
+STATIC
+VOID
+TaskPoolWaitTask (
+  IN TASK_POOL       *Pool,
+  IN UINTN           Processor,
+  IN TASK_POOL_TASK  *Task
+  );
+
+/**
+  Run a part of a parallel-for. The part is halved until it is not larger than
+  the grain, and the upper halves are pushed as tasks that the other
+  processors may steal.
+
+  @param[in] Pool       The task pool.
+  @param[in] Processor  The number of the calling processor.
+  @param[in] For        The parallel-for.
+  @param[in] Start      The first index of the part.
+  @param[in] End        The index following the last index of the part.
+**/
+STATIC
+VOID
+TaskPoolRunRange (
+  IN TASK_POOL      *Pool,
+  IN UINTN          Processor,
+  IN TASK_POOL_FOR  *For,
+  IN UINTN          Start,
+  IN UINTN          End
+  )
+{
+  TASK_POOL_TASK  *Tasks[sizeof (UINTN) * 8];
+  TASK_POOL_TASK  *Task;
+  UINTN           Count;
+  UINTN           Middle;
+
+  Count = 0;
+  while (End - Start > For->Grain) {
+    Task = TaskPoolAllocateTask (Pool);
+    if (Task == NULL) {
+      break;
+    }
+
+    Middle      = Start + (End - Start) / 2;
+    Task->For   = For;
+    Task->Start = Middle;
+    Task->End   = End;
+    TaskPoolPushTask (Pool, Processor, Task);
+    Tasks[Count++] = Task;
+    End            = Middle;
+  }
+
+  For->Procedure (Start, End, For->Context);
+
+  //
+  // Wait for the newest task first: unless it was stolen, it is at the tail
+  // of the deque of this processor.
+  //
+  while (Count > 0) {
+    TaskPoolWaitTask (Pool, Processor, Tasks[--Count]);
+  }
+}
+
+/**
+  Run a task, then release it or mark it done, and count it as completed.
+
+  @param[in] Pool       The task pool.
+  @param[in] Processor  The number of the calling processor.
+  @param[in] Task       The task.
+**/
+STATIC
+VOID
+TaskPoolRunTask (
+  IN TASK_POOL       *Pool,
+  IN UINTN           Processor,
+  IN TASK_POOL_TASK  *Task
+  )
+{
+  if (Task->For != NULL) {
+    TaskPoolRunRange (Pool, Processor, Task->For, Task->Start, Task->End);
+  } else {
+    Task->Procedure (Task->Context);
+  }
+
+  if (Task->Detached) {
+    TaskPoolFreeTask (Pool, Task);
+  } else {
+    //
+    // Make the side effects of the task visible before the waiter sees it
+    // done. The waiter releases the task, so it must not be touched after.
+    //
+    MemoryFence ();
+    Task->Done = TRUE;
+  }
+
+  InterlockedDecrement (&Pool->PendingTasks);
+}
+
+/**
+  Wait for a task to complete, running other tasks meanwhile, and release it.
+
+  @param[in] Pool       The task pool.
+  @param[in] Processor  The number of the calling processor.
+  @param[in] Task       The task.
+**/
+STATIC
+VOID
+TaskPoolWaitTask (
+  IN TASK_POOL       *Pool,
+  IN UINTN           Processor,
+  IN TASK_POOL_TASK  *Task
+  )
+{
+  TASK_POOL_TASK  *Other;
+
+  while (!Task->Done) {
+    Other = TaskPoolTakeTask (Pool, Processor);
+    if (Other != NULL) {
+      TaskPoolRunTask (Pool, Processor, Other);
+    } else {
+      CpuPause ();
+    }
+  }
+
+  TaskPoolFreeTask (Pool, Task);
+}
+
+/**
+  Run tasks until no task is pending. Runs on the BSP and on the APs.
+
+  @param[in] Buffer  The task pool.
+**/
+STATIC
+VOID
+EFIAPI
+TaskPoolWorker (
+  IN OUT VOID  *Buffer
+  )
+{
+  TASK_POOL       *Pool;
+  TASK_POOL_TASK  *Task;
+  UINTN           Processor;
+
+  Pool = (TASK_POOL *)Buffer;
+  if (InterlockedIncrement (&Pool->ActiveWorkers) > Pool->WorkerCount) {
+    return;
+  }
+
+  Processor = TaskPoolGetProcessor (Pool);
+  while (Pool->PendingTasks != 0) {
+    Task = TaskPoolTakeTask (Pool, Processor);
+    if (Task != NULL) {
+      TaskPoolRunTask (Pool, Processor, Task);
+    } else {
+      CpuPause ();
+    }
+  }
+}
+
+/**
+  Create a task pool.
+
+  Must be called on the BSP.
+
+  @param[in]  MaxTasks      The number of tasks that can be pending at the same
+                            time. When all of them are pending, the task
+                            submitted next runs at once on the submitting
+                            processor. 0 selects 64 tasks per processor.
+  @param[in]  MaxWorkers    The number of processors running the tasks, or 0
+                            for all the enabled processors.
+  @param[out] Pool          The created task pool.
+
+  @retval RETURN_SUCCESS            The task pool was created.
+  @retval RETURN_INVALID_PARAMETER  Pool is NULL.
+  @retval RETURN_OUT_OF_RESOURCES   There is not enough memory for the pool.
+
+**/
+RETURN_STATUS
+EFIAPI
+TaskPoolCreate (
+  IN  UINTN      MaxTasks,
+  IN  UINTN      MaxWorkers,
+  OUT TASK_POOL  **Pool
+  )
+{
+  TASK_POOL        *NewPool;
+  TASK_POOL_DEQUE  *Deque;
+  UINTN            EnabledCount;
+  UINTN            Alignment;
+  UINTN            Index;
+
+  if (Pool == NULL) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  NewPool = AllocateZeroPool (sizeof (TASK_POOL));
+  if (NewPool == NULL) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  NewPool->ProcessorCount = 1;
+  EnabledCount            = 1;
+  if (EFI_ERROR (TaskPoolGetMpServices (&NewPool->MpServices))) {
+    NewPool->MpServices.Ppi = NULL;
+  } else {
+    NewPool->ProcessorCount = TaskPoolGetNumberOfProcessors (NewPool->MpServices, &EnabledCount);
+  }
+
+  NewPool->WorkerCount = EnabledCount;
+  if ((MaxWorkers != 0) && (MaxWorkers < EnabledCount)) {
+    NewPool->WorkerCount = MaxWorkers;
+  }
+
+  if (MaxTasks == 0) {
+    MaxTasks = NewPool->WorkerCount * TASK_POOL_TASKS_PER_PROCESSOR;
+  }
+
+  NewPool->MaxTasks = MaxTasks;
+
+  Alignment            = MAX (GetSpinLockProperties (), sizeof (UINT64));
+  NewPool->DequeSize   = ALIGN_VALUE (sizeof (TASK_POOL_DEQUE), Alignment);
+  NewPool->DequeBuffer = AllocateZeroPool (NewPool->ProcessorCount * NewPool->DequeSize + Alignment);
+  NewPool->Tasks       = AllocateZeroPool (MaxTasks * sizeof (TASK_POOL_TASK));
+  NewPool->DequeTasks  = AllocatePool (NewPool->ProcessorCount * MaxTasks * sizeof (TASK_POOL_TASK *));
+  if ((NewPool->DequeBuffer == NULL) || (NewPool->Tasks == NULL) || (NewPool->DequeTasks == NULL)) {
+    TaskPoolDestroy (NewPool);
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  NewPool->Deques = (UINT8 *)ALIGN_POINTER (NewPool->DequeBuffer, Alignment);
+  for (Index = 0; Index < NewPool->ProcessorCount; Index++) {
+    Deque        = TaskPoolGetDeque (NewPool, Index);
+    Deque->Tasks = &NewPool->DequeTasks[Index * MaxTasks];
+    InitializeSpinLock (&Deque->Lock);
+  }
+
+  InitializeSpinLock (&NewPool->FreeLock);
+  TaskPoolResetTasks (NewPool);
+
+  *Pool = NewPool;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Free a task pool.
+
+  Must be called on the BSP, when no TaskPoolRun () is in progress.
+
+  @param[in] Pool  The task pool to free.
+
+**/
+VOID
+EFIAPI
+TaskPoolDestroy (
+  IN TASK_POOL  *Pool
+  )
+{
+  if (Pool == NULL) {
+    return;
+  }
+
+  ASSERT (!Pool->Running);
+
+  if (Pool->DequeBuffer != NULL) {
+    FreePool (Pool->DequeBuffer);
+  }
+
+  if (Pool->Tasks != NULL) {
+    FreePool (Pool->Tasks);
+  }
+
+  if (Pool->DequeTasks != NULL) {
+    FreePool (Pool->DequeTasks);
+  }
+
+  FreePool (Pool);
+}
+
+/**
+  Return the number of processors that may run the tasks of a task pool.
+
+  @param[in] Pool  The task pool.
+
+  @return The number of processors, at least 1.
+
+**/
+UINTN
+EFIAPI
+TaskPoolGetWorkerCount (
+  IN TASK_POOL  *Pool
+  )
+{
+  ASSERT (Pool != NULL);
+  return Pool->WorkerCount;
+}
+
+/**
+  Run a task and all the tasks it submits, and return when they all completed.
+
+  Must be called on the BSP, outside of any task. The APs run the tasks for the
+  whole duration of the call, and the BSP joins them when the MP services allow
+  it to go on while the APs run.
+
+  @param[in] Pool       The task pool.
+  @param[in] Procedure  The first task.
+  @param[in] Context    The context passed to Procedure.
+
+  @retval RETURN_SUCCESS            All the tasks completed.
+  @retval RETURN_INVALID_PARAMETER  Pool or Procedure is NULL.
+  @retval RETURN_ALREADY_STARTED    The task pool is already running.
+
+**/
+RETURN_STATUS
+EFIAPI
+TaskPoolRun (
+  IN TASK_POOL            *Pool,
+  IN TASK_POOL_PROCEDURE  Procedure,
+  IN VOID                 *Context
+  )
+{
+  TASK_POOL_TASK  *Task;
+  EFI_STATUS      Status;
+
+  if ((Pool == NULL) || (Procedure == NULL)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  if (Pool->Running) {
+    return RETURN_ALREADY_STARTED;
+  }
+
+  Task = TaskPoolAllocateTask (Pool);
+  ASSERT (Task != NULL);
+  Task->Procedure = Procedure;
+  Task->Context   = Context;
+  Task->Detached  = TRUE;
+
+  Pool->Running       = TRUE;
+  Pool->ActiveWorkers = 0;
+  TaskPoolPushTask (Pool, TaskPoolGetProcessor (Pool), Task);
+
+  Status = EFI_UNSUPPORTED;
+  if ((Pool->MpServices.Ppi != NULL) && (Pool->WorkerCount > 1)) {
+    Status = TaskPoolStartupAllCpus (Pool->MpServices, TaskPoolWorker, Pool);
+  }
+
+  if (EFI_ERROR (Status)) {
+    //
+    // The APs did not run, or not all of them. Completing the remaining tasks
+    // on the BSP also covers the case where the BSP did not run the worker.
+    //
+    Pool->ActiveWorkers = 0;
+    TaskPoolWorker (Pool);
+  }
+
+  ASSERT (Pool->PendingTasks == 0);
+
+  //
+  // Release the futures that were not waited for.
+  //
+  TaskPoolResetTasks (Pool);
+  Pool->Running = FALSE;
+  return RETURN_SUCCESS;
+}
+
+/**
+  Submit a task from a running task.
+
+  The task is pushed to the deque of the calling processor. When all the tasks
+  of the pool are pending, the task runs before this function returns, and
+  *Future is set to NULL.
+
+  A returned future must be passed to TaskPoolWait () once. The futures that
+  are not waited for are released when TaskPoolRun () returns.
+
+  @param[in]  Pool       The task pool.
+  @param[in]  Procedure  The task.
+  @param[in]  Context    The context passed to Procedure.
+  @param[out] Future     The future of the task, or NULL to not wait for it.
+
+  @retval RETURN_SUCCESS            The task was submitted or ran.
+  @retval RETURN_INVALID_PARAMETER  Pool or Procedure is NULL.
+  @retval RETURN_NOT_STARTED        The task pool is not running.
+
+**/
+RETURN_STATUS
+EFIAPI
+TaskPoolSubmit (
+  IN  TASK_POOL            *Pool,
+  IN  TASK_POOL_PROCEDURE  Procedure,
+  IN  VOID                 *Context,
+  OUT TASK_POOL_FUTURE     **Future OPTIONAL
+  )
+{
+  TASK_POOL_TASK  *Task;
+
+  if ((Pool == NULL) || (Procedure == NULL)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  if (!Pool->Running) {
+    return RETURN_NOT_STARTED;
+  }
+
+  Task = TaskPoolAllocateTask (Pool);
+  if (Task == NULL) {
+    Procedure (Context);
+  } else {
+    Task->Procedure = Procedure;
+    Task->Context   = Context;
+    Task->Detached  = (BOOLEAN)(Future == NULL);
+    TaskPoolPushTask (Pool, TaskPoolGetProcessor (Pool), Task);
+  }
+
+  if (Future != NULL) {
+    *Future = Task;
+  }
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Wait for a task submitted by TaskPoolSubmit () to complete, and release its
+  future.
+
+  The calling processor runs other tasks while it waits.
+
+  @param[in] Pool    The task pool.
+  @param[in] Future  The future of the task. NULL returns at once.
+
+**/
+VOID
+EFIAPI
+TaskPoolWait (
+  IN TASK_POOL         *Pool,
+  IN TASK_POOL_FUTURE  *Future
+  )
+{
+  ASSERT (Pool != NULL);
+  if (Future == NULL) {
+    return;
+  }
+
+  ASSERT (!Future->Detached);
+  TaskPoolWaitTask (Pool, TaskPoolGetProcessor (Pool), Future);
+}
+
+///
+/// The first task of a parallel-for started outside of TaskPoolRun ().
+///
+typedef struct {
+  TASK_POOL        *Pool;
+  TASK_POOL_FOR    *For;
+  UINTN            Start;
+  UINTN            End;
+} TASK_POOL_FOR_ROOT;
+
+/**
+  Run the whole range of a parallel-for.
+
+  @param[in] Context  The TASK_POOL_FOR_ROOT of the parallel-for.
+**/
+STATIC
+VOID
+EFIAPI
+TaskPoolForRoot (
+  IN VOID  *Context
+  )
+{
+  TASK_POOL_FOR_ROOT  *Root;
+
+  Root = (TASK_POOL_FOR_ROOT *)Context;
+  TaskPoolRunRange (Root->Pool, TaskPoolGetProcessor (Root->Pool), Root->For, Root->Start, Root->End);
+}
+
+/**
+  Run Procedure over the index range [Start, End), split in parts of about
+  Grain indexes that run in parallel.
+
+  Called on the BSP outside of any task, the function runs the parallel-for
+  with TaskPoolRun (). Called from a running task, the parts run as tasks of
+  the current run. In both cases the function returns when all the parts
+  completed.
+
+  @param[in] Pool       The task pool.
+  @param[in] Start      The first index.
+  @param[in] End        The index following the last index.
+  @param[in] Grain      The number of indexes under which a part is not split
+                        further, or 0 to select it from the number of
+                        processors.
+  @param[in] Procedure  The body of the parallel-for.
+  @param[in] Context    The context passed to Procedure.
+
+  @retval RETURN_SUCCESS            All the parts completed.
+  @retval RETURN_INVALID_PARAMETER  Pool or Procedure is NULL, or End is
+                                    below Start.
+
+**/
+RETURN_STATUS
+EFIAPI
+TaskPoolParallelFor (
+  IN TASK_POOL                  *Pool,
+  IN UINTN                      Start,
+  IN UINTN                      End,
+  IN UINTN                      Grain,
+  IN TASK_POOL_RANGE_PROCEDURE  Procedure,
+  IN VOID                       *Context
+  )
+{
+  TASK_POOL_FOR       For;
+  TASK_POOL_FOR_ROOT  Root;
+
+  if ((Pool == NULL) || (Procedure == NULL) || (End < Start)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  if (Start == End) {
+    return RETURN_SUCCESS;
+  }
+
+  if (Grain == 0) {
+    Grain = MAX ((End - Start) / (Pool->WorkerCount * TASK_POOL_PARTS_PER_PROCESSOR), 1);
+  }
+
+  For.Procedure = Procedure;
+  For.Context   = Context;
+  For.Grain     = Grain;
+
+  if (Pool->Running) {
+    TaskPoolRunRange (Pool, TaskPoolGetProcessor (Pool), &For, Start, End);
+    return RETURN_SUCCESS;
+  }
+
+  Root.Pool  = Pool;
+  Root.For   = &For;
+  Root.Start = Start;
+  Root.End   = End;
+  return TaskPoolRun (Pool, TaskPoolForRoot, &Root);
+}
@@ -0,0 +1,607 @@
+/** @file
+  Unit tests of the task pool of TaskPoolLib.
+
+  The MP services are replaced by a model running the procedure on the
+  simulated processors one after the other, the APs first, so that the tasks
+  submitted on the BSP are stolen by the APs.
+
+  Copyright (c) 2026, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "../InternalTaskPoolLib.h"
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_APP_NAME     "TaskPoolLib Unit Tests"
+#define UNIT_TEST_APP_VERSION  "1.0"
+
+#define TEST_PROCESSOR_COUNT  4
+#define TEST_RANGE_SIZE       10000
+#define TEST_FIBONACCI_INDEX  16
+#define TEST_FIBONACCI_VALUE  987
+
+///
+/// Context of a test: whether the MP services are available, and the
+/// parameters of TaskPoolCreate ().
+///
+typedef struct {
+  BOOLEAN    MpServicesAvailable;
+  UINTN      MaxTasks;
+  UINTN      MaxWorkers;
+} TASK_POOL_TEST_CONTEXT;
+
+typedef struct {
+  TASK_POOL    *Pool;
+  UINTN        Index;
+  UINTN        Value;
+} FIBONACCI_CONTEXT;
+
+typedef struct {
+  UINT8    *Hits;
+  UINTN    Processors[TEST_PROCESSOR_COUNT];
+} RANGE_CONTEXT;
+
+typedef struct {
+  TASK_POOL          *Pool;
+  volatile UINT32    Counter;
+  RETURN_STATUS      Status;
+} POOL_CONTEXT;
+
+STATIC BOOLEAN  mMpServicesAvailable;
+STATIC UINTN    mCurrentProcessor;
+STATIC UINTN    mTaskProcessors[TEST_PROCESSOR_COUNT];
+STATIC UINT8    mPpiPlaceholder;
+
+/**
+  Get EFI_PEI_MP_SERVICES2_PPI or EFI_MP_SERVICES_PROTOCOL pointer.
+
+  @param[out] MpServices    A pointer to the buffer where EFI_PEI_MP_SERVICES2_PPI or
+                            EFI_MP_SERVICES_PROTOCOL is stored
+
+  @retval EFI_SUCCESS       EFI_PEI_MP_SERVICES2_PPI or EFI_MP_SERVICES_PROTOCOL interface is returned
+  @retval EFI_NOT_FOUND     EFI_PEI_MP_SERVICES2_PPI or EFI_MP_SERVICES_PROTOCOL interface is not found
+**/
+EFI_STATUS
+TaskPoolGetMpServices (
+  OUT MP_SERVICES  *MpServices
+  )
+{
+  if (!mMpServicesAvailable) {
+    return EFI_NOT_FOUND;
+  }
+
+  MpServices->Ppi = (EFI_PEI_MP_SERVICES2_PPI *)&mPpiPlaceholder;
+  return EFI_SUCCESS;
+}
+
+/**
+  Run a procedure on all the simulated processors, the APs first.
+
+  @param[in]  MpServices          MP_SERVICES structure.
+  @param[in]  Procedure           A pointer to the function to be run on enabled logical processors.
+  @param[in]  ProcedureArgument   The parameter passed into Procedure for all enabled logical processors.
+
+  @retval EFI_SUCCESS       Procedure ran on the enabled logical processors.
+**/
+EFI_STATUS
+TaskPoolStartupAllCpus (
+  IN MP_SERVICES       MpServices,
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *ProcedureArgument
+  )
+{
+  UINTN  Index;
+
+  for (Index = 1; Index <= TEST_PROCESSOR_COUNT; Index++) {
+    mCurrentProcessor = Index % TEST_PROCESSOR_COUNT;
+    Procedure (ProcedureArgument);
+  }
+
+  mCurrentProcessor = 0;
+  return EFI_SUCCESS;
+}
+
+/**
+  Get the logical processor number.
+
+  @param[in]  MpServices          MP_SERVICES structure.
+
+  @retval  Return the logical processor number.
+**/
+UINTN
+TaskPoolWhoAmI (
+  IN MP_SERVICES  MpServices
+  )
+{
+  return mCurrentProcessor;
+}
+
+/**
+  Get the number of logical processors in the platform.
+
+  @param[in]  MpServices                 MP_SERVICES structure.
+  @param[out] NumberOfEnabledProcessors  The number of enabled logical processors.
+
+  @retval  Return the total number of logical processors.
+**/
+UINTN
+TaskPoolGetNumberOfProcessors (
+  IN  MP_SERVICES  MpServices,
+  OUT UINTN        *NumberOfEnabledProcessors
+  )
+{
+  *NumberOfEnabledProcessors = TEST_PROCESSOR_COUNT;
+  return TEST_PROCESSOR_COUNT;
+}
+
+/**
+  Create the task pool described by a test context.
+
+  @param[in]  Context  The TASK_POOL_TEST_CONTEXT.
+  @param[out] Pool     The created task pool.
+
+  @return The status of TaskPoolCreate ().
+**/
+STATIC
+RETURN_STATUS
+TestCreatePool (
+  IN  UNIT_TEST_CONTEXT  Context,
+  OUT TASK_POOL          **Pool
+  )
+{
+  TASK_POOL_TEST_CONTEXT  *TestContext;
+
+  TestContext          = (TASK_POOL_TEST_CONTEXT *)Context;
+  mMpServicesAvailable = TestContext->MpServicesAvailable;
+  mCurrentProcessor    = 0;
+  ZeroMem (mTaskProcessors, sizeof (mTaskProcessors));
+  return TaskPoolCreate (TestContext->MaxTasks, TestContext->MaxWorkers, Pool);
+}
+
+/**
+  Count the indexes of a part of a parallel-for.
+
+  @param[in] Start    The first index of the part.
+  @param[in] End      The index following the last index of the part.
+  @param[in] Context  The RANGE_CONTEXT.
+**/
+STATIC
+VOID
+EFIAPI
+CountRange (
+  IN UINTN  Start,
+  IN UINTN  End,
+  IN VOID   *Context
+  )
+{
+  RANGE_CONTEXT  *Range;
+  UINTN          Index;
+
+  Range = (RANGE_CONTEXT *)Context;
+  Range->Processors[mCurrentProcessor]++;
+  for (Index = Start; Index < End; Index++) {
+    Range->Hits[Index]++;
+  }
+}
+
+/**
+  Compute a Fibonacci number with one task per call.
+
+  @param[in] Context  The FIBONACCI_CONTEXT.
+**/
+STATIC
+VOID
+EFIAPI
+Fibonacci (
+  IN VOID  *Context
+  )
+{
+  FIBONACCI_CONTEXT  *Fib;
+  FIBONACCI_CONTEXT  Lower;
+  FIBONACCI_CONTEXT  Higher;
+  TASK_POOL_FUTURE   *Future;
+  RETURN_STATUS      Status;
+
+  Fib = (FIBONACCI_CONTEXT *)Context;
+  mTaskProcessors[mCurrentProcessor]++;
+  if (Fib->Index < 2) {
+    Fib->Value = Fib->Index;
+    return;
+  }
+
+  Lower.Pool   = Fib->Pool;
+  Lower.Index  = Fib->Index - 2;
+  Higher.Pool  = Fib->Pool;
+  Higher.Index = Fib->Index - 1;
+
+  Status = TaskPoolSubmit (Fib->Pool, Fibonacci, &Higher, &Future);
+  ASSERT (Status == RETURN_SUCCESS);
+  Fibonacci (&Lower);
+  TaskPoolWait (Fib->Pool, Future);
+
+  Fib->Value = Lower.Value + Higher.Value;
+}
+
+/**
+  Increment the counter of a POOL_CONTEXT.
+
+  @param[in] Context  The POOL_CONTEXT.
+**/
+STATIC
+VOID
+EFIAPI
+IncrementCounter (
+  IN VOID  *Context
+  )
+{
+  InterlockedIncrement (&((POOL_CONTEXT *)Context)->Counter);
+}
+
+/**
+  Submit tasks without futures.
+
+  @param[in] Context  The POOL_CONTEXT.
+**/
+STATIC
+VOID
+EFIAPI
+SubmitDetached (
+  IN VOID  *Context
+  )
+{
+  POOL_CONTEXT   *PoolContext;
+  UINTN          Index;
+  RETURN_STATUS  Status;
+
+  PoolContext = (POOL_CONTEXT *)Context;
+  for (Index = 0; Index < 100; Index++) {
+    Status = TaskPoolSubmit (PoolContext->Pool, IncrementCounter, PoolContext, NULL);
+    ASSERT (Status == RETURN_SUCCESS);
+  }
+}
+
+/**
+  Try to start a run from a running task.
+
+  @param[in] Context  The POOL_CONTEXT.
+**/
+STATIC
+VOID
+EFIAPI
+RunFromTask (
+  IN VOID  *Context
+  )
+{
+  POOL_CONTEXT  *PoolContext;
+
+  PoolContext         = (POOL_CONTEXT *)Context;
+  PoolContext->Status = TaskPoolRun (PoolContext->Pool, IncrementCounter, PoolContext);
+}
+
+/**
+  Check that a parallel-for runs every index of its range exactly once, on the
+  allowed processors.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+ParallelForShouldCoverRange (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC CONST UINTN  Sizes[]  = { 1, 2, 7, 1000, TEST_RANGE_SIZE };
+  STATIC CONST UINTN  Grains[] = { 0, 1, 3, 64, TEST_RANGE_SIZE };
+  TASK_POOL           *Pool;
+  RANGE_CONTEXT       Range;
+  RETURN_STATUS       Status;
+  UINTN               SizeIndex;
+  UINTN               GrainIndex;
+  UINTN               Index;
+  UINTN               Processor;
+  UINTN               Runners;
+
+  Status = TestCreatePool (Context, &Pool);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  Range.Hits = AllocatePool (TEST_RANGE_SIZE + 1);
+  UT_ASSERT_NOT_NULL (Range.Hits);
+
+  for (SizeIndex = 0; SizeIndex < ARRAY_SIZE (Sizes); SizeIndex++) {
+    for (GrainIndex = 0; GrainIndex < ARRAY_SIZE (Grains); GrainIndex++) {
+      ZeroMem (Range.Hits, TEST_RANGE_SIZE + 1);
+      ZeroMem (Range.Processors, sizeof (Range.Processors));
+
+      //
+      // Start at 1 so that an index below Start would be seen in Hits[0].
+      //
+      Status = TaskPoolParallelFor (Pool, 1, Sizes[SizeIndex] + 1, Grains[GrainIndex], CountRange, &Range);
+      UT_ASSERT_STATUS_EQUAL (Status, RETURN_SUCCESS);
+
+      UT_ASSERT_EQUAL (Range.Hits[0], 0);
+      for (Index = 1; Index <= Sizes[SizeIndex]; Index++) {
+        UT_ASSERT_EQUAL (Range.Hits[Index], 1);
+      }
+
+      //
+      // The parts only run on the allowed processors.
+      //
+      Runners = 0;
+      for (Processor = 0; Processor < TEST_PROCESSOR_COUNT; Processor++) {
+        if (Range.Processors[Processor] != 0) {
+          Runners++;
+        }
+      }
+
+      UT_ASSERT_TRUE (Runners >= 1);
+      UT_ASSERT_TRUE (Runners <= TaskPoolGetWorkerCount (Pool));
+      if (!mMpServicesAvailable) {
+        UT_ASSERT_NOT_EQUAL (Range.Processors[0], 0);
+      }
+    }
+  }
+
+  //
+  // An empty range succeeds without calling the procedure.
+  //
+  Range.Hits[0] = 0;
+  Status        = TaskPoolParallelFor (Pool, 5, 5, 1, CountRange, &Range);
+  UT_ASSERT_STATUS_EQUAL (Status, RETURN_SUCCESS);
+  UT_ASSERT_EQUAL (Range.Hits[0], 0);
+
+  FreePool (Range.Hits);
+  TaskPoolDestroy (Pool);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that the futures return the results of their tasks, including when the
+  tasks run at once because all the tasks of the pool are pending, and that
+  the detached tasks all run.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+FuturesShouldComplete (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TASK_POOL          *Pool;
+  FIBONACCI_CONTEXT  Fib;
+  POOL_CONTEXT       Detached;
+  RETURN_STATUS      Status;
+  UINTN              Processor;
+  UINTN              Runners;
+
+  Status = TestCreatePool (Context, &Pool);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  Fib.Pool  = Pool;
+  Fib.Index = TEST_FIBONACCI_INDEX;
+  Fib.Value = 0;
+  Status    = TaskPoolRun (Pool, Fibonacci, &Fib);
+  UT_ASSERT_STATUS_EQUAL (Status, RETURN_SUCCESS);
+  UT_ASSERT_EQUAL (Fib.Value, TEST_FIBONACCI_VALUE);
+
+  Runners = 0;
+  for (Processor = 0; Processor < TEST_PROCESSOR_COUNT; Processor++) {
+    if (mTaskProcessors[Processor] != 0) {
+      Runners++;
+    }
+  }
+
+  UT_ASSERT_TRUE (Runners >= 1);
+  UT_ASSERT_TRUE (Runners <= TaskPoolGetWorkerCount (Pool));
+  if (!mMpServicesAvailable) {
+    UT_ASSERT_EQUAL (TaskPoolGetWorkerCount (Pool), 1);
+  } else {
+    //
+    // The first task was pushed on the BSP, which only runs after the APs in
+    // the model of the MP services, so an AP stole it.
+    //
+    UT_ASSERT_EQUAL (mTaskProcessors[0], 0);
+  }
+
+  //
+  // The tasks without futures complete before TaskPoolRun () returns.
+  //
+  ZeroMem (&Detached, sizeof (Detached));
+  Detached.Pool = Pool;
+  Status        = TaskPoolRun (Pool, SubmitDetached, &Detached);
+  UT_ASSERT_STATUS_EQUAL (Status, RETURN_SUCCESS);
+  UT_ASSERT_EQUAL (Detached.Counter, 100);
+
+  //
+  // The futures that were not waited for were released: the pool still has
+  // all its tasks.
+  //
+  Fib.Value = 0;
+  Status    = TaskPoolRun (Pool, Fibonacci, &Fib);
+  UT_ASSERT_STATUS_EQUAL (Status, RETURN_SUCCESS);
+  UT_ASSERT_EQUAL (Fib.Value, TEST_FIBONACCI_VALUE);
+
+  TaskPoolDestroy (Pool);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check the parameters of the task pool functions.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+ParametersShouldBeChecked (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TASK_POOL         *Pool;
+  TASK_POOL_FUTURE  *Future;
+  RANGE_CONTEXT     Range;
+  POOL_CONTEXT      PoolContext;
+  RETURN_STATUS     Status;
+
+  UT_ASSERT_STATUS_EQUAL (TaskPoolCreate (0, 0, NULL), RETURN_INVALID_PARAMETER);
+
+  Status = TestCreatePool (Context, &Pool);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  ZeroMem (&PoolContext, sizeof (PoolContext));
+  PoolContext.Pool = Pool;
+  UT_ASSERT_STATUS_EQUAL (TaskPoolRun (NULL, IncrementCounter, &PoolContext), RETURN_INVALID_PARAMETER);
+  UT_ASSERT_STATUS_EQUAL (TaskPoolRun (Pool, NULL, &PoolContext), RETURN_INVALID_PARAMETER);
+  UT_ASSERT_STATUS_EQUAL (TaskPoolSubmit (Pool, IncrementCounter, &PoolContext, &Future), RETURN_NOT_STARTED);
+  UT_ASSERT_STATUS_EQUAL (TaskPoolSubmit (Pool, NULL, &PoolContext, &Future), RETURN_INVALID_PARAMETER);
+  UT_ASSERT_STATUS_EQUAL (TaskPoolParallelFor (Pool, 2, 1, 1, CountRange, &Range), RETURN_INVALID_PARAMETER);
+  UT_ASSERT_STATUS_EQUAL (TaskPoolParallelFor (Pool, 1, 2, 1, NULL, &Range), RETURN_INVALID_PARAMETER);
+  UT_ASSERT_EQUAL (PoolContext.Counter, 0);
+
+  //
+  // TaskPoolRun () cannot be nested, and the pool is usable after.
+  //
+  Status = TaskPoolRun (Pool, RunFromTask, &PoolContext);
+  UT_ASSERT_STATUS_EQUAL (Status, RETURN_SUCCESS);
+  UT_ASSERT_STATUS_EQUAL (PoolContext.Status, RETURN_ALREADY_STARTED);
+  UT_ASSERT_EQUAL (PoolContext.Counter, 0);
+
+  Status = TaskPoolRun (Pool, IncrementCounter, &PoolContext);
+  UT_ASSERT_STATUS_EQUAL (Status, RETURN_SUCCESS);
+  UT_ASSERT_EQUAL (PoolContext.Counter, 1);
+
+  TaskPoolDestroy (Pool);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  task pool and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UnitTestingEntry (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      PoolTests;
+  UINTN                       Index;
+
+  STATIC TASK_POOL_TEST_CONTEXT  TestContexts[] = {
+    { TRUE,  0, 0 },
+    { TRUE,  4, 0 },
+    { TRUE,  0, 2 },
+    { FALSE, 0, 0 },
+    { FALSE, 2, 0 },
+  };
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_APP_NAME, UNIT_TEST_APP_VERSION));
+
+  //
+  // Start setting up the test framework for running the tests.
+  //
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_APP_NAME, gEfiCallerBaseName, UNIT_TEST_APP_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&PoolTests, Framework, "Task Pool Tests", "TaskPoolLib.TaskPool", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for Task Pool Tests\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  //
+  // The contexts cover all the processors, few tasks so that submitted tasks
+  // run at once, fewer workers than processors, and no MP services.
+  //
+  for (Index = 0; Index < ARRAY_SIZE (TestContexts); Index++) {
+    AddTestCase (PoolTests, "Parallel-for covers its range once", "ParallelFor", ParallelForShouldCoverRange, NULL, NULL, &TestContexts[Index]);
+    AddTestCase (PoolTests, "Futures complete", "Futures", FuturesShouldComplete, NULL, NULL, &TestContexts[Index]);
+    AddTestCase (PoolTests, "Parameters are checked", "Parameters", ParametersShouldBeChecked, NULL, NULL, &TestContexts[Index]);
+  }
+
+  //
+  // Execute the tests.
+  //
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+///
+/// Avoid ECC error for function name that starts with lower case letter
+///
+#define TaskPoolLibUnitTestMain  main
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+
+  @param[in] Argc  Number of arguments
+  @param[in] Argv  Array of pointers to arguments
+
+  @retval 0      Success
+  @retval other  Error
+**/
+INT32
+TaskPoolLibUnitTestMain (
+  IN INT32  Argc,
+  IN CHAR8  *Argv[]
+  )
+{
+  UnitTestingEntry ();
+  return 0;
+}